@@ -124,6 +124,11 @@ extern "C" {
 
 #define SYS_CONSOLE_USB_CDC_READ_WRITE_BUFFER_SIZE 	(64)
 
+/* RANDOM System Service Configuration Options */
+#define SYS_RANDOM_POOL_SIZE                64
+#define SYS_RANDOM_POOL_RESEED_FILLS        1024
+#define SYS_RANDOM_FAST_RESEED_COUNT        65536
+
 
 
 // *****************************************************************************
@@ -158,6 +163,7 @@ extern "C" {
 #define WDRV_PIC32MZW_BIGINTSW_SUPPORT
 #define WDRV_PIC32MZW_ALARM_PERIOD_1MS          0
 #define WDRV_PIC32MZW_ALARM_PERIOD_MAX          0
+#define WDRV_PIC32MZW_SCAN_RESULT_CACHE_LIFETIME    30000
 
 
 
@@ -184,6 +190,9 @@ extern "C" {
 #define TCPIP_DNS_CLIENT_DELETE_OLD_ENTRIES			true
 #define TCPIP_DNS_CLIENT_CONSOLE_CMD               	true
 #define TCPIP_DNS_CLIENT_USER_NOTIFICATION   false
+#define TCPIP_DNS_CLIENT_PREFETCH_PERCENT			10
+#define TCPIP_DNS_CLIENT_NEGATIVE_CACHE_TMO			300
+#define TCPIP_DNS_CLIENT_PARALLEL_QUERY			true
 
 
 
@@ -286,8 +295,20 @@ extern "C" {
 #define TCPIP_TCP_WINDOW_UPDATE_TIMEOUT_VAL			200
 #define TCPIP_TCP_MAX_SOCKETS		                10
 #define TCPIP_TCP_TASK_TICK_RATE		        	5
+#define TCPIP_TCP_IDLE_TICK_RATE		        	1000
 #define TCPIP_TCP_MSL_TIMEOUT		        	    0
 #define TCPIP_TCP_QUIET_TIME		        	    0
+#define TCPIP_TCP_LISTEN_BACKLOG   true
+#define TCPIP_TCP_EMBRYONIC_LIMIT   8
+#define TCPIP_TCP_SYN_COOKIES   false
+#define TCPIP_TCP_SYN_RATE_LIMIT   0
+#define TCPIP_TCP_SYN_RATE_SOURCES   8
+#define TCPIP_TCP_AUTO_TUNE   false
+#define TCPIP_TCP_AUTO_TUNE_MAX_SIZE   8192
+#define TCPIP_TCP_AUTO_TUNE_TOTAL_SIZE   16384
+#define TCPIP_TCP_AUTO_TUNE_IDLE_TIMEOUT   2000
+#define TCPIP_TCP_AUTO_TUNE_HEAP_RESERVE   8192
+#define TCPIP_TCP_QUICK_ACK   true
 #define TCPIP_TCP_COMMANDS   false
 #define TCPIP_TCP_EXTERN_PACKET_PROCESS   false
 #define TCPIP_TCP_DISABLE_CRYPTO_USAGE		        	    false
@@ -298,6 +319,7 @@ extern "C" {
 #define TCPIP_STACK_USE_DHCP_CLIENT
 #define TCPIP_DHCP_TIMEOUT                          10
 #define TCPIP_DHCP_TASK_TICK_RATE                   5
+#define TCPIP_DHCP_IDLE_TICK_RATE                   1000
 #define TCPIP_DHCP_HOST_NAME_SIZE                   20
 #define TCPIP_DHCP_CLIENT_CONNECT_PORT              68
 #define TCPIP_DHCP_SERVER_LISTEN_PORT               67
@@ -309,6 +331,11 @@ extern "C" {
 #define TCPIP_DHCP_NTP_SERVER_ADDRESSES             0
 #define TCPIP_DHCP_ARP_LEASE_CHECK_TMO              1000
 #define TCPIP_DHCP_WAIT_ARP_FAIL_CHECK_TMO          10
+#define TCPIP_DHCP_USE_INIT_REBOOT                  true
+#define TCPIP_DHCP_INIT_REBOOT_TMO                  1500
+#define TCPIP_DHCP_REQUEST_ACK_TMO                  0
+#define TCPIP_DHCP_USE_RAPID_COMMIT                 true
+#define TCPIP_DHCP_USE_OPTIMISTIC_BIND              true
 
 
 
@@ -326,6 +353,9 @@ extern "C" {
 #define TCPIP_ARP_TASK_PROCESS_RATE		        	2000
 #define TCPIP_ARP_PRIMARY_CACHE_ONLY		        	true
 #define TCPIP_ARP_COMMANDS false
+#define TCPIP_ARP_WARM_START		        	true
+#define TCPIP_ARP_WARM_SNAPSHOT_RATE		        	10
+#define TCPIP_ARP_WARM_RESTORE_TMO		        	60
 
 
 
@@ -483,6 +513,8 @@ extern "C" {
 
 #define TCPIP_STACK_HEAP_USE_FLAGS                   TCPIP_STACK_HEAP_FLAG_ALLOC_UNCACHED
 
+#define TCPIP_STACK_PACKET_CACHED_BUFFERS            false
+
 #define TCPIP_STACK_HEAP_USAGE_CONFIG                TCPIP_STACK_HEAP_USE_DEFAULT
 
 #define TCPIP_STACK_SUPPORTED_HEAPS                  1
@@ -503,6 +535,8 @@ extern "C" {
 #define TCPIP_STACK_TICK_RATE		        		5
 #define TCPIP_STACK_SECURE_PORT_ENTRIES             10
 #define TCPIP_STACK_LINK_RATE		        		333
+#define TCPIP_STACK_DEADLINE_TIMEOUTS               true
+#define TCPIP_STACK_STAGED_INIT                     false
 
 #define TCPIP_STACK_ALIAS_INTERFACE_SUPPORT   false
 
@@ -510,6 +544,7 @@ extern "C" {
 
 /* TCP/IP stack event notification */
 #define TCPIP_STACK_USE_EVENT_NOTIFICATION
+#define TCPIP_STACK_USE_SOCKET_READY
 #define TCPIP_STACK_USER_NOTIFICATION   true
 #define TCPIP_STACK_DOWN_OPERATION   true
 #define TCPIP_STACK_IF_UP_DOWN_OPERATION   true
@@ -537,6 +572,7 @@ extern "C" {
 #define TCPIP_UDP_USE_POOL_BUFFERS   false
 #define TCPIP_UDP_USE_TX_CHECKSUM             			true
 #define TCPIP_UDP_USE_RX_CHECKSUM             			true
+#define TCPIP_UDP_BATCH_SEND   true
 #define TCPIP_UDP_COMMANDS   false
 #define TCPIP_UDP_EXTERN_PACKET_PROCESS   false
 
@@ -677,6 +713,37 @@ extern "C" {
 
 #define TCPIP_MAC_BRIDGE_STATISTICS          		false
 #define TCPIP_MAC_BRIDGE_EVENT_NOTIFY          		false
+#define TCPIP_MAC_BRIDGE_BOOT_TIMESTAMPS       		true
+#define TCPIP_MAC_BRIDGE_WARM_START            		true
+#define TCPIP_MAC_BRIDGE_WARM_SNAPSHOT_RATE         5
+#define TCPIP_MAC_BRIDGE_WARM_RESTORE_TMO           30
+#define TCPIP_MAC_BRIDGE_VLAN_SUPPORT          		false
+#define TCPIP_MAC_BRIDGE_MAX_VLANS                  8
+#define TCPIP_MAC_BRIDGE_RSTP_SUPPORT          		false
+#define TCPIP_MAC_BRIDGE_RSTP_PRIORITY              32768
+#define TCPIP_MAC_BRIDGE_RSTP_HELLO_TIME            2
+#define TCPIP_MAC_BRIDGE_RSTP_MAX_AGE               20
+#define TCPIP_MAC_BRIDGE_RSTP_FORWARD_DELAY         15
+#define TCPIP_MAC_BRIDGE_RSTP_PORT_PATH_COST        200000
+#define TCPIP_MAC_BRIDGE_LEARN_LIMITS          		false
+#define TCPIP_MAC_BRIDGE_LEARN_MAX_ENTRIES          0
+#define TCPIP_MAC_BRIDGE_LEARN_RATE                 0
+#define TCPIP_MAC_BRIDGE_LEARN_VIOLATION            0
+#define TCPIP_MAC_BRIDGE_LEARN_HOLD_TIME            30
+#define TCPIP_MAC_BRIDGE_LEARN_PROTECT_TIME         10
+#define TCPIP_MAC_BRIDGE_MOVE_DAMPENING          		false
+#define TCPIP_MAC_BRIDGE_MOVE_THRESHOLD             4
+#define TCPIP_MAC_BRIDGE_MOVE_WINDOW                10
+#define TCPIP_MAC_BRIDGE_MOVE_PIN_TIME              60
+#define TCPIP_MAC_BRIDGE_MOVE_PORT_HOLD_TIME        0
+#define TCPIP_MAC_BRIDGE_ENTRY_COUNTERS          	false
+#define TCPIP_MAC_BRIDGE_TX_BACKLOG                 0
+#define TCPIP_MAC_BRIDGE_ACK_FILTER          		false
+#define TCPIP_MAC_BRIDGE_ACL                 		false
+#define TCPIP_MAC_BRIDGE_ACL_MAX_RULES              16
+#define TCPIP_MAC_BRIDGE_FDB_MAX_ENTRIES            0
+#define TCPIP_MAC_BRIDGE_FDB_GROW_LOAD              75
+#define TCPIP_MAC_BRIDGE_FDB_SHRINK_LOAD            25
 
 #define TCPIP_MAC_BRIDGE_IF_NAME_TABLE false
 
@@ -51,6 +51,44 @@ Microchip or any third party.
         
 
 
+#if defined(__PIC32MZ__)
+// Cache maintenance for data buffers passed through the cached KSEG0 segment.
+// The descriptors themselves are always accessed uncached.
+// A KSEG0 RX buffer has to own all the cache lines it spans.
+
+// TX: writes the buffer back to memory before the DMA reads it
+// The lines stay valid, the CPU can still use the data
+static void _EthBufferCacheWriteback(const void* pBuff, int nBytes)
+{
+    const uint8_t* pLine = (const uint8_t*)((uint32_t)pBuff & ~(CACHE_LINE_SIZE - 1));
+    const uint8_t* pEnd = (const uint8_t*)pBuff + nBytes;
+
+    for(; pLine < pEnd; pLine += CACHE_LINE_SIZE)
+    {   // hit writeback order
+        __asm__ __volatile__ ("cache 0x19, 0(%0)" ::"r"(pLine));
+    }
+    __asm__ __volatile__ ("sync");
+}
+
+// RX: drops the buffer lines
+// Before the DMA owns the buffer so that no dirty line is evicted over the received data
+// and after the DMA is done so that the CPU does not read stale lines
+static void _EthBufferCacheInvalidate(const void* pBuff, int nBytes)
+{
+    const uint8_t* pLine = (const uint8_t*)((uint32_t)pBuff & ~(CACHE_LINE_SIZE - 1));
+    const uint8_t* pEnd = (const uint8_t*)pBuff + nBytes;
+
+    for(; pLine < pEnd; pLine += CACHE_LINE_SIZE)
+    {   // hit invalidate order
+        __asm__ __volatile__ ("cache 0x11, 0(%0)" ::"r"(pLine));
+    }
+    __asm__ __volatile__ ("sync");
+}
+#else
+#define _EthBufferCacheWriteback(pBuff, nBytes)
+#define _EthBufferCacheInvalidate(pBuff, nBytes)
+#endif  // defined(__PIC32MZ__)
+
 static void  _EnetPoolFreeDcptList(DRV_ETHMAC_DCPT_LIST* pList, DRV_ETHMAC_DCPT_FreeF fFree, void* fParam);
 static DRV_ETHMAC_DCPT_NODE* _EnetFindPacket(const void* pBuff, DRV_ETHMAC_DCPT_LIST* pList);
 static int _EnetDescriptorsCount(DRV_ETHMAC_DCPT_LIST* pList, bool isHwCtrl);
@@ -506,6 +544,7 @@ DRV_ETHMAC_RESULT DRV_ETHMAC_LibRxBuffersAppend(DRV_ETHMAC_INSTANCE_DCPT* pMacD,
         if(IS_KVA0(pBuff))
         {
             pEDcpt->hwDcpt.hdr.kv0=1;
+            _EthBufferCacheInvalidate(pBuff, pMacD->mData.macConfig.rxBuffSize);
         }
         else if(!IS_KVA(pBuff))
         {
@@ -583,6 +622,7 @@ static DRV_ETHMAC_RESULT _EthTxSchedBuffer(DRV_ETHMAC_INSTANCE_DCPT* pMacD, cons
         if(IS_KVA0(pBuff))
         {
             pEDcpt->hwDcpt.hdr.kv0=1;
+            _EthBufferCacheWriteback(pBuff, nBytes);
         }
         DRV_ETHMAC_LIB_ListAddTail(pList, pEDcpt);
         res=DRV_ETHMAC_RES_OK;
@@ -904,6 +944,10 @@ static DRV_ETHMAC_RESULT _EthRxAckBuffer(DRV_ETHMAC_INSTANCE_DCPT* pMacD, const
         {
             // add it to the busy list...
             pEDcpt->hwDcpt.hdr.SOP=pEDcpt->hwDcpt.hdr.EOP=pEDcpt->hwDcpt.hdr.rx_wack=0;
+            if(pEDcpt->hwDcpt.hdr.kv0)
+            {   // the buffer may have been written while processed
+                _EthBufferCacheInvalidate(PA_TO_KVA0((uint32_t)pEDcpt->hwDcpt.pEDBuff), pMacD->mData.macConfig.rxBuffSize);
+            }
             pEDcpt->hwDcpt.hdr.EOWN=1;  // hw owned
             DRV_ETHMAC_LIB_ListAddTail(pStickyList, pEDcpt);
         }
@@ -1052,6 +1096,10 @@ DRV_ETHMAC_RESULT DRV_ETHMAC_LibRxGetPacket(DRV_ETHMAC_INSTANCE_DCPT* pMacD, DRV
                 {
                     pBuffDcpt->pBuff=(pEDcpt->hwDcpt.hdr.kv0?PA_TO_KVA0((uint32_t)pEDcpt->hwDcpt.pEDBuff):PA_TO_KVA1((uint32_t)pEDcpt->hwDcpt.pEDBuff));
                     pBuffDcpt->nBytes=pEDcpt->hwDcpt.hdr.bCount;
+                    if(pEDcpt->hwDcpt.hdr.kv0)
+                    {
+                        _EthBufferCacheInvalidate(pBuffDcpt->pBuff, pBuffDcpt->nBytes);
+                    }
                     pBuffDcpt=pBuffDcpt->next;
                     reportBuffs++;
                 }
@@ -1129,6 +1177,66 @@ DRV_ETHMAC_RESULT DRV_ETHMAC_LibTxPendingBuffersGet(DRV_ETHMAC_INSTANCE_DCPT* pM
 
 }
 
+#if defined(DRV_ETHMAC_CACHE_MEASUREMENT) && defined(__PIC32MZ__)
+#include <cp0defs.h>
+#include "tcpip/src/tcpip_helpers_private.h"
+
+// writes back and drops the buffer lines: the next access misses,
+// as for a buffer just written by the DMA
+static void _EthBufferCacheFlush(const void* pBuff, int nBytes)
+{
+    const uint8_t* pLine = (const uint8_t*)((uint32_t)pBuff & ~(CACHE_LINE_SIZE - 1));
+    const uint8_t* pEnd = (const uint8_t*)pBuff + nBytes;
+
+    for(; pLine < pEnd; pLine += CACHE_LINE_SIZE)
+    {   // hit writeback invalidate order
+        __asm__ __volatile__ ("cache 0x15, 0(%0)" ::"r"(pLine));
+    }
+    __asm__ __volatile__ ("sync");
+}
+
+void DRV_ETHMAC_LibCacheMeasure(void* pBuff, uint16_t nBytes, DRV_ETHMAC_CACHE_MEASURE* pMeas)
+{
+    uint32_t tStart;
+    uint16_t chkUncached, chkCached;
+    // the same memory through both aliases
+    uint8_t* pUncached = (uint8_t*)PA_TO_KVA1(KVA_TO_PA(pBuff));
+    uint8_t* pCached = (uint8_t*)PA_TO_KVA0(KVA_TO_PA(pBuff));
+
+    // uncached: the TCPIP_STACK_HEAP_FLAG_ALLOC_UNCACHED packet buffers
+    tStart = _CP0_GET_COUNT();
+    chkUncached = TCPIP_Helper_CalcIPChecksum(pUncached, nBytes, 0);
+    pMeas->chkUncached = _CP0_GET_COUNT() - tStart;
+
+    tStart = _CP0_GET_COUNT();
+    memcpy(pUncached + nBytes, pUncached, nBytes);
+    pMeas->cpyUncached = _CP0_GET_COUNT() - tStart;
+
+    // cached: the checksum misses on every line, the copy source is then cached
+    _EthBufferCacheFlush(pCached, 2 * nBytes);
+    tStart = _CP0_GET_COUNT();
+    chkCached = TCPIP_Helper_CalcIPChecksum(pCached, nBytes, 0);
+    pMeas->chkCached = _CP0_GET_COUNT() - tStart;
+
+    tStart = _CP0_GET_COUNT();
+    memcpy(pCached + nBytes, pCached, nBytes);
+    pMeas->cpyCached = _CP0_GET_COUNT() - tStart;
+
+    // the maintenance of a TX buffer: the copy is dirty
+    tStart = _CP0_GET_COUNT();
+    _EthBufferCacheWriteback(pCached + nBytes, nBytes);
+    pMeas->wbackCycles = _CP0_GET_COUNT() - tStart;
+
+    // the maintenance of a RX buffer
+    tStart = _CP0_GET_COUNT();
+    _EthBufferCacheInvalidate(pCached, nBytes);
+    pMeas->invCycles = _CP0_GET_COUNT() - tStart;
+
+    pMeas->chkMatch = chkUncached == chkCached;
+    _EthBufferCacheInvalidate(pCached + nBytes, nBytes);
+}
+#endif  // defined(DRV_ETHMAC_CACHE_MEASUREMENT) && defined(__PIC32MZ__)
+
 static int _EnetDescriptorsCount(DRV_ETHMAC_DCPT_LIST* pList, bool isHwCtrl)
 {
     DRV_ETHMAC_DCPT_NODE    *pEDcpt;
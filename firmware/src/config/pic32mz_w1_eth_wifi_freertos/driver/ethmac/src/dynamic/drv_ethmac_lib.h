@@ -1460,6 +1460,66 @@ DRV_ETHMAC_RESULT DRV_ETHMAC_LibRxScheduledBuffersGet(DRV_ETHMAC_INSTANCE_DCPT*
 DRV_ETHMAC_RESULT DRV_ETHMAC_LibTxPendingBuffersGet(DRV_ETHMAC_INSTANCE_DCPT* pMacD, int* pnBuffs);
 
 
+// enables the measurement of the packet data access through the cached and uncached aliases
+// Uses the CP0 count register, SYS_FREQ/2 resolution
+//#define DRV_ETHMAC_CACHE_MEASUREMENT
+
+#if defined(DRV_ETHMAC_CACHE_MEASUREMENT) && defined(__PIC32MZ__)
+
+// core timer counts for one buffer
+typedef struct
+{
+    uint32_t    chkUncached;    // TCPIP_Helper_CalcIPChecksum(), uncached buffer
+    uint32_t    chkCached;      // TCPIP_Helper_CalcIPChecksum(), cached buffer, not in the cache
+    uint32_t    cpyUncached;    // memcpy(), uncached source and destination
+    uint32_t    cpyCached;      // memcpy(), cached source and destination
+    uint32_t    wbackCycles;    // cache write back before a TX DMA
+    uint32_t    invCycles;      // cache invalidate around a RX DMA
+    bool        chkMatch;       // both checksums are equal
+}DRV_ETHMAC_CACHE_MEASURE;
+
+/*******************************************************************************
+  Function:
+    void DRV_ETHMAC_LibCacheMeasure(void* pBuff, uint16_t nBytes, DRV_ETHMAC_CACHE_MEASURE* pMeas)
+
+  Summary:
+    Measures the checksum and copy of a buffer in both cache modes.
+
+  Description:
+    This function times the IP checksum and the copy of nBytes
+    through the uncached (KSEG1) and the cached (KSEG0) alias of the same memory,
+    and the cache maintenance that the cached packet buffers add to a DMA transfer.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pBuff       - buffer of 2 * nBytes, KSEG0 or KSEG1 address, cache line aligned.
+                  The 2nd half is overwritten.
+    nBytes      - bytes to process, multiple of the cache line size
+    pMeas       - address to store the results
+
+  Returns:
+    None
+
+  Example:
+    <code>
+    static uint8_t __attribute__((aligned(16))) measBuff[2 * 1536];
+    DRV_ETHMAC_CACHE_MEASURE meas;
+    DRV_ETHMAC_LibCacheMeasure(measBuff, 1536, &meas);
+    </code>
+
+  Remarks:
+    For debugging only.
+    Should be called with the interrupts disabled, for stable results.
+
+ *****************************************************************************/
+
+void DRV_ETHMAC_LibCacheMeasure(void* pBuff, uint16_t nBytes, DRV_ETHMAC_CACHE_MEASURE* pMeas);
+
+#endif  // defined(DRV_ETHMAC_CACHE_MEASUREMENT) && defined(__PIC32MZ__)
+
+
 
 #endif  // _DRV_ETHMAC_LIB_H_
 
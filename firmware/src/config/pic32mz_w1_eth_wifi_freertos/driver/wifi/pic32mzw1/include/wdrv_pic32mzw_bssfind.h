@@ -652,4 +652,52 @@ uint8_t WDRV_PIC32MZW_BSSFindGetNumBSSResults(DRV_HANDLE handle);
 
 bool WDRV_PIC32MZW_BSSFindInProgress(DRV_HANDLE handle);
 
+//*******************************************************************************
+/*
+  Function:
+    WDRV_PIC32MZW_STATUS WDRV_PIC32MZW_BSSFindCacheLookup
+    (
+        DRV_HANDLE handle,
+        const WDRV_PIC32MZW_SSID *const pSSID,
+        WDRV_PIC32MZW_BSS_INFO *const pBSSInfo
+    )
+
+  Summary:
+    Searches the results of the last scan for a BSS.
+
+  Description:
+    Searches the results of the last completed scan for the BSS with the
+      strongest signal which matches the SSID provided. Results older than
+      WDRV_PIC32MZW_SCAN_RESULT_CACHE_LIFETIME milliseconds are not used.
+
+  Precondition:
+    WDRV_PIC32MZW_Initialize must have been called.
+    WDRV_PIC32MZW_Open must have been called to obtain a valid handle.
+
+  Parameters:
+    handle   - Client handle obtained by a call to WDRV_PIC32MZW_Open.
+    pSSID    - Pointer to SSID to search for.
+    pBSSInfo - Pointer to structure to populate with the BSS information.
+
+  Returns:
+    WDRV_PIC32MZW_STATUS_OK                 - A matching BSS was found.
+    WDRV_PIC32MZW_STATUS_NOT_OPEN           - The driver instance is not open.
+    WDRV_PIC32MZW_STATUS_INVALID_ARG        - The parameters were incorrect.
+    WDRV_PIC32MZW_STATUS_SCAN_IN_PROGRESS   - A scan is in progress.
+    WDRV_PIC32MZW_STATUS_NO_BSS_INFO        - No fresh matching result exists.
+
+  Remarks:
+    The returned BSS context can be used with WDRV_PIC32MZW_BSSConnect to
+      connect on a single channel without a full scan. The lookup always
+      fails if WDRV_PIC32MZW_SCAN_RESULT_CACHE_LIFETIME is 0.
+
+*/
+
+WDRV_PIC32MZW_STATUS WDRV_PIC32MZW_BSSFindCacheLookup
+(
+    DRV_HANDLE handle,
+    const WDRV_PIC32MZW_SSID *const pSSID,
+    WDRV_PIC32MZW_BSS_INFO *const pBSSInfo
+);
+
 #endif /* _WDRV_PIC32MZW_BSSFIND_H */
@@ -2202,42 +2202,45 @@ bool WDRV_PIC32MZW_MACPowerMode(DRV_HANDLE handle, TCPIP_MAC_POWER_MODE pwrMode)
 //*******************************************************************************
 /*
   Function:
-    TCPIP_MAC_RES WDRV_PIC32MZW_MACPacketTx(DRV_HANDLE handle, TCPIP_MAC_PACKET* ptrPacket)
+    static TCPIP_MAC_RES _WDRV_PIC32MZW_MACPacketTxOne
+    (
+        WDRV_PIC32MZW_DCPT *const pDcpt,
+        TCPIP_MAC_PACKET* ptrPacket
+    )
 
   Summary:
-    Send an Ethernet frame via the PIC32MZW.
+    Send a single Ethernet frame via the PIC32MZW.
 
   Description:
-    Takes an Ethernet frame from the TCP/IP stack and schedules it with the
-      PIC32MZW.
+    Copies the frame segments into PIC32MZW packet memory, acknowledges the
+      frame to the stack and schedules it for transmission.
+
+  Precondition:
+    pDcpt and ptrPacket have been validated by WDRV_PIC32MZW_MACPacketTx.
+
+  Parameters:
+    pDcpt     - Pointer to the driver descriptor.
+    ptrPacket - Pointer to the frame to send.
+
+  Returns:
+    TCPIP_MAC_RES_OK if the frame was sent, TCPIP_MAC_RES_OP_ERR otherwise.
+      The frame is not acknowledged on failure.
 
   Remarks:
-    See wdrv_pic32mzw_mac.h for usage information.
+    None.
 
 */
 
-TCPIP_MAC_RES WDRV_PIC32MZW_MACPacketTx(DRV_HANDLE handle, TCPIP_MAC_PACKET* ptrPacket)
+static TCPIP_MAC_RES _WDRV_PIC32MZW_MACPacketTxOne
+(
+    WDRV_PIC32MZW_DCPT *const pDcpt,
+    TCPIP_MAC_PACKET* ptrPacket
+)
 {
-    WDRV_PIC32MZW_DCPT *const pDcpt = (WDRV_PIC32MZW_DCPT *const)handle;
     uint8_t *payLoadPtr;
     int pktLen = 0;
     uint8_t pktTos = 0;
 
-    if ((DRV_HANDLE_INVALID == handle) || (NULL == pDcpt) || (NULL == pDcpt->pMac))
-    {
-        return TCPIP_MAC_RES_PACKET_ERR;
-    }
-
-    if ((NULL == ptrPacket) || (NULL == ptrPacket->pDSeg))
-    {
-        return TCPIP_MAC_RES_PACKET_ERR;
-    }
-
-    if (NULL == pDcpt->pMac->pktAckF)
-    {
-        return TCPIP_MAC_RES_PACKET_ERR;
-    }
-
     TCPIP_MAC_ETHERNET_HEADER *pEthHdr;
 
     pEthHdr = (TCPIP_MAC_ETHERNET_HEADER*)ptrPacket->pMacLayer;
@@ -2352,6 +2355,71 @@ TCPIP_MAC_RES WDRV_PIC32MZW_MACPacketTx(DRV_HANDLE handle, TCPIP_MAC_PACKET* ptr
     return TCPIP_MAC_RES_OK;
 }
 
+//*******************************************************************************
+/*
+  Function:
+    TCPIP_MAC_RES WDRV_PIC32MZW_MACPacketTx(DRV_HANDLE handle, TCPIP_MAC_PACKET* ptrPacket)
+
+  Summary:
+    Send an Ethernet frame via the PIC32MZW.
+
+  Description:
+    Takes an Ethernet frame, or a chain of frames linked through the
+      packet 'next' field, from the TCP/IP stack and schedules them with the
+      PIC32MZW.
+
+  Remarks:
+    See wdrv_pic32mzw_mac.h for usage information.
+
+*/
+
+TCPIP_MAC_RES WDRV_PIC32MZW_MACPacketTx(DRV_HANDLE handle, TCPIP_MAC_PACKET* ptrPacket)
+{
+    WDRV_PIC32MZW_DCPT *const pDcpt = (WDRV_PIC32MZW_DCPT *const)handle;
+    TCPIP_MAC_PACKET *pNextPkt;
+    TCPIP_MAC_RES res;
+
+    if ((DRV_HANDLE_INVALID == handle) || (NULL == pDcpt) || (NULL == pDcpt->pMac))
+    {
+        return TCPIP_MAC_RES_PACKET_ERR;
+    }
+
+    if ((NULL == ptrPacket) || (NULL == ptrPacket->pDSeg))
+    {
+        return TCPIP_MAC_RES_PACKET_ERR;
+    }
+
+    if (NULL == pDcpt->pMac->pktAckF)
+    {
+        return TCPIP_MAC_RES_PACKET_ERR;
+    }
+
+    /* The first frame failure is reported to the caller, which still owns
+       the chain. Once a frame has been accepted the rest of the chain
+       belongs to the driver, so later failures are acknowledged instead. */
+    pNextPkt = ptrPacket->next;
+
+    res = _WDRV_PIC32MZW_MACPacketTxOne(pDcpt, ptrPacket);
+
+    if (TCPIP_MAC_RES_OK != res)
+    {
+        return res;
+    }
+
+    while (NULL != pNextPkt)
+    {
+        ptrPacket = pNextPkt;
+        pNextPkt  = ptrPacket->next;
+
+        if ((NULL == ptrPacket->pDSeg) || (TCPIP_MAC_RES_OK != _WDRV_PIC32MZW_MACPacketTxOne(pDcpt, ptrPacket)))
+        {
+            pDcpt->pMac->pktAckF(ptrPacket, TCPIP_MAC_PKT_ACK_MAC_REJECT_ERR, TCPIP_THIS_MODULE_ID);
+        }
+    }
+
+    return TCPIP_MAC_RES_OK;
+}
+
 //*******************************************************************************
 /*
   Function:
@@ -51,9 +51,16 @@ Microchip or any third party.
 
 #define WDRV_PIC32MZW_SCAN_RESULT_CACHE_NUM_ENTRIES     100
 
+/* Time, in ms, the results of a completed scan may be reused by
+   WDRV_PIC32MZW_BSSFindCacheLookup. 0 disables the lookup. */
+#ifndef WDRV_PIC32MZW_SCAN_RESULT_CACHE_LIFETIME
+#define WDRV_PIC32MZW_SCAN_RESULT_CACHE_LIFETIME        0
+#endif
+
 typedef struct
 {
     int                         numDescrs;
+    uint64_t                    tStored;
     DRV_PIC32MZW_SCAN_RESULTS   bssDescr[WDRV_PIC32MZW_SCAN_RESULT_CACHE_NUM_ENTRIES];
 } WDRV_PIC32MZW_SCAN_RESULT_CACHE;
 
@@ -75,6 +82,137 @@ static const WDRV_PIC32MZW_SEC_MASK map11iToSecMask[] = {
     WDRV_PIC32MZW_SEC_BIT_SAE           //DRV_PIC32MZW_11I_SAE
 };
 
+// *****************************************************************************
+// *****************************************************************************
+// Section: PIC32MZW Driver BSS Find Local Functions
+// *****************************************************************************
+// *****************************************************************************
+
+/* Convert a cached scan result into the public BSS information structure. */
+static void _WDRV_PIC32MZW_BSSFindInfoConvert
+(
+    const DRV_PIC32MZW_SCAN_RESULTS *const pLastBSSScanInfo,
+    WDRV_PIC32MZW_BSS_INFO *const pBSSInfo
+)
+{
+    DRV_PIC32MZW_11I_MASK dot11iInfo;
+
+    /* Copy BSS scan cache to user supplied buffer. */
+    pBSSInfo->ctx.channel       = pLastBSSScanInfo->channel;
+    pBSSInfo->rssi              = pLastBSSScanInfo->rssi;
+    pBSSInfo->ctx.ssid.length   = pLastBSSScanInfo->ssid.length;
+    pBSSInfo->ctx.bssid.valid   = true;
+    pBSSInfo->ctx.cloaked       = false;
+
+    memcpy(pBSSInfo->ctx.bssid.addr, pLastBSSScanInfo->bssid, 6);
+
+    memset(pBSSInfo->ctx.ssid.name, 0, WDRV_PIC32MZW_MAX_SSID_LEN);
+    memcpy(pBSSInfo->ctx.ssid.name, pLastBSSScanInfo->ssid.name, pBSSInfo->ctx.ssid.length);
+
+    /* Derive security capabilities from dot11iInfo field. */
+    dot11iInfo = (DRV_PIC32MZW_11I_MASK)(pLastBSSScanInfo->dot11iInfo);
+    pBSSInfo->secCapabilities = 0;
+    if (DRV_PIC32MZW_PRIVACY == dot11iInfo)
+    {
+        /* Privacy bit and no 11i elements means WEP. */
+        pBSSInfo->secCapabilities |= WDRV_PIC32MZW_SEC_BIT_WEP;
+    }
+    else
+    {
+        /* Convert dot11iInfo bits into WDRV_PIC32MZW_SEC_MASK value. */
+        int count = sizeof(map11iToSecMask)/sizeof(map11iToSecMask[0]);
+        while (count--)
+        {
+            if (dot11iInfo & (1<<count))
+            {
+                pBSSInfo->secCapabilities |= map11iToSecMask[count];
+            }
+        }
+        /* The above mapping sets the WPA2/3 bit based on the setting of
+         * DRV_PIC32MZW_11I_CCMP128. We should require DRV_PIC32MZW_11I_RSNE
+         * to be set also. */
+        if (!(dot11iInfo & DRV_PIC32MZW_11I_RSNE))
+        {
+            pBSSInfo->secCapabilities &= ~WDRV_PIC32MZW_SEC_BIT_WPA2OR3;
+        }
+    }
+
+    /* Derive recommended auth type for connection. Start with default (invalid). */
+    pBSSInfo->authTypeRecommended = WDRV_PIC32MZW_AUTH_TYPE_DEFAULT;
+
+    /* If no security is offered then we must use Open. */
+    if (0 == dot11iInfo)
+    {
+        pBSSInfo->authTypeRecommended = WDRV_PIC32MZW_AUTH_TYPE_OPEN;
+    }
+    /* If WEP is offered then we must use WEP. */
+    else if (
+            (DRV_PIC32MZW_PRIVACY == dot11iInfo)
+        ||  (dot11iInfo & DRV_PIC32MZW_11I_WEP)
+    )
+    {
+        pBSSInfo->authTypeRecommended = WDRV_PIC32MZW_AUTH_TYPE_WEP;
+    }
+    /* Otherwise if TKIP is offered, then we must use WPA2 compatibility mode. */
+    else if (
+            (dot11iInfo & DRV_PIC32MZW_11I_TKIP)
+        ||  !(dot11iInfo & DRV_PIC32MZW_11I_RSNE)
+    )
+    {
+#ifdef WDRV_PIC32MZW_ENTERPRISE_SUPPORT
+        if (dot11iInfo & DRV_PIC32MZW_11I_1X)
+        {
+            pBSSInfo->authTypeRecommended = WDRV_PIC32MZW_AUTH_TYPE_WPAWPA2_ENTERPRISE;
+        }
+        else
+#endif
+        if (dot11iInfo & DRV_PIC32MZW_11I_PSK)
+        {
+            pBSSInfo->authTypeRecommended = WDRV_PIC32MZW_AUTH_TYPE_WPAWPA2_PERSONAL;
+        }
+    }
+    /* Otherwise check CCMP-128 is offered and recommend WPA2 or WPA3. */
+    else if (dot11iInfo & DRV_PIC32MZW_11I_CCMP128)
+    {
+        /* WPA3-Personal if available. */
+#ifdef WDRV_PIC32MZW_WPA3_PERSONAL_SUPPORT
+        if (
+                (dot11iInfo & DRV_PIC32MZW_11I_SAE)
+            &&  (dot11iInfo & DRV_PIC32MZW_11I_BIPCMAC128)
+        )
+        {
+            pBSSInfo->authTypeRecommended = WDRV_PIC32MZW_AUTH_TYPE_WPA3_PERSONAL;
+        }
+        else
+#endif
+        /* Otherwise Enterprise if available. */
+#ifdef WDRV_PIC32MZW_ENTERPRISE_SUPPORT
+        if (dot11iInfo & DRV_PIC32MZW_11I_1X)
+        {
+            /* If AP _requires_ MFP then we can use WPA3-only.               */
+            /* Note that MFP _capability_ is not sufficient - that does not  */
+            /* guarantee support for AKM suite 5.                            */
+            if (dot11iInfo & DRV_PIC32MZW_11I_MFP_REQUIRED)
+            {
+                pBSSInfo->authTypeRecommended = WDRV_PIC32MZW_AUTH_TYPE_WPA3_ENTERPRISE;
+            }
+            /* Otherwise WPA3-only might not work, so use WPA3 transition. */
+            else
+            {
+                pBSSInfo->authTypeRecommended = WDRV_PIC32MZW_AUTH_TYPE_WPA2WPA3_ENTERPRISE;
+            }
+        }
+        else
+#endif
+        /* Otherwise WPA2-Personal. */
+        if (dot11iInfo & DRV_PIC32MZW_11I_PSK)
+        {
+            pBSSInfo->authTypeRecommended = WDRV_PIC32MZW_AUTH_TYPE_WPA2_PERSONAL;
+        }
+    }
+
+}
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: PIC32MZW Driver BSS Find Implementations
@@ -431,7 +569,6 @@ WDRV_PIC32MZW_STATUS WDRV_PIC32MZW_BSSFindGetInfo
 {
     WDRV_PIC32MZW_DCPT *const pDcpt = (WDRV_PIC32MZW_DCPT *const)handle;
     DRV_PIC32MZW_SCAN_RESULTS *pLastBSSScanInfo;
-    DRV_PIC32MZW_11I_MASK dot11iInfo;
 
     /* Ensure the driver handle and user pointer is valid. */
     if ((DRV_HANDLE_INVALID == handle) || (NULL == pDcpt) || (NULL == pDcpt->pCtrl) || (NULL == pBSSInfo))
@@ -457,119 +594,7 @@ WDRV_PIC32MZW_STATUS WDRV_PIC32MZW_BSSFindGetInfo
         return WDRV_PIC32MZW_STATUS_NO_BSS_INFO;
     }
 
-    /* Copy BSS scan cache to user supplied buffer. */
-    pBSSInfo->ctx.channel       = pLastBSSScanInfo->channel;
-    pBSSInfo->rssi              = pLastBSSScanInfo->rssi;
-    pBSSInfo->ctx.ssid.length   = pLastBSSScanInfo->ssid.length;
-    pBSSInfo->ctx.bssid.valid   = true;
-    pBSSInfo->ctx.cloaked       = false;
-
-    memcpy(pBSSInfo->ctx.bssid.addr, pLastBSSScanInfo->bssid, 6);
-
-    memset(pBSSInfo->ctx.ssid.name, 0, WDRV_PIC32MZW_MAX_SSID_LEN);
-    memcpy(pBSSInfo->ctx.ssid.name, pLastBSSScanInfo->ssid.name, pBSSInfo->ctx.ssid.length);
-
-    /* Derive security capabilities from dot11iInfo field. */
-    dot11iInfo = (DRV_PIC32MZW_11I_MASK)(pLastBSSScanInfo->dot11iInfo);
-    pBSSInfo->secCapabilities = 0;
-    if (DRV_PIC32MZW_PRIVACY == dot11iInfo)
-    {
-        /* Privacy bit and no 11i elements means WEP. */
-        pBSSInfo->secCapabilities |= WDRV_PIC32MZW_SEC_BIT_WEP;
-    }
-    else
-    {
-        /* Convert dot11iInfo bits into WDRV_PIC32MZW_SEC_MASK value. */
-        int count = sizeof(map11iToSecMask)/sizeof(map11iToSecMask[0]);
-        while (count--)
-        {
-            if (dot11iInfo & (1<<count))
-            {
-                pBSSInfo->secCapabilities |= map11iToSecMask[count];
-            }
-        }
-        /* The above mapping sets the WPA2/3 bit based on the setting of
-         * DRV_PIC32MZW_11I_CCMP128. We should require DRV_PIC32MZW_11I_RSNE
-         * to be set also. */
-        if (!(dot11iInfo & DRV_PIC32MZW_11I_RSNE))
-        {
-            pBSSInfo->secCapabilities &= ~WDRV_PIC32MZW_SEC_BIT_WPA2OR3;
-        }
-    }
-
-    /* Derive recommended auth type for connection. Start with default (invalid). */
-    pBSSInfo->authTypeRecommended = WDRV_PIC32MZW_AUTH_TYPE_DEFAULT;
-
-    /* If no security is offered then we must use Open. */
-    if (0 == dot11iInfo)
-    {
-        pBSSInfo->authTypeRecommended = WDRV_PIC32MZW_AUTH_TYPE_OPEN;
-    }
-    /* If WEP is offered then we must use WEP. */
-    else if (
-            (DRV_PIC32MZW_PRIVACY == dot11iInfo)
-        ||  (dot11iInfo & DRV_PIC32MZW_11I_WEP)
-    )
-    {
-        pBSSInfo->authTypeRecommended = WDRV_PIC32MZW_AUTH_TYPE_WEP;
-    }
-    /* Otherwise if TKIP is offered, then we must use WPA2 compatibility mode. */
-    else if (
-            (dot11iInfo & DRV_PIC32MZW_11I_TKIP)
-        ||  !(dot11iInfo & DRV_PIC32MZW_11I_RSNE)
-    )
-    {
-#ifdef WDRV_PIC32MZW_ENTERPRISE_SUPPORT
-        if (dot11iInfo & DRV_PIC32MZW_11I_1X)
-        {
-            pBSSInfo->authTypeRecommended = WDRV_PIC32MZW_AUTH_TYPE_WPAWPA2_ENTERPRISE;
-        }
-        else
-#endif
-        if (dot11iInfo & DRV_PIC32MZW_11I_PSK)
-        {
-            pBSSInfo->authTypeRecommended = WDRV_PIC32MZW_AUTH_TYPE_WPAWPA2_PERSONAL;
-        }
-    }
-    /* Otherwise check CCMP-128 is offered and recommend WPA2 or WPA3. */
-    else if (dot11iInfo & DRV_PIC32MZW_11I_CCMP128)
-    {
-        /* WPA3-Personal if available. */
-#ifdef WDRV_PIC32MZW_WPA3_PERSONAL_SUPPORT
-        if (
-                (dot11iInfo & DRV_PIC32MZW_11I_SAE)
-            &&  (dot11iInfo & DRV_PIC32MZW_11I_BIPCMAC128)
-        )
-        {
-            pBSSInfo->authTypeRecommended = WDRV_PIC32MZW_AUTH_TYPE_WPA3_PERSONAL;
-        }
-        else
-#endif
-        /* Otherwise Enterprise if available. */
-#ifdef WDRV_PIC32MZW_ENTERPRISE_SUPPORT
-        if (dot11iInfo & DRV_PIC32MZW_11I_1X)
-        {
-            /* If AP _requires_ MFP then we can use WPA3-only.               */
-            /* Note that MFP _capability_ is not sufficient - that does not  */
-            /* guarantee support for AKM suite 5.                            */
-            if (dot11iInfo & DRV_PIC32MZW_11I_MFP_REQUIRED)
-            {
-                pBSSInfo->authTypeRecommended = WDRV_PIC32MZW_AUTH_TYPE_WPA3_ENTERPRISE;
-            }
-            /* Otherwise WPA3-only might not work, so use WPA3 transition. */
-            else
-            {
-                pBSSInfo->authTypeRecommended = WDRV_PIC32MZW_AUTH_TYPE_WPA2WPA3_ENTERPRISE;
-            }
-        }
-        else
-#endif
-        /* Otherwise WPA2-Personal. */
-        if (dot11iInfo & DRV_PIC32MZW_11I_PSK)
-        {
-            pBSSInfo->authTypeRecommended = WDRV_PIC32MZW_AUTH_TYPE_WPA2_PERSONAL;
-        }
-    }
+    _WDRV_PIC32MZW_BSSFindInfoConvert(pLastBSSScanInfo, pBSSInfo);
 
     return WDRV_PIC32MZW_STATUS_OK;
 }
@@ -860,6 +885,102 @@ bool WDRV_PIC32MZW_BSSFindInProgress(DRV_HANDLE handle)
     return pDcpt->pCtrl->scanInProgress;
 }
 
+//*******************************************************************************
+/*
+  Function:
+    WDRV_PIC32MZW_STATUS WDRV_PIC32MZW_BSSFindCacheLookup
+    (
+        DRV_HANDLE handle,
+        const WDRV_PIC32MZW_SSID *const pSSID,
+        WDRV_PIC32MZW_BSS_INFO *const pBSSInfo
+    )
+
+  Summary:
+    Searches the results of the last scan for a BSS.
+
+  Description:
+    Returns the strongest BSS matching the SSID from the results of the last
+      completed scan, provided those results are not older than
+      WDRV_PIC32MZW_SCAN_RESULT_CACHE_LIFETIME.
+
+  Remarks:
+    See wdrv_pic32mzw_bssfind.h for usage information.
+
+*/
+
+WDRV_PIC32MZW_STATUS WDRV_PIC32MZW_BSSFindCacheLookup
+(
+    DRV_HANDLE handle,
+    const WDRV_PIC32MZW_SSID *const pSSID,
+    WDRV_PIC32MZW_BSS_INFO *const pBSSInfo
+)
+{
+    WDRV_PIC32MZW_DCPT *const pDcpt = (WDRV_PIC32MZW_DCPT *const)handle;
+    const DRV_PIC32MZW_SCAN_RESULTS *pScanInfo;
+    const DRV_PIC32MZW_SCAN_RESULTS *pBestScanInfo;
+    OSAL_CRITSECT_DATA_TYPE critSect;
+    int index;
+
+    /* Ensure the driver handle and user pointers are valid. */
+    if ((DRV_HANDLE_INVALID == handle) || (NULL == pDcpt) || (NULL == pDcpt->pCtrl) || (NULL == pSSID) || (NULL == pBSSInfo))
+    {
+        return WDRV_PIC32MZW_STATUS_INVALID_ARG;
+    }
+
+    /* Ensure the driver instance has been opened for use. */
+    if ((false == pDcpt->isOpen) || (DRV_HANDLE_INVALID == pDcpt->pCtrl->handle))
+    {
+        return WDRV_PIC32MZW_STATUS_NOT_OPEN;
+    }
+
+    /* The cache is being rebuilt while a scan is in progress. */
+    if (true == pDcpt->pCtrl->scanInProgress)
+    {
+        return WDRV_PIC32MZW_STATUS_SCAN_IN_PROGRESS;
+    }
+
+    pBestScanInfo = NULL;
+
+    critSect = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+
+    if ((0 != WDRV_PIC32MZW_SCAN_RESULT_CACHE_LIFETIME) && (0 != scanResultCache.numDescrs))
+    {
+        uint64_t tAge = SYS_TIME_Counter64Get() - scanResultCache.tStored;
+
+        if (tAge < ((uint64_t)SYS_TIME_FrequencyGet() * WDRV_PIC32MZW_SCAN_RESULT_CACHE_LIFETIME) / 1000)
+        {
+            for (index = 0; index < scanResultCache.numDescrs; index++)
+            {
+                pScanInfo = &scanResultCache.bssDescr[index];
+
+                if ((0 == pScanInfo->ofTotal) || (pScanInfo->ssid.length != pSSID->length))
+                {
+                    continue;
+                }
+
+                if (0 != memcmp(pScanInfo->ssid.name, pSSID->name, pSSID->length))
+                {
+                    continue;
+                }
+
+                if ((NULL == pBestScanInfo) || (pScanInfo->rssi > pBestScanInfo->rssi))
+                {
+                    pBestScanInfo = pScanInfo;
+                }
+            }
+        }
+    }
+
+    if (NULL != pBestScanInfo)
+    {
+        _WDRV_PIC32MZW_BSSFindInfoConvert(pBestScanInfo, pBSSInfo);
+    }
+
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, critSect);
+
+    return (NULL != pBestScanInfo) ? WDRV_PIC32MZW_STATUS_OK : WDRV_PIC32MZW_STATUS_NO_BSS_INFO;
+}
+
 //*******************************************************************************
 /*
   Function:
@@ -900,6 +1021,7 @@ bool DRV_PIC32MZW_StoreBSSScanResult(const DRV_PIC32MZW_SCAN_RESULTS *const pSca
     {
         memset(&scanResultCache, 0, sizeof(WDRV_PIC32MZW_SCAN_RESULT_CACHE));
         scanResultCache.numDescrs = pScanResult->ofTotal;
+        scanResultCache.tStored   = SYS_TIME_Counter64Get();
     }
 
     memcpy(&scanResultCache.bssDescr[pScanResult->index], pScanResult, sizeof(DRV_PIC32MZW_SCAN_RESULTS));
@@ -406,6 +406,8 @@ const TCPIP_MAC_BRIDGE_CONFIG  tcpipBridgeInitData =
     // advanced
     .bridgePermTableSize = 0,
     .bridgePermTable = 0,
+    .vlanTableSize = 0,
+    .vlanTable = 0,
 
 };
 
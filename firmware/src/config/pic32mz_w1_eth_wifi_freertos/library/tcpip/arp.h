@@ -733,6 +733,67 @@ size_t          TCPIP_ARP_CacheEntriesNoGet(TCPIP_NET_HANDLE hNet, TCPIP_ARP_ENT
 */
 TCPIP_ARP_RESULT TCPIP_ARP_CacheThresholdSet(TCPIP_NET_HANDLE hNet, int purgeThres, int purgeEntries);
 
+// *****************************************************************************
+/* Function
+    bool TCPIP_ARP_WarmSnapshot(void);
+
+   Summary:
+    Requests a snapshot of the solved ARP cache entries for a warm start.
+
+   Description:
+    This function requests the ARP module to copy the complete entries of all the ARP caches
+    to a checksummed persistent RAM area.
+    After a soft reset, the ARP initialization restores these entries
+    if the snapshot is valid and the ARP configuration did not change.
+    A restored entry expires after at most TCPIP_ARP_WARM_RESTORE_TMO seconds.
+
+   Precondition:
+    The ARP module should have been initialized.
+    ARP warm start enabled (TCPIP_ARP_WARM_START != 0).
+
+   Parameters:
+    None.
+
+   Returns:
+    - On Success - true, the snapshot is requested
+    - On Failure - false (the ARP module is not running or the warm start is not enabled)
+
+   Remarks:
+    The ARP module takes a snapshot every TCPIP_ARP_WARM_SNAPSHOT_RATE seconds.
+    Call this function before an orderly software reset to save the latest cache contents.
+
+    The snapshot is taken by the ARP task, at its next timeout
+    (TCPIP_ARP_TASK_PROCESS_RATE), not by the caller.
+    Use TCPIP_ARP_WarmSnapshotPending() to wait for it before resetting.
+*/
+bool TCPIP_ARP_WarmSnapshot(void);
+
+// *****************************************************************************
+/* Function
+    bool TCPIP_ARP_WarmSnapshotPending(void);
+
+   Summary:
+    Checks if a requested warm start snapshot has not been taken yet.
+
+   Description:
+    This function returns true while a snapshot requested with TCPIP_ARP_WarmSnapshot()
+    is waiting for the ARP task.
+
+   Precondition:
+    The ARP module should have been initialized.
+
+   Parameters:
+    None.
+
+   Returns:
+    - true  - the snapshot is pending
+    - false - no snapshot is pending or the warm start is not enabled
+
+   Remarks:
+    None.
+*/
+bool TCPIP_ARP_WarmSnapshotPending(void);
+
 // *****************************************************************************
 /* Function:
     void  TCPIP_ARP_Task(void)
@@ -192,6 +192,46 @@ typedef struct
                                                     // size is given by ntpServersNo
 }TCPIP_DHCP_INFO;
 
+// *****************************************************************************
+/* Structure: TCPIP_DHCP_STEP_TIMEOUTS
+
+  Summary:
+    DHCP client per step time-outs.
+
+  Description:
+    This data structure is used for the run time adjustment
+    of the time-outs of the individual lease acquisition steps.
+    All values are in milliseconds.
+ */
+typedef struct
+{
+    uint16_t    initRebootTmo;      // time to wait for the server reply to an INIT-REBOOT request
+                                    // before falling back to DISCOVER
+                                    // 0 means use the exponential back-off DHCP time-out
+    uint16_t    requestTmo;         // time to wait for the server ACK to a REQUEST for an offered lease
+                                    // 0 means use the exponential back-off DHCP time-out
+    uint16_t    leaseCheckTmo;      // time to wait for an ARP conflict on a new lease
+                                    // 0 means skip the lease verification
+}TCPIP_DHCP_STEP_TIMEOUTS;
+
+// *****************************************************************************
+/* Structure: TCPIP_DHCP_LEASE_DATA
+
+  Summary:
+    DHCP client lease data to be saved across reboots.
+
+  Description:
+    This data structure is used to retrieve the current DHCP lease
+    and to restore it after a reboot, so that the client can
+    confirm it with an INIT-REBOOT request instead of going
+    through the whole DISCOVER/OFFER/REQUEST exchange.
+ */
+typedef struct
+{
+    IPV4_ADDR                   leaseAddress;       // IPv4 address held by the lease
+    uint32_t                    leaseRemaining;     // lease time still left, seconds
+}TCPIP_DHCP_LEASE_DATA;
+
 // *****************************************************************************
 /*
   Type:
@@ -559,6 +599,120 @@ bool TCPIP_DHCP_IsBound(TCPIP_NET_HANDLE hNet);
 bool TCPIP_DHCP_RequestTimeoutSet(TCPIP_NET_HANDLE hNet, uint16_t initTmo, 
                                   uint16_t dhcpBaseTmo);
 
+// *****************************************************************************
+/* Function:
+    bool TCPIP_DHCP_StepTimeoutsSet(TCPIP_NET_HANDLE hNet, const TCPIP_DHCP_STEP_TIMEOUTS* pStepTmo)
+
+  Summary:
+    Sets the DHCP client per step time-out values.
+
+  Description:
+    This function allows the run time adjustment of the time-outs
+    used for the INIT-REBOOT request, the REQUEST for an offered lease
+    and the ARP verification of a new lease.
+
+  Precondition:
+    The DHCP module must be initialized.
+
+  Parameters:
+    hNet     - Interface handle
+    pStepTmo - pointer to the new time-out values
+
+  Returns:
+    - true  - if successful
+    - false - if a wrong interface handle or a null pointer was provided 
+
+  Remarks:
+    The build time defaults are TCPIP_DHCP_INIT_REBOOT_TMO,
+    TCPIP_DHCP_REQUEST_ACK_TMO and TCPIP_DHCP_ARP_LEASE_CHECK_TMO.
+ */
+bool TCPIP_DHCP_StepTimeoutsSet(TCPIP_NET_HANDLE hNet, const TCPIP_DHCP_STEP_TIMEOUTS* pStepTmo);
+
+// *****************************************************************************
+/* Function:
+    bool TCPIP_DHCP_StepTimeoutsGet(TCPIP_NET_HANDLE hNet, TCPIP_DHCP_STEP_TIMEOUTS* pStepTmo)
+
+  Summary:
+    Returns the DHCP client per step time-out values.
+
+  Description:
+    This function returns the time-outs currently used
+    for the individual lease acquisition steps.
+
+  Precondition:
+    The DHCP module must be initialized.
+
+  Parameters:
+    hNet     - Interface handle
+    pStepTmo - address to store the time-out values
+
+  Returns:
+    - true  - if successful
+    - false - if a wrong interface handle or a null pointer was provided 
+ */
+bool TCPIP_DHCP_StepTimeoutsGet(TCPIP_NET_HANDLE hNet, TCPIP_DHCP_STEP_TIMEOUTS* pStepTmo);
+
+// *****************************************************************************
+/* Function:
+    bool TCPIP_DHCP_LeaseGet(TCPIP_NET_HANDLE hNet, TCPIP_DHCP_LEASE_DATA* pLease)
+
+  Summary:
+    Returns the current DHCP lease.
+
+  Description:
+    This function returns the address and the remaining time
+    of the lease the client currently holds.
+    The application can save this data in non-volatile memory,
+    for example when the DHCP_EVENT_BOUND event is received,
+    and pass it to TCPIP_DHCP_LeaseRestore after a reboot.
+
+  Precondition:
+    The DHCP module must be initialized.
+
+  Parameters:
+    hNet   - Interface handle
+    pLease - address to store the lease data
+
+  Returns:
+    - true  - if the client is bound and the data was returned
+    - false - if a wrong interface handle was provided or there is no valid lease
+ */
+bool TCPIP_DHCP_LeaseGet(TCPIP_NET_HANDLE hNet, TCPIP_DHCP_LEASE_DATA* pLease);
+
+// *****************************************************************************
+/* Function:
+    bool TCPIP_DHCP_LeaseRestore(TCPIP_NET_HANDLE hNet, const TCPIP_DHCP_LEASE_DATA* pLease)
+
+  Summary:
+    Restores a previously saved DHCP lease.
+
+  Description:
+    This function passes a lease saved before a reboot to the DHCP client.
+    If the client does not hold a lease yet, it will try to confirm
+    the restored address with an INIT-REBOOT request (RFC 2131 3.2)
+    and will fall back to DISCOVER if the server does not answer
+    or declines the request.
+
+  Precondition:
+    The DHCP module must be initialized.
+    The DHCP client must be enabled on the interface.
+
+  Parameters:
+    hNet   - Interface handle
+    pLease - the saved lease data
+
+  Returns:
+    - true  - if the lease was accepted
+    - false - if a wrong interface handle or lease data was provided,
+              the client is already past the discovery phase
+              or TCPIP_DHCP_USE_INIT_REBOOT is not enabled
+
+  Remarks:
+    The leaseRemaining field should be adjusted by the application
+    with the time spent while the system was down, if known.
+ */
+bool TCPIP_DHCP_LeaseRestore(TCPIP_NET_HANDLE hNet, const TCPIP_DHCP_LEASE_DATA* pLease);
+
 
 
 // *****************************************************************************
@@ -211,6 +211,7 @@ typedef enum
     TCPIP_DNS_RES_CACHE_FULL          = -8,   // the cache is full and no entry could be added
     TCPIP_DNS_RES_INVALID_HOSTNAME    = -9,   // Invalid hostname
     TCPIP_DNS_RES_SOCKET_ERROR       = -10,   // DNS UDP socket error: not ready, TX error, etc.
+    TCPIP_DNS_RES_NAME_ERROR         = -11,   // the name does not exist; cached server answer
 }TCPIP_DNS_RESULT;
 
 
@@ -305,6 +306,10 @@ typedef struct
     uint16_t            pendingEntries;                 // number of entries that need to be solved
     uint16_t            currentEntries;                 // number of solved and unslolved name entries
     uint16_t            totalEntries;                   // total number of supported name entries
+    uint32_t            cacheHits;                      // resolve requests answered from the cache
+    uint32_t            cacheMisses;                    // resolve requests that needed a server query
+    uint32_t            negativeHits;                   // resolve requests answered by a cached name error
+    uint32_t            prefetchQueries;                // cache entries refreshed before their expiration
 }TCPIP_DNS_CLIENT_INFO;
 
 // *****************************************************************************
@@ -337,12 +342,21 @@ typedef struct
     TCPIP_DNS_RES_OK          - success, name is solved.
     TCPIP_DNS_RES_PENDING     - operation is ongoing
     TCPIP_DNS_RES_NAME_IS_IPADDRESS   - name request is a IPv4 or IPv6 address
+    TCPIP_DNS_RES_NAME_ERROR  - cached answer: the name does not exist
 
     or an error code if an error occurred
     
   Remarks:
     To clear the cache use TCPIP_DNS_Disable(hNet, true);
 
+    Solved entries that are still in use are refreshed ahead of their expiration
+    when TCPIP_DNS_CLIENT_PREFETCH_PERCENT != 0.
+    The previous answer stays valid until the refresh completes.
+
+    Name errors are cached as per RFC 2308, for at most
+    TCPIP_DNS_CLIENT_NEGATIVE_CACHE_TMO seconds.
+    Use TCPIP_DNS_Send_Query or TCPIP_DNS_RemoveEntry to override a cached name error.
+
   */
 TCPIP_DNS_RESULT  TCPIP_DNS_Resolve(const char* hostName, TCPIP_DNS_RESOLVE_TYPE type);
 
@@ -376,6 +390,7 @@ TCPIP_DNS_RESULT  TCPIP_DNS_Resolve(const char* hostName, TCPIP_DNS_RESOLVE_TYPE
     - TCPIP_DNS_RES_PENDING - The resolution process is still in progress
     - TCPIP_DNS_RES_SERVER_TMO - DNS server timed out
     - TCPIP_DNS_RES_NO_NAME_ENTRY - no such entry to be resolved exists
+    - TCPIP_DNS_RES_NAME_ERROR - the server reported that the name does not exist
 
   Remarks:
     The function will set either an IPv6 or an IPv4 address to the hostIP address,
@@ -417,6 +432,7 @@ TCPIP_DNS_RESULT  TCPIP_DNS_IsResolved(const char* hostName, IP_MULTI_ADDRESS* h
     - TCPIP_DNS_RES_PENDING - The resolution process is still in progress
     - TCPIP_DNS_RES_SERVER_TMO - DNS server timed out
     - TCPIP_DNS_RES_NO_NAME_ENTRY - no such entry to be resolved exists
+    - TCPIP_DNS_RES_NAME_ERROR - the server reported that the name does not exist
 
   Remarks:
     The function will set either an IPv6 or an IPv4 address to the hostIP address,
@@ -81,6 +81,10 @@ typedef struct
 
     TCPIP_MAC_PACKET*   pMacPkt;             // packet that we use to send requests ARP requests
                                              // only ONE packet is used for now even if there are multiple interfaces!!!
+#if (_TCPIP_ARP_WARM_START != 0)
+    uint32_t            warmSnapSec;         // ARP time of the last warm start snapshot
+    volatile uint8_t    warmSnapReq;         // TCPIP_ARP_WarmSnapshot() request, taken by the ARP timeout
+#endif  // (_TCPIP_ARP_WARM_START != 0)
 }ARP_MODULE_DCPT;
 
 
@@ -90,6 +94,11 @@ static ARP_MODULE_DCPT arpMod = { 0 };
 
 static TCPIP_MAC_ADDR             arpBcastAdd = { {0xff, 0xff, 0xff, 0xff, 0xff, 0xff} };
 
+#if (_TCPIP_ARP_WARM_START != 0)
+// solved entries saved across a soft reset; not cleared by the start up code
+static ARP_WARM_SNAPSHOT    arpWarmSnap __attribute__((persistent));
+#endif  // (_TCPIP_ARP_WARM_START != 0)
+
 #ifdef TCPIP_STACK_USE_ZEROCONF_LINK_LOCAL
 #define MAX_REG_APPS            2           // MAX num allowed registrations of Modules/Apps
 static struct arp_app_callbacks reg_apps[MAX_REG_APPS]; // Call-Backs storage for MAX of two Modules/Apps
@@ -129,6 +138,14 @@ static TCPIP_MAC_PACKET* _ARPAllocateTxPacket(void);
 static void         _ARPTxAckFnc (TCPIP_MAC_PACKET * pPkt, const void * param);
 
 static void         TCPIP_ARP_Timeout(void);
+
+#if (_TCPIP_ARP_WARM_START != 0)
+static void         _ARPWarmSnapshot(void);
+static void         _ARPWarmRestore(ARP_CACHE_DCPT* pArpDcpt);
+#else
+#define             _ARPWarmSnapshot()
+#define             _ARPWarmRestore(pArpDcpt)
+#endif  // (_TCPIP_ARP_WARM_START != 0)
 static void         TCPIP_ARP_Process(void);
 
 
@@ -664,6 +681,8 @@ bool TCPIP_ARP_Initialize(const TCPIP_STACK_MODULE_CTRL* const stackCtrl, const
                 hashDcpt->hEntrySize = sizeof(ARP_HASH_ENTRY);
                 hashDcpt->hEntries = arpData->cacheEntries;
                 hashDcpt->probeStep = ARP_HASH_PROBE_STEP;
+                // the entries are linked in the ARP lists, they cannot move
+                hashDcpt->hFlags = OA_HASH_FLAG_NONE;
 
 #if defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
                 hashDcpt->hashF = TCPIP_ARP_HashKeyHash;
@@ -726,6 +745,9 @@ bool TCPIP_ARP_Initialize(const TCPIP_STACK_MODULE_CTRL* const stackCtrl, const
         _ARPRemoveCacheEntries(pArpDcpt);
     }
     // else do not re-initialize
+
+    // get back what was solved before a soft reset
+    _ARPWarmRestore(pArpDcpt);
     
     arpMod.initCount++;
 
@@ -1063,7 +1085,176 @@ static void TCPIP_ARP_Timeout(void)
         pArpDcpt++;  
     } 
 
+#if (_TCPIP_ARP_WARM_START != 0)
+    if(arpMod.warmSnapReq != 0 || arpMod.timeSeconds - arpMod.warmSnapSec >= TCPIP_ARP_WARM_SNAPSHOT_RATE)
+    {
+        _ARPWarmSnapshot();
+    }
+#endif  // (_TCPIP_ARP_WARM_START != 0)
+}
+
+#if (_TCPIP_ARP_WARM_START != 0)
+// ARP cache warm start
+// the solved entries are kept in persistent RAM
+// so that after a soft reset the stack doesn't have to ARP again for all its peers
+
+// hash of the ARP configuration the snapshot depends on
+static uint16_t _ARPWarmCfgHash(void)
+{
+    uint32_t cfgData[4];
+
+    cfgData[0] = (uint32_t)arpMod.nIfs;
+    cfgData[1] = (uint32_t)arpMod.arpCacheDcpt->hashDcpt->hEntries;
+    cfgData[2] = arpMod.entrySolvedTmo;
+    cfgData[3] = (uint32_t)sizeof(ARP_WARM_SNAPSHOT);
+
+    return TCPIP_Helper_CalcIPChecksum((const uint8_t*)cfgData, sizeof(cfgData), 0);
+}
+
+static uint16_t _ARPWarmChecksum(const ARP_WARM_SNAPSHOT* pSnap)
+{
+    return TCPIP_Helper_CalcIPChecksum((const uint8_t*)&pSnap->cfgHash, sizeof(*pSnap) - offsetof(ARP_WARM_SNAPSHOT, cfgHash), 0);
+}
+
+// saves the complete entries of all the ARP caches
+// runs in the ARP task, the only one that changes the caches
+static void _ARPWarmSnapshot(void)
+{
+    int cacheIx;
+    ARP_HASH_ENTRY  *pE;
+    ARP_CACHE_DCPT  *pArpDcpt;
+    SGL_LIST_NODE   *pN;
+    ARP_WARM_SNAPSHOT* pSnap = &arpWarmSnap;
+    ARP_WARM_ENTRY* pWarm = pSnap->entries;
+    ARP_WARM_ENTRY* pEnd = pSnap->entries + sizeof(pSnap->entries) / sizeof(*pSnap->entries);
+
+    // invalidate first, a reset in the middle leaves nothing behind
+    pSnap->magic = 0;
+
+    for(cacheIx = 0, pArpDcpt = arpMod.arpCacheDcpt; cacheIx < arpMod.nIfs; cacheIx++, pArpDcpt++)
+    {
+        for(pN = pArpDcpt->completeList.list.head; pN != 0 && pWarm < pEnd; pN = pN->next)
+        {
+            pE = (ARP_HASH_ENTRY*) ((uint8_t*)pN - offsetof(struct _TAG_ARP_HASH_ENTRY, next));
+            pWarm->ipAddress.Val = pE->ipAddress.Val;
+            pWarm->hwAdd = pE->hwAdd;
+            pWarm->cacheIx = (uint8_t)cacheIx;
+            pWarm->reserved = 0;
+            pWarm->age = arpMod.timeSeconds - pE->tInsert;
+            pWarm++;
+        }
+    }
+
+    pSnap->nEntries = pWarm - pSnap->entries;
+    memset(pWarm, 0, (pEnd - pWarm) * sizeof(*pWarm));
+    pSnap->reserved = 0;
+    pSnap->cfgHash = _ARPWarmCfgHash();
+    pSnap->checksum = _ARPWarmChecksum(pSnap);
+    pSnap->magic = ARP_WARM_MAGIC;
+
+    arpMod.warmSnapSec = arpMod.timeSeconds;
+    arpMod.warmSnapReq = 0;
+}
+
+// restores the saved complete entries of an ARP cache
+// the entries are aged with the snapshot rate
+// and their remaining lifetime is limited to TCPIP_ARP_WARM_RESTORE_TMO
+// if the cache cannot take all of them, the oldest ones are dropped
+static void _ARPWarmRestore(ARP_CACHE_DCPT* pArpDcpt)
+{
+    int ix, nSkip;
+    uint32_t age;
+    ARP_HASH_ENTRY  *arpHE;
+    const ARP_WARM_ENTRY* pWarm;
+    ARP_WARM_SNAPSHOT* pSnap = &arpWarmSnap;
+    uint8_t cacheIx = pArpDcpt - arpMod.arpCacheDcpt;
+
+    arpMod.warmSnapSec = arpMod.timeSeconds;
+
+    if(pSnap->magic != ARP_WARM_MAGIC || pSnap->nEntries > sizeof(pSnap->entries) / sizeof(*pSnap->entries))
+    {   // nothing saved
+        return;
+    }
+
+    if(pSnap->checksum != _ARPWarmChecksum(pSnap) || pSnap->cfgHash != _ARPWarmCfgHash())
+    {   // corrupted or different configuration
+        return;
+    }
+
+    // do not go over the purge threshold
+    nSkip = (int)pArpDcpt->hashDcpt->fullSlots - (int)pArpDcpt->purgeThres;
+    for(ix = 0, pWarm = pSnap->entries; ix < pSnap->nEntries; ix++, pWarm++)
+    {
+        if(pWarm->cacheIx == cacheIx)
+        {
+            nSkip++;
+        }
+    }
+
+    for(ix = 0, pWarm = pSnap->entries; ix < pSnap->nEntries; ix++, pWarm++)
+    {
+        if(pWarm->cacheIx != cacheIx)
+        {
+            continue;
+        }
+
+        if(nSkip > 0)
+        {   // older entry, no room
+            nSkip--;
+            continue;
+        }
+
+        age = pWarm->age + TCPIP_ARP_WARM_SNAPSHOT_RATE;
+        if(age >= arpMod.entrySolvedTmo || pWarm->ipAddress.Val == 0)
+        {   // expired
+            continue;
+        }
+
+        if(arpMod.entrySolvedTmo - age > TCPIP_ARP_WARM_RESTORE_TMO)
+        {
+            age = arpMod.entrySolvedTmo - TCPIP_ARP_WARM_RESTORE_TMO;
+        }
+
+        arpHE = (ARP_HASH_ENTRY*)TCPIP_OAHASH_EntryLookupOrInsert(pArpDcpt->hashDcpt, &pWarm->ipAddress.Val);
+        if(arpHE == 0 || arpHE->hEntry.flags.newEntry == 0)
+        {   // already there
+            continue;
+        }
+
+        // the snapshot is ordered, the completeList stays ordered by tInsert
+        _ARPSetEntry(arpHE, ARP_FLAG_ENTRY_COMPLETE, &pWarm->hwAdd, &pArpDcpt->completeList);
+        arpHE->tInsert = arpMod.timeSeconds - age;
+    }
+}
+
+bool TCPIP_ARP_WarmSnapshot(void)
+{
+    if(arpMod.arpCacheDcpt == 0)
+    {   // not running
+        return false;
+    }
+
+    // the caller may run in any task: the ARP timeout takes the snapshot
+    arpMod.warmSnapReq = 1;
+
+    return true;
+}
+
+bool TCPIP_ARP_WarmSnapshotPending(void)
+{
+    return arpMod.warmSnapReq != 0;
+}
+#else
+bool TCPIP_ARP_WarmSnapshot(void)
+{
+    return false;
+}
+
+bool TCPIP_ARP_WarmSnapshotPending(void)
+{
+    return false;
 }
+#endif  // (_TCPIP_ARP_WARM_START != 0)
 
 static void TCPIP_ARP_Process(void)
 {
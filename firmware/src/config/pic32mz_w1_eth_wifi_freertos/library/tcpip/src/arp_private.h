@@ -142,6 +142,48 @@ typedef struct __attribute__((packed))
 
 
 
+#if defined(TCPIP_ARP_WARM_START) && (TCPIP_ARP_WARM_START != 0)
+#define _TCPIP_ARP_WARM_START   1
+#else
+#define _TCPIP_ARP_WARM_START   0
+#endif
+
+#if (_TCPIP_ARP_WARM_START != 0)
+// rate of the ARP cache warm start snapshots, seconds
+#if !defined(TCPIP_ARP_WARM_SNAPSHOT_RATE)
+#define TCPIP_ARP_WARM_SNAPSHOT_RATE    10
+#endif
+// max lifetime of an entry restored from the snapshot, seconds
+#if !defined(TCPIP_ARP_WARM_RESTORE_TMO)
+#define TCPIP_ARP_WARM_RESTORE_TMO      60
+#endif
+
+#define ARP_WARM_MAGIC      0x41525057u     // "ARPW"
+
+// complete ARP entry saved in persistent RAM
+typedef struct
+{
+    IPV4_ADDR           ipAddress;      // the resolved IP address
+    TCPIP_MAC_ADDR      hwAdd;          // its hardware address
+    uint8_t             cacheIx;        // index of the ARP cache it belongs to
+    uint8_t             reserved;       // padding, 0
+    uint32_t            age;            // seconds since the entry was solved/refreshed
+}ARP_WARM_ENTRY;
+
+// ARP caches snapshot that survives a soft reset
+// the entries are stored in the completeList order, oldest first
+typedef struct
+{
+    uint32_t            magic;          // ARP_WARM_MAGIC if the snapshot is valid
+    uint16_t            checksum;       // checksum of all the following fields
+    uint16_t            cfgHash;        // hash of the ARP configuration the snapshot was taken with
+    uint16_t            nEntries;       // number of valid entries
+    uint16_t            reserved;       // padding, 0
+    ARP_WARM_ENTRY      entries[TCPIP_ARP_CACHE_ENTRIES * TCPIP_STACK_NETWORK_INTERAFCE_COUNT];
+}ARP_WARM_SNAPSHOT;
+#endif  // (_TCPIP_ARP_WARM_START != 0)
+
+
 // ARP event registration
 
 typedef struct  _TAG_ARP_LIST_NODE
@@ -58,6 +58,7 @@ typedef struct
                                             // T1 < T2 < Texp
     uint32_t                t3Seconds;      // # of seconds to wait until reissuing a REQUEST in RENEW/REBIND state
     uint32_t                tOpStart;       // time at which a lease operation is started
+    uint32_t                tLeaseEnd;      // time at which the last granted lease expires - seconds
     uint32_t                dwServerID;     // DHCP Server ID cache
     IPV4_ADDR               lastSrvAddress; // DHCP Server that sent the last message
     IPV4_ADDR               leaseSrvAddress;// DHCP Server that we try to bound to; to avoid using another server that interfered while we're doing ARP...
@@ -83,6 +84,8 @@ typedef struct
     uint16_t                dhcpTmoBase;    // DHCP base timeout
     uint16_t                tOpFailTmo;     // operation failure timeout: initialization, etc.
     uint16_t                tLeaseCheck;    // time to wait for a lease check
+    uint16_t                tInitRebootTmo; // time to wait for the INIT-REBOOT request reply, ms
+    uint16_t                tRequestTmo;    // time to wait for the REQUEST ACK, ms
     uint16_t                dhcpOp;         // DHCP current operation: TCPIP_DHCP_OPERATION_TYPE
 #if (TCPIP_DHCP_DEBUG_MASK & TCPIP_DHCP_DEBUG_MASK_STATUS) != 0
     uint8_t                 smState;        // DHCP client state machine variable: TCPIP_DHCP_STATUS
@@ -94,16 +97,17 @@ typedef struct
     {
         struct
         {
-            uint8_t bDHCPEnabled        : 1;    // Whether or not DHCP is currently enabled
-            uint8_t bIsBound            : 1;    // Whether or not DHCP is currently bound
-            uint8_t bOfferReceived      : 1;    // Whether or not an offer has been received
-            uint8_t bDHCPServerDetected : 1;    // Indicates if a DCHP server has been detected
-            uint8_t bWasBound           : 1;    // successfully held a lease
-            uint8_t bReportFail         : 1;    // report run time failure flag
-            uint8_t bWriteBack          : 1;    // write back the resulting host name
-            uint8_t bRetry              : 1;    // a new cycle/retry because of a failure
+            uint16_t bDHCPEnabled        : 1;    // Whether or not DHCP is currently enabled
+            uint16_t bIsBound            : 1;    // Whether or not DHCP is currently bound
+            uint16_t bOfferReceived      : 1;    // Whether or not an offer has been received
+            uint16_t bDHCPServerDetected : 1;    // Indicates if a DCHP server has been detected
+            uint16_t bWasBound           : 1;    // successfully held a lease
+            uint16_t bReportFail         : 1;    // report run time failure flag
+            uint16_t bWriteBack          : 1;    // write back the resulting host name
+            uint16_t bRetry              : 1;    // a new cycle/retry because of a failure
+            uint16_t bLeaseCheck         : 1;    // bound with the ARP lease verification still pending
         };
-        uint8_t val;
+        uint16_t val;
     } flags;
     // Indicates which DHCP values are currently valid
     union
@@ -153,6 +157,10 @@ static void     _DHCPSetNewLease(DHCP_CLIENT_VARS* pClient, TCPIP_NET_IF* pNetIf
 static unsigned int     _DHCPProcessReceiveData(DHCP_CLIENT_VARS* pClient, TCPIP_NET_IF* pNetIf);
 static void     _DHCPCheckRunFailEvent(TCPIP_NET_IF* pNetIf, DHCP_CLIENT_VARS* pClient);
 static void     _DHCPSetBoundState(DHCP_CLIENT_VARS* pClient);
+static void     _DHCPSetStepTimeout(DHCP_CLIENT_VARS* pClient, uint16_t stepTmo);
+static int      _DHCPLeaseCheck(DHCP_CLIENT_VARS* pClient, TCPIP_NET_IF* pNetIf, IPV4_ADDR* pArpCheck);
+static void     _DHCPLeaseDecline(DHCP_CLIENT_VARS* pClient, TCPIP_NET_IF* pNetIf);
+static TCPIP_DHCP_OPERATION_TYPE _DHCPLinkUpOperation(DHCP_CLIENT_VARS* pClient);
 
 static TCPIP_DHCP_OPTION_RESULT _DHCPOptionProcess(DHCP_CLIENT_VARS* pClient, TCPIP_DHCP_OPTION_PROCESS_DATA* pOptData);
 static int                      _DHCPOptionProcessMsgType(DHCP_CLIENT_VARS* pClient, TCPIP_DHCP_OPTION_PROCESS_DATA* pOptData);
@@ -170,6 +178,10 @@ static int                      _DHCPOptionProcessTimeServer(DHCP_CLIENT_VARS* p
 static int                      _DHCPOptionProcessNtpServer(DHCP_CLIENT_VARS* pClient, TCPIP_DHCP_OPTION_PROCESS_DATA* pOptData);
 #endif  // (TCPIP_DHCP_USE_OPTION_NTP_SERVER != 0)
 
+#if (_TCPIP_DHCP_USE_RAPID_COMMIT != 0)
+static int                      _DHCPOptionProcessRapidCommit(DHCP_CLIENT_VARS* pClient, TCPIP_DHCP_OPTION_PROCESS_DATA* pOptData);
+#endif  // (_TCPIP_DHCP_USE_RAPID_COMMIT != 0)
+
 static int                      _DHCPOptionProcessEnd(DHCP_CLIENT_VARS* pClient, TCPIP_DHCP_OPTION_PROCESS_DATA* pOptData);
 static unsigned int             _DHCPOptionGetMsgType(TCPIP_DHCP_OPTION_PROCESS_DATA* pOptData);
 
@@ -181,6 +193,9 @@ static int                      _DHCPOptionWriteParamRequest(TCPIP_NET_IF* pNetI
 static int                      _DHCPOptionWriteIPRequest(TCPIP_NET_IF* pNetIf, TCPIP_DHCP_OPTION_WRITE_DATA* pSendData);
 static int                      _DHCPOptionHostName(TCPIP_NET_IF* pNetIf, TCPIP_DHCP_OPTION_WRITE_DATA* pSendData);
 static int                      _DHCPOptionClientId(TCPIP_NET_IF* pNetIf, TCPIP_DHCP_OPTION_WRITE_DATA* pSendData);
+#if (_TCPIP_DHCP_USE_RAPID_COMMIT != 0)
+static int                      _DHCPOptionWriteRapidCommit(TCPIP_NET_IF* pNetIf, TCPIP_DHCP_OPTION_WRITE_DATA* pSendData);
+#endif  // (_TCPIP_DHCP_USE_RAPID_COMMIT != 0)
 static int                      _DHCPOptionWriteEnd(TCPIP_NET_IF* pNetIf, TCPIP_DHCP_OPTION_WRITE_DATA* pSendData);
 
 static int                      _DHCPFormatHostName(char* destBuffer, const char* srcBuffer, int destSize);
@@ -216,6 +231,9 @@ static UDP_PORT             dhcpClientPort;
 static UDP_PORT             dhcpServerPort;
 
 static tcpipSignalHandle     dhcpSignalHandle = 0;
+#if (_TCPIP_DHCP_IDLE_TICK_RATE != 0)
+static bool                  dhcpTickIdle = false;  // the DHCP timer runs at the idle rate
+#endif  // (_TCPIP_DHCP_IDLE_TICK_RATE != 0)
 
 static const uint8_t    dhcpMagicCookie[4] = {0x63, 0x82, 0x53, 0x63};      // DHCP cookie, network order
 // DHCP event registration
@@ -302,6 +320,9 @@ static const TCPIP_DHCP_OPTION_PROC_ENTRY   _DHCPOptProcTbl[] =
 #if (TCPIP_DHCP_USE_OPTION_NTP_SERVER != 0)
     {  TCPIP_DHCP_NTP_SERVER,           _DHCPOptionProcessNtpServer },
 #endif  // (TCPIP_DHCP_USE_OPTION_NTP_SERVER != 0)
+#if (_TCPIP_DHCP_USE_RAPID_COMMIT != 0)
+    {  TCPIP_DHCP_RAPID_COMMIT,         _DHCPOptionProcessRapidCommit },
+#endif  // (_TCPIP_DHCP_USE_RAPID_COMMIT != 0)
     {  TCPIP_DHCP_END_OPTION,           _DHCPOptionProcessEnd },
 
 };
@@ -328,6 +349,9 @@ static const TCPIP_DHCP_OPTION_WRITE_ENTRY   _DHCPOptWriteTbl[] =
     {  /* TCPIP_DHCP_PARAM_REQUEST_IP_ADDRESS */ _DHCPOptionWriteIPRequest },
     {  /* TCPIP_DHCP_HOST_NAME */                _DHCPOptionHostName },
     {  /* TCPIP_DHCP_PARAM_REQUEST_CLIENT_ID */  _DHCPOptionClientId },
+#if (_TCPIP_DHCP_USE_RAPID_COMMIT != 0)
+    {  /* TCPIP_DHCP_RAPID_COMMIT */             _DHCPOptionWriteRapidCommit },
+#endif  // (_TCPIP_DHCP_USE_RAPID_COMMIT != 0)
     {  /* TCPIP_DHCP_END_OPTION */               _DHCPOptionWriteEnd },      // always the last!
 };
 
@@ -391,10 +415,25 @@ static void _DHCPDbgStatus(DHCP_CLIENT_VARS* pClient)
 #define _DHCPDbgStatus(pClient)
 #endif  // TCPIP_DHCP_DEBUG_MASK
 
+#if (_TCPIP_DHCP_IDLE_TICK_RATE != 0)
+// idle and bound clients only check the lease times, with 1 second resolution
+static __inline__ bool __attribute__((always_inline)) _DHCPStateIsQuiet(TCPIP_DHCP_STATUS state)
+{
+    return state == TCPIP_DHCP_IDLE || state == TCPIP_DHCP_BOUND;
+}
+#endif  // (_TCPIP_DHCP_IDLE_TICK_RATE != 0)
+
 static __inline__ void __attribute__((always_inline)) _DHCPClientStateSet(DHCP_CLIENT_VARS* pClient, TCPIP_DHCP_STATUS newState)
 {
     pClient->smState = newState;
     _DHCPDbgStatus(pClient);
+#if (_TCPIP_DHCP_IDLE_TICK_RATE != 0)
+    if(dhcpTickIdle && !_DHCPStateIsQuiet(newState))
+    {   // client needs attention; restore the regular timer rate
+        dhcpTickIdle = false;
+        _TCPIPStackSignalHandlerSetParams(TCPIP_THIS_MODULE_ID, dhcpSignalHandle, TCPIP_DHCP_TASK_TICK_RATE);
+    }
+#endif  // (_TCPIP_DHCP_IDLE_TICK_RATE != 0)
 }
 
 #if (TCPIP_DHCP_DEBUG_MASK & TCPIP_DHCP_DEBUG_MASK_ADDRESS_EVENTS) != 0
@@ -507,6 +546,7 @@ static void _DHCPClientClose(TCPIP_NET_IF* pNetIf, bool disable, bool release)
         }
 
         pClient->flags.bIsBound = false;
+        pClient->flags.bLeaseCheck = false;
         pClient->flags.bDHCPServerDetected = false;
         pClient->flags.bReportFail = 1; 
         pClient->tOpStart = 0; 
@@ -646,10 +686,39 @@ static void _DHCPSetTimeout(DHCP_CLIENT_VARS* pClient)
 {
     // add a random variation [-TCPIP_DHCP_EXP_BACKOFF_FUZZ, TCPIP_DHCP_EXP_BACKOFF_FUZZ] seconds
     uint32_t sysFreq = SYS_TMR_TickCounterFrequencyGet();
-    pClient->waitTicks = (pClient->dhcpTmo - TCPIP_DHCP_EXP_BACKOFF_FUZZ) * sysFreq + SYS_RANDOM_PseudoGet() % ((2 * TCPIP_DHCP_EXP_BACKOFF_FUZZ) * sysFreq);
+    pClient->waitTicks = (pClient->dhcpTmo - TCPIP_DHCP_EXP_BACKOFF_FUZZ) * sysFreq + SYS_RANDOM_FastGet() % ((2 * TCPIP_DHCP_EXP_BACKOFF_FUZZ) * sysFreq);
     pClient->startWait = SYS_TMR_TickCountGet();
 }
 
+// sets the timeout for a request step
+// stepTmo is in ms; 0 selects the exponential back-off timeout
+static void _DHCPSetStepTimeout(DHCP_CLIENT_VARS* pClient, uint16_t stepTmo)
+{
+    if(stepTmo == 0)
+    {
+        _DHCPSetTimeout(pClient);
+    }
+    else
+    {
+        pClient->waitTicks = (uint32_t)(((uint64_t)stepTmo * SYS_TMR_TickCounterFrequencyGet()) / 1000);
+        pClient->startWait = SYS_TMR_TickCountGet();
+    }
+}
+
+// returns the operation to start with when the link comes up
+static TCPIP_DHCP_OPERATION_TYPE _DHCPLinkUpOperation(DHCP_CLIENT_VARS* pClient)
+{
+#if (_TCPIP_DHCP_USE_INIT_REBOOT != 0)
+    if(pClient->flags.bWasBound != 0 && (int32_t)(pClient->tLeaseEnd - _TCPIP_SecCountGet()) > 0)
+    {   // the last lease hasn't expired; try to have it confirmed
+        return TCPIP_DHCP_OPER_INIT_REBOOT;
+    }
+    return TCPIP_DHCP_OPER_INIT;
+#else
+    return pClient->flags.bWasBound ? TCPIP_DHCP_OPER_INIT_REBOOT : TCPIP_DHCP_OPER_INIT;
+#endif  // (_TCPIP_DHCP_USE_INIT_REBOOT != 0)
+}
+
 
 
 /*****************************************************************************
@@ -711,6 +780,9 @@ bool TCPIP_DHCP_Initialize(const TCPIP_STACK_MODULE_CTRL* const stackCtrl, const
 
         // create the DHCP timer
         dhcpSignalHandle =_TCPIPStackSignalHandlerRegister(TCPIP_THIS_MODULE_ID, TCPIP_DHCP_Task, TCPIP_DHCP_TASK_TICK_RATE);
+#if (_TCPIP_DHCP_IDLE_TICK_RATE != 0)
+        dhcpTickIdle = false;
+#endif  // (_TCPIP_DHCP_IDLE_TICK_RATE != 0)
         iniRes = TCPIP_Notification_Initialize(&dhcpRegisteredUsers);
         dhcpClientPort = pDhcpConfig->dhcpCliPort;
         dhcpServerPort = pDhcpConfig->dhcpSrvPort;
@@ -743,6 +815,8 @@ bool TCPIP_DHCP_Initialize(const TCPIP_STACK_MODULE_CTRL* const stackCtrl, const
     // set a proper timeout base
     pClient->dhcpTmoBase = (TCPIP_DHCP_EXP_BACKOFF_BASE < TCPIP_DHCP_EXP_BACKOFF_FUZZ + 1) ? TCPIP_DHCP_EXP_BACKOFF_FUZZ + 1 : TCPIP_DHCP_EXP_BACKOFF_BASE;
     pClient->tLeaseCheck = TCPIP_DHCP_ARP_LEASE_CHECK_TMO;
+    pClient->tInitRebootTmo = _TCPIP_DHCP_INIT_REBOOT_TMO;
+    pClient->tRequestTmo = _TCPIP_DHCP_REQUEST_ACK_TMO;
     
 #if (TCPIP_DHCP_DEBUG_MASK & TCPIP_DHCP_DEBUG_MASK_FAKE_TMO) != 0
     pClient->dhcpTmoBase = _dhcpDbgBaseTmo;
@@ -1082,6 +1156,71 @@ bool TCPIP_DHCP_RequestTimeoutSet(TCPIP_NET_HANDLE hNet, uint16_t initTmo, uint1
     return false;
 }
 
+bool TCPIP_DHCP_StepTimeoutsSet(TCPIP_NET_HANDLE hNet, const TCPIP_DHCP_STEP_TIMEOUTS* pStepTmo)
+{
+    TCPIP_NET_IF* pNetIf = _TCPIPStackHandleToNetUp(hNet);
+    if(DHCPClients && pNetIf && pStepTmo)
+    {
+        DHCP_CLIENT_VARS* pClient = DHCPClients + TCPIP_STACK_NetIxGet(pNetIf);
+        pClient->tInitRebootTmo = pStepTmo->initRebootTmo;
+        pClient->tRequestTmo = pStepTmo->requestTmo;
+        pClient->tLeaseCheck = pStepTmo->leaseCheckTmo;
+        return true;
+    }
+    return false;
+}
+
+bool TCPIP_DHCP_StepTimeoutsGet(TCPIP_NET_HANDLE hNet, TCPIP_DHCP_STEP_TIMEOUTS* pStepTmo)
+{
+    TCPIP_NET_IF* pNetIf = _TCPIPStackHandleToNetUp(hNet);
+    if(DHCPClients && pNetIf && pStepTmo)
+    {
+        DHCP_CLIENT_VARS* pClient = DHCPClients + TCPIP_STACK_NetIxGet(pNetIf);
+        pStepTmo->initRebootTmo = pClient->tInitRebootTmo;
+        pStepTmo->requestTmo = pClient->tRequestTmo;
+        pStepTmo->leaseCheckTmo = pClient->tLeaseCheck;
+        return true;
+    }
+    return false;
+}
+
+bool TCPIP_DHCP_LeaseGet(TCPIP_NET_HANDLE hNet, TCPIP_DHCP_LEASE_DATA* pLease)
+{
+    TCPIP_NET_IF* pNetIf = _TCPIPStackHandleToNetUp(hNet);
+    if(DHCPClients && pNetIf && pLease)
+    {
+        DHCP_CLIENT_VARS* pClient = DHCPClients + TCPIP_STACK_NetIxGet(pNetIf);
+        int32_t leaseLeft = (int32_t)(pClient->tLeaseEnd - _TCPIP_SecCountGet());
+        if(pClient->flags.bIsBound != 0 && leaseLeft > 0)
+        {
+            pLease->leaseAddress.Val = pClient->dhcpIPAddress.Val;
+            pLease->leaseRemaining = (uint32_t)leaseLeft;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TCPIP_DHCP_LeaseRestore(TCPIP_NET_HANDLE hNet, const TCPIP_DHCP_LEASE_DATA* pLease)
+{
+#if (_TCPIP_DHCP_USE_INIT_REBOOT != 0)
+    TCPIP_NET_IF* pNetIf = _TCPIPStackHandleToNetUp(hNet);
+    if(DHCPClients && pNetIf && pLease && pLease->leaseAddress.Val != 0 && pLease->leaseRemaining != 0)
+    {
+        DHCP_CLIENT_VARS* pClient = DHCPClients + TCPIP_STACK_NetIxGet(pNetIf);
+        if(pClient->flags.bDHCPEnabled != 0 && pClient->smState <= TCPIP_DHCP_GET_OFFER)
+        {   // no lease yet; start over with the restored one
+            pClient->dhcpIPAddress.Val = pLease->leaseAddress.Val;
+            pClient->tLeaseEnd = _TCPIP_SecCountGet() + pLease->leaseRemaining;
+            pClient->flags.bWasBound = true;
+            _DHCPEnable(pNetIf, TCPIP_DHCP_OPER_INIT_REBOOT);
+            return true;
+        }
+    }
+#endif  // (_TCPIP_DHCP_USE_INIT_REBOOT != 0)
+    return false;
+}
+
 
 void TCPIP_DHCP_Task(void)
 {
@@ -1121,6 +1260,9 @@ static void TCPIP_DHCP_Process(bool isTmo)
     DHCP_CLIENT_VARS*   pClient;
     int                 netIx, nNets;
     TCPIP_NET_IF*       pNetIf;
+#if (_TCPIP_DHCP_IDLE_TICK_RATE != 0)
+    bool                tickQuiet = true;
+#endif  // (_TCPIP_DHCP_IDLE_TICK_RATE != 0)
 
     nNets = TCPIP_STACK_NumberOfNetworksGet();
     for(netIx = 0; netIx < nNets; netIx++) 
@@ -1231,7 +1373,7 @@ static void TCPIP_DHCP_Process(bool isTmo)
                 pClient->tRequest = _TCPIP_SecCountGet();
                 _DHCPNotifyClients(pNetIf, DHCP_EVENT_REQUEST, 0, 0);
                 // Start a timer and begin looking for a response
-                _DHCPSetTimeout(pClient);
+                _DHCPSetStepTimeout(pClient, (pClient->dhcpOp == TCPIP_DHCP_OPER_INIT_REBOOT) ? pClient->tInitRebootTmo : pClient->tRequestTmo);
                 _DHCPClientStateSet(pClient, TCPIP_DHCP_GET_REQUEST_ACK);
                 break;
 
@@ -1240,9 +1382,10 @@ static void TCPIP_DHCP_Process(bool isTmo)
                 if(_DHCPProcessReceiveData(pClient, pNetIf) == TCPIP_DHCP_TIMEOUT_MESSAGE)
                 {   // no data available
                     // Go back and retransmit a new discovery if we didn't get an ACK
+                    // an unanswered INIT-REBOOT doesn't count as a failure for the back-off
                     if((SYS_TMR_TickCountGet() - pClient->startWait) >= pClient->waitTicks)
                     {
-                        _DHCPSetRunFail(pClient, TCPIP_DHCP_SEND_DISCOVERY, true);
+                        _DHCPSetRunFail(pClient, TCPIP_DHCP_SEND_DISCOVERY, pClient->dhcpOp != TCPIP_DHCP_OPER_INIT_REBOOT);
                         _DHCPNotifyClients(pNetIf, DHCP_EVENT_TIMEOUT, 0, 0);
                     }
                 }
@@ -1251,51 +1394,23 @@ static void TCPIP_DHCP_Process(bool isTmo)
             case TCPIP_DHCP_WAIT_LEASE_CHECK:
                 // check for an ARP entry
                 {
-                    bool arpChkFail = false;
-                    bool arpChkSuccess = false;
                     IPV4_ADDR arpCheck;
+                    int chkRes = _DHCPLeaseCheck(pClient, pNetIf, &arpCheck);
 
-                    arpCheck.Val = pClient->dhcpIPAddress.Val;
-#if (TCPIP_DHCP_DEBUG_MASK & TCPIP_DHCP_DEBUG_MASK_FAIL_ARP) != 0
-                    if(_dhcpDbgFakeArpAddress != 0)
-                    {
-                        arpCheck.Val = _dhcpDbgFakeArpAddress;
-                    }
-#endif  // TCPIP_DHCP_DEBUG_MASK
-
-                    if(TCPIP_ARP_IsResolved(pNetIf, &arpCheck, 0))
-                    {   // oooops, someone else with this address!
-                        arpChkFail = true;
+                    if(chkRes > 0)
+                    {   // validation success
+                        _DHCPSetNewLease(pClient, pNetIf);
                     }
-                    else if((_TCPIP_MsecCountGet() - pClient->startWait) >= pClient->tLeaseCheck)
-                    {   // no ARP conflict
-#if (TCPIP_DHCP_DEBUG_MASK & TCPIP_DHCP_DEBUG_MASK_FAIL_ARP) != 0
-                        if(_dhcpDbgFailArpCheckCnt != 0)
-                        {
-                            _dhcpDbgFailArpCheckCnt--;
-                            arpChkFail = true;
-                        }
-                        else
-#endif  // TCPIP_DHCP_DEBUG_MASK
-                        {   // validation success
-                            _DHCPSetNewLease(pClient, pNetIf);
-                            arpChkSuccess = true;
-                        }
-                    }
-                    // else no timeout yet
                     
-                    if(arpChkFail || arpChkSuccess)
+                    if(chkRes != 0)
                     {   // remove ARP entry so that we can probe it again if DHCP is disabled/enabled
                         // or the lease is lost quicker than the ARP entry expiration timeout    
                         TCPIP_ARP_EntryRemove(pNetIf,  &arpCheck);
                     }
 
-                    if(arpChkFail)
+                    if(chkRes < 0)
                     {   // fail
-                        _DHCPSend(pClient, pNetIf, TCPIP_DHCP_DECLINE_MESSAGE, TCPIP_DHCP_FLAG_SEND_ZERO_ADD | TCPIP_DHCP_FLAG_SEND_BCAST);
-                        _DHCPClientStateSet(pClient, TCPIP_DHCP_WAIT_LEASE_RETRY);
-                        pClient->startWait = _TCPIP_SecCountGet();
-                        _DHCPNotifyClients(pNetIf, DHCP_EVENT_DECLINE, 0, 0);
+                        _DHCPLeaseDecline(pClient, pNetIf);
                     }
                 }
                 break;
@@ -1314,12 +1429,34 @@ static void TCPIP_DHCP_Process(bool isTmo)
                 break;
 
             case TCPIP_DHCP_BOUND:
+#if (_TCPIP_DHCP_USE_OPTIMISTIC_BIND != 0)
+                if(pClient->flags.bLeaseCheck != 0)
+                {   // the lease is already in use but the ARP verification is still running
+                    IPV4_ADDR arpCheck;
+                    int chkRes = _DHCPLeaseCheck(pClient, pNetIf, &arpCheck);
+                    if(chkRes != 0)
+                    {
+                        TCPIP_ARP_EntryRemove(pNetIf,  &arpCheck);
+                        pClient->flags.bLeaseCheck = false;
+                    }
+
+                    if(chkRes < 0)
+                    {   // conflict; give up the address
+                        IPV4_ADDR zeroAdd = {0};
+                        _TCPIPStackSetConfigAddress(pNetIf, &zeroAdd, &zeroAdd, 0, true);
+                        pClient->flags.bIsBound = false;
+                        _DHCPLeaseDecline(pClient, pNetIf);
+                        break;
+                    }
+                }
+#endif  // (_TCPIP_DHCP_USE_OPTIMISTIC_BIND != 0)
                 // check for T1 timeout
                 if((_TCPIP_SecCountGet() - pClient->tRequest) < pClient->t1Seconds)
                 {   // within BOUND state
                     break;
                 }
                 // time for renew
+                pClient->flags.bLeaseCheck = false;
                 _DHCPClientStateSet(pClient, TCPIP_DHCP_SEND_RENEW);
                 // No break
 
@@ -1401,8 +1538,23 @@ static void TCPIP_DHCP_Process(bool isTmo)
                 }
                 break;
         }
+
+#if (_TCPIP_DHCP_IDLE_TICK_RATE != 0)
+        if(!_DHCPStateIsQuiet(pClient->smState) || pClient->flags.bLeaseCheck != 0)
+        {
+            tickQuiet = false;
+        }
+#endif  // (_TCPIP_DHCP_IDLE_TICK_RATE != 0)
     }
 
+#if (_TCPIP_DHCP_IDLE_TICK_RATE != 0)
+    if(tickQuiet != dhcpTickIdle)
+    {   // adjust the timer rate to what the clients need
+        dhcpTickIdle = tickQuiet;
+        _TCPIPStackSignalHandlerSetParams(TCPIP_THIS_MODULE_ID, dhcpSignalHandle, tickQuiet ? _TCPIP_DHCP_IDLE_TICK_RATE : TCPIP_DHCP_TASK_TICK_RATE);
+    }
+#endif  // (_TCPIP_DHCP_IDLE_TICK_RATE != 0)
+
     // everything that needed processing was done; discard leftovers
     TCPIP_UDP_Discard(dhcpClientSocket);
 }
@@ -1564,7 +1716,18 @@ static unsigned int _DHCPReceive(DHCP_CLIENT_VARS* pClient, TCPIP_NET_IF* pNetIf
         }
 
         // check what we got
-        if ( dhcpOptData.msgType == TCPIP_DHCP_OFFER_MESSAGE || (dhcpOptData.msgType == TCPIP_DHCP_ACK_MESSAGE && pClient->dhcpOp == TCPIP_DHCP_OPER_INIT_REBOOT))
+        bool newServer = dhcpOptData.msgType == TCPIP_DHCP_OFFER_MESSAGE || (dhcpOptData.msgType == TCPIP_DHCP_ACK_MESSAGE && pClient->dhcpOp == TCPIP_DHCP_OPER_INIT_REBOOT);
+        if(dhcpOptData.msgType == TCPIP_DHCP_ACK_MESSAGE && pClient->smState == TCPIP_DHCP_GET_OFFER)
+        {   // an ACK to a DISCOVER is valid only with the rapid commit option (RFC 4039)
+            if(dhcpOptData.rapidCommit == 0)
+            {
+                rxErrCode = 8;
+                break;
+            }
+            newServer = true;
+        }
+
+        if (newServer)
         {   // store the current server ID
             pClient->dwServerID = dhcpOptData.serverID.Val;
             pClient->flags.bOfferReceived = true;
@@ -1959,6 +2122,23 @@ static int _DHCPOptionProcessEnd(DHCP_CLIENT_VARS* pClient, TCPIP_DHCP_OPTION_PR
     return 0;   // end detected
 }
 
+#if (_TCPIP_DHCP_USE_RAPID_COMMIT != 0)
+static int _DHCPOptionProcessRapidCommit(DHCP_CLIENT_VARS* pClient, TCPIP_DHCP_OPTION_PROCESS_DATA* pOptData)
+{
+    if(pOptData->optSize >= sizeof(TCPIP_DHCP_OPTION_DATA_RAPID_COMMIT))
+    {
+        TCPIP_DHCP_OPTION_DATA_RAPID_COMMIT* pRapid = (TCPIP_DHCP_OPTION_DATA_RAPID_COMMIT*)pOptData->pOpt;
+        if(pRapid->len == 0)
+        {
+            pOptData->rapidCommit = 1;
+            return sizeof(TCPIP_DHCP_OPTION_DATA_RAPID_COMMIT);
+        }
+    }
+
+    return -1;
+}
+#endif  // (_TCPIP_DHCP_USE_RAPID_COMMIT != 0)
+
 // return the message type from the option data
 static unsigned int _DHCPOptionGetMsgType(TCPIP_DHCP_OPTION_PROCESS_DATA* pOptData)
 {
@@ -2009,7 +2189,7 @@ static unsigned int _DHCPProcessReceiveData(DHCP_CLIENT_VARS* pClient, TCPIP_NET
             }
 #endif  // TCPIP_DHCP_DEBUG_MASK
 
-            if( pClient->smState == TCPIP_DHCP_GET_REQUEST_ACK)
+            if( pClient->smState == TCPIP_DHCP_GET_REQUEST_ACK || pClient->smState == TCPIP_DHCP_GET_OFFER)
             {
                 if(pClient->validValues.IPAddress == 0 || pClient->validValues.Mask == 0)
                 {   // having a new address without a valid mask seems weird
@@ -2017,6 +2197,11 @@ static unsigned int _DHCPProcessReceiveData(DHCP_CLIENT_VARS* pClient, TCPIP_NET
                     break;
                 }
 
+                if(pClient->smState == TCPIP_DHCP_GET_OFFER)
+                {   // rapid commit; there's no REQUEST, the lease starts now
+                    pClient->tRequest = _TCPIP_SecCountGet();
+                }
+
                 // seems we received a new valid lease
                 pClient->leaseSrvAddress.Val = pClient->lastSrvAddress.Val;     // this is the server that granted the lease
                 TCPIP_DHCP_STATUS newState;
@@ -2040,7 +2225,13 @@ static unsigned int _DHCPProcessReceiveData(DHCP_CLIENT_VARS* pClient, TCPIP_NET
                     // not really  ARP_OPERATION_GRATUITOUS but only one single probe needs to go out
                     TCPIP_ARP_Probe(pNetIf, &arpCheck, &zeroAdd, ARP_OPERATION_REQ | ARP_OPERATION_CONFIGURE |  ARP_OPERATION_GRATUITOUS);
                     pClient->startWait = _TCPIP_MsecCountGet();
+#if (_TCPIP_DHCP_USE_OPTIMISTIC_BIND != 0)
+                    // bind now, the conflict check goes on in the bound state
+                    pClient->flags.bLeaseCheck = true;
+                    newState = TCPIP_DHCP_SKIP_LEASE_CHECK;
+#else
                     newState = TCPIP_DHCP_WAIT_LEASE_CHECK;
+#endif  // (_TCPIP_DHCP_USE_OPTIMISTIC_BIND != 0)
                 }
                 _DHCPClientStateSet(pClient, newState);
             }
@@ -2056,6 +2247,8 @@ static unsigned int _DHCPProcessReceiveData(DHCP_CLIENT_VARS* pClient, TCPIP_NET
 
         case TCPIP_DHCP_NAK_MESSAGE:
             dhcpRecvFail = true;
+            // the server doesn't want us to use this lease anymore
+            pClient->tLeaseEnd = _TCPIP_SecCountGet();
             break;
 
         default:
@@ -2226,10 +2419,55 @@ static void _DHCPSetNewLease(DHCP_CLIENT_VARS* pClient, TCPIP_NET_IF* pNetIf)
 
 }
 
+// checks the ARP probe sent for a new lease
+// returns > 0 if the address is free, < 0 if in use, 0 if the check is still pending
+// pArpCheck is updated with the probed address
+static int _DHCPLeaseCheck(DHCP_CLIENT_VARS* pClient, TCPIP_NET_IF* pNetIf, IPV4_ADDR* pArpCheck)
+{
+    pArpCheck->Val = pClient->dhcpIPAddress.Val;
+#if (TCPIP_DHCP_DEBUG_MASK & TCPIP_DHCP_DEBUG_MASK_FAIL_ARP) != 0
+    if(_dhcpDbgFakeArpAddress != 0)
+    {
+        pArpCheck->Val = _dhcpDbgFakeArpAddress;
+    }
+#endif  // TCPIP_DHCP_DEBUG_MASK
+
+    if(TCPIP_ARP_IsResolved(pNetIf, pArpCheck, 0))
+    {   // oooops, someone else with this address!
+        return -1;
+    }
+
+    if((_TCPIP_MsecCountGet() - pClient->startWait) >= pClient->tLeaseCheck)
+    {   // no ARP conflict
+#if (TCPIP_DHCP_DEBUG_MASK & TCPIP_DHCP_DEBUG_MASK_FAIL_ARP) != 0
+        if(_dhcpDbgFailArpCheckCnt != 0)
+        {
+            _dhcpDbgFailArpCheckCnt--;
+            return -1;
+        }
+#endif  // TCPIP_DHCP_DEBUG_MASK
+        return 1;
+    }
+
+    // no timeout yet
+    return 0;
+}
+
+// the lease address is in use; decline it and wait before retrying
+static void _DHCPLeaseDecline(DHCP_CLIENT_VARS* pClient, TCPIP_NET_IF* pNetIf)
+{
+    _DHCPSend(pClient, pNetIf, TCPIP_DHCP_DECLINE_MESSAGE, TCPIP_DHCP_FLAG_SEND_ZERO_ADD | TCPIP_DHCP_FLAG_SEND_BCAST);
+    _DHCPClientStateSet(pClient, TCPIP_DHCP_WAIT_LEASE_RETRY);
+    pClient->startWait = _TCPIP_SecCountGet();
+    pClient->tLeaseEnd = pClient->startWait;    // not to be reused
+    _DHCPNotifyClients(pNetIf, DHCP_EVENT_DECLINE, 0, 0);
+}
+
 static void _DHCPSetBoundState(DHCP_CLIENT_VARS* pClient)
 {
     // store the address of the server that gave us the lease
     pClient->boundSrvAddress.Val = pClient->leaseSrvAddress.Val;
+    pClient->tLeaseEnd = pClient->tRequest + pClient->tExpSeconds;
 
     _DHCPClientStateSet(pClient, TCPIP_DHCP_BOUND);
     pClient->flags.bIsBound = true; 
@@ -2289,8 +2527,8 @@ static void _DHCPSetLeaseTimeParams(DHCP_CLIENT_VARS* pClient, TCPIP_DHCP_OPTION
 
 
     // apply random fuzz
-    pClient->t1Seconds = (t1Time - TCPIP_DHCP_LEASE_EXPIRE_FUZZ) + SYS_RANDOM_PseudoGet() %  (2 * TCPIP_DHCP_LEASE_EXPIRE_FUZZ);
-    pClient->t2Seconds = (t2Time - TCPIP_DHCP_LEASE_EXPIRE_FUZZ) + SYS_RANDOM_PseudoGet() %  (2 * TCPIP_DHCP_LEASE_EXPIRE_FUZZ);
+    pClient->t1Seconds = (t1Time - TCPIP_DHCP_LEASE_EXPIRE_FUZZ) + SYS_RANDOM_FastGet() %  (2 * TCPIP_DHCP_LEASE_EXPIRE_FUZZ);
+    pClient->t2Seconds = (t2Time - TCPIP_DHCP_LEASE_EXPIRE_FUZZ) + SYS_RANDOM_FastGet() %  (2 * TCPIP_DHCP_LEASE_EXPIRE_FUZZ);
 
     // finally set the expire seconds
     pClient->tExpSeconds = leaseTime;
@@ -2379,7 +2617,7 @@ static bool _DHCPSend(DHCP_CLIENT_VARS* pClient, TCPIP_NET_IF* pNetIf, int messa
     {
         if(pClient->flags.bRetry == false)
         {   // generate a new transaction ID
-            pClient->transactionID = SYS_RANDOM_PseudoGet(); 
+            pClient->transactionID = SYS_RANDOM_PoolGet(SYS_RANDOM_POOL_NET_ID); 
         }
         // Reset offered flag so we know to act upon the next valid offer
         pClient->flags.bOfferReceived = false;
@@ -2715,6 +2953,30 @@ static int _DHCPOptionClientId(TCPIP_NET_IF* pNetIf, TCPIP_DHCP_OPTION_WRITE_DAT
 
 }
 
+
+#if (_TCPIP_DHCP_USE_RAPID_COMMIT != 0)
+static int _DHCPOptionWriteRapidCommit(TCPIP_NET_IF* pNetIf, TCPIP_DHCP_OPTION_WRITE_DATA* pSendData)
+{
+    TCPIP_DHCP_OPTION_DATA_RAPID_COMMIT* pRapid;
+
+    if(pSendData->msgType == TCPIP_DHCP_DISCOVER_MESSAGE)
+    {   // ask for the 2 message exchange
+        if(pSendData->writeSpace >= sizeof(*pRapid))
+        {
+            pRapid = (TCPIP_DHCP_OPTION_DATA_RAPID_COMMIT*)pSendData->pOpt;
+            pRapid->opt = TCPIP_DHCP_RAPID_COMMIT;
+            pRapid->len = 0;
+            return sizeof(*pRapid);
+        }
+
+        // not enough room?
+        return -1;
+    }
+
+    // only used for discovery
+    return 0;
+}
+#endif  // (_TCPIP_DHCP_USE_RAPID_COMMIT != 0)
                       
 static int _DHCPOptionWriteEnd(TCPIP_NET_IF* pNetIf, TCPIP_DHCP_OPTION_WRITE_DATA* pSendData)
 {
@@ -2752,7 +3014,7 @@ void TCPIP_DHCP_ConnectionHandler(TCPIP_NET_IF* pNetIf, TCPIP_MAC_EVENT connEven
             // put it in wait connection mode
             // should be in this state anyway
             // but just in case we've missed the link down event
-            _DHCPEnable(pNetIf, pClient->flags.bWasBound ? TCPIP_DHCP_OPER_INIT_REBOOT : TCPIP_DHCP_OPER_INIT);
+            _DHCPEnable(pNetIf, _DHCPLinkUpOperation(pClient));
             _DHCPNotifyClients(pNetIf, DHCP_EVENT_CONN_ESTABLISHED, 0, 0);
         }
     }
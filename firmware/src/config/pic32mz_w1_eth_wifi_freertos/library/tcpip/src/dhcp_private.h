@@ -118,6 +118,7 @@ Microchip or any third party.
 #define TCPIP_DHCP_RENEW_TIME                 (58u) // DHCP RENEW time (T1)
 #define TCPIP_DHCP_REBIND_TIME                (59u) // DHCP REBIND time (T2)
 #define TCPIP_DHCP_NTP_SERVER                 (42u) // DHCP_NTP_SERVER Type
+#define TCPIP_DHCP_RAPID_COMMIT               (80u) // DHCP Rapid Commit, RFC 4039
 
 #define TCPIP_DHCP_END_OPTION                 (255u)    // DHCP_END_OPTION Type
 
@@ -179,6 +180,49 @@ Microchip or any third party.
 // DHCP host name illegal character replacement
 #define TCPIP_DHCP_HOST_REPLACE_CHAR    'x'
 
+// INIT-REBOOT with the last valid lease after a link flap or a lease restore
+#if defined(TCPIP_DHCP_USE_INIT_REBOOT) && (TCPIP_DHCP_USE_INIT_REBOOT != 0)
+#define _TCPIP_DHCP_USE_INIT_REBOOT     1
+#else
+#define _TCPIP_DHCP_USE_INIT_REBOOT     0
+#endif
+
+// time to wait for the server reply to an INIT-REBOOT request; milliseconds
+// 0 means use the exponential back-off DHCP timeout
+#if defined(TCPIP_DHCP_INIT_REBOOT_TMO)
+#define _TCPIP_DHCP_INIT_REBOOT_TMO     TCPIP_DHCP_INIT_REBOOT_TMO
+#else
+#define _TCPIP_DHCP_INIT_REBOOT_TMO     0
+#endif
+
+// time to wait for the server ACK to a REQUEST for an offered lease; milliseconds
+// 0 means use the exponential back-off DHCP timeout
+#if defined(TCPIP_DHCP_REQUEST_ACK_TMO)
+#define _TCPIP_DHCP_REQUEST_ACK_TMO     TCPIP_DHCP_REQUEST_ACK_TMO
+#else
+#define _TCPIP_DHCP_REQUEST_ACK_TMO     0
+#endif
+
+// RFC 4039 two message exchange
+#if defined(TCPIP_DHCP_USE_RAPID_COMMIT) && (TCPIP_DHCP_USE_RAPID_COMMIT != 0)
+#define _TCPIP_DHCP_USE_RAPID_COMMIT    1
+#else
+#define _TCPIP_DHCP_USE_RAPID_COMMIT    0
+#endif
+
+// use a new lease right away and run the ARP conflict check in the bound state
+#if defined(TCPIP_DHCP_USE_OPTIMISTIC_BIND) && (TCPIP_DHCP_USE_OPTIMISTIC_BIND != 0)
+#define _TCPIP_DHCP_USE_OPTIMISTIC_BIND 1
+#else
+#define _TCPIP_DHCP_USE_OPTIMISTIC_BIND 0
+#endif
+
+#if defined(TCPIP_DHCP_IDLE_TICK_RATE) && (TCPIP_DHCP_IDLE_TICK_RATE > TCPIP_DHCP_TASK_TICK_RATE)
+#define _TCPIP_DHCP_IDLE_TICK_RATE      TCPIP_DHCP_IDLE_TICK_RATE
+#else
+#define _TCPIP_DHCP_IDLE_TICK_RATE      0
+#endif
+
 
 // DHCP or BOOTP Header structure
 typedef struct
@@ -227,6 +271,7 @@ typedef struct
     TCPIP_UINT32_VAL    leaseTime;  // lease time or 0 if not valid
     TCPIP_UINT32_VAL    renewTime;  // renew time or 0 if not valid
     TCPIP_UINT32_VAL    rebindTime; // rebind time or 0 if not valid
+    unsigned int        rapidCommit;// rapid commit option present
 }TCPIP_DHCP_OPTION_PROCESS_DATA;
 
 typedef struct __attribute__((packed))
@@ -337,6 +382,13 @@ typedef struct __attribute__((packed))
 }TCPIP_DHCP_OPTION_DATA_REBIND_TIME;
 
 
+typedef struct __attribute__((packed))
+{
+    uint8_t     opt;        // should be TCPIP_DHCP_RAPID_COMMIT
+    uint8_t     len;        // 0
+}TCPIP_DHCP_OPTION_DATA_RAPID_COMMIT;
+
+
 typedef struct __attribute__((packed))
 {
     uint8_t     opt;        // should be TCPIP_DHCP_PARAM_REQUEST_LIST
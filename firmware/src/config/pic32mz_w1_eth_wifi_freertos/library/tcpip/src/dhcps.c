@@ -410,6 +410,8 @@ bool TCPIP_DHCPS_Initialize(const TCPIP_STACK_MODULE_CTRL* const stackCtrl, cons
         hashDcpt->hEntrySize = sizeof(DHCPS_HASH_ENTRY);
         hashDcpt->hEntries = pDhcpsConfig->leaseEntries;
         hashDcpt->probeStep = DHCPS_HASH_PROBE_STEP;
+        // the leased address is derived from the bucket index
+        hashDcpt->hFlags = OA_HASH_FLAG_NONE;
 
         hashDcpt->hashF= TCPIP_DHCPS_MACHashKeyHash;
 #if defined(OA_DOUBLE_HASH_PROBING)
@@ -87,8 +87,10 @@ static void                 _DNSClientCleanup(TCPIP_DNS_DCPT* pDnsDcpt);
 #define _DNSClientCleanup(pDnsDcpt)
 #endif  // (TCPIP_STACK_DOWN_OPERATION != 0)
 static TCPIP_DNS_HASH_ENTRY *_DNSHashEntryFromTransactionId(TCPIP_DNS_DCPT* pDnsDcpt, const char* hostName, uint16_t transactionId);
-static bool                 _DNS_RESPONSE_HashEntryUpdate(TCPIP_DNS_RX_DATA* dnsRxData, TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* dnsHE);
+static bool                 _DNS_RESPONSE_HashEntryUpdate(TCPIP_DNS_RR_PROCESS* pProc, TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* dnsHE);
 static int                  _DNS_GetAddresses(const char* hostName, int startIndex, IP_MULTI_ADDRESS* pIPAddr, int nIPAddresses, TCPIP_DNS_ADDRESS_REC_MASK recMask);
+static uint32_t             _DNS_EntryTimeout(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* pDnsHE);
+static void                 _DNS_RetriesInit(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* pDnsHE);
 
 
 
@@ -255,8 +257,8 @@ static void _DNS_CleanCacheEntry(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY*
 {
     if(pDnsHE->hEntry.flags.busy)
     {
-        if((pDnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_COMPLETE) == 0)
-        {   // deleting an unsolved entry
+        if((pDnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_COMPLETE) == 0 || (pDnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_PREFETCH) != 0)
+        {   // deleting an unsolved or refreshing entry
             pDnsDcpt->unsolvedEntries--;
             _DNSAssertCond(pDnsDcpt->unsolvedEntries >= 0, __func__, __LINE__);
         }
@@ -291,7 +293,7 @@ static void _DNS_UpdateExpiredHashEntry_Notify(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_D
 static  TCPIP_DNS_RESULT  _DNSCompleteHashEntry(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* dnsHE)
 {
      
-    dnsHE->hEntry.flags.value &= ~TCPIP_DNS_FLAG_ENTRY_TIMEOUT;
+    dnsHE->hEntry.flags.value &= ~(TCPIP_DNS_FLAG_ENTRY_TIMEOUT | TCPIP_DNS_FLAG_ENTRY_PREFETCH | TCPIP_DNS_FLAG_ENTRY_NEGATIVE);
     dnsHE->hEntry.flags.value |= TCPIP_DNS_FLAG_ENTRY_COMPLETE;
     dnsHE->recordMask = TCPIP_DNS_ADDRESS_REC_NONE;
 
@@ -315,6 +317,41 @@ static  TCPIP_DNS_RESULT  _DNSCompleteHashEntry(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_
     return TCPIP_DNS_RES_OK;
 }
 
+#if (_TCPIP_DNS_CLIENT_NEGATIVE_CACHE_TMO != 0)
+// solved entry that caches a name error
+// ipTTL is the negative caching time
+static void _DNSCompleteNegativeHashEntry(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* dnsHE, uint32_t negTTL)
+{
+    dnsHE->nIPv4Entries = dnsHE->nIPv6Entries = 0;
+    dnsHE->ipTTL.Val = negTTL;
+    _DNSCompleteHashEntry(pDnsDcpt, dnsHE);
+    dnsHE->hEntry.flags.value |= TCPIP_DNS_FLAG_ENTRY_NEGATIVE;
+}
+#endif  // (_TCPIP_DNS_CLIENT_NEGATIVE_CACHE_TMO != 0)
+
+// returns the lifetime of a solved entry, seconds
+static uint32_t _DNS_EntryTimeout(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* pDnsHE)
+{
+    // if cacheEntryTMO is equal to zero, then TTL time is the timeout period. 
+    // a name error is always kept for its negative TTL
+    if(pDnsDcpt->cacheEntryTMO == 0 || (pDnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_NEGATIVE) != 0)
+    {
+        return pDnsHE->ipTTL.Val;
+    }
+
+    return pDnsDcpt->cacheEntryTMO;
+}
+
+// sets the retries for a new query of the entry
+// if a strict interface, we try only on that; otherwise on all
+static void _DNS_RetriesInit(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* pDnsHE)
+{
+    int retryIfs = (pDnsDcpt->strictNet == 0) ? TCPIP_STACK_NumberOfNetworksGet() : 1;
+    pDnsHE->tRetry = pDnsDcpt->dnsTime;
+    pDnsHE->currRetry = 0;
+    pDnsHE->nRetries = retryIfs * _TCPIP_DNS_IF_RETRY_COUNT;
+}
+
 static  void _DNSDeleteCacheEntries(TCPIP_DNS_DCPT* pDnsDcpt)
 {
     size_t          bktIx;
@@ -404,6 +441,8 @@ bool TCPIP_DNS_ClientInitialize(const TCPIP_STACK_MODULE_CTRL* const stackData,
         hashDcpt->hEntrySize = sizeof(TCPIP_DNS_HASH_ENTRY);
         hashDcpt->hEntries = dnsData->cacheEntries;
         hashDcpt->probeStep = TCPIP_DNS_HASH_PROBE_STEP;
+        // each bucket owns its preallocated address buffers
+        hashDcpt->hFlags = OA_HASH_FLAG_NONE;
 
         hashDcpt->hashF = TCPIP_DNS_OAHASH_KeyHash;
         hashDcpt->delF = TCPIP_DNS_OAHASH_DeleteEntry;
@@ -671,24 +710,38 @@ static TCPIP_DNS_RESULT _DNS_Resolve(const char* hostName, TCPIP_DNS_RESOLVE_TYP
 
     if(forceQuery == 0 && dnsHE->hEntry.flags.newEntry == 0)
     {   // already in hash
+        if((dnsHE->hEntry.flags.value & (TCPIP_DNS_FLAG_ENTRY_COMPLETE | TCPIP_DNS_FLAG_ENTRY_NEGATIVE)) == (TCPIP_DNS_FLAG_ENTRY_COMPLETE | TCPIP_DNS_FLAG_ENTRY_NEGATIVE))
+        {   // cached name error, whatever the type
+            pDnsDcpt->negativeHits++;
+            return TCPIP_DNS_RES_NAME_ERROR;
+        }
+
         if((dnsHE->recordMask & recMask) == recMask)
         {   // already have the requested type
             if((dnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_COMPLETE) != 0)
             {
-               return TCPIP_DNS_RES_OK; 
+                dnsHE->hEntry.flags.value |= TCPIP_DNS_FLAG_ENTRY_ACCESSED;
+                pDnsDcpt->cacheHits++;
+                return TCPIP_DNS_RES_OK; 
             }
             return (dnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_TIMEOUT) == 0 ? TCPIP_DNS_RES_PENDING : TCPIP_DNS_RES_SERVER_TMO; 
         }
         // else new query is needed, for new type
     }
 
+    if(forceQuery == 0)
+    {
+        pDnsDcpt->cacheMisses++;
+    }
+
     // this is a forced/new entry/query
     // update entry parameters
     if(dnsHE->hEntry.flags.newEntry != 0)
     {
         dnsHE->nIPv4Entries = 0;
         dnsHE->nIPv6Entries = 0;
-        dnsHE->hEntry.flags.value &= ~(TCPIP_DNS_FLAG_ENTRY_COMPLETE | TCPIP_DNS_FLAG_ENTRY_TIMEOUT);
+        dnsHE->hEntry.flags.value &= ~(TCPIP_DNS_FLAG_ENTRY_COMPLETE | TCPIP_DNS_FLAG_ENTRY_TIMEOUT | TCPIP_DNS_FLAG_ENTRY_PREFETCH | TCPIP_DNS_FLAG_ENTRY_NEGATIVE | TCPIP_DNS_FLAG_ENTRY_ACCESSED);
+        pDnsDcpt->unsolvedEntries++;
     }
     else
     {   // forced
@@ -700,17 +753,17 @@ static TCPIP_DNS_RESULT _DNS_Resolve(const char* hostName, TCPIP_DNS_RESOLVE_TYP
         {
             dnsHE->nIPv6Entries = 0;
         }
-        dnsHE->hEntry.flags.value &= ~TCPIP_DNS_FLAG_ENTRY_COMPLETE;
+        if((dnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_COMPLETE) != 0 && (dnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_PREFETCH) == 0)
+        {   // a pending or refreshing entry is already counted
+            pDnsDcpt->unsolvedEntries++;
+        }
+        dnsHE->hEntry.flags.value &= ~(TCPIP_DNS_FLAG_ENTRY_COMPLETE | TCPIP_DNS_FLAG_ENTRY_TIMEOUT | TCPIP_DNS_FLAG_ENTRY_PREFETCH | TCPIP_DNS_FLAG_ENTRY_NEGATIVE);
     }
     dnsHE->ipTTL.Val = 0;
     dnsHE->resolve_type = type;
     dnsHE->recordMask |= recMask;
-    dnsHE->tRetry = dnsHE->tInsert = pDnsDcpt->dnsTime;
-    dnsHE->currRetry = 0;
-    // if a strict interface, we try only on that; otherwise on all
-    int retryIfs = (pDnsDcpt->strictNet == 0) ? TCPIP_STACK_NumberOfNetworksGet() : 1;
-    dnsHE->nRetries = retryIfs * _TCPIP_DNS_IF_RETRY_COUNT;
-    pDnsDcpt->unsolvedEntries++;
+    dnsHE->tInsert = pDnsDcpt->dnsTime;
+    _DNS_RetriesInit(pDnsDcpt, dnsHE);
     return _DNS_Send_Query(pDnsDcpt, dnsHE);
 }
 
@@ -743,6 +796,8 @@ static int _DNS_GetAddresses(const char* hostName, int startIndex, IP_MULTI_ADDR
         return 0; 
     }
 
+    dnsHashEntry->hEntry.flags.value |= TCPIP_DNS_FLAG_ENTRY_ACCESSED;
+
     nAddrs = 0;
     if(recMask == TCPIP_DNS_ADDRESS_REC_IPV4)
     {
@@ -909,12 +964,18 @@ static TCPIP_DNS_RESULT  _DNS_IsNameResolved(const char* hostName, IPV4_ADDR* ho
         return (pDnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_TIMEOUT) == 0 ? TCPIP_DNS_RES_PENDING : TCPIP_DNS_RES_SERVER_TMO; 
     }
 
+    if((pDnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_NEGATIVE) != 0)
+    {   // cached name error
+        return TCPIP_DNS_RES_NAME_ERROR;
+    }
+
     // completed entry
     nIPv6Entries = pDnsHE->nIPv6Entries;
     nIPv4Entries = pDnsHE->nIPv4Entries;
 
     if(nIPv6Entries || nIPv4Entries)
     {
+        pDnsHE->hEntry.flags.value |= TCPIP_DNS_FLAG_ENTRY_ACCESSED;
         if(nIPv6Entries)
         {
             if(hostIPv6)
@@ -957,6 +1018,10 @@ TCPIP_DNS_RESULT TCPIP_DNS_ClientInfoGet(TCPIP_DNS_CLIENT_INFO* pClientInfo)
         pClientInfo->pendingEntries = pDnsDcpt->unsolvedEntries;
         pClientInfo->currentEntries = pDnsDcpt->hashDcpt->fullSlots;
         pClientInfo->totalEntries = pDnsDcpt->hashDcpt->hEntries;
+        pClientInfo->cacheHits = pDnsDcpt->cacheHits;
+        pClientInfo->cacheMisses = pDnsDcpt->cacheMisses;
+        pClientInfo->negativeHits = pDnsDcpt->negativeHits;
+        pClientInfo->prefetchQueries = pDnsDcpt->prefetchQueries;
     }
     return TCPIP_DNS_RES_OK;
 }
@@ -997,16 +1062,9 @@ TCPIP_DNS_RESULT TCPIP_DNS_EntryQuery(TCPIP_DNS_ENTRY_QUERY *pDnsQuery, int quer
 
         if((pBkt->flags.value & TCPIP_DNS_FLAG_ENTRY_COMPLETE) != 0)
         {
-            pDnsQuery->status = TCPIP_DNS_RES_OK;
+            pDnsQuery->status = (pBkt->flags.value & TCPIP_DNS_FLAG_ENTRY_NEGATIVE) == 0 ? TCPIP_DNS_RES_OK : TCPIP_DNS_RES_NAME_ERROR;
             currTime = pDnsDcpt->dnsTime;
-            if(pDnsDcpt->cacheEntryTMO > 0)
-            {
-                pDnsQuery->ttlTime = pDnsDcpt->cacheEntryTMO - (currTime - pE->tInsert);
-            }
-            else
-            {
-                pDnsQuery->ttlTime = pE->ipTTL.Val - (currTime - pE->tInsert);
-            }
+            pDnsQuery->ttlTime = _DNS_EntryTimeout(pDnsDcpt, pE) - (currTime - pE->tInsert);
 
             for(ix = 0; ix < pE->nIPv4Entries && ix < pDnsQuery->nIPv4Entries; ix++)
             {
@@ -1224,17 +1282,93 @@ static void _DNSSocketRxSignalHandler(UDP_SOCKET hUDP, TCPIP_NET_HANDLE hNet, TC
 }
 
 #if defined (TCPIP_STACK_USE_IPV4)
-static TCPIP_DNS_RESULT _DNS_Send_Query(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* pDnsHE)
+// aborts a pending ARP on an old DNS server
+static void _DNS_ArpFlush(TCPIP_DNS_HASH_ENTRY* pDnsHE, TCPIP_NET_IF* oldIf, int oldServerIx)
+{
+    IPV4_ADDR oldDns = oldIf->dnsServer[oldServerIx];
+    if(oldDns.Val != 0)
+    {
+        TCPIP_ARP_EntryRemove(oldIf, &oldDns);
+        _DNS_DbgArpFlush(oldIf, oldServerIx, pDnsHE->currNet, pDnsHE->currServerIx, &oldDns);
+    }
+}
+
+// writes the query for the pDnsHE to the serverIx DNS server of the current interface
+// returns true if the packet was sent
+static bool _DNS_Send_QueryPacket(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* pDnsHE, int serverIx)
 {
     TCPIP_DNS_HEADER    DNSPutHeader;
     uint8_t             *wrPtr, *startPtr;
     uint16_t            sktPayload;
-    TCPIP_DNS_EVENT_TYPE evType;
-    TCPIP_DNS_RESULT    res;
     IPV4_ADDR           dnsServerAdd;
     UDP_SOCKET          dnsSocket = pDnsDcpt->dnsSocket;
+
+    if(!TCPIP_UDP_PutIsReady(dnsSocket))
+    {   // failed to allocate another TX buffer
+        return false;
+    }
+
+    // this will put the start pointer at the beginning of the TX buffer
+    TCPIP_UDP_TxOffsetSet(dnsSocket, 0, false);    
+
+    //Get the write pointer:
+    wrPtr = TCPIP_UDP_TxPointerGet(dnsSocket);
+    if(wrPtr == 0)
+    {
+        return false;
+    }
+
+    // set up the socket
+    TCPIP_UDP_Bind(dnsSocket, IP_ADDRESS_TYPE_IPV4, 0, (IP_MULTI_ADDRESS*)&pDnsHE->currNet->netIPAddr);
+    dnsServerAdd.Val = pDnsHE->currNet->dnsServer[serverIx].Val;
+    TCPIP_UDP_DestinationIPAddressSet(dnsSocket, pDnsDcpt->ipAddressType, (IP_MULTI_ADDRESS*)&dnsServerAdd);
+    TCPIP_UDP_DestinationPortSet(dnsSocket, TCPIP_DNS_SERVER_PORT);
+
+    startPtr = wrPtr;
+    // Put DNS query here
+    DNSPutHeader.TransactionID.Val = TCPIP_Helper_htons(pDnsHE->transactionId.Val);
+    // Flag -- Standard query with recursion
+    DNSPutHeader.Flags.Val = TCPIP_Helper_htons(0x0100); // Standard query with recursion
+    // Question -- only one question at this time
+    DNSPutHeader.Questions.Val = TCPIP_Helper_htons(0x0001); // questions
+    // Answers set to zero
+    // Name server resource address also set to zero
+    // Additional records also set to zero
+    DNSPutHeader.Answers.Val = DNSPutHeader.AuthoritativeRecords.Val = DNSPutHeader.AdditionalRecords.Val = 0;
+
+    // copy the DNS header to the UDP buffer
+    memcpy(wrPtr, &DNSPutHeader, sizeof(TCPIP_DNS_HEADER));
+    wrPtr += sizeof(TCPIP_DNS_HEADER);
+
+    // Put hostname string to resolve
+    _DNSPutString(&wrPtr, pDnsHE->pHostName);
+
+    // Type: TCPIP_DNS_TYPE_A A (host address) or TCPIP_DNS_TYPE_MX for mail exchange
+    *wrPtr++ = 0x00;
+    *wrPtr++ = pDnsHE->resolve_type;
+
+    // Class: IN (Internet)
+    *wrPtr++ = 0x00;
+    *wrPtr++ = 0x01; // 0x0001
+
+    // Put complete DNS query packet buffer to the UDP buffer
+    // Once it is completed writing into the buffer, you need to update the Tx offset again,
+    // because the socket flush function calculates how many bytes are in the buffer using the current write pointer:
+    sktPayload = (uint16_t)(wrPtr - startPtr);
+    TCPIP_UDP_TxOffsetSet(dnsSocket, sktPayload, false);
+
+    return TCPIP_UDP_Flush(dnsSocket) == sktPayload;
+}
+
+static TCPIP_DNS_RESULT _DNS_Send_Query(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* pDnsHE)
+{
+    TCPIP_DNS_EVENT_TYPE evType;
+    TCPIP_DNS_RESULT    res;
     
-    pDnsHE->hEntry.flags.value &= ~TCPIP_DNS_FLAG_ENTRY_COMPLETE;
+    if((pDnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_PREFETCH) == 0)
+    {   // a refreshed entry keeps the old answer until the new one arrives
+        pDnsHE->hEntry.flags.value &= ~TCPIP_DNS_FLAG_ENTRY_COMPLETE;
+    }
 
     while(true)
     {
@@ -1256,84 +1390,45 @@ static TCPIP_DNS_RESULT _DNS_Send_Query(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH
             // abort (if any) pending ARP on the old DNS server.
             // a pending ARP counts as a socket TX pending packet
             // and newer packets could be discarded if the socket limit is exceeded
-            IPV4_ADDR oldDns = oldIf->dnsServer[oldServerIx];
-            if(oldDns.Val != 0)
+#if (_TCPIP_DNS_CLIENT_PARALLEL_QUERY != 0)
+            // all the interface servers are in use; flush only when leaving the interface
+            if(pDnsHE->currNet != oldIf)
             {
-                TCPIP_ARP_EntryRemove(oldIf, &oldDns);
-                _DNS_DbgArpFlush(oldIf, oldServerIx, pDnsHE->currNet, pDnsHE->currServerIx, &oldDns);
+                for(oldServerIx = 0; oldServerIx < sizeof(oldIf->dnsServer) / sizeof(*oldIf->dnsServer); oldServerIx++)
+                {
+                    _DNS_ArpFlush(pDnsHE, oldIf, oldServerIx);
+                }
             }
+#else
+            _DNS_ArpFlush(pDnsHE, oldIf, oldServerIx);
+#endif  // (_TCPIP_DNS_CLIENT_PARALLEL_QUERY != 0)
         }
 
-        if(!TCPIP_UDP_PutIsReady(dnsSocket))
-        {   // failed to allocate another TX buffer
-            res = TCPIP_DNS_RES_SOCKET_ERROR;
-            evType = TCPIP_DNS_EVENT_SOCKET_ERROR;
-            break; 
-        }
-
-        // this will put the start pointer at the beginning of the TX buffer
-        TCPIP_UDP_TxOffsetSet(dnsSocket, 0, false);    
-
-        //Get the write pointer:
-        wrPtr = TCPIP_UDP_TxPointerGet(dnsSocket);
-        if(wrPtr == 0)
-        {
-            res = TCPIP_DNS_RES_SOCKET_ERROR;
-            evType = TCPIP_DNS_EVENT_SOCKET_ERROR;
-            break; 
-        }
-
-        // set up the socket
-        TCPIP_UDP_Bind(dnsSocket, IP_ADDRESS_TYPE_IPV4, 0, (IP_MULTI_ADDRESS*)&pDnsHE->currNet->netIPAddr);
-        dnsServerAdd.Val = pDnsHE->currNet->dnsServer[pDnsHE->currServerIx].Val;
-        TCPIP_UDP_DestinationIPAddressSet(dnsSocket, pDnsDcpt->ipAddressType, (IP_MULTI_ADDRESS*)&dnsServerAdd);
-        TCPIP_UDP_DestinationPortSet(dnsSocket, TCPIP_DNS_SERVER_PORT);
-
-        startPtr = wrPtr;
-        // Put DNS query here
         // Set a new Transaction ID
-        pDnsHE->transactionId.Val = (uint16_t)SYS_RANDOM_PseudoGet();
-        DNSPutHeader.TransactionID.Val = TCPIP_Helper_htons(pDnsHE->transactionId.Val);
-        // Flag -- Standard query with recursion
-        DNSPutHeader.Flags.Val = TCPIP_Helper_htons(0x0100); // Standard query with recursion
-        // Question -- only one question at this time
-        DNSPutHeader.Questions.Val = TCPIP_Helper_htons(0x0001); // questions
-        // Answers set to zero
-        // Name server resource address also set to zero
-        // Additional records also set to zero
-        DNSPutHeader.Answers.Val = DNSPutHeader.AuthoritativeRecords.Val = DNSPutHeader.AdditionalRecords.Val = 0;
-
-        // copy the DNS header to the UDP buffer
-        memcpy(wrPtr, &DNSPutHeader, sizeof(TCPIP_DNS_HEADER));
-        wrPtr += sizeof(TCPIP_DNS_HEADER);
-
-        // Put hostname string to resolve
-        _DNSPutString(&wrPtr, pDnsHE->pHostName);
-
-        // Type: TCPIP_DNS_TYPE_A A (host address) or TCPIP_DNS_TYPE_MX for mail exchange
-        *wrPtr++ = 0x00;
-        *wrPtr++ = pDnsHE->resolve_type;
-
-        // Class: IN (Internet)
-        *wrPtr++ = 0x00;
-        *wrPtr++ = 0x01; // 0x0001
-    
-        // Put complete DNS query packet buffer to the UDP buffer
-        // Once it is completed writing into the buffer, you need to update the Tx offset again,
-        // because the socket flush function calculates how many bytes are in the buffer using the current write pointer:
-        sktPayload = (uint16_t)(wrPtr - startPtr);
-        TCPIP_UDP_TxOffsetSet(dnsSocket, sktPayload, false);
-
-        if(TCPIP_UDP_Flush(dnsSocket) != sktPayload)
+        pDnsHE->transactionId.Val = (uint16_t)SYS_RANDOM_PoolGet(SYS_RANDOM_POOL_NET_ID);
+        if(!_DNS_Send_QueryPacket(pDnsDcpt, pDnsHE, pDnsHE->currServerIx))
         {
             res = TCPIP_DNS_RES_SOCKET_ERROR;
             evType = TCPIP_DNS_EVENT_SOCKET_ERROR;
+            break;
         }
-        else
+
+#if (_TCPIP_DNS_CLIENT_PARALLEL_QUERY != 0)
+        // the other servers of the interface get the same query and transaction ID
+        // the first valid answer completes the entry, the late ones are discarded
+        int srvIx;
+        TCPIP_NET_IF* pDnsIf = pDnsHE->currNet;
+        for(srvIx = 0; srvIx < sizeof(pDnsIf->dnsServer) / sizeof(*pDnsIf->dnsServer); srvIx++)
         {
-            res = TCPIP_DNS_RES_PENDING;
-            evType = TCPIP_DNS_EVENT_NAME_QUERY;
+            if(srvIx != pDnsHE->currServerIx && pDnsIf->dnsServer[srvIx].Val != 0 && pDnsIf->dnsServer[srvIx].Val != pDnsIf->dnsServer[pDnsHE->currServerIx].Val)
+            {   // best effort; the retry covers a failure
+                _DNS_Send_QueryPacket(pDnsDcpt, pDnsHE, srvIx);
+            }
         }
+#endif  // (_TCPIP_DNS_CLIENT_PARALLEL_QUERY != 0)
+
+        res = TCPIP_DNS_RES_PENDING;
+        evType = TCPIP_DNS_EVENT_NAME_QUERY;
         break;
     }
 
@@ -1418,6 +1513,47 @@ void TCPIP_DNS_ClientTask(void)
 
 }
 
+#if (_TCPIP_DNS_CLIENT_PREFETCH_PERCENT != 0)
+// refresh-ahead of a solved entry that is still in use
+// the entry stays complete, with the old answer, until the new one arrives
+static void _DNS_PrefetchTimeout(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* pDnsHE, uint32_t timeout)
+{
+    uint32_t currTime = pDnsDcpt->dnsTime;
+    uint16_t entryFlags = pDnsHE->hEntry.flags.value;
+
+    if((entryFlags & TCPIP_DNS_FLAG_ENTRY_PREFETCH) != 0)
+    {   // refresh ongoing
+        if((currTime - pDnsHE->tRetry) >= TCPIP_DNS_CLIENT_LOOKUP_RETRY_TMO)
+        {
+            pDnsHE->tRetry = currTime;
+            if(pDnsHE->currRetry < pDnsHE->nRetries)
+            {
+                pDnsHE->currRetry++;
+                _DNS_Send_Query(pDnsDcpt, pDnsHE);
+            }
+            else
+            {   // no answer; the old one is used until it expires
+                pDnsHE->hEntry.flags.value &= ~TCPIP_DNS_FLAG_ENTRY_PREFETCH;
+                pDnsDcpt->unsolvedEntries--;
+            }
+        }
+    }
+    else if((entryFlags & (TCPIP_DNS_FLAG_ENTRY_ACCESSED | TCPIP_DNS_FLAG_ENTRY_NEGATIVE)) == TCPIP_DNS_FLAG_ENTRY_ACCESSED)
+    {   // used since the last refresh; check the lifetime left
+        uint32_t timeLeft = timeout - (currTime - pDnsHE->tInsert);
+        if((uint64_t)timeLeft * 100 <= (uint64_t)timeout * _TCPIP_DNS_CLIENT_PREFETCH_PERCENT)
+        {
+            pDnsHE->hEntry.flags.value &= ~TCPIP_DNS_FLAG_ENTRY_ACCESSED;
+            pDnsHE->hEntry.flags.value |= TCPIP_DNS_FLAG_ENTRY_PREFETCH;
+            _DNS_RetriesInit(pDnsDcpt, pDnsHE);
+            pDnsDcpt->unsolvedEntries++;
+            pDnsDcpt->prefetchQueries++;
+            _DNS_Send_Query(pDnsDcpt, pDnsHE);
+        }
+    }
+}
+#endif  // (_TCPIP_DNS_CLIENT_PREFETCH_PERCENT != 0)
+
 static void TCPIP_DNS_CacheTimeout(TCPIP_DNS_DCPT* pDnsDcpt)
 {
     TCPIP_DNS_HASH_ENTRY  *pDnsHE;
@@ -1438,15 +1574,17 @@ static void TCPIP_DNS_CacheTimeout(TCPIP_DNS_DCPT* pDnsDcpt)
         {   // not empty hash slot
             if((pDnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_COMPLETE) != 0)
             {   // solved entry: check timeout
-                // if cacheEntryTMO is equal to zero, then TTL time is the timeout period. 
-                if((timeout = pDnsDcpt->cacheEntryTMO) == 0)
-                {
-                    timeout = pDnsHE->ipTTL.Val;
-                }
+                timeout = _DNS_EntryTimeout(pDnsDcpt, pDnsHE);
                 if((currTime - pDnsHE->tInsert) >= timeout)
                 {
                     _DNS_UpdateExpiredHashEntry_Notify(pDnsDcpt, pDnsHE);
                 }
+#if (_TCPIP_DNS_CLIENT_PREFETCH_PERCENT != 0)
+                else
+                {
+                    _DNS_PrefetchTimeout(pDnsDcpt, pDnsHE, timeout);
+                }
+#endif  // (_TCPIP_DNS_CLIENT_PREFETCH_PERCENT != 0)
             }
             else
             {   // unsolved entry
@@ -1520,11 +1658,12 @@ static void TCPIP_DNS_ClientProcess(bool isTmo)
 // if dnsHE == 0, than it just discards
 // returns true if processing was successful
 // false if some error occurred
-static bool _DNS_RESPONSE_HashEntryUpdate(TCPIP_DNS_RX_DATA* dnsRxData, TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* dnsHE)
+static bool _DNS_RESPONSE_HashEntryUpdate(TCPIP_DNS_RR_PROCESS* pProc, TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* dnsHE)
 {
     TCPIP_DNS_ANSWER_HEADER DNSAnswerHeader;    
     IP_MULTI_ADDRESS        ipAddr;
     bool                    discardData;
+    TCPIP_DNS_RX_DATA*      dnsRxData = pProc->dnsRxData;
 
     memset(&DNSAnswerHeader, 0, sizeof(DNSAnswerHeader));
     if(!_DNSGetData(dnsRxData, (uint8_t *)&DNSAnswerHeader, sizeof(TCPIP_DNS_ANSWER_HEADER)))
@@ -1591,6 +1730,37 @@ static bool _DNS_RESPONSE_HashEntryUpdate(TCPIP_DNS_RX_DATA* dnsRxData, TCPIP_DN
             break;
         }
 
+#if (_TCPIP_DNS_CLIENT_NEGATIVE_CACHE_TMO != 0)
+        if (DNSAnswerHeader.ResponseType.Val == _TCPIP_DNS_TYPE_SOA && DNSAnswerHeader.ResponseLen.Val >= _TCPIP_DNS_SOA_MIN_RDATA_LEN)
+        {
+            if((pProc->dnsHeader->Flags.v[0] & _TCPIP_DNS_RCODE_MASK) != _TCPIP_DNS_RCODE_NAME_ERROR)
+            {   // used for name errors only
+                break;
+            }
+
+            // RFC 2308: the negative TTL is the minimum of the SOA TTL and the SOA MINIMUM field
+            // MINIMUM is the last field; skip the variable length names
+            TCPIP_UINT32_VAL soaMin;
+            if(!_DNSGetData(dnsRxData, 0, DNSAnswerHeader.ResponseLen.Val - sizeof(soaMin)) || !_DNSGetData(dnsRxData, soaMin.v, sizeof(soaMin)))
+            {
+                return false;
+            }
+
+            discardData = false;
+            soaMin.Val = TCPIP_Helper_ntohl(soaMin.Val);
+            if(soaMin.Val > DNSAnswerHeader.ResponseTTL.Val)
+            {
+                soaMin.Val = DNSAnswerHeader.ResponseTTL.Val;
+            }
+            if(soaMin.Val > _TCPIP_DNS_CLIENT_NEGATIVE_CACHE_TMO)
+            {
+                soaMin.Val = _TCPIP_DNS_CLIENT_NEGATIVE_CACHE_TMO;
+            }
+            pProc->negTTL = soaMin.Val;
+            break;
+        }
+#endif  // (_TCPIP_DNS_CLIENT_NEGATIVE_CACHE_TMO != 0)
+
         // else discard and continue
         break;
     }
@@ -1708,8 +1878,8 @@ static int _DNS_ProcessRR(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_RR_PROCESS* pProc,
 
         if(dnsHE != 0)
         {
-            if((dnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_COMPLETE) != 0)
-            {
+            if((dnsHE->hEntry.flags.value & (TCPIP_DNS_FLAG_ENTRY_COMPLETE | TCPIP_DNS_FLAG_ENTRY_PREFETCH)) == TCPIP_DNS_FLAG_ENTRY_COMPLETE)
+            {   // could be the late answer of a parallel query
                 evDbgType = TCPIP_DNS_DBG_EVENT_COMPLETE_ERROR;
                 break;
             }
@@ -1717,6 +1887,18 @@ static int _DNS_ProcessRR(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_RR_PROCESS* pProc,
             if(pProc->dnsHE == 0)
             {
                 pProc->dnsHE = dnsHE;
+                if((dnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_PREFETCH) != 0)
+                {   // refresh answer: replace the queried addresses
+                    if(dnsHE->resolve_type != TCPIP_DNS_TYPE_AAAA)
+                    {
+                        dnsHE->nIPv4Entries = 0;
+                    }
+                    if(dnsHE->resolve_type != TCPIP_DNS_TYPE_A)
+                    {
+                        dnsHE->nIPv6Entries = 0;
+                    }
+                    dnsHE->ipTTL.Val = 0;
+                }
             }
             else if(pProc->dnsHE != dnsHE)
             {
@@ -1736,7 +1918,7 @@ static int _DNS_ProcessRR(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_RR_PROCESS* pProc,
         }
         else
         {
-            bool entryUpdate = _DNS_RESPONSE_HashEntryUpdate(pProc->dnsRxData, pDnsDcpt, dnsHE);
+            bool entryUpdate = _DNS_RESPONSE_HashEntryUpdate(pProc, pDnsDcpt, dnsHE);
             if(entryUpdate == false)
             {
                 evDbgType = TCPIP_DNS_DBG_EVENT_RR_DATA_ERROR;
@@ -1777,6 +1959,7 @@ static bool _DNS_ProcessPacket(TCPIP_DNS_DCPT* pDnsDcpt)
     TCPIP_DNS_EVENT_TYPE    evType = TCPIP_DNS_EVENT_NONE;
     TCPIP_DNS_DBG_EVENT_TYPE evDbgType = TCPIP_DNS_DBG_EVENT_NONE;
     TCPIP_DNS_RR_PROCESS    procRR;
+    int                     rCode;
 
 
     // Get DNS Reply packet
@@ -1800,14 +1983,17 @@ static bool _DNS_ProcessPacket(TCPIP_DNS_DCPT* pDnsDcpt)
     procRR.dnsRxData = &dnsRxData;
     procRR.dnsPacketSize = dnsPacketSize;
     procRR.dnsHE = 0;
+    procRR.negTTL = 0;
 
     while(true)
     {
         dnsHE = 0;
         procFail = false;
 
-        if((DNSHeader.Flags.v[0] & 0x03) != 0)
-        {   
+        rCode = DNSHeader.Flags.v[0] & _TCPIP_DNS_RCODE_MASK;
+        if(rCode != 0 && rCode != _TCPIP_DNS_RCODE_NAME_ERROR)
+        {   // server failure, refused, etc.
+            // not an answer for the name; another server or a retry could still solve it
             evType = TCPIP_DNS_EVENT_NAME_ERROR;
             procFail = true;
             break;
@@ -1835,7 +2021,12 @@ static bool _DNS_ProcessPacket(TCPIP_DNS_DCPT* pDnsDcpt)
         dnsHE = procRR.dnsHE;
 
         // finally
-        if(dnsHE != 0 && (dnsHE->nIPv4Entries > 0 || dnsHE->nIPv6Entries > 0))
+        if(rCode == _TCPIP_DNS_RCODE_NAME_ERROR)
+        {   // valid answer: no such name
+            evType = TCPIP_DNS_EVENT_NAME_ERROR;
+            procFail = dnsHE == 0;
+        }
+        else if(dnsHE != 0 && (dnsHE->nIPv4Entries > 0 || dnsHE->nIPv6Entries > 0))
         {
             evType = TCPIP_DNS_EVENT_NAME_RESOLVED;
         }           
@@ -1857,13 +2048,27 @@ static bool _DNS_ProcessPacket(TCPIP_DNS_DCPT* pDnsDcpt)
             _DNSCompleteHashEntry(pDnsDcpt, dnsHE);
         }
         else if(evType == TCPIP_DNS_EVENT_NAME_ERROR && dnsHE != 0)
-        {   // Remove name if "No Such name"
-            TCPIP_DNS_RemoveEntry(dnsHE->pHostName);
+        {
+#if (_TCPIP_DNS_CLIENT_NEGATIVE_CACHE_TMO != 0)
+            if(procRR.negTTL != 0)
+            {   // RFC 2308: cache the name error
+                _DNSCompleteNegativeHashEntry(pDnsDcpt, dnsHE, procRR.negTTL);
+            }
+            else
+#endif  // (_TCPIP_DNS_CLIENT_NEGATIVE_CACHE_TMO != 0)
+            {   // Remove name if "No Such name"
+                TCPIP_DNS_RemoveEntry(dnsHE->pHostName);
+            }
         }
     }
     else if (evDbgType != TCPIP_DNS_DBG_EVENT_NONE)
     {
         _DNS_DbgEvent(pDnsDcpt, dnsHE, evDbgType);
+        dnsHE = procRR.dnsHE;
+        if(dnsHE != 0 && (dnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_PREFETCH) != 0 && dnsHE->nIPv4Entries == 0 && dnsHE->nIPv6Entries == 0)
+        {   // the failed refresh answer left no addresses
+            _DNS_UpdateExpiredHashEntry_Notify(pDnsDcpt, dnsHE);
+        }
     }
 
     return !procFail;
@@ -2077,10 +2282,14 @@ static OA_HASH_ENTRY* TCPIP_DNS_OAHASH_DeleteEntry(OA_HASH_DCPT* pOH)
         if(pBkt->flags.busy != 0 && (pBkt->flags.value & TCPIP_DNS_FLAG_ENTRY_COMPLETE) != 0)
         {
             pE = (TCPIP_DNS_HASH_ENTRY*)pBkt;
-            timeout = (pDnsDcpt->cacheEntryTMO > 0) ? pDnsDcpt->cacheEntryTMO : pE->ipTTL.Val;
+            timeout = _DNS_EntryTimeout(pDnsDcpt, pE);
 
             if((currTime - pE->tInsert) >= timeout)
             {
+                if((pBkt->flags.value & TCPIP_DNS_FLAG_ENTRY_PREFETCH) != 0)
+                {   // abandoned refresh
+                    pDnsDcpt->unsolvedEntries--;
+                }
                 _DNSNotifyClients(pDnsDcpt, pE, TCPIP_DNS_EVENT_NAME_REMOVED);
                 return pBkt;
             }
@@ -76,6 +76,38 @@ Microchip or any third party.
 // it will be removed from the cache
 #define _TCPIP_DNS_CLIENT_CACHE_UNSOLVED_EXPIRE_TMO     1
 
+// refresh-ahead of the cache entries still in use:
+// a new query is sent when less than this percentage of the entry lifetime is left
+#if defined(TCPIP_DNS_CLIENT_PREFETCH_PERCENT) && (TCPIP_DNS_CLIENT_PREFETCH_PERCENT != 0)
+#define _TCPIP_DNS_CLIENT_PREFETCH_PERCENT  TCPIP_DNS_CLIENT_PREFETCH_PERCENT
+#else
+#define _TCPIP_DNS_CLIENT_PREFETCH_PERCENT  0
+#endif
+
+// RFC 2308 negative caching: upper limit of the time, in seconds,
+// a name error answer is kept in the cache
+#if defined(TCPIP_DNS_CLIENT_NEGATIVE_CACHE_TMO) && (TCPIP_DNS_CLIENT_NEGATIVE_CACHE_TMO != 0)
+#define _TCPIP_DNS_CLIENT_NEGATIVE_CACHE_TMO    TCPIP_DNS_CLIENT_NEGATIVE_CACHE_TMO
+#else
+#define _TCPIP_DNS_CLIENT_NEGATIVE_CACHE_TMO    0
+#endif
+
+// query all the DNS servers of the selected interface at once
+#if defined(TCPIP_DNS_CLIENT_PARALLEL_QUERY) && (TCPIP_DNS_CLIENT_PARALLEL_QUERY != 0)
+#define _TCPIP_DNS_CLIENT_PARALLEL_QUERY    1
+#else
+#define _TCPIP_DNS_CLIENT_PARALLEL_QUERY    0
+#endif
+
+// DNS header RCODE values
+#define _TCPIP_DNS_RCODE_MASK               0x0f
+#define _TCPIP_DNS_RCODE_NAME_ERROR         3       // NXDOMAIN
+
+// SOA RR type, used for the negative caching TTL
+#define _TCPIP_DNS_TYPE_SOA                 6
+// SOA RDATA: MNAME and RNAME (at least 1 byte each) followed by 5 32 bit fields
+#define _TCPIP_DNS_SOA_MIN_RDATA_LEN        (2 + 5 * 4)
+
 // a DNS debug event
 typedef enum
 {
@@ -120,6 +152,10 @@ typedef enum
     TCPIP_DNS_FLAG_ENTRY_COMPLETE     = 0x0080,     // regular entry, complete
                                                     // else it's incomplete
     TCPIP_DNS_FLAG_ENTRY_TIMEOUT      = 0x0100,     // entry has timed out
+    TCPIP_DNS_FLAG_ENTRY_PREFETCH     = 0x0200,     // complete entry being refreshed
+                                                    // the old answer is still valid
+    TCPIP_DNS_FLAG_ENTRY_NEGATIVE     = 0x0400,     // complete entry caching a name error
+    TCPIP_DNS_FLAG_ENTRY_ACCESSED     = 0x0800,     // entry used since the last refresh
                                                   
 }TCPIP_DNS_HASH_ENTRY_FLAGS;
 
@@ -168,6 +204,10 @@ typedef struct
     PROTECTED_SINGLE_LIST   dnsRegisteredUsers;
 #endif  // (TCPIP_DNS_CLIENT_USER_NOTIFICATION != 0)
     uint32_t                dnsTime;                        // coarse DNS time keeping, seconds
+    uint32_t                cacheHits;                      // requests answered from the cache
+    uint32_t                cacheMisses;                    // requests that needed a new query
+    uint32_t                negativeHits;                   // requests answered by a cached name error
+    uint32_t                prefetchQueries;                // entries refreshed before expiration
     // unaligned members
     uint16_t                nIPv4Entries;
     uint16_t                nIPv6Entries;
@@ -232,6 +272,7 @@ typedef struct
     uint16_t                dnsPacketSize;  // packet size
     TCPIP_DNS_HASH_ENTRY*   dnsHE;          // associated hash entry
     TCPIP_DNS_DBG_EVENT_TYPE evDbgType;     // associated parsing event, if any
+    uint32_t                negTTL;         // negative caching TTL from the SOA record, if any
 }TCPIP_DNS_RR_PROCESS;
 
 
@@ -158,6 +158,8 @@ bool TCPIP_DNSS_Initialize(const TCPIP_STACK_MODULE_CTRL* const stackCtrl, const
             hashDcpt->hEntrySize = sizeof(DNSS_HASH_ENTRY);
             hashDcpt->hEntries = cacheEntries;
             hashDcpt->probeStep = TCPIP_DNSS_HASH_PROBE_STEP;
+            // removed entries are still accessed, keep them in place
+            hashDcpt->hFlags = OA_HASH_FLAG_NONE;
 
             hashDcpt->hashF = TCPIP_OAHASH_DNSS_KeyHash;
             hashDcpt->delF = TCPIP_OAHASH_DNSS_EntryDelete;
@@ -318,6 +318,10 @@ ICMP_ECHO_RESULT TCPIP_ICMP_EchoRequest (TCPIP_ICMP_ECHO_REQUEST* pEchoRequest,
 
         // success; mark as busy
         lock = _ICMPRequestListLock();
+        if(TCPIP_Helper_SingleListIsEmpty(&echoRequestBusyList))
+        {   // first pending request; start the timer
+            _TCPIPStackSignalHandlerSetParams(TCPIP_THIS_MODULE_ID, signalHandle, TCPIP_ICMP_TASK_TICK_RATE);
+        }
         TCPIP_Helper_SingleListTailAdd(&echoRequestBusyList, (SGL_LIST_NODE*)pReqNode);
         _ICMPRequestListUnlock(lock);
     
@@ -548,6 +552,10 @@ static void  TCPIP_ICMP_Timeout(void)
         }
     }
 
+    if(TCPIP_Helper_SingleListIsEmpty(&echoRequestBusyList))
+    {   // nothing to time out; the next request restarts the timer
+        _TCPIPStackSignalHandlerSetParams(TCPIP_THIS_MODULE_ID, signalHandle, 0);
+    }
     _ICMPRequestListUnlock(lock);
 
     // traverse the expired list
@@ -2191,6 +2191,60 @@ bool TCPIP_IPV4_PktTx(IPV4_PACKET* pPkt, TCPIP_MAC_PACKET* pMacPkt, bool isPersi
     return txRes;
 }
 
+bool TCPIP_IPV4_PacketChainTransmit(IPV4_PACKET* pPkt)
+{
+    TCPIP_MAC_ADDR   destMacAdd, *pMacDst;
+    TCPIP_NET_IF*    pNetIf;
+    TCPIP_MAC_PACKET* pMacPkt;
+    IPV4_ADDR       arpTarget;
+    uint16_t        linkMtu;
+
+    // all checks are done before touching the packets
+    pNetIf = _TCPIPStackHandleToNetLinked(pPkt->netIfH);
+    if(pNetIf == 0 || TCPIP_STACK_MatchNetAddress(pNetIf, &pPkt->destAddress) != 0)
+    {   // dead interface or internal destination
+        return false;
+    }
+
+    pMacDst = &destMacAdd;
+    if(TCPIP_IPV4_PktMacDestination(pPkt, &pPkt->destAddress, &pMacDst, &arpTarget) == TCPIP_IPV4_DEST_FAIL || pMacDst == 0)
+    {   // failed or ARP queuing needed
+        return false;
+    }
+
+    linkMtu = _TCPIPStackNetLinkMtu(pNetIf);
+    for(pMacPkt = &pPkt->macPkt; pMacPkt != 0; pMacPkt = pMacPkt->next)
+    {
+        if(_TCPIPStackIsConfig(pNetIf) && (pMacPkt->pktFlags & TCPIP_MAC_PKT_FLAG_CONFIG) == 0)
+        {   // no packets go out in stack configuration
+            return false;
+        }
+        if(TCPIP_PKT_PayloadLen(pMacPkt) > linkMtu)
+        {   // needs fragmentation
+            return false;
+        }
+    }
+
+    for(pMacPkt = &pPkt->macPkt; pMacPkt != 0; pMacPkt = pMacPkt->next)
+    {
+        pMacPkt->pktIf = pNetIf;
+        TCPIP_PKT_PacketMACFormat(pMacPkt, pMacDst, (const TCPIP_MAC_ADDR*)_TCPIPStack_NetMACAddressGet(pNetIf), TCPIP_ETHER_TYPE_IPV4);
+        TCPIP_PKT_FlightLogTx(pMacPkt, TCPIP_THIS_MODULE_ID);
+    }
+
+    // MAC sets itself the TCPIP_MAC_PKT_FLAG_QUEUED
+    if(_TCPIPStackPacketTx(pNetIf, &pPkt->macPkt) < 0)
+    {   // rejected; restore the packets
+        for(pMacPkt = &pPkt->macPkt; pMacPkt != 0; pMacPkt = pMacPkt->next)
+        {
+            pMacPkt->pDSeg->segLen -= sizeof(TCPIP_MAC_ETHERNET_HEADER);
+        }
+        return false;
+    }
+
+    return true;
+}
+
 
 // IPv4 formats a IPV4_PACKET and calculates the header checksum
 // the source and destination addresses should be updated in the packet 
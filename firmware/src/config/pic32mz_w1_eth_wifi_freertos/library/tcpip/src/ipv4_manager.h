@@ -125,6 +125,14 @@ void                    TCPIP_IPV4_MacPacketSwitchTxToRx(TCPIP_MAC_PACKET* pRxPk
 // Otherwise, the pMacPkt will be used if ARP queuing needed
 bool TCPIP_IPV4_PktTx(IPV4_PACKET* pPkt, TCPIP_MAC_PACKET* pMacPkt, bool isPersistent);
 
+// transmits a chain of packets linked with macPkt.next,
+// all formatted with TCPIP_IPV4_PacketFormatTx for the same interface and destination
+// the destination is solved once and the whole chain is passed to the MAC in one call
+// returns false, with no packet transmitted, if that's not possible:
+// internal destination, ARP not solved yet, fragmentation needed or MAC rejection
+// The packets can then be transmitted one by one with TCPIP_IPV4_PacketTransmit
+bool TCPIP_IPV4_PacketChainTransmit(IPV4_PACKET* pPkt);
+
 #endif // _IPV4_MANAGER_H_
 
 
@@ -42,22 +42,138 @@ Microchip or any third party.
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "device.h"
 #include "tcpip/src/oahash.h"
 
+// the Robin Hood ordering needs the same probe step for all keys
+#if defined(OA_DOUBLE_HASH_PROBING)
+#define _OAHashIsRobinHood(pOH)     (false)
+#else
+#define _OAHashIsRobinHood(pOH)     (((pOH)->hFlags & OA_HASH_FLAG_ROBIN_HOOD) != 0)
+#endif  // defined(OA_DOUBLE_HASH_PROBING)
+
+// the migration relies on the entries being relocatable
+#define _OAHashIsResizable(pOH)     (_OAHashIsRobinHood(pOH) && ((pOH)->hFlags & OA_HASH_FLAG_RESIZE) != 0)
+
+// number of migration steps done by a TCPIP_OAHASH_EntryLookupOrInsert() call
+// a step is either a bucket found empty or an entry moved to the new array.
+// High enough for a shrink to complete before the inserts fill the smaller array.
+#define OA_HASH_INSERT_MIGRATE_STEPS    8
 
 // local prototypes
 // 
 
 static OA_HASH_ENTRY*   _OAHashFindBkt(OA_HASH_DCPT* pOH, const void* key);
+static OA_HASH_ENTRY*   _OAHashRobinHoodFindBkt(OA_HASH_DCPT* pOH, const void* key);
+static void             _OAHashRobinHoodRemove(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* pOE);
+static OA_HASH_ENTRY*   _OAHashLookup(OA_HASH_DCPT* pOH, const void* key);
+static void             _OAHashClearBkts(OA_HASH_DCPT* pOH);
+static void             _OAHashMigrate(OA_HASH_DCPT* pOH, size_t nSteps);
+static size_t           _OAHashResizeTarget(OA_HASH_DCPT* pOH);
+static void             _OAHashIterStart(OA_HASH_DCPT* pOH, OA_HASH_ITERATOR* pIter);
+
+static __inline__ OA_HASH_ENTRY* __attribute__((always_inline)) _OAHashBkt(OA_HASH_DCPT* pOH, size_t bktIx)
+{
+    return (OA_HASH_ENTRY*)((uint8_t*)(pOH->memBlk) + bktIx * pOH->hEntrySize);
+}
+
+static __inline__ size_t __attribute__((always_inline)) _OAHashNextBkt(OA_HASH_DCPT* pOH, size_t bktIx, size_t probeStep)
+{
+    bktIx += probeStep;
+    if(bktIx >= pOH->hEntries)
+    {
+        bktIx -= pOH->hEntries;
+    }
+
+    return bktIx;
+}
+
+static __inline__ size_t __attribute__((always_inline)) _OAHashPrevBkt(OA_HASH_DCPT* pOH, size_t bktIx)
+{
+    return bktIx >= pOH->probeStep ? bktIx - pOH->probeStep : bktIx + pOH->hEntries - pOH->probeStep;
+}
+
+static __inline__ size_t __attribute__((always_inline)) _OAHashKeyHash(OA_HASH_DCPT* pOH, const void* key)
+{
+#if defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
+    return (*pOH->hashF)(pOH, key);
+#else
+    return TCPIP_OAHASH_KeyHash(pOH, key);
+#endif  // defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
+}
+
+static __inline__ int __attribute__((always_inline)) _OAHashKeyCompare(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* pBkt, const void* key)
+{
+#if defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
+    return (*pOH->cmpF)(pOH, pBkt, key);
+#else
+    return TCPIP_OAHASH_KeyCompare(pOH, pBkt, key);
+#endif  // defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
+}
+
+static __inline__ void __attribute__((always_inline)) _OAHashKeyCopy(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* pBkt, const void* key)
+{
+#if defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
+    (*pOH->cpyF)(pOH, pBkt, key);
+#else
+    TCPIP_OAHASH_KeyCopy(pOH, pBkt, key);
+#endif  // defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
+}
+
+static __inline__ const void* __attribute__((always_inline)) _OAHashEntryKey(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* pBkt)
+{
+#if defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
+    return (*pOH->keyF)(pOH, pBkt);
+#else
+    return TCPIP_OAHASH_EntryKey(pOH, pBkt);
+#endif  // defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
+}
+
+// builds a descriptor for the bucket array being migrated
+// so that the regular bucket operations apply to it
+static void _OAHashOldView(OA_HASH_DCPT* pOH, OA_HASH_DCPT* pView)
+{
+    *pView = *pOH;
+    pView->memBlk = pOH->oldMemBlk;
+    pView->hEntries = pOH->oldEntries;
+    pView->fullSlots = pOH->oldFullSlots;
+    pView->oldMemBlk = 0;
+    pView->oldFullSlots = 0;
+}
+
+static __inline__ bool __attribute__((always_inline)) _OAHashIsOldBkt(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* pOE)
+{
+    uint8_t* pOld = (uint8_t*)pOH->oldMemBlk;
+    return pOld != 0 && pOld <= (uint8_t*)pOE && (uint8_t*)pOE < pOld + pOH->oldEntries * pOH->hEntrySize;
+}
 
 static __inline__ void __attribute__((always_inline)) _OAHashRemoveEntry(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* pOE)
 {
+    OA_HASH_DCPT oldView;
+
     if(pOE->flags.busy)
     {
-        pOE->flags.busy = 0;
-        pOH->fullSlots--;
+        if(_OAHashIsOldBkt(pOH, pOE))
+        {   // not migrated yet
+            _OAHashOldView(pOH, &oldView);
+            _OAHashRobinHoodRemove(&oldView, pOE);
+            pOH->oldFullSlots--;
+        }
+        else if(_OAHashIsRobinHood(pOH))
+        {
+            _OAHashRobinHoodRemove(pOH, pOE);
+        }
+        else
+        {
+            pOE->flags.busy = 0;
+        }
+
+        if(--pOH->fullSlots == 0)
+        {   // no key left behind
+            pOH->maxProbe = 0;
+        }
     }
 }
 
@@ -90,16 +206,36 @@ static __inline__ void __attribute__((always_inline)) _OAHashRemoveEntry(OA_HASH
 // Initializes a OA hash table
 void TCPIP_OAHASH_Initialize(OA_HASH_DCPT* pOH)
 {
-    OA_HASH_ENTRY*  pHE;    
-    size_t  ix;
-
     pOH->fullSlots = 0; 
+    pOH->maxProbe = 0; 
+    pOH->oldMemBlk = 0;
+    pOH->oldEntries = 0;
+    pOH->oldFullSlots = 0;
+    pOH->migrateIx = 0;
+    pOH->migrateBkts = 0;
     
-    pHE = (OA_HASH_ENTRY*)pOH->memBlk;
-    for(ix = 0; ix < pOH->hEntries; ix++)
+    _OAHashClearBkts(pOH);
+}
+
+void TCPIP_OAHASH_Deinitialize(OA_HASH_DCPT* pOH)
+{
+    if(_OAHashIsResizable(pOH))
     {
-        pHE->flags.value = 0;
-        pHE = (OA_HASH_ENTRY*)((uint8_t*)pHE + pOH->hEntrySize);
+        if(pOH->oldMemBlk != 0)
+        {
+            (*pOH->freeF)(pOH, pOH->oldMemBlk);
+            pOH->oldMemBlk = 0;
+        }
+
+        if(pOH->memBlk != 0)
+        {
+            (*pOH->freeF)(pOH, pOH->memBlk);
+            pOH->memBlk = 0;
+        }
+
+        pOH->hEntries = 0;
+        pOH->fullSlots = 0;
+        pOH->oldFullSlots = 0;
     }
 }
 
@@ -107,44 +243,58 @@ void TCPIP_OAHASH_Initialize(OA_HASH_DCPT* pOH)
 // performs look up only
 // if no such entry found, it returns NULL
 OA_HASH_ENTRY* TCPIP_OAHASH_EntryLookup(OA_HASH_DCPT* pOH, const void* key)
+{
+    OA_HASH_DCPT    oldView;
+    OA_HASH_ENTRY*  pBkt = _OAHashLookup(pOH, key);
+
+    if(pBkt == 0 && pOH->oldMemBlk != 0)
+    {   // may not be migrated yet
+        _OAHashOldView(pOH, &oldView);
+        pBkt = _OAHashLookup(&oldView, key);
+    }
+
+    return pBkt;
+}
+
+// look up in one bucket array
+static OA_HASH_ENTRY* _OAHashLookup(OA_HASH_DCPT* pOH, const void* key)
 {
     OA_HASH_ENTRY*  pBkt;
-    size_t      bkts = 0;
+    size_t      bkts;
+    size_t      maxBkts;
     size_t      bktIx;
     size_t      probeStep;
+    bool        robinHood = _OAHashIsRobinHood(pOH);
    
     probeStep = _OAHashProbeStep(pOH, key);
-#if defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
-    bktIx = (*pOH->hashF)(pOH, key);
-#else
-    bktIx = TCPIP_OAHASH_KeyHash(pOH, key);
-#endif  // defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
+    bktIx = _OAHashKeyHash(pOH, key);
 
-    while(bkts < pOH->hEntries)
+    // no key is further than maxProbe from its hash bucket
+    maxBkts = robinHood ? pOH->hEntries : pOH->maxProbe + 1;
+
+    for(bkts = 0; bkts < maxBkts; bkts++)
     {
-        pBkt = (OA_HASH_ENTRY*)((uint8_t*)(pOH->memBlk) + bktIx * pOH->hEntrySize);
-#if defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
-        if(pBkt->flags.busy && (*pOH->cmpF)(pOH, pBkt, key) == 0)
-        {   // found entry
-            pBkt->flags.newEntry = 0;
-            return pBkt;
+        pBkt = _OAHashBkt(pOH, bktIx);
+        if(pBkt->flags.busy != 0)
+        {
+            if(robinHood && pBkt->probeCount < bkts)
+            {   // the key would have taken this bucket
+                break;
+            }
+
+            if(_OAHashKeyCompare(pOH, pBkt, key) == 0)
+            {   // found entry
+                pBkt->flags.newEntry = 0;
+                return pBkt;
+            }
         }
-#else
-        if(pBkt->flags.busy && TCPIP_OAHASH_KeyCompare(pOH, pBkt, key) == 0)
-        {   // found entry
-            pBkt->flags.newEntry = 0;
-            return pBkt;
+        else if(robinHood)
+        {   // there are no gaps in a Robin Hood probe sequence
+            break;
         }
-#endif  // defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
 
         // advance to the next hash slot
-        bktIx += probeStep;
-        if(bktIx >= pOH->hEntries)
-        {
-            bktIx -= pOH->hEntries;
-        }
-
-        bkts++;
+        bktIx = _OAHashNextBkt(pOH, bktIx, probeStep);
     }
     
     return 0;   // not found
@@ -156,6 +306,9 @@ OA_HASH_ENTRY* TCPIP_OAHASH_EntryLookup(OA_HASH_DCPT* pOH, const void* key)
 // the key in this slot and newEntry flag will be set
 // If there's no room in the hash it will call the delF to empty
 // a slot and place the key there 
+// During a resize the delF sees only the current bucket array:
+// TCPIP_OAHASH_EntryRange(), TCPIP_OAHASH_EntryGet() and the iterator
+// leave out the entries not migrated yet.
 // If the delF is NULL it will return NULL.
 // NULL is also returned when the probeStep is not properly chosen and
 // the hash cannot be properly traversed in one pass
@@ -164,31 +317,55 @@ OA_HASH_ENTRY* TCPIP_OAHASH_EntryLookup(OA_HASH_DCPT* pOH, const void* key)
 OA_HASH_ENTRY*   TCPIP_OAHASH_EntryLookupOrInsert(OA_HASH_DCPT* pOH, const void* key)
 {
     OA_HASH_ENTRY   *pBkt, *pDel;
+    OA_HASH_DCPT    oldView;
+    size_t          maxSlots;
+    void*           oldMemBlk;
+    bool            robinHood = _OAHashIsRobinHood(pOH);
+
+    if(pOH->oldMemBlk != 0)
+    {   // resize in progress: move some more entries along
+        _OAHashMigrate(pOH, OA_HASH_INSERT_MIGRATE_STEPS);
+        if(pOH->oldFullSlots != 0)
+        {
+            _OAHashOldView(pOH, &oldView);
+            if((pBkt = _OAHashLookup(&oldView, key)) != 0)
+            {   // not migrated yet
+                return pBkt;
+            }
+        }
+    }
 
-    pBkt = _OAHashFindBkt(pOH, key);
+    // a Robin Hood hash keeps one bucket empty
+    maxSlots = robinHood ? pOH->hEntries - 1 : pOH->hEntries;
+
+    pBkt = robinHood ? _OAHashRobinHoodFindBkt(pOH, key) : _OAHashFindBkt(pOH, key);
     if(pBkt == 0)
     {
-        if(pOH->fullSlots != pOH->hEntries)
+        if(pOH->fullSlots - pOH->oldFullSlots < maxSlots)
         {   // wrong probeStep!
             return 0;
         }
         
         // else cache is full
         // discard an old entry and retry
+        // while resizing, the entries not migrated yet take no room in the current array:
+        // they are hidden, the delete function picks from the current array only
+        oldMemBlk = pOH->oldMemBlk;
+        pOH->oldMemBlk = 0;
 #if defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
-        if(pOH->delF == 0 || (pDel = (*pOH->delF)(pOH)) == 0)
-        {   // nothing else we can do
-            return 0;
-        }
+        pDel = pOH->delF != 0 ? (*pOH->delF)(pOH) : 0;
 #else
-        if((pDel = TCPIP_OAHASH_EntryDelete(pOH)) == 0)
+        pDel = TCPIP_OAHASH_EntryDelete(pOH);
+#endif  // defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
+        pOH->oldMemBlk = oldMemBlk;
+
+        if(pDel == 0)
         {   // nothing else we can do
             return 0;
         }
-#endif  // defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
 
         _OAHashRemoveEntry(pOH, pDel);
-        pBkt = _OAHashFindBkt(pOH, key);
+        pBkt = robinHood ? _OAHashRobinHoodFindBkt(pOH, key) : _OAHashFindBkt(pOH, key);
         if(pBkt == 0)
         {   // probeStep failure, again
             return 0;
@@ -228,28 +405,52 @@ void TCPIP_OAHASH_EntriesRemoveAll(OA_HASH_DCPT* pOH)
     OA_HASH_ENTRY*  pBkt;
     size_t      bktIx;
     
+    // everything goes, no need to shift anything
     pBkt = (OA_HASH_ENTRY*)pOH->memBlk;
     for(bktIx = 0; bktIx < pOH->hEntries; bktIx++)
     {
-        if(pBkt->flags.busy)
-        {   // found entry
-            _OAHashRemoveEntry(pOH, pBkt);
-        }
-
+        pBkt->flags.busy = 0;
         pBkt = (OA_HASH_ENTRY*)((uint8_t*)pBkt + pOH->hEntrySize);
     }
+
+    if(pOH->oldMemBlk != 0)
+    {   // nothing left to migrate
+        // the old array is released by the next TCPIP_OAHASH_ResizeStep()
+        pBkt = (OA_HASH_ENTRY*)pOH->oldMemBlk;
+        for(bktIx = 0; bktIx < pOH->oldEntries; bktIx++)
+        {
+            pBkt->flags.busy = 0;
+            pBkt = (OA_HASH_ENTRY*)((uint8_t*)pBkt + pOH->hEntrySize);
+        }
+        pOH->oldFullSlots = 0;
+        pOH->migrateBkts = 0;
+    }
+
+    pOH->fullSlots = 0;
+    pOH->maxProbe = 0;
 }
 
 OA_HASH_ENTRY* TCPIP_OAHASH_EntryGet(OA_HASH_DCPT* pOH, size_t entryIx)
 {
     if(entryIx < pOH->hEntries)
     {
-        return (OA_HASH_ENTRY*)((uint8_t*)(pOH->memBlk) + entryIx * pOH->hEntrySize);
+        return _OAHashBkt(pOH, entryIx);
+    }
+
+    entryIx -= pOH->hEntries;
+    if(pOH->oldMemBlk != 0 && entryIx < pOH->oldEntries)
+    {   // the old array indexes follow the current ones
+        return (OA_HASH_ENTRY*)((uint8_t*)pOH->oldMemBlk + entryIx * pOH->hEntrySize);
     }
 
     return 0;
 }
 
+size_t TCPIP_OAHASH_EntryRange(OA_HASH_DCPT* pOH)
+{
+    return pOH->oldMemBlk != 0 ? pOH->hEntries + pOH->oldEntries : pOH->hEntries;
+}
+
 int32_t TCPIP_OAHASH_EntryGetIndex(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* pHe)
 {
     if(pOH != 0 && pHe != 0)
@@ -268,67 +469,385 @@ int32_t TCPIP_OAHASH_EntryGetIndex(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* pHe)
                 return (int32_t)entryIx;
             }
         } 
+        else if(_OAHashIsOldBkt(pOH, pHe))
+        {
+            size_t entryIx = ((uint8_t*)pHe - (uint8_t*)pOH->oldMemBlk) / pOH->hEntrySize;
+            pBkt = (OA_HASH_ENTRY*)((uint8_t*)pOH->oldMemBlk + entryIx * pOH->hEntrySize);
+            if(pBkt == pHe)
+            {
+                return (int32_t)(pOH->hEntries + entryIx);
+            }
+        }
     }
 
     return -1;
 }
 
+void TCPIP_OAHASH_IteratorInit(OA_HASH_DCPT* pOH, OA_HASH_ITERATOR* pIter)
+{
+    _OAHashIterStart(pOH, pIter);
+    pIter->fullSlots = pOH->fullSlots;
+    pIter->pEntry = 0;
+    pIter->oldTbl = false;
+}
+
+// positions the iterator at the start of a bucket array
+static void _OAHashIterStart(OA_HASH_DCPT* pOH, OA_HASH_ITERATOR* pIter)
+{
+    size_t bktIx = 0;
+
+    if(_OAHashIsRobinHood(pOH))
+    {   // start right after an empty bucket and follow the probe sequence:
+        // a backward shift never crosses the empty bucket, so it only moves
+        // entries that are still to be visited towards the current bucket
+        while(bktIx < pOH->hEntries && _OAHashBkt(pOH, bktIx)->flags.busy != 0)
+        {
+            bktIx++;
+        }
+
+        bktIx = bktIx < pOH->hEntries ? _OAHashNextBkt(pOH, bktIx, pOH->probeStep) : 0;
+    }
+
+    pIter->bktIx = bktIx;
+    pIter->nBkts = pOH->hEntries;
+}
+
+OA_HASH_ENTRY* TCPIP_OAHASH_IteratorNext(OA_HASH_DCPT* pOH, OA_HASH_ITERATOR* pIter)
+{
+    OA_HASH_ENTRY*  pBkt;
+    OA_HASH_DCPT    oldView;
+    OA_HASH_DCPT*   pTbl = pOH;
+    size_t          step = _OAHashIsRobinHood(pOH) ? pOH->probeStep : 1;
+
+    if(pIter->oldTbl)
+    {
+        _OAHashOldView(pOH, &oldView);
+        pTbl = &oldView;
+    }
+
+    if(pIter->pEntry != 0)
+    {
+        pIter->pEntry = 0;
+        if(pOH->fullSlots == pIter->fullSlots)
+        {   // done with this bucket
+            pIter->bktIx = _OAHashNextBkt(pTbl, pIter->bktIx, step);
+            pIter->nBkts--;
+        }
+        // else the entry was removed; another one may have been shifted in
+    }
+
+    while(true)
+    {
+        while(pIter->nBkts != 0)
+        {
+            pBkt = _OAHashBkt(pTbl, pIter->bktIx);
+            if(pBkt->flags.busy != 0)
+            {
+                pIter->pEntry = pBkt;
+                pIter->fullSlots = pOH->fullSlots;
+                return pBkt;
+            }
+
+            pIter->bktIx = _OAHashNextBkt(pTbl, pIter->bktIx, step);
+            pIter->nBkts--;
+        }
+
+        if(pIter->oldTbl || pOH->oldMemBlk == 0)
+        {
+            return 0;
+        }
+
+        // continue with the entries not migrated yet
+        // no migration occurs during the traversal, the old array stays in place
+        _OAHashOldView(pOH, &oldView);
+        pTbl = &oldView;
+        _OAHashIterStart(pTbl, pIter);
+        pIter->oldTbl = true;
+    }
+}
+
+bool TCPIP_OAHASH_ResizeStep(OA_HASH_DCPT* pOH, size_t nSteps)
+{
+    size_t  newEntries;
+    void*   newBlk;
+
+    if(!_OAHashIsResizable(pOH))
+    {
+        return false;
+    }
+
+    if(pOH->oldMemBlk != 0)
+    {
+        _OAHashMigrate(pOH, nSteps);
+        if(pOH->migrateBkts == 0)
+        {   // all moved
+            (*pOH->freeF)(pOH, pOH->oldMemBlk);
+            pOH->oldMemBlk = 0;
+            pOH->oldEntries = 0;
+            pOH->oldFullSlots = 0;
+        }
+    }
+    else if((newEntries = _OAHashResizeTarget(pOH)) != 0)
+    {
+        if((newBlk = (*pOH->allocF)(pOH, newEntries * pOH->hEntrySize)) != 0)
+        {   // the current array becomes the old one, the new one starts empty
+            // the migration starts right before an empty bucket
+            pOH->migrateIx = 0;
+            while(_OAHashBkt(pOH, pOH->migrateIx)->flags.busy != 0)
+            {   // there's always one
+                pOH->migrateIx++;
+            }
+            pOH->migrateIx = _OAHashPrevBkt(pOH, pOH->migrateIx);
+            pOH->migrateBkts = pOH->hEntries;
+            pOH->oldMemBlk = pOH->memBlk;
+            pOH->oldEntries = pOH->hEntries;
+            pOH->oldFullSlots = pOH->fullSlots;
+            pOH->memBlk = newBlk;
+            pOH->hEntries = newEntries;
+            _OAHashClearBkts(pOH);
+        }
+        // else retry next time
+    }
+
+    return pOH->oldMemBlk != 0;
+}
+
 // implementation
 
+static void _OAHashClearBkts(OA_HASH_DCPT* pOH)
+{
+    OA_HASH_ENTRY*  pHE;    
+    size_t  ix;
+
+    pHE = (OA_HASH_ENTRY*)pOH->memBlk;
+    for(ix = 0; ix < pOH->hEntries; ix++)
+    {
+        pHE->flags.value = 0;
+        pHE = (OA_HASH_ENTRY*)((uint8_t*)pHE + pOH->hEntrySize);
+    }
+}
+
+// returns the new number of buckets if the load is out of range
+// 0 otherwise
+static size_t _OAHashResizeTarget(OA_HASH_DCPT* pOH)
+{
+    size_t newEntries;
+    size_t load = pOH->fullSlots * 100;
+
+    if(load >= pOH->hEntries * pOH->growLoad && pOH->hEntries < pOH->maxEntries)
+    {
+        newEntries = pOH->hEntries * 2;
+        return newEntries < pOH->maxEntries ? newEntries : pOH->maxEntries;
+    }
+
+    if(load < pOH->hEntries * pOH->shrinkLoad && pOH->hEntries > pOH->minEntries)
+    {
+        newEntries = pOH->hEntries / 2;
+        if(newEntries < pOH->minEntries)
+        {
+            newEntries = pOH->minEntries;
+        }
+
+        if(load < newEntries * pOH->growLoad)
+        {   // the smaller array wouldn't need to grow right away
+            return newEntries;
+        }
+    }
+
+    return 0;
+}
+
+// moves entries from the old bucket array to the current one
+// The old array is walked backwards along the probe sequence,
+// starting before an empty bucket: the bucket following the migrated one
+// is always empty, so its backward shift deletion moves nothing
+// and the old array remains a valid Robin Hood table for the look ups.
+// The user removals don't disturb that either: their backward shift
+// stops at the migrated (empty) buckets.
+static void _OAHashMigrate(OA_HASH_DCPT* pOH, size_t nSteps)
+{
+    OA_HASH_DCPT    oldView;
+    OA_HASH_ENTRY   *pOld, *pNew;
+    uint16_t        probeCount;
+
+    _OAHashOldView(pOH, &oldView);
+
+    for(; nSteps != 0 && pOH->migrateBkts != 0; nSteps--)
+    {
+        pOld = _OAHashBkt(&oldView, pOH->migrateIx);
+        if(pOld->flags.busy != 0)
+        {
+            pNew = _OAHashRobinHoodFindBkt(pOH, _OAHashEntryKey(pOH, pOld));
+            if(pNew == 0)
+            {   // no room in the current array; retry once entries are removed
+                break;
+            }
+
+            if(pNew->flags.busy == 0)
+            {   // just inserted: take over the entry data
+                probeCount = pNew->probeCount;
+                memcpy(pNew, pOld, pOH->hEntrySize);
+                pNew->probeCount = probeCount;
+            }
+            // else the key is already in the current array; shouldn't happen
+
+            // counted again by _OAHashRobinHoodFindBkt() or dropped as a duplicate
+            pOH->fullSlots--;
+            pOH->oldFullSlots--;
+            _OAHashRobinHoodRemove(&oldView, pOld);
+        }
+
+        pOH->migrateIx = _OAHashPrevBkt(&oldView, pOH->migrateIx);
+        pOH->migrateBkts--;
+    }
+}
+
 // finds a entry that either contains the desired key
 // or is empty and can be used to insert the key 
+// the key is searched up to maxProbe, even past unused entries
+// that may have been left by removed keys
 static OA_HASH_ENTRY* _OAHashFindBkt(OA_HASH_DCPT* pOH, const void* key)
 {
     OA_HASH_ENTRY*  pBkt;
+    OA_HASH_ENTRY*  pFree;
     size_t      bktIx;
     size_t      probeStep;
-    size_t      bkts = 0;
+    size_t      bkts;
+    size_t      freeBkts = 0;
 
     probeStep = _OAHashProbeStep(pOH, key);
-#if defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
-    bktIx = (*pOH->hashF)(pOH, key);
-#else
-    bktIx = TCPIP_OAHASH_KeyHash(pOH, key);
-#endif  // defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
+    bktIx = _OAHashKeyHash(pOH, key);
 
-    while(bkts < pOH->hEntries)
+    pFree = 0;
+    for(bkts = 0; bkts < pOH->hEntries; bkts++)
     {
-        pBkt = (OA_HASH_ENTRY*)((uint8_t*)(pOH->memBlk) + bktIx * pOH->hEntrySize);
+        pBkt = _OAHashBkt(pOH, bktIx);
         if(pBkt->flags.busy == 0)
-        {   // found unused entry
-#if defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
-            (*pOH->cpyF)(pOH, pBkt, key);   // set the key
-#else
-            TCPIP_OAHASH_KeyCopy(pOH, pBkt, key);   // set the key
-#endif  // defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
-            pBkt->probeCount = bkts;
-            pOH->fullSlots++;
-            return pBkt;
+        {
+            if(pFree == 0)
+            {   // found unused entry
+                pFree = pBkt;
+                freeBkts = bkts;
+            }
         }
-
-#if defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
-        if((*pOH->cmpF)(pOH, pBkt, key) == 0)
+        else if(bkts <= pOH->maxProbe && _OAHashKeyCompare(pOH, pBkt, key) == 0)
         {   // found entry
             return pBkt;
         }
-#else
-        if(TCPIP_OAHASH_KeyCompare(pOH, pBkt, key) == 0)
+
+        if(pFree != 0 && bkts >= pOH->maxProbe)
+        {   // the key cannot be further away
+            break;
+        }
+
+        // advance to the next hash slot
+        bktIx = _OAHashNextBkt(pOH, bktIx, probeStep);
+    }
+
+    if(pFree != 0)
+    {
+        _OAHashKeyCopy(pOH, pFree, key);   // set the key
+        pFree->probeCount = freeBkts;
+        if(freeBkts > pOH->maxProbe)
+        {
+            pOH->maxProbe = freeBkts;
+        }
+        pOH->fullSlots++;
+    }
+    
+    return pFree;   // 0 if cache full, not found
+}
+
+// Robin Hood version of _OAHashFindBkt
+// along a probe sequence the entries are ordered by their home bucket
+// i.e. an entry is never further from its home than a following entry is from its own.
+// A new key takes the bucket of the first entry that's closer to home
+// and the rest of the sequence is shifted by one bucket, up to the first empty one.
+static OA_HASH_ENTRY* _OAHashRobinHoodFindBkt(OA_HASH_DCPT* pOH, const void* key)
+{
+    OA_HASH_ENTRY   *pBkt, *pPrev;
+    size_t      bktIx, insIx, prevIx;
+    size_t      bkts;
+    size_t      probeStep = pOH->probeStep;
+
+    bktIx = _OAHashKeyHash(pOH, key);
+    pBkt = 0;
+    for(bkts = 0; bkts < pOH->hEntries; bkts++)
+    {
+        pBkt = _OAHashBkt(pOH, bktIx);
+        if(pBkt->flags.busy == 0 || pBkt->probeCount < bkts)
+        {   // the key belongs here
+            break;
+        }
+
+        if(_OAHashKeyCompare(pOH, pBkt, key) == 0)
         {   // found entry
             return pBkt;
         }
-#endif  // defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
 
-        // advance to the next hash slot
-        bktIx += probeStep;
-        if(bktIx >= pOH->hEntries)
+        bktIx = _OAHashNextBkt(pOH, bktIx, probeStep);
+    }
+
+    if(bkts == pOH->hEntries || pOH->fullSlots - pOH->oldFullSlots >= pOH->hEntries - 1)
+    {   // not found and no room
+        return 0;
+    }
+
+    // find the first empty bucket
+    insIx = bktIx;
+    while(pBkt->flags.busy != 0)
+    {
+        bktIx = _OAHashNextBkt(pOH, bktIx, probeStep);
+        if(bktIx == insIx)
+        {   // wrong probeStep, the sequence doesn't cover the hash
+            return 0;
+        }
+        pBkt = _OAHashBkt(pOH, bktIx);
+    }
+
+    // shift towards it
+    while(bktIx != insIx)
+    {
+        prevIx = _OAHashPrevBkt(pOH, bktIx);
+        pPrev = _OAHashBkt(pOH, prevIx);
+        memcpy(pBkt, pPrev, pOH->hEntrySize);
+        pBkt->probeCount++;
+        pBkt = pPrev;
+        bktIx = prevIx;
+    }
+
+    // the bucket may hold a stale copy of a shifted entry
+    pBkt->flags.value = 0;
+    _OAHashKeyCopy(pOH, pBkt, key);   // set the key
+    pBkt->probeCount = bkts;
+    pOH->fullSlots++;
+
+    return pBkt;
+}
+
+// backward shift deletion:
+// the following entries on the probe sequence move one bucket back towards their home
+// until an empty bucket or an entry already in its home bucket
+static void _OAHashRobinHoodRemove(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* pOE)
+{
+    OA_HASH_ENTRY*  pNext;
+    size_t  bktIx = ((uint8_t*)pOE - (uint8_t*)pOH->memBlk) / pOH->hEntrySize;
+
+    while(true)
+    {
+        bktIx = _OAHashNextBkt(pOH, bktIx, pOH->probeStep);
+        pNext = _OAHashBkt(pOH, bktIx);
+        if(pNext->flags.busy == 0 || pNext->probeCount == 0)
         {
-            bktIx -= pOH->hEntries;
+            break;
         }
 
-        bkts++;
+        memcpy(pOE, pNext, pOH->hEntrySize);
+        pOE->probeCount--;
+        pOE = pNext;
     }
-    
-    return 0;   // cache full, not found
+
+    pOE->flags.busy = 0;
 }
 
 
@@ -100,8 +100,52 @@ typedef int (*OA_HASH_KEY_COMPARE_F)(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* hEntry, c
 // function that copies a key to a destination entry
 typedef void (*OA_HASH_KEY_COPY_F)(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* dstEntry, const void* srcKey);
 
+// function that returns a pointer to the key stored in an entry
+// used to re-hash the entries of a OA_HASH_FLAG_RESIZE hash
+typedef const void* (*OA_HASH_ENTRY_KEY_F)(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* hEntry);
+
 #endif  // defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
 
+// bucket array allocation function for a OA_HASH_FLAG_RESIZE hash
+// returns 0 if the memory is not available
+typedef void*   (*OA_HASH_ALLOC_F)(OA_HASH_DCPT* pOH, size_t nBytes);
+
+// frees a bucket array obtained with OA_HASH_ALLOC_F
+typedef void    (*OA_HASH_FREE_F)(OA_HASH_DCPT* pOH, void* memBlk);
+
+
+// hash behavior flags
+typedef enum
+{
+    OA_HASH_FLAG_NONE           = 0x00,     // default: an entry stays in the bucket it was inserted in
+                                            // the entry pointers and bucket indexes remain valid until the entry is removed
+
+    OA_HASH_FLAG_ROBIN_HOOD     = 0x01,     // Robin Hood insertion and backward shift deletion:
+                                            // the entries on a probe sequence are kept ordered by their probe distance
+                                            // so that an unsuccessful look up stops early and no deleted slots are left behind.
+                                            // The entries are moved (copied) to other buckets by the insertion and removal
+                                            // of other keys:
+                                            //  - the entry data has to be position independent
+                                            //  - an entry pointer or index is valid only until the next
+                                            //    TCPIP_OAHASH_EntryLookupOrInsert()/TCPIP_OAHASH_EntryRemove() call
+                                            //  - a traversal that removes entries has to use the TCPIP_OAHASH_Iterator functions
+                                            // One bucket is always kept empty, the hash holds at most hEntries - 1 entries.
+                                            // Ignored when OA_DOUBLE_HASH_PROBING is defined
+
+    OA_HASH_FLAG_RESIZE         = 0x02,     // the number of buckets follows the load:
+                                            // the hash doubles when the load reaches growLoad
+                                            // and halves when it drops under shrinkLoad, within minEntries - maxEntries.
+                                            // The new bucket array is allocated by TCPIP_OAHASH_ResizeStep()
+                                            // and the entries are moved to it a few at a time by the following
+                                            // TCPIP_OAHASH_ResizeStep()/TCPIP_OAHASH_EntryLookupOrInsert() calls;
+                                            // meanwhile the look ups search both arrays.
+                                            //  - needs OA_HASH_FLAG_ROBIN_HOOD: the same entry relocation rules apply
+                                            //  - needs allocF, freeF, keyF and a memBlk obtained from allocF
+                                            //  - the hashF result should depend only on the key and pOH->hEntries
+                                            //  - probeStep has to be prime with all the sizes in the range
+                                            //  - the bucket indexes cover both arrays while a resize is in progress:
+                                            //    a by index traversal should use TCPIP_OAHASH_EntryRange(), not hEntries
+}OA_HASH_FLAGS;
 
 
 // Descriptor of an Open Addressing Hash
@@ -117,8 +161,12 @@ typedef void (*OA_HASH_KEY_COPY_F)(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* dstEntry, c
 // when no memory allocation is needed/desired.
 // The number of entries is fixed and all the slots are
 // gradually filled.
+// (unless OA_HASH_FLAG_RESIZE is used and the hash
+// allocates a new bucket array when the load changes)
 // However, like with all Open Addressing hashes,
 // the performance degrades when the load factor gets >= 0.7
+// (less so for a OA_HASH_FLAG_ROBIN_HOOD hash, which keeps
+// the probe sequences short up to 0.9 and more)
 // Use the probeCount number to check the hash
 // performance and choose the number of entries carefully!
 // For best performance the number of elements should be prime
@@ -155,13 +203,51 @@ struct _TAG_OA_HASH_DCPT
     OA_HASH_KEY_COMPARE_F   cmpF;       // compare two keys function
     
     OA_HASH_KEY_COPY_F      cpyF;       // copy key function
+
+    OA_HASH_ENTRY_KEY_F     keyF;       // entry key function
+                                        // OA_HASH_FLAG_RESIZE only
 #endif  // defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
+    uint16_t                hFlags;     // OA_HASH_FLAGS value
+
+    // OA_HASH_FLAG_RESIZE parameters
+    // ignored by a fixed size hash
+    OA_HASH_ALLOC_F         allocF;     // bucket array allocation
+    OA_HASH_FREE_F          freeF;      // bucket array release
+    size_t                  minEntries; // range of hEntries
+    size_t                  maxEntries;
+    uint8_t                 growLoad;   // load percentage that doubles the hash
+    uint8_t                 shrinkLoad; // load percentage that halves the hash
+                                        // should be less than growLoad / 2
 
     // fields updated by the TCPIP_OAHASH_Initialize()
     // and maintained by the hash itself  
     size_t                  fullSlots;  // number of elements/slots having valid data                         
+                                        // including the ones not migrated yet
+    size_t                  maxProbe;   // longest probe sequence of an inserted key
+                                        // bounds the unsuccessful look ups
+                                        // reset when the hash gets empty
+                                        // not used for a OA_HASH_FLAG_ROBIN_HOOD hash
+    void*                   oldMemBlk;  // bucket array being migrated
+                                        // 0 if no resize in progress
+    size_t                  oldEntries; // number of buckets in oldMemBlk
+    size_t                  oldFullSlots; // entries not migrated yet
+    size_t                  migrateIx;  // next oldMemBlk bucket to migrate
+    size_t                  migrateBkts;// oldMemBlk buckets left to migrate
 };
 
+// Iterator for a full hash traversal
+// The caller is allowed to remove the entry returned by TCPIP_OAHASH_IteratorNext()
+// before the next call, every other entry is still visited exactly once.
+// No other insertion/removal is allowed during the traversal.
+typedef struct
+{
+    size_t                  bktIx;      // current bucket
+    size_t                  nBkts;      // buckets left to traverse
+    size_t                  fullSlots;  // hash fullSlots when the current entry was returned
+    OA_HASH_ENTRY*          pEntry;     // last returned entry
+    bool                    oldTbl;     // traversing the buckets not migrated yet
+}OA_HASH_ITERATOR;
+
 
 // Definition of a OA hash entry
 // Note that the key is not described here!
@@ -199,6 +285,11 @@ struct _TAG_OA_HASH_ENTRY
 // all entries have their flags field cleared.
 void            TCPIP_OAHASH_Initialize(OA_HASH_DCPT* pOH);
 
+// Releases the bucket arrays of a OA_HASH_FLAG_RESIZE hash,
+// memBlk included.
+// Nothing to do for a fixed size hash.
+void            TCPIP_OAHASH_Deinitialize(OA_HASH_DCPT* pOH);
+
 
 // performs look up only
 // if no such entry found, it returns NULL
@@ -210,6 +301,9 @@ OA_HASH_ENTRY*   TCPIP_OAHASH_EntryLookup(OA_HASH_DCPT* pOH, const void* key);
 // the key in this slot and newEntry flag will be set
 // If there's no room in the hash it will call the delF to empty
 // a slot and place the key there 
+// During a resize the delF sees only the current bucket array:
+// TCPIP_OAHASH_EntryRange(), TCPIP_OAHASH_EntryGet() and the iterator
+// leave out the entries not migrated yet.
 // If the delF is NULL it will return NULL.
 // NULL is also returned when the probeStep is not properly chosen and
 // the hash cannot be properly traversed in one pass
@@ -222,6 +316,8 @@ OA_HASH_ENTRY*   TCPIP_OAHASH_EntryLookupOrInsert(OA_HASH_DCPT* pOH, const void*
 // because the hash also has to do some internal clean-up.
 // Note: when an entry is deleted by TCPIP_OAHASH_EntryLookupOrInsert (calling pOH->delF)
 // the hash state is maintained internally, no need to call TCPIP_OAHASH_EntryRemove();
+// For a OA_HASH_FLAG_ROBIN_HOOD hash the entries following on the probe sequence
+// are shifted back, so the bucket may hold another entry after the call.
 void            TCPIP_OAHASH_EntryRemove(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* pOE);
 
 
@@ -232,14 +328,34 @@ void            TCPIP_OAHASH_EntriesRemoveAll(OA_HASH_DCPT* pOH);
 
 
 // helper to return an pointer to an entry
-// entryIx should be < hEntries
+// entryIx should be < TCPIP_OAHASH_EntryRange()
 // otherwise it returns 0 
 OA_HASH_ENTRY*  TCPIP_OAHASH_EntryGet(OA_HASH_DCPT* pOH, size_t entryIx);
 
 // helper to return the index of a hash entry
 // returns an index >= 0 if success
 // returns < 0 if failure
-int32_t         TCPIP_OAHASH_EntryGetIndex(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* pHe);       
+int32_t         TCPIP_OAHASH_EntryGetIndex(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* pHe);
+
+// starts a full traversal of the hash
+void            TCPIP_OAHASH_IteratorInit(OA_HASH_DCPT* pOH, OA_HASH_ITERATOR* pIter);
+
+// returns the next busy entry of the traversal
+// or 0 if all the buckets have been visited
+OA_HASH_ENTRY*  TCPIP_OAHASH_IteratorNext(OA_HASH_DCPT* pOH, OA_HASH_ITERATOR* pIter);       
+
+// returns the number of bucket indexes accepted by TCPIP_OAHASH_EntryGet()
+// this is hEntries, plus oldEntries while a resize is in progress
+size_t          TCPIP_OAHASH_EntryRange(OA_HASH_DCPT* pOH);
+
+// Periodic maintenance of a OA_HASH_FLAG_RESIZE hash:
+// starts a resize when the load is out of the growLoad - shrinkLoad range
+// or moves up to nSteps buckets of a resize in progress to the new array.
+// This is the only call that allocates or frees memory;
+// a failed allocation is retried on the next call.
+// Returns true while a resize is in progress.
+// Entry pointers and indexes are not valid across the call.
+bool            TCPIP_OAHASH_ResizeStep(OA_HASH_DCPT* pOH, size_t nSteps);
 
 #if !defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
 
@@ -266,6 +382,9 @@ int             TCPIP_OAHASH_KeyCompare(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* hEntry
 // function that copies a key to a destination entry
 void            TCPIP_OAHASH_KeyCopy(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* dstEntry, const void* srcKey);
 
+// function that returns a pointer to the key stored in an entry
+const void*     TCPIP_OAHASH_EntryKey(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* hEntry);
+
 #endif  // !defined ( OA_HASH_DYNAMIC_KEY_MANIPULATION )
 
 #endif //  _HASH_TBL_H_
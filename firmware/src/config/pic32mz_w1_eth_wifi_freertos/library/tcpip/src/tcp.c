@@ -44,6 +44,7 @@ Microchip or any third party.
 
 #include "tcpip/src/tcpip_private.h"
 #include "tcpip/src/tcp_private.h"
+#include "tcpip/src/hash_fnv.h"
 
 #if defined(TCPIP_STACK_USE_TCP)
 
@@ -115,6 +116,11 @@ static unsigned int TcpSockets;                      // number of sockets in the
 
 static tcpipSignalHandle    tcpSignalHandle = 0;
 
+#if (_TCP_IDLE_TICK_RATE != 0)
+static bool                 tcpTickIdle;                // the TCP timer runs at the idle rate
+static bool                 tcpTickWake;                // a socket became active during the current tick
+#endif  // (_TCP_IDLE_TICK_RATE != 0)
+
 static uint16_t             tcpDefTxSize;               // default size of the TX buffer
 static uint16_t             tcpDefRxSize;               // default size of the RX buffer
 
@@ -132,6 +138,27 @@ static const void* tcpPktHandlerParam;
 
 static uint32_t             sysTickFreq;            // the system tick counter frequency; frequently used 
 
+#if (_TCP_SYN_COOKIES != 0)
+static uint32_t             tcpCookieKey[16 / 4];       // SYN cookie secret key
+static uint32_t             tcpCookieTime;              // last time a SYN cookie was sent, ticks
+static bool                 tcpCookieActive;            // SYN cookies were sent recently; ACKs to listening sockets are checked
+
+// MSS values that can be encoded in a SYN cookie
+static const uint16_t       tcpCookieMssTbl[] = {536, 1024, 1200, 1300, 1360, 1400, 1440, 1460};
+#endif  // (_TCP_SYN_COOKIES != 0)
+
+#if (_TCP_SYN_RATE_LIMIT != 0)
+static TCP_SYN_SOURCE       tcpSynSources[TCPIP_TCP_SYN_RATE_SOURCES];  // recent SYN sources
+static uint32_t             tcpSynSourceKey[16 / 4];    // secret key of the SYN source hash
+#endif  // (_TCP_SYN_RATE_LIMIT != 0)
+
+#if (_TCP_AUTO_TUNE != 0)
+static volatile uint32_t    tcpTaskSeq;                 // incremented when TCPIP_TCP_Task starts and ends; odd while it runs
+static uint32_t             tcpTuneBytes;               // buffer space the auto tuning added above the sockets base sizes
+static uint32_t             tcpTuneFailTime;            // last time a TCP buffer allocation failed, ticks; 0 if none
+static bool                 tcpTunePressure;            // heap low; buffers are not grown and grown buffers are released
+#endif  // (_TCP_AUTO_TUNE != 0)
+
 /****************************************************************************
   Section:
     Function Prototypes
@@ -142,6 +169,7 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t len, TCPIP_MAC
 static TCB_STUB* _TcpFindMatchingSocket(TCPIP_MAC_PACKET* pRxPkt, const void * remoteIP, const void * localIP, IP_ADDRESS_TYPE addressType);
 static void _TcpSwapHeader(TCP_HEADER* header);
 static void _TcpCloseSocket(TCB_STUB* pSkt, TCPIP_TCP_SIGNAL_TYPE tcpEvent);
+static void _TcpSocketTxPktRelease(TCB_STUB* pSkt, bool freePkt);
 static void _TcpSocketInitialize(TCB_STUB* pSkt, TCP_SOCKET hTCP, uint8_t* txBuff, uint16_t txBuffSize, uint8_t* rxBuff, uint16_t rxBuffSize);
 static void _TcpSocketSetIdleState(TCB_STUB* pSkt);
 
@@ -169,6 +197,30 @@ static __inline__ uint16_t __attribute__((always_inline)) _TcpSktGetSignalLocked
 static void _TcpAbort(TCB_STUB* pSkt, _TCP_ABORT_FLAGS abFlags, TCPIP_TCP_SIGNAL_TYPE tcpEvent);
 static _TCP_SEND_RES _TcpDisconnect(TCB_STUB* pSkt, bool signalFIN);
 
+#if (_TCP_LISTEN_BACKLOG != 0)
+static TCB_STUB*    _TcpListenChildCreate(TCB_STUB* pListen);
+static void         _TcpListenUnlink(TCB_STUB* pSkt);
+static void         _TcpAcceptQueueAdd(TCB_STUB* pChild);
+#if (_TCP_SYN_COOKIES != 0)
+static bool         _TcpListenEmbryonicDrop(TCB_STUB* pListen);
+#endif  // (_TCP_SYN_COOKIES != 0)
+#endif  // (_TCP_LISTEN_BACKLOG != 0)
+
+#if (_TCP_SYN_COOKIES != 0)
+static void         _TcpSynCookieKeySet(void);
+static uint32_t     _TcpSynCookieHash(const void* remoteIP, const void* localIP, IP_ADDRESS_TYPE addType, const TCP_HEADER* h, uint32_t remoteISN, uint32_t cookieTag);
+static uint32_t     _TcpSynCookieGet(const void* remoteIP, const void* localIP, IP_ADDRESS_TYPE addType, TCP_HEADER* h);
+static uint16_t     _TcpSynCookieCheck(const void* remoteIP, const void* localIP, IP_ADDRESS_TYPE addType, const TCP_HEADER* h);
+static uint16_t     _TcpLocalMssGet(TCB_STUB* pSkt);
+static void         _TcpListenUnbind(TCB_STUB* pSkt);
+static uint16_t     _GetMaxSegSizeOption(TCP_HEADER* h);
+#endif  // (_TCP_SYN_COOKIES != 0)
+
+#if (_TCP_SYN_RATE_LIMIT != 0)
+static uint32_t     _TcpSynSourceHash(const void* remoteIP, size_t addSize);
+static bool         _TcpSynRateCheck(const void* remoteIP, IP_ADDRESS_TYPE addType);
+#endif  // (_TCP_SYN_RATE_LIMIT != 0)
+
 
 static void         TCPIP_TCP_Tick(void);
 
@@ -189,6 +241,8 @@ typedef enum
 
 static TCP_SOCKET   _TCP_Open(IP_ADDRESS_TYPE addType, TCP_OPEN_TYPE opType, TCP_PORT port, IP_MULTI_ADDRESS* address);
 
+static TCB_STUB*    _TcpSocketCreate(IP_ADDRESS_TYPE addType, uint16_t txBuffSize, uint16_t rxBuffSize);
+
 static TCP_SOCKET_FLAGS _TCP_SktFlagsGet(TCB_STUB* pSkt);
 
 static uint32_t         _TCP_SktSetSequenceNo(const TCB_STUB* pSkt);
@@ -247,6 +301,49 @@ static bool         _TCPNeedSend(TCB_STUB* pSkt);
 
 static void         _TCPSetHalfFlushFlag(TCB_STUB* pSkt);
 
+#if (TCPIP_TCP_DYNAMIC_OPTIONS != 0)
+static bool         _TcpFifoSizeAdjust(TCB_STUB* pSkt, uint16_t wMinRXSize, uint16_t wMinTXSize, TCP_ADJUST_FLAGS vFlags, bool autoTune);
+#endif  // (TCPIP_TCP_DYNAMIC_OPTIONS != 0)
+
+#if (_TCP_AUTO_TUNE != 0)
+static void         _TcpAutoTune(TCB_STUB* pSkt);
+static uint16_t     _TcpAutoTuneGrowSize(uint16_t currSize, uint32_t maxSize);
+static void         _TcpAutoTuneTick(void);
+
+// excess of the socket buffers over the base sizes
+static __inline__ uint32_t __attribute__((always_inline)) _TcpAutoTuneExcess(TCB_STUB* pSkt)
+{
+    uint32_t txSize = pSkt->txEnd - pSkt->txStart - 1;
+    uint32_t rxSize = pSkt->rxEnd - pSkt->rxStart;
+
+    return (txSize > pSkt->tuneTxBase ? txSize - pSkt->tuneTxBase : 0) + (rxSize > pSkt->tuneRxBase ? rxSize - pSkt->tuneRxBase : 0);
+}
+
+// the handshake completed; store its round trip time
+static __inline__ void __attribute__((always_inline)) _TcpAutoTuneRtt(TCB_STUB* pSkt)
+{
+    if(pSkt->tuneRxMeas == TCP_TUNE_MEAS_SYN)
+    {
+        pSkt->tuneRxRtt = SYS_TMR_TickCountGet() - pSkt->tuneRxStart;
+        pSkt->tuneRxMeas = TCP_TUNE_MEAS_NONE;
+    }
+}
+
+// performs the buffer changes requested by the stack, if any
+// called from the socket user context
+static __inline__ void __attribute__((always_inline)) _TcpAutoTuneCheck(TCB_STUB* pSkt)
+{
+    if((pSkt->tuneTxLimited | pSkt->tuneRxLimited | pSkt->tuneShrink) != 0)
+    {
+        _TcpAutoTune(pSkt);
+    }
+}
+#endif  // (_TCP_AUTO_TUNE != 0)
+
+#if (_TCP_QUICK_ACK != 0)
+static bool         _TcpQuickAckCheck(TCB_STUB* pSkt, bool outOfOrder);
+#endif  // (_TCP_QUICK_ACK != 0)
+
 static bool         _TCPSetSourceAddress(TCB_STUB* pSkt, IP_ADDRESS_TYPE addType, IP_MULTI_ADDRESS* localAddress)
 {
     if(localAddress == 0)
@@ -339,6 +436,36 @@ static __inline__ bool __attribute__((always_inline)) _TCP_IsConnected(TCB_STUB*
     return (pSkt->smState == TCPIP_TCP_STATE_ESTABLISHED || pSkt->smState == TCPIP_TCP_STATE_FIN_WAIT_1 || pSkt->smState == TCPIP_TCP_STATE_FIN_WAIT_2 || pSkt->smState == TCPIP_TCP_STATE_CLOSE_WAIT);
 } 
 
+#if (_TCP_IDLE_TICK_RATE != 0)
+// sockets in these states need no timer processing
+static __inline__ bool __attribute__((always_inline)) _TcpStateIsQuiet(TCPIP_TCP_STATE state)
+{
+    return state == TCPIP_TCP_STATE_LISTEN || state == TCPIP_TCP_STATE_CLIENT_WAIT_CONNECT || state == TCPIP_TCP_STATE_KILLED;
+}
+
+static __inline__ bool __attribute__((always_inline)) _TcpSocketIsQuiet(TCB_STUB* pSkt)
+{
+    return _TcpStateIsQuiet(pSkt->smState) && pSkt->Flags.bTimerEnabled == 0 && pSkt->Flags.bTimer2Enabled == 0 &&
+           pSkt->Flags.bDelayedACKTimerEnabled == 0 && pSkt->Flags.bTXASAP == 0 && pSkt->Flags.bTXASAPWithoutTimerReset == 0;
+}
+
+// a socket becomes active: restore the regular TCP timer rate
+static void _TcpTickWake(TCPIP_TCP_STATE newState)
+{
+    if(!_TcpStateIsQuiet(newState))
+    {
+        tcpTickWake = true;
+        if(tcpTickIdle)
+        {
+            tcpTickIdle = false;
+            _TCPIPStackSignalHandlerSetParams(TCPIP_THIS_MODULE_ID, tcpSignalHandle, TCPIP_TCP_TASK_TICK_RATE);
+        }
+    }
+}
+#else
+#define _TcpTickWake(newState)
+#endif  // (_TCP_IDLE_TICK_RATE != 0)
+
 #if ((TCPIP_TCP_DEBUG_LEVEL & TCPIP_TCP_DEBUG_MASK_TRACE_STATE) != 0)
 static const char* _tcpTraceStateName[] = 
 {
@@ -368,6 +495,7 @@ static void _TcpSocketSetState(TCB_STUB* pSkt, TCPIP_TCP_STATE newState)
         } 
     }
     pSkt->smState = newState;
+    _TcpTickWake(newState);
 }
 
 static uint32_t    _tcpTraceMask = 0;      // currently only first 32 sockets could be traced from the creation moment
@@ -400,6 +528,7 @@ bool TCPIP_TCP_SocketTraceSet(TCP_SOCKET sktNo, bool enable)
 static __inline__ void __attribute__((always_inline)) _TcpSocketSetState(TCB_STUB* pSkt, TCPIP_TCP_STATE newState)
 {
     pSkt->smState = newState;
+    _TcpTickWake(newState);
 }
 bool TCPIP_TCP_SocketTraceSet(TCP_SOCKET sktNo, bool enable)
 {
@@ -450,14 +579,23 @@ static bool TCPIP_TCP_CheckRxPkt(TCP_HEADER* pHdr)
 
 /*static __inline__*/static  void /*__attribute__((always_inline))*/ _TcpSocketKill(TCB_STUB* pSkt)
 {
+#if (_TCP_LISTEN_BACKLOG != 0)
+    _TcpListenUnlink(pSkt);
+#endif  // (_TCP_LISTEN_BACKLOG != 0)
     _TcpSocketSetState(pSkt, TCPIP_TCP_STATE_KILLED);       // trace purpose only
     
     OSAL_CRITSECT_DATA_TYPE status = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
     TCBStubs[pSkt->sktIx] = 0;
+#if (_TCP_AUTO_TUNE != 0)
+    tcpTuneBytes -= _TcpAutoTuneExcess(pSkt);
+#endif  // (_TCP_AUTO_TUNE != 0)
     OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, status);
 
     TCPIP_HEAP_Free(tcpHeapH, (void*)pSkt->rxStart);
     TCPIP_HEAP_Free(tcpHeapH, (void*)pSkt->txStart);
+#if (_TCP_AUTO_TUNE != 0)
+    TCPIP_HEAP_Free(tcpHeapH, pSkt->tuneTxOld);
+#endif  // (_TCP_AUTO_TUNE != 0)
     TCPIP_HEAP_Free(tcpHeapH, pSkt);
 }
 
@@ -710,6 +848,9 @@ bool TCPIP_TCP_Initialize(const TCPIP_STACK_MODULE_CTRL* const stackInit, const
     tcpQuietDone = false;
     tcpStartTime = 0;
 #endif  // (TCPIP_TCP_QUIET_TIME != 0)
+#if (_TCP_IDLE_TICK_RATE != 0)
+    tcpTickIdle = tcpTickWake = false;
+#endif  // (_TCP_IDLE_TICK_RATE != 0)
 #if ((TCPIP_TCP_DEBUG_LEVEL & TCPIP_TCP_DEBUG_MASK_TRACE_STATE) != 0)
     _tcpTraceMask = 0;
 #endif  // ((TCPIP_TCP_DEBUG_LEVEL & TCPIP_TCP_DEBUG_MASK_TRACE_STATE) != 0)
@@ -739,6 +880,20 @@ bool TCPIP_TCP_Initialize(const TCPIP_STACK_MODULE_CTRL* const stackInit, const
     tcpPktHandler = 0;
 #endif  // (TCPIP_TCP_EXTERN_PACKET_PROCESS != 0)
 
+#if (_TCP_SYN_COOKIES != 0)
+    _TcpSynCookieKeySet();
+    tcpCookieActive = false;
+#endif  // (_TCP_SYN_COOKIES != 0)
+#if (_TCP_SYN_RATE_LIMIT != 0)
+    memset(tcpSynSources, 0, sizeof(tcpSynSources));
+    SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_SECRET, tcpSynSourceKey, sizeof(tcpSynSourceKey));
+#endif  // (_TCP_SYN_RATE_LIMIT != 0)
+#if (_TCP_AUTO_TUNE != 0)
+    tcpTuneBytes = 0;
+    tcpTuneFailTime = 0;
+    tcpTunePressure = false;
+#endif  // (_TCP_AUTO_TUNE != 0)
+
     tcpInitCount = 1; // initialized
     tcpLockCount = 1; // release the lock
 
@@ -866,6 +1021,13 @@ static void _TCPAbortSockets(uint32_t netMask, TCPIP_TCP_SIGNAL_TYPE sigType)
                 uint32_t sktIfMask = 1 << netIx;
                 if((sktIfMask & netMask) != 0)
                 {   // match
+#if (_TCP_LISTEN_BACKLOG != 0)
+                    if(pSkt->flags.listenChild != 0)
+                    {   // not accepted yet; no user to keep it alive for
+                        _TcpAbort(pSkt, _TCP_ABORT_FLAG_FORCE_CLOSE, 0);
+                        continue;
+                    }
+#endif  // (_TCP_LISTEN_BACKLOG != 0)
                     // just disconnect, don't kill sockets
                     bool isServer = pSkt->Flags.bServer;
                     pSkt->Flags.bServer = 1;
@@ -1052,77 +1214,15 @@ TCP_SOCKET TCPIP_TCP_ClientOpen(IP_ADDRESS_TYPE addType, TCP_PORT remotePort, IP
   ***************************************************************************/
 
 
-/*****************************************************************************
-  Function:
-    TCP_SOCKET _TCP_Open(IP_ADDRESS_TYPE addType, TCP_OPEN_TYPE opType, TCP_PORT port, IP_MULTI_ADDRESS* address)
-    
-  Summary:
-    Opens a TCP socket for listening or as a client.
-
-  Description:
-    Provides a unified method for opening TCP sockets. This function can
-    open both client and server sockets.
-    It accepts an IP address in binary form.
-    
-    Sockets are dynamically allocated with this function
-    and freed using TCPIP_TCP_Abort or TCPIP_TCP_Close.
-
-  Conditions:
-    TCP is initialized.
-
-  Input:
-    addType     - IPv4/IPv6 address type spec
-    opType      - TCP_OPEN_SERVER/TCP_OPEN_CLIENT ro open a server or a client socket
-    port        - for a client socket this is the remote port
-                  for a server socket this is the local port the server is listening on
-    hostAddress - A big endian IP address
-                  for a client socket this is the address of the host to connect to
-                  for a server socket this is not currently used
-                  (it may be used in the future for local binding though).
-                 
-
-  Return Values:
-    INVALID_SOCKET -  No sockets of the specified type were available to be
-                      opened.
-    Otherwise -       A TCP_SOCKET handle. Save this handle and use it when
-                      calling all other TCP APIs.
-
-  Remarks:
-    When finished using the TCP socket handle, call the TCPIP_TCP_Close() function to free the 
-    socket and delete the handle.
-
-    IP_ADDRESS_TYPE_ANY is supported for server sockets only!
-
-  *****************************************************************************/
-static TCP_SOCKET _TCP_Open(IP_ADDRESS_TYPE addType, TCP_OPEN_TYPE opType, TCP_PORT port, IP_MULTI_ADDRESS* hostAddress)
+// allocates a new socket in a free slot, with the requested TX/RX buffer sizes
+// the socket is in the idle state, with the TX packet allocated for the address type
+// returns the new socket or 0 if no slot is available or out of memory
+static TCB_STUB* _TcpSocketCreate(IP_ADDRESS_TYPE addType, uint16_t txBuffSize, uint16_t rxBuffSize)
 {
     TCB_STUB*  pSkt;
     TCP_SOCKET hTCP;
-    TCP_PORT   localPort, remotePort;     
     uint8_t    *txBuff, *rxBuff;
 
-    if(opType == TCP_OPEN_CLIENT)
-    {
-        localPort = 0;
-        remotePort = port;
-    }
-    else
-    {   // for server socket allow multiple sockets listening on the same port
-        localPort = port;
-        remotePort = 0;
-    }
-
-    // allocate an ephemeral port for both server and client
-    if(localPort == 0)
-    {
-        localPort = _TCP_EphemeralPortAllocate();
-        if(localPort  == 0)
-        {
-            return INVALID_SOCKET;
-        }
-    }
-
-
     pSkt = (TCB_STUB*)1;
     // Shared Data Lock
     if (OSAL_SEM_Pend(&tcpSemaphore, OSAL_WAIT_FOREVER) != OSAL_RESULT_TRUE)
@@ -1145,15 +1245,18 @@ static TCP_SOCKET _TCP_Open(IP_ADDRESS_TYPE addType, TCP_OPEN_TYPE opType, TCP_P
         {
             // SYS_DEBUG message
         }
-        return INVALID_SOCKET;
+        return 0;
     }
 
     pSkt = (TCB_STUB*)TCPIP_HEAP_Calloc(tcpHeapH, 1, sizeof(*pSkt));
-    txBuff = (uint8_t*)TCPIP_HEAP_Malloc(tcpHeapH, tcpDefTxSize + 1);
-    rxBuff = (uint8_t*)TCPIP_HEAP_Malloc(tcpHeapH, tcpDefRxSize + 1);
+    txBuff = (uint8_t*)TCPIP_HEAP_Malloc(tcpHeapH, txBuffSize + 1);
+    rxBuff = (uint8_t*)TCPIP_HEAP_Malloc(tcpHeapH, rxBuffSize + 1);
 
     if(pSkt == 0 || txBuff == 0 || rxBuff == 0)
     {   // out of memory
+#if (_TCP_AUTO_TUNE != 0)
+        tcpTuneFailTime = SYS_TMR_TickCountGet();
+#endif  // (_TCP_AUTO_TUNE != 0)
         TCPIP_HEAP_Free(tcpHeapH, rxBuff);
         TCPIP_HEAP_Free(tcpHeapH, txBuff);
         TCPIP_HEAP_Free(tcpHeapH, pSkt);
@@ -1162,10 +1265,10 @@ static TCP_SOCKET _TCP_Open(IP_ADDRESS_TYPE addType, TCP_OPEN_TYPE opType, TCP_P
         {
             // SYS_DEBUG message
         }
-        return INVALID_SOCKET;
+        return 0;
     }
 
-    _TcpSocketInitialize(pSkt, hTCP, txBuff, tcpDefTxSize, rxBuff, tcpDefRxSize);
+    _TcpSocketInitialize(pSkt, hTCP, txBuff, txBuffSize, rxBuff, rxBuffSize);
     // Shared Data Lock
     if (OSAL_SEM_Post(&tcpSemaphore) != OSAL_RESULT_TRUE)
     {
@@ -1197,17 +1300,100 @@ static TCP_SOCKET _TCP_Open(IP_ADDRESS_TYPE addType, TCP_OPEN_TYPE opType, TCP_P
     if (pSkt->pTxPkt == 0 && pSkt->addType != IP_ADDRESS_TYPE_ANY)
     {   // failed to allocate memory
         _TcpSocketKill(pSkt);
-        return INVALID_SOCKET;
+        return 0;
     }
 
     pSkt->flags.openAddType = addType;
 
+    return pSkt;
+}
+
+/*****************************************************************************
+  Function:
+    TCP_SOCKET _TCP_Open(IP_ADDRESS_TYPE addType, TCP_OPEN_TYPE opType, TCP_PORT port, IP_MULTI_ADDRESS* address)
+    
+  Summary:
+    Opens a TCP socket for listening or as a client.
+
+  Description:
+    Provides a unified method for opening TCP sockets. This function can
+    open both client and server sockets.
+    It accepts an IP address in binary form.
+    
+    Sockets are dynamically allocated with this function
+    and freed using TCPIP_TCP_Abort or TCPIP_TCP_Close.
+
+  Conditions:
+    TCP is initialized.
+
+  Input:
+    addType     - IPv4/IPv6 address type spec
+    opType      - TCP_OPEN_SERVER/TCP_OPEN_CLIENT ro open a server or a client socket
+    port        - for a client socket this is the remote port
+                  for a server socket this is the local port the server is listening on
+    hostAddress - A big endian IP address
+                  for a client socket this is the address of the host to connect to
+                  for a server socket this is not currently used
+                  (it may be used in the future for local binding though).
+                 
+
+  Return Values:
+    INVALID_SOCKET -  No sockets of the specified type were available to be
+                      opened.
+    Otherwise -       A TCP_SOCKET handle. Save this handle and use it when
+                      calling all other TCP APIs.
+
+  Remarks:
+    When finished using the TCP socket handle, call the TCPIP_TCP_Close() function to free the 
+    socket and delete the handle.
+
+    IP_ADDRESS_TYPE_ANY is supported for server sockets only!
+
+  *****************************************************************************/
+static TCP_SOCKET _TCP_Open(IP_ADDRESS_TYPE addType, TCP_OPEN_TYPE opType, TCP_PORT port, IP_MULTI_ADDRESS* hostAddress)
+{
+    TCB_STUB*  pSkt;
+    TCP_SOCKET hTCP;
+    TCP_PORT   localPort, remotePort;     
+
+    if(opType == TCP_OPEN_CLIENT)
+    {
+        localPort = 0;
+        remotePort = port;
+    }
+    else
+    {   // for server socket allow multiple sockets listening on the same port
+        localPort = port;
+        remotePort = 0;
+    }
+
+    // allocate an ephemeral port for both server and client
+    if(localPort == 0)
+    {
+        localPort = _TCP_EphemeralPortAllocate();
+        if(localPort  == 0)
+        {
+            return INVALID_SOCKET;
+        }
+    }
+
+
+    pSkt = _TcpSocketCreate(addType, tcpDefTxSize, tcpDefRxSize);
+    if(pSkt == 0)
+    {   // no slot or out of memory
+        return INVALID_SOCKET;
+    }
+    hTCP = pSkt->sktIx;
+
     if(opType == TCP_OPEN_SERVER)
     {
         pSkt->localPort = localPort;
         pSkt->Flags.bServer = true;
         _TcpSocketSetState(pSkt, TCPIP_TCP_STATE_LISTEN);
         pSkt->remoteHash = localPort;
+#if (_TCP_LISTEN_BACKLOG != 0)
+        pSkt->acceptHead = INVALID_SOCKET;
+#endif  // (_TCP_LISTEN_BACKLOG != 0)
     }
     // Handle all the client mode socket types
     else
@@ -1258,6 +1444,10 @@ void  TCPIP_TCP_Task(void)
 {
     TCPIP_MODULE_SIGNAL sigPend;
 
+#if (_TCP_AUTO_TUNE != 0)
+    tcpTaskSeq++;   // user threads won't relocate socket buffers while the task runs
+#endif  // (_TCP_AUTO_TUNE != 0)
+
 #if (TCPIP_TCP_QUIET_TIME != 0)
     if(!tcpQuietDone)
     {
@@ -1297,6 +1487,10 @@ void  TCPIP_TCP_Task(void)
     { // regular TMO occurred
         TCPIP_TCP_Tick();
     }
+
+#if (_TCP_AUTO_TUNE != 0)
+    tcpTaskSeq++;
+#endif  // (_TCP_AUTO_TUNE != 0)
 }
 
 static void TCPIP_TCP_Process(void)
@@ -1661,6 +1855,7 @@ static TCPIP_MAC_PKT_ACK_RES TCPIP_TCP_ProcessIPv4(TCPIP_MAC_PACKET* pRxPkt)
     IPV4_PSEUDO_HEADER  pseudoHdr;
     uint16_t            calcChkSum;
     TCB_STUB*           pSkt; 
+    TCP_SOCKET          sktIx;
     TCPIP_TCP_SIGNAL_FUNCTION sigHandler;
     const void*         sigParam;
     uint16_t            sigMask;
@@ -1721,7 +1916,13 @@ static TCPIP_MAC_PKT_ACK_RES TCPIP_TCP_ProcessIPv4(TCPIP_MAC_PACKET* pRxPkt)
 
         // extract header
         pRxPkt->pDSeg->segLen -=  optionsSize + sizeof(*pTCPHdr);    
+        sktIx = pSkt->sktIx;
         _TcpHandleSeg(pSkt, pTCPHdr, tcpTotLength - optionsSize - sizeof(*pTCPHdr), pRxPkt, &sktEvent);
+        if(TCBStubs[sktIx] != pSkt)
+        {   // the segment closed a socket that is not a server: it's gone
+            ackRes = TCPIP_MAC_PKT_ACK_RX_OK;
+            break;
+        }
 
         sigMask = _TcpSktGetSignalLocked(pSkt, &sigHandler, &sigParam);
         if((sktEvent &= sigMask) != 0)
@@ -2074,7 +2275,15 @@ bool TCPIP_TCP_IsConnected(TCP_SOCKET hTCP)
 {
     TCB_STUB* pSkt = _TcpSocketChk(hTCP); 
 
-    return (pSkt) ? _TCP_IsConnected(pSkt) : false;
+    if(pSkt == 0)
+    {
+        return false;
+    }
+
+#if (_TCP_AUTO_TUNE != 0)
+    _TcpAutoTuneCheck(pSkt);
+#endif  // (_TCP_AUTO_TUNE != 0)
+    return _TCP_IsConnected(pSkt);
 }
 
 // This function closes a connection to a remote node by sending a FIN
@@ -2291,6 +2500,195 @@ bool TCPIP_TCP_Close(TCP_SOCKET hTCP)
 }
 
 
+#if (_TCP_LISTEN_BACKLOG != 0)
+// Sets the number of connections a listening socket can have
+// pending or waiting to be accepted
+bool TCPIP_TCP_ServerBacklogSet(TCP_SOCKET hTCP, uint8_t backlog)
+{
+    TCB_STUB* pSkt = _TcpSocketChk(hTCP); 
+
+    if(pSkt && pSkt->Flags.bServer != 0 && pSkt->smState == TCPIP_TCP_STATE_LISTEN)
+    {
+        pSkt->backlog = backlog;
+        return true;
+    }
+
+    return false;
+}
+
+// Returns the first connection from the accept queue of a listening socket
+TCP_SOCKET TCPIP_TCP_Accept(TCP_SOCKET hTCP)
+{
+    TCB_STUB* pChild;
+    TCP_SOCKET hChild = INVALID_SOCKET;
+    TCB_STUB* pSkt = _TcpSocketChk(hTCP); 
+
+    if(pSkt && pSkt->Flags.bServer != 0)
+    {
+        OSAL_CRITSECT_DATA_TYPE status = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+        if((hChild = pSkt->acceptHead) != INVALID_SOCKET)
+        {
+            pChild = TCBStubs[hChild];
+            pSkt->acceptHead = pChild->acceptNext;
+            pSkt->nChildren--;
+            // the socket belongs to the user now
+            pChild->flags.listenChild = 0;
+            pChild->flags.acceptReady = 0;
+        }
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, status);
+    }
+
+    return hChild;
+}
+
+// creates a socket to take a new connection for a listening socket
+// the new socket inherits the listening socket options and buffer sizes
+// and takes the SYN in the TCPIP_TCP_STATE_LISTEN state.
+// It is not a server socket: it's killed when closed
+static TCB_STUB* _TcpListenChildCreate(TCB_STUB* pListen)
+{
+    TCB_STUB* pChild = _TcpSocketCreate((IP_ADDRESS_TYPE)pListen->flags.openAddType, pListen->txEnd - pListen->txStart - 1, pListen->rxEnd - pListen->rxStart);
+
+    if(pChild == 0)
+    {
+        return 0;
+    }
+
+    pChild->localPort = pListen->localPort;
+    pChild->Flags.keepAlive = pListen->Flags.keepAlive;
+    pChild->Flags.halfThresType = pListen->Flags.halfThresType;
+    pChild->Flags.delayAckSend = pListen->Flags.delayAckSend;
+    pChild->flags.nonLinger = pListen->flags.nonLinger;
+    pChild->flags.nonGraceful = pListen->flags.nonGraceful;
+    pChild->flags.forceFlush = pListen->flags.forceFlush;
+    pChild->keepAliveTmo = pListen->keepAliveTmo;
+    pChild->keepAliveLim = pListen->keepAliveLim;
+    pChild->ttl = pListen->ttl;
+    pChild->tos = pListen->tos;
+
+    pChild->listenSkt = pListen->sktIx;
+    pChild->acceptNext = INVALID_SOCKET;
+    pChild->acceptHead = INVALID_SOCKET;
+    pChild->flags.listenChild = 1;
+
+    OSAL_CRITSECT_DATA_TYPE status = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+    pListen->nChildren++;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, status);
+
+    _TcpSocketSetState(pChild, TCPIP_TCP_STATE_LISTEN);
+
+    return pChild;
+}
+
+// a listen child got connected
+// append it to the accept queue and let the listening socket user know
+static void _TcpAcceptQueueAdd(TCB_STUB* pChild)
+{
+    TCB_STUB* pQSkt;
+    TCPIP_TCP_SIGNAL_FUNCTION sigHandler;
+    const void* sigParam;
+    uint16_t    sigMask;
+    TCB_STUB* pListen = TCBStubs[pChild->listenSkt];
+
+    OSAL_CRITSECT_DATA_TYPE status = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+    pChild->acceptNext = INVALID_SOCKET;
+    if(pListen->acceptHead == INVALID_SOCKET)
+    {
+        pListen->acceptHead = pChild->sktIx;
+    }
+    else
+    {
+        pQSkt = TCBStubs[pListen->acceptHead];
+        while(pQSkt->acceptNext != INVALID_SOCKET)
+        {
+            pQSkt = TCBStubs[pQSkt->acceptNext];
+        }
+        pQSkt->acceptNext = pChild->sktIx;
+    }
+    pChild->flags.acceptReady = 1;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, status);
+
+    sigMask = _TcpSktGetSignalLocked(pListen, &sigHandler, &sigParam);
+    if((sigMask & TCPIP_TCP_SIGNAL_ACCEPT) != 0 && sigHandler != 0)
+    {
+        (*sigHandler)(pListen->sktIx, pChild->pSktNet, TCPIP_TCP_SIGNAL_ACCEPT, sigParam);
+    }
+}
+
+// a socket is killed
+// a listen child is removed from its listening socket
+// a listening socket aborts the connections not accepted yet
+static void _TcpListenUnlink(TCB_STUB* pSkt)
+{
+    int ix;
+    TCB_STUB* pChild;
+
+    if(pSkt->flags.listenChild != 0)
+    {
+        TCB_STUB* pListen = TCBStubs[pSkt->listenSkt];
+        OSAL_CRITSECT_DATA_TYPE status = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+        if(pSkt->flags.acceptReady != 0)
+        {
+            if(pListen->acceptHead == pSkt->sktIx)
+            {
+                pListen->acceptHead = pSkt->acceptNext;
+            }
+            else
+            {
+                for(pChild = TCBStubs[pListen->acceptHead]; pChild->acceptNext != INVALID_SOCKET; pChild = TCBStubs[pChild->acceptNext])
+                {
+                    if(pChild->acceptNext == pSkt->sktIx)
+                    {
+                        pChild->acceptNext = pSkt->acceptNext;
+                        break;
+                    }
+                }
+            }
+        }
+        pListen->nChildren--;
+        pSkt->flags.listenChild = 0;
+        pSkt->flags.acceptReady = 0;
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, status);
+    }
+    else if(pSkt->Flags.bServer != 0 && pSkt->nChildren != 0)
+    {
+        for(ix = 0; ix < TcpSockets; ix++)
+        {
+            pChild = TCBStubs[ix];
+            if(pChild != 0 && pChild->flags.listenChild != 0 && pChild->listenSkt == pSkt->sktIx)
+            {
+                _TcpAbort(pChild, _TCP_ABORT_FLAG_FORCE_CLOSE, 0);
+            }
+        }
+    }
+}
+
+#if (_TCP_SYN_COOKIES != 0)
+// aborts a half-open child of a listening socket
+// to make room for a connection that completed the handshake with a SYN cookie:
+// under a SYN flood the half-open children would fill the backlog
+// returns false if all the children are connected
+static bool _TcpListenEmbryonicDrop(TCB_STUB* pListen)
+{
+    int ix;
+    TCB_STUB* pChild;
+
+    for(ix = 0; ix < TcpSockets; ix++)
+    {
+        pChild = TCBStubs[ix];
+        if(pChild != 0 && pChild->flags.listenChild != 0 && pChild->listenSkt == pListen->sktIx && pChild->smState == TCPIP_TCP_STATE_SYN_RECEIVED)
+        {
+            _TcpAbort(pChild, _TCP_ABORT_FLAG_FORCE_CLOSE, 0);
+            return true;
+        }
+    }
+
+    return false;
+}
+#endif  // (_TCP_SYN_COOKIES != 0)
+#endif  // (_TCP_LISTEN_BACKLOG != 0)
+
+
 /*****************************************************************************
   Function:
     bool TCPIP_TCP_SocketInfoGet(TCP_SOCKET hTCP, TCP_SOCKET_INFO* remoteInfo)
@@ -2434,7 +2832,7 @@ static uint32_t _TCP_SktSetSequenceNo(const TCB_STUB* pSkt)
     }hashData = {0};
         
     // get secret key
-    SYS_RANDOM_CryptoBlockGet(secretKey, sizeof(secretKey));
+    SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_SECRET, secretKey, sizeof(secretKey));
 
     // calculate the hash
     CRYPT_MD5_Initialize(&md5Ctx);
@@ -2498,6 +2896,243 @@ static uint32_t _TCP_SktSetSequenceNo(const TCB_STUB* pSkt)
 }
 #endif  // defined(TCPIP_TCP_DISABLE_CRYPTO_USAGE) && (TCPIP_TCP_DISABLE_CRYPTO_USAGE != false)
 
+#if (_TCP_SYN_COOKIES != 0)
+// SYN cookie layout: 5 bits time counter, 3 bits MSS index, 24 bits hash
+#define _TCP_COOKIE_COUNT_SHIFT     27
+#define _TCP_COOKIE_COUNT_MASK      0x1f
+#define _TCP_COOKIE_MSS_SHIFT       24
+#define _TCP_COOKIE_MSS_MASK        0x07
+#define _TCP_COOKIE_HASH_MASK       0x00ffffff
+
+#if defined(TCPIP_TCP_DISABLE_CRYPTO_USAGE) && (TCPIP_TCP_DISABLE_CRYPTO_USAGE != false)
+static void _TcpSynCookieKeySet(void)
+{
+    int ix;
+
+    for(ix = 0; ix < sizeof(tcpCookieKey) / sizeof(*tcpCookieKey); ix++)
+    {
+        tcpCookieKey[ix] = (SYS_RANDOM_PseudoGet() << 16) | (uint16_t)SYS_RANDOM_PseudoGet();
+    }
+}
+
+// FNV-1a over the cookie data; the key is part of the data
+static uint32_t _TcpSynCookieDigest(const uint32_t* pData, int nWords)
+{
+    int ix;
+    uint32_t digest = 2166136261u;
+    const uint8_t* pByte = (const uint8_t*)pData;
+
+    for(ix = 0; ix < nWords * sizeof(uint32_t); ix++)
+    {
+        digest = (digest ^ *pByte++) * 16777619u;
+    }
+
+    return digest ^ (digest >> 8);
+}
+#else
+static void _TcpSynCookieKeySet(void)
+{
+    SYS_RANDOM_CryptoBlockGet(tcpCookieKey, sizeof(tcpCookieKey));
+}
+
+// MD5 over the cookie data; the key is part of the data
+static uint32_t _TcpSynCookieDigest(const uint32_t* pData, int nWords)
+{
+    CRYPT_MD5_CTX md5Ctx;
+    uint32_t digest[16 / 4];
+
+    CRYPT_MD5_Initialize(&md5Ctx);
+    CRYPT_MD5_DataAdd(&md5Ctx, (const uint8_t*)pData, nWords * sizeof(uint32_t));
+    CRYPT_MD5_Finalize(&md5Ctx, (uint8_t*)digest);
+
+    return digest[0];
+}
+#endif  // defined(TCPIP_TCP_DISABLE_CRYPTO_USAGE) && (TCPIP_TCP_DISABLE_CRYPTO_USAGE != false)
+
+// current SYN cookie time counter; 64 seconds period
+static __inline__ uint32_t __attribute__((always_inline)) _TcpSynCookieCount(void)
+{
+    return ((SYS_TMR_TickCountGet() / sysTickFreq) >> 6) & _TCP_COOKIE_COUNT_MASK;
+}
+
+// calculates the SYN cookie hash
+// over the connection identity, the remote ISN and the cookie tag: time counter + MSS index
+// the header is in host order
+static uint32_t _TcpSynCookieHash(const void* remoteIP, const void* localIP, IP_ADDRESS_TYPE addType, const TCP_HEADER* h, uint32_t remoteISN, uint32_t cookieTag)
+{
+    uint32_t hashData[60 / 4];  // max: 16B remote + 16B local address, 4B ports, 4B ISN, 4B tag, 16B key
+    int      nWords;
+
+#if defined (TCPIP_STACK_USE_IPV6)
+    if(addType == IP_ADDRESS_TYPE_IPV6)
+    {
+        memcpy(hashData + 0, remoteIP, sizeof(IPV6_ADDR));
+        memcpy(hashData + 4, localIP, sizeof(IPV6_ADDR));
+        nWords = 8;
+    }
+    else
+#endif  // defined (TCPIP_STACK_USE_IPV6)
+    {
+        hashData[0] = ((const IPV4_ADDR*)remoteIP)->Val;
+        hashData[1] = ((const IPV4_ADDR*)localIP)->Val;
+        nWords = 2;
+    }
+
+    hashData[nWords++] = ((uint32_t)h->DestPort << 16) | h->SourcePort;
+    hashData[nWords++] = remoteISN;
+    hashData[nWords++] = cookieTag;
+    memcpy(hashData + nWords, tcpCookieKey, sizeof(tcpCookieKey));
+    nWords += sizeof(tcpCookieKey) / sizeof(*tcpCookieKey);
+
+    return _TcpSynCookieDigest(hashData, nWords) & _TCP_COOKIE_HASH_MASK;
+}
+
+// returns the cookie to be used as ISN in the SYN + ACK answering the SYN in h
+static uint32_t _TcpSynCookieGet(const void* remoteIP, const void* localIP, IP_ADDRESS_TYPE addType, TCP_HEADER* h)
+{
+    uint32_t mssIx, cookieTag;
+    uint16_t remoteMss = _GetMaxSegSizeOption(h);
+
+    // encode the largest table MSS not exceeding the remote one
+    for(mssIx = sizeof(tcpCookieMssTbl) / sizeof(*tcpCookieMssTbl) - 1; mssIx != 0; mssIx--)
+    {
+        if(tcpCookieMssTbl[mssIx] <= remoteMss)
+        {
+            break;
+        }
+    }
+
+    cookieTag = (_TcpSynCookieCount() << _TCP_COOKIE_COUNT_SHIFT) | (mssIx << _TCP_COOKIE_MSS_SHIFT);
+    return cookieTag | _TcpSynCookieHash(remoteIP, localIP, addType, h, h->SeqNumber, cookieTag);
+}
+
+// checks the cookie acknowledged by the ACK in h
+// returns the remote MSS encoded in the cookie or 0 if not a valid cookie
+static uint16_t _TcpSynCookieCheck(const void* remoteIP, const void* localIP, IP_ADDRESS_TYPE addType, const TCP_HEADER* h)
+{
+    uint32_t cookie = h->AckNumber - 1;
+    uint32_t cookieTag = cookie & ~_TCP_COOKIE_HASH_MASK;
+    uint32_t cookieAge = (_TcpSynCookieCount() - (cookie >> _TCP_COOKIE_COUNT_SHIFT)) & _TCP_COOKIE_COUNT_MASK;
+
+    if(cookieAge > 1)
+    {   // expired
+        return 0;
+    }
+
+    if(_TcpSynCookieHash(remoteIP, localIP, addType, h, h->SeqNumber - 1, cookieTag) != (cookie & _TCP_COOKIE_HASH_MASK))
+    {
+        return 0;
+    }
+
+    return tcpCookieMssTbl[(cookie >> _TCP_COOKIE_MSS_SHIFT) & _TCP_COOKIE_MSS_MASK];
+}
+
+// returns the MSS a socket advertises in its SYN
+static uint16_t _TcpLocalMssGet(TCB_STUB* pSkt)
+{
+#if defined (TCPIP_STACK_USE_IPV6)
+    if(pSkt->addType == IP_ADDRESS_TYPE_IPV6)
+    {
+        return TCPIP_IPV6_MaxDatagramDataSizeGet(pSkt->pSktNet) - sizeof(TCP_HEADER); 
+    }
+#endif  // defined (TCPIP_STACK_USE_IPV6)
+
+#if defined (TCPIP_STACK_USE_IPV4)
+    if(pSkt->addType == IP_ADDRESS_TYPE_IPV4)
+    {
+        return TCPIP_IPV4_MaxDatagramDataSizeGet(pSkt->pSktNet) - sizeof(TCP_HEADER);
+    }
+#endif  // defined (TCPIP_STACK_USE_IPV4)
+
+    return TCP_MIN_DEFAULT_MTU;
+}
+
+// drops the remote binding of a listening socket that answered a SYN with a cookie
+// the socket stays in LISTEN; it was never connected:
+// unlike _TcpCloseSocket() no reset is reported to the socket user
+static void _TcpListenUnbind(TCB_STUB* pSkt)
+{
+    uint8_t sktReset = pSkt->Flags.bSocketReset;
+
+    _TcpSocketTxPktRelease(pSkt, pSkt->flags.openAddType == IP_ADDRESS_TYPE_ANY);
+    _TcpSocketSetIdleState(pSkt);
+    pSkt->Flags.bSocketReset = sktReset;
+}
+#endif  // (_TCP_SYN_COOKIES != 0)
+
+#if (_TCP_SYN_RATE_LIMIT != 0)
+// hash of a SYN source address
+// FNV-1a over the secret key + the address: a remote host cannot pick
+// addresses that share a source entry; cheap enough to run for every SYN of a flood
+static uint32_t _TcpSynSourceHash(const void* remoteIP, size_t addSize)
+{
+    uint8_t hashData[sizeof(tcpSynSourceKey) + 16];     // key + max address size: IPv6
+
+    memcpy(hashData, tcpSynSourceKey, sizeof(tcpSynSourceKey));
+    memcpy(hashData + sizeof(tcpSynSourceKey), remoteIP, addSize);
+
+    return fnv_32a_hash(hashData, sizeof(tcpSynSourceKey) + addSize);
+}
+
+// counts a SYN from a remote source
+// returns false if the source already sent TCPIP_TCP_SYN_RATE_LIMIT SYNs in the current second
+static bool _TcpSynRateCheck(const void* remoteIP, IP_ADDRESS_TYPE addType)
+{
+    int ix;
+    uint32_t srcHash;
+    TCP_SYN_SOURCE* pSrc, *pNew;
+    uint32_t currTick = SYS_TMR_TickCountGet();
+
+#if defined (TCPIP_STACK_USE_IPV6)
+    if(addType == IP_ADDRESS_TYPE_IPV6)
+    {
+        srcHash = _TcpSynSourceHash(remoteIP, sizeof(IPV6_ADDR));
+    }
+    else
+#endif  // defined (TCPIP_STACK_USE_IPV6)
+    {
+        srcHash = _TcpSynSourceHash(remoteIP, sizeof(IPV4_ADDR));
+    }
+
+    if(srcHash == 0)
+    {   // 0 marks an unused entry
+        srcHash = 1;
+    }
+
+    pNew = 0;
+    for(ix = 0, pSrc = tcpSynSources; ix < TCPIP_TCP_SYN_RATE_SOURCES; ix++, pSrc++)
+    {
+        if(pSrc->srcHash == srcHash)
+        {
+            if(currTick - pSrc->startTime >= sysTickFreq)
+            {   // start a new window
+                pSrc->startTime = currTick;
+                pSrc->nSyns = 0;
+            }
+
+            if(pSrc->nSyns >= TCPIP_TCP_SYN_RATE_LIMIT)
+            {
+                return false;
+            }
+
+            pSrc->nSyns++;
+            return true;
+        }
+
+        // a new source takes an unused entry or the one with the oldest window
+        if(pNew == 0 || (pNew->srcHash != 0 && (pSrc->srcHash == 0 || currTick - pSrc->startTime > currTick - pNew->startTime)))
+        {
+            pNew = pSrc;
+        }
+    }
+
+    pNew->srcHash = srcHash;
+    pNew->startTime = currTick;
+    pNew->nSyns = 1;
+    return true;
+}
+#endif  // (_TCP_SYN_RATE_LIMIT != 0)
+
 /****************************************************************************
   Section:
     Transmit Functions
@@ -2584,7 +3219,15 @@ uint16_t TCPIP_TCP_PutIsReady(TCP_SOCKET hTCP)
 {
     TCB_STUB* pSkt = _TcpSocketChk(hTCP); 
     
-    return pSkt ? _TCPIsPutReady(pSkt) : 0;
+    if(pSkt == 0)
+    {
+        return 0;
+    }
+
+#if (_TCP_AUTO_TUNE != 0)
+    _TcpAutoTuneCheck(pSkt);
+#endif  // (_TCP_AUTO_TUNE != 0)
+    return _TCPIsPutReady(pSkt);
 }
 
 
@@ -2653,7 +3296,16 @@ uint16_t TCPIP_TCP_ArrayPut(TCP_SOCKET hTCP, const uint8_t* data, uint16_t len)
         return 0;
     }
 
+#if (_TCP_AUTO_TUNE != 0)
+    _TcpAutoTuneCheck(pSkt);
+#endif  // (_TCP_AUTO_TUNE != 0)
     wFreeTxSpace = _TCPIsPutReady(pSkt);
+#if (_TCP_AUTO_TUNE != 0)
+    if(len >= wFreeTxSpace && pSkt->maxRemoteWindow > (uint16_t)(pSkt->txEnd - pSkt->txStart - 1))
+    {   // the TX buffer fills up but the remote node could take more
+        pSkt->tuneTxLimited = 1;
+    }
+#endif  // (_TCP_AUTO_TUNE != 0)
     if(wFreeTxSpace == 0)
     {   // no room in the socket buffer
         if(_TCP_TxPktValid(pSkt))
@@ -2665,6 +3317,9 @@ uint16_t TCPIP_TCP_ArrayPut(TCP_SOCKET hTCP, const uint8_t* data, uint16_t len)
 
     wActualLen = len >= wFreeTxSpace ? wFreeTxSpace : len;
     wFreeTxSpace -= wActualLen; // new free space
+#if (_TCP_AUTO_TUNE != 0)
+    pSkt->tuneTime = SYS_TMR_TickCountGet();
+#endif  // (_TCP_AUTO_TUNE != 0)
 
     // See if we need a two part put
     if(pSkt->txHead + wActualLen >= pSkt->txEnd)
@@ -2924,16 +3579,85 @@ static bool _TCPSendWinIncUpdate(TCB_STUB* pSkt)
         {   // Send a Window update message to the remote node
             toAdvertise = true;
         }
+#if (_TCP_QUICK_ACK != 0)
+        else if(oldWin < minWinInc && newWin >= minWinInc)
+        {   // the window opens from below the minimum increment
+            // the remote node avoiding the SWS could be waiting for it
+            toAdvertise = true;
+        }
+#endif  // (_TCP_QUICK_ACK != 0)
+    }
+
+    if(toAdvertise)
+    {
+        _TcpSend(pSkt, ACK, SENDTCP_RESET_TIMERS);
+        return true;
+    }
+
+    return false;
+}
+
+#if (_TCP_QUICK_ACK != 0)
+// updates the delayed acknowledgment timeout when a segment is received
+// the timeout follows the segments inter-arrival time when that's shorter:
+// waiting longer than the next segment is expected to take does not save an acknowledgment
+// returns true if the segment needs to be acknowledged immediately
+static bool _TcpQuickAckCheck(TCB_STUB* pSkt, bool outOfOrder)
+{
+    uint32_t nQuick;
+    uint32_t currTick = SYS_TMR_TickCountGet();
+    uint32_t rxGap = currTick - pSkt->ackRxTime;
+    uint32_t maxDelay = (TCPIP_TCP_DELAYED_ACK_TIMEOUT * sysTickFreq) / 1000;
+    uint32_t minDelay = (_TCP_ACK_DELAY_MIN * sysTickFreq) / 1000;
+
+    if(minDelay > maxDelay)
+    {
+        minDelay = maxDelay;
+    }
+    if(minDelay == 0)
+    {
+        minDelay = 1;
+    }
+
+    pSkt->ackRxTime = currTick;
+    if(pSkt->ackDelay == 0 || rxGap > maxDelay)
+    {   // connection start or the remote node has been idle
+        // acknowledge immediately while the remote node congestion window opens
+        nQuick = pSkt->localMSS != 0 ? (pSkt->rxEnd - pSkt->rxStart) / (2 * pSkt->localMSS) : 0;
+        pSkt->ackQuick = nQuick < 2 ? 2 : nQuick > _TCP_QUICK_ACK_SEGMENTS ? _TCP_QUICK_ACK_SEGMENTS : nQuick;
+        pSkt->ackDelay = minDelay;
+    }
+    else if(rxGap <= minDelay / 2)
+    {
+        pSkt->ackDelay = pSkt->ackDelay / 2 + minDelay / 2;
+    }
+    else if(rxGap < pSkt->ackDelay)
+    {
+        pSkt->ackDelay = pSkt->ackDelay / 2 + rxGap;
+        if(pSkt->ackDelay > maxDelay)
+        {
+            pSkt->ackDelay = maxDelay;
+        }
+    }
+    if(pSkt->ackDelay < minDelay)
+    {
+        pSkt->ackDelay = minDelay;
     }
 
-    if(toAdvertise)
+    if(outOfOrder)
+    {   // duplicate acknowledgment or a hole just filled: the remote node needs to know it now
+        return true;
+    }
+
+    if(pSkt->ackQuick != 0)
     {
-        _TcpSend(pSkt, ACK, SENDTCP_RESET_TIMERS);
+        pSkt->ackQuick--;
         return true;
     }
 
     return false;
 }
+#endif  // (_TCP_QUICK_ACK != 0)
 
 /*****************************************************************************
   Function:
@@ -2963,6 +3687,9 @@ uint16_t TCPIP_TCP_GetIsReady(TCP_SOCKET hTCP)
     
     if(pSkt)
     {
+#if (_TCP_AUTO_TUNE != 0)
+        _TcpAutoTuneCheck(pSkt);
+#endif  // (_TCP_AUTO_TUNE != 0)
         return _TCPIsGetReady(pSkt);
     }
 
@@ -2991,8 +3718,17 @@ uint16_t TCPIP_TCP_ArrayGet(TCP_SOCKET hTCP, uint8_t* buffer, uint16_t len)
     uint16_t RightLen = 0;
     TCB_STUB* pSkt; 
     
+    if(len == 0 || (pSkt= _TcpSocketChk(hTCP)) == 0)
+    {
+        return 0;
+    }
+
+#if (_TCP_AUTO_TUNE != 0)
+    _TcpAutoTuneCheck(pSkt);
+#endif  // (_TCP_AUTO_TUNE != 0)
+
     // See if there is any data which can be read
-    if(len == 0 || (pSkt= _TcpSocketChk(hTCP)) == 0 || (wGetReadyCount = _TCPIsGetReady(pSkt)) == 0)
+    if((wGetReadyCount = _TCPIsGetReady(pSkt)) == 0)
     {
         return 0;
     }
@@ -3467,11 +4203,26 @@ static void TCPIP_TCP_Tick(void)
     uint8_t vFlags;
     uint16_t w;
     TCB_STUB* pSkt; 
+#if (_TCP_IDLE_TICK_RATE != 0)
+    bool    tickQuiet = true;
+
+    tcpTickWake = false;
+#endif  // (_TCP_IDLE_TICK_RATE != 0)
+
+#if (_TCP_AUTO_TUNE != 0)
+    _TcpAutoTuneTick();
+#endif  // (_TCP_AUTO_TUNE != 0)
 
     // Periodically all "not closed" sockets must perform timed operations
     for(hTCP = 0; hTCP < TcpSockets; hTCP++)
     {
         pSkt = TCBStubs[hTCP];
+#if (_TCP_IDLE_TICK_RATE != 0)
+        if(tickQuiet && pSkt != 0 && !_TcpSocketIsQuiet(pSkt))
+        {
+            tickQuiet = false;
+        }
+#endif  // (_TCP_IDLE_TICK_RATE != 0)
         if(pSkt != 0 && pSkt->smState != TCPIP_TCP_STATE_CLIENT_WAIT_CONNECT)
         {   // existing socket
             vFlags = 0x00;
@@ -3637,7 +4388,11 @@ static void TCPIP_TCP_Tick(void)
                     }
                     else
                     {
+#if (_TCP_LISTEN_BACKLOG != 0)
+                        if(pSkt->Flags.bServer || pSkt->flags.listenChild)
+#else
                         if(pSkt->Flags.bServer)
+#endif  // (_TCP_LISTEN_BACKLOG != 0)
                         {
                             vFlags = RST | ACK;
                             bCloseSocket = true;
@@ -3760,6 +4515,16 @@ static void TCPIP_TCP_Tick(void)
         }
     }
 
+#if (_TCP_IDLE_TICK_RATE != 0)
+#if (TCPIP_TCP_QUIET_TIME != 0)
+    tickQuiet = tickQuiet && tcpQuietDone;
+#endif  // (TCPIP_TCP_QUIET_TIME != 0)
+    if(tickQuiet && !tcpTickWake && !tcpTickIdle)
+    {   // no socket needs the timer; slow down
+        tcpTickIdle = true;
+        _TCPIPStackSignalHandlerSetParams(TCPIP_THIS_MODULE_ID, tcpSignalHandle, _TCP_IDLE_TICK_RATE);
+    }
+#endif  // (_TCP_IDLE_TICK_RATE != 0)
 }
 
 
@@ -3772,6 +4537,7 @@ static TCPIP_MAC_PKT_ACK_RES TCPIP_TCP_ProcessIPv6(TCPIP_MAC_PACKET* pRxPkt)
     const IPV6_ADDR*    localIP;
     const IPV6_ADDR*    remoteIP;
     TCB_STUB*       pSkt; 
+    TCP_SOCKET      sktIx;
     TCPIP_NET_IF*       pPktIf;
     TCPIP_TCP_SIGNAL_FUNCTION sigHandler;
     const void*         sigParam;
@@ -3834,7 +4600,13 @@ static TCPIP_MAC_PKT_ACK_RES TCPIP_TCP_ProcessIPv6(TCPIP_MAC_PACKET* pRxPkt)
 
         // extract header
         pRxPkt->pDSeg->segLen -=  optionsSize + sizeof(*pTCPHdr);    
+        sktIx = pSkt->sktIx;
         _TcpHandleSeg(pSkt, pTCPHdr, dataLen - optionsSize - sizeof(*pTCPHdr), pRxPkt, &sktEvent);
+        if(TCBStubs[sktIx] != pSkt)
+        {   // the segment closed a socket that is not a server: it's gone
+            ackRes = TCPIP_MAC_PKT_ACK_RX_OK;
+            break;
+        }
 
         sigMask = _TcpSktGetSignalLocked(pSkt, &sigHandler, &sigParam);
         if((sktEvent &= sigMask) != 0)
@@ -4217,11 +4989,18 @@ static _TCP_SEND_RES _TcpSend(TCB_STUB* pSkt, uint8_t vTCPFlags, uint8_t vSendFl
             if(pSkt->flags.bSYNSent)
             {
                 header->SeqNumber--;
+#if (_TCP_AUTO_TUNE != 0)
+                pSkt->tuneRxMeas = TCP_TUNE_MEAS_NONE;  // ambiguous for a retransmitted SYN
+#endif  // (_TCP_AUTO_TUNE != 0)
             }
             else
             {
                 pSkt->MySEQ++;
                 pSkt->flags.bSYNSent = 1;
+#if (_TCP_AUTO_TUNE != 0)
+                pSkt->tuneRxStart = SYS_TMR_TickCountGet();
+                pSkt->tuneRxMeas = TCP_TUNE_MEAS_SYN;
+#endif  // (_TCP_AUTO_TUNE != 0)
             }
         }
         else
@@ -4249,6 +5028,15 @@ static _TCP_SEND_RES _TcpSend(TCB_STUB* pSkt, uint8_t vTCPFlags, uint8_t vSendFl
             header->Window = pSkt->rxTail - pSkt->rxHead - 1;
         }
         pSkt->localWindow = header->Window; // store the last advertised window
+#if (_TCP_AUTO_TUNE != 0)
+        if(pSkt->tuneRxMeas == TCP_TUNE_MEAS_NONE && pSkt->tuneRxRtt != TCP_TUNE_RTT_UNKNOWN &&
+           header->Window > ((pSkt->rxEnd - pSkt->rxStart) >> 1))
+        {   // time the reception of the window advertised now
+            pSkt->tuneRxEdge = pSkt->RemoteSEQ + header->Window;
+            pSkt->tuneRxStart = SYS_TMR_TickCountGet();
+            pSkt->tuneRxMeas = TCP_TUNE_MEAS_WINDOW;
+        }
+#endif  // (_TCP_AUTO_TUNE != 0)
 
         _TcpSwapHeader(header);
 
@@ -4323,6 +5111,16 @@ static TCB_STUB* _TcpFindMatchingSocket(TCPIP_MAC_PACKET* pRxPkt, const void * r
     uint16_t hash;
     TCB_STUB* pSkt, *partialSkt;
     TCPIP_NET_IF* pPktIf;
+#if (_TCP_LISTEN_BACKLOG != 0) || (_TCP_EMBRYONIC_LIMIT != 0) || (_TCP_SYN_RATE_LIMIT != 0)
+    bool    newConn;
+#endif  // (_TCP_LISTEN_BACKLOG != 0) || (_TCP_EMBRYONIC_LIMIT != 0) || (_TCP_SYN_RATE_LIMIT != 0)
+#if (_TCP_EMBRYONIC_LIMIT != 0)
+    int     nEmbryonic = 0;
+#endif  // (_TCP_EMBRYONIC_LIMIT != 0)
+#if (_TCP_SYN_COOKIES != 0)
+    uint16_t cookieMss = 0;
+    uint8_t  synCookie = 0;
+#endif  // (_TCP_SYN_COOKIES != 0)
 
     TCP_HEADER* h = (TCP_HEADER*)pRxPkt->pTransportLayer;
     pPktIf = (TCPIP_NET_IF*)pRxPkt->pktIf;
@@ -4364,6 +5162,13 @@ static TCB_STUB* _TcpFindMatchingSocket(TCPIP_MAC_PACKET* pRxPkt, const void * r
             continue;
         }
 
+#if (_TCP_EMBRYONIC_LIMIT != 0)
+        if(pSkt->smState == TCPIP_TCP_STATE_SYN_RECEIVED && pSkt->localPort == h->DestPort)
+        {   // half-open connection on this port
+            nEmbryonic++;
+        }
+#endif  // (_TCP_EMBRYONIC_LIMIT != 0)
+
         if( (pSkt->addType == IP_ADDRESS_TYPE_ANY || pSkt->addType == addressType) &&
                 (pSkt->pSktNet == 0 || pSkt->pSktNet == pPktIf) )
         {   // both network interface and address type match
@@ -4429,6 +5234,59 @@ static TCB_STUB* _TcpFindMatchingSocket(TCPIP_MAC_PACKET* pRxPkt, const void * r
     while(partialSkt != 0)
     {
         pSkt = partialSkt;
+#if (_TCP_LISTEN_BACKLOG != 0) || (_TCP_EMBRYONIC_LIMIT != 0) || (_TCP_SYN_RATE_LIMIT != 0)
+        newConn = (h->Flags.byte & (SYN | ACK | RST)) == SYN;
+#endif  // (_TCP_LISTEN_BACKLOG != 0) || (_TCP_EMBRYONIC_LIMIT != 0) || (_TCP_SYN_RATE_LIMIT != 0)
+#if (_TCP_SYN_RATE_LIMIT != 0)
+        if(newConn && !_TcpSynRateCheck(remoteIP, addressType))
+        {   // too many connection requests from this source
+            return 0;
+        }
+#endif  // (_TCP_SYN_RATE_LIMIT != 0)
+
+#if (_TCP_SYN_COOKIES != 0)
+        if(newConn)
+        {
+            if(nEmbryonic >= TCPIP_TCP_EMBRYONIC_LIMIT)
+            {   // the listening socket answers with a cookie and keeps no state
+                synCookie = 1;
+                newConn = false;
+            }
+        }
+        else if(tcpCookieActive && (h->Flags.byte & (SYN | ACK | RST)) == ACK)
+        {
+            if((SYS_TMR_TickCountGet() - tcpCookieTime) >= (2 * 64) * sysTickFreq)
+            {   // no cookie sent lately
+                tcpCookieActive = false;
+            }
+            else if((cookieMss = _TcpSynCookieCheck(remoteIP, localIP, addressType, h)) != 0)
+            {   // completes a handshake started with a cookie
+                synCookie = 1;
+                newConn = true;
+            }
+        }
+#elif (_TCP_EMBRYONIC_LIMIT != 0)
+        if(newConn && nEmbryonic >= TCPIP_TCP_EMBRYONIC_LIMIT)
+        {   // too many half-open connections; drop the SYN, the remote will retry
+            return 0;
+        }
+#endif  // (_TCP_SYN_COOKIES != 0)
+
+#if (_TCP_LISTEN_BACKLOG != 0)
+        if(pSkt->backlog != 0 && newConn)
+        {   // the connection goes to a new socket; the listening socket keeps listening
+#if (_TCP_SYN_COOKIES != 0)
+            if(cookieMss != 0 && pSkt->nChildren >= pSkt->backlog)
+            {   // a completed handshake goes before a half-open one
+                _TcpListenEmbryonicDrop(pSkt);
+            }
+#endif  // (_TCP_SYN_COOKIES != 0)
+            if(pSkt->nChildren >= pSkt->backlog || (pSkt = _TcpListenChildCreate(pSkt)) == 0)
+            {   // backlog full or out of resources; drop the SYN, the remote will retry
+                return 0;
+            }
+        }
+#endif  // (_TCP_LISTEN_BACKLOG != 0)
 
         switch(addressType)
         {
@@ -4444,6 +5302,12 @@ static TCB_STUB* _TcpFindMatchingSocket(TCPIP_MAC_PACKET* pRxPkt, const void * r
 
                 if(pSkt->pV6Pkt == 0)
                 {   // failed to allocate memory   
+#if (_TCP_LISTEN_BACKLOG != 0)
+                    if(pSkt->flags.listenChild != 0)
+                    {
+                        _TcpSocketKill(pSkt);
+                    }
+#endif  // (_TCP_LISTEN_BACKLOG != 0)
                     return 0;
                 }
 
@@ -4462,6 +5326,18 @@ static TCB_STUB* _TcpFindMatchingSocket(TCPIP_MAC_PACKET* pRxPkt, const void * r
                 break;
         }
 
+#if (_TCP_SYN_COOKIES != 0)
+        if(cookieMss != 0)
+        {
+            pSkt->wRemoteMSS = cookieMss;
+        }
+        else if(synCookie != 0)
+        {
+            pSkt->MySEQ = _TcpSynCookieGet(remoteIP, localIP, addressType, h);
+        }
+        pSkt->synCookie = synCookie;
+#endif  // (_TCP_SYN_COOKIES != 0)
+
         // success; bind it
         pSkt->addType = addressType;
         _TcpSocketBind(pSkt, pPktIf, (IP_MULTI_ADDRESS*)localIP);
@@ -4522,6 +5398,10 @@ static void _TcpSocketInitialize(TCB_STUB* pSkt, TCP_SOCKET hTCP, uint8_t* txBuf
     pSkt->txEnd     = txBuff + txBuffSize + 1;
     pSkt->rxStart   = rxBuff;
     pSkt->rxEnd     = rxBuff + rxBuffSize;
+#if (_TCP_AUTO_TUNE != 0)
+    pSkt->tuneTxBase = txBuffSize < TCP_MIN_TX_BUFF_SIZE ? TCP_MIN_TX_BUFF_SIZE : txBuffSize;
+    pSkt->tuneRxBase = rxBuffSize < TCP_MIN_RX_BUFF_SIZE ? TCP_MIN_RX_BUFF_SIZE : rxBuffSize;
+#endif  // (_TCP_AUTO_TUNE != 0)
 
     // Start out assuming worst case Maximum Segment Size (changes when MSS 
     // option is received from remote node)
@@ -4562,6 +5442,14 @@ static void _TcpSocketSetIdleState(TCB_STUB* pSkt)
     pSkt->sHoleSize = -1;
     pSkt->remoteWindow = 1;
     pSkt->maxRemoteWindow = 1;
+#if (_TCP_AUTO_TUNE != 0)
+    pSkt->tuneRxMeas = TCP_TUNE_MEAS_NONE;
+    pSkt->tuneRxRtt = TCP_TUNE_RTT_UNKNOWN;
+#endif  // (_TCP_AUTO_TUNE != 0)
+#if (_TCP_QUICK_ACK != 0)
+    pSkt->ackDelay = 0;
+    pSkt->ackQuick = 0;
+#endif  // (_TCP_QUICK_ACK != 0)
 
 
     // Note : no result of the explicit binding is maintained!
@@ -4591,6 +5479,53 @@ static void _TcpSocketSetIdleState(TCB_STUB* pSkt)
 
 }
 
+// releases the socket TX packet
+// freePkt: the packet is freed, else it's kept for reuse
+static void _TcpSocketTxPktRelease(TCB_STUB* pSkt, bool freePkt)
+{
+    while(pSkt->pTxPkt != NULL)
+    {
+#if defined (TCPIP_STACK_USE_IPV6)
+        if(pSkt->addType == IP_ADDRESS_TYPE_IPV6)
+        {
+            if(freePkt)
+            {
+                IPV6_PACKET* pFreePkt = _TxSktFreeLockedV6Pkt(pSkt);
+                if(pFreePkt)
+                {
+                    TCPIP_IPV6_PacketFree (pFreePkt);
+                }
+            }
+            else
+            {
+                IPV6_PACKET* reusePkt = _TxSktGetLockedV6Pkt(pSkt, 0, false); 
+                if( reusePkt != 0)
+                {   // packet in place; reused
+                    TCPIP_IPV6_TransmitPacketStateReset (pSkt->pV6Pkt);
+                }
+            }
+                
+            break;
+        }
+#endif  // defined (TCPIP_STACK_USE_IPV6)
+
+#if defined (TCPIP_STACK_USE_IPV4)
+        if(pSkt->addType == IP_ADDRESS_TYPE_IPV4)
+        {
+            if(freePkt)
+            {
+                TCPIP_MAC_PACKET* pFreePkt = _TxSktFreeLockedV4Pkt(pSkt);
+                if(pFreePkt)
+                {
+                    TCPIP_PKT_PacketFree(pFreePkt);
+                }
+            }
+        }
+#endif  // defined (TCPIP_STACK_USE_IPV4)
+        break;
+    }
+}
+
 /*****************************************************************************
   Function:
     static void _TcpCloseSocket(TCB_STUB* pSkt, TCPIP_TCP_SIGNAL_TYPE tcpEvent)
@@ -4635,47 +5570,7 @@ static void _TcpCloseSocket(TCB_STUB* pSkt, TCPIP_TCP_SIGNAL_TYPE tcpEvent)
         sktIsKilled = true;
         freePkt = true;
     }
-    while(pSkt->pTxPkt != NULL)
-    {
-#if defined (TCPIP_STACK_USE_IPV6)
-        if(pSkt->addType == IP_ADDRESS_TYPE_IPV6)
-        {
-            if(freePkt)
-            {
-                IPV6_PACKET* pFreePkt = _TxSktFreeLockedV6Pkt(pSkt);
-                if(pFreePkt)
-                {
-                    TCPIP_IPV6_PacketFree (pFreePkt);
-                }
-            }
-            else
-            {
-                IPV6_PACKET* reusePkt = _TxSktGetLockedV6Pkt(pSkt, 0, false); 
-                if( reusePkt != 0)
-                {   // packet in place; reused
-                    TCPIP_IPV6_TransmitPacketStateReset (pSkt->pV6Pkt);
-                }
-            }
-                
-            break;
-        }
-#endif  // defined (TCPIP_STACK_USE_IPV6)
-
-#if defined (TCPIP_STACK_USE_IPV4)
-        if(pSkt->addType == IP_ADDRESS_TYPE_IPV4)
-        {
-            if(freePkt)
-            {
-                TCPIP_MAC_PACKET* pFreePkt = _TxSktFreeLockedV4Pkt(pSkt);
-                if(pFreePkt)
-                {
-                    TCPIP_PKT_PacketFree(pFreePkt);
-                }
-            }
-        }
-#endif  // defined (TCPIP_STACK_USE_IPV4)
-        break;
-    }
+    _TcpSocketTxPktRelease(pSkt, freePkt);
 
     sigMask = _TcpSktGetSignalLocked(pSkt, &sigHandler, &sigParam);
     if((tcpEvent &= sigMask))
@@ -4873,6 +5768,9 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
     uint8_t* pSegSrc;
     uint16_t nCopiedBytes;
     uint8_t* newRxHead;
+#if (_TCP_QUICK_ACK != 0)
+    bool outOfOrder = false;
+#endif  // (_TCP_QUICK_ACK != 0)
 
 
      
@@ -4909,6 +5807,20 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
             // Second: check ACK flag, which would be invalid
             if(localHeaderFlags & ACK)
             {
+#if (_TCP_SYN_COOKIES != 0)
+                if(pSkt->synCookie != 0)
+                {   // the ACK carries a valid cookie
+                    // restore the SYN_RECEIVED state and process the segment
+                    pSkt->synCookie = 0;
+                    pSkt->RemoteSEQ = localSeqNumber;
+                    pSkt->MySEQ = localAckNumber;
+                    pSkt->flags.bSYNSent = 1;
+                    pSkt->localMSS = _TcpLocalMssGet(pSkt);
+                    _TCPSetHalfFlushFlag(pSkt);
+                    _TcpSocketSetState(pSkt, TCPIP_TCP_STATE_SYN_RECEIVED);
+                    break;
+                }
+#endif  // (_TCP_SYN_COOKIES != 0)
                 // Use a believable sequence number and reset the remote node
                 pSkt->MySEQ = localAckNumber;
                 _TcpSend(pSkt, RST, 0);
@@ -4926,6 +5838,20 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
                 pSkt->wRemoteMSS = _GetMaxSegSizeOption(h);
                 _TCPSetHalfFlushFlag(pSkt);
 
+#if (_TCP_SYN_COOKIES != 0)
+                if(pSkt->synCookie != 0)
+                {   // MySEQ holds the cookie; send it and forget the connection
+                    pSkt->synCookie = 0;
+                    if(_TcpSend(pSkt, SYN | ACK, 0) == _TCP_SEND_OK)
+                    {
+                        tcpCookieTime = SYS_TMR_TickCountGet();
+                        tcpCookieActive = true;
+                    }
+                    _TcpListenUnbind(pSkt);
+                    return;
+                }
+#endif  // (_TCP_SYN_COOKIES != 0)
+
                 // Respond with SYN + ACK
                 _TcpSend(pSkt, SYN | ACK, SENDTCP_RESET_TIMERS);
                 _TcpSocketSetState(pSkt, TCPIP_TCP_STATE_SYN_RECEIVED);
@@ -4988,6 +5914,9 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
 
                 if(localHeaderFlags & ACK)
                 {
+#if (_TCP_AUTO_TUNE != 0)
+                    _TcpAutoTuneRtt(pSkt);
+#endif  // (_TCP_AUTO_TUNE != 0)
                     _TcpSend(pSkt, ACK, SENDTCP_RESET_TIMERS);
                     _TcpSocketSetState(pSkt, TCPIP_TCP_STATE_ESTABLISHED);
                     *pSktEvent |= TCPIP_TCP_SIGNAL_ESTABLISHED;
@@ -5149,8 +6078,17 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
                 pSkt->MySEQ = localSeqNumber;   // Restore original SEQ number
                 return;
             }
+#if (_TCP_AUTO_TUNE != 0)
+            _TcpAutoTuneRtt(pSkt);
+#endif  // (_TCP_AUTO_TUNE != 0)
             _TcpSocketSetState(pSkt, TCPIP_TCP_STATE_ESTABLISHED);
             *pSktEvent |= TCPIP_TCP_SIGNAL_ESTABLISHED;
+#if (_TCP_LISTEN_BACKLOG != 0)
+            if(pSkt->flags.listenChild != 0)
+            {
+                _TcpAcceptQueueAdd(pSkt);
+            }
+#endif  // (_TCP_LISTEN_BACKLOG != 0)
             // No break
 
         case TCPIP_TCP_STATE_ESTABLISHED:
@@ -5405,6 +6343,9 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
                 // See if we have a hole and other data waiting already in the RX FIFO
                 if(pSkt->sHoleSize != -1)
                 {
+#if (_TCP_QUICK_ACK != 0)
+                    outOfOrder = true;
+#endif  // (_TCP_QUICK_ACK != 0)
                     pSkt->sHoleSize -= len;
                     wTemp = pSkt->wFutureDataSize + pSkt->sHoleSize;
 
@@ -5424,10 +6365,25 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
                         pSkt->sHoleSize = -1;
                     }
                 }
+#if (_TCP_AUTO_TUNE != 0)
+                pSkt->tuneTime = SYS_TMR_TickCountGet();
+                if(pSkt->tuneRxMeas == TCP_TUNE_MEAS_WINDOW && (int32_t)(pSkt->tuneRxEdge - pSkt->RemoteSEQ) < ((pSkt->rxEnd - pSkt->rxStart) >> 3))
+                {   // the advertised window has been received
+                    // a sender limited by the window delivers it in about one round trip
+                    if(pSkt->tuneTime - pSkt->tuneRxStart <= 2 * pSkt->tuneRxRtt + 1)
+                    {
+                        pSkt->tuneRxLimited = 1;
+                    }
+                    pSkt->tuneRxMeas = TCP_TUNE_MEAS_NONE;
+                }
+#endif  // (_TCP_AUTO_TUNE != 0)
             }
         } 
         else if(wMissingBytes > 0)
         {   // wMissingBytes  > 0: this packet contains ahead data
+#if (_TCP_QUICK_ACK != 0)
+            outOfOrder = true;
+#endif  // (_TCP_QUICK_ACK != 0)
             // This packet is out of order or we lost a packet, see if we can generate a hole to accomodate it
             // Truncate packets that would overflow our TCP RX FIFO
             if(len + wMissingBytes > wFreeSpace)
@@ -5502,6 +6458,9 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
     // the delayed acknowledgement algorithm here, only sending 
     // back an immediate ACK if this is the second segment received.  
     // Otherwise, a 200ms timer will cause the ACK to be transmitted.
+    // With _TCP_QUICK_ACK the timer follows the segments inter-arrival time
+    // and the ACK is immediate at the connection start, after an idle period
+    // and for out of order data.
     if(wSegmentLength)
     {
         // For non-established sockets, delete all data in 
@@ -5514,7 +6473,11 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
             pSkt->rxTail = pSkt->rxHead;
         }
 
+#if (_TCP_QUICK_ACK != 0)
+        if(_TcpQuickAckCheck(pSkt, outOfOrder) || pSkt->Flags.bOneSegmentReceived)
+#else
         if(pSkt->Flags.bOneSegmentReceived)
+#endif  // (_TCP_QUICK_ACK != 0)
         {
             _TcpSend(pSkt, ACK, SENDTCP_RESET_TIMERS);
             // bOneSegmentReceived is cleared in _TcpSend(pSkt, ), so no need here
@@ -5529,7 +6492,11 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
             if(!pSkt->Flags.bDelayedACKTimerEnabled)
             {
                 pSkt->Flags.bDelayedACKTimerEnabled = 1;
+#if (_TCP_QUICK_ACK != 0)
+                pSkt->delayedACKTime = SYS_TMR_TickCountGet() + pSkt->ackDelay;
+#else
                 pSkt->delayedACKTime = SYS_TMR_TickCountGet() + (TCPIP_TCP_DELAYED_ACK_TIMEOUT * sysTickFreq)/1000;
+#endif  // (_TCP_QUICK_ACK != 0)
 
             }
         }
@@ -5714,12 +6681,6 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
 #if (TCPIP_TCP_DYNAMIC_OPTIONS != 0)
 bool TCPIP_TCP_FifoSizeAdjust(TCP_SOCKET hTCP, uint16_t wMinRXSize, uint16_t wMinTXSize, TCP_ADJUST_FLAGS vFlags)
 {
-    uint16_t    oldTxSize, pendTxEnd, pendTxBeg, txUnackOffs;
-    uint16_t    oldRxSize, avlblRxEnd, avlblRxBeg;
-    uint16_t    diffChange;
-    uint8_t     *newTxBuff, *newRxBuff;
-    bool        adjustFail;
-    
     if((vFlags & (TCP_ADJUST_TX_ONLY | TCP_ADJUST_RX_ONLY)) == (TCP_ADJUST_TX_ONLY | TCP_ADJUST_RX_ONLY))
     {   // invalid option
         return false;
@@ -5732,6 +6693,32 @@ bool TCPIP_TCP_FifoSizeAdjust(TCP_SOCKET hTCP, uint16_t wMinRXSize, uint16_t wMi
         return false;
     }
 
+    return _TcpFifoSizeAdjust(pSkt, wMinRXSize, wMinTXSize, vFlags, false);
+}
+
+// relocates the socket TX/RX FIFOs
+// autoTune == false: user request, the new sizes become the base for the auto tuning
+// autoTune == true: auto tuning request from the socket user context;
+//      fails if the TCP task ran while the data was copied;
+//      a TX buffer with unacknowledged data is released by the TCP task once that data is acknowledged
+static bool _TcpFifoSizeAdjust(TCB_STUB* pSkt, uint16_t wMinRXSize, uint16_t wMinTXSize, TCP_ADJUST_FLAGS vFlags, bool autoTune)
+{
+    uint16_t    oldTxSize, pendTxEnd, pendTxBeg, txUnackOffs;
+    uint16_t    oldRxSize, avlblRxEnd, avlblRxBeg;
+    uint16_t    diffChange;
+    uint8_t     *newTxBuff, *newRxBuff;
+    uint8_t     *oldTxBuff, *oldRxBuff;
+    bool        adjustFail;
+#if (_TCP_AUTO_TUNE != 0)
+    uint32_t    taskSeq = tcpTaskSeq;
+    uint32_t    oldExcess;
+
+    if(autoTune && (taskSeq & 1) != 0)
+    {   // TCP task is running; retry later
+        return false;
+    }
+#endif  // (_TCP_AUTO_TUNE != 0)
+    
     // minimum size check
     if(wMinRXSize < TCP_MIN_RX_BUFF_SIZE)
     {
@@ -5792,6 +6779,9 @@ bool TCPIP_TCP_FifoSizeAdjust(TCP_SOCKET hTCP, uint16_t wMinRXSize, uint16_t wMi
         newTxBuff = (uint8_t*)TCPIP_HEAP_Malloc(tcpHeapH, wMinTXSize + 1);
         if(newTxBuff == 0)
         {    // fail, out of memory
+#if (_TCP_AUTO_TUNE != 0)
+            tcpTuneFailTime = SYS_TMR_TickCountGet();
+#endif  // (_TCP_AUTO_TUNE != 0)
             return false;
         }
     }
@@ -5815,6 +6805,9 @@ bool TCPIP_TCP_FifoSizeAdjust(TCP_SOCKET hTCP, uint16_t wMinRXSize, uint16_t wMi
         newRxBuff = (uint8_t*)TCPIP_HEAP_Malloc(tcpHeapH, wMinRXSize + 1);
         if(newRxBuff == 0)
         {    // fail, out of memory
+#if (_TCP_AUTO_TUNE != 0)
+            tcpTuneFailTime = SYS_TMR_TickCountGet();
+#endif  // (_TCP_AUTO_TUNE != 0)
             TCPIP_HEAP_Free(tcpHeapH, newTxBuff);
             return false;
         }
@@ -5946,12 +6939,25 @@ bool TCPIP_TCP_FifoSizeAdjust(TCP_SOCKET hTCP, uint16_t wMinRXSize, uint16_t wMi
         return false;
     }
 
+    OSAL_CRITSECT_DATA_TYPE status = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+#if (_TCP_AUTO_TUNE != 0)
+    if(autoTune && tcpTaskSeq != taskSeq)
+    {   // the copied data may be stale
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, status);
+        TCPIP_HEAP_Free(tcpHeapH, newRxBuff);
+        TCPIP_HEAP_Free(tcpHeapH, newTxBuff);
+        return false;
+    }
+    oldExcess = _TcpAutoTuneExcess(pSkt);
+#endif  // (_TCP_AUTO_TUNE != 0)
+
     // success
 
     // adjust new TX pointers
+    oldTxBuff = 0;
     if(newTxBuff)
     {
-        TCPIP_HEAP_Free(tcpHeapH, (void*)pSkt->txStart);
+        oldTxBuff = pSkt->txStart;
         pSkt->txStart =  newTxBuff;
         pSkt->txEnd = newTxBuff + wMinTXSize + 1;
         pSkt->txTail = pSkt->txStart;
@@ -5961,17 +6967,39 @@ bool TCPIP_TCP_FifoSizeAdjust(TCP_SOCKET hTCP, uint16_t wMinRXSize, uint16_t wMi
     }
 
     // adjust new RX pointers
+    oldRxBuff = 0;
     if(newRxBuff)
     {
-        TCPIP_HEAP_Free(tcpHeapH, (void*)pSkt->rxStart);
+        oldRxBuff = pSkt->rxStart;
         pSkt->rxStart = newRxBuff;
         pSkt->rxEnd = newRxBuff + wMinRXSize;
         pSkt->rxTail = pSkt->rxStart;
         pSkt->rxHead = pSkt->rxStart + (avlblRxEnd + avlblRxBeg);
     }
 
+#if (_TCP_AUTO_TUNE != 0)
+    if(!autoTune)
+    {   // user selected sizes
+        pSkt->tuneTxBase = pSkt->txEnd - pSkt->txStart - 1;
+        pSkt->tuneRxBase = pSkt->rxEnd - pSkt->rxStart;
+        pSkt->tuneShrink = 0;
+    }
+    else if(oldTxBuff != 0 && txUnackOffs != 0)
+    {   // packets in flight may still need the old data
+        pSkt->tuneTxOld = oldTxBuff;
+        pSkt->tuneTxOldSeq = pSkt->MySEQ;
+        oldTxBuff = 0;
+    }
+    tcpTuneBytes += _TcpAutoTuneExcess(pSkt) - oldExcess;
+#endif  // (_TCP_AUTO_TUNE != 0)
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, status);
+
+    TCPIP_HEAP_Free(tcpHeapH, oldRxBuff);
+    TCPIP_HEAP_Free(tcpHeapH, oldTxBuff);
+
     // Send a window update to notify remote node of change
-    if(newTxBuff || newRxBuff)
+    // a TX only or shrinking RX change done by the auto tuning needs no update
+    if(autoTune ? (newRxBuff != 0 && wMinRXSize > oldRxSize) : (newTxBuff != 0 || newRxBuff != 0))
     {
         if(pSkt->smState == TCPIP_TCP_STATE_ESTABLISHED)
         {
@@ -5984,6 +7012,186 @@ bool TCPIP_TCP_FifoSizeAdjust(TCP_SOCKET hTCP, uint16_t wMinRXSize, uint16_t wMi
 }
 #endif  // (TCPIP_TCP_DYNAMIC_OPTIONS != 0)
 
+#if (_TCP_AUTO_TUNE != 0)
+// Automatic buffer tuning:
+// - the stack marks the sockets whose transfers are limited by the buffer sizes:
+//      TX: the user tried to put more than the TX buffer could take and the remote window is larger
+//      RX: an advertised window is received within about one round trip, as measured during the handshake
+// - the stack marks the sockets to be shrunk when idle or when the heap is low
+// - the buffers are relocated in the socket user context, when it next calls the data API,
+//   the same way TCPIP_TCP_FifoSizeAdjust() does
+// - growing doubles a buffer, up to TCPIP_TCP_AUTO_TUNE_MAX_SIZE,
+//   with the total growth for all sockets limited to TCPIP_TCP_AUTO_TUNE_TOTAL_SIZE
+// - shrinking returns a buffer to the size the socket was opened with or set by the user
+static void _TcpAutoTune(TCB_STUB* pSkt)
+{
+    uint16_t    txSize, rxSize, newSize, pendSize;
+    bool        shrinkDone;
+
+    txSize = pSkt->txEnd - pSkt->txStart - 1;
+    rxSize = pSkt->rxEnd - pSkt->rxStart;
+
+    if(pSkt->tuneShrink != 0)
+    {   // a buffer with more data than the base size or with the previous TX buffer not released yet is retried next time
+        pSkt->tuneTxLimited = 0;
+        pSkt->tuneRxLimited = 0;
+        shrinkDone = true;
+        if(txSize > pSkt->tuneTxBase)
+        {
+            pendSize = pSkt->txHead >= pSkt->txTail ? pSkt->txHead - pSkt->txTail : (txSize + 1) - (pSkt->txTail - pSkt->txHead);
+            if(pSkt->tuneTxOld != 0 || pendSize > pSkt->tuneTxBase ||
+               !_TcpFifoSizeAdjust(pSkt, 0, pSkt->tuneTxBase, TCP_ADJUST_TX_ONLY | TCP_ADJUST_PRESERVE_TX, true))
+            {
+                shrinkDone = false;
+            }
+        }
+        if(rxSize > pSkt->tuneRxBase)
+        {
+            if(pSkt->sHoleSize != -1 || _TCPIsGetReady(pSkt) > pSkt->tuneRxBase ||
+               !_TcpFifoSizeAdjust(pSkt, pSkt->tuneRxBase, 0, TCP_ADJUST_RX_ONLY | TCP_ADJUST_PRESERVE_RX, true))
+            {
+                shrinkDone = false;
+            }
+        }
+        if(shrinkDone)
+        {
+            pSkt->tuneShrink = 0;
+        }
+        return;
+    }
+
+    if(pSkt->tuneTxLimited != 0 && pSkt->tuneTxOld == 0)
+    {   // the previous TX buffer has been released
+        pSkt->tuneTxLimited = 0;
+        if((newSize = _TcpAutoTuneGrowSize(txSize, pSkt->maxRemoteWindow)) != txSize)
+        {
+            if(!_TcpFifoSizeAdjust(pSkt, 0, newSize, TCP_ADJUST_TX_ONLY | TCP_ADJUST_PRESERVE_TX, true))
+            {   // retry
+                pSkt->tuneTxLimited = 1;
+            }
+        }
+    }
+
+    if(pSkt->tuneRxLimited != 0)
+    {
+        pSkt->tuneRxLimited = 0;
+        if((newSize = _TcpAutoTuneGrowSize(rxSize, TCP_MAX_RX_BUFF_SIZE)) != rxSize)
+        {
+            if(!_TcpFifoSizeAdjust(pSkt, newSize, 0, TCP_ADJUST_RX_ONLY | TCP_ADJUST_PRESERVE_RX, true))
+            {   // retry
+                pSkt->tuneRxLimited = 1;
+            }
+        }
+    }
+}
+
+// returns the new size for a buffer that needs to grow
+// or currSize if it cannot grow
+static uint16_t _TcpAutoTuneGrowSize(uint16_t currSize, uint32_t maxSize)
+{
+    uint32_t    newSize, tuneLeft;
+    size_t      heapFree;
+
+    if(tcpTunePressure)
+    {
+        return currSize;
+    }
+
+    newSize = (uint32_t)currSize << 1;
+    if(newSize > TCPIP_TCP_AUTO_TUNE_MAX_SIZE)
+    {
+        newSize = TCPIP_TCP_AUTO_TUNE_MAX_SIZE;
+    }
+    if(newSize > maxSize)
+    {
+        newSize = maxSize;
+    }
+
+    tuneLeft = tcpTuneBytes < TCPIP_TCP_AUTO_TUNE_TOTAL_SIZE ? TCPIP_TCP_AUTO_TUNE_TOTAL_SIZE - tcpTuneBytes : 0;
+    if(newSize > currSize + tuneLeft)
+    {
+        newSize = currSize + tuneLeft;
+    }
+
+    if(newSize < currSize + TCP_MIN_BUFF_CHANGE)
+    {
+        return currSize;
+    }
+
+    // the old and the new buffer coexist while relocating
+    // a heap that doesn't report its free size relies on the allocation failures
+    heapFree = TCPIP_HEAP_FreeSize(tcpHeapH);
+    if(heapFree != 0 && heapFree < newSize + TCPIP_TCP_AUTO_TUNE_HEAP_RESERVE)
+    {
+        return currSize;
+    }
+
+    return (uint16_t)newSize;
+}
+
+// evaluates the heap pressure, marks the sockets to be shrunk
+// and releases the relocated TX buffers no longer needed
+// called from the TCP task
+static void _TcpAutoTuneTick(void)
+{
+    TCP_SOCKET  hTCP;
+    TCB_STUB*   pSkt;
+    size_t      heapFree;
+    uint32_t    unackLen;
+    uint32_t    currTime = SYS_TMR_TickCountGet();
+    uint32_t    idleTicks = (TCPIP_TCP_AUTO_TUNE_IDLE_TIMEOUT * sysTickFreq) / 1000;
+
+    heapFree = TCPIP_HEAP_FreeSize(tcpHeapH);
+    tcpTunePressure = (heapFree != 0 && heapFree < TCPIP_TCP_AUTO_TUNE_HEAP_RESERVE) ||
+                      (tcpTuneFailTime != 0 && (currTime - tcpTuneFailTime) < idleTicks);
+
+    for(hTCP = 0; hTCP < TcpSockets; hTCP++)
+    {
+        pSkt = TCBStubs[hTCP];
+        if(pSkt == 0)
+        {
+            continue;
+        }
+
+        if(pSkt->tuneTxOld != 0)
+        {
+            switch(pSkt->smState)
+            {
+                case TCPIP_TCP_STATE_ESTABLISHED:
+                case TCPIP_TCP_STATE_CLOSE_WAIT:
+                case TCPIP_TCP_STATE_FIN_WAIT_1:
+                case TCPIP_TCP_STATE_CLOSING:
+                case TCPIP_TCP_STATE_LAST_ACK:
+                    // wait for the old data to be acknowledged
+                    unackLen = pSkt->txUnackedTail - pSkt->txTail;
+                    if(pSkt->txUnackedTail < pSkt->txTail)
+                    {
+                        unackLen += pSkt->txEnd - pSkt->txStart;
+                    }
+                    if((int32_t)(pSkt->MySEQ - unackLen - pSkt->tuneTxOldSeq) < 0)
+                    {
+                        break;
+                    }
+                    // else acknowledged
+
+                default:
+                    TCPIP_HEAP_Free(tcpHeapH, pSkt->tuneTxOld);
+                    pSkt->tuneTxOld = 0;
+                    break;
+            }
+        }
+
+        if(pSkt->tuneShrink == 0 && _TcpAutoTuneExcess(pSkt) != 0)
+        {
+            if(tcpTunePressure || (currTime - pSkt->tuneTime) >= idleTicks)
+            {
+                pSkt->tuneShrink = 1;
+            }
+        }
+    }
+}
+#endif  // (_TCP_AUTO_TUNE != 0)
+
 
 /*
   Function:
@@ -6111,7 +7319,7 @@ static TCP_PORT _TCP_EphemeralPortAllocate(void)
 #if defined(TCPIP_TCP_DISABLE_CRYPTO_USAGE) && (TCPIP_TCP_DISABLE_CRYPTO_USAGE != false)
     next_ephemeral = TCPIP_TCP_LOCAL_PORT_START_NUMBER + (SYS_RANDOM_PseudoGet() % num_ephemeral);
 #else
-    next_ephemeral = TCPIP_TCP_LOCAL_PORT_START_NUMBER + (SYS_RANDOM_CryptoGet() % num_ephemeral);
+    next_ephemeral = TCPIP_TCP_LOCAL_PORT_START_NUMBER + (SYS_RANDOM_PoolGet(SYS_RANDOM_POOL_NET_ID) % num_ephemeral);
 #endif  // defined(TCPIP_TCP_DISABLE_CRYPTO_USAGE) && (TCPIP_TCP_DISABLE_CRYPTO_USAGE != false)
 
     while(count--)
@@ -88,6 +88,13 @@ Microchip or any third party.
 // the minimum MTU value that needs to be supported
 #define TCP_MIN_DEFAULT_MTU     (536)
 
+// auto tuning RX measurement
+#define TCP_TUNE_MEAS_NONE      0       // no measurement in progress
+#define TCP_TUNE_MEAS_WINDOW    1       // timing the reception of an advertised window
+#define TCP_TUNE_MEAS_SYN       2       // timing the handshake round trip
+
+#define TCP_TUNE_RTT_UNKNOWN    0xffffffffU
+
 // the min value of the data offset field, in 32 bit words
 #define TCP_DATA_OFFSET_VAL_MIN    5       // 20 bytes
 
@@ -101,6 +108,64 @@ Microchip or any third party.
 #define _TCP_SOCKET_RETX_TMO    1500        // default value, 1.5 sec
 #endif
 
+// TCP timer rate when no socket needs it: all sockets listening or waiting to connect
+#if defined(TCPIP_TCP_IDLE_TICK_RATE) && (TCPIP_TCP_IDLE_TICK_RATE > TCPIP_TCP_TASK_TICK_RATE)
+#define _TCP_IDLE_TICK_RATE     TCPIP_TCP_IDLE_TICK_RATE
+#else
+#define _TCP_IDLE_TICK_RATE     0
+#endif
+
+// listening sockets with a backlog and accept queue
+#if defined(TCPIP_TCP_LISTEN_BACKLOG) && (TCPIP_TCP_LISTEN_BACKLOG != 0)
+#define _TCP_LISTEN_BACKLOG     1
+#else
+#define _TCP_LISTEN_BACKLOG     0
+#endif
+
+// limit of the half-open connections per listening port
+#if defined(TCPIP_TCP_EMBRYONIC_LIMIT) && (TCPIP_TCP_EMBRYONIC_LIMIT != 0)
+#define _TCP_EMBRYONIC_LIMIT    1
+#else
+#define _TCP_EMBRYONIC_LIMIT    0
+#endif
+
+// SYN cookies are sent above the half-open connections limit
+#if (_TCP_EMBRYONIC_LIMIT != 0) && defined(TCPIP_TCP_SYN_COOKIES) && (TCPIP_TCP_SYN_COOKIES != 0)
+#define _TCP_SYN_COOKIES        1
+#else
+#define _TCP_SYN_COOKIES        0
+#endif
+
+// per source SYN rate limit
+#if defined(TCPIP_TCP_SYN_RATE_LIMIT) && (TCPIP_TCP_SYN_RATE_LIMIT != 0) && defined(TCPIP_TCP_SYN_RATE_SOURCES) && (TCPIP_TCP_SYN_RATE_SOURCES != 0)
+#define _TCP_SYN_RATE_LIMIT     1
+#else
+#define _TCP_SYN_RATE_LIMIT     0
+#endif
+
+// automatic TX/RX buffer tuning; uses the run time FIFO adjustment
+#if defined(TCPIP_TCP_AUTO_TUNE) && (TCPIP_TCP_AUTO_TUNE != 0) && (TCPIP_TCP_DYNAMIC_OPTIONS != 0)
+#define _TCP_AUTO_TUNE          1
+#else
+#define _TCP_AUTO_TUNE          0
+#endif
+
+// adaptive delayed acknowledgment and quick acknowledgment mode
+#if defined(TCPIP_TCP_QUICK_ACK) && (TCPIP_TCP_QUICK_ACK != 0)
+#define _TCP_QUICK_ACK          1
+#else
+#define _TCP_QUICK_ACK          0
+#endif
+
+#if (_TCP_QUICK_ACK != 0)
+// max data segments acknowledged immediately at the connection start and after an idle period
+// the number used is half the RX buffer, in segments, but at least 2
+#define _TCP_QUICK_ACK_SEGMENTS 16
+
+// minimum acknowledgment delay, ms; 2 TCP task ticks
+#define _TCP_ACK_DELAY_MIN      (2 * TCPIP_TCP_TASK_TICK_RATE)
+#endif  // (_TCP_QUICK_ACK != 0)
+
 
 /****************************************************************************
   Section:
@@ -205,8 +270,8 @@ typedef struct
         uint16_t openAddType    : 2;                // the address type used at open
         uint16_t bFINSent       : 1;                // A FIN has been sent
         uint16_t bSYNSent       : 1;                // A SYN has been sent
-        uint16_t res1           : 1;                // not used
-        uint16_t res2           : 1;                // not used
+        uint16_t listenChild    : 1;                // socket created by a listening socket backlog, not yet accepted
+        uint16_t acceptReady    : 1;                // listen child connected and waiting in the accept queue
         uint16_t nonLinger      : 1;                // linger option
         uint16_t nonGraceful    : 1;                // graceful close
         uint16_t ackSent        : 1;                // acknowledge sent in this pass
@@ -229,6 +294,37 @@ typedef struct
     uint8_t             keepAliveLim;               // current limit
     uint8_t ttl;                                    // socket TTL value
     uint8_t tos;                                    // socket TOS value
+#if (_TCP_LISTEN_BACKLOG != 0)
+    uint8_t             backlog;                    // listening socket: max connections pending or waiting to be accepted
+                                                    // 0 means the socket itself takes the connection
+    uint8_t             nChildren;                  // listening socket: current connections pending or waiting to be accepted
+    TCP_SOCKET          acceptHead;                 // listening socket: first connection in the accept queue
+    TCP_SOCKET          listenSkt;                  // listen child: the listening socket that created it
+    TCP_SOCKET          acceptNext;                 // listen child: next connection in the accept queue
+#endif  // (_TCP_LISTEN_BACKLOG != 0)
+#if (_TCP_SYN_COOKIES != 0)
+    uint8_t             synCookie;                  // listening socket: the current segment is a SYN to be answered with a cookie
+                                                    // or an ACK carrying a valid cookie
+#endif  // (_TCP_SYN_COOKIES != 0)
+#if (_TCP_AUTO_TUNE != 0)
+    uint16_t            tuneTxBase;                 // TX buffer size set by the user; auto tuning returns to it
+    uint16_t            tuneRxBase;                 // RX buffer size set by the user; auto tuning returns to it
+    uint32_t            tuneTime;                   // last time data was transferred, ticks
+    uint8_t*            tuneTxOld;                  // relocated TX buffer still referenced by packets in flight
+    uint32_t            tuneTxOldSeq;               // sequence number that, once acknowledged, releases tuneTxOld
+    uint32_t            tuneRxEdge;                 // right edge of the advertised window being timed
+    uint32_t            tuneRxStart;                // time the SYN or the window was sent, ticks
+    uint32_t            tuneRxRtt;                  // round trip time measured during the handshake, ticks
+    uint8_t             tuneTxLimited;              // user: a put was limited by the TX buffer size
+    uint8_t             tuneRxLimited;              // stack: the remote node is limited by the RX window
+    uint8_t             tuneRxMeas;                 // stack: TCP_TUNE_MEAS_ value
+    uint8_t             tuneShrink;                 // stack: socket idle or heap low, buffers should return to the base size
+#endif  // (_TCP_AUTO_TUNE != 0)
+#if (_TCP_QUICK_ACK != 0)
+    uint32_t            ackRxTime;                  // arrival time of the last received segment, ticks
+    uint32_t            ackDelay;                   // current delayed acknowledgment timeout, ticks; 0 if no data received yet
+    uint8_t             ackQuick;                   // data segments still to be acknowledged immediately
+#endif  // (_TCP_QUICK_ACK != 0)
     union
     {
         uint8_t         val;
@@ -243,4 +339,14 @@ typedef struct
     uint8_t pad[];                  // padding; not used
 } TCB_STUB;
 
+#if (_TCP_SYN_RATE_LIMIT != 0)
+// SYN rate of a remote source
+typedef struct
+{
+    uint32_t            srcHash;                    // hash of the source address; 0 if entry not used
+    uint32_t            startTime;                  // start of the current 1 second window, ticks
+    uint16_t            nSyns;                      // SYNs received in the current window
+}TCP_SYN_SOURCE;
+#endif  // (_TCP_SYN_RATE_LIMIT != 0)
+
 #endif  // _TCP_PRIVATE_H_
@@ -93,9 +93,14 @@ Microchip or any third party.
 #define _TCPIP_STACK_HDLC_COMMANDS
 #endif  // defined(TCPIP_STACK_USE_PPP_INTERFACE) && (TCPIP_STACK_HDLC_COMMANDS != 0)
 
-#if defined(_TCPIP_COMMAND_PING4) || defined(_TCPIP_COMMAND_PING6) || defined(TCPIP_STACK_USE_DNS) || defined(_TCPIP_COMMANDS_MIIM) || defined(_TCPIP_STACK_PPP_ECHO_COMMAND)
+#if (defined(TCPIP_STACK_USE_MAC_BRIDGE) && (TCPIP_MAC_BRIDGE_WARM_START != 0)) || (defined(TCPIP_STACK_USE_IPV4) && (TCPIP_ARP_WARM_START != 0))
+#include "system/reset/sys_reset.h"
+#define _TCPIP_COMMAND_WARM_REBOOT
+#endif  // (defined(TCPIP_STACK_USE_MAC_BRIDGE) && (TCPIP_MAC_BRIDGE_WARM_START != 0)) || (defined(TCPIP_STACK_USE_IPV4) && (TCPIP_ARP_WARM_START != 0))
+
+#if defined(_TCPIP_COMMAND_PING4) || defined(_TCPIP_COMMAND_PING6) || defined(TCPIP_STACK_USE_DNS) || defined(_TCPIP_COMMANDS_MIIM) || defined(_TCPIP_STACK_PPP_ECHO_COMMAND) || defined(_TCPIP_COMMAND_WARM_REBOOT)
 #define _TCPIP_STACK_COMMAND_TASK
-#endif // defined(_TCPIP_COMMAND_PING4) || defined(_TCPIP_COMMAND_PING6) || defined(TCPIP_STACK_USE_DNS) || defined(_TCPIP_COMMANDS_MIIM) || defined(_TCPIP_STACK_PPP_ECHO_COMMAND)
+#endif // defined(_TCPIP_COMMAND_PING4) || defined(_TCPIP_COMMAND_PING6) || defined(TCPIP_STACK_USE_DNS) || defined(_TCPIP_COMMANDS_MIIM) || defined(_TCPIP_STACK_PPP_ECHO_COMMAND) || defined(_TCPIP_COMMAND_WARM_REBOOT)
 
 
 #if defined(TCPIP_STACK_COMMANDS_STORAGE_ENABLE) && (TCPIP_STACK_CONFIGURATION_SAVE_RESTORE != 0)
@@ -338,6 +343,9 @@ typedef enum
     TCPIP_CMD_STAT_PPP_START,       // ppp echo start
     TCPIP_PPP_CMD_DO_ECHO,          // do the job
     TCPIP_CMD_STAT_PPP_STOP = TCPIP_PPP_CMD_DO_ECHO,    // pppp echo stop
+
+    // warm reboot status
+    TCPIP_CMD_STAT_REBOOT,          // wait for the warm start snapshots, then reset
 }TCPIP_COMMANDS_STAT;
 
 static SYS_CMD_DEVICE_NODE* pTcpipCmdDevice = 0;
@@ -486,6 +494,18 @@ static void _CommandPacket(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
 static void _CommandBridge(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
 #endif // defined(TCPIP_STACK_USE_MAC_BRIDGE) && (TCPIP_STACK_MAC_BRIDGE_COMMANDS != 0)
 
+#if defined(_TCPIP_COMMAND_WARM_REBOOT)
+#define TCPIP_COMMAND_REBOOT_RATE       100     // rate to check the warm start snapshots, ms
+#define TCPIP_COMMAND_REBOOT_TICKS      50      // max number of checks before resetting anyway
+static void _CommandReboot(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
+static void TCPIPCmdRebootTask(void);
+
+static int  rebootTicks;        // checks done so far
+#if defined(TCPIP_STACK_USE_MAC_BRIDGE) && (TCPIP_MAC_BRIDGE_WARM_START != 0)
+static bool rebootBridgeDone;   // bridge snapshot taken
+#endif  // defined(TCPIP_STACK_USE_MAC_BRIDGE) && (TCPIP_MAC_BRIDGE_WARM_START != 0)
+#endif  // defined(_TCPIP_COMMAND_WARM_REBOOT)
+
 #if defined(_TCPIP_STACK_HDLC_COMMANDS)
 static void _CommandHdlc(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv);
 #endif  // defined(_TCPIP_STACK_HDLC_COMMANDS)
@@ -608,6 +628,9 @@ static const SYS_CMD_DESCRIPTOR    tcpipCmdTbl[]=
 #if defined(TCPIP_STACK_USE_MAC_BRIDGE) && (TCPIP_STACK_MAC_BRIDGE_COMMANDS != 0)
     {"bridge",      _CommandBridge,                 ": Bridge"},
 #endif // defined(TCPIP_STACK_USE_MAC_BRIDGE) && (TCPIP_STACK_MAC_BRIDGE_COMMANDS != 0)
+#if defined(_TCPIP_COMMAND_WARM_REBOOT)
+    {"reboot",      _CommandReboot,                 ": Reset host, saving the warm start data"},
+#endif  // defined(_TCPIP_COMMAND_WARM_REBOOT)
 #if defined(_TCPIP_STACK_HDLC_COMMANDS)
     {"hdlc",        _CommandHdlc,                   ": Hdlc"},
 #endif  // defined(_TCPIP_STACK_HDLC_COMMANDS)
@@ -2307,6 +2330,7 @@ static int _Command_ShowDNSResolvedInfo(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, c
 
     (*pCmdIO->pCmdApi->print)(cmdIoParam, "DNS Client IF - Strict: %s, Preferred: %s\r\n", strictName, prefName);
     (*pCmdIO->pCmdApi->print)(cmdIoParam, "DNS Client - time: %d, pending: %d, current: %d, total: %d\r\n", clientInfo.dnsTime, clientInfo.pendingEntries, clientInfo.currentEntries, clientInfo.totalEntries);
+    (*pCmdIO->pCmdApi->print)(cmdIoParam, "DNS Client - hits: %d, misses: %d, negative: %d, prefetch: %d\r\n", clientInfo.cacheHits, clientInfo.cacheMisses, clientInfo.negativeHits, clientInfo.prefetchQueries);
 
     index = 0;
     while(1)
@@ -4011,6 +4035,59 @@ static void TCPIPCmdPingTask(void)
 
 #endif  // defined(_TCPIP_COMMAND_PING4) || defined(_TCPIP_COMMAND_PING6)
 
+#if defined(_TCPIP_COMMAND_WARM_REBOOT)
+static void _CommandReboot(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
+{
+    const void* cmdIoParam = pCmdIO->cmdIoParam;
+
+    if(tcpipCmdStat != TCPIP_CMD_STAT_IDLE)
+    {
+        (*pCmdIO->pCmdApi->msg)(cmdIoParam, "reboot: command in progress. Retry later.\r\n");
+        return;
+    }
+
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "\r\n *** System Reboot, saving the warm start data ***\r\n");
+
+#if defined(TCPIP_STACK_USE_IPV4) && (TCPIP_ARP_WARM_START != 0)
+    TCPIP_ARP_WarmSnapshot();
+#endif  // defined(TCPIP_STACK_USE_IPV4) && (TCPIP_ARP_WARM_START != 0)
+#if defined(TCPIP_STACK_USE_MAC_BRIDGE) && (TCPIP_MAC_BRIDGE_WARM_START != 0)
+    rebootBridgeDone = false;
+#endif  // defined(TCPIP_STACK_USE_MAC_BRIDGE) && (TCPIP_MAC_BRIDGE_WARM_START != 0)
+    rebootTicks = 0;
+
+    // the snapshots are taken in the stack context
+    tcpipCmdStat = TCPIP_CMD_STAT_REBOOT;
+    pTcpipCmdDevice = pCmdIO;
+    _TCPIPStackSignalHandlerSetParams(TCPIP_THIS_MODULE_ID, tcpipCmdSignalHandle, TCPIP_COMMAND_REBOOT_RATE);
+}
+
+static void TCPIPCmdRebootTask(void)
+{
+    bool snapDone = true;
+
+#if defined(TCPIP_STACK_USE_MAC_BRIDGE) && (TCPIP_MAC_BRIDGE_WARM_START != 0)
+    if(!rebootBridgeDone)
+    {   // retry while the snapshot buffer or the FDB is busy
+        rebootBridgeDone = TCPIP_MAC_Bridge_WarmSnapshot(TCPIP_MAC_Bridge_Open(0)) != TCPIP_MAC_BRIDGE_RES_LOCK_ERROR;
+        snapDone = rebootBridgeDone;
+    }
+#endif  // defined(TCPIP_STACK_USE_MAC_BRIDGE) && (TCPIP_MAC_BRIDGE_WARM_START != 0)
+
+#if defined(TCPIP_STACK_USE_IPV4) && (TCPIP_ARP_WARM_START != 0)
+    if(TCPIP_ARP_WarmSnapshotPending())
+    {   // taken at the next ARP timeout
+        snapDone = false;
+    }
+#endif  // defined(TCPIP_STACK_USE_IPV4) && (TCPIP_ARP_WARM_START != 0)
+
+    if(snapDone || ++rebootTicks >= TCPIP_COMMAND_REBOOT_TICKS)
+    {   // if some snapshot could not be taken, the periodic one is still there
+        SYS_RESET_SoftwareReset();
+    }
+}
+#endif  // defined(_TCPIP_COMMAND_WARM_REBOOT)
+
 void TCPIP_COMMAND_Task(void)
 {
     TCPIP_MODULE_SIGNAL sigPend;
@@ -4045,6 +4122,12 @@ void TCPIP_COMMAND_Task(void)
             TCPIPCmd_PppEchoTask();
         }
 #endif  // defined(_TCPIP_STACK_PPP_ECHO_COMMAND)
+#if defined(_TCPIP_COMMAND_WARM_REBOOT)
+        if(tcpipCmdStat == TCPIP_CMD_STAT_REBOOT)
+        {
+            TCPIPCmdRebootTask();
+        }
+#endif  // defined(_TCPIP_COMMAND_WARM_REBOOT)
     }
 }
 
@@ -6990,7 +7073,7 @@ static void _CommandBridgeShowStats(SYS_CMD_DEVICE_NODE* pCmdIO, TCPIP_MAC_BRIDG
 
     (*pCmdIO->pCmdApi->print)(cmdIoParam, "stats returned: %d\r\n", res);
     (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t failPktAlloc: %d, failDcptAlloc: %d, failLocks: %d, fdbFull: %d\r\n", stat.failPktAlloc, stat.failDcptAlloc, stat.failLocks, stat.fdbFull);
-    (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t failMac: %d, failMtu: %d, failSize: %d\r\n", stat.failMac, stat.failMtu, stat.failSize);
+    (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t failMac: %d, failMtu: %d, failSize: %d, fdbEvictions: %d\r\n", stat.failMac, stat.failMtu, stat.failSize, stat.fdbEvictions);
     (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t allocPackets: %d, freedPackets: %d, ackPackets: %d, delayPackets: %d\r\n", stat.allocPackets, stat.freedPackets, stat.ackPackets, stat.delayPackets);
     (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t pktPoolSize: %d, pktPoolLowSize: %d, pktPoolEmpty: %d\r\n", stat.pktPoolSize, stat.pktPoolLowSize, stat.pktPoolEmpty);
     (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t dcptPoolSize: %d, dcptPoolLowSize: %d, dcptPoolEmpty: %d\r\n", stat.dcptPoolSize, stat.dcptPoolLowSize, stat.dcptPoolEmpty);
@@ -7001,8 +7084,95 @@ static void _CommandBridgeShowStats(SYS_CMD_DEVICE_NODE* pCmdIO, TCPIP_MAC_BRIDG
         (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t port %d stats:\r\n", ix);
         (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t\t pkts received: %d, dest me-ucast: %d, dest notme-ucast: %d, dest mcast: %d\r\n", pPort->rxPackets, pPort->rxDestMeUcast, pPort->rxDestNotMeUcast, pPort->rxDestMcast);
         (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t\t pkts reserved: %d, fwd ucast: %d, fwd mcast: %d, fwd direct: %d\r\n", pPort->reservedPackets, pPort->fwdUcastPackets, pPort->fwdMcastPackets, pPort->fwdDirectPackets);
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t\t pkts VLAN discard: %d, RSTP discard: %d\r\n", pPort->vlanDiscardPackets, pPort->rstpDiscardPackets);
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t\t learn denied: %d, learn drop: %d\r\n", pPort->learnDenied, pPort->learnDropPackets);
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t\t MAC moves: %d, move denied: %d\r\n", pPort->macMoves, pPort->moveDenied);
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t\t backlog: %d, backlog drop: %d, ACKs filtered: %d\r\n", pPort->backlogPackets, pPort->backlogDropPackets, pPort->ackFiltered);
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t\t ACL drop: %d\r\n", pPort->aclDropPackets);
+    }
+}
+
+static void _CommandBridgeShowBoot(SYS_CMD_DEVICE_NODE* pCmdIO, TCPIP_MAC_BRIDGE_HANDLE brH)
+{
+    int ix;
+    const void* cmdIoParam = pCmdIO->cmdIoParam;
+
+    TCPIP_MAC_BRIDGE_BOOT_TIMES bootTimes;
+    if(TCPIP_MAC_Bridge_BootTimesGet(brH, &bootTimes) == false)
+    {
+        (*pCmdIO->pCmdApi->msg)(cmdIoParam, "failed to get boot times!\r\n");
+        return;
+    }
+
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "boot times, us (0 - not reached):\r\n");
+    (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t bridgeInit: %lu, bridgeReady: %lu, stackReady: %lu\r\n", (unsigned long)bootTimes.bridgeInit, (unsigned long)bootTimes.bridgeReady, (unsigned long)bootTimes.stackReady);
+    for(ix = 0; ix < TCPIP_MAC_BRIDGE_MAX_PORTS_NO; ix++)
+    {
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t port %d up: %lu, first rx: %lu\r\n", ix, (unsigned long)bootTimes.portUp[ix], (unsigned long)bootTimes.portRx[ix]);
+    }
+    (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t firstFwd: %lu\r\n", (unsigned long)bootTimes.firstFwd);
+}
+
+#if (TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+static void _CommandBridgePrintId(SYS_CMD_DEVICE_NODE* pCmdIO, const char* msg, const uint8_t* pId)
+{
+    char addBuff[20];
+
+    TCPIP_Helper_MACAddressToString((const TCPIP_MAC_ADDR*)(pId + 2), addBuff, sizeof(addBuff));
+    (*pCmdIO->pCmdApi->print)(pCmdIO->cmdIoParam, "%s%d/%s", msg, ((uint16_t)pId[0] << 8) | pId[1], addBuff);
+}
+
+static void _CommandBridgeShowRstp(SYS_CMD_DEVICE_NODE* pCmdIO, TCPIP_MAC_BRIDGE_HANDLE brH)
+{
+    int ix;
+    TCPIP_MAC_BRIDGE_RSTP_INFO rstpInfo;
+    TCPIP_MAC_BRIDGE_RSTP_PORT_INFO* pPort;
+    const void* cmdIoParam = pCmdIO->cmdIoParam;
+    static const char* roleNames[] = {"disabled", "root", "designated", "alternate", "backup"};
+    static const char* stateNames[] = {"discarding", "learning", "forwarding"};
+
+    if(TCPIP_MAC_Bridge_RstpInfoGet(brH, &rstpInfo) == false)
+    {
+        (*pCmdIO->pCmdApi->msg)(cmdIoParam, "failed to get RSTP info!\r\n");
+        return;
+    }
+
+    _CommandBridgePrintId(pCmdIO, "bridge: ", rstpInfo.bridgeId);
+    _CommandBridgePrintId(pCmdIO, ", root: ", rstpInfo.rootId);
+    (*pCmdIO->pCmdApi->print)(cmdIoParam, ", cost: %lu, root port: %d\r\n", (unsigned long)rstpInfo.rootPathCost, rstpInfo.rootPort);
+    (*pCmdIO->pCmdApi->print)(cmdIoParam, "topology changes: %lu, last: %lu sec ago\r\n", (unsigned long)rstpInfo.tcCount, (unsigned long)rstpInfo.tcAge);
+
+    pPort = rstpInfo.portInfo;
+    for(ix = 0; ix < rstpInfo.nPorts; ix++, pPort++)
+    {
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t port %d, id: 0x%04x, role: %s, state: %s, flags: 0x%02x, cost: %lu\r\n", ix, pPort->portId, roleNames[pPort->role], stateNames[pPort->state], pPort->portFlags, (unsigned long)pPort->pathCost);
+        _CommandBridgePrintId(pCmdIO, "\t\t designated: ", pPort->designatedId);
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, ", port: 0x%04x, BPDUs rx: %lu, tx: %lu, TCs: %lu\r\n", pPort->designatedPort, (unsigned long)pPort->rxBpdus, (unsigned long)pPort->txBpdus, (unsigned long)pPort->tcCount);
+    }
+}
+#endif  // (TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+
+#if (TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+static void _CommandBridgeShowLearn(SYS_CMD_DEVICE_NODE* pCmdIO, TCPIP_MAC_BRIDGE_HANDLE brH)
+{
+    int ix;
+    size_t nLearnt;
+    TCPIP_MAC_BRIDGE_LEARN_LIMIT learnLimit;
+    const void* cmdIoParam = pCmdIO->cmdIoParam;
+    static const char* policyNames[] = {"notify", "drop", "disable"};
+
+    for(ix = 0; ix < TCPIP_MAC_BRIDGE_MAX_PORTS_NO; ix++)
+    {
+        if(TCPIP_MAC_Bridge_LearnLimitGet(brH, ix, &learnLimit, &nLearnt) != TCPIP_MAC_BRIDGE_RES_OK)
+        {
+            (*pCmdIO->pCmdApi->print)(cmdIoParam, "failed to get port %d learn limits!\r\n", ix);
+            continue;
+        }
+
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t port %d, learnt: %lu, max: %d, rate: %d/s, policy: %s\r\n", ix, nLearnt, learnLimit.maxEntries, learnLimit.maxRate, policyNames[learnLimit.policy]);
     }
 }
+#endif  // (TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
 
 static void _CommandBridgeShowFDB(SYS_CMD_DEVICE_NODE* pCmdIO, TCPIP_MAC_BRIDGE_HANDLE brH)
 {
@@ -7032,6 +7202,10 @@ static void _CommandBridgeShowFDB(SYS_CMD_DEVICE_NODE* pCmdIO, TCPIP_MAC_BRIDGE_
                 int nChars = sprintf(flagsBuff, "%s", (fdbEntry.flags & TCPIP_MAC_FDB_FLAG_STATIC) != 0 ? "static" : "dynamic");
                 nChars += sprintf(flagsBuff + nChars, ", %s", (fdbEntry.flags & TCPIP_MAC_FDB_FLAG_HOST) != 0 ? "host" : "ext");
                 nChars += sprintf(flagsBuff + nChars, ", port %s", (fdbEntry.flags & TCPIP_MAC_FDB_FLAG_PORT_VALID) != 0 ? "valid" : "invalid");
+                if((fdbEntry.flags & TCPIP_MAC_FDB_FLAG_PINNED) != 0)
+                {
+                    nChars += sprintf(flagsBuff + nChars, ", %s", "pinned");
+                }
             }
 
             (*pCmdIO->pCmdApi->print)(cmdIoParam, "\tEntry flags: 0x%02x: %s\r\n", fdbEntry.flags, flagsBuff);
@@ -7041,6 +7215,16 @@ static void _CommandBridgeShowFDB(SYS_CMD_DEVICE_NODE* pCmdIO, TCPIP_MAC_BRIDGE_
                 (*pCmdIO->pCmdApi->print)(cmdIoParam, "\tEntry learn port: %d\r\n", fdbEntry.learnPort);
             }
 
+            if(fdbEntry.vlanId != 0) 
+            {
+                (*pCmdIO->pCmdApi->print)(cmdIoParam, "\tEntry VLAN: %d\r\n", fdbEntry.vlanId);
+            }
+
+            if(fdbEntry.moveCount != 0) 
+            {
+                (*pCmdIO->pCmdApi->print)(cmdIoParam, "\tEntry moves: %d\r\n", fdbEntry.moveCount);
+            }
+
             if((fdbEntry.flags & TCPIP_MAC_FDB_FLAG_STATIC) != 0) 
             {   // display the outPortMap 
                 int jx, kx;
@@ -7062,10 +7246,233 @@ static void _CommandBridgeShowFDB(SYS_CMD_DEVICE_NODE* pCmdIO, TCPIP_MAC_BRIDGE_
                 (*pCmdIO->pCmdApi->print)(cmdIoParam, "\tEntry tExpire: 0x%08x\r\n", fdbEntry.tExpire);
             }
             (*pCmdIO->pCmdApi->print)(cmdIoParam, "\tEntry fwdPackets: %lu\r\n", fdbEntry.fwdPackets);
+#if (TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+            (*pCmdIO->pCmdApi->print)(cmdIoParam, "\tEntry txBytes: %lu, rxPackets: %lu, rxBytes: %lu\r\n", fdbEntry.txBytes, fdbEntry.rxPackets, fdbEntry.rxBytes);
+#endif  // (TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+        }
+    }
+
+}
+
+#if (TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
+static void _CommandBridgeShowMoves(SYS_CMD_DEVICE_NODE* pCmdIO, TCPIP_MAC_BRIDGE_HANDLE brH)
+{
+    // list the FDB entries that moved between ports
+    int ix, nMoved;
+    char addrBuff[20];
+    TCPIP_MAC_FDB_ENTRY fdbEntry;
+    const void* cmdIoParam = pCmdIO->cmdIoParam;
+    int nEntries = TCPIP_MAC_Bridge_FDBEntries(brH);
+
+    nMoved = 0;
+    for(ix = 0; ix < nEntries; ix++)
+    {
+        if(TCPIP_MAC_Bridge_FDBIndexRead(brH, ix, &fdbEntry) == TCPIP_MAC_BRIDGE_RES_OK && fdbEntry.moveCount != 0)
+        {
+            TCPIP_Helper_MACAddressToString(&fdbEntry.destAdd, addrBuff, sizeof(addrBuff));
+            (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t %s, port: %d, moves: %d%s\r\n", addrBuff, fdbEntry.learnPort, fdbEntry.moveCount, (fdbEntry.flags & TCPIP_MAC_FDB_FLAG_PINNED) != 0 ? ", pinned" : "");
+            nMoved++;
+        }
+    }
+
+    (*pCmdIO->pCmdApi->print)(cmdIoParam, "moved entries: %d\r\n", nMoved);
+}
+#endif  // (TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
+
+#if (TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+// max number of top talkers displayed
+#define _TCPIP_COMMAND_BRIDGE_TOP_MAX   8
+static void _CommandBridgeShowTop(SYS_CMD_DEVICE_NODE* pCmdIO, TCPIP_MAC_BRIDGE_HANDLE brH, int nTop, const char* keyName)
+{
+    size_t ix, nFound;
+    char addrBuff[20];
+    TCPIP_MAC_BRIDGE_RESULT res;
+    TCPIP_MAC_BRIDGE_TOP_KEY key;
+    TCPIP_MAC_FDB_ENTRY topEntries[_TCPIP_COMMAND_BRIDGE_TOP_MAX];
+    const TCPIP_MAC_FDB_ENTRY* pEntry;
+    const void* cmdIoParam = pCmdIO->cmdIoParam;
+    static const char* keyNames[] = {"bytes", "rx", "tx", "rxpkt", "txpkt"};
+
+    for(key = TCPIP_MAC_BRIDGE_TOP_KEY_BYTES; key < sizeof(keyNames) / sizeof(*keyNames); key++)
+    {
+        if(strcmp(keyName, keyNames[key]) == 0)
+        {
+            break;
         }
     }
 
+    if(key == sizeof(keyNames) / sizeof(*keyNames))
+    {
+        (*pCmdIO->pCmdApi->msg)(cmdIoParam, "top key: bytes/rx/tx/rxpkt/txpkt\r\n");
+        return;
+    }
+
+    if(nTop <= 0 || nTop > _TCPIP_COMMAND_BRIDGE_TOP_MAX)
+    {
+        nTop = _TCPIP_COMMAND_BRIDGE_TOP_MAX;
+    }
+
+    res = TCPIP_MAC_Bridge_FDBTopGet(brH, key, topEntries, nTop, &nFound);
+    if(res != TCPIP_MAC_BRIDGE_RES_OK)
+    {
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, "top failed: %d\r\n", res);
+        return;
+    }
+
+    (*pCmdIO->pCmdApi->print)(cmdIoParam, "top %lu by %s:\r\n", nFound, keyNames[key]);
+    for(ix = 0, pEntry = topEntries; ix < nFound; ix++, pEntry++)
+    {
+        TCPIP_Helper_MACAddressToString(&pEntry->destAdd, addrBuff, sizeof(addrBuff));
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t %s, rx: %lu pkts/%lu bytes, tx: %lu pkts/%lu bytes\r\n", addrBuff, pEntry->rxPackets, pEntry->rxBytes, pEntry->fwdPackets, pEntry->txBytes);
+    }
 }
+#endif  // (TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+
+#if (TCPIP_MAC_BRIDGE_ACL != 0)
+// max number of ACL rules handled by the console
+#define _TCPIP_COMMAND_BRIDGE_ACL_MAX   16
+static void _CommandBridgeShowAcl(SYS_CMD_DEVICE_NODE* pCmdIO, TCPIP_MAC_BRIDGE_HANDLE brH, bool clearHits)
+{
+    size_t ix, nRules;
+    char addrBuff[20];
+    TCPIP_MAC_BRIDGE_RESULT res;
+    TCPIP_MAC_BRIDGE_ACL_RULE rules[_TCPIP_COMMAND_BRIDGE_ACL_MAX];
+    uint32_t hits[_TCPIP_COMMAND_BRIDGE_ACL_MAX];
+    const TCPIP_MAC_BRIDGE_ACL_RULE* pRule;
+    const void* cmdIoParam = pCmdIO->cmdIoParam;
+
+    res = TCPIP_MAC_Bridge_AclGet(brH, rules, hits, _TCPIP_COMMAND_BRIDGE_ACL_MAX, &nRules, clearHits);
+    if(res != TCPIP_MAC_BRIDGE_RES_OK)
+    {
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, "acl get failed: %d\r\n", res);
+        return;
+    }
+
+    (*pCmdIO->pCmdApi->print)(cmdIoParam, "ACL rules: %lu\r\n", nRules);
+    for(ix = 0, pRule = rules; ix < nRules && ix < _TCPIP_COMMAND_BRIDGE_ACL_MAX; ix++, pRule++)
+    {
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, "\t %lu: %s, hits: %lu", ix, pRule->action == TCPIP_MAC_BRIDGE_ACL_ACTION_DROP ? "drop" : "permit", hits[ix]);
+        if((pRule->matchFlags & TCPIP_MAC_BRIDGE_ACL_MATCH_IN_PORT) != 0)
+        {
+            (*pCmdIO->pCmdApi->print)(cmdIoParam, ", port: %d", pRule->inPort);
+        }
+        if((pRule->matchFlags & TCPIP_MAC_BRIDGE_ACL_MATCH_SRC_MAC) != 0)
+        {
+            TCPIP_Helper_MACAddressToString(&pRule->srcAdd, addrBuff, sizeof(addrBuff));
+            (*pCmdIO->pCmdApi->print)(cmdIoParam, ", src: %s", addrBuff);
+        }
+        if((pRule->matchFlags & TCPIP_MAC_BRIDGE_ACL_MATCH_DEST_MAC) != 0)
+        {
+            TCPIP_Helper_MACAddressToString(&pRule->destAdd, addrBuff, sizeof(addrBuff));
+            (*pCmdIO->pCmdApi->print)(cmdIoParam, ", dest: %s", addrBuff);
+        }
+        if((pRule->matchFlags & TCPIP_MAC_BRIDGE_ACL_MATCH_ETHER_TYPE) != 0)
+        {
+            (*pCmdIO->pCmdApi->print)(cmdIoParam, ", type: 0x%04x", pRule->etherType);
+        }
+        if((pRule->matchFlags & TCPIP_MAC_BRIDGE_ACL_MATCH_VLAN) != 0)
+        {
+            (*pCmdIO->pCmdApi->print)(cmdIoParam, ", vlan: %d", pRule->vlanId);
+        }
+        if((pRule->matchFlags & TCPIP_MAC_BRIDGE_ACL_MATCH_IP_PROTO) != 0)
+        {
+            (*pCmdIO->pCmdApi->print)(cmdIoParam, ", proto: %d", pRule->ipProto);
+        }
+        if((pRule->matchFlags & TCPIP_MAC_BRIDGE_ACL_MATCH_SRC_PORT) != 0)
+        {
+            (*pCmdIO->pCmdApi->print)(cmdIoParam, ", sport: %d-%d", pRule->srcPortLow, pRule->srcPortHigh);
+        }
+        if((pRule->matchFlags & TCPIP_MAC_BRIDGE_ACL_MATCH_DEST_PORT) != 0)
+        {
+            (*pCmdIO->pCmdApi->print)(cmdIoParam, ", dport: %d-%d", pRule->destPortLow, pRule->destPortHigh);
+        }
+        (*pCmdIO->pCmdApi->msg)(cmdIoParam, "\r\n");
+    }
+}
+
+// appends a rule to the ACL
+// argv: acl add drop/permit <field value> ...
+static void _CommandBridgeAclAdd(SYS_CMD_DEVICE_NODE* pCmdIO, TCPIP_MAC_BRIDGE_HANDLE brH, int argc, char** argv)
+{
+    int argIx;
+    size_t nRules;
+    char* pEnd;
+    const char* value;
+    TCPIP_MAC_BRIDGE_RESULT res;
+    TCPIP_MAC_BRIDGE_ACL_RULE rules[_TCPIP_COMMAND_BRIDGE_ACL_MAX];
+    TCPIP_MAC_BRIDGE_ACL_RULE* pRule;
+    const void* cmdIoParam = pCmdIO->cmdIoParam;
+
+    res = TCPIP_MAC_Bridge_AclGet(brH, rules, 0, _TCPIP_COMMAND_BRIDGE_ACL_MAX, &nRules, false);
+    if(res != TCPIP_MAC_BRIDGE_RES_OK || nRules >= _TCPIP_COMMAND_BRIDGE_ACL_MAX)
+    {
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, "acl add failed: %d, rules: %lu\r\n", res, nRules);
+        return;
+    }
+
+    pRule = rules + nRules;
+    memset(pRule, 0, sizeof(*pRule));
+    if(argc < 5 || (strcmp(argv[2], "drop") != 0 && strcmp(argv[2], "permit") != 0) || (argc & 1) != 1)
+    {
+        (*pCmdIO->pCmdApi->msg)(cmdIoParam, "acl add drop/permit <port/src/dest/type/vlan/proto/sport/dport value> ...\r\n");
+        return;
+    }
+    pRule->action = strcmp(argv[2], "drop") == 0 ? TCPIP_MAC_BRIDGE_ACL_ACTION_DROP : TCPIP_MAC_BRIDGE_ACL_ACTION_PERMIT;
+
+    for(argIx = 3; argIx + 1 < argc; argIx += 2)
+    {
+        value = argv[argIx + 1];
+        if(strcmp(argv[argIx], "port") == 0)
+        {
+            pRule->matchFlags |= TCPIP_MAC_BRIDGE_ACL_MATCH_IN_PORT;
+            pRule->inPort = (uint8_t)atoi(value);
+        }
+        else if(strcmp(argv[argIx], "src") == 0 && TCPIP_Helper_StringToMACAddress(value, pRule->srcAdd.v))
+        {
+            pRule->matchFlags |= TCPIP_MAC_BRIDGE_ACL_MATCH_SRC_MAC;
+        }
+        else if(strcmp(argv[argIx], "dest") == 0 && TCPIP_Helper_StringToMACAddress(value, pRule->destAdd.v))
+        {
+            pRule->matchFlags |= TCPIP_MAC_BRIDGE_ACL_MATCH_DEST_MAC;
+        }
+        else if(strcmp(argv[argIx], "type") == 0)
+        {
+            pRule->matchFlags |= TCPIP_MAC_BRIDGE_ACL_MATCH_ETHER_TYPE;
+            pRule->etherType = (uint16_t)strtoul(value, 0, 16);
+        }
+        else if(strcmp(argv[argIx], "vlan") == 0)
+        {
+            pRule->matchFlags |= TCPIP_MAC_BRIDGE_ACL_MATCH_VLAN;
+            pRule->vlanId = (uint16_t)atoi(value);
+        }
+        else if(strcmp(argv[argIx], "proto") == 0)
+        {
+            pRule->matchFlags |= TCPIP_MAC_BRIDGE_ACL_MATCH_IP_PROTO;
+            pRule->ipProto = (uint8_t)atoi(value);
+        }
+        else if(strcmp(argv[argIx], "sport") == 0)
+        {   // port or low-high
+            pRule->matchFlags |= TCPIP_MAC_BRIDGE_ACL_MATCH_SRC_PORT;
+            pRule->srcPortLow = (uint16_t)strtoul(value, &pEnd, 10);
+            pRule->srcPortHigh = *pEnd == '-' ? (uint16_t)strtoul(pEnd + 1, 0, 10) : pRule->srcPortLow;
+        }
+        else if(strcmp(argv[argIx], "dport") == 0)
+        {
+            pRule->matchFlags |= TCPIP_MAC_BRIDGE_ACL_MATCH_DEST_PORT;
+            pRule->destPortLow = (uint16_t)strtoul(value, &pEnd, 10);
+            pRule->destPortHigh = *pEnd == '-' ? (uint16_t)strtoul(pEnd + 1, 0, 10) : pRule->destPortLow;
+        }
+        else
+        {
+            (*pCmdIO->pCmdApi->print)(cmdIoParam, "acl add: invalid %s %s\r\n", argv[argIx], value);
+            return;
+        }
+    }
+
+    res = TCPIP_MAC_Bridge_AclSet(brH, rules, nRules + 1);
+    (*pCmdIO->pCmdApi->print)(cmdIoParam, "acl add returned: %d\r\n", res);
+}
+#endif  // (TCPIP_MAC_BRIDGE_ACL != 0)
 
 #if (TCPIP_MAC_BRIDGE_DYNAMIC_FDB_ACCESS != 0)
 static void _CommandBridgeResetFDB(SYS_CMD_DEVICE_NODE* pCmdIO, TCPIP_MAC_BRIDGE_HANDLE brH)
@@ -7179,6 +7586,32 @@ static void _CommandBridgeEventHandler(TCPIP_MAC_BRIDGE_EVENT evType, const void
             sprintf(evBuff, "%s, address: %s\r\n", "entry expired", addBuff);
             break;
 
+        case TCPIP_MAC_BRIDGE_EVENT_LEARN_DENIED:
+            pMacAdd = (const TCPIP_MAC_ADDR*)param;
+            TCPIP_Helper_MACAddressToString(pMacAdd, addBuff, sizeof(addBuff));
+            sprintf(evBuff, "%s, address: %s\r\n", "learn denied", addBuff);
+            break;
+
+        case TCPIP_MAC_BRIDGE_EVENT_ENTRY_EVICTED:
+            pMacAdd = (const TCPIP_MAC_ADDR*)param;
+            TCPIP_Helper_MACAddressToString(pMacAdd, addBuff, sizeof(addBuff));
+            sprintf(evBuff, "%s, address: %s\r\n", "entry evicted", addBuff);
+            break;
+
+        case TCPIP_MAC_BRIDGE_EVENT_ENTRY_PINNED:
+            pMacAdd = (const TCPIP_MAC_ADDR*)param;
+            TCPIP_Helper_MACAddressToString(pMacAdd, addBuff, sizeof(addBuff));
+            sprintf(evBuff, "%s, address: %s\r\n", "entry pinned", addBuff);
+            break;
+
+        case TCPIP_MAC_BRIDGE_EVENT_TOPOLOGY_CHANGE:
+            sprintf(evBuff, "%s, port: %lu\r\n", "topology change", (size_t)param);
+            break;
+
+        case TCPIP_MAC_BRIDGE_EVENT_PORT_STATE:
+            sprintf(evBuff, "%s, port: %lu, state: %lu\r\n", "port state", (size_t)param >> 8, (size_t)param & 0xff);
+            break;
+
         default:
             sprintf(evBuff, "unknown!\r\n");
             break;
@@ -7195,6 +7628,12 @@ static void _CommandBridge(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
 {
     // bridge stats <clr>
     // bridge status
+    // bridge boot
+    // bridge rstp <port n prio cost edge>
+    // bridge learn <port max rate policy>
+    // bridge moves
+    // bridge top <n key>/clr
+    // bridge acl <clr/del/add>
     // bridge fdb show/reset/add/delete
     // bridge register <param>
 
@@ -7227,6 +7666,104 @@ static void _CommandBridge(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
             return;
         }
 
+        if(strcmp(argv[1], "boot") == 0)
+        {
+            _CommandBridgeShowBoot(pCmdIO, brH);
+            return;
+        }
+
+#if (TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+        if(strcmp(argv[1], "rstp") == 0)
+        {
+            if(argc > 2 && strcmp(argv[2], "port") == 0)
+            {
+                if(argc < 7)
+                {
+                    break;
+                }
+
+                TCPIP_MAC_BRIDGE_RSTP_PORT_CONFIG portCfg;
+                portCfg.portPriority = (uint8_t)atoi(argv[4]);
+                portCfg.pathCost = (uint32_t)atoi(argv[5]);
+                portCfg.adminEdge = (uint8_t)atoi(argv[6]);
+                TCPIP_MAC_BRIDGE_RESULT res = TCPIP_MAC_Bridge_RstpPortSet(brH, atoi(argv[3]), &portCfg);
+                (*pCmdIO->pCmdApi->print)(cmdIoParam, "rstp port set returned: %d\r\n", res);
+                return;
+            }
+
+            _CommandBridgeShowRstp(pCmdIO, brH);
+            return;
+        }
+#endif  // (TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+
+#if (TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+        if(strcmp(argv[1], "learn") == 0)
+        {
+            if(argc > 2)
+            {
+                if(argc < 6)
+                {
+                    break;
+                }
+
+                TCPIP_MAC_BRIDGE_LEARN_LIMIT learnLimit;
+                learnLimit.maxEntries = (uint16_t)atoi(argv[3]);
+                learnLimit.maxRate = (uint16_t)atoi(argv[4]);
+                learnLimit.policy = (uint8_t)atoi(argv[5]);
+                TCPIP_MAC_BRIDGE_RESULT res = TCPIP_MAC_Bridge_LearnLimitSet(brH, atoi(argv[2]), &learnLimit);
+                (*pCmdIO->pCmdApi->print)(cmdIoParam, "learn limit set returned: %d\r\n", res);
+                return;
+            }
+
+            _CommandBridgeShowLearn(pCmdIO, brH);
+            return;
+        }
+#endif  // (TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+
+#if (TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
+        if(strcmp(argv[1], "moves") == 0)
+        {
+            _CommandBridgeShowMoves(pCmdIO, brH);
+            return;
+        }
+#endif  // (TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
+
+#if (TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+        if(strcmp(argv[1], "top") == 0)
+        {
+            if(argc > 2 && strcmp(argv[2], "clr") == 0)
+            {
+                TCPIP_MAC_BRIDGE_RESULT res = TCPIP_MAC_Bridge_FDBCountersReset(brH);
+                (*pCmdIO->pCmdApi->print)(cmdIoParam, "counters reset returned: %d\r\n", res);
+                return;
+            }
+
+            _CommandBridgeShowTop(pCmdIO, brH, argc > 2 ? atoi(argv[2]) : 0, argc > 3 ? argv[3] : "bytes");
+            return;
+        }
+#endif  // (TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+
+#if (TCPIP_MAC_BRIDGE_ACL != 0)
+        if(strcmp(argv[1], "acl") == 0)
+        {
+            if(argc > 2 && strcmp(argv[2], "del") == 0)
+            {
+                TCPIP_MAC_BRIDGE_RESULT res = TCPIP_MAC_Bridge_AclSet(brH, 0, 0);
+                (*pCmdIO->pCmdApi->print)(cmdIoParam, "acl delete returned: %d\r\n", res);
+                return;
+            }
+
+            if(argc > 2 && strcmp(argv[2], "add") == 0)
+            {
+                _CommandBridgeAclAdd(pCmdIO, brH, argc - 1, argv + 1);
+                return;
+            }
+
+            _CommandBridgeShowAcl(pCmdIO, brH, argc > 2 && strcmp(argv[2], "clr") == 0);
+            return;
+        }
+#endif  // (TCPIP_MAC_BRIDGE_ACL != 0)
+
 #if (TCPIP_MAC_BRIDGE_EVENT_NOTIFY  != 0) 
         if(strcmp(argv[1], "register") == 0)
         {
@@ -7312,6 +7849,22 @@ static void _CommandBridge(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
 
     (*pCmdIO->pCmdApi->msg)(cmdIoParam, "usage: bridge status\r\n");
     (*pCmdIO->pCmdApi->msg)(cmdIoParam, "usage: bridge stats <clr>\r\n");
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "usage: bridge boot\r\n");
+#if (TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "usage: bridge rstp <port n prio cost edge>\r\n");
+#endif  // (TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+#if (TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "usage: bridge learn <port max rate policy>\r\n");
+#endif  // (TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+#if (TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "usage: bridge moves\r\n");
+#endif  // (TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
+#if (TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "usage: bridge top <n bytes/rx/tx/rxpkt/txpkt>/clr\r\n");
+#endif  // (TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+#if (TCPIP_MAC_BRIDGE_ACL != 0)
+    (*pCmdIO->pCmdApi->msg)(cmdIoParam, "usage: bridge acl <clr/del/add drop/permit field value ...>\r\n");
+#endif  // (TCPIP_MAC_BRIDGE_ACL != 0)
 #if (TCPIP_MAC_BRIDGE_EVENT_NOTIFY  != 0) 
     (*pCmdIO->pCmdApi->msg)(cmdIoParam, "usage: bridge register <param>\r\n");
 #endif  // (TCPIP_MAC_BRIDGE_EVENT_NOTIFY  != 0) 
@@ -50,7 +50,8 @@ static void     _MAC_Bridge_Cleanup(void);
 static int      _MAC_Bridge_SetPorts(MAC_BRIDGE_DCPT* pBDcpt, const TCPIP_MAC_BRIDGE_CONFIG* pConfig);
 
 static TCPIP_MAC_BRIDGE_RESULT      _MAC_Bridge_SetPermEntries(MAC_BRIDGE_DCPT* pDcpt, const TCPIP_MAC_BRIDGE_CONFIG* pBConfig);
-static TCPIP_MAC_BRIDGE_RESULT      _MAC_Bridge_SetHostEntries(MAC_BRIDGE_DCPT* pDcpt);
+static TCPIP_MAC_BRIDGE_RESULT      _MAC_Bridge_SetHostEntry(MAC_BRIDGE_DCPT* pDcpt, int portIx);
+static bool     _MAC_Bridge_CompleteInit(MAC_BRIDGE_DCPT* pDcpt);
 
 static TCPIP_MAC_BRIDGE_RESULT      _MAC_Bridge_SetFDBFromPerm(MAC_BRIDGE_DCPT* pBDcpt, MAC_BRIDGE_HASH_ENTRY* hE,  const TCPIP_MAC_BRIDGE_PERMANENT_ENTRY* pPerm);
 
@@ -66,6 +67,11 @@ static size_t   _MAC_BridgeHashKeyHash(OA_HASH_DCPT* pOH, const void* key);
 static OA_HASH_ENTRY* _MAC_BridgeHashEntryDelete(OA_HASH_DCPT* pOH);
 static int      _MAC_BridgeHashKeyCompare(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* hEntry, const void* key);
 static void     _MAC_BridgeHashKeyCopy(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* dstEntry, const void* key);
+#if (_TCPIP_MAC_BRIDGE_FDB_RESIZE != 0)
+static const void* _MAC_BridgeHashEntryKey(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* hEntry);
+static void*    _MAC_BridgeHashAlloc(OA_HASH_DCPT* pOH, size_t nBytes);
+static void     _MAC_BridgeHashFree(OA_HASH_DCPT* pOH, void* memBlk);
+#endif  // (_TCPIP_MAC_BRIDGE_FDB_RESIZE != 0)
 
 static void     _MAC_Bridge_SetPacketForward(MAC_BRIDGE_DCPT* pBDcpt, MAC_BRIDGE_HASH_ENTRY* heDest, uint8_t inPort, MAC_BRIDGE_FWD_DCPT* pFDcpt);
 
@@ -88,6 +94,72 @@ static void     _MAC_Bridge_StatPortUpdate(MAC_BRIDGE_DCPT* bDcpt, int port, MAC
 #define         _MAC_Bridge_StatPortUpdate(bDcpt, port, statType, incUpdate)
 #endif  // (_TCPIP_MAC_BRIDGE_STATISTICS != 0)
 
+#if (_TCPIP_MAC_BRIDGE_WARM_START != 0) 
+static void     _MAC_Bridge_WarmSnapshot(MAC_BRIDGE_DCPT* pBDcpt);
+static int      _MAC_Bridge_WarmRestore(MAC_BRIDGE_DCPT* pBDcpt);
+#else
+#define         _MAC_Bridge_WarmSnapshot(pBDcpt)
+#define         _MAC_Bridge_WarmRestore(pBDcpt)
+#endif  // (_TCPIP_MAC_BRIDGE_WARM_START != 0) 
+
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+static TCPIP_MAC_BRIDGE_RESULT      _MAC_Bridge_SetVlans(MAC_BRIDGE_DCPT* pBDcpt, const TCPIP_MAC_BRIDGE_CONFIG* pBConfig);
+static const MAC_BRIDGE_VLAN_DCPT*  _MAC_Bridge_VlanFind(MAC_BRIDGE_DCPT* pBDcpt, uint16_t vlanId);
+static const MAC_BRIDGE_VLAN_DCPT*  _MAC_Bridge_VlanIngress(MAC_BRIDGE_DCPT* pBDcpt, TCPIP_MAC_PACKET* pRxPkt, uint8_t inPort, MAC_BRIDGE_FWD_DCPT* pFDcpt);
+static bool     _MAC_Bridge_VlanNeedsCopy(const MAC_BRIDGE_FWD_DCPT* pFDcpt);
+static void     _MAC_Bridge_VlanPacketCopy(TCPIP_MAC_PACKET* pSrcPkt, TCPIP_MAC_PACKET* pBridgePkt, const MAC_BRIDGE_FWD_DCPT* pFDcpt);
+static void     _MAC_Bridge_VlanEgress(TCPIP_MAC_PACKET* pPkt, const MAC_BRIDGE_FWD_DCPT* pFDcpt, bool txUntagged);
+static MAC_BRIDGE_HASH_ENTRY*       _MAC_Bridge_FDBLookup(MAC_BRIDGE_DCPT* pBDcpt, const TCPIP_MAC_ADDR* pAdd, uint16_t vlanId);
+static MAC_BRIDGE_HASH_ENTRY*       _MAC_Bridge_FDBInsert(MAC_BRIDGE_DCPT* pBDcpt, const TCPIP_MAC_ADDR* pAdd, uint16_t vlanId);
+#else
+// the FDB is keyed by the MAC address only; the vlanId is ignored
+#define         _MAC_Bridge_FDBLookup(pBDcpt, pAdd, vlanId)     (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryLookup((pBDcpt)->hashDcpt, (pAdd)->v)
+#define         _MAC_Bridge_FDBInsert(pBDcpt, pAdd, vlanId)     (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryLookupOrInsert((pBDcpt)->hashDcpt, (pAdd)->v)
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+
+#if (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+static void     _MAC_Bridge_RstpInit(MAC_BRIDGE_DCPT* pBDcpt);
+static void     _MAC_Bridge_RstpTask(MAC_BRIDGE_DCPT* pBDcpt, uint32_t currSec);
+static void     _MAC_Bridge_RstpRxBpdu(MAC_BRIDGE_DCPT* pBDcpt, TCPIP_MAC_PACKET* pRxPkt, uint8_t inPort);
+#else
+#define         _MAC_Bridge_RstpInit(pBDcpt)
+#endif  // (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+
+#if (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+static void     _MAC_Bridge_LearnInit(MAC_BRIDGE_DCPT* pBDcpt);
+static MAC_BRIDGE_LEARN_RES _MAC_Bridge_LearnCheck(MAC_BRIDGE_DCPT* pBDcpt, uint8_t port, TCPIP_MAC_BRIDGE_EVENT* pEvent);
+static void     _MAC_Bridge_LearnCount(MAC_BRIDGE_DCPT* pBDcpt, MAC_BRIDGE_HASH_ENTRY* hE, uint8_t port);
+#else
+#define         _MAC_Bridge_LearnInit(pBDcpt)
+#define         _MAC_Bridge_LearnCheck(pBDcpt, port, pEvent)    MAC_BRIDGE_LEARN_RES_ALLOW
+#define         _MAC_Bridge_LearnCount(pBDcpt, hE, port)
+#endif  // (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+
+#if (_TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
+static bool     _MAC_Bridge_MoveCheck(MAC_BRIDGE_DCPT* pBDcpt, MAC_BRIDGE_HASH_ENTRY* hE, uint8_t port, TCPIP_MAC_BRIDGE_EVENT* pEvent);
+#else
+#define         _MAC_Bridge_MoveCheck(pBDcpt, hE, port, pEvent) (true)
+#endif  // (_TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
+
+#if (_TCPIP_MAC_BRIDGE_TX_BACKLOG != 0)
+static bool     _MAC_Bridge_BacklogPending(MAC_BRIDGE_DCPT* pBDcpt, int brPort, const MAC_BRIDGE_FWD_DCPT* pFDcpt);
+static bool     _MAC_Bridge_BacklogAdd(MAC_BRIDGE_DCPT* pBDcpt, int brPort, TCPIP_MAC_PACKET* pFwdPkt);
+static void     _MAC_Bridge_BacklogService(MAC_BRIDGE_DCPT* pBDcpt, int brPort);
+#endif  // (_TCPIP_MAC_BRIDGE_TX_BACKLOG != 0)
+
+#if (_TCPIP_MAC_BRIDGE_ACK_FILTER != 0)
+static void     _MAC_Bridge_AckFilter(MAC_BRIDGE_DCPT* pBDcpt, int brPort, TCPIP_MAC_PACKET* pNewPkt);
+#else
+#define         _MAC_Bridge_AckFilter(pBDcpt, brPort, pNewPkt)
+#endif  // (_TCPIP_MAC_BRIDGE_ACK_FILTER != 0)
+
+#if (_TCPIP_MAC_BRIDGE_ACL != 0)
+static TCPIP_MAC_BRIDGE_RESULT      _MAC_Bridge_AclCompile(MAC_BRIDGE_DCPT* pBDcpt, const TCPIP_MAC_BRIDGE_ACL_RULE* pRules, size_t nRules, MAC_BRIDGE_ACL** ppAcl);
+static bool     _MAC_Bridge_AclCheck(MAC_BRIDGE_DCPT* pBDcpt, TCPIP_MAC_PACKET* pRxPkt, uint8_t inPort);
+#else
+#define         _MAC_Bridge_AclCheck(pBDcpt, pRxPkt, inPort)    (true)
+#endif  // (_TCPIP_MAC_BRIDGE_ACL != 0)
+
 #if (_TCPIP_MAC_BRIDGE_EVENT_NOTIFY  != 0) 
 static void     _MAC_Bridge_NotifyEvent(MAC_BRIDGE_DCPT* pBDcpt, TCPIP_MAC_BRIDGE_EVENT event, const void* evParam);
 #else
@@ -109,6 +181,11 @@ static MAC_BRIDGE_DCPT* gBridgeDcpt = 0;
 
 static const uint8_t bridge_reserved_address[6] = {0x01, 0x80, 0xC2, 0x00, 0x00, 0x00};
 
+#if (_TCPIP_MAC_BRIDGE_WARM_START != 0) 
+// learnt FDB entries; not cleared by the start up code
+static MAC_BRIDGE_WARM_SNAPSHOT bridgeWarmSnap __attribute__((persistent));
+#endif  // (_TCPIP_MAC_BRIDGE_WARM_START != 0) 
+
 // implementation
 #if ((MAC_BRIDGE_DEBUG_MASK & MAC_BRIDGE_DEBUG_MASK_BASIC) != 0)
 volatile int _MacBridgeStayAssertLoop = 0;
@@ -153,8 +230,8 @@ bool _MAC_Bridge_CheckFDB(MAC_BRIDGE_DCPT* pDcpt)
     int traceIx = 0;
     TCPIP_MAC_ADDR* pTrace = hashTrace;
 
-    int nEntries = pDcpt->hashDcpt->hEntries;
-    for(ix = 0; ix < nEntries; ix++)
+    int nEntries = TCPIP_OAHASH_EntryRange(pDcpt->hashDcpt);
+    for(ix = 0; ix < nEntries && traceIx < sizeof(hashTrace) / sizeof(*hashTrace); ix++)
     {
         hE = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryGet(pDcpt->hashDcpt, ix);
         if(hE->hEntry.flags.busy != 0)
@@ -330,6 +407,249 @@ static __inline__ uint32_t __attribute__((always_inline))  _MAC_Bridge_GetSecond
     return bridgeSecCount;
 }
 
+#if (_TCPIP_MAC_BRIDGE_BOOT_TIMESTAMPS != 0) 
+// boot stage time keeping
+// SYS_TIME runs on the core timer; only the 1st occurrence of a stage is recorded
+static __inline__ void __attribute__((always_inline))  _MAC_Bridge_BootStamp(uint64_t* pStamp)
+{
+    if(*pStamp == 0)
+    {
+        *pStamp = SYS_TIME_Counter64Get();
+    }
+}
+
+static uint32_t _MAC_Bridge_BootStampToUs(uint64_t stamp)
+{
+    uint32_t sysFreq = SYS_TIME_FrequencyGet();
+    return sysFreq == 0 ? 0 : (uint32_t)((stamp * 1000000ull) / sysFreq);
+}
+
+static void _MAC_Bridge_BootReport(MAC_BRIDGE_DCPT* pBDcpt)
+{
+    MAC_BRIDGE_BOOT_STAMPS* pStamps = &pBDcpt->bootStamps;
+    SYS_CONSOLE_PRINT("MAC Bridge: init %lu us, ready %lu us, stack ready %lu us\r\n", (unsigned long)_MAC_Bridge_BootStampToUs(pStamps->bridgeInit),
+            (unsigned long)_MAC_Bridge_BootStampToUs(pStamps->bridgeReady), (unsigned long)_MAC_Bridge_BootStampToUs(pStamps->stackReady));
+}
+
+// with the staged stack initialization the bridge is ready before the stack:
+// records the stack ready stage and reports the boot times once both are ready
+static void _MAC_Bridge_BootCheck(MAC_BRIDGE_DCPT* pBDcpt)
+{
+    MAC_BRIDGE_BOOT_STAMPS* pStamps = &pBDcpt->bootStamps;
+    if(pStamps->stackReady == 0 && TCPIP_STACK_Status(TCPIP_STACK_Initialize(0, 0)) == SYS_STATUS_READY)
+    {
+        _MAC_Bridge_BootStamp(&pStamps->stackReady);
+        if(pStamps->bridgeReady != 0)
+        {
+            _MAC_Bridge_BootReport(pBDcpt);
+        }
+    }
+}
+
+#define _MAC_Bridge_BootStampSet(pBDcpt, stage)             _MAC_Bridge_BootStamp(&(pBDcpt)->bootStamps.stage)
+#define _MAC_Bridge_BootStampPortSet(pBDcpt, stage, port)   _MAC_Bridge_BootStamp((pBDcpt)->bootStamps.stage + (port))
+#else
+#define _MAC_Bridge_BootStampSet(pBDcpt, stage)
+#define _MAC_Bridge_BootStampPortSet(pBDcpt, stage, port)
+#define _MAC_Bridge_BootReport(pBDcpt)
+#define _MAC_Bridge_BootCheck(pBDcpt)
+#endif  // (_TCPIP_MAC_BRIDGE_BOOT_TIMESTAMPS != 0) 
+
+#if (_TCPIP_MAC_BRIDGE_WARM_START != 0) 
+// FDB warm start
+// a snapshot of the learnt entries is kept in persistent RAM
+// and is used to re-populate the FDB after a soft reset,
+// so that the bridge doesn't have to flood until all the stations are learnt again
+
+// hash of the bridge configuration that affects the snapshot layout and meaning
+static uint16_t _MAC_Bridge_WarmCfgHash(MAC_BRIDGE_DCPT* pBDcpt)
+{
+    uint32_t cfgData[5];
+
+    cfgData[0] = (uint32_t)pBDcpt->hashDcpt->minEntries;
+    cfgData[1] = (uint32_t)sizeof(MAC_BRIDGE_WARM_SNAPSHOT);
+    cfgData[2] = pBDcpt->purgeTmo;
+    cfgData[3] = (uint32_t)pBDcpt->nPorts;
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+    cfgData[4] = (uint32_t)pBDcpt->nVlans;
+#else
+    cfgData[4] = 0;
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+
+    uint16_t cfgHash = TCPIP_Helper_CalcIPChecksum((const uint8_t*)cfgData, sizeof(cfgData), 0);
+    return TCPIP_Helper_CalcIPChecksum(pBDcpt->port2IfIx, sizeof(pBDcpt->port2IfIx), ~cfgHash);
+}
+
+// checksum of the snapshot data following the checksum field
+static uint16_t _MAC_Bridge_WarmChecksum(const MAC_BRIDGE_WARM_SNAPSHOT* pSnap)
+{
+    return TCPIP_Helper_CalcIPChecksum((const uint8_t*)&pSnap->cfgHash, sizeof(*pSnap) - offsetof(MAC_BRIDGE_WARM_SNAPSHOT, cfgHash), 0);
+}
+
+// claims the snapshot buffer
+// both the bridge task and the TCPIP_MAC_Bridge_WarmSnapshot() caller write it
+// returns false if the buffer is being written already
+static bool _MAC_Bridge_WarmClaim(MAC_BRIDGE_DCPT* pBDcpt)
+{
+    bool claimed;
+    OSAL_CRITSECT_DATA_TYPE critStat = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+
+    if(pBDcpt->warmSnapBusy != 0)
+    {
+        claimed = false;
+    }
+    else
+    {
+        pBDcpt->warmSnapBusy = 1;
+        claimed = true;
+    }
+
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, critStat);
+
+    return claimed;
+}
+
+static __inline__ void __attribute__((always_inline)) _MAC_Bridge_WarmRelease(MAC_BRIDGE_DCPT* pBDcpt)
+{
+    __sync_synchronize();
+    pBDcpt->warmSnapBusy = 0;
+}
+
+// takes a snapshot of the learnt FDB entries
+// the snapshot buffer should be claimed
+static void _MAC_Bridge_WarmSnapshot(MAC_BRIDGE_DCPT* pBDcpt)
+{
+    int ix;
+    MAC_BRIDGE_HASH_ENTRY* hE;
+    MAC_BRIDGE_WARM_SNAPSHOT* pSnap = &bridgeWarmSnap;
+    MAC_BRIDGE_WARM_ENTRY* pWarm = pSnap->entries;
+    int nEntries = TCPIP_OAHASH_EntryRange(pBDcpt->hashDcpt);
+    int maxWarm = sizeof(pSnap->entries) / sizeof(*pSnap->entries);
+    uint32_t currSec = _MAC_Bridge_GetSecond();
+
+    // invalidate first, a reset in the middle leaves nothing behind
+    pSnap->magic = 0;
+
+    for(ix = 0; ix < nEntries && pWarm < pSnap->entries + maxWarm; ix++)
+    {
+        hE = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryGet(pBDcpt->hashDcpt, ix);
+        if(hE == 0)
+        {   // resized meanwhile; the API caller retries
+            break;
+        }
+        if(hE->hEntry.flags.busy == 0 || (hE->hEntry.flags.value & (MAC_BRIDGE_HFLAG_STATIC | MAC_BRIDGE_HFLAG_PORT_VALID)) != MAC_BRIDGE_HFLAG_PORT_VALID)
+        {   // only valid learnt entries
+            continue;
+        }
+
+        uint32_t tLeft = hE->tExpire - currSec;
+        if((int32_t)tLeft <= 0 || tLeft > pBDcpt->purgeTmo)
+        {   // about to expire
+            continue;
+        }
+
+        memcpy(pWarm->destAdd.v, hE->destAdd.v, sizeof(pWarm->destAdd));
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+        pWarm->vlanId = hE->vlanId;
+#else
+        pWarm->vlanId = 0;
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+        pWarm->learnPort = hE->learnPort;
+        memset(pWarm->reserved, 0, sizeof(pWarm->reserved));
+        pWarm->age = pBDcpt->purgeTmo - tLeft;
+        pWarm++;
+    }
+
+    pSnap->nEntries = pWarm - pSnap->entries;
+    memset(pWarm, 0, (maxWarm - pSnap->nEntries) * sizeof(*pWarm));
+    pSnap->reserved = 0;
+    pSnap->cfgHash = _MAC_Bridge_WarmCfgHash(pBDcpt);
+    pSnap->checksum = _MAC_Bridge_WarmChecksum(pSnap);
+    pSnap->magic = MAC_BRIDGE_WARM_MAGIC;
+
+    pBDcpt->warmSnapSec = currSec;
+}
+
+// restores the learnt entries from the warm start snapshot
+// called at initialization, before the bridge is running
+// the restored entries are aged with the snapshot rate
+// and their lifetime is capped to TCPIP_MAC_BRIDGE_WARM_RESTORE_TMO:
+// a station that's gone is purged soon, a station still present gets refreshed by learning
+// returns the number of restored entries
+static int _MAC_Bridge_WarmRestore(MAC_BRIDGE_DCPT* pBDcpt)
+{
+    int ix;
+    MAC_BRIDGE_HASH_ENTRY* hE;
+    const MAC_BRIDGE_WARM_ENTRY* pWarm;
+    MAC_BRIDGE_WARM_SNAPSHOT* pSnap = &bridgeWarmSnap;
+    OA_HASH_DCPT* hashDcpt = pBDcpt->hashDcpt;
+    int nRestored = 0;
+
+    uint32_t currSec = _MAC_Bridge_UpdateSecond();
+    pBDcpt->warmSnapSec = currSec;
+
+    while(pSnap->magic == MAC_BRIDGE_WARM_MAGIC && (pBDcpt->bridgeFlags & TCPIP_MAC_BRIDGE_FLAG_NO_DYNAMIC_LEARN) == 0)
+    {
+        if(pSnap->nEntries > sizeof(pSnap->entries) / sizeof(*pSnap->entries) || pSnap->checksum != _MAC_Bridge_WarmChecksum(pSnap))
+        {   // corrupted
+            break;
+        }
+
+        if(pSnap->cfgHash != _MAC_Bridge_WarmCfgHash(pBDcpt))
+        {   // different configuration
+            break;
+        }
+
+        for(ix = 0, pWarm = pSnap->entries; ix < pSnap->nEntries; ix++, pWarm++)
+        {
+            if(hashDcpt->fullSlots + pBDcpt->nPorts >= hashDcpt->hEntries - 1)
+            {   // leave room for the host entries; a full hash would try to purge
+                break;
+            }
+
+            uint32_t age = pWarm->age + TCPIP_MAC_BRIDGE_WARM_SNAPSHOT_RATE;
+            if(age >= pBDcpt->purgeTmo || pWarm->learnPort >= pBDcpt->nPorts || TCPIP_Helper_IsMcastMACAddress(&pWarm->destAdd))
+            {   // expired or invalid
+                continue;
+            }
+
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+            if(pWarm->vlanId != 0 && _MAC_Bridge_VlanFind(pBDcpt, pWarm->vlanId) == 0)
+            {   // VLAN no longer configured
+                continue;
+            }
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+
+            hE = _MAC_Bridge_FDBInsert(pBDcpt, &pWarm->destAdd, pWarm->vlanId);
+            if(hE == 0 || hE->hEntry.flags.newEntry == 0)
+            {   // permanent entries take precedence
+                continue;
+            }
+
+            uint32_t tLeft = pBDcpt->purgeTmo - age;
+            if(tLeft > TCPIP_MAC_BRIDGE_WARM_RESTORE_TMO)
+            {
+                tLeft = TCPIP_MAC_BRIDGE_WARM_RESTORE_TMO;
+            }
+
+            hE->hEntry.flags.value &= ~MAC_BRIDGE_HFLAG_MASK;
+            hE->hEntry.flags.value |= MAC_BRIDGE_HFLAG_PORT_VALID;
+            hE->learnPort = pWarm->learnPort;
+            hE->tExpire = currSec + tLeft;
+            hE->fwdPackets = 0;
+            nRestored++;
+        }
+
+        break;
+    }
+
+    // the snapshot stays valid until the next one is taken
+    // a reset before that restores the same entries, aged again
+    return nRestored;
+}
+
+#endif  // (_TCPIP_MAC_BRIDGE_WARM_START != 0) 
+
 // clear/empty the forwarding map
 static __inline__ void __attribute__((always_inline))  _MAC_Bridge_ClearMap(MAC_BRIDGE_FWD_DCPT* pFDcpt)
 {
@@ -376,6 +696,119 @@ static __inline__ MAC_BRIDGE_DCPT* __attribute__((always_inline)) _MAC_Bridge_Va
     return ((MAC_BRIDGE_DCPT*)brHandle ==  gBridgeDcpt) ? (MAC_BRIDGE_DCPT*)brHandle : 0;
 }
 
+#if (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+// returns true if the RSTP state of the port allows learning
+static __inline__ bool __attribute__((always_inline)) _MAC_Bridge_RstpPortLearns(MAC_BRIDGE_DCPT* pDcpt, int port)
+{
+    return (pDcpt->rstpLearnMap & (1ul << port)) != 0;
+}
+#else
+#define _MAC_Bridge_RstpPortLearns(pDcpt, port)    (true)
+#endif  // (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+
+#if (_TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0) && (TCPIP_MAC_BRIDGE_MOVE_PORT_HOLD_TIME != 0)
+// returns true if the learning is not blocked on the port by a flapping address
+static __inline__ bool __attribute__((always_inline)) _MAC_Bridge_MovePortLearns(MAC_BRIDGE_DCPT* pDcpt, int port)
+{
+    return pDcpt->moveHoldSec[port] == 0 || (int32_t)(pDcpt->moveHoldSec[port] - _MAC_Bridge_GetSecond()) <= 0;
+}
+#else
+#define _MAC_Bridge_MovePortLearns(pDcpt, port)    (true)
+#endif  // (_TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0) && (TCPIP_MAC_BRIDGE_MOVE_PORT_HOLD_TIME != 0)
+
+#if (_TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+// per FDB entry traffic accounting; single word updates, not bracketed
+static __inline__ void __attribute__((always_inline)) _MAC_Bridge_EntryCountRx(MAC_BRIDGE_HASH_ENTRY* hE, uint16_t pktLen)
+{
+    if(hE != 0)
+    {
+        hE->rxPackets++;
+        hE->rxBytes += pktLen;
+    }
+}
+
+static __inline__ void __attribute__((always_inline)) _MAC_Bridge_EntryCountTx(MAC_BRIDGE_HASH_ENTRY* hE, uint16_t pktLen)
+{
+    hE->txBytes += pktLen;
+}
+#else
+#define _MAC_Bridge_EntryCountRx(hE, pktLen)
+#define _MAC_Bridge_EntryCountTx(hE, pktLen)
+#endif  // (_TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+
+// FDB sequence lock
+// the FDB readers (management, console) do not take the bridgeLock
+// so that they never make the packet processing fail the lock.
+// A writer brackets any FDB update that changes more than one word of an entry
+// (insertion, removal, port change, static entry changes);
+// a reader copies the data and retries if the sequence count changed meanwhile.
+// Single word updates (tExpire refresh, fwdPackets) are not bracketed.
+// The sequence count cannot protect a table freed by a resize:
+// a reader is counted between _MAC_Bridge_FDBReadBegin() and _MAC_Bridge_FDBReadValid()
+// and the bridge task frees the retired table only when there's none.
+static __inline__ void __attribute__((always_inline)) _MAC_Bridge_FDBWriteBegin(MAC_BRIDGE_DCPT* pDcpt)
+{
+    pDcpt->fdbSeq++;
+    __sync_synchronize();
+}
+
+static __inline__ void __attribute__((always_inline)) _MAC_Bridge_FDBWriteEnd(MAC_BRIDGE_DCPT* pDcpt)
+{
+    __sync_synchronize();
+    pDcpt->fdbSeq++;
+}
+
+#if (_TCPIP_MAC_BRIDGE_FDB_RESIZE != 0)
+static void _MAC_Bridge_FDBReaders(MAC_BRIDGE_DCPT* pDcpt, int delta)
+{
+    OSAL_CRITSECT_DATA_TYPE critStat = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+    pDcpt->fdbReaders += delta;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, critStat);
+}
+#else
+#define _MAC_Bridge_FDBReaders(pDcpt, delta)
+#endif  // (_TCPIP_MAC_BRIDGE_FDB_RESIZE != 0)
+
+static __inline__ uint32_t __attribute__((always_inline)) _MAC_Bridge_FDBReadBegin(MAC_BRIDGE_DCPT* pDcpt)
+{
+    _MAC_Bridge_FDBReaders(pDcpt, 1);
+    uint32_t seq = pDcpt->fdbSeq;
+    __sync_synchronize();
+    return seq;
+}
+
+// ends the read started by _MAC_Bridge_FDBReadBegin()
+// returns true if the data read meanwhile is consistent
+static __inline__ bool __attribute__((always_inline)) _MAC_Bridge_FDBReadValid(MAC_BRIDGE_DCPT* pDcpt, uint32_t seq)
+{
+    __sync_synchronize();
+    bool valid = (seq & 1) == 0 && pDcpt->fdbSeq == seq;
+    _MAC_Bridge_FDBReaders(pDcpt, -1);
+    return valid;
+}
+
+#if (_TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+// clears the traffic counters of all the FDB entries
+// requested by TCPIP_MAC_Bridge_FDBCountersReset(), done by the bridge task
+static void _MAC_Bridge_EntryCountersClear(MAC_BRIDGE_DCPT* pBDcpt)
+{
+    OA_HASH_ITERATOR hIter;
+    MAC_BRIDGE_HASH_ENTRY* hE;
+
+    pBDcpt->countersReset = 0;
+    _MAC_Bridge_FDBWriteBegin(pBDcpt);
+    TCPIP_OAHASH_IteratorInit(pBDcpt->hashDcpt, &hIter);
+    while((hE = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_IteratorNext(pBDcpt->hashDcpt, &hIter)) != 0)
+    {
+        hE->fwdPackets = 0;
+        hE->txBytes = 0;
+        hE->rxPackets = 0;
+        hE->rxBytes = 0;
+    }
+    _MAC_Bridge_FDBWriteEnd(pBDcpt);
+}
+#endif  // (_TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+
 // sets the flags of the packet
 // since this is either the bridge copy or the host does not process it
 // we use the pktClientData16[0] for flags
@@ -479,10 +912,35 @@ bool TCPIP_MAC_Bridge_Initialize(const TCPIP_STACK_MODULE_CTRL* const stackCtrl,
 
         bridgeDcpt.nPorts = nPorts;
 
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+        TCPIP_MAC_BRIDGE_RESULT resVlan = _MAC_Bridge_SetVlans(&bridgeDcpt, pBConfig);
+        if(resVlan != TCPIP_MAC_BRIDGE_RES_OK)
+        {   // failed, wrong VLAN configuration
+            _Mac_Bridge_InitCond(0, resVlan);
+            return false;
+        }
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+        _MAC_Bridge_RstpInit(&bridgeDcpt);
+        _MAC_Bridge_LearnInit(&bridgeDcpt);
+
         // create the FDB
         bridgeDcpt.memH = stackCtrl->memH;
-        size_t hashMemSize = sizeof(OA_HASH_DCPT) + pBConfig->fdbEntries * sizeof(MAC_BRIDGE_HASH_ENTRY);
+        // the Robin Hood hash keeps a bucket empty
+        size_t hashEntries = pBConfig->fdbEntries + 1;
+#if (_TCPIP_MAC_BRIDGE_FDB_RESIZE != 0)
+        // the table is replaced when resizing, allocate it separately
+        OA_HASH_DCPT* hashDcpt = (OA_HASH_DCPT*)TCPIP_HEAP_Malloc(bridgeDcpt.memH, sizeof(OA_HASH_DCPT));
+        void* hashMem = hashDcpt != 0 ? _MAC_BridgeHashAlloc(hashDcpt, hashEntries * sizeof(MAC_BRIDGE_HASH_ENTRY)) : 0;
+        if(hashDcpt != 0 && hashMem == 0)
+        {
+            TCPIP_HEAP_Free(bridgeDcpt.memH, hashDcpt);
+            hashDcpt = 0;
+        }
+#else
+        size_t hashMemSize = sizeof(OA_HASH_DCPT) + hashEntries * sizeof(MAC_BRIDGE_HASH_ENTRY);
         OA_HASH_DCPT* hashDcpt = (OA_HASH_DCPT*)TCPIP_HEAP_Malloc(bridgeDcpt.memH, hashMemSize);
+        void* hashMem = hashDcpt + 1;
+#endif  // (_TCPIP_MAC_BRIDGE_FDB_RESIZE != 0)
 
         if(hashDcpt == 0)
         {   // failed
@@ -491,16 +949,28 @@ bool TCPIP_MAC_Bridge_Initialize(const TCPIP_STACK_MODULE_CTRL* const stackCtrl,
         }
 
         // populate the entries
-        hashDcpt->memBlk = hashDcpt + 1;
+        hashDcpt->memBlk = hashMem;
         hashDcpt->hParam = 0;
         hashDcpt->hEntrySize = sizeof(MAC_BRIDGE_HASH_ENTRY);
-        hashDcpt->hEntries = pBConfig->fdbEntries;
+        hashDcpt->hEntries = hashEntries;
+        hashDcpt->minEntries = hashEntries;
         hashDcpt->probeStep = MAC_BRIDGE_HASH_PROBE_STEP;
+        // the FDB entries hold no references and are looked up on every packet
+        hashDcpt->hFlags = OA_HASH_FLAG_ROBIN_HOOD;
 
         hashDcpt->hashF = _MAC_BridgeHashKeyHash;
         hashDcpt->delF = _MAC_BridgeHashEntryDelete;
         hashDcpt->cmpF = _MAC_BridgeHashKeyCompare;
         hashDcpt->cpyF = _MAC_BridgeHashKeyCopy; 
+#if (_TCPIP_MAC_BRIDGE_FDB_RESIZE != 0)
+        hashDcpt->hFlags |= OA_HASH_FLAG_RESIZE;
+        hashDcpt->keyF = _MAC_BridgeHashEntryKey;
+        hashDcpt->allocF = _MAC_BridgeHashAlloc;
+        hashDcpt->freeF = _MAC_BridgeHashFree;
+        hashDcpt->maxEntries = TCPIP_MAC_BRIDGE_FDB_MAX_ENTRIES + 1 > hashEntries ? TCPIP_MAC_BRIDGE_FDB_MAX_ENTRIES + 1 : hashEntries;
+        hashDcpt->growLoad = TCPIP_MAC_BRIDGE_FDB_GROW_LOAD;
+        hashDcpt->shrinkLoad = TCPIP_MAC_BRIDGE_FDB_SHRINK_LOAD;
+#endif  // (_TCPIP_MAC_BRIDGE_FDB_RESIZE != 0)
         TCPIP_OAHASH_Initialize(hashDcpt);
 
         bridgeDcpt.hashDcpt = hashDcpt;
@@ -528,6 +998,22 @@ bool TCPIP_MAC_Bridge_Initialize(const TCPIP_STACK_MODULE_CTRL* const stackCtrl,
         bridgeDcpt.dcptReplenish = pBConfig->dcptReplenish;
         bridgeDcpt.bridgeFlags = pBConfig->bridgeFlags;
 
+#if (_TCPIP_MAC_BRIDGE_ACL != 0)
+        MAC_BRIDGE_ACL* pAcl;
+        TCPIP_MAC_BRIDGE_RESULT resAcl = _MAC_Bridge_AclCompile(&bridgeDcpt, pBConfig->aclTable, pBConfig->aclTableSize, &pAcl);
+        if(resAcl != TCPIP_MAC_BRIDGE_RES_OK) 
+        {   // failed, wrong ACL rules
+            _Mac_Bridge_InitCond(0, resAcl);
+            _MAC_Bridge_Cleanup();
+            return false;
+        }
+        bridgeDcpt.pAcl = pAcl;
+#endif  // (_TCPIP_MAC_BRIDGE_ACL != 0)
+
+        // re-populate the FDB with what was learnt before a soft reset
+        // the host entries are not set yet, and there's no gBridgeDcpt for purging the hash
+        _MAC_Bridge_WarmRestore(&bridgeDcpt);
+
         TCPIP_Helper_SingleListInitialize(&bridgeDcpt.pktPool);
         TCPIP_Helper_SingleListInitialize(&bridgeDcpt.dcptPool);
 
@@ -558,7 +1044,8 @@ bool TCPIP_MAC_Bridge_Initialize(const TCPIP_STACK_MODULE_CTRL* const stackCtrl,
 #if (_TCPIP_MAC_BRIDGE_STATISTICS != 0)
         bridgeDcpt.stat.dcptPoolLowSize = pBConfig->dcptPoolSize; 
 #endif   
-        bridgeDcpt.tmrSigHandle =_TCPIPStackSignalHandlerRegister(TCPIP_THIS_MODULE_ID, TCPIP_MAC_Bridge_Task, TCPIP_MAC_BRIDGE_TASK_RATE);
+        // run faster until the bridge ports are up; the regular rate is set when the bridge is ready
+        bridgeDcpt.tmrSigHandle =_TCPIPStackSignalHandlerRegister(TCPIP_THIS_MODULE_ID, TCPIP_MAC_Bridge_Task, MAC_BRIDGE_BOOT_TASK_RATE);
         if(bridgeDcpt.tmrSigHandle == 0)
         {
             _Mac_Bridge_InitCond(0, TCPIP_MAC_BRIDGE_RES_SIGNAL_ERROR);
@@ -567,6 +1054,7 @@ bool TCPIP_MAC_Bridge_Initialize(const TCPIP_STACK_MODULE_CTRL* const stackCtrl,
         }
         
         bridgeDcpt.status = SYS_STATUS_BUSY;    // waiting to complete the initialization
+        _MAC_Bridge_BootStampSet(&bridgeDcpt, bridgeInit);
         gBridgeDcpt = &bridgeDcpt;
 
         break;
@@ -616,19 +1104,42 @@ void TCPIP_MAC_Bridge_Deinitialize(const TCPIP_STACK_MODULE_CTRL* const stackCtr
 
 static void _MAC_Bridge_Cleanup(void)
 {
+#if (_TCPIP_MAC_BRIDGE_TX_BACKLOG != 0)
+    int portIx;
+    TCPIP_MAC_PACKET* pQPkt;
+    for(portIx = 0; portIx < TCPIP_MAC_BRIDGE_MAX_PORTS_NO; portIx++)
+    {   // release the held frames to their owners/pools
+        while((pQPkt = (TCPIP_MAC_PACKET*)TCPIP_Helper_SingleListHeadRemove(bridgeDcpt.txBacklog + portIx)) != 0)
+        {
+            _MAC_Bridge_ClearMap(_MAC_Bridge_GetPktFwdDcpt(pQPkt));
+            _MAC_Bridge_ForwardPacket(pQPkt, 0);
+        }
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_TX_BACKLOG != 0)
+
     if(bridgeDcpt.tmrSigHandle != 0)
     {
         _TCPIPStackSignalHandlerDeregister(bridgeDcpt.tmrSigHandle);
         bridgeDcpt.tmrSigHandle = 0;
     }
 
+    // no more frames in transit: the FDB tables can go right away
+    gBridgeDcpt = 0;
     if(bridgeDcpt.hashDcpt != 0)
     {
         TCPIP_OAHASH_EntriesRemoveAll(bridgeDcpt.hashDcpt);
+        TCPIP_OAHASH_Deinitialize(bridgeDcpt.hashDcpt);
 
         TCPIP_HEAP_Free(bridgeDcpt.memH, bridgeDcpt.hashDcpt);
         bridgeDcpt.hashDcpt = 0;
     }
+#if (_TCPIP_MAC_BRIDGE_FDB_RESIZE != 0)
+    if(bridgeDcpt.pFdbRetired != 0)
+    {
+        TCPIP_HEAP_Free(bridgeDcpt.memH, bridgeDcpt.pFdbRetired);
+        bridgeDcpt.pFdbRetired = 0;
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_FDB_RESIZE != 0)
 
     TCPIP_MAC_PACKET* pBPkt;
     while( (pBPkt = (TCPIP_MAC_PACKET*)TCPIP_Helper_SingleListHeadRemove(&bridgeDcpt.pktPool)) != 0)
@@ -642,7 +1153,19 @@ static void _MAC_Bridge_Cleanup(void)
         TCPIP_HEAP_Free(bridgeDcpt.memH, pFwdDcpt);
     }
 
-    gBridgeDcpt = 0;
+#if (_TCPIP_MAC_BRIDGE_ACL != 0)
+    if(bridgeDcpt.pAcl != 0)
+    {
+        TCPIP_HEAP_Free(bridgeDcpt.memH, bridgeDcpt.pAcl);
+        bridgeDcpt.pAcl = 0;
+    }
+    if(bridgeDcpt.pAclRetired != 0)
+    {
+        TCPIP_HEAP_Free(bridgeDcpt.memH, bridgeDcpt.pAclRetired);
+        bridgeDcpt.pAclRetired = 0;
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_ACL != 0)
+
     bridgeInitCount = 0;
 
 }
@@ -736,37 +1259,93 @@ TCPIP_MAC_BRIDGE_PKT_RES TCPIP_MAC_Bridge_ProcessPacket(TCPIP_MAC_PACKET* pRxPkt
 
     uint8_t inPort = _TCPIPStack_BridgeGetIfPort(pInIf);
     _MAC_Bridge_StatPortUpdate(gBridgeDcpt, inPort, MAC_BRIDGE_STAT_TYPE_RX_PKTS, 1);
+    _MAC_Bridge_BootStampPortSet(gBridgeDcpt, portRx, inPort);
     _MAC_Bridge_TracePkt(pRxPkt, inPort, false);
 
+#if (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+    if(memcmp(((TCPIP_MAC_ETHERNET_HEADER*)pRxPkt->pMacLayer)->DestMACAddr.v, bridge_reserved_address, sizeof(bridge_reserved_address)) == 0)
+    {   // BPDU: consumed by the spanning tree, untagged, never learnt or relayed
+        _MAC_Bridge_RstpRxBpdu(gBridgeDcpt, pRxPkt, inPort);
+#if (_TCPIP_MAC_BRIDGE_DYNAMIC_FDB_ACCESS != 0)
+        _MAC_Bridge_FDBUnlock(gBridgeDcpt);
+#endif // (_TCPIP_MAC_BRIDGE_DYNAMIC_FDB_ACCESS != 0)
+        TCPIP_PKT_PacketAcknowledge(pRxPkt, TCPIP_MAC_PKT_ACK_BRIDGE_DONE); 
+        return TCPIP_MAC_BRIDGE_PKT_RES_BRIDGE_PROCESS;
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+    // VLAN classification, before learning: the FDB is keyed by (MAC, VLAN)
+    const MAC_BRIDGE_VLAN_DCPT* pVlan = 0;
+    uint16_t vlanId = 0;
+    if(gBridgeDcpt->nVlans != 0)
+    {
+        pVlan = _MAC_Bridge_VlanIngress(gBridgeDcpt, pRxPkt, inPort, &fwdDcpt);
+        if(pVlan == 0)
+        {   // ingress filtering: no VLAN or the port is not a member
+            _MAC_Bridge_StatPortUpdate(gBridgeDcpt, inPort, MAC_BRIDGE_STAT_TYPE_VLAN_DISCARD_PKTS, 1);
+#if (_TCPIP_MAC_BRIDGE_DYNAMIC_FDB_ACCESS != 0)
+            _MAC_Bridge_FDBUnlock(gBridgeDcpt);
+#endif // (_TCPIP_MAC_BRIDGE_DYNAMIC_FDB_ACCESS != 0)
+            TCPIP_PKT_PacketAcknowledge(pRxPkt, TCPIP_MAC_PKT_ACK_BRIDGE_DISCARD); 
+            return TCPIP_MAC_BRIDGE_PKT_RES_BRIDGE_DISCARD;
+        }
+        vlanId = pVlan->vlanId;
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+
+    if(!_MAC_Bridge_AclCheck(gBridgeDcpt, pRxPkt, inPort))
+    {   // unwanted traffic class: dropped before learning and any processing
+        _MAC_Bridge_StatPortUpdate(gBridgeDcpt, inPort, MAC_BRIDGE_STAT_TYPE_ACL_DROP_PKTS, 1);
+#if (_TCPIP_MAC_BRIDGE_DYNAMIC_FDB_ACCESS != 0)
+        _MAC_Bridge_FDBUnlock(gBridgeDcpt);
+#endif // (_TCPIP_MAC_BRIDGE_DYNAMIC_FDB_ACCESS != 0)
+        TCPIP_PKT_PacketAcknowledge(pRxPkt, TCPIP_MAC_PKT_ACK_BRIDGE_DISCARD); 
+        return TCPIP_MAC_BRIDGE_PKT_RES_BRIDGE_DISCARD;
+    }
+
     // learn
     TCPIP_MAC_ETHERNET_HEADER*  pMacHdr = (TCPIP_MAC_ETHERNET_HEADER*)pRxPkt->pMacLayer;
+    MAC_BRIDGE_LEARN_RES learnRes = MAC_BRIDGE_LEARN_RES_ALLOW;
     heSrc = 0;
-    if(!TCPIP_Helper_IsMcastMACAddress(&pMacHdr->SourceMACAddr))
+    if(!TCPIP_Helper_IsMcastMACAddress(&pMacHdr->SourceMACAddr) && _MAC_Bridge_RstpPortLearns(gBridgeDcpt, inPort) && _MAC_Bridge_MovePortLearns(gBridgeDcpt, inPort))
     {   // we shouldn't learn multicast addresses
+        // or on a port that's discarding or held down by a flapping address
         // update destination in the FDB
         _MAC_Bridge_CheckFDB(gBridgeDcpt);
         brEvent = TCPIP_MAC_BRIDGE_EVENT_NONE;
-        if((gBridgeDcpt->bridgeFlags & TCPIP_MAC_BRIDGE_FLAG_NO_DYNAMIC_LEARN) != 0)
-        {
-            heSrc = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryLookup(gBridgeDcpt->hashDcpt, pMacHdr->SourceMACAddr.v);
+        heSrc = _MAC_Bridge_FDBLookup(gBridgeDcpt, &pMacHdr->SourceMACAddr, vlanId);
+        if(heSrc != 0 && heSrc->learnPort == inPort && (heSrc->hEntry.flags.value & MAC_BRIDGE_HFLAG_PORT_VALID) != 0)
+        {   // known station, same port: just refresh it
+            heSrc->tExpire = _MAC_Bridge_GetSecond() + gBridgeDcpt->purgeTmo;
         }
         else
-        {
-            heSrc = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryLookupOrInsert(gBridgeDcpt->hashDcpt, pMacHdr->SourceMACAddr.v);
-            if(heSrc == 0)
+        {   // new station or moved
+            _MAC_Bridge_FDBWriteBegin(gBridgeDcpt);
+            if(heSrc == 0 && (gBridgeDcpt->bridgeFlags & TCPIP_MAC_BRIDGE_FLAG_NO_DYNAMIC_LEARN) == 0)
             {
-                brEvent = TCPIP_MAC_BRIDGE_EVENT_FDB_FULL;
-                _MAC_Bridge_StatUpdate(gBridgeDcpt, MAC_BRIDGE_STAT_TYPE_FDB_FULL, 1);
+                learnRes = _MAC_Bridge_LearnCheck(gBridgeDcpt, inPort, &brEvent);
+                if(learnRes == MAC_BRIDGE_LEARN_RES_ALLOW)
+                {
+                    heSrc = _MAC_Bridge_FDBInsert(gBridgeDcpt, &pMacHdr->SourceMACAddr, vlanId);
+                    if(heSrc == 0)
+                    {
+                        brEvent = TCPIP_MAC_BRIDGE_EVENT_FDB_FULL;
+                        _MAC_Bridge_StatUpdate(gBridgeDcpt, MAC_BRIDGE_STAT_TYPE_FDB_FULL, 1);
+                    }
+                }
             }
-        }
 
-        if(heSrc != 0)
-        {   // (new) dynamic/learnt entry needs to be updated
-            _MAC_Bridge_SetHashDynamicEntry(heSrc, inPort, MAC_BRIDGE_HFLAG_NONE, MAC_BRIDGE_HFLAG_PORT_VALID); 
-            if(heSrc->hEntry.flags.newEntry != 0)
-            {
-                brEvent = TCPIP_MAC_BRIDGE_EVENT_ENTRY_ADDED;
+            if(heSrc != 0 && _MAC_Bridge_MoveCheck(gBridgeDcpt, heSrc, inPort, &brEvent))
+            {   // (new) dynamic/learnt entry needs to be updated
+                _MAC_Bridge_LearnCount(gBridgeDcpt, heSrc, inPort);
+                _MAC_Bridge_SetHashDynamicEntry(heSrc, inPort, MAC_BRIDGE_HFLAG_NONE, MAC_BRIDGE_HFLAG_PORT_VALID); 
+                if(heSrc->hEntry.flags.newEntry != 0)
+                {
+                    brEvent = TCPIP_MAC_BRIDGE_EVENT_ENTRY_ADDED;
+                }
             }
+            _MAC_Bridge_FDBWriteEnd(gBridgeDcpt);
         }
 
         if(brEvent != TCPIP_MAC_BRIDGE_EVENT_NONE)
@@ -776,6 +1355,16 @@ TCPIP_MAC_BRIDGE_PKT_RES TCPIP_MAC_Bridge_ProcessPacket(TCPIP_MAC_PACKET* pRxPkt
         _MAC_Bridge_CheckFDB(gBridgeDcpt);
     }
 
+    if(learnRes == MAC_BRIDGE_LEARN_RES_DROP)
+    {   // unknown source on a port over its learning limits
+        _MAC_Bridge_StatPortUpdate(gBridgeDcpt, inPort, MAC_BRIDGE_STAT_TYPE_LEARN_DROP_PKTS, 1);
+#if (_TCPIP_MAC_BRIDGE_DYNAMIC_FDB_ACCESS != 0)
+        _MAC_Bridge_FDBUnlock(gBridgeDcpt);
+#endif // (_TCPIP_MAC_BRIDGE_DYNAMIC_FDB_ACCESS != 0)
+        TCPIP_PKT_PacketAcknowledge(pRxPkt, TCPIP_MAC_PKT_ACK_BRIDGE_DISCARD); 
+        return TCPIP_MAC_BRIDGE_PKT_RES_BRIDGE_DISCARD;
+    }
+
     // check if destination is a reserved address
     // IEEE 802.1D-2004 - 7.12.6:
     //      Frames containing any of the group MAC Addresses specified in Table 7-10
@@ -803,21 +1392,26 @@ TCPIP_MAC_BRIDGE_PKT_RES TCPIP_MAC_Bridge_ProcessPacket(TCPIP_MAC_PACKET* pRxPkt
     // forward
     fwdDcpt.tReceive = _MAC_Bridge_GetSecond();
     fwdDcpt.pktLen = TCPIP_PKT_PayloadLen(pRxPkt);
-    
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+    if((fwdDcpt.fwdFlags & MAC_BRIDGE_FWD_FLAG_TAGGED) != 0)
+    {   // the MTU check and the copy use the untagged length
+        fwdDcpt.pktLen -= MAC_BRIDGE_VLAN_TAG_SIZE;
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+    _MAC_Bridge_EntryCountRx(heSrc, fwdDcpt.pktLen);
 
     // check destination is in the FDB
     _MAC_Bridge_CheckFDB(gBridgeDcpt);
-    heDest = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryLookup(gBridgeDcpt->hashDcpt, pMacHdr->DestMACAddr.v);
+    heDest = _MAC_Bridge_FDBLookup(gBridgeDcpt, &pMacHdr->DestMACAddr, vlanId);
 
     if(TCPIP_Helper_IsMcastMACAddress(&pMacHdr->DestMACAddr))
     {
         _Mac_Bridge_AssertCond(heDest == 0 || (heDest->hEntry.flags.value & (MAC_BRIDGE_HFLAG_STATIC | MAC_BRIDGE_HFLAG_HOST)) == MAC_BRIDGE_HFLAG_STATIC, __func__, __LINE__);
-        fwdDcpt.fwdFlags = MAC_BRIDGE_FWD_FLAG_MCAST;
+        fwdDcpt.fwdFlags |= MAC_BRIDGE_FWD_FLAG_MCAST;
         _MAC_Bridge_StatPortUpdate(gBridgeDcpt, inPort, MAC_BRIDGE_STAT_TYPE_RX_DEST_MCAST, 1);
     }
     else
     {
-        fwdDcpt.fwdFlags = MAC_BRIDGE_FWD_FLAG_NONE;
         _MAC_Bridge_StatPortUpdate(gBridgeDcpt, inPort, (heDest == 0 || (heDest->hEntry.flags.value & MAC_BRIDGE_HFLAG_HOST) == 0) ? MAC_BRIDGE_STAT_TYPE_RX_DEST_NOT_ME_UCAST : MAC_BRIDGE_STAT_TYPE_RX_DEST_ME_UCAST, 1);
     } 
 
@@ -829,6 +1423,19 @@ TCPIP_MAC_BRIDGE_PKT_RES TCPIP_MAC_Bridge_ProcessPacket(TCPIP_MAC_PACKET* pRxPkt
         _MAC_Bridge_SetPacketForward(gBridgeDcpt, heDest, inPort, &fwdDcpt);
     }
 
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+    if(pVlan != 0)
+    {   // flood/forward only to the VLAN member ports
+        // the host processes only the untagged frames, these belong to the port PVID
+        uint32_t vlanMap = pVlan->memberMap & ~(1ul << inPort);
+        if((fwdDcpt.fwdFlags & MAC_BRIDGE_FWD_FLAG_TAGGED) == 0)
+        {
+            vlanMap |= 1ul << inPort;
+        }
+        fwdDcpt.fwdMap32 &= vlanMap;
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+
     if(!_MAC_Bridge_IsMapEmpty(&fwdDcpt))
     {   // check if the host processes this packet
         if(_MAC_Bridge_IsPortMapped(inPort, &fwdDcpt))
@@ -841,15 +1448,37 @@ TCPIP_MAC_BRIDGE_PKT_RES TCPIP_MAC_Bridge_ProcessPacket(TCPIP_MAC_PACKET* pRxPkt
     if(!_MAC_Bridge_IsMapEmpty(&fwdDcpt))
     {   // packet must be forwarded on some ports 
 
+        pFwdPkt = 0;
         pFwdDcpt = _MAC_Bridge_GetFwdDcpt(gBridgeDcpt);
         if(pFwdDcpt != 0)
         {   // have valid descriptor
-            if(pktRes == TCPIP_MAC_BRIDGE_PKT_RES_HOST_PROCESS)
+            bool needCopy = pktRes == TCPIP_MAC_BRIDGE_PKT_RES_HOST_PROCESS;
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+            if(pVlan != 0)
+            {   // a tag cannot be inserted in the received packet
+                needCopy = needCopy || _MAC_Bridge_VlanNeedsCopy(&fwdDcpt);
+            }
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+
+            if(needCopy)
             {   // host needs to process this packet; we need a copy
-                pFwdPkt = _MAC_Bridge_GetFwdPkt(gBridgeDcpt, fwdDcpt.pktLen);
-                if(pFwdPkt != 0)
-                {   // ok, we can flood/forward
-                    _MAC_Bridge_PacketCopy(pRxPkt, pFwdPkt, fwdDcpt.pktLen, heDest);
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+                if(pVlan != 0)
+                {   // the VLAN copy is built tagged
+                    pFwdPkt = _MAC_Bridge_GetFwdPkt(gBridgeDcpt, fwdDcpt.pktLen + MAC_BRIDGE_VLAN_TAG_SIZE);
+                    if(pFwdPkt != 0)
+                    {
+                        _MAC_Bridge_VlanPacketCopy(pRxPkt, pFwdPkt, &fwdDcpt);
+                    }
+                }
+                else
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+                {
+                    pFwdPkt = _MAC_Bridge_GetFwdPkt(gBridgeDcpt, fwdDcpt.pktLen);
+                    if(pFwdPkt != 0)
+                    {   // ok, we can flood/forward
+                        _MAC_Bridge_PacketCopy(pRxPkt, pFwdPkt, fwdDcpt.pktLen, heDest);
+                    }
                 }
             }
             else
@@ -867,12 +1496,26 @@ TCPIP_MAC_BRIDGE_PKT_RES TCPIP_MAC_Bridge_ProcessPacket(TCPIP_MAC_PACKET* pRxPkt
                 _MAC_Bridge_StorePktFwdDcpt(pFwdPkt, pFwdDcpt);
 
                 pFwdPkt->ackFunc = _MAC_Bridge_PacketAck; 
-                pFwdPkt->ackParam = heDest; 
+                pFwdPkt->ackParam = 0;  // no FDB entry pointer across the async TX: the table can move/resize
                 // adjust: the source packet comes from the MAC driver with segLen adjusted
                 pFwdPkt->pDSeg->segLen += sizeof(TCPIP_MAC_ETHERNET_HEADER);
 
                 _MAC_Bridge_ForwardPacket(pFwdPkt, heDest);
             }
+            else
+            {   // could not get a packet; the descriptor is not used
+                TCPIP_Helper_SingleListTailAdd(&gBridgeDcpt->dcptPool, (SGL_LIST_NODE*)pFwdDcpt); 
+            }
+        }
+
+        if(pktRes != TCPIP_MAC_BRIDGE_PKT_RES_HOST_PROCESS && pFwdPkt != pRxPkt)
+        {   // the host does not process it and the received packet was not forwarded directly
+            // it was either copied or dropped; done with it
+            TCPIP_PKT_PacketAcknowledge(pRxPkt, pFwdPkt != 0 ? TCPIP_MAC_PKT_ACK_BRIDGE_DONE : TCPIP_MAC_PKT_ACK_BRIDGE_DISCARD); 
+            if(pFwdPkt == 0)
+            {
+                pktRes = TCPIP_MAC_BRIDGE_PKT_RES_BRIDGE_DISCARD;
+            }
         }
     }
     else
@@ -903,29 +1546,20 @@ void TCPIP_MAC_Bridge_Task(void)
 
     if(gBridgeDcpt->status == SYS_STATUS_BUSY)
     {   // try to complete the initialization
-        // get the stack handle; it should be running
-        SYS_MODULE_OBJ stackObj = TCPIP_STACK_Initialize(0, 0);
-        SYS_STATUS stackStat = TCPIP_STACK_Status(stackObj);
-        if(stackStat < 0)
-        {   // some error has occurred
-            gBridgeDcpt->status = SYS_STATUS_ERROR;
-            return;
-        }
-        else if(stackStat != SYS_STATUS_READY)
-        {   // wait some more
-           return;
-        }
-
-        // proceed with the initialization
-        TCPIP_MAC_BRIDGE_RESULT resHost = _MAC_Bridge_SetHostEntries(gBridgeDcpt);
-        if(resHost != TCPIP_MAC_BRIDGE_RES_OK)
-        {   // some error has occurred
-            gBridgeDcpt->status = SYS_STATUS_ERROR;
-            return;
+        if(!_MAC_Bridge_CompleteInit(gBridgeDcpt))
+        {   // wait some more or failed
+#if (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+            // while waiting, the ports that are up already run the spanning tree
+            if(gBridgeDcpt->status != SYS_STATUS_BUSY)
+#endif  // (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+            {
+                return;
+            }
         }
-
-        // all good
-        gBridgeDcpt->status = SYS_STATUS_READY;
+    }
+    else
+    {
+        _MAC_Bridge_BootCheck(gBridgeDcpt);
     }
 
     uint32_t currSec = _MAC_Bridge_UpdateSecond();
@@ -941,32 +1575,181 @@ void TCPIP_MAC_Bridge_Task(void)
     }
 #endif  // (_TCPIP_MAC_BRIDGE_DYNAMIC_FDB_ACCESS != 0)
 
+#if (_TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+    if(gBridgeDcpt->countersReset != 0)
+    {
+        _MAC_Bridge_EntryCountersClear(gBridgeDcpt);
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+
     // traverse the FDB for periodic maintenance
-    int ix;
+    // the removal shifts entries, use the hash iterator
+    OA_HASH_ITERATOR hIter;
     MAC_BRIDGE_HASH_ENTRY* hE;
-    int nEntries = gBridgeDcpt->hashDcpt->hEntries;
+#if (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0) || (_TCPIP_MAC_BRIDGE_TX_BACKLOG != 0)
+    int ix;
+#endif  // (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0) || (_TCPIP_MAC_BRIDGE_TX_BACKLOG != 0)
+#if (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+    uint16_t nLearnt[TCPIP_MAC_BRIDGE_MAX_PORTS_NO] = {0};
+#endif  // (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
 
     _MAC_Bridge_CheckFDB(gBridgeDcpt);
-    for(ix = 0; ix < nEntries; ix++)
+    TCPIP_OAHASH_IteratorInit(gBridgeDcpt->hashDcpt, &hIter);
+    while((hE = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_IteratorNext(gBridgeDcpt->hashDcpt, &hIter)) != 0)
     {
-        hE = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryGet(gBridgeDcpt->hashDcpt, ix);
-        if(hE->hEntry.flags.busy != 0 && (hE->hEntry.flags.value & MAC_BRIDGE_HFLAG_STATIC ) == 0)
+        if((hE->hEntry.flags.value & MAC_BRIDGE_HFLAG_STATIC ) == 0)
         {   // in use dynamic entry
             if((int32_t)(currSec - hE->tExpire) > 0)
             {   // expired entry; remove
                 _MAC_Bridge_NotifyEvent(gBridgeDcpt, TCPIP_MAC_BRIDGE_EVENT_ENTRY_EXPIRED, hE->destAdd.v);
+                _MAC_Bridge_FDBWriteBegin(gBridgeDcpt);
                 TCPIP_OAHASH_EntryRemove(gBridgeDcpt->hashDcpt, &hE->hEntry);
+                _MAC_Bridge_FDBWriteEnd(gBridgeDcpt);
+            }
+#if (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+            else if((hE->hEntry.flags.value & MAC_BRIDGE_HFLAG_PORT_VALID) != 0)
+            {
+                nLearnt[hE->learnPort]++;
             }
+#endif  // (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
         }
     }
     _MAC_Bridge_CheckFDB(gBridgeDcpt);
 
-#if (_TCPIP_MAC_BRIDGE_DYNAMIC_FDB_ACCESS != 0)
-    _MAC_Bridge_FDBUnlock(gBridgeDcpt);
-#endif // (_TCPIP_MAC_BRIDGE_DYNAMIC_FDB_ACCESS != 0)
-}
+#if (_TCPIP_MAC_BRIDGE_FDB_RESIZE != 0)
+    if(gBridgeDcpt->pFdbRetired != 0)
+    {   // free the old table once no lock free reader can be using it
+        // the new readers get the new table
+        OSAL_CRITSECT_DATA_TYPE critStat = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+        void* pRetired = gBridgeDcpt->fdbReaders == 0 ? gBridgeDcpt->pFdbRetired : 0;
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, critStat);
 
-SYS_STATUS TCPIP_MAC_Bridge_Status(TCPIP_MAC_BRIDGE_HANDLE brHandle)
+        if(pRetired != 0)
+        {
+            TCPIP_HEAP_Free(gBridgeDcpt->memH, pRetired);
+            gBridgeDcpt->pFdbRetired = 0;
+        }
+    }
+    else
+    {   // follow the number of stations; a completed resize retires the old table
+        _MAC_Bridge_FDBWriteBegin(gBridgeDcpt);
+        TCPIP_OAHASH_ResizeStep(gBridgeDcpt->hashDcpt, MAC_BRIDGE_FDB_RESIZE_STEPS);
+        _MAC_Bridge_FDBWriteEnd(gBridgeDcpt);
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_FDB_RESIZE != 0)
+
+#if (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+    // the exact count, after all the removals since the last run
+    for(ix = 0; ix < gBridgeDcpt->nPorts; ix++)
+    {
+        gBridgeDcpt->learnDcpt[ix].nLearnt = nLearnt[ix];
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+
+#if (_TCPIP_MAC_BRIDGE_WARM_START != 0) 
+    if(currSec - gBridgeDcpt->warmSnapSec >= TCPIP_MAC_BRIDGE_WARM_SNAPSHOT_RATE && _MAC_Bridge_WarmClaim(gBridgeDcpt))
+    {   // else the API is taking a snapshot; retry next time
+        _MAC_Bridge_WarmSnapshot(gBridgeDcpt);
+        _MAC_Bridge_WarmRelease(gBridgeDcpt);
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_WARM_START != 0) 
+
+#if (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+    _MAC_Bridge_RstpTask(gBridgeDcpt, currSec);
+#endif  // (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+
+#if (_TCPIP_MAC_BRIDGE_ACL != 0)
+    if(gBridgeDcpt->pAclRetired != 0)
+    {   // no frame is being processed now
+        TCPIP_HEAP_Free(gBridgeDcpt->memH, gBridgeDcpt->pAclRetired);
+        gBridgeDcpt->pAclRetired = 0;
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_ACL != 0)
+
+#if (_TCPIP_MAC_BRIDGE_TX_BACKLOG != 0)
+    // retry the frames left by the forwarding path
+    for(ix = 0; ix < gBridgeDcpt->nPorts; ix++)
+    {
+        _MAC_Bridge_BacklogService(gBridgeDcpt, ix);
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_TX_BACKLOG != 0)
+
+#if (_TCPIP_MAC_BRIDGE_DYNAMIC_FDB_ACCESS != 0)
+    _MAC_Bridge_FDBUnlock(gBridgeDcpt);
+#endif // (_TCPIP_MAC_BRIDGE_DYNAMIC_FDB_ACCESS != 0)
+}
+
+// completes the bridge initialization
+// Note: the bridge does not wait for the whole stack to be ready:
+//  each port gets its host entry installed as soon as its interface is up
+//  so that the host MAC addresses are known before forwarding starts on that port.
+//  With TCPIP_STACK_STAGED_INIT the service modules complete their initialization
+//  in the background, after the interfaces are up.
+// returns true if the bridge is ready, false otherwise
+static bool _MAC_Bridge_CompleteInit(MAC_BRIDGE_DCPT* pDcpt)
+{
+    int portIx;
+    TCPIP_NET_IF* pNetIf;
+
+    // get the stack handle; it should be running
+    SYS_MODULE_OBJ stackObj = TCPIP_STACK_Initialize(0, 0);
+    SYS_STATUS stackStat = TCPIP_STACK_Status(stackObj);
+    if(stackStat < 0)
+    {   // some error has occurred
+        pDcpt->status = SYS_STATUS_ERROR;
+        return false;
+    }
+    else if(stackStat == SYS_STATUS_READY)
+    {
+        _MAC_Bridge_BootStampSet(pDcpt, stackReady);
+    }
+
+    for(portIx = 0; portIx < pDcpt->nPorts; portIx++) 
+    {
+        if((pDcpt->hostPortMask & (1ul << portIx)) != 0)
+        {   // already done
+            continue;
+        }
+
+        pNetIf = _TCPIPStackHandleToNet(TCPIP_STACK_IndexToNet(pDcpt->port2IfIx[portIx]));
+        if(!TCPIP_STACK_NetworkIsUp(pNetIf))
+        {   // MAC not initialized yet; the MAC address is not known
+            continue;
+        }
+
+        _MAC_Bridge_FDBWriteBegin(pDcpt);
+        TCPIP_MAC_BRIDGE_RESULT resHost = _MAC_Bridge_SetHostEntry(pDcpt, portIx);
+        _MAC_Bridge_FDBWriteEnd(pDcpt);
+        if(resHost != TCPIP_MAC_BRIDGE_RES_OK)
+        {   // some error has occurred
+            pDcpt->status = SYS_STATUS_ERROR;
+            return false;
+        }
+
+        pDcpt->hostPortMask |= 1ul << portIx;
+        _MAC_Bridge_BootStampPortSet(pDcpt, portUp, portIx);
+    }
+
+    if(pDcpt->hostPortMask != (1ul << pDcpt->nPorts) - 1)
+    {   // wait some more
+        return false;
+    }
+
+    // all good
+    // back to the regular rate
+    _TCPIPStackSignalHandlerSetParams(TCPIP_THIS_MODULE_ID, pDcpt->tmrSigHandle, TCPIP_MAC_BRIDGE_TASK_RATE);
+    pDcpt->status = SYS_STATUS_READY;
+    _MAC_Bridge_BootStampSet(pDcpt, bridgeReady);
+#if (_TCPIP_MAC_BRIDGE_BOOT_TIMESTAMPS != 0) 
+    if(pDcpt->bootStamps.stackReady != 0)
+    {   // otherwise reported when the stack is ready
+        _MAC_Bridge_BootReport(pDcpt);
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_BOOT_TIMESTAMPS != 0) 
+    return true;
+}
+
+SYS_STATUS TCPIP_MAC_Bridge_Status(TCPIP_MAC_BRIDGE_HANDLE brHandle)
 {
     MAC_BRIDGE_DCPT* bDcpt = _MAC_Bridge_ValidateHandle(brHandle);
 
@@ -1159,6 +1942,12 @@ static void _MAC_Bridge_SetPacketForward(MAC_BRIDGE_DCPT* pBDcpt, MAC_BRIDGE_HAS
     TCPIP_MAC_BRIDGE_CONTROL_TYPE portControl, defOutControl, defHostControl;
     uint16_t linkMtu;
     int learnPort = 0;
+#if (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+    // relay only between forwarding ports
+    // the host processing of the frame (the inPort bit) is not affected
+    uint32_t rstpOutMap = (pBDcpt->rstpFwdMap & (1ul << inPort)) != 0 ? pBDcpt->rstpFwdMap : 0;
+    bool rstpDiscard = false;
+#endif  // (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
 
     if(hDest == 0 || ((hDest->hEntry.flags.value & (MAC_BRIDGE_HFLAG_STATIC | MAC_BRIDGE_HFLAG_PORT_VALID)) == 0) )
     {   // no such entry in our FDB or invalid dynamic entry; forward an all other ports;
@@ -1256,6 +2045,13 @@ static void _MAC_Bridge_SetPacketForward(MAC_BRIDGE_DCPT* pBDcpt, MAC_BRIDGE_HAS
 
         if(portControl == TCPIP_MAC_BRIDGE_CONTROL_TYPE_FORWARD)
         {   // port needs forwarding
+#if (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+            if((rstpOutMap & (1ul << portIx)) == 0)
+            {   // input or output port not forwarding
+                rstpDiscard = true;
+                continue;
+            }
+#endif  // (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
             // check it's not too large to send on the output interface
             outIfIx = pBDcpt->port2IfIx[portIx];
             pOutIf = _TCPIPStackHandleToNet(TCPIP_STACK_IndexToNet(outIfIx));
@@ -1272,7 +2068,13 @@ static void _MAC_Bridge_SetPacketForward(MAC_BRIDGE_DCPT* pBDcpt, MAC_BRIDGE_HAS
         }
         // else filter
     }
-        
+
+#if (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+    if(rstpDiscard)
+    {
+        _MAC_Bridge_StatPortUpdate(pBDcpt, inPort, MAC_BRIDGE_STAT_TYPE_RSTP_DISCARD_PKTS, 1);
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
 }
 
 #if (_TCPIP_MAC_BRIDGE_EVENT_NOTIFY  != 0) 
@@ -1323,15 +2125,46 @@ size_t TCPIP_MAC_Bridge_FDBEntries(TCPIP_MAC_BRIDGE_HANDLE brHandle)
     MAC_BRIDGE_DCPT* bDcpt = _MAC_Bridge_ValidateHandle(brHandle);
     if(bDcpt != 0)
     {
-        return bDcpt->hashDcpt->hEntries;
+        return TCPIP_OAHASH_EntryRange(bDcpt->hashDcpt);
     }
 
     return 0;
 }
 
+static void _MAC_Bridge_FDBEntryCopy(TCPIP_MAC_FDB_ENTRY* pEntry, const MAC_BRIDGE_HASH_ENTRY* hE)
+{
+    memcpy(pEntry->destAdd.v, hE->destAdd.v, sizeof(hE->destAdd));
+    pEntry->flags = (uint8_t)(hE->hEntry.flags.value >> 8);
+    pEntry->learnPort = hE->learnPort;
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+    pEntry->vlanId = hE->vlanId;
+#else
+    pEntry->vlanId = 0;
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+#if (_TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
+    pEntry->moveCount = hE->moveCount;
+#else
+    pEntry->moveCount = 0;
+#endif  // (_TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
+    pEntry->tExpire = hE->tExpire;
+    pEntry->fwdPackets = hE->fwdPackets;
+#if (_TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+    pEntry->txBytes = hE->txBytes;
+    pEntry->rxPackets = hE->rxPackets;
+    pEntry->rxBytes = hE->rxBytes;
+#else
+    pEntry->txBytes = 0;
+    pEntry->rxPackets = 0;
+    pEntry->rxBytes = 0;
+#endif  // (_TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+    memcpy(pEntry->outPortMap, hE->outPortMap, sizeof(hE->outPortMap));
+}
+
 TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBIndexRead(TCPIP_MAC_BRIDGE_HANDLE brHandle, size_t ix, TCPIP_MAC_FDB_ENTRY* pEntry)
 {
-    MAC_BRIDGE_HASH_ENTRY h1, h2;
+    int nTries;
+    uint32_t seq;
+    MAC_BRIDGE_HASH_ENTRY h1;
     MAC_BRIDGE_DCPT* bDcpt = _MAC_Bridge_ValidateHandle(brHandle);
 
     if(bDcpt == 0)
@@ -1339,21 +2172,30 @@ TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBIndexRead(TCPIP_MAC_BRIDGE_HANDLE br
         return TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR;
     }
 
-    MAC_BRIDGE_HASH_ENTRY* hE = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryGet(bDcpt->hashDcpt, ix);
+    MAC_BRIDGE_HASH_ENTRY* hE;
 
-    if(hE == 0)
+    // obtain a consistent reading without locking the FDB
+    // a resize moves the entries to another table: get the address every time
+    for(nTries = 0; ; nTries++)
     {
-        return TCPIP_MAC_BRIDGE_RES_INDEX_ERROR; 
-    }
-
+        if(nTries == MAC_BRIDGE_FDB_READ_RETRIES)
+        {   // too much update activity
+            return TCPIP_MAC_BRIDGE_RES_LOCK_ERROR;
+        }
 
-    // obtain a consistent reading
-    while(true)
-    {
+        seq = _MAC_Bridge_FDBReadBegin(bDcpt);
+        hE = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryGet(bDcpt->hashDcpt, ix);
+        if(hE == 0)
+        {
+            if(_MAC_Bridge_FDBReadValid(bDcpt, seq))
+            {
+                return TCPIP_MAC_BRIDGE_RES_INDEX_ERROR; 
+            }
+            continue;
+        }
         memcpy(&h1, hE, sizeof(h1));
-        memcpy(&h2, hE, sizeof(h2));
-        if(memcmp(&h1, &h2, sizeof(h1)) == 0)
-        {   // match
+        if(_MAC_Bridge_FDBReadValid(bDcpt, seq))
+        {
             break;
         }
     }
@@ -1362,12 +2204,7 @@ TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBIndexRead(TCPIP_MAC_BRIDGE_HANDLE br
     {
         if(pEntry)
         {
-            memcpy(pEntry->destAdd.v, h1.destAdd.v, sizeof(h1.destAdd));
-            pEntry->flags = (uint8_t)(h1.hEntry.flags.value >> 8);
-            pEntry->learnPort = h1.learnPort;
-            pEntry->tExpire = h1.tExpire;
-            pEntry->fwdPackets = h1.fwdPackets;
-            memcpy(pEntry->outPortMap, h1.outPortMap, sizeof(h1.outPortMap));
+            _MAC_Bridge_FDBEntryCopy(pEntry, &h1);
         }
 
         return TCPIP_MAC_BRIDGE_RES_OK;
@@ -1376,6 +2213,193 @@ TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBIndexRead(TCPIP_MAC_BRIDGE_HANDLE br
     return TCPIP_MAC_BRIDGE_RES_INDEX_NO_ENTRY;
 }
 
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBExport(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_FDB_ENTRY* pEntries, size_t nEntries, size_t* pnExported)
+{
+    int nTries;
+    uint32_t seq;
+    size_t ix, nHashEntries, nCopied;
+    const MAC_BRIDGE_HASH_ENTRY* hE;
+    MAC_BRIDGE_DCPT* bDcpt = _MAC_Bridge_ValidateHandle(brHandle);
+
+    if(bDcpt == 0)
+    {
+        return TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR;
+    }
+
+    if(pEntries == 0 || nEntries == 0)
+    {
+        return TCPIP_MAC_BRIDGE_RES_PARAM_ERROR;
+    }
+
+    // copy the whole FDB as one consistent snapshot
+    for(nTries = 0; ; nTries++)
+    {
+        if(nTries == MAC_BRIDGE_FDB_READ_RETRIES)
+        {   // too much update activity
+            return TCPIP_MAC_BRIDGE_RES_LOCK_ERROR;
+        }
+
+        seq = _MAC_Bridge_FDBReadBegin(bDcpt);
+        nHashEntries = TCPIP_OAHASH_EntryRange(bDcpt->hashDcpt);
+        nCopied = 0;
+        for(ix = 0; ix < nHashEntries && nCopied < nEntries; ix++)
+        {
+            hE = (const MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryGet(bDcpt->hashDcpt, ix);
+            if(hE == 0)
+            {   // resized meanwhile
+                break;
+            }
+            if(hE->hEntry.flags.busy != 0)
+            {
+                _MAC_Bridge_FDBEntryCopy(pEntries + nCopied, hE);
+                nCopied++;
+            }
+        }
+
+        if(_MAC_Bridge_FDBReadValid(bDcpt, seq))
+        {
+            break;
+        }
+    }
+
+    if(pnExported)
+    {
+        *pnExported = nCopied;
+    }
+
+    return TCPIP_MAC_BRIDGE_RES_OK;
+}
+
+#if (_TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+static uint32_t _MAC_Bridge_TopValue(const TCPIP_MAC_FDB_ENTRY* pEntry, TCPIP_MAC_BRIDGE_TOP_KEY key)
+{
+    switch(key)
+    {
+        case TCPIP_MAC_BRIDGE_TOP_KEY_RX_BYTES:
+            return pEntry->rxBytes;
+
+        case TCPIP_MAC_BRIDGE_TOP_KEY_TX_BYTES:
+            return pEntry->txBytes;
+
+        case TCPIP_MAC_BRIDGE_TOP_KEY_RX_PACKETS:
+            return pEntry->rxPackets;
+
+        case TCPIP_MAC_BRIDGE_TOP_KEY_TX_PACKETS:
+            return pEntry->fwdPackets;
+
+        default:
+            break;
+    }
+
+    return pEntry->rxBytes + pEntry->txBytes;
+}
+
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBTopGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_BRIDGE_TOP_KEY key, TCPIP_MAC_FDB_ENTRY* pEntries, size_t nEntries, size_t* pnFound)
+{
+    int nTries;
+    uint32_t seq, value;
+    size_t ix, jx, nHashEntries, nFound;
+    const MAC_BRIDGE_HASH_ENTRY* hE;
+    TCPIP_MAC_FDB_ENTRY fdbEntry;
+    MAC_BRIDGE_DCPT* bDcpt = _MAC_Bridge_ValidateHandle(brHandle);
+
+    if(bDcpt == 0)
+    {
+        return TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR;
+    }
+
+    if(pEntries == 0 || nEntries == 0 || key > TCPIP_MAC_BRIDGE_TOP_KEY_TX_PACKETS)
+    {
+        return TCPIP_MAC_BRIDGE_RES_PARAM_ERROR;
+    }
+
+    for(nTries = 0; ; nTries++)
+    {
+        if(nTries == MAC_BRIDGE_FDB_READ_RETRIES)
+        {   // too much update activity
+            return TCPIP_MAC_BRIDGE_RES_LOCK_ERROR;
+        }
+
+        seq = _MAC_Bridge_FDBReadBegin(bDcpt);
+        nHashEntries = TCPIP_OAHASH_EntryRange(bDcpt->hashDcpt);
+        nFound = 0;
+        for(ix = 0; ix < nHashEntries; ix++)
+        {
+            hE = (const MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryGet(bDcpt->hashDcpt, ix);
+            if(hE == 0)
+            {   // resized meanwhile
+                break;
+            }
+            if(hE->hEntry.flags.busy == 0)
+            {
+                continue;
+            }
+
+            _MAC_Bridge_FDBEntryCopy(&fdbEntry, hE);
+            value = _MAC_Bridge_TopValue(&fdbEntry, key);
+            if(value == 0)
+            {
+                continue;
+            }
+
+            if(nFound == nEntries)
+            {   // full; replace the smallest one if this is larger
+                if(value <= _MAC_Bridge_TopValue(pEntries + nFound - 1, key))
+                {
+                    continue;
+                }
+                nFound--;
+            }
+
+            // partial insertion sort, descending
+            for(jx = nFound; jx != 0 && _MAC_Bridge_TopValue(pEntries + jx - 1, key) < value; jx--)
+            {
+                pEntries[jx] = pEntries[jx - 1];
+            }
+            pEntries[jx] = fdbEntry;
+            nFound++;
+        }
+
+        if(_MAC_Bridge_FDBReadValid(bDcpt, seq))
+        {
+            break;
+        }
+    }
+
+    if(pnFound)
+    {
+        *pnFound = nFound;
+    }
+
+    return TCPIP_MAC_BRIDGE_RES_OK;
+}
+
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBCountersReset(TCPIP_MAC_BRIDGE_HANDLE brHandle)
+{
+    MAC_BRIDGE_DCPT* bDcpt = _MAC_Bridge_ValidateHandle(brHandle);
+
+    if(bDcpt == 0)
+    {
+        return TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR;
+    }
+
+    // the entries are written only by the bridge task
+    bDcpt->countersReset = 1;
+
+    return TCPIP_MAC_BRIDGE_RES_OK;
+}
+#else
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBTopGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_BRIDGE_TOP_KEY key, TCPIP_MAC_FDB_ENTRY* pEntries, size_t nEntries, size_t* pnFound)
+{
+    return TCPIP_MAC_BRIDGE_RES_PARAM_ERROR;
+}
+
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBCountersReset(TCPIP_MAC_BRIDGE_HANDLE brHandle)
+{
+    return TCPIP_MAC_BRIDGE_RES_PARAM_ERROR;
+}
+#endif  // (_TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+
 #if (_TCPIP_MAC_BRIDGE_DYNAMIC_FDB_ACCESS != 0)
 static TCPIP_MAC_BRIDGE_RESULT _MAC_Bridge_FDBLock(TCPIP_MAC_BRIDGE_HANDLE brHandle, bool validate)
 {
@@ -1424,9 +2448,8 @@ static void _MAC_Bridge_FDBUnlock(MAC_BRIDGE_DCPT* pDcpt)
 TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBReset(TCPIP_MAC_BRIDGE_HANDLE brHandle)
 {
     // delete all dynamic data from the FDB
-    int ix;
+    OA_HASH_ITERATOR hIter;
     MAC_BRIDGE_HASH_ENTRY* hE;
-    int nEntries;
 
     // lock access: make sure the user threads don't mess with the FDB
     TCPIP_MAC_BRIDGE_RESULT res = _MAC_Bridge_FDBLock(brHandle, true);
@@ -1438,24 +2461,21 @@ TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBReset(TCPIP_MAC_BRIDGE_HANDLE brHand
 
     MAC_BRIDGE_DCPT* pDcpt = _MAC_Bridge_DcptFromHandle(brHandle);
 
-    nEntries = pDcpt->hashDcpt->hEntries;
-
-    for(ix = 0; ix < nEntries; ix++)
+    _MAC_Bridge_FDBWriteBegin(pDcpt);
+    TCPIP_OAHASH_IteratorInit(pDcpt->hashDcpt, &hIter);
+    while((hE = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_IteratorNext(pDcpt->hashDcpt, &hIter)) != 0)
     {
-        hE = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryGet(pDcpt->hashDcpt, ix);
-        if(hE->hEntry.flags.busy != 0)
-        {   // in use
-            if((hE->hEntry.flags.value & MAC_BRIDGE_HFLAG_STATIC ) != 0)
-            {   // static entry
-                hE->hEntry.flags.value &= ~MAC_BRIDGE_HFLAG_PORT_VALID;
-                hE->fwdPackets = 0;
-            }
-            else
-            {   // dynamic entry
-                TCPIP_OAHASH_EntryRemove(pDcpt->hashDcpt, &hE->hEntry);
-            }
+        if((hE->hEntry.flags.value & MAC_BRIDGE_HFLAG_STATIC ) != 0)
+        {   // static entry
+            hE->hEntry.flags.value &= ~MAC_BRIDGE_HFLAG_PORT_VALID;
+            hE->fwdPackets = 0;
+        }
+        else
+        {   // dynamic entry
+            TCPIP_OAHASH_EntryRemove(pDcpt->hashDcpt, &hE->hEntry);
         }
     }
+    _MAC_Bridge_FDBWriteEnd(pDcpt);
 
     // done
     _MAC_Bridge_FDBUnlock(pDcpt);
@@ -1475,13 +2495,27 @@ TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBDeleteEntry(TCPIP_MAC_BRIDGE_HANDLE
 
     MAC_BRIDGE_DCPT* pDcpt = _MAC_Bridge_DcptFromHandle(brHandle);
 
-    MAC_BRIDGE_HASH_ENTRY* hE = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryLookup(pDcpt->hashDcpt, pDestAddr->v);
+    MAC_BRIDGE_HASH_ENTRY* hE = _MAC_Bridge_FDBLookup(pDcpt, pDestAddr, 0);
 
+    _MAC_Bridge_FDBWriteBegin(pDcpt);
     if(hE != 0 && hE->hEntry.flags.busy != 0)
     {   // valid entry
         TCPIP_OAHASH_EntryRemove(pDcpt->hashDcpt, &hE->hEntry);
     }
 
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+    int ix;
+    for(ix = 0; ix < pDcpt->nVlans; ix++)
+    {   // the address could have been learnt on each VLAN
+        hE = _MAC_Bridge_FDBLookup(pDcpt, pDestAddr, pDcpt->vlanTbl[ix].vlanId);
+        if(hE != 0 && hE->hEntry.flags.busy != 0)
+        {
+            TCPIP_OAHASH_EntryRemove(pDcpt->hashDcpt, &hE->hEntry);
+        }
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+    _MAC_Bridge_FDBWriteEnd(pDcpt);
+
     // done
     _MAC_Bridge_FDBUnlock(pDcpt);
     return TCPIP_MAC_BRIDGE_RES_OK;
@@ -1503,7 +2537,8 @@ TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBAddEntry(TCPIP_MAC_BRIDGE_HANDLE brH
 
     MAC_BRIDGE_DCPT* pDcpt = _MAC_Bridge_DcptFromHandle(brHandle);
 
-    MAC_BRIDGE_HASH_ENTRY* hE = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryLookupOrInsert(pDcpt->hashDcpt, pPermEntry->destAdd.v);
+    _MAC_Bridge_FDBWriteBegin(pDcpt);
+    MAC_BRIDGE_HASH_ENTRY* hE = _MAC_Bridge_FDBInsert(pDcpt, &pPermEntry->destAdd, 0);
 
     if(hE != 0)
     {   // clear the outPortMap for a new entry, keep it for existent one
@@ -1515,6 +2550,7 @@ TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBAddEntry(TCPIP_MAC_BRIDGE_HANDLE brH
     {
         res = TCPIP_MAC_BRIDGE_RES_FDB_FULL; 
     }
+    _MAC_Bridge_FDBWriteEnd(pDcpt);
 
     // done
     _MAC_Bridge_FDBUnlock(pDcpt);
@@ -1545,6 +2581,8 @@ static void _MAC_Bridge_SetHashStaticEntry(MAC_BRIDGE_HASH_ENTRY* hE, MAC_BRIDGE
 
 // forward a packet on an output interface
 // if all done, it frees the allocated packet
+// hEntry is the destination FDB entry, valid only for the call from _MAC_Bridge_ProcessPacket:
+// a deferred TX (MAC acknowledge, TX backlog) passes 0 and is not counted per entry
 static void _MAC_Bridge_ForwardPacket(TCPIP_MAC_PACKET* pFwdPkt, MAC_BRIDGE_HASH_ENTRY* hEntry)
 {
     MAC_BRIDGE_FWD_DCPT* pFDcpt = _MAC_Bridge_GetPktFwdDcpt(pFwdPkt);
@@ -1582,6 +2620,18 @@ static void _MAC_Bridge_ForwardPacket(TCPIP_MAC_PACKET* pFwdPkt, MAC_BRIDGE_HASH
         // test that the netowrk IF hasn't been killed; there's no other test for this
         if(TCPIP_STACK_NetworkIsUp(pOutIf))
         {
+#if (_TCPIP_MAC_BRIDGE_TX_BACKLOG != 0)
+            if(_MAC_Bridge_BacklogPending(pBDcpt, brPort, pFDcpt) && _MAC_Bridge_BacklogAdd(pBDcpt, brPort, pFwdPkt))
+            {   // queued behind the older frames waiting for this port
+                return;
+            }
+#endif  // (_TCPIP_MAC_BRIDGE_TX_BACKLOG != 0)
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+            if((pFDcpt->fwdFlags & MAC_BRIDGE_FWD_FLAG_VLAN) != 0)
+            {   // tag/untag as needed by this port
+                _MAC_Bridge_VlanEgress(pFwdPkt, pFDcpt, (pFDcpt->untagMap & (1ul << brPort)) != 0);
+            }
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
             pFwdPkt->next = 0;   // send single packet
             if(_TCPIPStackPacketTx(pOutIf, pFwdPkt) >= 0)
             {   // successfully transmitted
@@ -1596,17 +2646,25 @@ static void _MAC_Bridge_ForwardPacket(TCPIP_MAC_PACKET* pFwdPkt, MAC_BRIDGE_HASH
                 if(hEntry != 0)
                 {
                     hEntry->fwdPackets++;
+                    _MAC_Bridge_EntryCountTx(hEntry, pFDcpt->pktLen);
                 }
                 if((pktFlags & MAC_BRIDGE_ALLOC_FLAG_BRIDGE_OWN) == 0)
                 {
                     _MAC_Bridge_StatPortUpdate(gBridgeDcpt, brPort, MAC_BRIDGE_STAT_TYPE_FWD_DIRECT_PKTS, 1);
                 }
+                _MAC_Bridge_BootStampSet(pBDcpt, firstFwd);
 
                 _MAC_Bridge_TracePkt(pFwdPkt, brPort, true);
                 return;
             }
 
             // failed sending the packet 
+#if (_TCPIP_MAC_BRIDGE_TX_BACKLOG != 0)
+            if(_MAC_Bridge_BacklogAdd(pBDcpt, brPort, pFwdPkt))
+            {   // MAC busy, retried later
+                return;
+            }
+#endif  // (_TCPIP_MAC_BRIDGE_TX_BACKLOG != 0)
             _MAC_Bridge_StatUpdate(pBDcpt, MAC_BRIDGE_STAT_TYPE_FAIL_MAC, 1);
         }
 
@@ -1615,6 +2673,13 @@ static void _MAC_Bridge_ForwardPacket(TCPIP_MAC_PACKET* pFwdPkt, MAC_BRIDGE_HASH
 
     // at this point the forward map is empty and we're done
 
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+    if((pFDcpt->fwdFlags & MAC_BRIDGE_FWD_FLAG_VLAN) != 0)
+    {   // restore the tagged layout: the packet goes back to the pool or to the MAC driver
+        _MAC_Bridge_VlanEgress(pFwdPkt, pFDcpt, false);
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+
     if((pktFlags & MAC_BRIDGE_ALLOC_FLAG_BRIDGE_OWN) != 0)
     {   // bridge owned
         if((pktFlags & MAC_BRIDGE_ALLOC_FLAG_STICKY) != 0)
@@ -1631,7 +2696,7 @@ static void _MAC_Bridge_ForwardPacket(TCPIP_MAC_PACKET* pFwdPkt, MAC_BRIDGE_HASH
     {   // restore the packet owners and acknowledge it
         pFwdPkt->ackParam = pFDcpt->ownAckParam;
         pFwdPkt->ackFunc = pFDcpt->ownAckFunc;
-        TCPIP_PKT_PacketAcknowledge(pFwdPkt, TCPIP_MAC_PKT_ACK_BRIDGE_DONE); 
+        TCPIP_PKT_PacketAcknowledge(pFwdPkt, TCPIP_MAC_PKT_ACK_BRIDGE_DONE);
     }
 
     // re-add the fowrward descriptor to the pool
@@ -1664,7 +2729,7 @@ static void _MAC_Bridge_PacketAck(TCPIP_MAC_PACKET* pkt,  const void* param)
     _MAC_Bridge_StatUpdate(gBridgeDcpt, MAC_BRIDGE_STAT_TYPE_ACK_PKTS, 1);
 
     // keep forwarding to the other interfaces
-    _MAC_Bridge_ForwardPacket(pkt, (MAC_BRIDGE_HASH_ENTRY*)param);
+    _MAC_Bridge_ForwardPacket(pkt, 0);
 }
 
 // returns the number of the ports that are part of the bridge and their port map
@@ -1737,7 +2802,7 @@ static TCPIP_MAC_BRIDGE_RESULT _MAC_Bridge_SetPermEntries(MAC_BRIDGE_DCPT* pBDcp
     TCPIP_MAC_BRIDGE_RESULT res = TCPIP_MAC_BRIDGE_RES_OK;
     for(ix = 0, pPerm = pBConfig->bridgePermTable; ix < pBConfig->bridgePermTableSize; ix++, pPerm++)
     {
-        hE = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryLookupOrInsert(pBDcpt->hashDcpt, pPerm->destAdd.v);
+        hE = _MAC_Bridge_FDBInsert(pBDcpt, &pPerm->destAdd, 0);
         if(hE == 0)
         {   // out of entries!
             return TCPIP_MAC_BRIDGE_RES_FDB_FULL;
@@ -1800,52 +2865,47 @@ static TCPIP_MAC_BRIDGE_RESULT _MAC_Bridge_SetFDBFromPerm(MAC_BRIDGE_DCPT* pBDcp
 
 // populates the FDB with the host internal entries
 // these configure the host packets behavior
-static TCPIP_MAC_BRIDGE_RESULT _MAC_Bridge_SetHostEntries(MAC_BRIDGE_DCPT* pDcpt)
+// installs the static host entry for the interface of a bridge port
+// the interface has to be up, so that its MAC address is valid
+static TCPIP_MAC_BRIDGE_RESULT _MAC_Bridge_SetHostEntry(MAC_BRIDGE_DCPT* pDcpt, int portIx)
 {
     MAC_BRIDGE_HASH_ENTRY* hE;
     TCPIP_NET_IF*   pNetIf;
     const TCPIP_MAC_ADDR* pMacAddress;
-    int ifIx;
-    int portIx;
     bool clearOutMap;
 
-    for(portIx = 0; portIx < pDcpt->nPorts; portIx++) 
-    {
-        ifIx = pDcpt->port2IfIx[portIx];
-        pNetIf = _TCPIPStackHandleToNet(TCPIP_STACK_IndexToNet(ifIx));
+    pNetIf = _TCPIPStackHandleToNet(TCPIP_STACK_IndexToNet(pDcpt->port2IfIx[portIx]));
 
-        _Mac_Bridge_AssertCond(pNetIf != 0, __func__, __LINE__);
-        _Mac_Bridge_AssertCond(_TCPIPStack_BridgeCheckIf(pNetIf) == true, __func__, __LINE__);
-        _Mac_Bridge_AssertCond(_TCPIPStack_BridgeGetIfPort(pNetIf) == portIx, __func__, __LINE__);
+    _Mac_Bridge_AssertCond(pNetIf != 0, __func__, __LINE__);
+    _Mac_Bridge_AssertCond(_TCPIPStack_BridgeCheckIf(pNetIf) == true, __func__, __LINE__);
+    _Mac_Bridge_AssertCond(_TCPIPStack_BridgeGetIfPort(pNetIf) == portIx, __func__, __LINE__);
 
 
-        pMacAddress = (const TCPIP_MAC_ADDR*)_TCPIPStack_NetMACAddressGet(pNetIf);
-
-        if(TCPIP_Helper_IsMcastMACAddress(pMacAddress))
-        {
-            return TCPIP_MAC_BRIDGE_RES_IF_ADDRESS_ERROR; 
-        }
+    pMacAddress = (const TCPIP_MAC_ADDR*)_TCPIPStack_NetMACAddressGet(pNetIf);
 
-        // add this interface as a static entry
-        hE = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryLookupOrInsert(pDcpt->hashDcpt, _TCPIPStack_NetMACAddressGet(pNetIf));
-        if(hE == 0)
-        {   // out of entries!
-            return TCPIP_MAC_BRIDGE_RES_FDB_FULL;
-        }
+    if(TCPIP_Helper_IsMcastMACAddress(pMacAddress))
+    {
+        return TCPIP_MAC_BRIDGE_RES_IF_ADDRESS_ERROR; 
+    }
 
-        if(hE->hEntry.flags.newEntry == 0)
-        {   // overriden by initialization 
-            _Mac_Bridge_AssertCond((hE->hEntry.flags.value & MAC_BRIDGE_HFLAG_STATIC) != 0, __func__, __LINE__);
-            clearOutMap = false;
-        }
-        else
-        {   // just added
-            clearOutMap = true;
-        }
+    // add this interface as a static entry
+    hE = _MAC_Bridge_FDBInsert(pDcpt, pMacAddress, 0);
+    if(hE == 0)
+    {   // out of entries!
+        return TCPIP_MAC_BRIDGE_RES_FDB_FULL;
+    }
 
-        _MAC_Bridge_SetHashStaticEntry(hE, MAC_BRIDGE_HFLAG_HOST, clearOutMap);
+    if(hE->hEntry.flags.newEntry == 0 && (hE->hEntry.flags.value & MAC_BRIDGE_HFLAG_STATIC) != 0)
+    {   // overriden by initialization 
+        clearOutMap = false;
+    }
+    else
+    {   // just added or learnt while the port was coming up 
+        clearOutMap = true;
     }
 
+    _MAC_Bridge_SetHashStaticEntry(hE, MAC_BRIDGE_HFLAG_HOST, clearOutMap);
+
     return TCPIP_MAC_BRIDGE_RES_OK;
 }
 
@@ -1867,37 +2927,1928 @@ static int _MAC_Bridge_IfBridged(MAC_BRIDGE_DCPT* pDcpt, int netIx)
     return -1;
 }
 
-// simplistic implementation of count leading zeros in a 32 bit value
-// It returns the number of contiguous leading zeroes
-#if !defined (__PIC32MX__) && !defined(__PIC32MZ__)
-static unsigned int _MAC_BridgeLeadingZeroes(uint32_t value)
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+// IEEE 802.1Q VLAN aware bridging
+// The FDB is keyed by the (MAC address, VLAN ID) pair.
+// The static and host entries have VLAN ID 0 and apply to all VLANs.
+
+// builds the run time VLAN table and the ports PVID from the configuration
+static TCPIP_MAC_BRIDGE_RESULT _MAC_Bridge_SetVlans(MAC_BRIDGE_DCPT* pBDcpt, const TCPIP_MAC_BRIDGE_CONFIG* pBConfig)
 {
-    int ix;
-    uint32_t mask;
-    uint16_t nZeroes;
+    size_t ix;
+    int jx, brPort;
+    const TCPIP_MAC_BRIDGE_VLAN_ENTRY* pEntry;
+    const TCPIP_MAC_BRIDGE_VLAN_MEMBER* pMember;
+    MAC_BRIDGE_VLAN_DCPT* pVlan;
 
-    nZeroes = 0;
-    mask = 1 << 31;  // start from MSB
+    if(pBConfig->vlanTableSize == 0 || pBConfig->vlanTable == 0)
+    {   // not VLAN aware
+        return TCPIP_MAC_BRIDGE_RES_OK;
+    }
 
-    for(ix = 0; ix < 32; ix++)
+    if(pBConfig->vlanTableSize > TCPIP_MAC_BRIDGE_MAX_VLANS)
     {
-        if((value & mask) != 0)
-        {   // 1 detected
-            return nZeroes;
-        }
-
-        // 0 detected
-        nZeroes++;
-        mask >>= 1;
+        return TCPIP_MAC_BRIDGE_RES_VLAN_ERROR;
     }
 
-    return nZeroes;
-}
-#endif  // !defined (__PIC32MX__) && !defined(__PIC32MZ__)
+    pVlan = pBDcpt->vlanTbl;
+    for(ix = 0, pEntry = pBConfig->vlanTable; ix < pBConfig->vlanTableSize; ix++, pEntry++, pVlan++)
+    {
+        if(pEntry->vlanId == 0 || pEntry->vlanId > MAC_BRIDGE_VLAN_VID_MAX || _MAC_Bridge_VlanFind(pBDcpt, pEntry->vlanId) != 0)
+        {   // invalid or duplicate VLAN
+            return TCPIP_MAC_BRIDGE_RES_VLAN_ERROR;
+        }
 
+        if(pEntry->nMembers != 0 && pEntry->pMembers == 0)
+        {
+            return TCPIP_MAC_BRIDGE_RES_VLAN_ERROR;
+        }
 
+        pVlan->vlanId = pEntry->vlanId;
+        pVlan->memberMap = 0;
+        pVlan->untagMap = 0;
+        for(jx = 0, pMember = pEntry->pMembers; jx < pEntry->nMembers; jx++, pMember++)
+        {
+            brPort = _MAC_Bridge_IfBridged(pBDcpt, pMember->ifIx);
+            if(brPort < 0)
+            {
+                return TCPIP_MAC_BRIDGE_RES_IF_NOT_BRIDGED;
+            }
 
-size_t _MAC_BridgeHashKeyHash(OA_HASH_DCPT* pOH, const void* key)
+            pVlan->memberMap |= 1ul << brPort;
+            if((pMember->memberFlags & TCPIP_MAC_BRIDGE_VLAN_FLAG_UNTAGGED) != 0)
+            {
+                pVlan->untagMap |= 1ul << brPort;
+            }
+
+            if((pMember->memberFlags & TCPIP_MAC_BRIDGE_VLAN_FLAG_PVID) != 0)
+            {
+                if(pBDcpt->portPvid[brPort] != 0)
+                {   // only one PVID per port
+                    return TCPIP_MAC_BRIDGE_RES_VLAN_ERROR;
+                }
+                pBDcpt->portPvid[brPort] = pEntry->vlanId;
+            }
+        }
+
+        // VLAN is in use, visible to _MAC_Bridge_VlanFind
+        pBDcpt->nVlans++;
+    }
+
+    return TCPIP_MAC_BRIDGE_RES_OK;
+}
+
+// returns the VLAN descriptor for a VLAN ID
+// 0 if not found
+static const MAC_BRIDGE_VLAN_DCPT* _MAC_Bridge_VlanFind(MAC_BRIDGE_DCPT* pBDcpt, uint16_t vlanId)
+{
+    int ix;
+    const MAC_BRIDGE_VLAN_DCPT* pVlan = pBDcpt->vlanTbl;
+
+    for(ix = 0; ix < pBDcpt->nVlans; ix++, pVlan++)
+    {
+        if(pVlan->vlanId == vlanId)
+        {
+            return pVlan;
+        }
+    }
+
+    return 0;
+}
+
+// classifies a received frame to a VLAN
+// untagged and priority tagged frames belong to the port PVID
+// returns the frame VLAN or 0 if the frame needs to be discarded:
+// no VLAN or the ingress port is not a member of the VLAN
+// sets the VLAN forwarding data in the descriptor
+static const MAC_BRIDGE_VLAN_DCPT* _MAC_Bridge_VlanIngress(MAC_BRIDGE_DCPT* pBDcpt, TCPIP_MAC_PACKET* pRxPkt, uint8_t inPort, MAC_BRIDGE_FWD_DCPT* pFDcpt)
+{
+    const MAC_BRIDGE_VLAN_DCPT* pVlan;
+    uint16_t tci, vlanId;
+    TCPIP_MAC_ETHERNET_HEADER* pMacHdr = (TCPIP_MAC_ETHERNET_HEADER*)pRxPkt->pMacLayer;
+
+    if(pMacHdr->Type == TCPIP_Helper_htons(TCPIP_ETHER_TYPE_VLAN))
+    {   // tagged frame; the TCI follows the Ethernet header
+        tci = ((uint16_t)pRxPkt->pNetLayer[0] << 8) | pRxPkt->pNetLayer[1];
+        vlanId = tci & MAC_BRIDGE_VLAN_VID_MASK;
+        pFDcpt->fwdFlags = MAC_BRIDGE_FWD_FLAG_VLAN | MAC_BRIDGE_FWD_FLAG_TAGGED;
+    }
+    else
+    {   // untagged, default priority
+        tci = 0;
+        vlanId = 0;
+        pFDcpt->fwdFlags = MAC_BRIDGE_FWD_FLAG_VLAN;
+    }
+
+    if(vlanId == 0)
+    {   // untagged or priority tagged
+        vlanId = pBDcpt->portPvid[inPort];
+    }
+
+    pVlan = _MAC_Bridge_VlanFind(pBDcpt, vlanId);
+    if(pVlan == 0 || (pVlan->memberMap & (1ul << inPort)) == 0)
+    {
+        return 0;
+    }
+
+    pFDcpt->vlanTci = (tci & ~MAC_BRIDGE_VLAN_VID_MASK) | vlanId;
+    pFDcpt->untagMap = pVlan->untagMap;
+    return pVlan;
+}
+
+// checks if the received packet can be forwarded directly
+// a tag can be removed in place but there's no room to insert one
+// returns true if a bridge copy is needed
+static bool _MAC_Bridge_VlanNeedsCopy(const MAC_BRIDGE_FWD_DCPT* pFDcpt)
+{
+    if((pFDcpt->fwdFlags & MAC_BRIDGE_FWD_FLAG_TAGGED) != 0)
+    {
+        return false;
+    }
+
+    // untagged frame: some output port needs it tagged
+    return (pFDcpt->fwdMap32 & ~pFDcpt->untagMap) != 0;
+}
+
+// creates a tagged copy of the source packet
+// the tag is removed per output port, as needed
+static void _MAC_Bridge_VlanPacketCopy(TCPIP_MAC_PACKET* pSrcPkt, TCPIP_MAC_PACKET* pBridgePkt, const MAC_BRIDGE_FWD_DCPT* pFDcpt)
+{
+    uint8_t* pDst = pBridgePkt->pNetLayer;
+    uint8_t* srcStartAdd = pSrcPkt->pNetLayer;
+    uint16_t copyLen = pFDcpt->pktLen;
+    TCPIP_MAC_ETHERNET_HEADER* pSrcHdr = (TCPIP_MAC_ETHERNET_HEADER*)pSrcPkt->pMacLayer;
+    TCPIP_MAC_ETHERNET_HEADER* pDstHdr = (TCPIP_MAC_ETHERNET_HEADER*)pBridgePkt->pMacLayer;
+
+    if((pFDcpt->fwdFlags & MAC_BRIDGE_FWD_FLAG_TAGGED) != 0)
+    {   // the tag is copied with the payload
+        copyLen += MAC_BRIDGE_VLAN_TAG_SIZE;
+    }
+    else
+    {   // make room for the tag: the TCI is followed by the original type
+        memcpy(pDst + 2, &pSrcHdr->Type, sizeof(pSrcHdr->Type));
+        pDst += MAC_BRIDGE_VLAN_TAG_SIZE;
+    }
+
+    uint16_t copiedLen = TCPIP_Helper_PacketCopy(pSrcPkt, pDst, &srcStartAdd, copyLen, false);
+    if(copiedLen != copyLen)
+    {   // should NOT happen!
+        _Mac_Bridge_AssertCond(false, __func__, __LINE__);
+    }
+
+    // the TCI is set by _MAC_Bridge_VlanEgress
+    memcpy(pDstHdr, pSrcHdr, sizeof(pSrcHdr->DestMACAddr) + sizeof(pSrcHdr->SourceMACAddr));
+    pDstHdr->Type = TCPIP_Helper_htons(TCPIP_ETHER_TYPE_VLAN);
+
+    pBridgePkt->pDSeg->segLen = pFDcpt->pktLen + MAC_BRIDGE_VLAN_TAG_SIZE;
+}
+
+// sets the packet format for an output port
+// Only packets that start tagged are processed here:
+// the tag is removed in place by moving the MAC addresses over it
+// and put back by moving them back into place.
+// pMacLayer, segLoad, segLen follow the frame start;
+// the MAC driver acknowledges the RX packets by segLoad
+// so the tagged layout is restored before a packet is returned
+static void _MAC_Bridge_VlanEgress(TCPIP_MAC_PACKET* pPkt, const MAC_BRIDGE_FWD_DCPT* pFDcpt, bool txUntagged)
+{
+    uint8_t* pMac;
+    uint16_t pktFlags = _MAC_Bridge_GetPktFlags(pPkt);
+
+    if(txUntagged)
+    {
+        if((pktFlags & MAC_BRIDGE_ALLOC_FLAG_UNTAGGED) == 0)
+        {   // remove the tag
+            pMac = pPkt->pMacLayer;
+            memmove(pMac + MAC_BRIDGE_VLAN_TAG_SIZE, pMac, 2 * sizeof(TCPIP_MAC_ADDR));
+            pPkt->pMacLayer += MAC_BRIDGE_VLAN_TAG_SIZE;
+            pPkt->pDSeg->segLoad += MAC_BRIDGE_VLAN_TAG_SIZE;
+            pPkt->pDSeg->segLen -= MAC_BRIDGE_VLAN_TAG_SIZE;
+            _MAC_Bridge_SetPktFlags(pPkt, pktFlags | MAC_BRIDGE_ALLOC_FLAG_UNTAGGED);
+        }
+        return;
+    }
+
+    if((pktFlags & MAC_BRIDGE_ALLOC_FLAG_UNTAGGED) != 0)
+    {   // put the tag back
+        pPkt->pMacLayer -= MAC_BRIDGE_VLAN_TAG_SIZE;
+        pPkt->pDSeg->segLoad -= MAC_BRIDGE_VLAN_TAG_SIZE;
+        pPkt->pDSeg->segLen += MAC_BRIDGE_VLAN_TAG_SIZE;
+        pMac = pPkt->pMacLayer;
+        memmove(pMac, pMac + MAC_BRIDGE_VLAN_TAG_SIZE, 2 * sizeof(TCPIP_MAC_ADDR));
+        _MAC_Bridge_SetPktFlags(pPkt, pktFlags & ~MAC_BRIDGE_ALLOC_FLAG_UNTAGGED);
+    }
+
+    // always set the TPID + TCI: a priority tagged frame gets its VLAN ID
+    pMac = pPkt->pMacLayer + 2 * sizeof(TCPIP_MAC_ADDR);
+    pMac[0] = (uint8_t)(TCPIP_ETHER_TYPE_VLAN >> 8);
+    pMac[1] = (uint8_t)TCPIP_ETHER_TYPE_VLAN;
+    pMac[2] = (uint8_t)(pFDcpt->vlanTci >> 8);
+    pMac[3] = (uint8_t)pFDcpt->vlanTci;
+}
+
+// FDB lookup of a (MAC address, VLAN) pair
+// falls back to the VLAN independent static entry
+static MAC_BRIDGE_HASH_ENTRY* _MAC_Bridge_FDBLookup(MAC_BRIDGE_DCPT* pBDcpt, const TCPIP_MAC_ADDR* pAdd, uint16_t vlanId)
+{
+    MAC_BRIDGE_HASH_KEY key;
+    MAC_BRIDGE_HASH_ENTRY* hE;
+
+    memcpy(key.destAdd.v, pAdd->v, sizeof(key.destAdd));
+    key.vlanId = vlanId;
+    hE = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryLookup(pBDcpt->hashDcpt, &key);
+
+    if(hE == 0 && vlanId != 0)
+    {
+        key.vlanId = 0;
+        hE = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryLookup(pBDcpt->hashDcpt, &key);
+    }
+
+    return hE;
+}
+
+static MAC_BRIDGE_HASH_ENTRY* _MAC_Bridge_FDBInsert(MAC_BRIDGE_DCPT* pBDcpt, const TCPIP_MAC_ADDR* pAdd, uint16_t vlanId)
+{
+    MAC_BRIDGE_HASH_KEY key;
+
+    memcpy(key.destAdd.v, pAdd->v, sizeof(key.destAdd));
+    key.vlanId = vlanId;
+    return (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_EntryLookupOrInsert(pBDcpt->hashDcpt, &key);
+}
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+
+#if (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+// Rapid Spanning Tree, IEEE 802.1D-2004 clause 17
+// The port state machines are collapsed into a once per second tick + the BPDU reception:
+//  - port role selection based on the priority vectors
+//  - proposal/agreement handshake for the rapid transition of the designated and root ports
+//  - topology change detection/propagation with FDB flushing
+// Legacy STP BPDUs are understood but the bridge always transmits RST BPDUs
+
+static __inline__ uint16_t __attribute__((always_inline)) _MAC_Bridge_RstpGet16(const uint8_t* pBuff)
+{
+    return ((uint16_t)pBuff[0] << 8) | pBuff[1];
+}
+
+static __inline__ void __attribute__((always_inline)) _MAC_Bridge_RstpPut16(uint8_t* pBuff, uint16_t val)
+{
+    pBuff[0] = (uint8_t)(val >> 8);
+    pBuff[1] = (uint8_t)val;
+}
+
+static __inline__ uint32_t __attribute__((always_inline)) _MAC_Bridge_RstpGet32(const uint8_t* pBuff)
+{
+    return ((uint32_t)pBuff[0] << 24) | ((uint32_t)pBuff[1] << 16) | ((uint32_t)pBuff[2] << 8) | pBuff[3];
+}
+
+static __inline__ void __attribute__((always_inline)) _MAC_Bridge_RstpPut32(uint8_t* pBuff, uint32_t val)
+{
+    pBuff[0] = (uint8_t)(val >> 24);
+    pBuff[1] = (uint8_t)(val >> 16);
+    pBuff[2] = (uint8_t)(val >> 8);
+    pBuff[3] = (uint8_t)val;
+}
+
+// decrements a RSTP timer
+// returns true if the timer just expired
+static bool _MAC_Bridge_RstpTimerDec(uint8_t* pTimer, uint32_t elapsed)
+{
+    if(*pTimer == 0)
+    {
+        return false;
+    }
+
+    *pTimer = (*pTimer > elapsed) ? *pTimer - (uint8_t)elapsed : 0;
+    return *pTimer == 0;
+}
+
+static void _MAC_Bridge_RstpInit(MAC_BRIDGE_DCPT* pBDcpt)
+{
+    int portIx;
+    MAC_BRIDGE_PORT_DCPT* pPort;
+
+    // all ports start discarding; the bridge ID is set when the 1st port is up
+    for(portIx = 0; portIx < pBDcpt->nPorts; portIx++)
+    {
+        pPort = pBDcpt->portDcpt + portIx;
+        pPort->pathCost = TCPIP_MAC_BRIDGE_RSTP_PORT_PATH_COST;
+        pPort->portId = (MAC_BRIDGE_RSTP_PORT_PRIORITY << 8) | (portIx + 1);
+    }
+
+    pBDcpt->rootPort = -1;
+    pBDcpt->rootTimes.maxAge = TCPIP_MAC_BRIDGE_RSTP_MAX_AGE;
+    pBDcpt->rootTimes.helloTime = TCPIP_MAC_BRIDGE_RSTP_HELLO_TIME;
+    pBDcpt->rootTimes.fwdDelay = TCPIP_MAC_BRIDGE_RSTP_FORWARD_DELAY;
+}
+
+// sets the bridge ID using the MAC address of the 1st port that's up
+static bool _MAC_Bridge_RstpSetBridgeId(MAC_BRIDGE_DCPT* pBDcpt)
+{
+    int portIx;
+    TCPIP_NET_IF* pNetIf;
+
+    for(portIx = 0; portIx < pBDcpt->nPorts; portIx++)
+    {
+        if((pBDcpt->hostPortMask & (1ul << portIx)) != 0)
+        {
+            pNetIf = _TCPIPStackHandleToNet(TCPIP_STACK_IndexToNet(pBDcpt->port2IfIx[portIx]));
+            _MAC_Bridge_RstpPut16(pBDcpt->bridgeId, TCPIP_MAC_BRIDGE_RSTP_PRIORITY);
+            memcpy(pBDcpt->bridgeId + 2, _TCPIPStack_NetMACAddressGet(pNetIf), sizeof(TCPIP_MAC_ADDR));
+            pBDcpt->rstpFlags |= MAC_BRIDGE_RSTP_FLAG_ID_VALID;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// removes the FDB info learnt on the ports in the portMap
+static void _MAC_Bridge_RstpFlush(MAC_BRIDGE_DCPT* pBDcpt, uint32_t portMap)
+{
+    OA_HASH_ITERATOR hIter;
+    MAC_BRIDGE_HASH_ENTRY* hE;
+
+    _MAC_Bridge_FDBWriteBegin(pBDcpt);
+    TCPIP_OAHASH_IteratorInit(pBDcpt->hashDcpt, &hIter);
+    while((hE = (MAC_BRIDGE_HASH_ENTRY*)TCPIP_OAHASH_IteratorNext(pBDcpt->hashDcpt, &hIter)) != 0)
+    {
+        if((hE->hEntry.flags.value & MAC_BRIDGE_HFLAG_PORT_VALID) == 0)
+        {
+            continue;
+        }
+
+        if((portMap & (1ul << hE->learnPort)) != 0)
+        {
+            if((hE->hEntry.flags.value & MAC_BRIDGE_HFLAG_STATIC) == 0)
+            {   // dynamic entry: remove
+                TCPIP_OAHASH_EntryRemove(pBDcpt->hashDcpt, &hE->hEntry);
+            }
+            else
+            {   // static entry: forget the learnt port
+                hE->hEntry.flags.value &= ~MAC_BRIDGE_HFLAG_PORT_VALID;
+            }
+        }
+    }
+    _MAC_Bridge_FDBWriteEnd(pBDcpt);
+}
+
+// a topology change was detected (a non edge port became forwarding) on tcPort
+// or was received on tcPort
+// propagate it on the other ports and flush what was learnt on them
+static void _MAC_Bridge_RstpTopologyChange(MAC_BRIDGE_DCPT* pBDcpt, int tcPort, bool detected)
+{
+    int portIx;
+    MAC_BRIDGE_PORT_DCPT* pPort;
+    uint32_t flushMap = 0;
+
+    for(portIx = 0; portIx < pBDcpt->nPorts; portIx++)
+    {
+        pPort = pBDcpt->portDcpt + portIx;
+        if(portIx == tcPort && !detected)
+        {   // do not send it back
+            continue;
+        }
+
+        if((pPort->role == TCPIP_MAC_BRIDGE_PORT_ROLE_ROOT || pPort->role == TCPIP_MAC_BRIDGE_PORT_ROLE_DESIGNATED) && (pPort->portFlags & MAC_BRIDGE_RSTP_PFLAG_OPER_EDGE) == 0)
+        {
+            pPort->tcWhile = pBDcpt->rootTimes.helloTime + 1;
+            pPort->portFlags |= MAC_BRIDGE_RSTP_PFLAG_NEW_INFO;
+        }
+
+        if(portIx != tcPort)
+        {
+            flushMap |= 1ul << portIx;
+        }
+    }
+
+    _MAC_Bridge_RstpFlush(pBDcpt, flushMap);
+    pBDcpt->portDcpt[tcPort].tcCount++;
+    pBDcpt->tcCount++;
+    pBDcpt->tcSec = _MAC_Bridge_GetSecond();
+    _MAC_Bridge_NotifyEvent(pBDcpt, TCPIP_MAC_BRIDGE_EVENT_TOPOLOGY_CHANGE, (const void*)(uintptr_t)tcPort);
+}
+
+static void _MAC_Bridge_RstpSetState(MAC_BRIDGE_DCPT* pBDcpt, int portIx, TCPIP_MAC_BRIDGE_PORT_STATE newState)
+{
+    MAC_BRIDGE_PORT_DCPT* pPort = pBDcpt->portDcpt + portIx;
+    uint32_t portBit = 1ul << portIx;
+
+    if(pPort->state == newState)
+    {
+        return;
+    }
+
+    pPort->state = (uint8_t)newState;
+    pBDcpt->rstpLearnMap &= ~portBit;
+    pBDcpt->rstpFwdMap &= ~portBit;
+    if(newState != TCPIP_MAC_BRIDGE_PORT_STATE_DISCARDING)
+    {
+        pBDcpt->rstpLearnMap |= portBit;
+        if(newState == TCPIP_MAC_BRIDGE_PORT_STATE_FORWARDING)
+        {
+            pBDcpt->rstpFwdMap |= portBit;
+        }
+    }
+
+    _MAC_Bridge_NotifyEvent(pBDcpt, TCPIP_MAC_BRIDGE_EVENT_PORT_STATE, (const void*)(uintptr_t)((portIx << 8) | newState));
+
+    if(newState == TCPIP_MAC_BRIDGE_PORT_STATE_FORWARDING)
+    {
+        if((pPort->portFlags & MAC_BRIDGE_RSTP_PFLAG_OPER_EDGE) == 0)
+        {
+            _MAC_Bridge_RstpTopologyChange(pBDcpt, portIx, true);
+        }
+    }
+    else if(newState == TCPIP_MAC_BRIDGE_PORT_STATE_DISCARDING)
+    {   // what was learnt on this port is no longer valid
+        _MAC_Bridge_RstpFlush(pBDcpt, portBit);
+    }
+}
+
+// a new root port needs to be forwarding:
+// block the designated ports that are not known to be safe and ask them to propose
+static void _MAC_Bridge_RstpSync(MAC_BRIDGE_DCPT* pBDcpt, int rootPort)
+{
+    int portIx;
+    MAC_BRIDGE_PORT_DCPT* pPort;
+
+    for(portIx = 0; portIx < pBDcpt->nPorts; portIx++)
+    {
+        pPort = pBDcpt->portDcpt + portIx;
+        if(portIx == rootPort || pPort->role != TCPIP_MAC_BRIDGE_PORT_ROLE_DESIGNATED)
+        {
+            continue;
+        }
+
+        if((pPort->portFlags & (MAC_BRIDGE_RSTP_PFLAG_OPER_EDGE | MAC_BRIDGE_RSTP_PFLAG_AGREED)) == 0)
+        {
+            _MAC_Bridge_RstpSetState(pBDcpt, portIx, TCPIP_MAC_BRIDGE_PORT_STATE_DISCARDING);
+            pPort->fdWhile = pBDcpt->rootTimes.fwdDelay;
+            pPort->portFlags |= MAC_BRIDGE_RSTP_PFLAG_PROPOSING | MAC_BRIDGE_RSTP_PFLAG_NEW_INFO;
+        }
+    }
+}
+
+static void _MAC_Bridge_RstpSetRole(MAC_BRIDGE_DCPT* pBDcpt, int portIx, TCPIP_MAC_BRIDGE_PORT_ROLE newRole)
+{
+    MAC_BRIDGE_PORT_DCPT* pPort = pBDcpt->portDcpt + portIx;
+
+    if(pPort->role == newRole)
+    {
+        return;
+    }
+
+    pPort->role = (uint8_t)newRole;
+    pPort->portFlags &= ~(MAC_BRIDGE_RSTP_PFLAG_PROPOSING | MAC_BRIDGE_RSTP_PFLAG_PROPOSED | MAC_BRIDGE_RSTP_PFLAG_AGREE | MAC_BRIDGE_RSTP_PFLAG_AGREED);
+
+    switch(newRole)
+    {
+        case TCPIP_MAC_BRIDGE_PORT_ROLE_ROOT:
+            // the previous root port, if any, is already blocked
+            _MAC_Bridge_RstpSync(pBDcpt, portIx);
+            _MAC_Bridge_RstpSetState(pBDcpt, portIx, TCPIP_MAC_BRIDGE_PORT_STATE_FORWARDING);
+            break;
+
+        case TCPIP_MAC_BRIDGE_PORT_ROLE_DESIGNATED:
+            pPort->portFlags |= MAC_BRIDGE_RSTP_PFLAG_NEW_INFO;
+            pPort->helloWhen = 0;
+            if(pPort->state != TCPIP_MAC_BRIDGE_PORT_STATE_FORWARDING)
+            {
+                if((pPort->portFlags & MAC_BRIDGE_RSTP_PFLAG_OPER_EDGE) != 0)
+                {
+                    _MAC_Bridge_RstpSetState(pBDcpt, portIx, TCPIP_MAC_BRIDGE_PORT_STATE_FORWARDING);
+                }
+                else
+                {
+                    pPort->portFlags |= MAC_BRIDGE_RSTP_PFLAG_PROPOSING;
+                    pPort->fdWhile = pBDcpt->rootTimes.fwdDelay;
+                }
+            }
+            break;
+
+        default:
+            // disabled, alternate, backup
+            pPort->fdWhile = pBDcpt->rootTimes.fwdDelay;
+            _MAC_Bridge_RstpSetState(pBDcpt, portIx, TCPIP_MAC_BRIDGE_PORT_STATE_DISCARDING);
+            break;
+    }
+}
+
+// the priority vector of this bridge as a root
+static void _MAC_Bridge_RstpBridgeVector(MAC_BRIDGE_DCPT* pBDcpt, MAC_BRIDGE_RSTP_VECTOR* pVector)
+{
+    memset(pVector, 0, sizeof(*pVector));
+    memcpy(pVector->rootId, pBDcpt->bridgeId, sizeof(pVector->rootId));
+    memcpy(pVector->designatedId, pBDcpt->bridgeId, sizeof(pVector->designatedId));
+}
+
+// port role selection
+static void _MAC_Bridge_RstpSelectRoles(MAC_BRIDGE_DCPT* pBDcpt)
+{
+    int portIx;
+    MAC_BRIDGE_PORT_DCPT* pPort;
+    MAC_BRIDGE_RSTP_VECTOR rootVector, candVector;
+    uint8_t newRole[TCPIP_MAC_BRIDGE_MAX_PORTS_NO];
+    int rootPort = -1;
+
+    pBDcpt->rstpFlags &= ~MAC_BRIDGE_RSTP_FLAG_RESELECT;
+
+    // select the root port: the best vector received through an enabled port
+    _MAC_Bridge_RstpBridgeVector(pBDcpt, &rootVector);
+    for(portIx = 0; portIx < pBDcpt->nPorts; portIx++)
+    {
+        pPort = pBDcpt->portDcpt + portIx;
+        if((pPort->portFlags & MAC_BRIDGE_RSTP_PFLAG_ENABLED) == 0 || pPort->infoIs != MAC_BRIDGE_RSTP_INFO_RECEIVED)
+        {
+            continue;
+        }
+        if(memcmp(pPort->portPrio.designatedId + 2, pBDcpt->bridgeId + 2, sizeof(TCPIP_MAC_ADDR)) == 0)
+        {   // our own info looped back
+            continue;
+        }
+
+        candVector = pPort->portPrio;
+        _MAC_Bridge_RstpPut32(candVector.rootPathCost, _MAC_Bridge_RstpGet32(candVector.rootPathCost) + pPort->pathCost);
+        _MAC_Bridge_RstpPut16(candVector.bridgePort, pPort->portId);
+        if(memcmp(&candVector, &rootVector, sizeof(candVector)) < 0)
+        {
+            rootVector = candVector;
+            rootPort = portIx;
+        }
+    }
+
+    pBDcpt->rootPrio = rootVector;
+    pBDcpt->rootPort = (int8_t)rootPort;
+    if(rootPort >= 0)
+    {
+        pBDcpt->rootTimes = pBDcpt->portDcpt[rootPort].portTimes;
+        pBDcpt->rootTimes.messageAge++;
+    }
+    else
+    {
+        memset(&pBDcpt->rootTimes, 0, sizeof(pBDcpt->rootTimes));
+        pBDcpt->rootTimes.maxAge = TCPIP_MAC_BRIDGE_RSTP_MAX_AGE;
+        pBDcpt->rootTimes.helloTime = TCPIP_MAC_BRIDGE_RSTP_HELLO_TIME;
+        pBDcpt->rootTimes.fwdDelay = TCPIP_MAC_BRIDGE_RSTP_FORWARD_DELAY;
+    }
+
+    // compute the designated vectors and the port roles
+    for(portIx = 0; portIx < pBDcpt->nPorts; portIx++)
+    {
+        pPort = pBDcpt->portDcpt + portIx;
+        memcpy(pPort->desgPrio.rootId, rootVector.rootId, sizeof(rootVector.rootId));
+        memcpy(pPort->desgPrio.rootPathCost, rootVector.rootPathCost, sizeof(rootVector.rootPathCost));
+        memcpy(pPort->desgPrio.designatedId, pBDcpt->bridgeId, sizeof(pBDcpt->bridgeId));
+        _MAC_Bridge_RstpPut16(pPort->desgPrio.designatedPort, pPort->portId);
+        _MAC_Bridge_RstpPut16(pPort->desgPrio.bridgePort, pPort->portId);
+
+        if((pPort->portFlags & MAC_BRIDGE_RSTP_PFLAG_ENABLED) == 0)
+        {
+            newRole[portIx] = TCPIP_MAC_BRIDGE_PORT_ROLE_DISABLED;
+        }
+        else if(portIx == rootPort)
+        {
+            newRole[portIx] = TCPIP_MAC_BRIDGE_PORT_ROLE_ROOT;
+        }
+        else if(pPort->infoIs != MAC_BRIDGE_RSTP_INFO_RECEIVED || memcmp(&pPort->desgPrio, &pPort->portPrio, MAC_BRIDGE_RSTP_MSG_VECTOR_SIZE) < 0)
+        {
+            newRole[portIx] = TCPIP_MAC_BRIDGE_PORT_ROLE_DESIGNATED;
+            if(pPort->infoIs != MAC_BRIDGE_RSTP_INFO_MINE || memcmp(&pPort->desgPrio, &pPort->portPrio, MAC_BRIDGE_RSTP_MSG_VECTOR_SIZE) != 0)
+            {   // new info: the neighbor needs to agree again
+                pPort->portFlags &= ~MAC_BRIDGE_RSTP_PFLAG_AGREED;
+                pPort->portFlags |= MAC_BRIDGE_RSTP_PFLAG_NEW_INFO;
+            }
+            pPort->portPrio = pPort->desgPrio;
+            pPort->portTimes = pBDcpt->rootTimes;
+            pPort->infoIs = MAC_BRIDGE_RSTP_INFO_MINE;
+        }
+        else if(memcmp(pPort->portPrio.designatedId, pBDcpt->bridgeId, sizeof(pBDcpt->bridgeId)) == 0)
+        {   // another port of this bridge is designated for the LAN
+            newRole[portIx] = TCPIP_MAC_BRIDGE_PORT_ROLE_BACKUP;
+        }
+        else
+        {
+            newRole[portIx] = TCPIP_MAC_BRIDGE_PORT_ROLE_ALTERNATE;
+        }
+    }
+
+    // apply the new roles: block first, then the designated ports, the root port last
+    for(portIx = 0; portIx < pBDcpt->nPorts; portIx++)
+    {
+        if(newRole[portIx] != TCPIP_MAC_BRIDGE_PORT_ROLE_ROOT && newRole[portIx] != TCPIP_MAC_BRIDGE_PORT_ROLE_DESIGNATED)
+        {
+            _MAC_Bridge_RstpSetRole(pBDcpt, portIx, (TCPIP_MAC_BRIDGE_PORT_ROLE)newRole[portIx]);
+        }
+    }
+    for(portIx = 0; portIx < pBDcpt->nPorts; portIx++)
+    {
+        if(newRole[portIx] == TCPIP_MAC_BRIDGE_PORT_ROLE_DESIGNATED)
+        {
+            _MAC_Bridge_RstpSetRole(pBDcpt, portIx, TCPIP_MAC_BRIDGE_PORT_ROLE_DESIGNATED);
+        }
+    }
+    if(rootPort >= 0)
+    {
+        _MAC_Bridge_RstpSetRole(pBDcpt, rootPort, TCPIP_MAC_BRIDGE_PORT_ROLE_ROOT);
+    }
+}
+
+static void _MAC_Bridge_RstpPortEnable(MAC_BRIDGE_DCPT* pBDcpt, int portIx)
+{
+    MAC_BRIDGE_PORT_DCPT* pPort = pBDcpt->portDcpt + portIx;
+
+    pPort->portFlags = MAC_BRIDGE_RSTP_PFLAG_ENABLED | (pPort->adminEdge != 0 ? MAC_BRIDGE_RSTP_PFLAG_OPER_EDGE : 0);
+    pPort->infoIs = MAC_BRIDGE_RSTP_INFO_AGED;
+    pPort->edgeDelayWhile = MAC_BRIDGE_RSTP_MIGRATE_TIME;
+    pPort->fdWhile = pBDcpt->rootTimes.fwdDelay;
+    pPort->helloWhen = pPort->tcWhile = pPort->rcvdInfoWhile = pPort->txCount = 0;
+    pBDcpt->rstpFlags |= MAC_BRIDGE_RSTP_FLAG_RESELECT;
+}
+
+static void _MAC_Bridge_RstpPortDisable(MAC_BRIDGE_DCPT* pBDcpt, int portIx)
+{
+    MAC_BRIDGE_PORT_DCPT* pPort = pBDcpt->portDcpt + portIx;
+
+    pPort->portFlags = 0;
+    pPort->infoIs = MAC_BRIDGE_RSTP_INFO_DISABLED;
+    _MAC_Bridge_RstpSetRole(pBDcpt, portIx, TCPIP_MAC_BRIDGE_PORT_ROLE_DISABLED);
+    pBDcpt->rstpFlags |= MAC_BRIDGE_RSTP_FLAG_RESELECT;
+}
+
+static void _MAC_Bridge_RstpTxAck(TCPIP_MAC_PACKET* pPkt,  const void* param)
+{
+    TCPIP_PKT_PacketFree(pPkt);
+}
+
+static void _MAC_Bridge_RstpTxBpdu(MAC_BRIDGE_DCPT* pBDcpt, int portIx)
+{
+    MAC_BRIDGE_PORT_DCPT* pPort = pBDcpt->portDcpt + portIx;
+    TCPIP_NET_IF* pNetIf;
+    TCPIP_MAC_PACKET* pPkt;
+    MAC_BRIDGE_RSTP_BPDU* pBpdu;
+    uint8_t flags;
+
+    if(pPort->txCount >= MAC_BRIDGE_RSTP_TX_HOLD_COUNT)
+    {   // retry on the next tick
+        return;
+    }
+
+    pNetIf = _TCPIPStackHandleToNet(TCPIP_STACK_IndexToNet(pBDcpt->port2IfIx[portIx]));
+    if(!TCPIP_STACK_NetworkIsUp(pNetIf))
+    {
+        return;
+    }
+
+    pPkt = TCPIP_PKT_PacketAlloc(sizeof(TCPIP_MAC_PACKET), sizeof(MAC_BRIDGE_RSTP_BPDU), TCPIP_MAC_PKT_FLAG_TX | TCPIP_MAC_PKT_FLAG_MCAST);
+    if(pPkt == 0)
+    {   // out of memory; retry on the next tick
+        return;
+    }
+    TCPIP_PKT_PacketAcknowledgeSet(pPkt, _MAC_Bridge_RstpTxAck, 0);
+
+    pBpdu = (MAC_BRIDGE_RSTP_BPDU*)pPkt->pNetLayer;
+    memset(pBpdu, 0, sizeof(*pBpdu));
+    pBpdu->dsap = pBpdu->ssap = MAC_BRIDGE_RSTP_LLC_SAP;
+    pBpdu->llcCtrl = MAC_BRIDGE_RSTP_LLC_UI;
+    pBpdu->version = MAC_BRIDGE_RSTP_VERSION;
+    pBpdu->bpduType = MAC_BRIDGE_RSTP_BPDU_TYPE_RST;
+
+    flags = 0;
+    if(pPort->tcWhile != 0)
+    {
+        flags |= MAC_BRIDGE_RSTP_BFLAG_TC;
+    }
+    if(pPort->role == TCPIP_MAC_BRIDGE_PORT_ROLE_ROOT)
+    {
+        flags |= MAC_BRIDGE_RSTP_BPDU_ROLE_ROOT << MAC_BRIDGE_RSTP_BFLAG_ROLE_SHIFT;
+    }
+    else if(pPort->role == TCPIP_MAC_BRIDGE_PORT_ROLE_DESIGNATED)
+    {
+        flags |= MAC_BRIDGE_RSTP_BPDU_ROLE_DESIGNATED << MAC_BRIDGE_RSTP_BFLAG_ROLE_SHIFT;
+        if((pPort->portFlags & MAC_BRIDGE_RSTP_PFLAG_PROPOSING) != 0)
+        {
+            flags |= MAC_BRIDGE_RSTP_BFLAG_PROPOSAL;
+        }
+    }
+    else
+    {
+        flags |= MAC_BRIDGE_RSTP_BPDU_ROLE_ALT_BACKUP << MAC_BRIDGE_RSTP_BFLAG_ROLE_SHIFT;
+    }
+    if((pPort->portFlags & MAC_BRIDGE_RSTP_PFLAG_AGREE) != 0)
+    {
+        flags |= MAC_BRIDGE_RSTP_BFLAG_AGREEMENT;
+    }
+    if(pPort->state != TCPIP_MAC_BRIDGE_PORT_STATE_DISCARDING)
+    {
+        flags |= MAC_BRIDGE_RSTP_BFLAG_LEARNING;
+        if(pPort->state == TCPIP_MAC_BRIDGE_PORT_STATE_FORWARDING)
+        {
+            flags |= MAC_BRIDGE_RSTP_BFLAG_FORWARDING;
+        }
+    }
+    pBpdu->flags = flags;
+
+    // the alternate/backup ports carry the received info
+    memcpy(pBpdu->msgVector, pPort->role == TCPIP_MAC_BRIDGE_PORT_ROLE_ROOT || pPort->role == TCPIP_MAC_BRIDGE_PORT_ROLE_DESIGNATED ? &pPort->desgPrio : &pPort->portPrio, sizeof(pBpdu->msgVector));
+    // times in 1/256 seconds
+    pBpdu->messageAge[0] = pBDcpt->rootTimes.messageAge;
+    pBpdu->maxAge[0] = pBDcpt->rootTimes.maxAge;
+    pBpdu->helloTime[0] = pBDcpt->rootTimes.helloTime;
+    pBpdu->fwdDelay[0] = pBDcpt->rootTimes.fwdDelay;
+
+    pPkt->pDSeg->segLen = sizeof(MAC_BRIDGE_RSTP_BPDU);
+    // 802.3 frame: the type field is the payload length
+    TCPIP_PKT_PacketMACFormat(pPkt, (const TCPIP_MAC_ADDR*)bridge_reserved_address, (const TCPIP_MAC_ADDR*)_TCPIPStack_NetMACAddressGet(pNetIf), sizeof(MAC_BRIDGE_RSTP_BPDU));
+    pPkt->next = 0;
+
+    if(_TCPIPStackPacketTx(pNetIf, pPkt) < 0)
+    {   // failed; retry on the next tick
+        TCPIP_PKT_PacketFree(pPkt);
+        return;
+    }
+
+    pPort->txCount++;
+    pPort->txBpdus++;
+    pPort->portFlags &= ~MAC_BRIDGE_RSTP_PFLAG_NEW_INFO;
+}
+
+// transmits the pending BPDUs
+static void _MAC_Bridge_RstpTxPending(MAC_BRIDGE_DCPT* pBDcpt)
+{
+    int portIx;
+    MAC_BRIDGE_PORT_DCPT* pPort;
+
+    for(portIx = 0; portIx < pBDcpt->nPorts; portIx++)
+    {
+        pPort = pBDcpt->portDcpt + portIx;
+        if((pPort->portFlags & (MAC_BRIDGE_RSTP_PFLAG_ENABLED | MAC_BRIDGE_RSTP_PFLAG_NEW_INFO)) != (MAC_BRIDGE_RSTP_PFLAG_ENABLED | MAC_BRIDGE_RSTP_PFLAG_NEW_INFO))
+        {
+            continue;
+        }
+
+        if(pPort->role == TCPIP_MAC_BRIDGE_PORT_ROLE_ROOT || pPort->role == TCPIP_MAC_BRIDGE_PORT_ROLE_DESIGNATED || (pPort->portFlags & MAC_BRIDGE_RSTP_PFLAG_AGREE) != 0)
+        {
+            _MAC_Bridge_RstpTxBpdu(pBDcpt, portIx);
+        }
+        else
+        {   // alternate/backup ports are silent
+            pPort->portFlags &= ~MAC_BRIDGE_RSTP_PFLAG_NEW_INFO;
+        }
+    }
+}
+
+// RSTP tick, once per second
+// applies the port configuration changes requested by TCPIP_MAC_Bridge_RstpPortSet()
+static void _MAC_Bridge_RstpPortConfig(MAC_BRIDGE_DCPT* pBDcpt)
+{
+    int portIx;
+    uint32_t cfgMask;
+    MAC_BRIDGE_PORT_DCPT* pPort;
+    TCPIP_MAC_BRIDGE_RSTP_PORT_CONFIG portCfg[TCPIP_MAC_BRIDGE_MAX_PORTS_NO];
+
+    OSAL_CRITSECT_DATA_TYPE critStat = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+    cfgMask = pBDcpt->rstpCfgMask;
+    pBDcpt->rstpCfgMask = 0;
+    if(cfgMask != 0)
+    {
+        memcpy(portCfg, pBDcpt->rstpPortCfg, sizeof(portCfg));
+    }
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, critStat);
+
+    if(cfgMask == 0)
+    {
+        return;
+    }
+
+    for(portIx = 0; portIx < pBDcpt->nPorts; portIx++)
+    {
+        if((cfgMask & (1ul << portIx)) != 0)
+        {
+            pPort = pBDcpt->portDcpt + portIx;
+            pPort->pathCost = portCfg[portIx].pathCost != 0 ? portCfg[portIx].pathCost : TCPIP_MAC_BRIDGE_RSTP_PORT_PATH_COST;
+            pPort->portId = ((uint16_t)portCfg[portIx].portPriority << 8) | (portIx + 1);
+            pPort->adminEdge = portCfg[portIx].adminEdge != 0;
+        }
+    }
+
+    pBDcpt->rstpFlags |= MAC_BRIDGE_RSTP_FLAG_RESELECT;
+}
+
+static void _MAC_Bridge_RstpTask(MAC_BRIDGE_DCPT* pBDcpt, uint32_t currSec)
+{
+    int portIx;
+    bool portUp;
+    TCPIP_NET_IF* pNetIf;
+    MAC_BRIDGE_PORT_DCPT* pPort;
+    uint32_t elapsed = currSec - pBDcpt->rstpSec;
+
+    _MAC_Bridge_RstpPortConfig(pBDcpt);
+
+    if(elapsed == 0)
+    {
+        return;
+    }
+    pBDcpt->rstpSec = currSec;
+    if(elapsed > 255)
+    {
+        elapsed = 255;
+    }
+
+    if((pBDcpt->rstpFlags & MAC_BRIDGE_RSTP_FLAG_ID_VALID) == 0)
+    {
+        if(!_MAC_Bridge_RstpSetBridgeId(pBDcpt))
+        {   // no port up yet
+            return;
+        }
+    }
+
+    for(portIx = 0; portIx < pBDcpt->nPorts; portIx++)
+    {
+        pPort = pBDcpt->portDcpt + portIx;
+        pNetIf = _TCPIPStackHandleToNet(TCPIP_STACK_IndexToNet(pBDcpt->port2IfIx[portIx]));
+        portUp = (pBDcpt->hostPortMask & (1ul << portIx)) != 0 && TCPIP_STACK_NetworkIsUp(pNetIf) && TCPIP_STACK_NetworkIsLinked(pNetIf);
+
+        if(portUp != ((pPort->portFlags & MAC_BRIDGE_RSTP_PFLAG_ENABLED) != 0))
+        {
+            if(portUp)
+            {
+                _MAC_Bridge_RstpPortEnable(pBDcpt, portIx);
+            }
+            else
+            {
+                _MAC_Bridge_RstpPortDisable(pBDcpt, portIx);
+            }
+        }
+
+        if(!portUp)
+        {
+            continue;
+        }
+
+        _MAC_Bridge_RstpTimerDec(&pPort->helloWhen, elapsed);
+        _MAC_Bridge_RstpTimerDec(&pPort->fdWhile, elapsed);
+        _MAC_Bridge_RstpTimerDec(&pPort->tcWhile, elapsed);
+        _MAC_Bridge_RstpTimerDec(&pPort->edgeDelayWhile, elapsed);
+        pPort->txCount = 0;
+        if(_MAC_Bridge_RstpTimerDec(&pPort->rcvdInfoWhile, elapsed) && pPort->infoIs == MAC_BRIDGE_RSTP_INFO_RECEIVED)
+        {   // the designated bridge is gone
+            pPort->infoIs = MAC_BRIDGE_RSTP_INFO_AGED;
+            pBDcpt->rstpFlags |= MAC_BRIDGE_RSTP_FLAG_RESELECT;
+        }
+
+        if(pPort->adminEdge != 0 && (pPort->portFlags & MAC_BRIDGE_RSTP_PFLAG_OPER_EDGE) == 0 && pPort->edgeDelayWhile == 0)
+        {   // no more BPDUs on an edge port
+            pPort->portFlags |= MAC_BRIDGE_RSTP_PFLAG_OPER_EDGE;
+        }
+    }
+
+    if((pBDcpt->rstpFlags & MAC_BRIDGE_RSTP_FLAG_RESELECT) != 0)
+    {
+        _MAC_Bridge_RstpSelectRoles(pBDcpt);
+    }
+
+    // designated ports transitions
+    for(portIx = 0; portIx < pBDcpt->nPorts; portIx++)
+    {
+        pPort = pBDcpt->portDcpt + portIx;
+        if(pPort->role != TCPIP_MAC_BRIDGE_PORT_ROLE_DESIGNATED)
+        {
+            continue;
+        }
+
+        if(pPort->state != TCPIP_MAC_BRIDGE_PORT_STATE_FORWARDING)
+        {
+            if((pPort->portFlags & MAC_BRIDGE_RSTP_PFLAG_PROPOSING) != 0 && pPort->edgeDelayWhile == 0)
+            {   // no bridge answered our proposals
+                pPort->portFlags |= MAC_BRIDGE_RSTP_PFLAG_OPER_EDGE;
+            }
+
+            if((pPort->portFlags & (MAC_BRIDGE_RSTP_PFLAG_OPER_EDGE | MAC_BRIDGE_RSTP_PFLAG_AGREED)) != 0)
+            {
+                pPort->portFlags &= ~MAC_BRIDGE_RSTP_PFLAG_PROPOSING;
+                _MAC_Bridge_RstpSetState(pBDcpt, portIx, TCPIP_MAC_BRIDGE_PORT_STATE_FORWARDING);
+            }
+            else if(pPort->fdWhile == 0)
+            {   // no agreement: slow transition
+                pPort->fdWhile = pBDcpt->rootTimes.fwdDelay;
+                _MAC_Bridge_RstpSetState(pBDcpt, portIx, pPort->state == TCPIP_MAC_BRIDGE_PORT_STATE_DISCARDING ? TCPIP_MAC_BRIDGE_PORT_STATE_LEARNING : TCPIP_MAC_BRIDGE_PORT_STATE_FORWARDING);
+            }
+        }
+
+        if(pPort->helloWhen == 0)
+        {
+            pPort->portFlags |= MAC_BRIDGE_RSTP_PFLAG_NEW_INFO;
+            pPort->helloWhen = pBDcpt->rootTimes.helloTime;
+        }
+    }
+
+    _MAC_Bridge_RstpTxPending(pBDcpt);
+}
+
+// processes a BPDU received on inPort
+static void _MAC_Bridge_RstpRxBpdu(MAC_BRIDGE_DCPT* pBDcpt, TCPIP_MAC_PACKET* pRxPkt, uint8_t inPort)
+{
+    MAC_BRIDGE_PORT_DCPT* pPort = pBDcpt->portDcpt + inPort;
+    TCPIP_MAC_ETHERNET_HEADER* pMacHdr = (TCPIP_MAC_ETHERNET_HEADER*)pRxPkt->pMacLayer;
+    MAC_BRIDGE_RSTP_BPDU* pBpdu = (MAC_BRIDGE_RSTP_BPDU*)pRxPkt->pNetLayer;
+    TCPIP_NET_IF* pNetIf;
+    uint16_t bpduLen;
+    uint8_t bpduRole, bpduFlags;
+    int cmpRes;
+
+    if((pPort->portFlags & MAC_BRIDGE_RSTP_PFLAG_ENABLED) == 0)
+    {
+        return;
+    }
+
+    pNetIf = _TCPIPStackHandleToNet(TCPIP_STACK_IndexToNet(pBDcpt->port2IfIx[inPort]));
+    if(memcmp(pMacHdr->SourceMACAddr.v, _TCPIPStack_NetMACAddressGet(pNetIf), sizeof(TCPIP_MAC_ADDR)) == 0)
+    {   // our own BPDU reflected by the AP
+        return;
+    }
+
+    // 802.3 frame with LLC header
+    bpduLen = TCPIP_Helper_ntohs(pMacHdr->Type);
+    // Note: the MAC driver excludes the Ethernet header from segLen
+    if(bpduLen >= 0x600 || bpduLen > pRxPkt->pDSeg->segLen)
+    {
+        return;
+    }
+    if(bpduLen < MAC_BRIDGE_RSTP_TCN_BPDU_SIZE + 3 || pBpdu->dsap != MAC_BRIDGE_RSTP_LLC_SAP || pBpdu->ssap != MAC_BRIDGE_RSTP_LLC_SAP || pBpdu->llcCtrl != MAC_BRIDGE_RSTP_LLC_UI)
+    {
+        return;
+    }
+    if(pBpdu->protocolId[0] != 0 || pBpdu->protocolId[1] != 0)
+    {
+        return;
+    }
+    bpduLen -= 3;   // LLC
+
+    pPort->rxBpdus++;
+    // a bridge is present on the port LAN
+    pPort->edgeDelayWhile = MAC_BRIDGE_RSTP_MIGRATE_TIME;
+    pPort->portFlags &= ~MAC_BRIDGE_RSTP_PFLAG_OPER_EDGE;
+
+    if(pBpdu->bpduType == MAC_BRIDGE_RSTP_BPDU_TYPE_TCN)
+    {
+        if(pPort->role == TCPIP_MAC_BRIDGE_PORT_ROLE_DESIGNATED)
+        {
+            _MAC_Bridge_RstpTopologyChange(pBDcpt, inPort, false);
+        }
+        _MAC_Bridge_RstpTxPending(pBDcpt);
+        return;
+    }
+
+    if(pBpdu->bpduType == MAC_BRIDGE_RSTP_BPDU_TYPE_CONFIG && bpduLen >= MAC_BRIDGE_RSTP_CONFIG_BPDU_SIZE)
+    {   // legacy bridge: always designated, no handshake
+        bpduFlags = pBpdu->flags & MAC_BRIDGE_RSTP_BFLAG_TC;
+        bpduRole = MAC_BRIDGE_RSTP_BPDU_ROLE_DESIGNATED;
+    }
+    else if(pBpdu->bpduType == MAC_BRIDGE_RSTP_BPDU_TYPE_RST && bpduLen >= MAC_BRIDGE_RSTP_RST_BPDU_SIZE && pBpdu->version >= MAC_BRIDGE_RSTP_VERSION)
+    {
+        bpduFlags = pBpdu->flags;
+        bpduRole = (bpduFlags & MAC_BRIDGE_RSTP_BFLAG_ROLE_MASK) >> MAC_BRIDGE_RSTP_BFLAG_ROLE_SHIFT;
+    }
+    else
+    {   // unknown
+        return;
+    }
+
+    if(pBpdu->messageAge[0] >= pBpdu->maxAge[0])
+    {   // stale info
+        return;
+    }
+
+    cmpRes = memcmp(pBpdu->msgVector, &pPort->portPrio, MAC_BRIDGE_RSTP_MSG_VECTOR_SIZE);
+    if(bpduRole == MAC_BRIDGE_RSTP_BPDU_ROLE_DESIGNATED)
+    {
+        MAC_BRIDGE_RSTP_VECTOR* pMsgVector = (MAC_BRIDGE_RSTP_VECTOR*)pBpdu->msgVector;
+        bool sameDesignated = pPort->infoIs == MAC_BRIDGE_RSTP_INFO_RECEIVED &&
+                              memcmp(pMsgVector->designatedId, pPort->portPrio.designatedId, sizeof(pMsgVector->designatedId)) == 0 &&
+                              memcmp(pMsgVector->designatedPort, pPort->portPrio.designatedPort, sizeof(pMsgVector->designatedPort)) == 0;
+
+        if(cmpRes < 0 || sameDesignated || pPort->infoIs == MAC_BRIDGE_RSTP_INFO_AGED)
+        {   // superior or updated info from the designated bridge
+            if(cmpRes != 0 || pPort->infoIs != MAC_BRIDGE_RSTP_INFO_RECEIVED)
+            {
+                memcpy(&pPort->portPrio, pBpdu->msgVector, MAC_BRIDGE_RSTP_MSG_VECTOR_SIZE);
+                pPort->portFlags &= ~(MAC_BRIDGE_RSTP_PFLAG_AGREED | MAC_BRIDGE_RSTP_PFLAG_PROPOSING | MAC_BRIDGE_RSTP_PFLAG_AGREE);
+                pBDcpt->rstpFlags |= MAC_BRIDGE_RSTP_FLAG_RESELECT;
+            }
+            pPort->portTimes.messageAge = pBpdu->messageAge[0];
+            pPort->portTimes.maxAge = pBpdu->maxAge[0];
+            pPort->portTimes.helloTime = pBpdu->helloTime[0];
+            pPort->portTimes.fwdDelay = pBpdu->fwdDelay[0];
+            pPort->infoIs = MAC_BRIDGE_RSTP_INFO_RECEIVED;
+            pPort->rcvdInfoWhile = 3 * pPort->portTimes.helloTime;
+            if((bpduFlags & MAC_BRIDGE_RSTP_BFLAG_PROPOSAL) != 0)
+            {
+                pPort->portFlags |= MAC_BRIDGE_RSTP_PFLAG_PROPOSED;
+            }
+        }
+        else if(cmpRes > 0 && pPort->role == TCPIP_MAC_BRIDGE_PORT_ROLE_DESIGNATED)
+        {   // inferior designated info: let the sender know ours
+            pPort->portFlags |= MAC_BRIDGE_RSTP_PFLAG_NEW_INFO;
+        }
+    }
+    else if((bpduFlags & MAC_BRIDGE_RSTP_BFLAG_AGREEMENT) != 0 && pPort->role == TCPIP_MAC_BRIDGE_PORT_ROLE_DESIGNATED)
+    {   // root or alternate/backup port agreeing to our proposal
+        if(memcmp(pBpdu->msgVector, pPort->desgPrio.rootId, sizeof(pPort->desgPrio.rootId)) == 0)
+        {
+            pPort->portFlags |= MAC_BRIDGE_RSTP_PFLAG_AGREED;
+            pPort->portFlags &= ~MAC_BRIDGE_RSTP_PFLAG_PROPOSING;
+            _MAC_Bridge_RstpSetState(pBDcpt, inPort, TCPIP_MAC_BRIDGE_PORT_STATE_FORWARDING);
+        }
+    }
+
+    if((pBDcpt->rstpFlags & MAC_BRIDGE_RSTP_FLAG_RESELECT) != 0)
+    {
+        _MAC_Bridge_RstpSelectRoles(pBDcpt);
+    }
+
+    if((bpduFlags & MAC_BRIDGE_RSTP_BFLAG_TC) != 0 && (pPort->role == TCPIP_MAC_BRIDGE_PORT_ROLE_ROOT || pPort->role == TCPIP_MAC_BRIDGE_PORT_ROLE_DESIGNATED))
+    {
+        _MAC_Bridge_RstpTopologyChange(pBDcpt, inPort, false);
+    }
+
+    if((pPort->portFlags & MAC_BRIDGE_RSTP_PFLAG_PROPOSED) != 0)
+    {
+        if(pPort->role == TCPIP_MAC_BRIDGE_PORT_ROLE_ROOT)
+        {   // block the downstream ports then agree
+            _MAC_Bridge_RstpSync(pBDcpt, inPort);
+            pPort->portFlags |= MAC_BRIDGE_RSTP_PFLAG_AGREE | MAC_BRIDGE_RSTP_PFLAG_NEW_INFO;
+        }
+        else if(pPort->role == TCPIP_MAC_BRIDGE_PORT_ROLE_ALTERNATE || pPort->role == TCPIP_MAC_BRIDGE_PORT_ROLE_BACKUP)
+        {   // already discarding
+            pPort->portFlags |= MAC_BRIDGE_RSTP_PFLAG_AGREE | MAC_BRIDGE_RSTP_PFLAG_NEW_INFO;
+        }
+        pPort->portFlags &= ~MAC_BRIDGE_RSTP_PFLAG_PROPOSED;
+    }
+
+    _MAC_Bridge_RstpTxPending(pBDcpt);
+}
+#endif  // (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+
+#if (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+static void _MAC_Bridge_LearnInit(MAC_BRIDGE_DCPT* pBDcpt)
+{
+    int portIx;
+    MAC_BRIDGE_LEARN_DCPT* pLearn = pBDcpt->learnDcpt;
+
+    for(portIx = 0; portIx < pBDcpt->nPorts; portIx++, pLearn++)
+    {
+        pLearn->maxEntries = TCPIP_MAC_BRIDGE_LEARN_MAX_ENTRIES;
+        pLearn->maxRate = TCPIP_MAC_BRIDGE_LEARN_RATE;
+        pLearn->policy = TCPIP_MAC_BRIDGE_LEARN_VIOLATION;
+        pLearn->notifySec = 0xffffffff;
+    }
+}
+
+// checks the port limits before learning a new source address
+static MAC_BRIDGE_LEARN_RES _MAC_Bridge_LearnCheck(MAC_BRIDGE_DCPT* pBDcpt, uint8_t port, TCPIP_MAC_BRIDGE_EVENT* pEvent)
+{
+    MAC_BRIDGE_LEARN_DCPT* pLearn = pBDcpt->learnDcpt + port;
+    uint32_t currSec = _MAC_Bridge_GetSecond();
+
+    if(pLearn->rateSec != currSec)
+    {   // new rate interval
+        pLearn->rateSec = currSec;
+        pLearn->rateCount = 0;
+    }
+
+    if(pLearn->holdSec == 0 || (int32_t)(pLearn->holdSec - currSec) <= 0)
+    {   // learning not disabled on this port
+        if((pLearn->maxEntries != 0 && pLearn->nLearnt >= pLearn->maxEntries) || (pLearn->maxRate != 0 && pLearn->rateCount >= pLearn->maxRate))
+        {   // violation
+            if(pLearn->policy == TCPIP_MAC_BRIDGE_LEARN_POLICY_DISABLE)
+            {
+                pLearn->holdSec = currSec + TCPIP_MAC_BRIDGE_LEARN_HOLD_TIME;
+            }
+        }
+        else
+        {
+            pLearn->rateCount++;
+            return MAC_BRIDGE_LEARN_RES_ALLOW;
+        }
+    }
+
+    _MAC_Bridge_StatPortUpdate(pBDcpt, port, MAC_BRIDGE_STAT_TYPE_LEARN_DENIED, 1);
+    if(pLearn->notifySec != currSec)
+    {   // a flooding station should not flood the event handler too
+        pLearn->notifySec = currSec;
+        *pEvent = TCPIP_MAC_BRIDGE_EVENT_LEARN_DENIED;
+    }
+
+    return pLearn->policy == TCPIP_MAC_BRIDGE_LEARN_POLICY_DROP ? MAC_BRIDGE_LEARN_RES_DROP : MAC_BRIDGE_LEARN_RES_DENY;
+}
+
+// accounts for a dynamic entry about to be (re)learnt on port
+static void _MAC_Bridge_LearnCount(MAC_BRIDGE_DCPT* pBDcpt, MAC_BRIDGE_HASH_ENTRY* hE, uint8_t port)
+{
+    if(hE->hEntry.flags.newEntry == 0)
+    {   
+        if((hE->hEntry.flags.value & (MAC_BRIDGE_HFLAG_STATIC | MAC_BRIDGE_HFLAG_PORT_VALID)) != MAC_BRIDGE_HFLAG_PORT_VALID)
+        {   // static entry or not learnt yet
+            return;
+        }
+
+        // station moved
+        MAC_BRIDGE_LEARN_DCPT* pOldLearn = pBDcpt->learnDcpt + hE->learnPort;
+        if(pOldLearn->nLearnt != 0)
+        {
+            pOldLearn->nLearnt--;
+        }
+    }
+
+    pBDcpt->learnDcpt[port].nLearnt++;
+}
+#endif  // (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+
+#if (_TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
+// checks a learnt address showing up on a different port
+// returns true if the entry can move to the new port
+// An address moving more than TCPIP_MAC_BRIDGE_MOVE_THRESHOLD times within the window
+// is pinned to the port it is on, so that a loop or a misbehaving upstream AP
+// doesn't make the traffic ping-pong between the ports
+static bool _MAC_Bridge_MoveCheck(MAC_BRIDGE_DCPT* pBDcpt, MAC_BRIDGE_HASH_ENTRY* hE, uint8_t port, TCPIP_MAC_BRIDGE_EVENT* pEvent)
+{
+    uint32_t currSec;
+
+    if(hE->hEntry.flags.newEntry != 0 || (hE->hEntry.flags.value & (MAC_BRIDGE_HFLAG_STATIC | MAC_BRIDGE_HFLAG_PORT_VALID)) != MAC_BRIDGE_HFLAG_PORT_VALID)
+    {   // not a move of a learnt address
+        return true;
+    }
+
+    currSec = _MAC_Bridge_GetSecond();
+    if((hE->hEntry.flags.value & MAC_BRIDGE_HFLAG_PINNED) != 0)
+    {
+        if((int32_t)(hE->pinSec - currSec) > 0)
+        {   // still pinned; the frame is forwarded but the entry stays
+            _MAC_Bridge_StatPortUpdate(pBDcpt, port, MAC_BRIDGE_STAT_TYPE_MOVE_DENIED_PKTS, 1);
+            return false;
+        }
+        // pin expired, start over
+        hE->hEntry.flags.value &= ~MAC_BRIDGE_HFLAG_PINNED;
+        hE->moveBurst = 0;
+    }
+
+    if(hE->moveBurst == 0 || currSec - hE->moveSec >= TCPIP_MAC_BRIDGE_MOVE_WINDOW)
+    {   // new window
+        hE->moveSec = currSec;
+        hE->moveBurst = 0;
+    }
+
+    if(hE->moveCount != 0xffff)
+    {
+        hE->moveCount++;
+    }
+    _MAC_Bridge_StatPortUpdate(pBDcpt, port, MAC_BRIDGE_STAT_TYPE_MAC_MOVES, 1);
+
+    if(++hE->moveBurst <= TCPIP_MAC_BRIDGE_MOVE_THRESHOLD)
+    {
+        return true;
+    }
+
+    // flapping: the move above the threshold is not taken
+    hE->hEntry.flags.value |= MAC_BRIDGE_HFLAG_PINNED;
+    hE->pinSec = currSec + TCPIP_MAC_BRIDGE_MOVE_PIN_TIME;
+#if (TCPIP_MAC_BRIDGE_MOVE_PORT_HOLD_TIME != 0)
+    pBDcpt->moveHoldSec[port] = currSec + TCPIP_MAC_BRIDGE_MOVE_PORT_HOLD_TIME;
+#endif  // (TCPIP_MAC_BRIDGE_MOVE_PORT_HOLD_TIME != 0)
+    *pEvent = TCPIP_MAC_BRIDGE_EVENT_ENTRY_PINNED;
+    return false;
+}
+#endif  // (_TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
+
+#if (_TCPIP_MAC_BRIDGE_TX_BACKLOG != 0)
+// Port TX backlog
+// The bridge normally hands a frame to the MAC driver and drops it if the driver cannot take it
+// (for the Wi-Fi MAC, no shared TX memory while the air is busy).
+// With a backlog, such unicast frames are held in order and retried
+// when new frames are forwarded to the port and from the bridge task.
+// The transit delay still applies: stale frames are discarded when retried.
+// Multicast and VLAN frames are not held.
+// Only bridge packets are held: a frame forwarded directly is copied first,
+// the MAC driver gets its RX buffer back right away.
+
+// returns true if there are older frames waiting for the port
+// and the new frame should be queued behind them
+static bool _MAC_Bridge_BacklogPending(MAC_BRIDGE_DCPT* pBDcpt, int brPort, const MAC_BRIDGE_FWD_DCPT* pFDcpt)
+{
+    SINGLE_LIST* pBacklog = pBDcpt->txBacklog + brPort;
+
+    if((pFDcpt->fwdFlags & MAC_BRIDGE_FWD_FLAG_BACKLOG) != 0 || TCPIP_Helper_SingleListIsEmpty(pBacklog))
+    {   // retried from the backlog or nothing waiting
+        return false;
+    }
+
+    _MAC_Bridge_BacklogService(pBDcpt, brPort);
+    return !TCPIP_Helper_SingleListIsEmpty(pBacklog);
+}
+
+// holds a frame that could not be transmitted on brPort
+// returns false if the frame cannot be held
+static bool _MAC_Bridge_BacklogAdd(MAC_BRIDGE_DCPT* pBDcpt, int brPort, TCPIP_MAC_PACKET* pFwdPkt)
+{
+    MAC_BRIDGE_FWD_DCPT* pFDcpt = _MAC_Bridge_GetPktFwdDcpt(pFwdPkt);
+    SINGLE_LIST* pBacklog = pBDcpt->txBacklog + brPort;
+
+    if((pFDcpt->fwdFlags & MAC_BRIDGE_FWD_FLAG_BACKLOG) != 0)
+    {   // retry failed; back at the head, it's still the oldest
+        _MAC_Bridge_AddPortMap(brPort, pFDcpt);
+        TCPIP_Helper_SingleListHeadAdd(pBacklog, (SGL_LIST_NODE*)pFwdPkt);
+        return true;
+    }
+
+    if((pFDcpt->fwdFlags & (MAC_BRIDGE_FWD_FLAG_MCAST | MAC_BRIDGE_FWD_FLAG_VLAN)) != 0 || !_MAC_Bridge_IsMapEmpty(pFDcpt))
+    {   // only frames going to a single port are held
+        return false;
+    }
+
+    if(TCPIP_Helper_SingleListCount(pBacklog) >= TCPIP_MAC_BRIDGE_TX_BACKLOG)
+    {
+        _MAC_Bridge_StatPortUpdate(pBDcpt, brPort, MAC_BRIDGE_STAT_TYPE_BACKLOG_DROP_PKTS, 1);
+        return false;
+    }
+
+    if((_MAC_Bridge_GetPktFlags(pFwdPkt) & MAC_BRIDGE_ALLOC_FLAG_BRIDGE_OWN) == 0)
+    {   // received packet, forwarded directly
+        TCPIP_MAC_PACKET* pCopyPkt = _MAC_Bridge_GetFwdPkt(pBDcpt, pFDcpt->pktLen);
+        if(pCopyPkt == 0)
+        {   // cannot hold it
+            return false;
+        }
+
+        _MAC_Bridge_PacketCopy(pFwdPkt, pCopyPkt, pFDcpt->pktLen, 0);
+        pCopyPkt->pDSeg->segLen += sizeof(TCPIP_MAC_ETHERNET_HEADER);
+        _MAC_Bridge_StorePktFwdDcpt(pCopyPkt, pFDcpt);
+        pCopyPkt->ackFunc = _MAC_Bridge_PacketAck;
+        pCopyPkt->ackParam = 0;
+
+        // the copy is forwarded; return the received packet to its owner
+        pFwdPkt->ackParam = pFDcpt->ownAckParam;
+        pFwdPkt->ackFunc = pFDcpt->ownAckFunc;
+        TCPIP_PKT_PacketAcknowledge(pFwdPkt, TCPIP_MAC_PKT_ACK_BRIDGE_DONE);
+        pFwdPkt = pCopyPkt;
+    }
+
+    _MAC_Bridge_AckFilter(pBDcpt, brPort, pFwdPkt);
+
+    pFDcpt->fwdFlags |= MAC_BRIDGE_FWD_FLAG_BACKLOG;
+    _MAC_Bridge_AddPortMap(brPort, pFDcpt);
+    TCPIP_Helper_SingleListTailAdd(pBacklog, (SGL_LIST_NODE*)pFwdPkt);
+    _MAC_Bridge_StatPortUpdate(pBDcpt, brPort, MAC_BRIDGE_STAT_TYPE_BACKLOG_PKTS, 1);
+    return true;
+}
+
+// retries the frames held for brPort, oldest first
+// stops at the first frame the MAC still refuses
+static void _MAC_Bridge_BacklogService(MAC_BRIDGE_DCPT* pBDcpt, int brPort)
+{
+    TCPIP_MAC_PACKET* pPkt;
+    SINGLE_LIST* pBacklog = pBDcpt->txBacklog + brPort;
+
+    if(pBDcpt->backlogService != 0)
+    {   // a MAC acknowledge while retrying
+        return;
+    }
+
+    pBDcpt->backlogService = 1;
+    while((pPkt = (TCPIP_MAC_PACKET*)TCPIP_Helper_SingleListHeadRemove(pBacklog)) != 0)
+    {
+        _MAC_Bridge_ForwardPacket(pPkt, 0);
+        if(pBacklog->head == (SGL_LIST_NODE*)pPkt)
+        {   // re-queued, the MAC is still busy
+            break;
+        }
+    }
+    pBDcpt->backlogService = 0;
+}
+#endif  // (_TCPIP_MAC_BRIDGE_TX_BACKLOG != 0)
+
+#if (_TCPIP_MAC_BRIDGE_ACK_FILTER != 0)
+// TCP ACK filtering on the TX backlog
+// A queued pure ACK is redundant once a newer cumulative ACK of the same connection
+// is queued behind it. Conservative rules, as the DOCSIS/CAKE filters:
+//  - IPv4 TCP, not fragmented, no CE mark, no payload
+//  - only the ACK flag set: SYN/FIN/RST/PSH/URG and the ECN flags carry information
+//  - options only NOP, EOL and timestamps: a SACK block is never dropped
+//  - same 4-tuple and sequence number, strictly newer ack, window not smaller, timestamp not older
+// Duplicate ACKs have the same ack number, so they are always kept for fast retransmit.
+
+static uint32_t _MAC_Bridge_AckGet32(const uint8_t* pBuff)
+{
+    return ((uint32_t)pBuff[0] << 24) | ((uint32_t)pBuff[1] << 16) | ((uint32_t)pBuff[2] << 8) | pBuff[3];
+}
+
+// returns true if the frame is a pure TCP ACK the filter can handle
+static bool _MAC_Bridge_AckParse(TCPIP_MAC_PACKET* pPkt, MAC_BRIDGE_ACK_INFO* pInfo)
+{
+    const uint8_t* pIp;
+    const uint8_t* pTcp;
+    const uint8_t* pOpt;
+    const uint8_t* pOptEnd;
+    int ipHdrLen, tcpHdrLen, totLen;
+    const TCPIP_MAC_ETHERNET_HEADER* pMacHdr = (const TCPIP_MAC_ETHERNET_HEADER*)pPkt->pMacLayer;
+
+    if(pMacHdr->Type != TCPIP_Helper_htons(TCPIP_ETHER_TYPE_IPV4))
+    {
+        return false;
+    }
+
+    pIp = (const uint8_t*)(pMacHdr + 1);
+    ipHdrLen = (pIp[0] & 0x0f) << 2;
+    if((pIp[0] & 0xf0) != 0x40 || ipHdrLen < 20 || pIp[9] != IP_PROT_TCP || (pIp[1] & 0x03) == 0x03)
+    {   // not IPv4/TCP or CE marked
+        return false;
+    }
+
+    if(((pIp[6] & 0x3f) | pIp[7]) != 0)
+    {   // fragment
+        return false;
+    }
+
+    totLen = ((int)pIp[2] << 8) | pIp[3];
+    if(totLen < ipHdrLen + 20 || sizeof(TCPIP_MAC_ETHERNET_HEADER) + totLen > pPkt->pDSeg->segLen)
+    {   // the headers have to be in the 1st segment
+        return false;
+    }
+
+    pTcp = pIp + ipHdrLen;
+    tcpHdrLen = (pTcp[12] >> 4) << 2;
+    if(tcpHdrLen < 20 || ipHdrLen + tcpHdrLen != totLen || pTcp[13] != 0x10)
+    {   // carries data or other flags than ACK
+        return false;
+    }
+
+    pInfo->hasTs = 0;
+    pInfo->tsVal = 0;
+    pOptEnd = pTcp + tcpHdrLen;
+    for(pOpt = pTcp + 20; pOpt < pOptEnd; )
+    {
+        if(pOpt[0] == 0)
+        {   // EOL
+            break;
+        }
+        else if(pOpt[0] == 1)
+        {   // NOP
+            pOpt++;
+        }
+        else if(pOpt[0] == 8 && pOpt + 10 <= pOptEnd && pOpt[1] == 10)
+        {   // timestamps
+            pInfo->hasTs = 1;
+            pInfo->tsVal = _MAC_Bridge_AckGet32(pOpt + 2);
+            pOpt += 10;
+        }
+        else
+        {   // SACK or anything else
+            return false;
+        }
+    }
+
+    pInfo->srcAdd = _MAC_Bridge_AckGet32(pIp + 12);
+    pInfo->dstAdd = _MAC_Bridge_AckGet32(pIp + 16);
+    pInfo->ports = _MAC_Bridge_AckGet32(pTcp);
+    pInfo->seq = _MAC_Bridge_AckGet32(pTcp + 4);
+    pInfo->ack = _MAC_Bridge_AckGet32(pTcp + 8);
+    pInfo->window = ((uint16_t)pTcp[14] << 8) | pTcp[15];
+
+    return true;
+}
+
+// returns true if pNew makes pOld redundant
+static bool _MAC_Bridge_AckSupersedes(const MAC_BRIDGE_ACK_INFO* pNew, const MAC_BRIDGE_ACK_INFO* pOld)
+{
+    if(pNew->srcAdd != pOld->srcAdd || pNew->dstAdd != pOld->dstAdd || pNew->ports != pOld->ports || pNew->seq != pOld->seq)
+    {   // different connection or data was sent in between
+        return false;
+    }
+
+    if((int32_t)(pNew->ack - pOld->ack) <= 0 || pNew->window < pOld->window)
+    {   // duplicate/older ACK or shrinking window
+        return false;
+    }
+
+    if(pNew->hasTs != pOld->hasTs || (pNew->hasTs != 0 && (int32_t)(pNew->tsVal - pOld->tsVal) < 0))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+// called before pNewPkt is queued on brPort
+// drops a queued ACK that pNewPkt supersedes
+static void _MAC_Bridge_AckFilter(MAC_BRIDGE_DCPT* pBDcpt, int brPort, TCPIP_MAC_PACKET* pNewPkt)
+{
+    MAC_BRIDGE_ACK_INFO newAck, oldAck;
+    SGL_LIST_NODE* prev;
+    TCPIP_MAC_PACKET* pOldPkt;
+    SINGLE_LIST* pBacklog = pBDcpt->txBacklog + brPort;
+
+    if(!_MAC_Bridge_AckParse(pNewPkt, &newAck))
+    {
+        return;
+    }
+
+    for(prev = 0, pOldPkt = (TCPIP_MAC_PACKET*)pBacklog->head; pOldPkt != 0; prev = (SGL_LIST_NODE*)pOldPkt, pOldPkt = pOldPkt->next)
+    {
+        if(_MAC_Bridge_AckParse(pOldPkt, &oldAck) && _MAC_Bridge_AckSupersedes(&newAck, &oldAck))
+        {   // release it, nothing left to forward
+            TCPIP_Helper_SingleListNextRemove(pBacklog, prev);
+            _MAC_Bridge_ClearMap(_MAC_Bridge_GetPktFwdDcpt(pOldPkt));
+            _MAC_Bridge_ForwardPacket(pOldPkt, 0);
+            _MAC_Bridge_StatPortUpdate(pBDcpt, brPort, MAC_BRIDGE_STAT_TYPE_ACK_FILTERED, 1);
+            // filtering on every add leaves at most one ACK per connection queued
+            break;
+        }
+    }
+}
+#endif  // (_TCPIP_MAC_BRIDGE_ACK_FILTER != 0)
+
+
+#if (_TCPIP_MAC_BRIDGE_ACL != 0)
+// ingress ACL
+// The rules are compiled into a bit vector classifier:
+// for each checked field, the distinct rule values (or the disjoint port intervals)
+// are sorted and each one gets the bitmap of the rules it matches.
+// A frame costs one binary search per checked field and an AND of the bitmaps,
+// the lowest bit set in the result being the highest priority matching rule.
+// The compiled table is replaced as a whole; the packet processing never sees it being built.
+
+static __inline__ void __attribute__((always_inline)) _MAC_Bridge_AclMapSet(MAC_BRIDGE_ACL_MAP* pMap, int ruleIx)
+{
+    pMap->map[ruleIx >> 5] |= 1ul << (ruleIx & 0x1f);
+}
+
+static uint64_t _MAC_Bridge_AclMacValue(const TCPIP_MAC_ADDR* pAdd)
+{
+    int ix;
+    uint64_t value = 0;
+
+    for(ix = 0; ix < sizeof(pAdd->v); ix++)
+    {
+        value = (value << 8) | pAdd->v[ix];
+    }
+
+    return value;
+}
+
+static uint64_t _MAC_Bridge_AclRuleValue(const TCPIP_MAC_BRIDGE_ACL_RULE* pRule, MAC_BRIDGE_ACL_FIELD field)
+{
+    switch(field)
+    {
+        case MAC_BRIDGE_ACL_FIELD_IN_PORT:
+            return pRule->inPort;
+
+        case MAC_BRIDGE_ACL_FIELD_SRC_MAC:
+            return _MAC_Bridge_AclMacValue(&pRule->srcAdd);
+
+        case MAC_BRIDGE_ACL_FIELD_DEST_MAC:
+            return _MAC_Bridge_AclMacValue(&pRule->destAdd);
+
+        case MAC_BRIDGE_ACL_FIELD_ETHER_TYPE:
+            return pRule->etherType;
+
+        case MAC_BRIDGE_ACL_FIELD_VLAN:
+            return pRule->vlanId;
+
+        default:
+            return pRule->ipProto;
+    }
+}
+
+static void _MAC_Bridge_AclRuleRange(const TCPIP_MAC_BRIDGE_ACL_RULE* pRule, MAC_BRIDGE_ACL_RANGE range, uint16_t* pLow, uint16_t* pHigh)
+{
+    if(range == MAC_BRIDGE_ACL_RANGE_SRC_PORT)
+    {
+        *pLow = pRule->srcPortLow;
+        *pHigh = pRule->srcPortHigh;
+    }
+    else
+    {
+        *pLow = pRule->destPortLow;
+        *pHigh = pRule->destPortHigh;
+    }
+}
+
+// adds a value to a sorted array, if not already there
+static void _MAC_Bridge_AclValueInsert(uint64_t* pValues, uint16_t* pnValues, uint64_t value)
+{
+    int pos;
+    int nValues = *pnValues;
+
+    for(pos = 0; pos < nValues && pValues[pos] < value; pos++);
+
+    if(pos == nValues || pValues[pos] != value)
+    {
+        memmove(pValues + pos + 1, pValues + pos, (nValues - pos) * sizeof(*pValues));
+        pValues[pos] = value;
+        *pnValues = nValues + 1;
+    }
+}
+
+// adds an interval start to a sorted array, if not already there
+static void _MAC_Bridge_AclStartInsert(uint16_t* pStarts, uint16_t* pnStarts, uint16_t start)
+{
+    int pos;
+    int nStarts = *pnStarts;
+
+    for(pos = 0; pos < nStarts && pStarts[pos] < start; pos++);
+
+    if(pos == nStarts || pStarts[pos] != start)
+    {
+        memmove(pStarts + pos + 1, pStarts + pos, (nStarts - pos) * sizeof(*pStarts));
+        pStarts[pos] = start;
+        *pnStarts = nStarts + 1;
+    }
+}
+
+// validates the rules and builds the compiled ACL
+// *ppAcl is 0 if there are no rules
+static TCPIP_MAC_BRIDGE_RESULT _MAC_Bridge_AclCompile(MAC_BRIDGE_DCPT* pBDcpt, const TCPIP_MAC_BRIDGE_ACL_RULE* pRules, size_t nRules, MAC_BRIDGE_ACL** ppAcl)
+{
+    int ruleIx, ix, valIx;
+    uint16_t low, high, fieldFlag;
+    size_t hdrSize, blkSize, maxIntervals;
+    uint8_t* pMem;
+    MAC_BRIDGE_ACL* pAcl;
+    MAC_BRIDGE_ACL_FIELD_TBL* pField;
+    MAC_BRIDGE_ACL_RANGE_TBL* pRange;
+    MAC_BRIDGE_ACL_MAP* pMap;
+    const TCPIP_MAC_BRIDGE_ACL_RULE* pRule;
+    uint16_t matchFlags = 0;
+
+    *ppAcl = 0;
+    if(nRules > TCPIP_MAC_BRIDGE_ACL_MAX_RULES || (nRules != 0 && pRules == 0))
+    {
+        return TCPIP_MAC_BRIDGE_RES_ACL_ERROR;
+    }
+
+    for(ruleIx = 0, pRule = pRules; ruleIx < nRules; ruleIx++, pRule++)
+    {
+        if((pRule->matchFlags & ~TCPIP_MAC_BRIDGE_ACL_MATCH_ALL) != 0 || pRule->action > TCPIP_MAC_BRIDGE_ACL_ACTION_DROP)
+        {
+            return TCPIP_MAC_BRIDGE_RES_ACL_ERROR;
+        }
+
+        if((pRule->matchFlags & TCPIP_MAC_BRIDGE_ACL_MATCH_IN_PORT) != 0 && pRule->inPort >= pBDcpt->nPorts)
+        {
+            return TCPIP_MAC_BRIDGE_RES_ACL_ERROR;
+        }
+
+        if(((pRule->matchFlags & TCPIP_MAC_BRIDGE_ACL_MATCH_SRC_PORT) != 0 && pRule->srcPortLow > pRule->srcPortHigh) ||
+           ((pRule->matchFlags & TCPIP_MAC_BRIDGE_ACL_MATCH_DEST_PORT) != 0 && pRule->destPortLow > pRule->destPortHigh))
+        {
+            return TCPIP_MAC_BRIDGE_RES_ACL_ERROR;
+        }
+
+        matchFlags |= pRule->matchFlags;
+    }
+
+    if(nRules == 0)
+    {
+        return TCPIP_MAC_BRIDGE_RES_OK;
+    }
+
+    // each rule range adds at most 2 interval starts
+    maxIntervals = 2 * nRules + 1;
+    // one block: the 64 bit values go first, for alignment
+    hdrSize = (sizeof(MAC_BRIDGE_ACL) + 7) & ~7;
+    blkSize = hdrSize + MAC_BRIDGE_ACL_FIELDS * nRules * (sizeof(uint64_t) + sizeof(MAC_BRIDGE_ACL_MAP)) +
+              MAC_BRIDGE_ACL_RANGES * maxIntervals * (sizeof(MAC_BRIDGE_ACL_MAP) + sizeof(uint16_t)) + nRules * sizeof(TCPIP_MAC_BRIDGE_ACL_RULE);
+
+    pMem = (uint8_t*)TCPIP_HEAP_Calloc(pBDcpt->memH, 1, blkSize);
+    if(pMem == 0)
+    {
+        return TCPIP_MAC_BRIDGE_RES_ACL_ERROR;
+    }
+
+    pAcl = (MAC_BRIDGE_ACL*)pMem;
+    pMem += hdrSize;
+    for(ix = 0; ix < MAC_BRIDGE_ACL_FIELDS; ix++)
+    {
+        pAcl->fieldTbl[ix].pValues = (uint64_t*)pMem;
+        pMem += nRules * sizeof(uint64_t);
+    }
+    for(ix = 0; ix < MAC_BRIDGE_ACL_FIELDS; ix++)
+    {
+        pAcl->fieldTbl[ix].pMaps = (MAC_BRIDGE_ACL_MAP*)pMem;
+        pMem += nRules * sizeof(MAC_BRIDGE_ACL_MAP);
+    }
+    for(ix = 0; ix < MAC_BRIDGE_ACL_RANGES; ix++)
+    {
+        pAcl->rangeTbl[ix].pMaps = (MAC_BRIDGE_ACL_MAP*)pMem;
+        pMem += maxIntervals * sizeof(MAC_BRIDGE_ACL_MAP);
+    }
+    pAcl->pRules = (TCPIP_MAC_BRIDGE_ACL_RULE*)pMem;
+    pMem += nRules * sizeof(TCPIP_MAC_BRIDGE_ACL_RULE);
+    for(ix = 0; ix < MAC_BRIDGE_ACL_RANGES; ix++)
+    {
+        pAcl->rangeTbl[ix].pStarts = (uint16_t*)pMem;
+        pMem += maxIntervals * sizeof(uint16_t);
+    }
+
+    memcpy(pAcl->pRules, pRules, nRules * sizeof(*pRules));
+    pAcl->nRules = nRules;
+    pAcl->matchFlags = matchFlags;
+    for(ruleIx = 0; ruleIx < nRules; ruleIx++)
+    {
+        _MAC_Bridge_AclMapSet(&pAcl->allMap, ruleIx);
+    }
+
+    // value fields
+    for(ix = 0, pField = pAcl->fieldTbl; ix < MAC_BRIDGE_ACL_FIELDS; ix++, pField++)
+    {
+        fieldFlag = 1 << ix;
+        for(ruleIx = 0, pRule = pRules; ruleIx < nRules; ruleIx++, pRule++)
+        {
+            if((pRule->matchFlags & fieldFlag) == 0)
+            {
+                _MAC_Bridge_AclMapSet(&pField->anyMap, ruleIx);
+            }
+            else
+            {
+                _MAC_Bridge_AclValueInsert(pField->pValues, &pField->nValues, _MAC_Bridge_AclRuleValue(pRule, ix));
+            }
+        }
+
+        for(valIx = 0, pMap = pField->pMaps; valIx < pField->nValues; valIx++, pMap++)
+        {
+            *pMap = pField->anyMap;
+            for(ruleIx = 0, pRule = pRules; ruleIx < nRules; ruleIx++, pRule++)
+            {
+                if((pRule->matchFlags & fieldFlag) != 0 && _MAC_Bridge_AclRuleValue(pRule, ix) == pField->pValues[valIx])
+                {
+                    _MAC_Bridge_AclMapSet(pMap, ruleIx);
+                }
+            }
+        }
+    }
+
+    // range fields: the rule ranges boundaries split [0, 0xffff] into intervals
+    // every rule either contains an interval or does not overlap it
+    for(ix = 0, pRange = pAcl->rangeTbl; ix < MAC_BRIDGE_ACL_RANGES; ix++, pRange++)
+    {
+        fieldFlag = 1 << (MAC_BRIDGE_ACL_FIELDS + ix);
+        pRange->pStarts[0] = 0;
+        pRange->nIntervals = 1;
+        for(ruleIx = 0, pRule = pRules; ruleIx < nRules; ruleIx++, pRule++)
+        {
+            if((pRule->matchFlags & fieldFlag) == 0)
+            {
+                _MAC_Bridge_AclMapSet(&pRange->anyMap, ruleIx);
+            }
+            else
+            {
+                _MAC_Bridge_AclRuleRange(pRule, ix, &low, &high);
+                _MAC_Bridge_AclStartInsert(pRange->pStarts, &pRange->nIntervals, low);
+                if(high != 0xffff)
+                {
+                    _MAC_Bridge_AclStartInsert(pRange->pStarts, &pRange->nIntervals, high + 1);
+                }
+            }
+        }
+
+        for(valIx = 0, pMap = pRange->pMaps; valIx < pRange->nIntervals; valIx++, pMap++)
+        {
+            *pMap = pRange->anyMap;
+            for(ruleIx = 0, pRule = pRules; ruleIx < nRules; ruleIx++, pRule++)
+            {
+                if((pRule->matchFlags & fieldFlag) != 0)
+                {
+                    _MAC_Bridge_AclRuleRange(pRule, ix, &low, &high);
+                    if(low <= pRange->pStarts[valIx] && pRange->pStarts[valIx] <= high)
+                    {
+                        _MAC_Bridge_AclMapSet(pMap, ruleIx);
+                    }
+                }
+            }
+        }
+    }
+
+    *ppAcl = pAcl;
+    return TCPIP_MAC_BRIDGE_RES_OK;
+}
+
+static const MAC_BRIDGE_ACL_MAP* _MAC_Bridge_AclFieldLookup(const MAC_BRIDGE_ACL_FIELD_TBL* pField, uint64_t value)
+{
+    int mid;
+    int low = 0;
+    int high = pField->nValues - 1;
+
+    while(low <= high)
+    {
+        mid = (low + high) >> 1;
+        if(pField->pValues[mid] == value)
+        {
+            return pField->pMaps + mid;
+        }
+
+        if(pField->pValues[mid] < value)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid - 1;
+        }
+    }
+
+    // no rule checks for this value
+    return &pField->anyMap;
+}
+
+static const MAC_BRIDGE_ACL_MAP* _MAC_Bridge_AclRangeLookup(const MAC_BRIDGE_ACL_RANGE_TBL* pRange, uint16_t value)
+{
+    int mid;
+    int low = 0;
+    int high = pRange->nIntervals - 1;
+
+    // the last interval starting <= value; pStarts[0] == 0 always qualifies
+    while(low < high)
+    {
+        mid = (low + high + 1) >> 1;
+        if(pRange->pStarts[mid] <= value)
+        {
+            low = mid;
+        }
+        else
+        {
+            high = mid - 1;
+        }
+    }
+
+    return pRange->pMaps + low;
+}
+
+// extracts the frame fields checked by the ACL rules
+static void _MAC_Bridge_AclKey(MAC_BRIDGE_DCPT* pBDcpt, const MAC_BRIDGE_ACL* pAcl, TCPIP_MAC_PACKET* pRxPkt, uint8_t inPort, MAC_BRIDGE_ACL_KEY* pKey)
+{
+    uint16_t etherType, vlanId;
+    int l3Len, ipHdrLen;
+    uint8_t ipProto;
+    const uint8_t* pL4;
+    const uint8_t* pL3 = pRxPkt->pNetLayer;
+    const TCPIP_MAC_ETHERNET_HEADER* pMacHdr = (const TCPIP_MAC_ETHERNET_HEADER*)pRxPkt->pMacLayer;
+
+    // the MAC driver adjusted the segment length for the Ethernet header
+    l3Len = pRxPkt->pDSeg->segLen;
+    etherType = TCPIP_Helper_ntohs(pMacHdr->Type);
+    vlanId = 0;
+    if(etherType == TCPIP_ETHER_TYPE_VLAN && l3Len >= MAC_BRIDGE_VLAN_TAG_SIZE)
+    {   // the rules match the encapsulated frame
+        vlanId = (((uint16_t)pL3[0] << 8) | pL3[1]) & MAC_BRIDGE_VLAN_VID_MASK;
+        etherType = ((uint16_t)pL3[2] << 8) | pL3[3];
+        pL3 += MAC_BRIDGE_VLAN_TAG_SIZE;
+        l3Len -= MAC_BRIDGE_VLAN_TAG_SIZE;
+    }
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+    if(vlanId == 0 && pBDcpt->nVlans != 0)
+    {   // untagged or priority tagged
+        vlanId = pBDcpt->portPvid[inPort];
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+
+    pKey->values[MAC_BRIDGE_ACL_FIELD_IN_PORT] = inPort;
+    pKey->values[MAC_BRIDGE_ACL_FIELD_SRC_MAC] = _MAC_Bridge_AclMacValue(&pMacHdr->SourceMACAddr);
+    pKey->values[MAC_BRIDGE_ACL_FIELD_DEST_MAC] = _MAC_Bridge_AclMacValue(&pMacHdr->DestMACAddr);
+    pKey->values[MAC_BRIDGE_ACL_FIELD_ETHER_TYPE] = etherType;
+    pKey->values[MAC_BRIDGE_ACL_FIELD_VLAN] = vlanId;
+    pKey->fieldFlags = TCPIP_MAC_BRIDGE_ACL_MATCH_IN_PORT | TCPIP_MAC_BRIDGE_ACL_MATCH_SRC_MAC | TCPIP_MAC_BRIDGE_ACL_MATCH_DEST_MAC |
+                       TCPIP_MAC_BRIDGE_ACL_MATCH_ETHER_TYPE | TCPIP_MAC_BRIDGE_ACL_MATCH_VLAN;
+
+    if((pAcl->matchFlags & (TCPIP_MAC_BRIDGE_ACL_MATCH_IP_PROTO | TCPIP_MAC_BRIDGE_ACL_MATCH_SRC_PORT | TCPIP_MAC_BRIDGE_ACL_MATCH_DEST_PORT)) == 0)
+    {   // no rule looks into the IP header
+        return;
+    }
+
+    pL4 = 0;
+    ipHdrLen = 0;
+    if(etherType == TCPIP_ETHER_TYPE_IPV4 && l3Len >= 20 && (pL3[0] & 0xf0) == 0x40)
+    {
+        ipProto = pL3[9];
+        ipHdrLen = (pL3[0] & 0x0f) << 2;
+        if(((pL3[6] & 0x1f) | pL3[7]) == 0)
+        {   // only the first fragment carries the ports
+            pL4 = pL3 + ipHdrLen;
+        }
+    }
+    else if(etherType == TCPIP_ETHER_TYPE_IPV6 && l3Len >= 40 && (pL3[0] & 0xf0) == 0x60)
+    {   // the extension headers are not followed
+        ipProto = pL3[6];
+        ipHdrLen = 40;
+        pL4 = pL3 + ipHdrLen;
+    }
+    else
+    {   // not IP
+        return;
+    }
+
+    pKey->values[MAC_BRIDGE_ACL_FIELD_IP_PROTO] = ipProto;
+    pKey->fieldFlags |= TCPIP_MAC_BRIDGE_ACL_MATCH_IP_PROTO;
+
+    if(pL4 != 0 && (ipProto == IP_PROT_TCP || ipProto == IP_PROT_UDP) && ipHdrLen >= 20 && l3Len >= ipHdrLen + 4)
+    {
+        pKey->ports[MAC_BRIDGE_ACL_RANGE_SRC_PORT] = ((uint16_t)pL4[0] << 8) | pL4[1];
+        pKey->ports[MAC_BRIDGE_ACL_RANGE_DEST_PORT] = ((uint16_t)pL4[2] << 8) | pL4[3];
+        pKey->fieldFlags |= TCPIP_MAC_BRIDGE_ACL_MATCH_SRC_PORT | TCPIP_MAC_BRIDGE_ACL_MATCH_DEST_PORT;
+    }
+}
+
+// checks a received frame against the ACL
+// returns false if the frame needs to be dropped
+static bool _MAC_Bridge_AclCheck(MAC_BRIDGE_DCPT* pBDcpt, TCPIP_MAC_PACKET* pRxPkt, uint8_t inPort)
+{
+    int ix, wIx, ruleIx;
+    uint16_t fieldFlag;
+    uint32_t word;
+    MAC_BRIDGE_ACL_MAP result;
+    MAC_BRIDGE_ACL_KEY key;
+    const MAC_BRIDGE_ACL_MAP* pMap;
+    MAC_BRIDGE_ACL* pAcl = pBDcpt->pAcl;
+
+    if(pAcl == 0)
+    {
+        return true;
+    }
+
+    _MAC_Bridge_AclKey(pBDcpt, pAcl, pRxPkt, inPort, &key);
+    result = pAcl->allMap;
+
+    for(ix = 0; ix < MAC_BRIDGE_ACL_FIELDS; ix++)
+    {
+        fieldFlag = 1 << ix;
+        if((pAcl->matchFlags & fieldFlag) != 0)
+        {   // some rule checks this field
+            pMap = (key.fieldFlags & fieldFlag) != 0 ? _MAC_Bridge_AclFieldLookup(pAcl->fieldTbl + ix, key.values[ix]) : &pAcl->fieldTbl[ix].anyMap;
+            for(wIx = 0; wIx < MAC_BRIDGE_ACL_MAP_WORDS; wIx++)
+            {
+                result.map[wIx] &= pMap->map[wIx];
+            }
+        }
+    }
+
+    for(ix = 0; ix < MAC_BRIDGE_ACL_RANGES; ix++)
+    {
+        fieldFlag = 1 << (MAC_BRIDGE_ACL_FIELDS + ix);
+        if((pAcl->matchFlags & fieldFlag) != 0)
+        {
+            pMap = (key.fieldFlags & fieldFlag) != 0 ? _MAC_Bridge_AclRangeLookup(pAcl->rangeTbl + ix, key.ports[ix]) : &pAcl->rangeTbl[ix].anyMap;
+            for(wIx = 0; wIx < MAC_BRIDGE_ACL_MAP_WORDS; wIx++)
+            {
+                result.map[wIx] &= pMap->map[wIx];
+            }
+        }
+    }
+
+    for(wIx = 0; wIx < MAC_BRIDGE_ACL_MAP_WORDS; wIx++)
+    {
+        word = result.map[wIx];
+        if(word != 0)
+        {   // the lowest bit set is the first matching rule
+            ruleIx = (wIx << 5) + 31 - _MAC_BridgeLeadingZeroes(word & (~word + 1));
+            pAcl->hits[ruleIx]++;
+            return pAcl->pRules[ruleIx].action != TCPIP_MAC_BRIDGE_ACL_ACTION_DROP;
+        }
+    }
+
+    // no rule matched
+    return true;
+}
+#endif  // (_TCPIP_MAC_BRIDGE_ACL != 0)
+
+// simplistic implementation of count leading zeros in a 32 bit value
+// It returns the number of contiguous leading zeroes
+#if !defined (__PIC32MX__) && !defined(__PIC32MZ__)
+static unsigned int _MAC_BridgeLeadingZeroes(uint32_t value)
+{
+    int ix;
+    uint32_t mask;
+    uint16_t nZeroes;
+
+    nZeroes = 0;
+    mask = 1 << 31;  // start from MSB
+
+    for(ix = 0; ix < 32; ix++)
+    {
+        if((value & mask) != 0)
+        {   // 1 detected
+            return nZeroes;
+        }
+
+        // 0 detected
+        nZeroes++;
+        mask >>= 1;
+    }
+
+    return nZeroes;
+}
+#endif  // !defined (__PIC32MX__) && !defined(__PIC32MZ__)
+
+
+
+size_t _MAC_BridgeHashKeyHash(OA_HASH_DCPT* pOH, const void* key)
 {
     return fnv_32_hash(key, MAC_BRIDGE_HASH_KEY_SIZE) % (pOH->hEntries);
 }
@@ -1906,13 +4857,21 @@ size_t _MAC_BridgeHashKeyHash(OA_HASH_DCPT* pOH, const void* key)
 // This should be taken care of the MAC_BRIDGE_Task()
 // However, there are static entries and the purgeTmo could be fairly long
 // So it's possible to be unable to make room in the cache
+// With the learning limits enabled, an entry without traffic for TCPIP_MAC_BRIDGE_LEARN_PROTECT_TIME
+// is evicted if there is no expired one
 OA_HASH_ENTRY* _MAC_BridgeHashEntryDelete(OA_HASH_DCPT* pOH)
 {
     _Mac_Bridge_AssertCond(pOH == gBridgeDcpt->hashDcpt, __func__, __LINE__);
 
     int ix;
     MAC_BRIDGE_HASH_ENTRY* hE;
-    int nEntries = gBridgeDcpt->hashDcpt->hEntries;
+    int nEntries = TCPIP_OAHASH_EntryRange(gBridgeDcpt->hashDcpt);
+
+#if (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+    MAC_BRIDGE_HASH_ENTRY* hOldest = 0;
+    // entries refreshed after this time are protected
+    uint32_t protectExpire = _MAC_Bridge_GetSecond() + gBridgeDcpt->purgeTmo - TCPIP_MAC_BRIDGE_LEARN_PROTECT_TIME;
+#endif  // (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
 
     for(ix = 0; ix < nEntries; ix++)
     {
@@ -1923,9 +4882,28 @@ OA_HASH_ENTRY* _MAC_BridgeHashEntryDelete(OA_HASH_DCPT* pOH)
             {   // expired entry; remove
                 return &hE->hEntry;
             }
+#if (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+            if((int32_t)(protectExpire - hE->tExpire) >= 0 && (hOldest == 0 || (int32_t)(hE->tExpire - hOldest->tExpire) < 0))
+            {   // idle long enough; the least recently refreshed is the candidate
+                hOldest = hE;
+            }
+#endif  // (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
         }
     }
     
+#if (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+    if(hOldest != 0)
+    {   // no expired entry, evict the oldest one that's not protected
+        if((hOldest->hEntry.flags.value & MAC_BRIDGE_HFLAG_PORT_VALID) != 0 && gBridgeDcpt->learnDcpt[hOldest->learnPort].nLearnt != 0)
+        {
+            gBridgeDcpt->learnDcpt[hOldest->learnPort].nLearnt--;
+        }
+        _MAC_Bridge_StatUpdate(gBridgeDcpt, MAC_BRIDGE_STAT_TYPE_FDB_EVICT, 1);
+        _MAC_Bridge_NotifyEvent(gBridgeDcpt, TCPIP_MAC_BRIDGE_EVENT_ENTRY_EVICTED, hOldest->destAdd.v);
+        return &hOldest->hEntry;
+    }
+#endif  // (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+
     return 0;
 }
 
@@ -1935,9 +4913,52 @@ int _MAC_BridgeHashKeyCompare(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* hEntry, const vo
     return memcmp(((MAC_BRIDGE_HASH_ENTRY*)hEntry)->destAdd.v, key, MAC_BRIDGE_HASH_KEY_SIZE);
 }
 
+#if (_TCPIP_MAC_BRIDGE_FDB_RESIZE != 0)
+// the key (address and VLAN) is stored contiguously in the entry
+const void* _MAC_BridgeHashEntryKey(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* hEntry)
+{
+    return ((MAC_BRIDGE_HASH_ENTRY*)hEntry)->destAdd.v;
+}
+
+void* _MAC_BridgeHashAlloc(OA_HASH_DCPT* pOH, size_t nBytes)
+{
+    return TCPIP_HEAP_Malloc(bridgeDcpt.memH, nBytes);
+}
+
+// a table released by a resize may still be read by the lock free FDB readers (management, console):
+// it is kept until there's none and freed by the bridge task.
+// The bridge task doesn't resize while there is a retired table.
+void _MAC_BridgeHashFree(OA_HASH_DCPT* pOH, void* memBlk)
+{
+    if(gBridgeDcpt != 0 && gBridgeDcpt->pFdbRetired == 0)
+    {
+        gBridgeDcpt->pFdbRetired = memBlk;
+    }
+    else
+    {
+        TCPIP_HEAP_Free(bridgeDcpt.memH, memBlk);
+    }
+}
+#endif  // (_TCPIP_MAC_BRIDGE_FDB_RESIZE != 0)
+
 void _MAC_BridgeHashKeyCopy(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* dstEntry, const void* key)
 {
-    memcpy(((MAC_BRIDGE_HASH_ENTRY*)dstEntry)->destAdd.v, key, MAC_BRIDGE_HASH_KEY_SIZE);
+    MAC_BRIDGE_HASH_ENTRY* hE = (MAC_BRIDGE_HASH_ENTRY*)dstEntry;
+
+    memcpy(hE->destAdd.v, key, MAC_BRIDGE_HASH_KEY_SIZE);
+#if (_TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+    // new entry, the counters of a reused slot start over
+    hE->fwdPackets = 0;
+    hE->txBytes = 0;
+    hE->rxPackets = 0;
+    hE->rxBytes = 0;
+#endif  // (_TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+#if (_TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
+    // new entry, clear the move history of a reused slot
+    hE->hEntry.flags.value &= ~MAC_BRIDGE_HFLAG_PINNED;
+    hE->moveCount = 0;
+    hE->moveBurst = 0;
+#endif  // (_TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
 }
 
 #if (_TCPIP_MAC_BRIDGE_STATISTICS != 0)
@@ -1987,6 +5008,309 @@ bool TCPIP_MAC_Bridge_StatisticsGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_
 }
 #endif  // (_TCPIP_MAC_BRIDGE_STATISTICS != 0)
 
+#if (_TCPIP_MAC_BRIDGE_BOOT_TIMESTAMPS != 0) 
+bool TCPIP_MAC_Bridge_BootTimesGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_BRIDGE_BOOT_TIMES* pTimes)
+{
+    int ix;
+    MAC_BRIDGE_DCPT* bDcpt = _MAC_Bridge_ValidateHandle(brHandle);
+
+    if(bDcpt == 0 || pTimes == 0)
+    {
+        return false;
+    }
+
+    MAC_BRIDGE_BOOT_STAMPS* pStamps = &bDcpt->bootStamps;
+    memset(pTimes, 0, sizeof(*pTimes));
+
+    pTimes->bridgeInit = _MAC_Bridge_BootStampToUs(pStamps->bridgeInit);
+    for(ix = 0; ix < bDcpt->nPorts; ix++)
+    {
+        pTimes->portUp[ix] = _MAC_Bridge_BootStampToUs(pStamps->portUp[ix]);
+        pTimes->portRx[ix] = _MAC_Bridge_BootStampToUs(pStamps->portRx[ix]);
+    }
+    pTimes->firstFwd = _MAC_Bridge_BootStampToUs(pStamps->firstFwd);
+    pTimes->bridgeReady = _MAC_Bridge_BootStampToUs(pStamps->bridgeReady);
+    pTimes->stackReady = _MAC_Bridge_BootStampToUs(pStamps->stackReady);
+
+    return true;
+}
+#else
+bool TCPIP_MAC_Bridge_BootTimesGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_BRIDGE_BOOT_TIMES* pTimes)
+{
+    return false;
+}
+#endif  // (_TCPIP_MAC_BRIDGE_BOOT_TIMESTAMPS != 0) 
+
+#if (_TCPIP_MAC_BRIDGE_WARM_START != 0) 
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_WarmSnapshot(TCPIP_MAC_BRIDGE_HANDLE brHandle)
+{
+    int nTries;
+    uint32_t seq;
+    MAC_BRIDGE_DCPT* pDcpt = _MAC_Bridge_ValidateHandle(brHandle);
+
+    if(pDcpt == 0)
+    {
+        return TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR;
+    }
+
+    if(!_MAC_Bridge_WarmClaim(pDcpt))
+    {   // the bridge task is writing the snapshot now
+        return TCPIP_MAC_BRIDGE_RES_LOCK_ERROR;
+    }
+
+    // lock free: retake the snapshot if the bridge updated the FDB meanwhile
+    for(nTries = 0; nTries < MAC_BRIDGE_FDB_READ_RETRIES; nTries++)
+    {
+        seq = _MAC_Bridge_FDBReadBegin(pDcpt);
+        _MAC_Bridge_WarmSnapshot(pDcpt);
+        if(_MAC_Bridge_FDBReadValid(pDcpt, seq))
+        {
+            _MAC_Bridge_WarmRelease(pDcpt);
+            return TCPIP_MAC_BRIDGE_RES_OK;
+        }
+    }
+
+    // do not leave an inconsistent snapshot behind
+    bridgeWarmSnap.magic = 0;
+    _MAC_Bridge_WarmRelease(pDcpt);
+    return TCPIP_MAC_BRIDGE_RES_LOCK_ERROR;
+}
+#else
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_WarmSnapshot(TCPIP_MAC_BRIDGE_HANDLE brHandle)
+{
+    return TCPIP_MAC_BRIDGE_RES_PARAM_ERROR;
+}
+#endif  // (_TCPIP_MAC_BRIDGE_WARM_START != 0) 
+
+#if (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+bool TCPIP_MAC_Bridge_RstpInfoGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_BRIDGE_RSTP_INFO* pInfo)
+{
+    int portIx;
+    MAC_BRIDGE_PORT_DCPT* pPort;
+    TCPIP_MAC_BRIDGE_RSTP_PORT_INFO* pPortInfo;
+    MAC_BRIDGE_DCPT* pDcpt = _MAC_Bridge_ValidateHandle(brHandle);
+
+    if(pDcpt == 0 || pInfo == 0)
+    {
+        return false;
+    }
+
+    // snapshot only, not protected against the bridge task
+    memset(pInfo, 0, sizeof(*pInfo));
+    memcpy(pInfo->bridgeId, pDcpt->bridgeId, sizeof(pInfo->bridgeId));
+    memcpy(pInfo->rootId, pDcpt->rootPrio.rootId, sizeof(pInfo->rootId));
+    pInfo->rootPathCost = _MAC_Bridge_RstpGet32(pDcpt->rootPrio.rootPathCost);
+    pInfo->tcCount = pDcpt->tcCount;
+    pInfo->tcAge = pDcpt->tcCount != 0 ? _MAC_Bridge_GetSecond() - pDcpt->tcSec : 0;
+    pInfo->rootPort = pDcpt->rootPort;
+    pInfo->nPorts = pDcpt->nPorts;
+
+    for(portIx = 0; portIx < pDcpt->nPorts; portIx++)
+    {
+        pPort = pDcpt->portDcpt + portIx;
+        pPortInfo = pInfo->portInfo + portIx;
+        memcpy(pPortInfo->designatedId, pPort->portPrio.designatedId, sizeof(pPortInfo->designatedId));
+        pPortInfo->pathCost = pPort->pathCost;
+        pPortInfo->rxBpdus = pPort->rxBpdus;
+        pPortInfo->txBpdus = pPort->txBpdus;
+        pPortInfo->tcCount = pPort->tcCount;
+        pPortInfo->designatedPort = _MAC_Bridge_RstpGet16(pPort->portPrio.designatedPort);
+        pPortInfo->portId = pPort->portId;
+        pPortInfo->role = pPort->role;
+        pPortInfo->state = pPort->state;
+        pPortInfo->portFlags = (pPort->portFlags & MAC_BRIDGE_RSTP_PFLAG_PUBLIC_MASK) | (pPort->adminEdge != 0 ? TCPIP_MAC_BRIDGE_RSTP_PORT_FLAG_ADMIN_EDGE : 0);
+    }
+
+    return true;
+}
+
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_RstpPortSet(TCPIP_MAC_BRIDGE_HANDLE brHandle, int portIx, const TCPIP_MAC_BRIDGE_RSTP_PORT_CONFIG* pPortCfg)
+{
+    MAC_BRIDGE_DCPT* pDcpt = _MAC_Bridge_ValidateHandle(brHandle);
+
+    if(pDcpt == 0)
+    {
+        return TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR;
+    }
+
+    if(pPortCfg == 0 || portIx < 0 || portIx >= pDcpt->nPorts)
+    {
+        return TCPIP_MAC_BRIDGE_RES_PARAM_ERROR;
+    }
+
+    // the port priority is a multiple of 16
+    if((pPortCfg->portPriority & 0x0f) != 0 || pPortCfg->pathCost > MAC_BRIDGE_RSTP_MAX_PATH_COST)
+    {
+        return TCPIP_MAC_BRIDGE_RES_PARAM_ERROR;
+    }
+
+    // the port data belongs to the bridge task:
+    // the change is applied by the next bridge task run
+    OSAL_CRITSECT_DATA_TYPE critStat = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+    pDcpt->rstpPortCfg[portIx] = *pPortCfg;
+    pDcpt->rstpCfgMask |= 1ul << portIx;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, critStat);
+
+    return TCPIP_MAC_BRIDGE_RES_OK;
+}
+#else
+bool TCPIP_MAC_Bridge_RstpInfoGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_BRIDGE_RSTP_INFO* pInfo)
+{
+    return false;
+}
+
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_RstpPortSet(TCPIP_MAC_BRIDGE_HANDLE brHandle, int portIx, const TCPIP_MAC_BRIDGE_RSTP_PORT_CONFIG* pPortCfg)
+{
+    return TCPIP_MAC_BRIDGE_RES_PARAM_ERROR;
+}
+#endif  // (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+
+#if (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_LearnLimitSet(TCPIP_MAC_BRIDGE_HANDLE brHandle, int portIx, const TCPIP_MAC_BRIDGE_LEARN_LIMIT* pLimit)
+{
+    MAC_BRIDGE_LEARN_DCPT* pLearn;
+    MAC_BRIDGE_DCPT* pDcpt = _MAC_Bridge_ValidateHandle(brHandle);
+
+    if(pDcpt == 0)
+    {
+        return TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR;
+    }
+
+    if(pLimit == 0 || portIx < 0 || portIx >= pDcpt->nPorts || pLimit->policy > TCPIP_MAC_BRIDGE_LEARN_POLICY_DISABLE)
+    {
+        return TCPIP_MAC_BRIDGE_RES_PARAM_ERROR;
+    }
+
+    pLearn = pDcpt->learnDcpt + portIx;
+    pLearn->maxEntries = pLimit->maxEntries;
+    pLearn->maxRate = pLimit->maxRate;
+    pLearn->policy = pLimit->policy;
+    pLearn->holdSec = 0;
+
+    return TCPIP_MAC_BRIDGE_RES_OK;
+}
+
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_LearnLimitGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, int portIx, TCPIP_MAC_BRIDGE_LEARN_LIMIT* pLimit, size_t* pnLearnt)
+{
+    MAC_BRIDGE_LEARN_DCPT* pLearn;
+    MAC_BRIDGE_DCPT* pDcpt = _MAC_Bridge_ValidateHandle(brHandle);
+
+    if(pDcpt == 0)
+    {
+        return TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR;
+    }
+
+    if(pLimit == 0 || portIx < 0 || portIx >= pDcpt->nPorts)
+    {
+        return TCPIP_MAC_BRIDGE_RES_PARAM_ERROR;
+    }
+
+    pLearn = pDcpt->learnDcpt + portIx;
+    pLimit->maxEntries = pLearn->maxEntries;
+    pLimit->maxRate = pLearn->maxRate;
+    pLimit->policy = pLearn->policy;
+    if(pnLearnt)
+    {
+        *pnLearnt = pLearn->nLearnt;
+    }
+
+    return TCPIP_MAC_BRIDGE_RES_OK;
+}
+#else
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_LearnLimitSet(TCPIP_MAC_BRIDGE_HANDLE brHandle, int portIx, const TCPIP_MAC_BRIDGE_LEARN_LIMIT* pLimit)
+{
+    return TCPIP_MAC_BRIDGE_RES_PARAM_ERROR;
+}
+
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_LearnLimitGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, int portIx, TCPIP_MAC_BRIDGE_LEARN_LIMIT* pLimit, size_t* pnLearnt)
+{
+    return TCPIP_MAC_BRIDGE_RES_PARAM_ERROR;
+}
+#endif  // (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+
+#if (_TCPIP_MAC_BRIDGE_ACL != 0)
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_AclSet(TCPIP_MAC_BRIDGE_HANDLE brHandle, const TCPIP_MAC_BRIDGE_ACL_RULE* pRules, size_t nRules)
+{
+    TCPIP_MAC_BRIDGE_RESULT res;
+    MAC_BRIDGE_ACL* pNewAcl;
+    MAC_BRIDGE_ACL* pOldAcl;
+    MAC_BRIDGE_DCPT* pDcpt = _MAC_Bridge_ValidateHandle(brHandle);
+
+    if(pDcpt == 0)
+    {
+        return TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR;
+    }
+
+    if(pDcpt->pAclRetired != 0)
+    {   // the bridge task did not release the previous ACL yet
+        return TCPIP_MAC_BRIDGE_RES_LOCK_ERROR;
+    }
+
+    res = _MAC_Bridge_AclCompile(pDcpt, pRules, nRules, &pNewAcl);
+    if(res != TCPIP_MAC_BRIDGE_RES_OK)
+    {
+        return res;
+    }
+
+    // switch first: the old ACL could still be in use by the packet processing
+    // the bridge task frees it; the task and the packet processing do not run concurrently
+    pOldAcl = pDcpt->pAcl;
+    pDcpt->pAcl = pNewAcl;
+    pDcpt->pAclRetired = pOldAcl;
+
+    return TCPIP_MAC_BRIDGE_RES_OK;
+}
+
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_AclGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_BRIDGE_ACL_RULE* pRules, uint32_t* pHits, size_t nRules, size_t* pnRules, bool clearHits)
+{
+    size_t ix, nAclRules;
+    MAC_BRIDGE_ACL* pAcl;
+    MAC_BRIDGE_DCPT* pDcpt = _MAC_Bridge_ValidateHandle(brHandle);
+
+    if(pDcpt == 0)
+    {
+        return TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR;
+    }
+
+    pAcl = pDcpt->pAcl;
+    nAclRules = pAcl != 0 ? pAcl->nRules : 0;
+
+    for(ix = 0; ix < nRules && ix < nAclRules; ix++)
+    {
+        if(pRules != 0)
+        {
+            pRules[ix] = pAcl->pRules[ix];
+        }
+        if(pHits != 0)
+        {
+            pHits[ix] = pAcl->hits[ix];
+        }
+    }
+
+    if(clearHits && pAcl != 0)
+    {
+        memset(pAcl->hits, 0, sizeof(pAcl->hits));
+    }
+
+    if(pnRules)
+    {
+        *pnRules = nAclRules;
+    }
+
+    return TCPIP_MAC_BRIDGE_RES_OK;
+}
+#else
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_AclSet(TCPIP_MAC_BRIDGE_HANDLE brHandle, const TCPIP_MAC_BRIDGE_ACL_RULE* pRules, size_t nRules)
+{
+    return TCPIP_MAC_BRIDGE_RES_PARAM_ERROR;
+}
+
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_AclGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_BRIDGE_ACL_RULE* pRules, uint32_t* pHits, size_t nRules, size_t* pnRules, bool clearHits)
+{
+    return TCPIP_MAC_BRIDGE_RES_PARAM_ERROR;
+}
+#endif  // (_TCPIP_MAC_BRIDGE_ACL != 0)
+
 #endif  //if defined(TCPIP_STACK_USE_MAC_BRIDGE)
 
 
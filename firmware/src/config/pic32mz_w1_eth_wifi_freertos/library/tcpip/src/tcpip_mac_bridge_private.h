@@ -81,6 +81,238 @@ Microchip or any third party.
 #define _TCPIP_MAC_BRIDGE_DYNAMIC_FDB_ACCESS 0
 #endif
 
+#if defined(TCPIP_MAC_BRIDGE_BOOT_TIMESTAMPS) && (TCPIP_MAC_BRIDGE_BOOT_TIMESTAMPS != 0)
+#define _TCPIP_MAC_BRIDGE_BOOT_TIMESTAMPS 1
+#else
+#define _TCPIP_MAC_BRIDGE_BOOT_TIMESTAMPS 0
+#endif
+
+#if defined(TCPIP_MAC_BRIDGE_WARM_START) && (TCPIP_MAC_BRIDGE_WARM_START != 0)
+#define _TCPIP_MAC_BRIDGE_WARM_START 1
+#else
+#define _TCPIP_MAC_BRIDGE_WARM_START 0
+#endif
+
+#if (_TCPIP_MAC_BRIDGE_WARM_START != 0)
+// rate of the FDB warm start snapshots, seconds
+#if !defined(TCPIP_MAC_BRIDGE_WARM_SNAPSHOT_RATE)
+#define TCPIP_MAC_BRIDGE_WARM_SNAPSHOT_RATE     5
+#endif
+// max lifetime of an entry restored from the snapshot, seconds
+#if !defined(TCPIP_MAC_BRIDGE_WARM_RESTORE_TMO)
+#define TCPIP_MAC_BRIDGE_WARM_RESTORE_TMO       30
+#endif
+#endif  // (_TCPIP_MAC_BRIDGE_WARM_START != 0)
+
+#if defined(TCPIP_MAC_BRIDGE_VLAN_SUPPORT) && (TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+#define _TCPIP_MAC_BRIDGE_VLAN_SUPPORT 1
+#else
+#define _TCPIP_MAC_BRIDGE_VLAN_SUPPORT 0
+#endif
+
+// IEEE 802.1Q tag: TPID (TCPIP_ETHER_TYPE_VLAN) + TCI
+#define MAC_BRIDGE_VLAN_TAG_SIZE        4
+#define MAC_BRIDGE_VLAN_VID_MASK        0x0fff      // VID part of the TCI
+
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+// max number of VLANs in the bridge VLAN table
+#if !defined(TCPIP_MAC_BRIDGE_MAX_VLANS)
+#define TCPIP_MAC_BRIDGE_MAX_VLANS      8
+#endif
+
+#define MAC_BRIDGE_VLAN_VID_MAX         4094        // 4095 is reserved
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+
+#if defined(TCPIP_MAC_BRIDGE_RSTP_SUPPORT) && (TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+#define _TCPIP_MAC_BRIDGE_RSTP_SUPPORT 1
+#else
+#define _TCPIP_MAC_BRIDGE_RSTP_SUPPORT 0
+#endif
+
+#if (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+// bridge priority, 0 - 61440, in steps of 4096
+#if !defined(TCPIP_MAC_BRIDGE_RSTP_PRIORITY)
+#define TCPIP_MAC_BRIDGE_RSTP_PRIORITY          32768
+#endif
+// RSTP times, seconds
+#if !defined(TCPIP_MAC_BRIDGE_RSTP_HELLO_TIME)
+#define TCPIP_MAC_BRIDGE_RSTP_HELLO_TIME        2
+#endif
+#if !defined(TCPIP_MAC_BRIDGE_RSTP_MAX_AGE)
+#define TCPIP_MAC_BRIDGE_RSTP_MAX_AGE           20
+#endif
+#if !defined(TCPIP_MAC_BRIDGE_RSTP_FORWARD_DELAY)
+#define TCPIP_MAC_BRIDGE_RSTP_FORWARD_DELAY     15
+#endif
+// default port path cost: 100 Mbps link
+#if !defined(TCPIP_MAC_BRIDGE_RSTP_PORT_PATH_COST)
+#define TCPIP_MAC_BRIDGE_RSTP_PORT_PATH_COST    200000
+#endif
+
+#define MAC_BRIDGE_RSTP_PORT_PRIORITY       128     // default port priority
+#define MAC_BRIDGE_RSTP_MAX_PATH_COST       200000000ul
+#define MAC_BRIDGE_RSTP_MIGRATE_TIME        3       // seconds; also the edge port detection delay
+#define MAC_BRIDGE_RSTP_TX_HOLD_COUNT       6       // max BPDUs transmitted per second on a port
+
+// BPDU encoding
+#define MAC_BRIDGE_RSTP_LLC_SAP             0x42    // IEEE 802.1D LLC DSAP/SSAP
+#define MAC_BRIDGE_RSTP_LLC_UI              0x03    // LLC unnumbered information
+#define MAC_BRIDGE_RSTP_BPDU_TYPE_CONFIG    0x00    // STP configuration BPDU
+#define MAC_BRIDGE_RSTP_BPDU_TYPE_TCN       0x80    // STP topology change notification BPDU
+#define MAC_BRIDGE_RSTP_BPDU_TYPE_RST       0x02    // RST BPDU
+#define MAC_BRIDGE_RSTP_VERSION             2
+#define MAC_BRIDGE_RSTP_TCN_BPDU_SIZE       4       // sizes without the LLC header
+#define MAC_BRIDGE_RSTP_CONFIG_BPDU_SIZE    35
+#define MAC_BRIDGE_RSTP_RST_BPDU_SIZE       36
+
+// BPDU flags
+#define MAC_BRIDGE_RSTP_BFLAG_TC            0x01    // topology change
+#define MAC_BRIDGE_RSTP_BFLAG_PROPOSAL      0x02
+#define MAC_BRIDGE_RSTP_BFLAG_ROLE_MASK     0x0c    // port role, encoded as MAC_BRIDGE_RSTP_BPDU_ROLE
+#define MAC_BRIDGE_RSTP_BFLAG_ROLE_SHIFT    2
+#define MAC_BRIDGE_RSTP_BFLAG_LEARNING      0x10
+#define MAC_BRIDGE_RSTP_BFLAG_FORWARDING    0x20
+#define MAC_BRIDGE_RSTP_BFLAG_AGREEMENT     0x40
+#define MAC_BRIDGE_RSTP_BFLAG_TC_ACK        0x80
+
+// port role as encoded in the BPDU flags
+#define MAC_BRIDGE_RSTP_BPDU_ROLE_ALT_BACKUP    1
+#define MAC_BRIDGE_RSTP_BPDU_ROLE_ROOT          2
+#define MAC_BRIDGE_RSTP_BPDU_ROLE_DESIGNATED    3
+#endif  // (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+
+#if defined(TCPIP_MAC_BRIDGE_LEARN_LIMITS) && (TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+#define _TCPIP_MAC_BRIDGE_LEARN_LIMITS 1
+#else
+#define _TCPIP_MAC_BRIDGE_LEARN_LIMITS 0
+#endif
+
+#if (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+// default per port limits; 0 - no limit
+#if !defined(TCPIP_MAC_BRIDGE_LEARN_MAX_ENTRIES)
+#define TCPIP_MAC_BRIDGE_LEARN_MAX_ENTRIES      0
+#endif
+#if !defined(TCPIP_MAC_BRIDGE_LEARN_RATE)
+#define TCPIP_MAC_BRIDGE_LEARN_RATE             0
+#endif
+// default TCPIP_MAC_BRIDGE_LEARN_POLICY
+#if !defined(TCPIP_MAC_BRIDGE_LEARN_VIOLATION)
+#define TCPIP_MAC_BRIDGE_LEARN_VIOLATION        TCPIP_MAC_BRIDGE_LEARN_POLICY_NOTIFY
+#endif
+// learning disabled time for TCPIP_MAC_BRIDGE_LEARN_POLICY_DISABLE, seconds
+#if !defined(TCPIP_MAC_BRIDGE_LEARN_HOLD_TIME)
+#define TCPIP_MAC_BRIDGE_LEARN_HOLD_TIME        30
+#endif
+// a dynamic entry with traffic within this time is not evicted from a full FDB, seconds
+#if !defined(TCPIP_MAC_BRIDGE_LEARN_PROTECT_TIME)
+#define TCPIP_MAC_BRIDGE_LEARN_PROTECT_TIME     10
+#endif
+#endif  // (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+
+#if defined(TCPIP_MAC_BRIDGE_MOVE_DAMPENING) && (TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
+#define _TCPIP_MAC_BRIDGE_MOVE_DAMPENING 1
+#else
+#define _TCPIP_MAC_BRIDGE_MOVE_DAMPENING 0
+#endif
+
+#if (_TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
+// maximum number of port moves within TCPIP_MAC_BRIDGE_MOVE_WINDOW
+// an entry that moves more often is pinned; 1 - 254
+#if !defined(TCPIP_MAC_BRIDGE_MOVE_THRESHOLD)
+#define TCPIP_MAC_BRIDGE_MOVE_THRESHOLD         4
+#endif
+// move counting window, seconds
+#if !defined(TCPIP_MAC_BRIDGE_MOVE_WINDOW)
+#define TCPIP_MAC_BRIDGE_MOVE_WINDOW            10
+#endif
+// time a flapping entry stays on its port, seconds
+#if !defined(TCPIP_MAC_BRIDGE_MOVE_PIN_TIME)
+#define TCPIP_MAC_BRIDGE_MOVE_PIN_TIME          60
+#endif
+// time the learning is blocked on the port the flapping entry moved to, seconds
+// 0 - learning is not blocked
+#if !defined(TCPIP_MAC_BRIDGE_MOVE_PORT_HOLD_TIME)
+#define TCPIP_MAC_BRIDGE_MOVE_PORT_HOLD_TIME    0
+#endif
+#endif  // (_TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
+
+#if defined(TCPIP_MAC_BRIDGE_ENTRY_COUNTERS) && (TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+#define _TCPIP_MAC_BRIDGE_ENTRY_COUNTERS 1
+#else
+#define _TCPIP_MAC_BRIDGE_ENTRY_COUNTERS 0
+#endif
+
+// TCPIP_MAC_BRIDGE_TX_BACKLOG: max number of frames held per port
+// when the MAC driver cannot take them; 0 - no backlog, the frames are dropped
+#if defined(TCPIP_MAC_BRIDGE_TX_BACKLOG) && (TCPIP_MAC_BRIDGE_TX_BACKLOG != 0)
+#define _TCPIP_MAC_BRIDGE_TX_BACKLOG 1
+#else
+#define _TCPIP_MAC_BRIDGE_TX_BACKLOG 0
+#endif
+
+// the ACK filter works on the TX backlog
+#if (_TCPIP_MAC_BRIDGE_TX_BACKLOG != 0) && defined(TCPIP_MAC_BRIDGE_ACK_FILTER) && (TCPIP_MAC_BRIDGE_ACK_FILTER != 0)
+#define _TCPIP_MAC_BRIDGE_ACK_FILTER 1
+#else
+#define _TCPIP_MAC_BRIDGE_ACK_FILTER 0
+#endif
+
+#if defined(TCPIP_MAC_BRIDGE_ACL) && (TCPIP_MAC_BRIDGE_ACL != 0)
+#define _TCPIP_MAC_BRIDGE_ACL 1
+#else
+#define _TCPIP_MAC_BRIDGE_ACL 0
+#endif
+
+#if (_TCPIP_MAC_BRIDGE_ACL != 0)
+// max number of rules in the ingress ACL
+#if !defined(TCPIP_MAC_BRIDGE_ACL_MAX_RULES)
+#define TCPIP_MAC_BRIDGE_ACL_MAX_RULES      16
+#endif
+
+// the compiled ACL supports at most 64 rules: 2 words for each rule bitmap
+#if (TCPIP_MAC_BRIDGE_ACL_MAX_RULES > 64) || (TCPIP_MAC_BRIDGE_ACL_MAX_RULES <= 0)
+#error "TCPIP_MAC_BRIDGE_ACL_MAX_RULES should be within 1 - 64"
+#endif
+
+#define MAC_BRIDGE_ACL_MAP_WORDS    ((TCPIP_MAC_BRIDGE_ACL_MAX_RULES + 31) / 32)
+#endif  // (_TCPIP_MAC_BRIDGE_ACL != 0)
+
+// TCPIP_MAC_BRIDGE_FDB_MAX_ENTRIES: the FDB grows with the number of stations up to this size
+// and shrinks back to fdbEntries; 0 - fixed size FDB
+#if defined(TCPIP_MAC_BRIDGE_FDB_MAX_ENTRIES) && (TCPIP_MAC_BRIDGE_FDB_MAX_ENTRIES != 0)
+#define _TCPIP_MAC_BRIDGE_FDB_RESIZE 1
+#else
+#define _TCPIP_MAC_BRIDGE_FDB_RESIZE 0
+#endif
+
+#if (_TCPIP_MAC_BRIDGE_FDB_RESIZE != 0)
+// FDB load percentages that double/halve the table
+#if !defined(TCPIP_MAC_BRIDGE_FDB_GROW_LOAD)
+#define TCPIP_MAC_BRIDGE_FDB_GROW_LOAD      75
+#endif
+#if !defined(TCPIP_MAC_BRIDGE_FDB_SHRINK_LOAD)
+#define TCPIP_MAC_BRIDGE_FDB_SHRINK_LOAD    25
+#endif
+
+// a halved table should not need to grow right away
+#if (TCPIP_MAC_BRIDGE_FDB_GROW_LOAD >= 100) || (TCPIP_MAC_BRIDGE_FDB_SHRINK_LOAD * 2 >= TCPIP_MAC_BRIDGE_FDB_GROW_LOAD)
+#error "TCPIP_MAC_BRIDGE_FDB_GROW_LOAD should be < 100 and more than twice TCPIP_MAC_BRIDGE_FDB_SHRINK_LOAD"
+#endif
+
+// number of FDB buckets moved to the resized table by each bridge task run
+// the learning of new stations moves some more
+#define MAC_BRIDGE_FDB_RESIZE_STEPS         32
+#endif  // (_TCPIP_MAC_BRIDGE_FDB_RESIZE != 0)
+
+// number of times a lock-free FDB reader retries its copy
+// if the FDB was updated in the meantime
+#define MAC_BRIDGE_FDB_READ_RETRIES     8
+
+// rate of the bridge task while the bridge ports are coming up, ms
+// the host entries are installed as soon as a port interface is up
+// so the bridge needs to check more often than the regular TCPIP_MAC_BRIDGE_TASK_RATE
+#define MAC_BRIDGE_BOOT_TASK_RATE       10
+
 
 // enumeration for statistics function
 // specify the statistics index (type)
@@ -94,6 +326,7 @@ typedef enum
     MAC_BRIDGE_STAT_TYPE_FAIL_SIZE,
     MAC_BRIDGE_STAT_TYPE_FAIL_LOCK,
     MAC_BRIDGE_STAT_TYPE_FDB_FULL,
+    MAC_BRIDGE_STAT_TYPE_FDB_EVICT,
 
     MAC_BRIDGE_STAT_TYPE_ALLOC_PKTS,
     MAC_BRIDGE_STAT_TYPE_ALLOC_DCPTS,
@@ -115,25 +348,226 @@ typedef enum
     MAC_BRIDGE_STAT_TYPE_FWD_UCAST_PKTS,
     MAC_BRIDGE_STAT_TYPE_FWD_MCAST_PKTS,
     MAC_BRIDGE_STAT_TYPE_FWD_DIRECT_PKTS,
+    MAC_BRIDGE_STAT_TYPE_VLAN_DISCARD_PKTS,
+    MAC_BRIDGE_STAT_TYPE_RSTP_DISCARD_PKTS,
+    MAC_BRIDGE_STAT_TYPE_LEARN_DENIED,
+    MAC_BRIDGE_STAT_TYPE_LEARN_DROP_PKTS,
+    MAC_BRIDGE_STAT_TYPE_MAC_MOVES,
+    MAC_BRIDGE_STAT_TYPE_MOVE_DENIED_PKTS,
+    MAC_BRIDGE_STAT_TYPE_BACKLOG_PKTS,
+    MAC_BRIDGE_STAT_TYPE_BACKLOG_DROP_PKTS,
+    MAC_BRIDGE_STAT_TYPE_ACK_FILTERED,
+    MAC_BRIDGE_STAT_TYPE_ACL_DROP_PKTS,
     
 }MAC_BRIDGE_STAT_TYPE;
 
 
-// Bridge input/output port descriptor
-// This is advanced/not currently supported
+#if (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+// RSTP priority vector
+// kept in network order, as carried by the BPDUs, so that the vectors compare with memcmp:
+// the lower the better
+typedef struct __attribute__((packed))
+{
+    uint8_t     rootId[8];          // root bridge ID: 2 bytes priority + MAC address
+    uint8_t     rootPathCost[4];    // path cost to the root bridge
+    uint8_t     designatedId[8];    // designated bridge ID
+    uint8_t     designatedPort[2];  // designated port ID
+    uint8_t     bridgePort[2];      // ID of the port the vector was received on
+                                    // not part of the BPDU; used only for the root port selection
+}MAC_BRIDGE_RSTP_VECTOR;
+
+// part of the vector carried by a BPDU
+#define MAC_BRIDGE_RSTP_MSG_VECTOR_SIZE     (sizeof(MAC_BRIDGE_RSTP_VECTOR) - sizeof(((MAC_BRIDGE_RSTP_VECTOR*)0)->bridgePort))
+
+// RSTP times, seconds
 typedef struct
 {
-    uint8_t userPriority;       // priority associated with this port
-                                // IEEE 802.3 frames do not encode priority
-                                // Value 0 - 7; Default is 0; Can be set by management
-    uint8_t portState;          // whether the port forwards or not, it learns or not
-                                // Discarding: excluded from forwarding and learning
-                                // Learning: learning enabled but forwarding disabled
-                                // Forwarding: learns and forwards
-    
-
+    uint8_t     messageAge;
+    uint8_t     maxAge;
+    uint8_t     helloTime;
+    uint8_t     fwdDelay;
+}MAC_BRIDGE_RSTP_TIMES;
+
+// BPDU, following the 802.3 header
+// the times are in 1/256 seconds, big endian
+typedef struct __attribute__((packed))
+{
+    uint8_t     dsap;               // MAC_BRIDGE_RSTP_LLC_SAP
+    uint8_t     ssap;               // MAC_BRIDGE_RSTP_LLC_SAP
+    uint8_t     llcCtrl;            // MAC_BRIDGE_RSTP_LLC_UI
+    uint8_t     protocolId[2];      // 0
+    uint8_t     version;            // 0 - STP, 2 - RSTP
+    uint8_t     bpduType;           // MAC_BRIDGE_RSTP_BPDU_TYPE_xxx
+    // the TCN BPDU ends here
+    uint8_t     flags;              // MAC_BRIDGE_RSTP_BFLAG_xxx
+    uint8_t     msgVector[MAC_BRIDGE_RSTP_MSG_VECTOR_SIZE];
+    uint8_t     messageAge[2];
+    uint8_t     maxAge[2];
+    uint8_t     helloTime[2];
+    uint8_t     fwdDelay[2];
+    // the configuration BPDU ends here
+    uint8_t     version1Len;        // 0
+}MAC_BRIDGE_RSTP_BPDU;
+
+// source of the port priority vector
+typedef enum
+{
+    MAC_BRIDGE_RSTP_INFO_DISABLED   = 0,    // port disabled
+    MAC_BRIDGE_RSTP_INFO_AGED,              // no valid info; the port needs to be (re)assigned
+    MAC_BRIDGE_RSTP_INFO_MINE,              // the designated info of this bridge
+    MAC_BRIDGE_RSTP_INFO_RECEIVED,          // info received from the designated bridge of the port LAN
+}MAC_BRIDGE_RSTP_INFO;
+
+// RSTP port flags
+// NOTE: the low 5 bits are the TCPIP_MAC_BRIDGE_RSTP_PORT_FLAGS
+// Keep them in sync!
+typedef enum
+{
+    MAC_BRIDGE_RSTP_PFLAG_NONE          = 0x00,
+    MAC_BRIDGE_RSTP_PFLAG_ENABLED       = 0x01,     // port is up and linked
+    // 0x02 is the adminEdge setting, kept separately
+    MAC_BRIDGE_RSTP_PFLAG_OPER_EDGE     = 0x04,     // no bridge detected on the port LAN
+    MAC_BRIDGE_RSTP_PFLAG_PROPOSING     = 0x08,     // designated port sends proposals
+    MAC_BRIDGE_RSTP_PFLAG_AGREED        = 0x10,     // the neighbor agreed to our proposal
+    MAC_BRIDGE_RSTP_PFLAG_PROPOSED      = 0x20,     // a proposal was received on the port
+    MAC_BRIDGE_RSTP_PFLAG_AGREE         = 0x40,     // an agreement needs to be sent on the port
+    MAC_BRIDGE_RSTP_PFLAG_NEW_INFO      = 0x80,     // a BPDU needs to be sent on the port
+
+    MAC_BRIDGE_RSTP_PFLAG_PUBLIC_MASK   = 0x1d,     // flags reported as TCPIP_MAC_BRIDGE_RSTP_PORT_FLAGS
+}MAC_BRIDGE_RSTP_PORT_FLAGS;
+
+// RSTP bridge flags
+typedef enum
+{
+    MAC_BRIDGE_RSTP_FLAG_NONE           = 0x00,
+    MAC_BRIDGE_RSTP_FLAG_ID_VALID       = 0x01,     // bridge ID set from a port MAC address
+    MAC_BRIDGE_RSTP_FLAG_RESELECT       = 0x02,     // port roles need to be recomputed
+}MAC_BRIDGE_RSTP_FLAGS;
 
+// Bridge port descriptor
+// the IEEE 802.1D-2004 clause 17 per port RSTP data
+typedef struct
+{
+    MAC_BRIDGE_RSTP_VECTOR  portPrio;   // port priority vector: received info or this bridge designated info
+    MAC_BRIDGE_RSTP_VECTOR  desgPrio;   // designated priority vector, computed by the role selection
+    MAC_BRIDGE_RSTP_TIMES   portTimes;  // times received along with the portPrio
+    uint32_t    pathCost;           // port path cost
+    uint32_t    rxBpdus;            // BPDUs received
+    uint32_t    txBpdus;            // BPDUs transmitted
+    uint32_t    tcCount;            // topology changes detected/received on this port
+    uint16_t    portId;             // port identifier: 4 bits priority, 12 bits port number
+    uint8_t     adminEdge;          // port configured as edge
+    uint8_t     portFlags;          // MAC_BRIDGE_RSTP_PORT_FLAGS value
+    uint8_t     role;               // TCPIP_MAC_BRIDGE_PORT_ROLE value
+    uint8_t     state;              // TCPIP_MAC_BRIDGE_PORT_STATE value
+    uint8_t     infoIs;             // MAC_BRIDGE_RSTP_INFO value
+    // timers, seconds
+    uint8_t     helloWhen;          // next periodic BPDU on a designated port
+    uint8_t     fdWhile;            // delay of the next state transition, without an agreement
+    uint8_t     tcWhile;            // BPDUs carry the TC flag while != 0
+    uint8_t     rcvdInfoWhile;      // received info ages out when 0
+    uint8_t     edgeDelayWhile;     // no BPDU received for this time: a proposing port becomes edge
+    uint8_t     txCount;            // BPDUs transmitted in the current second
 }MAC_BRIDGE_PORT_DCPT;
+#endif  // (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+
+// result of the learning limits check for a new source address
+typedef enum
+{
+    MAC_BRIDGE_LEARN_RES_ALLOW      = 0,    // address can be learnt
+    MAC_BRIDGE_LEARN_RES_DENY,              // address not learnt, the frame is forwarded
+    MAC_BRIDGE_LEARN_RES_DROP,              // address not learnt, the frame is dropped
+}MAC_BRIDGE_LEARN_RES;
+
+#if (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+// per port learning limits and state
+typedef struct
+{
+    uint16_t    maxEntries;         // max number of learnt dynamic entries; 0 - no limit
+    uint16_t    maxRate;            // max number of new addresses per second; 0 - no limit
+    uint16_t    nLearnt;            // dynamic entries currently learnt on the port
+                                    // recounted by the bridge task, incremented on learning
+    uint16_t    rateCount;          // addresses learnt in the current second
+    uint32_t    rateSec;            // bridge second the rateCount refers to
+    uint32_t    holdSec;            // learning disabled until this bridge second
+    uint32_t    notifySec;          // bridge second of the last TCPIP_MAC_BRIDGE_EVENT_LEARN_DENIED
+    uint8_t     policy;             // TCPIP_MAC_BRIDGE_LEARN_POLICY value
+}MAC_BRIDGE_LEARN_DCPT;
+#endif  // (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+
+#if (_TCPIP_MAC_BRIDGE_ACL != 0)
+// ACL fields matched on a value
+// Note: the field index is the bit number of its TCPIP_MAC_BRIDGE_ACL_MATCH flag
+// Keep them in sync!
+typedef enum
+{
+    MAC_BRIDGE_ACL_FIELD_IN_PORT    = 0,
+    MAC_BRIDGE_ACL_FIELD_SRC_MAC,
+    MAC_BRIDGE_ACL_FIELD_DEST_MAC,
+    MAC_BRIDGE_ACL_FIELD_ETHER_TYPE,
+    MAC_BRIDGE_ACL_FIELD_VLAN,
+    MAC_BRIDGE_ACL_FIELD_IP_PROTO,
+
+    MAC_BRIDGE_ACL_FIELDS               // number of value fields
+}MAC_BRIDGE_ACL_FIELD;
+
+// ACL fields matched on a range
+// their TCPIP_MAC_BRIDGE_ACL_MATCH flags follow the value fields
+typedef enum
+{
+    MAC_BRIDGE_ACL_RANGE_SRC_PORT   = 0,
+    MAC_BRIDGE_ACL_RANGE_DEST_PORT,
+
+    MAC_BRIDGE_ACL_RANGES               // number of range fields
+}MAC_BRIDGE_ACL_RANGE;
+
+// rule bitmap: bit n set - rule n matches
+// rule 0 has the highest priority
+typedef struct
+{
+    uint32_t    map[MAC_BRIDGE_ACL_MAP_WORDS];
+}MAC_BRIDGE_ACL_MAP;
+
+// compiled value field: the distinct values the rules match on
+typedef struct
+{
+    uint64_t*           pValues;    // sorted distinct values
+    MAC_BRIDGE_ACL_MAP* pMaps;      // pMaps[n]: rules matching pValues[n]
+    MAC_BRIDGE_ACL_MAP  anyMap;     // rules that do not check this field
+                                    // the result for a value not in pValues or a frame without this field
+    uint16_t            nValues;
+}MAC_BRIDGE_ACL_FIELD_TBL;
+
+// compiled range field: the rule ranges split into disjoint intervals
+typedef struct
+{
+    uint16_t*           pStarts;    // sorted interval starts; pStarts[0] == 0
+    MAC_BRIDGE_ACL_MAP* pMaps;      // pMaps[n]: rules matching [pStarts[n], pStarts[n + 1])
+    MAC_BRIDGE_ACL_MAP  anyMap;     // rules that do not check this field; the result for a frame without L4 ports
+    uint16_t            nIntervals;
+}MAC_BRIDGE_ACL_RANGE_TBL;
+
+// compiled ACL
+// allocated as a single block: the rules, the value and map arrays follow this header
+typedef struct
+{
+    TCPIP_MAC_BRIDGE_ACL_RULE*  pRules;         // copy of the rules, for reporting
+    MAC_BRIDGE_ACL_FIELD_TBL    fieldTbl[MAC_BRIDGE_ACL_FIELDS];
+    MAC_BRIDGE_ACL_RANGE_TBL    rangeTbl[MAC_BRIDGE_ACL_RANGES];
+    MAC_BRIDGE_ACL_MAP          allMap;         // all the rules
+    uint32_t                    hits[TCPIP_MAC_BRIDGE_ACL_MAX_RULES];  // frames matched by each rule
+    uint16_t                    nRules;
+    uint16_t                    matchFlags;     // TCPIP_MAC_BRIDGE_ACL_MATCH: the fields checked by any rule
+}MAC_BRIDGE_ACL;
+
+// frame fields looked up in the compiled ACL
+typedef struct
+{
+    uint64_t    values[MAC_BRIDGE_ACL_FIELDS];
+    uint16_t    ports[MAC_BRIDGE_ACL_RANGES];
+    uint16_t    fieldFlags;     // TCPIP_MAC_BRIDGE_ACL_MATCH: the fields present in the frame
+}MAC_BRIDGE_ACL_KEY;
+#endif  // (_TCPIP_MAC_BRIDGE_ACL != 0)
 
 // static filtering entry in the filtering database
 // under management control
@@ -175,7 +609,19 @@ typedef struct
 
 // hash probe step
 #define     MAC_BRIDGE_HASH_PROBE_STEP      1
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+// the FDB key is the (MAC address, VLAN ID) pair
+// the vlanId follows the destAdd in both the key and the hash entry
+#define     MAC_BRIDGE_HASH_KEY_SIZE        (sizeof(((MAC_BRIDGE_HASH_ENTRY*)0)->destAdd) + sizeof(((MAC_BRIDGE_HASH_ENTRY*)0)->vlanId))
+
+typedef struct __attribute__((packed))
+{
+    TCPIP_MAC_ADDR      destAdd;
+    uint16_t            vlanId;
+}MAC_BRIDGE_HASH_KEY;
+#else
 #define     MAC_BRIDGE_HASH_KEY_SIZE        (sizeof(((MAC_BRIDGE_HASH_ENTRY*)0)->destAdd))
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
 
 
 // bridge hash flags; part of the OA_HASH_ENTRY
@@ -188,8 +634,9 @@ typedef enum
                                                 // otherwise dynamic entry
     MAC_BRIDGE_HFLAG_HOST        = 0x0200,      // entry is for one of the interfaces belonging to this host
     MAC_BRIDGE_HFLAG_PORT_VALID  = 0x0400,      // the learnPort value is valid - mainly for a static entry
+    MAC_BRIDGE_HFLAG_PINNED      = 0x0800,      // dynamic entry pinned to its learnPort, moves are ignored
 
-    MAC_BRIDGE_HFLAG_MASK        = 0x0700,      // all flags mask
+    MAC_BRIDGE_HFLAG_MASK        = 0x0f00,      // all flags mask
 }MAC_BRIDGE_HASH_FLAGS;
 
 // Bridge FDB entry
@@ -199,8 +646,23 @@ typedef struct _TAG_MAC_BRIDGE_HASH_ENTRY
     // use the same filtering database for both static and dynamic entries
     uint32_t            tExpire;        // dynamic entry: expiration time - range: [10 - 1,000,000] sec. Default 300s. Granularity 1 sec.
     uint32_t            fwdPackets;     // number of packets forwarded for this destination address
+#if (_TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+    uint32_t            txBytes;        // bytes forwarded for this destination address
+    uint32_t            rxPackets;      // packets received from this source address
+    uint32_t            rxBytes;        // bytes received from this source address
+#endif  // (_TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
     TCPIP_MAC_ADDR      destAdd;        // dynamic entry - individual MAC address
                                         // static entry - individual MAC address or a group of MAC addresses
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+    uint16_t            vlanId;         // dynamic entry: VLAN the address was learnt on; part of the key
+                                        // static entry: 0, applies to all VLANs
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+#if (_TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
+    uint32_t            moveSec;        // bridge second the current move window started
+    uint32_t            pinSec;         // MAC_BRIDGE_HFLAG_PINNED entry: pinned until this bridge second
+    uint16_t            moveCount;      // total number of port moves, saturated
+    uint8_t             moveBurst;      // number of moves in the current window
+#endif  // (_TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0)
     uint8_t             learnPort;      // dynamic entry: port number this address has been learned on:
                                         //          this is where the packets with this destination will be forwarded
                                         // static entry: port number this address has been learned on
@@ -218,6 +680,57 @@ typedef struct _TAG_MAC_BRIDGE_HASH_ENTRY
 }MAC_BRIDGE_HASH_ENTRY;
 
 
+#if (_TCPIP_MAC_BRIDGE_BOOT_TIMESTAMPS != 0) 
+// bridge boot stages time stamps
+// raw SYS_TIME counter values, taken from the core timer
+// 0 means that stage was not reached yet
+typedef struct
+{
+    uint64_t    bridgeInit;         // bridge module initialized
+    uint64_t    portUp[TCPIP_MAC_BRIDGE_MAX_PORTS_NO];      // port interface up, host entry installed
+    uint64_t    portRx[TCPIP_MAC_BRIDGE_MAX_PORTS_NO];      // first frame received on the port
+    uint64_t    firstFwd;           // first frame forwarded
+    uint64_t    bridgeReady;        // all ports up, bridge status ready
+    uint64_t    stackReady;         // TCP/IP stack initialization completed
+}MAC_BRIDGE_BOOT_STAMPS;
+#endif  // (_TCPIP_MAC_BRIDGE_BOOT_TIMESTAMPS != 0) 
+
+#if (_TCPIP_MAC_BRIDGE_WARM_START != 0) 
+// warm start snapshot of the learnt FDB entries
+// kept in persistent RAM, so it survives a soft reset
+#define MAC_BRIDGE_WARM_MAGIC       0x42524447u     // "BRDG"
+
+typedef struct
+{
+    TCPIP_MAC_ADDR  destAdd;        // learnt address
+    uint16_t        vlanId;         // VLAN the address was learnt on, 0 if not VLAN aware
+    uint8_t         learnPort;      // port the address was learnt on
+    uint8_t         reserved[3];    // padding, 0
+    uint32_t        age;            // seconds since the entry was last refreshed
+}MAC_BRIDGE_WARM_ENTRY;
+
+typedef struct
+{
+    uint32_t        magic;          // MAC_BRIDGE_WARM_MAGIC if the snapshot is valid
+    uint16_t        checksum;       // checksum of all the following fields
+    uint16_t        cfgHash;        // hash of the bridge configuration the snapshot was taken with
+    uint16_t        nEntries;       // number of valid entries
+    uint16_t        reserved;       // padding, 0
+    MAC_BRIDGE_WARM_ENTRY entries[TCPIP_MAC_BRIDGE_FDB_TABLE_ENTRIES];
+}MAC_BRIDGE_WARM_SNAPSHOT;
+#endif  // (_TCPIP_MAC_BRIDGE_WARM_START != 0) 
+
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+// run time VLAN descriptor
+// built from the TCPIP_MAC_BRIDGE_VLAN_ENTRY configuration
+typedef struct
+{
+    uint32_t        memberMap;      // map of the member ports
+    uint32_t        untagMap;       // map of the ports transmitting the VLAN frames untagged
+    uint16_t        vlanId;         // VLAN ID
+}MAC_BRIDGE_VLAN_DCPT;
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+
 // the MAC bridge hash descriptor
 // the FDB is built of hash entries
 // access to the FDB has to be protected against multi-thread access
@@ -238,6 +751,7 @@ typedef struct
     uint8_t             pktReplenish;   // Number of packets to replenish the pool, when it becomes empty
     uint8_t             nPorts;         // number of ports in the bridge
     uint8_t             bridgeLock;     // access to FDB is locked
+                                        // used only by the FDB writers: packet processing, task, management updates
     int8_t              status;         // current bridge status: SYS_STATUS
     
     SINGLE_LIST         pktPool;        // packet pool
@@ -261,9 +775,71 @@ typedef struct
     TCPIP_MAC_BRIDGE_EVENT_HANDLER  evHandler;
 #endif  // (_TCPIP_MAC_BRIDGE_EVENT_NOTIFY  != 0) 
 
+#if (_TCPIP_MAC_BRIDGE_BOOT_TIMESTAMPS != 0) 
+    MAC_BRIDGE_BOOT_STAMPS  bootStamps;     // boot stages time stamps
+#endif  // (_TCPIP_MAC_BRIDGE_BOOT_TIMESTAMPS != 0) 
+
+    uint32_t            hostPortMask;       // map of ports that have the host entry installed
+    volatile uint32_t   fdbSeq;             // FDB sequence count, for the readers that do not take the bridgeLock
+                                            // odd while an FDB update is in progress
+#if (_TCPIP_MAC_BRIDGE_WARM_START != 0) 
+    uint32_t            warmSnapSec;        // bridge time of the last warm start snapshot
+    uint8_t             warmSnapBusy;       // the snapshot buffer is being written, by the bridge task or by the API
+#endif  // (_TCPIP_MAC_BRIDGE_WARM_START != 0) 
+
     uint8_t             bridgeFlags;        // TCPIP_MAC_BRIDGE_FLAGS value
     uint8_t             dcptReplenish;      // Number of descriptors to replenish the pool, when it becomes empty
     uint8_t             port2IfIx[TCPIP_MAC_BRIDGE_MAX_PORTS_NO];   // table with the interface indexes corresponding to the port
+
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+    uint16_t            nVlans;             // number of VLANs in vlanTbl; 0 if the bridge is not VLAN aware
+    uint16_t            portPvid[TCPIP_MAC_BRIDGE_MAX_PORTS_NO];    // PVID of each port; 0 if none: untagged frames are discarded
+    MAC_BRIDGE_VLAN_DCPT vlanTbl[TCPIP_MAC_BRIDGE_MAX_VLANS];
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+
+#if (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+    MAC_BRIDGE_RSTP_VECTOR  rootPrio;       // root priority vector of the bridge
+    MAC_BRIDGE_RSTP_TIMES   rootTimes;      // times used for the designated ports
+    uint8_t             bridgeId[8];        // 2 bytes priority + MAC address of the first port up
+    uint32_t            rstpFwdMap;         // map of the ports in the forwarding state
+    uint32_t            rstpLearnMap;       // map of the ports in the learning or forwarding state
+    uint32_t            rstpSec;            // bridge time of the last RSTP tick
+    uint32_t            tcCount;            // number of topology changes
+    uint32_t            tcSec;              // bridge time of the last topology change
+    int8_t              rootPort;           // current root port, < 0 if this is the root bridge
+    uint8_t             rstpFlags;          // MAC_BRIDGE_RSTP_FLAGS value
+    MAC_BRIDGE_PORT_DCPT portDcpt[TCPIP_MAC_BRIDGE_MAX_PORTS_NO];
+    uint32_t            rstpCfgMask;        // map of the ports with a pending configuration change
+    TCPIP_MAC_BRIDGE_RSTP_PORT_CONFIG rstpPortCfg[TCPIP_MAC_BRIDGE_MAX_PORTS_NO];  // pending port configuration
+                                            // set by TCPIP_MAC_Bridge_RstpPortSet(), applied by the bridge task
+#endif  // (_TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0)
+
+#if (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+    MAC_BRIDGE_LEARN_DCPT learnDcpt[TCPIP_MAC_BRIDGE_MAX_PORTS_NO];
+#endif  // (_TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0)
+
+#if (_TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0) && (TCPIP_MAC_BRIDGE_MOVE_PORT_HOLD_TIME != 0)
+    uint32_t            moveHoldSec[TCPIP_MAC_BRIDGE_MAX_PORTS_NO];    // learning blocked on the port until this bridge second
+#endif  // (_TCPIP_MAC_BRIDGE_MOVE_DAMPENING != 0) && (TCPIP_MAC_BRIDGE_MOVE_PORT_HOLD_TIME != 0)
+
+#if (_TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+    volatile uint8_t    countersReset;      // TCPIP_MAC_Bridge_FDBCountersReset() request, done by the bridge task
+#endif  // (_TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0)
+
+#if (_TCPIP_MAC_BRIDGE_TX_BACKLOG != 0)
+    SINGLE_LIST         txBacklog[TCPIP_MAC_BRIDGE_MAX_PORTS_NO];   // frames waiting for a busy MAC, in order
+    uint8_t             backlogService;     // the backlog is being retried
+#endif  // (_TCPIP_MAC_BRIDGE_TX_BACKLOG != 0)
+
+#if (_TCPIP_MAC_BRIDGE_ACL != 0)
+    MAC_BRIDGE_ACL* volatile pAcl;          // current compiled ACL; 0 if none
+    MAC_BRIDGE_ACL* volatile pAclRetired;   // ACL replaced by TCPIP_MAC_Bridge_AclSet, freed by the bridge task
+#endif  // (_TCPIP_MAC_BRIDGE_ACL != 0)
+
+#if (_TCPIP_MAC_BRIDGE_FDB_RESIZE != 0)
+    void*               pFdbRetired;        // FDB table left behind by a resize, freed by the bridge task
+    int                 fdbReaders;         // lock free FDB readers in progress
+#endif  // (_TCPIP_MAC_BRIDGE_FDB_RESIZE != 0)
     
 }MAC_BRIDGE_DCPT;
 
@@ -271,6 +847,9 @@ typedef enum
 {
     MAC_BRIDGE_FWD_FLAG_NONE    = 0x00,     // no flag set
     MAC_BRIDGE_FWD_FLAG_MCAST   = 0x01,     // forward for a multicast address
+    MAC_BRIDGE_FWD_FLAG_VLAN    = 0x02,     // VLAN aware forwarding: the frame needs to be tagged/untagged per output port
+    MAC_BRIDGE_FWD_FLAG_TAGGED  = 0x04,     // frame was received with a VLAN tag
+    MAC_BRIDGE_FWD_FLAG_BACKLOG = 0x08,     // frame is in or retried from a port TX backlog
     //
     // ...
 }MAC_BRIDGE_FWD_FLAGS;
@@ -283,11 +862,28 @@ typedef enum
     MAC_BRIDGE_ALLOC_FLAG_STICKY        = 0x02,     // packet belongs to the pool, should be returned
                                                     // otherwise should be freed    
                                                     // only if MAC_BRIDGE_ALLOC_FLAG_BRIDGE_OWN set
+    MAC_BRIDGE_ALLOC_FLAG_UNTAGGED      = 0x04,     // the VLAN tag of the packet is currently removed
+                                                    // the packet needs to be re-tagged before being returned
     //
     // ...
 }MAC_BRIDGE_ALLOC_FLAGS;
 
 
+#if (_TCPIP_MAC_BRIDGE_ACK_FILTER != 0)
+// the fields of a pure TCP ACK that the filter compares
+typedef struct
+{
+    uint32_t    srcAdd;         // IPv4 source address
+    uint32_t    dstAdd;         // IPv4 destination address
+    uint32_t    ports;          // source port << 16 | destination port
+    uint32_t    seq;            // sequence number
+    uint32_t    ack;            // acknowledgment number
+    uint32_t    tsVal;          // timestamp value, if hasTs
+    uint16_t    window;         // advertised window, not scaled
+    uint8_t     hasTs;          // the timestamp option is present
+}MAC_BRIDGE_ACK_INFO;
+#endif  // (_TCPIP_MAC_BRIDGE_ACK_FILTER != 0)
+
 // map of the ports need to be forwarded/flooded
 // limits the bridge ports to <= 32!
 typedef struct _tag_MAC_BRIDGE_FWD_DCPT
@@ -301,6 +897,10 @@ typedef struct _tag_MAC_BRIDGE_FWD_DCPT
     uint32_t        fwdMap32;       // map of ports to be forwarded/flooded
     uint16_t        pktLen;         // packet length
     uint16_t        fwdFlags;       // MAC_BRIDGE_FWD_FLAGS value
+#if (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
+    uint32_t        untagMap;       // map of the ports the frame is transmitted untagged on
+    uint16_t        vlanTci;        // TCI to be used when the frame is transmitted tagged
+#endif  // (_TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0)
 }MAC_BRIDGE_FWD_DCPT;
     
 // special port control for static FDB entries that rely on the learnt behavior as a default
@@ -169,6 +169,21 @@ static SYS_TMR_HANDLE       tcpip_stack_tickH = SYS_TMR_HANDLE_INVALID;      //
 static uint32_t             stackTaskRate;  // actual task running rate, ms
 static int32_t              stackLinkTmo;   // timeout for checking the link status, ms
 
+#if (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
+static volatile uint32_t    stackTimeMs;        // stack time, ms; advanced by the tick handler
+static volatile uint32_t    stackTmoDeadline;   // earliest of the module and link deadlines; checked by the tick handler
+static uint32_t             stackModDeadline;   // earliest module timeout deadline
+static uint32_t             stackLinkDeadline;  // next link status check
+static uint32_t             stackPendDeadline;  // earliest deadline set while the module table was scanned
+static bool                 stackPendValid;     // stackPendDeadline is valid
+#endif  // (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
+
+#if (_TCPIP_STACK_STAGED_INIT != 0)
+static const TCPIP_STACK_MODULE_CONFIG* stackDeferModConfig;   // module configuration used for the deferred initialization
+static int                  stackDeferModules;  // number of entries in stackDeferModConfig
+static int                  stackDeferModIx;    // TCPIP_STACK_MODULE_ENTRY_TBL index of the next module to check for deferred initialization
+#endif  // (_TCPIP_STACK_STAGED_INIT != 0)
+
 static uint32_t             stackAsyncSignalCount;   // global counter of the number of times the modules requested a TCPIP_MODULE_SIGNAL_ASYNC
                                                     // whenever !=0, it means that async signal requests are active!
 // a quick, constant time dispatch, approach taken here
@@ -280,6 +295,10 @@ static void _TCPIP_SecondCountSet(void);    // local time keeping
 static uint64_t         tcpip_stack_time = 0;
 static bool             tcpip_stack_timeEnable = 0;
 extern void             TCPIP_Commands_ExecTimeUpdate(void);
+#if defined(TCPIP_STACK_USE_MAC_BRIDGE)
+static uint64_t         tcpip_bridge_time = 0;      // TCPIP_MAC_Bridge_ProcessPacket() time
+static uint32_t         tcpip_bridge_pkts = 0;      // packets processed by the bridge
+#endif  // defined(TCPIP_STACK_USE_MAC_BRIDGE)
 #endif // defined(TCPIP_STACK_TIME_MEASUREMENT)
 
 static bool _TCPIPStackIsRunState(void);
@@ -329,6 +348,24 @@ static void _TCPIPStackExecuteModules(void);
 
 static void _TCPIPStackSignalTmo(void);
 
+#if (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
+static void _TCPIPStackDeadlineSet(TCPIP_MODULE_SIGNAL_ENTRY* pSigEntry, int16_t tmoMs);
+
+// returns true if the deadline is before the reference time
+static __inline__ bool __attribute__((always_inline)) _TCPIPStackDeadlineBefore(uint32_t deadline, uint32_t refTime)
+{
+    return (int32_t)(deadline - refTime) < 0;
+}
+
+// moves an expired deadline one period ahead
+// if the stack task fell behind, the deadline restarts from now instead of firing repeatedly
+static __inline__ uint32_t __attribute__((always_inline)) _TCPIPStackDeadlineAdvance(uint32_t deadline, uint32_t period, uint32_t now)
+{
+    deadline += period;
+    return _TCPIPStackDeadlineBefore(deadline, now) ? now + period : deadline;
+}
+#endif  // (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
+
 static bool _TCPIPStackCreateTimer(void);
 
 static bool _TCPIPStack_AdjustTimeouts(void);
@@ -649,6 +686,129 @@ static const TCPIP_STACK_MODULE_ENTRY TCPIP_STACK_MODULE_ENTRY_TBL [] =
 };
 #endif  // (TCPIP_STACK_DOWN_OPERATION != 0)
 
+#define _TCPIP_STACK_MODULES_NO     ((int)(sizeof(TCPIP_STACK_MODULE_ENTRY_TBL) / sizeof(*TCPIP_STACK_MODULE_ENTRY_TBL)))
+
+#if (_TCPIP_STACK_STAGED_INIT != 0)
+// staged initialization:
+//  the layer 1 and 2 modules and the MAC bridge are initialized together with the MACs
+//  so that the interfaces can process and forward packets as soon as the MACs are up.
+//  The service modules (layer 3 and up) are initialized by the stack task, one per task run,
+//  once all the interfaces are up.
+//  The stack status is SYS_STATUS_READY only after all the modules are initialized.
+static bool _TCPIPStackModuleIsDeferred(uint16_t moduleId)
+{
+    return moduleId >= TCPIP_MODULE_LAYER3 && moduleId != TCPIP_MODULE_MAC_BRIDGE;
+}
+
+// returns true if the TCPIP_STACK_MODULE_ENTRY_TBL module with index modIx
+// still waits for its deferred initialization
+static bool _TCPIPStackModuleInitPending(int modIx)
+{
+    return modIx >= stackDeferModIx && _TCPIPStackModuleIsDeferred(TCPIP_STACK_MODULE_ENTRY_TBL[modIx].moduleId);
+}
+
+// deferred initialization of a module on an interface
+static bool _TCPIPStackDeferredInitIf(const TCPIP_STACK_MODULE_ENTRY* pEntry, TCPIP_NET_IF* pNetIf, const void* configData)
+{
+    tcpip_stack_ctrl_data.pNetIf = pNetIf;
+    tcpip_stack_ctrl_data.netIx = pNetIf->netIfIx;
+    tcpip_stack_ctrl_data.stackAction = TCPIP_STACK_ACTION_INIT;
+    if(pNetIf->Flags.bInterfaceEnabled != 0 || pNetIf->Flags.bMacInitialize != 0)
+    {
+        tcpip_stack_ctrl_data.powerMode = pNetIf->Flags.powerMode;
+    }
+    else
+    {   // interface has been brought down in the meantime
+        tcpip_stack_ctrl_data.powerMode = TCPIP_MAC_POWER_DOWN;
+    }
+
+    if(!pEntry->initFunc(&tcpip_stack_ctrl_data, configData))
+    {
+        SYS_ERROR_PRINT(SYS_ERROR_ERROR, TCPIP_STACK_HDR_MESSAGE "Module no: %d Deferred initialization failed\r\n", pEntry->moduleId);
+        return false;
+    }
+
+    return true;
+}
+
+// initializes the next deferred module on all interfaces
+// returns false if the module initialization failed
+static bool _TCPIPStackDeferredInit(void)
+{
+    int     netIx, modIx;
+    TCPIP_NET_IF* pNetIf;
+    const TCPIP_STACK_MODULE_ENTRY* pEntry;
+    const TCPIP_STACK_MODULE_CONFIG* pConfig;
+    const void* configData;
+
+    for(modIx = stackDeferModIx; modIx < _TCPIP_STACK_MODULES_NO; modIx++)
+    {
+        if(_TCPIPStackModuleIsDeferred(TCPIP_STACK_MODULE_ENTRY_TBL[modIx].moduleId))
+        {
+            break;
+        }
+    }
+
+    if(modIx == _TCPIP_STACK_MODULES_NO)
+    {   // done
+        stackDeferModIx = modIx;
+        return true;
+    }
+
+    // from now on the module is considered initialized, even if it fails
+    // so that it is de-initialized when the stack is killed
+    stackDeferModIx = modIx + 1;
+    pEntry = TCPIP_STACK_MODULE_ENTRY_TBL + modIx;
+
+#if (_TCPIP_STACK_RUN_TIME_INIT != 0)
+    if(TCPIP_MODULES_RUN_TBL[pEntry->moduleId].isRunning == 0)
+    {
+        return true;
+    }
+#endif  // (_TCPIP_STACK_RUN_TIME_INIT != 0)
+
+    configData = 0;
+    if (stackDeferModConfig != 0)
+    {
+        pConfig = _TCPIP_STACK_FindModuleData(pEntry->moduleId, stackDeferModConfig, stackDeferModules);
+        if(pConfig != 0)
+        {
+            configData = pConfig->configData;
+        }
+    }
+
+    // same order as at stack start up: primary interfaces first, then the aliases
+    for(netIx = 0, pNetIf = tcpipNetIf; netIx < tcpip_stack_ctrl_data.nIfs; netIx++, pNetIf++)
+    {
+#if (_TCPIP_STACK_ALIAS_INTERFACE_SUPPORT)
+        if(!_TCPIPStackNetIsPrimary(pNetIf))
+        {
+            continue;
+        }
+#endif  // (_TCPIP_STACK_ALIAS_INTERFACE_SUPPORT)
+        if(!_TCPIPStackDeferredInitIf(pEntry, pNetIf, configData))
+        {
+            return false;
+        }
+    }
+
+#if (_TCPIP_STACK_ALIAS_INTERFACE_SUPPORT)
+    for(netIx = 0, pNetIf = tcpipNetIf; netIx < tcpip_stack_ctrl_data.nIfs; netIx++, pNetIf++)
+    {
+        if(!_TCPIPStackNetIsPrimary(pNetIf))
+        {
+            if(!_TCPIPStackDeferredInitIf(pEntry, pNetIf, configData))
+            {
+                return false;
+            }
+        }
+    }
+#endif  // (_TCPIP_STACK_ALIAS_INTERFACE_SUPPORT)
+
+    return true;
+}
+#endif  // (_TCPIP_STACK_STAGED_INIT != 0)
+
 SYS_MODULE_OBJ TCPIP_STACK_Initialize(const SYS_MODULE_INDEX index, const SYS_MODULE_INIT * const init)
 {
 
@@ -669,6 +829,10 @@ SYS_MODULE_OBJ TCPIP_STACK_Initialize(const SYS_MODULE_INDEX index, const SYS_MO
     newTcpipStackEventCnt = 0;
     newTcpipTickAvlbl = 0;
     stackTaskRate = stackLinkTmo = 0;
+#if (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
+    stackTimeMs = stackTmoDeadline = stackModDeadline = stackLinkDeadline = 0;
+    stackPendValid = false;
+#endif  // (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
 
     memset(&tcpip_stack_ctrl_data, 0, sizeof(tcpip_stack_ctrl_data));
 
@@ -895,6 +1059,14 @@ static bool _TCPIP_DoInitialize(const TCPIP_STACK_INIT * init)
             TCPIP_Helper_SingleListInitialize(TCPIP_MODULES_QUEUE_TBL + ix);
         }
 
+#if (_TCPIP_STACK_STAGED_INIT != 0)
+        // the service modules are initialized later on, by the stack task
+        // Note: the module configuration needs to be persistent!
+        stackDeferModConfig = pModConfig;
+        stackDeferModules = nModules;
+        stackDeferModIx = 0;
+#endif  // (_TCPIP_STACK_STAGED_INIT != 0)
+
         // start per interface initializing
         tcpip_stack_ctrl_data.stackAction = TCPIP_STACK_ACTION_INIT;
 
@@ -1093,8 +1265,15 @@ static bool TCPIP_STACK_BringNetUp(TCPIP_STACK_MODULE_CTRL* stackCtrlData, const
 #endif  // (_TCPIP_STACK_RUN_TIME_INIT != 0)
         const TCPIP_STACK_MODULE_ENTRY*  pEntry = TCPIP_STACK_MODULE_ENTRY_TBL + 0;
 
-        for(modIx = 0; modIx < sizeof(TCPIP_STACK_MODULE_ENTRY_TBL) / sizeof(*TCPIP_STACK_MODULE_ENTRY_TBL); modIx++)
+        for(modIx = 0; modIx < _TCPIP_STACK_MODULES_NO; modIx++)
         {
+#if (_TCPIP_STACK_STAGED_INIT != 0)
+            if(_TCPIPStackModuleInitPending(modIx))
+            {   // service module; initialized by the stack task once the interfaces are up
+                pEntry++;
+                continue;
+            }
+#endif  // (_TCPIP_STACK_STAGED_INIT != 0)
             configData = 0;
             if (pModConfig != 0)
             {
@@ -1402,10 +1581,16 @@ static void TCPIP_STACK_BringNetDown(TCPIP_STACK_MODULE_CTRL* stackCtrlData, TCP
     stackCtrlData->powerMode = powerMode;
 
     // Go to the last entry in the table
-    pEntry = TCPIP_STACK_MODULE_ENTRY_TBL + sizeof(TCPIP_STACK_MODULE_ENTRY_TBL)/sizeof(*TCPIP_STACK_MODULE_ENTRY_TBL);
+    pEntry = TCPIP_STACK_MODULE_ENTRY_TBL + _TCPIP_STACK_MODULES_NO;
     do
     {
         pEntry--;
+#if (_TCPIP_STACK_STAGED_INIT != 0)
+        if(_TCPIPStackModuleInitPending(pEntry - TCPIP_STACK_MODULE_ENTRY_TBL))
+        {   // not initialized yet
+            continue;
+        }
+#endif  // (_TCPIP_STACK_STAGED_INIT != 0)
         pEntry->deInitFunc(stackCtrlData);
     }
     while (pEntry != TCPIP_STACK_MODULE_ENTRY_TBL);
@@ -1483,6 +1668,9 @@ static bool _TCPIPStackCreateTimer(void)
         createRes = _TCPIPStack_AdjustTimeouts();
         // adjust the link rate to be a multiple of the stack task rate
         stackLinkTmo = ((_TCPIP_STACK_LINK_RATE + stackTaskRate - 1) / stackTaskRate) * stackTaskRate; 
+#if (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
+        stackLinkDeadline = stackTimeMs + stackLinkTmo;
+#endif  // (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
     }
 
     if(createRes == false)
@@ -1548,6 +1736,19 @@ void TCPIP_STACK_Task(SYS_MODULE_OBJ object)
         return;
     }
 
+#if (_TCPIP_STACK_STAGED_INIT != 0)
+    if(stackDeferModIx < _TCPIP_STACK_MODULES_NO)
+    {   // the interfaces are running; continue with the service modules
+        if(!_TCPIPStackDeferredInit())
+        {
+            TCPIP_STACK_KillStack();
+            tcpip_stack_status = SYS_STATUS_ERROR;
+            SYS_ERROR_PRINT(SYS_ERROR_ERROR, TCPIP_STACK_HDR_MESSAGE "Deferred initialization failed - Aborting! \r\n");
+            return;
+        }
+    }
+#endif  // (_TCPIP_STACK_STAGED_INIT != 0)
+
 #if defined(TCPIP_STACK_TIME_MEASUREMENT)
     uint32_t    tTaskStart;
     if(tcpip_stack_timeEnable)
@@ -1575,6 +1776,11 @@ void TCPIP_STACK_Task(SYS_MODULE_OBJ object)
     else
     {
         wasTickEvent = false;
+#if (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
+        // ticks reach the task only when a deadline is due
+        // keep the time current for the RX processing
+        _TCPIP_SecondCountSet();
+#endif  // (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
     }
 
     if( totTcpipEventsCnt)
@@ -1636,7 +1842,13 @@ void TCPIP_STACK_Task(SYS_MODULE_OBJ object)
             _TCPIP_ProcessMACErrorEvents(pNetIf, activeEvents);
         }
 
+#if (_TCPIP_STACK_STAGED_INIT != 0)
+        // the connection handlers belong to service modules:
+        // keep the event pending until all the modules are initialized
+        if(pNetIf->exFlags.connEvent != 0 && stackDeferModIx >= _TCPIP_STACK_MODULES_NO)
+#else
         if(pNetIf->exFlags.connEvent != 0)
+#endif  // (_TCPIP_STACK_STAGED_INIT != 0)
         {   // connection related event
             if(pNetIf->exFlags.connEventType != 0)
             {
@@ -1833,6 +2045,12 @@ static bool _TCPIPStackIsRunState(void)
         // passed through all interfaces
         if(ifUpMask == ((1 << netIx) - 1))
         {   // all interfaces up
+#if (_TCPIP_STACK_STAGED_INIT != 0)
+            if(stackDeferModIx < _TCPIP_STACK_MODULES_NO)
+            {   // running but the service modules are still initializing
+                return true;
+            }
+#endif  // (_TCPIP_STACK_STAGED_INIT != 0)
             tcpip_stack_status = SYS_STATUS_READY;
             SYS_CONSOLE_MESSAGE(TCPIP_STACK_HDR_MESSAGE "Initialization Ended - success \r\n");
         }
@@ -1936,14 +2154,24 @@ static void _TCPIP_ProcessTickEvent(void)
     int     netIx;
     TCPIP_NET_IF* pNetIf;
     bool    linkCurr, linkPrev;
+#if (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
+    uint32_t now;
+#endif  // (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
 
     newTcpipTickAvlbl = 0;
 
     _TCPIP_SecondCountSet();    // update time
+#if (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
+    now = stackTimeMs;
+    if(!_TCPIPStackDeadlineBefore(now, stackLinkDeadline))
+    {   // timeout exceeded 
+        stackLinkDeadline = _TCPIPStackDeadlineAdvance(stackLinkDeadline, _TCPIP_STACK_LINK_RATE, now);
+#else
     stackLinkTmo -= stackTaskRate;
     if(stackLinkTmo <= 0)
     {   // timeout exceeded 
         stackLinkTmo += _TCPIP_STACK_LINK_RATE; 
+#endif  // (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
         for(netIx = 0, pNetIf = tcpipNetIf; netIx < tcpip_stack_ctrl_data.nIfs; netIx++, pNetIf++)
         {
             if(pNetIf->Flags.bInterfaceEnabled)
@@ -2018,9 +2246,19 @@ static uint32_t _TCPIPProcessMacPackets(bool signal)
 #endif  // (TCPIP_STACK_EXTERN_PACKET_PROCESS != 0)
 
 #if defined(TCPIP_STACK_USE_MAC_BRIDGE)
+#if defined(TCPIP_STACK_TIME_MEASUREMENT)
+        uint32_t tBridgeStart = _CP0_GET_COUNT();
+#endif // defined(TCPIP_STACK_TIME_MEASUREMENT)
         TCPIP_MAC_BRIDGE_PKT_RES brRes = TCPIP_MAC_Bridge_ProcessPacket( pRxPkt);
         if(brRes != TCPIP_MAC_BRIDGE_PKT_RES_HOST_PROCESS)
         {
+#if defined(TCPIP_STACK_TIME_MEASUREMENT)
+            if(tcpip_stack_timeEnable)
+            {   // forwarded or discarded by the bridge
+                tcpip_bridge_time += _CP0_GET_COUNT() - tBridgeStart;
+                tcpip_bridge_pkts++;
+            }
+#endif // defined(TCPIP_STACK_TIME_MEASUREMENT)
             continue;
         } 
         
@@ -2128,9 +2366,20 @@ static void _TCPIP_NetIfEvent(TCPIP_NET_IF* pNetIf, TCPIP_MAC_EVENT event, bool
     To avoid synchronization issues between the TCP/IP threads and TMR thread
     or MAC ISR and TMR ISR
     the TMO signal is used on a different signal entry: TCPIP_MODULE_NONE!
+
+    With _TCPIP_STACK_DEADLINE_TIMEOUTS the stack task is signaled
+    only when the earliest module or link deadline is due.
 *****************************************************************************/
 static void _TCPIP_STACK_TickHandler(uintptr_t context, uint32_t currTick)
 {
+#if (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
+    stackTimeMs += stackTaskRate;
+    if(_TCPIPStackDeadlineBefore(stackTimeMs, stackTmoDeadline))
+    {   // nothing due yet
+        return;
+    }
+#endif  // (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
+
     newTcpipTickAvlbl++;
 
     TCPIP_MODULE_SIGNAL_ENTRY* pTmoEntry = _TCPIPModuleToSignalEntry(TCPIP_MODULE_NONE);
@@ -4203,6 +4452,9 @@ tcpipSignalHandle _TCPIPStackSignalHandlerRegister(TCPIP_STACK_MODULE modId, tcp
                     asyncTmoMs = stackTaskRate;
                 }
                 pSignalEntry->asyncTmo = pSignalEntry->currTmo = asyncTmoMs;
+#if (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
+                _TCPIPStackDeadlineSet(pSignalEntry, asyncTmoMs);
+#endif  // (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
                 return pSignalEntry;
             }
         }
@@ -4222,6 +4474,9 @@ bool _TCPIPStackSignalHandlerSetParams(TCPIP_STACK_MODULE modId, tcpipSignalHand
             asyncTmoMs = stackTaskRate;
         }
         pSignalEntry->asyncTmo = pSignalEntry->currTmo = asyncTmoMs;
+#if (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
+        _TCPIPStackDeadlineSet(pSignalEntry, asyncTmoMs);
+#endif  // (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
         return true;
     }
 
@@ -4391,6 +4646,88 @@ static void _TCPIPSignalEntrySetNotify(TCPIP_MODULE_SIGNAL_ENTRY* pSigEntry, TCP
 }
 
 // signal the stack manager maintained timeout
+#if (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
+// the module table is scanned only when the earliest module deadline is due
+static void _TCPIPStackSignalTmo(void)
+{
+    int         ix;
+    uint32_t    now, nextDeadline;
+    TCPIP_MODULE_SIGNAL_ENTRY*  pSigEntry;
+    OSAL_CRITSECT_DATA_TYPE     critSect;
+
+    now = stackTimeMs;
+    if(!_TCPIPStackDeadlineBefore(now, stackModDeadline))
+    {
+        critSect = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+        stackPendValid = false;
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, critSect);
+
+        // module timeouts are limited to int16_t; no registered timeout is further away than this
+        nextDeadline = now + 0x8000;
+        pSigEntry = TCPIP_STACK_MODULE_SIGNAL_TBL + TCPIP_MODULE_LAYER1;
+        for(ix = TCPIP_MODULE_LAYER1; ix < sizeof(TCPIP_STACK_MODULE_SIGNAL_TBL)/sizeof(*TCPIP_STACK_MODULE_SIGNAL_TBL); ix++, pSigEntry++)
+        {
+            if(pSigEntry->signalHandler == 0 || pSigEntry->asyncTmo == 0)
+            {   // unused slot
+                continue;
+            }
+
+            if(!_TCPIPStackDeadlineBefore(now, pSigEntry->tmoDeadline))
+            {   // timeout: send a signal to this module
+                pSigEntry->tmoDeadline = _TCPIPStackDeadlineAdvance(pSigEntry->tmoDeadline, pSigEntry->asyncTmo, now);
+                _TCPIPSignalEntrySetNotify(pSigEntry, TCPIP_MODULE_SIGNAL_TMO, 0); 
+            }
+
+            if(_TCPIPStackDeadlineBefore(pSigEntry->tmoDeadline, nextDeadline))
+            {
+                nextDeadline = pSigEntry->tmoDeadline;
+            }
+        }
+
+        critSect = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+        if(stackPendValid && _TCPIPStackDeadlineBefore(stackPendDeadline, nextDeadline))
+        {   // a module changed its timeout while scanning
+            nextDeadline = stackPendDeadline;
+        }
+        stackModDeadline = nextDeadline;
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, critSect);
+    }
+
+    critSect = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+    stackTmoDeadline = _TCPIPStackDeadlineBefore(stackLinkDeadline, stackModDeadline) ? stackLinkDeadline : stackModDeadline;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, critSect);
+}
+
+// sets a new module timeout, starting now
+// pulls in the earliest deadline if needed
+// could be called from user threads
+static void _TCPIPStackDeadlineSet(TCPIP_MODULE_SIGNAL_ENTRY* pSigEntry, int16_t tmoMs)
+{
+    uint32_t deadline;
+    OSAL_CRITSECT_DATA_TYPE critSect =  OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+
+    deadline = stackTimeMs + tmoMs;
+    pSigEntry->tmoDeadline = deadline;
+    if(tmoMs != 0)
+    {
+        if(!stackPendValid || _TCPIPStackDeadlineBefore(deadline, stackPendDeadline))
+        {
+            stackPendDeadline = deadline;
+            stackPendValid = true;
+        }
+        if(_TCPIPStackDeadlineBefore(deadline, stackModDeadline))
+        {
+            stackModDeadline = deadline;
+        }
+        if(_TCPIPStackDeadlineBefore(deadline, stackTmoDeadline))
+        {
+            stackTmoDeadline = deadline;
+        }
+    }
+
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, critSect);
+}
+#else
 static void _TCPIPStackSignalTmo(void)
 {
     int     ix;
@@ -4411,6 +4748,7 @@ static void _TCPIPStackSignalTmo(void)
         }
     }
 }
+#endif  // (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
 
 // insert a packet into a module RX queue
 // signal should be false when modId == TCPIP_MODULE_MANAGER !
@@ -4878,6 +5216,10 @@ void TCPIP_STACK_TimeMeasureStart(bool reset)
     if(reset)
     {
         tcpip_stack_time = 0;
+#if defined(TCPIP_STACK_USE_MAC_BRIDGE)
+        tcpip_bridge_time = 0;
+        tcpip_bridge_pkts = 0;
+#endif  // defined(TCPIP_STACK_USE_MAC_BRIDGE)
     }
 
     tcpip_stack_timeEnable = true;
@@ -4893,6 +5235,18 @@ uint64_t TCPIP_STACK_TimeMeasureGet(bool stop)
     return tcpip_stack_time;
 }
 
+#if defined(TCPIP_STACK_USE_MAC_BRIDGE)
+uint64_t TCPIP_STACK_BridgeTimeMeasureGet(uint32_t* pPkts)
+{
+    if(pPkts)
+    {
+        *pPkts = tcpip_bridge_pkts;
+    }
+
+    return tcpip_bridge_time;
+}
+#endif  // defined(TCPIP_STACK_USE_MAC_BRIDGE)
+
 #endif // defined(TCPIP_STACK_TIME_MEASUREMENT)
 
 #if ((_TCPIP_STACK_DEBUG_LEVEL & _TCPIP_STACK_DEBUG_MASK_BASIC) != 0)
@@ -56,6 +56,7 @@ Microchip or any third party.
 #define TCPIP_ETHER_TYPE_IPV6       (0x86DDu)
 #define TCPIP_ETHER_TYPE_ARP        (0x0806u)
 #define TCPIP_ETHER_TYPE_LLDP       (0x88CCu)
+#define TCPIP_ETHER_TYPE_VLAN       (0x8100u)   // IEEE 802.1Q tag; bridged only, not processed by the stack
 #define TCPIP_ETHER_TYPE_UNKNOWN    (0xFFFFu)
 
 // minimum timeout (maximum rate) for link check, ms
@@ -736,6 +737,11 @@ void        TCPIP_STACK_TimeMeasureStart(bool reset);
 
 uint64_t    TCPIP_STACK_TimeMeasureGet(bool stop);    
 
+#if defined(TCPIP_STACK_USE_MAC_BRIDGE)
+// time taken by the packets forwarded or discarded by the bridge, included in the TCPIP_STACK_Task() time
+// pPkts, if not NULL, gets the number of these packets
+uint64_t    TCPIP_STACK_BridgeTimeMeasureGet(uint32_t* pPkts);
+#endif  // defined(TCPIP_STACK_USE_MAC_BRIDGE)
 
 #endif // defined(TCPIP_STACK_TIME_MEASUREMENT)
 
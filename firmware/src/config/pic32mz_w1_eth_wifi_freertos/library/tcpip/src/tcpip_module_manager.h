@@ -87,6 +87,22 @@ typedef void    (*tcpipModuleDeInitFunc)(const TCPIP_STACK_MODULE_CTRL * const);
 #define _TCPIP_STACK_RUN_TIME_INIT       0
 #endif  // defined(TCPIP_STACK_RUN_TIME_INIT) && (TCPIP_STACK_RUN_TIME_INIT != 0)
 
+// module timeouts kept as absolute deadlines
+// the stack task is signaled only when the earliest deadline is due
+#if defined(TCPIP_STACK_DEADLINE_TIMEOUTS) && (TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
+#define _TCPIP_STACK_DEADLINE_TIMEOUTS   1
+#else
+#define _TCPIP_STACK_DEADLINE_TIMEOUTS   0
+#endif  // defined(TCPIP_STACK_DEADLINE_TIMEOUTS) && (TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
+
+// service modules (layer 3 and up) initialized by the stack task
+// after the interfaces are up and processing packets
+#if defined(TCPIP_STACK_STAGED_INIT) && (TCPIP_STACK_STAGED_INIT != 0)
+#define _TCPIP_STACK_STAGED_INIT         1
+#else
+#define _TCPIP_STACK_STAGED_INIT         0
+#endif  // defined(TCPIP_STACK_STAGED_INIT) && (TCPIP_STACK_STAGED_INIT != 0)
+
 // module run time flags
 // 8 bit only
 typedef union
@@ -137,6 +153,9 @@ typedef struct
     int16_t                     asyncTmo;           // module required timeout, msec; 
                                                     // the stack manager checks that the module reached its timeout
     int16_t                     currTmo;            // current module timeout, msec; maintained by the stack manager
+#if (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
+    uint32_t                    tmoDeadline;        // stack time of the next timeout, msec; maintained by the stack manager
+#endif  // (_TCPIP_STACK_DEADLINE_TIMEOUTS != 0)
     uint16_t                    signalParam;        // some signals have parameters
                                                     // for TCPIP_MODULE_SIGNAL_INTERFACE_CHANGE
                                                     // this is the interface mask: 1 << ifx 
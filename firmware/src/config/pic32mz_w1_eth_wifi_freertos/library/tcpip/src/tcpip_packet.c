@@ -36,6 +36,10 @@ Microchip or any third party.
 #include "tcpip_packet.h"
 #include "tcpip/tcpip_mac.h"
 
+#if (_TCPIP_STACK_PACKET_CACHED_BUFFERS != 0)
+#include <sys/kmem.h>
+#endif  // (_TCPIP_STACK_PACKET_CACHED_BUFFERS != 0)
+
 #define TCPIP_SEGMENT_CACHE_ALIGN_SIZE (CACHE_LINE_SIZE)
 
 // Segment payload gap:
@@ -70,6 +74,18 @@ Microchip or any third party.
 // for TX/RX we place the segment gap in front of the packet:
 #define _TCPIP_MAC_GAP_OFFSET    (int16_t)(-_TCPIP_MAC_DATA_SEGMENT_GAP_SIZE)
 
+#if (_TCPIP_STACK_PACKET_CACHED_BUFFERS != 0)
+// the gap and the data buffer are accessed through the cached alias
+// while the packet and segment descriptors are accessed uncached.
+// They must not share a cache line: the gap takes whole cache lines
+// and a trailing cache line covers the load offset
+#define TCPIP_SEGMENT_GAP_ALLOC_SIZE        (((_TCPIP_MAC_DATA_SEGMENT_GAP_SIZE + TCPIP_SEGMENT_CACHE_ALIGN_SIZE - 1) / TCPIP_SEGMENT_CACHE_ALIGN_SIZE) * TCPIP_SEGMENT_CACHE_ALIGN_SIZE)
+#define TCPIP_SEGMENT_TAIL_ALLOC_SIZE(tail) (TCPIP_SEGMENT_CACHE_ALIGN_SIZE)
+#else
+#define TCPIP_SEGMENT_GAP_ALLOC_SIZE        _TCPIP_MAC_DATA_SEGMENT_GAP_SIZE
+#define TCPIP_SEGMENT_TAIL_ALLOC_SIZE(tail) (tail)
+#endif  // (_TCPIP_STACK_PACKET_CACHED_BUFFERS != 0)
+
 
 
 
@@ -101,6 +117,44 @@ static TCPIP_MAC_DATA_SEGMENT* _TCPIP_PKT_SegmentAllocInt(uint16_t loadLen, TCPI
 static void _TCPIP_PKT_SegmentFreeInt(TCPIP_MAC_DATA_SEGMENT* pSeg, int moduleId);
 #endif  // defined(TCPIP_PACKET_ALLOCATION_TRACE_ENABLE)
 
+// returns the cache aligned data buffer of a newly allocated segment
+static __inline__ uint8_t* __attribute__((always_inline)) _TCPIP_PKT_SegmentBuffer(TCPIP_MAC_DATA_SEGMENT* pSeg)
+{
+    uint8_t* segBuffer = (uint8_t*)(pSeg + 1) + TCPIP_SEGMENT_GAP_ALLOC_SIZE;
+    // cache-align the data segment
+    segBuffer = (uint8_t*)((((uint32_t)segBuffer + TCPIP_SEGMENT_CACHE_ALIGN_SIZE - 1) / TCPIP_SEGMENT_CACHE_ALIGN_SIZE) * TCPIP_SEGMENT_CACHE_ALIGN_SIZE);
+#if (_TCPIP_STACK_PACKET_CACHED_BUFFERS != 0)
+    if(IS_KVA1(segBuffer))
+    {   // the heap flushed the block when mapping it, no lines are cached
+        segBuffer = (uint8_t*)KVA1_TO_KVA0(segBuffer);
+    }
+#endif  // (_TCPIP_STACK_PACKET_CACHED_BUFFERS != 0)
+
+    return segBuffer;
+}
+
+#if (_TCPIP_STACK_PACKET_CACHED_BUFFERS != 0)
+// discards the cache lines of a segment gap and data buffer
+// before the segment memory is returned to the heap.
+// The contents are no longer needed, so there is no write back.
+static void _TCPIP_PKT_SegmentCacheDiscard(TCPIP_MAC_DATA_SEGMENT* pSeg)
+{
+    if(IS_KVA0(pSeg->segBuffer))
+    {
+        uint8_t* pLine = pSeg->segBuffer - TCPIP_SEGMENT_GAP_ALLOC_SIZE;
+        uint8_t* pEnd = pLine + pSeg->segAllocSize - TCPIP_SEGMENT_CACHE_ALIGN_SIZE;
+
+        for(; pLine < pEnd; pLine += TCPIP_SEGMENT_CACHE_ALIGN_SIZE)
+        {   // hit invalidate order
+            __asm__ __volatile__ ("cache 0x11, 0(%0)" ::"r"(pLine));
+        }
+        __asm__ __volatile__ ("sync");
+    }
+}
+#else
+#define _TCPIP_PKT_SegmentCacheDiscard(pSeg)
+#endif  // (_TCPIP_STACK_PACKET_CACHED_BUFFERS != 0)
+
 #if (TCPIP_PACKET_LOG_ENABLE)
 
 // size of the packet log
@@ -326,7 +380,7 @@ static __inline__ TCPIP_MAC_PACKET* __attribute__((always_inline)) _TCPIP_PKT_Pa
     // segment size, multiple of cache line size
     segAlignSize = ((segLoadLen + sizeof(TCPIP_MAC_ETHERNET_HEADER) + TCPIP_SEGMENT_CACHE_ALIGN_SIZE  - 1) / TCPIP_SEGMENT_CACHE_ALIGN_SIZE) * TCPIP_SEGMENT_CACHE_ALIGN_SIZE;
     // segment allocation size, extra cache line so that the segBuffer can start on a cache line boundary
-    segAllocSize = segAlignSize + _TCPIP_MAC_DATA_SEGMENT_GAP_SIZE + TCPIP_MAC_PAYLOAD_OFFSET + TCPIP_SEGMENT_CACHE_ALIGN_SIZE; 
+    segAllocSize = segAlignSize + TCPIP_SEGMENT_GAP_ALLOC_SIZE + TCPIP_SEGMENT_TAIL_ALLOC_SIZE(TCPIP_MAC_PAYLOAD_OFFSET) + TCPIP_SEGMENT_CACHE_ALIGN_SIZE; 
     // total allocation size
     allocLen = pktUpLen + sizeof(*pSeg) + segAllocSize;
 
@@ -345,9 +399,7 @@ static __inline__ TCPIP_MAC_PACKET* __attribute__((always_inline)) _TCPIP_PKT_Pa
 
         pSeg->segSize = segAlignSize;
         pSeg->segAllocSize = segAllocSize;
-        pSeg->segBuffer = (uint8_t*)(pSeg + 1) + _TCPIP_MAC_DATA_SEGMENT_GAP_SIZE;
-        // cache-align the data segment
-        pSeg->segBuffer = (uint8_t*)((((uint32_t)pSeg->segBuffer + TCPIP_SEGMENT_CACHE_ALIGN_SIZE - 1) / TCPIP_SEGMENT_CACHE_ALIGN_SIZE) * TCPIP_SEGMENT_CACHE_ALIGN_SIZE);
+        pSeg->segBuffer = _TCPIP_PKT_SegmentBuffer(pSeg);
         // set the pointer to the packet that segment belongs to
         TCPIP_MAC_SEGMENT_GAP_DCPT* pGap = (TCPIP_MAC_SEGMENT_GAP_DCPT*)(pSeg->segBuffer + _TCPIP_MAC_GAP_OFFSET);
         pGap->segmentPktPtr = pPkt;
@@ -379,6 +431,7 @@ static __inline__ void __attribute__((always_inline)) _TCPIP_PKT_PacketFreeInt(T
             pNSeg = pSeg->next;
             if((pSeg->segFlags & TCPIP_MAC_SEG_FLAG_STATIC) == 0)
             {
+                _TCPIP_PKT_SegmentCacheDiscard(pSeg);
 #if defined(TCPIP_STACK_DRAM_DEBUG_ENABLE) 
                 TCPIP_HEAP_FreeDebug(pktMemH, pSeg, moduleId);
 #else
@@ -387,6 +440,7 @@ static __inline__ void __attribute__((always_inline)) _TCPIP_PKT_PacketFreeInt(T
             }
         }
 
+        _TCPIP_PKT_SegmentCacheDiscard(pPkt->pDSeg);    // the 1st segment is embedded in the packet
 #if defined(TCPIP_STACK_DRAM_DEBUG_ENABLE) 
         TCPIP_HEAP_FreeDebug(pktMemH, pPkt, moduleId);
 #else
@@ -435,7 +489,7 @@ static __inline__ TCPIP_MAC_DATA_SEGMENT* __attribute__((always_inline)) _TCPIP_
 
     segAlignSize = ((loadLen + TCPIP_SEGMENT_CACHE_ALIGN_SIZE  - 1) / TCPIP_SEGMENT_CACHE_ALIGN_SIZE) * TCPIP_SEGMENT_CACHE_ALIGN_SIZE;
     // segment allocation size, extra cache line so that the segBuffer can start on a cache line boundary
-    segAllocSize = segAlignSize + _TCPIP_MAC_DATA_SEGMENT_GAP_SIZE + TCPIP_SEGMENT_CACHE_ALIGN_SIZE; 
+    segAllocSize = segAlignSize + TCPIP_SEGMENT_GAP_ALLOC_SIZE + TCPIP_SEGMENT_TAIL_ALLOC_SIZE(0) + TCPIP_SEGMENT_CACHE_ALIGN_SIZE; 
 
     // total allocation size
     allocLen = sizeof(*pSeg) + segAllocSize;
@@ -455,9 +509,7 @@ static __inline__ TCPIP_MAC_DATA_SEGMENT* __attribute__((always_inline)) _TCPIP_
         pSeg->segFlags = flags & (~TCPIP_MAC_SEG_FLAG_STATIC);
         pSeg->segSize = segAlignSize;
         pSeg->segAllocSize = segAllocSize;
-        pSeg->segBuffer = (uint8_t*)(pSeg + 1) + _TCPIP_MAC_DATA_SEGMENT_GAP_SIZE;
-        // cache-align the data segment
-        pSeg->segBuffer = (uint8_t*)((((uint32_t)pSeg->segBuffer + TCPIP_SEGMENT_CACHE_ALIGN_SIZE - 1) / TCPIP_SEGMENT_CACHE_ALIGN_SIZE) * TCPIP_SEGMENT_CACHE_ALIGN_SIZE);
+        pSeg->segBuffer = _TCPIP_PKT_SegmentBuffer(pSeg);
         pSeg->segLoad = pSeg->segBuffer + TCPIP_MAC_PAYLOAD_OFFSET;
     }
 
@@ -468,6 +520,7 @@ static __inline__ void __attribute__((always_inline)) _TCPIP_PKT_SegmentFreeInt(
 {
     if( (pSeg->segFlags & TCPIP_MAC_SEG_FLAG_STATIC) == 0)
     {
+        _TCPIP_PKT_SegmentCacheDiscard(pSeg);
 #if defined(TCPIP_STACK_DRAM_DEBUG_ENABLE) 
         TCPIP_HEAP_FreeDebug(pktMemH, pSeg, moduleId);
 #else
@@ -684,7 +737,7 @@ TCPIP_MAC_PACKET* _TCPIP_PKT_PacketAlloc(uint16_t pktLen, uint16_t segLoadLen, T
     // segment size, multiple of cache line size
     segAlignSize = ((segLoadLen + sizeof(TCPIP_MAC_ETHERNET_HEADER) + TCPIP_SEGMENT_CACHE_ALIGN_SIZE  - 1) / TCPIP_SEGMENT_CACHE_ALIGN_SIZE) * TCPIP_SEGMENT_CACHE_ALIGN_SIZE;
     // segment allocation size, extra cache line so that the segBuffer can start on a cache line boundary
-    segAllocSize = segAlignSize + _TCPIP_MAC_DATA_SEGMENT_GAP_SIZE + TCPIP_MAC_PAYLOAD_OFFSET + TCPIP_SEGMENT_CACHE_ALIGN_SIZE; 
+    segAllocSize = segAlignSize + TCPIP_SEGMENT_GAP_ALLOC_SIZE + TCPIP_SEGMENT_TAIL_ALLOC_SIZE(TCPIP_MAC_PAYLOAD_OFFSET) + TCPIP_SEGMENT_CACHE_ALIGN_SIZE; 
     // total allocation size
     allocLen = pktUpLen + sizeof(*pSeg) + segAllocSize;
 
@@ -699,9 +752,7 @@ TCPIP_MAC_PACKET* _TCPIP_PKT_PacketAlloc(uint16_t pktLen, uint16_t segLoadLen, T
 
         pSeg->segSize = segAlignSize;
         pSeg->segAllocSize = segAllocSize;
-        pSeg->segBuffer = (uint8_t*)(pSeg + 1) + _TCPIP_MAC_DATA_SEGMENT_GAP_SIZE;
-        // cache-align the data segment
-        pSeg->segBuffer = (uint8_t*)((((uint32_t)pSeg->segBuffer + TCPIP_SEGMENT_CACHE_ALIGN_SIZE - 1) / TCPIP_SEGMENT_CACHE_ALIGN_SIZE) * TCPIP_SEGMENT_CACHE_ALIGN_SIZE);
+        pSeg->segBuffer = _TCPIP_PKT_SegmentBuffer(pSeg);
         // set the pointer to the packet that segment belongs to
         TCPIP_MAC_SEGMENT_GAP_DCPT* pGap = (TCPIP_MAC_SEGMENT_GAP_DCPT*)(pSeg->segBuffer + _TCPIP_MAC_GAP_OFFSET);
         pGap->segmentPktPtr = pPkt;
@@ -765,10 +816,12 @@ void _TCPIP_PKT_PacketFree(TCPIP_MAC_PACKET* pPkt)
             pNSeg = pSeg->next;
             if((pSeg->segFlags & TCPIP_MAC_SEG_FLAG_STATIC) == 0)
             {
+                _TCPIP_PKT_SegmentCacheDiscard(pSeg);
                 TCPIP_HEAP_Free(pktMemH, pSeg);
             }
         }
 
+        _TCPIP_PKT_SegmentCacheDiscard(pPkt->pDSeg);    // the 1st segment is embedded in the packet
         TCPIP_HEAP_Free(pktMemH, pPkt);
     }
 }
@@ -783,7 +836,7 @@ TCPIP_MAC_DATA_SEGMENT* _TCPIP_PKT_SegmentAlloc(uint16_t loadLen, TCPIP_MAC_SEGM
 
     segAlignSize = ((loadLen + TCPIP_SEGMENT_CACHE_ALIGN_SIZE  - 1) / TCPIP_SEGMENT_CACHE_ALIGN_SIZE) * TCPIP_SEGMENT_CACHE_ALIGN_SIZE;
     // segment allocation size, extra cache line so that the segBuffer can start on a cache line boundary
-    segAllocSize = segAlignSize + _TCPIP_MAC_DATA_SEGMENT_GAP_SIZE + TCPIP_SEGMENT_CACHE_ALIGN_SIZE; 
+    segAllocSize = segAlignSize + TCPIP_SEGMENT_GAP_ALLOC_SIZE + TCPIP_SEGMENT_TAIL_ALLOC_SIZE(0) + TCPIP_SEGMENT_CACHE_ALIGN_SIZE; 
 
     // total allocation size
     allocLen = sizeof(*pSeg) + segAllocSize;
@@ -797,9 +850,7 @@ TCPIP_MAC_DATA_SEGMENT* _TCPIP_PKT_SegmentAlloc(uint16_t loadLen, TCPIP_MAC_SEGM
         pSeg->segFlags = flags & (~TCPIP_MAC_SEG_FLAG_STATIC);
         pSeg->segSize = segAlignSize;
         pSeg->segAllocSize = segAllocSize;
-        pSeg->segBuffer = (uint8_t*)(pSeg + 1) + _TCPIP_MAC_DATA_SEGMENT_GAP_SIZE;
-        // cache-align the data segment
-        pSeg->segBuffer = (uint8_t*)((((uint32_t)pSeg->segBuffer + TCPIP_SEGMENT_CACHE_ALIGN_SIZE - 1) / TCPIP_SEGMENT_CACHE_ALIGN_SIZE) * TCPIP_SEGMENT_CACHE_ALIGN_SIZE);
+        pSeg->segBuffer = _TCPIP_PKT_SegmentBuffer(pSeg);
         pSeg->segLoad = pSeg->segBuffer + TCPIP_MAC_PAYLOAD_OFFSET;
     }
 
@@ -810,6 +861,7 @@ void _TCPIP_PKT_SegmentFree(TCPIP_MAC_DATA_SEGMENT* pSeg)
 {
     if( (pSeg->segFlags & TCPIP_MAC_SEG_FLAG_STATIC) == 0)
     {
+        _TCPIP_PKT_SegmentCacheDiscard(pSeg);
         TCPIP_HEAP_Free(pktMemH, pSeg);
     }
 }
@@ -76,6 +76,13 @@ Microchip or any third party.
 #define _TCPIP_STACK_ALIAS_INTERFACE_SUPPORT     0
 #endif  // defined(TCPIP_STACK_USE_IPV4) && (TCPIP_STACK_ALIAS_INTERFACE_SUPPORT != 0)
 
+// cached packet data buffers need the PIC32MZ KSEG0/KSEG1 aliasing
+#if defined(__PIC32MZ__) && (TCPIP_STACK_PACKET_CACHED_BUFFERS != 0)
+#define _TCPIP_STACK_PACKET_CACHED_BUFFERS     1
+#else
+#define _TCPIP_STACK_PACKET_CACHED_BUFFERS     0
+#endif  // defined(__PIC32MZ__) && (TCPIP_STACK_PACKET_CACHED_BUFFERS != 0)
+
 // debug symbols
 
 #define _TCPIP_STACK_DEBUG_MASK_BASIC       0x01    // enable the _TCPIPStack_Assert and _TCPIPStack_Condition calls
@@ -0,0 +1,435 @@
+/*******************************************************************************
+  TCP/IP socket readiness implementation file
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+   tcpip_socket_ready.c
+
+  Summary:
+   TCP/IP socket readiness service
+
+  Description:
+    This source file contains the socket ready set API.
+    A ready set is a client of the TCP/UDP socket signals:
+    the socket signal handler marks the entry pending and releases the waiting task.
+*******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+//DOM-IGNORE-END
+
+#define TCPIP_THIS_MODULE_ID    TCPIP_MODULE_MANAGER
+
+#include "tcpip/src/tcpip_private.h"
+
+#if defined(TCPIP_STACK_USE_SOCKET_READY)
+#include "tcpip/tcpip_socket_ready.h"
+
+// TCP signals reported as TCPIP_SOCKET_READY_EV_STATE
+#define _SKT_READY_TCP_STATE_SIGNALS    (TCPIP_TCP_SIGNAL_ESTABLISHED | TCPIP_TCP_SIGNAL_RX_FIN | TCPIP_TCP_SIGNAL_RX_RST | TCPIP_TCP_SIGNAL_TX_RST | \
+                                         TCPIP_TCP_SIGNAL_KEEP_ALIVE_TMO | TCPIP_TCP_SIGNAL_IF_DOWN | TCPIP_TCP_SIGNAL_IF_CHANGE)
+
+// UDP signals reported as TCPIP_SOCKET_READY_EV_STATE
+#define _SKT_READY_UDP_STATE_SIGNALS    (TCPIP_UDP_SIGNAL_IF_DOWN | TCPIP_UDP_SIGNAL_IF_CHANGE)
+
+// marks events pending for an entry
+// releases the waiting task when the entry had no pending events
+// called from the stack context
+static void _SktReadySignal(TCPIP_SOCKET_READY_ENTRY* pEntry, uint8_t events)
+{
+    bool    wasIdle;
+    TCPIP_SOCKET_READY_SET* pSet = pEntry->pSet;
+
+    OSAL_CRITSECT_DATA_TYPE critSect = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+    events &= pEntry->interest;
+    wasIdle = pEntry->pending == 0;
+    pEntry->pending |= events;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, critSect);
+
+    if(events != 0 && wasIdle)
+    {
+        OSAL_SEM_Post(&pSet->readySem);
+        if(pSet->notifyF != 0)
+        {
+            (*pSet->notifyF)(pSet, pSet->notifyParam);
+        }
+    }
+}
+
+#if defined(TCPIP_STACK_USE_TCP)
+static void _SktReadyTcpSignal(TCP_SOCKET hTCP, TCPIP_NET_HANDLE hNet, TCPIP_TCP_SIGNAL_TYPE sigType, const void* param)
+{
+    uint8_t events = 0;
+
+    if((sigType & (TCPIP_TCP_SIGNAL_RX_DATA | TCPIP_TCP_SIGNAL_ACCEPT)) != 0)
+    {
+        events |= TCPIP_SOCKET_READY_EV_RX;
+    }
+    if((sigType & TCPIP_TCP_SIGNAL_TX_SPACE) != 0)
+    {
+        events |= TCPIP_SOCKET_READY_EV_TX;
+    }
+    if((sigType & _SKT_READY_TCP_STATE_SIGNALS) != 0)
+    {
+        events |= TCPIP_SOCKET_READY_EV_STATE;
+    }
+
+    _SktReadySignal((TCPIP_SOCKET_READY_ENTRY*)param, events);
+}
+#endif  // defined(TCPIP_STACK_USE_TCP)
+
+#if defined(TCPIP_STACK_USE_UDP)
+static void _SktReadyUdpSignal(UDP_SOCKET hUDP, TCPIP_NET_HANDLE hNet, TCPIP_UDP_SIGNAL_TYPE sigType, const void* param)
+{
+    uint8_t events = 0;
+
+    if((sigType & TCPIP_UDP_SIGNAL_RX_DATA) != 0)
+    {
+        events |= TCPIP_SOCKET_READY_EV_RX;
+    }
+    if((sigType & TCPIP_UDP_SIGNAL_TX_DONE) != 0)
+    {
+        events |= TCPIP_SOCKET_READY_EV_TX;
+    }
+    if((sigType & _SKT_READY_UDP_STATE_SIGNALS) != 0)
+    {
+        events |= TCPIP_SOCKET_READY_EV_STATE;
+    }
+
+    _SktReadySignal((TCPIP_SOCKET_READY_ENTRY*)param, events);
+}
+#endif  // defined(TCPIP_STACK_USE_UDP)
+
+static TCPIP_SOCKET_READY_ENTRY* _SktReadyFind(TCPIP_SOCKET_READY_SET* pSet, TCPIP_SOCKET_READY_TYPE type, int16_t socket)
+{
+    int ix;
+    TCPIP_SOCKET_READY_ENTRY* pEntry = pSet->pEntries;
+
+    for(ix = 0; ix < pSet->nEntries; ix++, pEntry++)
+    {
+        if(pEntry->socket == socket && pEntry->type == (uint8_t)type)
+        {
+            return pEntry;
+        }
+    }
+
+    return 0;
+}
+
+// registers the socket signal handler for an entry
+// returns the current socket readiness or -1 if failed
+static int _SktReadyRegister(TCPIP_SOCKET_READY_ENTRY* pEntry, TCPIP_SOCKET_READY_TYPE type, int16_t socket, uint8_t events)
+{
+    int     readyEv = 0;
+
+#if defined(TCPIP_STACK_USE_TCP)
+    if(type == TCPIP_SOCKET_READY_TYPE_TCP)
+    {
+        TCPIP_TCP_SIGNAL_TYPE sigMask = 0;
+        if((events & TCPIP_SOCKET_READY_EV_RX) != 0)
+        {
+            sigMask |= TCPIP_TCP_SIGNAL_RX_DATA | TCPIP_TCP_SIGNAL_ACCEPT;
+        }
+        if((events & TCPIP_SOCKET_READY_EV_TX) != 0)
+        {
+            sigMask |= TCPIP_TCP_SIGNAL_TX_SPACE;
+        }
+        if((events & TCPIP_SOCKET_READY_EV_STATE) != 0)
+        {
+            sigMask |= _SKT_READY_TCP_STATE_SIGNALS;
+        }
+
+        if((pEntry->hSig = TCPIP_TCP_SignalHandlerRegister(socket, sigMask, _SktReadyTcpSignal, pEntry)) == 0)
+        {
+            return -1;
+        }
+
+        if(TCPIP_TCP_GetIsReady(socket) != 0)
+        {
+            readyEv |= TCPIP_SOCKET_READY_EV_RX;
+        }
+        if(TCPIP_TCP_IsConnected(socket) && TCPIP_TCP_PutIsReady(socket) != 0)
+        {
+            readyEv |= TCPIP_SOCKET_READY_EV_TX;
+        }
+        return readyEv;
+    }
+#endif  // defined(TCPIP_STACK_USE_TCP)
+
+#if defined(TCPIP_STACK_USE_UDP)
+    if(type == TCPIP_SOCKET_READY_TYPE_UDP)
+    {
+        TCPIP_UDP_SIGNAL_TYPE sigMask = 0;
+        if((events & TCPIP_SOCKET_READY_EV_RX) != 0)
+        {
+            sigMask |= TCPIP_UDP_SIGNAL_RX_DATA;
+        }
+        if((events & TCPIP_SOCKET_READY_EV_TX) != 0)
+        {
+            sigMask |= TCPIP_UDP_SIGNAL_TX_DONE;
+        }
+        if((events & TCPIP_SOCKET_READY_EV_STATE) != 0)
+        {
+            sigMask |= _SKT_READY_UDP_STATE_SIGNALS;
+        }
+
+        if((pEntry->hSig = TCPIP_UDP_SignalHandlerRegister(socket, sigMask, _SktReadyUdpSignal, pEntry)) == 0)
+        {
+            return -1;
+        }
+
+        if(TCPIP_UDP_GetIsReady(socket) != 0)
+        {
+            readyEv |= TCPIP_SOCKET_READY_EV_RX;
+        }
+        if(TCPIP_UDP_PutIsReady(socket) != 0)
+        {
+            readyEv |= TCPIP_SOCKET_READY_EV_TX;
+        }
+        return readyEv;
+    }
+#endif  // defined(TCPIP_STACK_USE_UDP)
+
+    return -1;
+}
+
+static void _SktReadyDeregister(TCPIP_SOCKET_READY_ENTRY* pEntry)
+{
+#if defined(TCPIP_STACK_USE_TCP)
+    if(pEntry->type == TCPIP_SOCKET_READY_TYPE_TCP)
+    {
+        TCPIP_TCP_SignalHandlerDeregister(pEntry->socket, (TCPIP_TCP_SIGNAL_HANDLE)pEntry->hSig);
+    }
+#endif  // defined(TCPIP_STACK_USE_TCP)
+#if defined(TCPIP_STACK_USE_UDP)
+    if(pEntry->type == TCPIP_SOCKET_READY_TYPE_UDP)
+    {
+        TCPIP_UDP_SignalHandlerDeregister(pEntry->socket, (TCPIP_UDP_SIGNAL_HANDLE)pEntry->hSig);
+    }
+#endif  // defined(TCPIP_STACK_USE_UDP)
+
+    OSAL_CRITSECT_DATA_TYPE critSect = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+    pEntry->socket = -1;
+    pEntry->interest = pEntry->pending = 0;
+    pEntry->hSig = 0;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, critSect);
+}
+
+// collects the pending entries, starting after the last reported one
+static int _SktReadyCollect(TCPIP_SOCKET_READY_SET* pSet, TCPIP_SOCKET_READY_RESULT* pResults, int nResults)
+{
+    int     ix, entryIx, nReady;
+    uint8_t events;
+    TCPIP_SOCKET_READY_ENTRY* pEntry;
+    OSAL_CRITSECT_DATA_TYPE critSect;
+
+    nReady = 0;
+    entryIx = pSet->scanIx;
+    for(ix = 0; ix < pSet->nEntries && nReady < nResults; ix++)
+    {
+        if(++entryIx >= pSet->nEntries)
+        {
+            entryIx = 0;
+        }
+
+        pEntry = pSet->pEntries + entryIx;
+        if(pEntry->pending == 0)
+        {
+            continue;
+        }
+
+        critSect = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+        events = pEntry->pending;
+        pEntry->pending = 0;
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, critSect);
+
+        if(events != 0)
+        {
+            pResults->socket = pEntry->socket;
+            pResults->type = pEntry->type;
+            pResults->events = events;
+            pResults++;
+            nReady++;
+            pSet->scanIx = entryIx;
+        }
+    }
+
+    return nReady;
+}
+
+bool TCPIP_SOCKET_ReadySetCreate(TCPIP_SOCKET_READY_SET* pSet, TCPIP_SOCKET_READY_ENTRY* pEntries, int nEntries,
+                                 TCPIP_SOCKET_READY_NOTIFY notifyF, const void* notifyParam)
+{
+    int ix;
+
+    if(pSet == 0 || pEntries == 0 || nEntries <= 0 || nEntries > 0xffff)
+    {
+        return false;
+    }
+
+    memset(pSet, 0, sizeof(*pSet));
+    if(OSAL_SEM_Create(&pSet->readySem, OSAL_SEM_TYPE_BINARY, 1, 0) != OSAL_RESULT_TRUE)
+    {
+        return false;
+    }
+
+    memset(pEntries, 0, nEntries * sizeof(*pEntries));
+    for(ix = 0; ix < nEntries; ix++)
+    {
+        pEntries[ix].pSet = pSet;
+        pEntries[ix].socket = -1;
+    }
+
+    pSet->pEntries = pEntries;
+    pSet->nEntries = (uint16_t)nEntries;
+    pSet->scanIx = (uint16_t)(nEntries - 1);
+    pSet->notifyF = notifyF;
+    pSet->notifyParam = notifyParam;
+
+    return true;
+}
+
+void TCPIP_SOCKET_ReadySetDelete(TCPIP_SOCKET_READY_SET* pSet)
+{
+    int ix;
+    TCPIP_SOCKET_READY_ENTRY* pEntry;
+
+    if(pSet == 0 || pSet->pEntries == 0)
+    {
+        return;
+    }
+
+    for(ix = 0, pEntry = pSet->pEntries; ix < pSet->nEntries; ix++, pEntry++)
+    {
+        if(pEntry->socket >= 0)
+        {
+            _SktReadyDeregister(pEntry);
+        }
+    }
+
+    OSAL_SEM_Delete(&pSet->readySem);
+    pSet->pEntries = 0;
+    pSet->nEntries = 0;
+}
+
+bool TCPIP_SOCKET_ReadyAdd(TCPIP_SOCKET_READY_SET* pSet, TCPIP_SOCKET_READY_TYPE type, int16_t socket, TCPIP_SOCKET_READY_EVENT events)
+{
+    int readyEv;
+    TCPIP_SOCKET_READY_ENTRY* pEntry;
+
+    if(pSet == 0 || pSet->pEntries == 0 || socket < 0 || (events & TCPIP_SOCKET_READY_EV_ALL) == 0)
+    {
+        return false;
+    }
+
+    if(_SktReadyFind(pSet, type, socket) != 0)
+    {   // already there
+        return false;
+    }
+
+    if((pEntry = _SktReadyFind(pSet, 0, -1)) == 0)
+    {   // no free entry
+        return false;
+    }
+
+    // set the entry before the handler can be called
+    pEntry->type = (uint8_t)type;
+    pEntry->interest = (uint8_t)(events & TCPIP_SOCKET_READY_EV_ALL);
+    pEntry->pending = 0;
+    pEntry->socket = socket;
+
+    if((readyEv = _SktReadyRegister(pEntry, type, socket, pEntry->interest)) < 0)
+    {   // failed
+        pEntry->socket = -1;
+        pEntry->type = 0;
+        pEntry->interest = 0;
+        return false;
+    }
+
+    if(readyEv != 0)
+    {   // already ready
+        _SktReadySignal(pEntry, (uint8_t)readyEv);
+    }
+
+    return true;
+}
+
+bool TCPIP_SOCKET_ReadyRemove(TCPIP_SOCKET_READY_SET* pSet, TCPIP_SOCKET_READY_TYPE type, int16_t socket)
+{
+    TCPIP_SOCKET_READY_ENTRY* pEntry;
+
+    if(pSet == 0 || pSet->pEntries == 0 || socket < 0)
+    {
+        return false;
+    }
+
+    if((pEntry = _SktReadyFind(pSet, type, socket)) == 0)
+    {
+        return false;
+    }
+
+    _SktReadyDeregister(pEntry);
+    pEntry->type = 0;
+    return true;
+}
+
+int TCPIP_SOCKET_ReadyWait(TCPIP_SOCKET_READY_SET* pSet, TCPIP_SOCKET_READY_RESULT* pResults, int nResults, uint16_t waitMs)
+{
+    int nReady;
+
+    if(pSet == 0 || pSet->pEntries == 0 || pResults == 0 || nResults <= 0)
+    {
+        return -1;
+    }
+
+    // consume a stale release: its events could have been collected by the previous call
+    (void)OSAL_SEM_Pend(&pSet->readySem, 0);
+
+    while(true)
+    {
+        if((nReady = _SktReadyCollect(pSet, pResults, nResults)) != 0 || waitMs == 0)
+        {
+            break;
+        }
+
+        if(OSAL_SEM_Pend(&pSet->readySem, waitMs) != OSAL_RESULT_TRUE)
+        {   // timeout
+            break;
+        }
+
+        if(waitMs != OSAL_WAIT_FOREVER)
+        {   // report what's there; don't restart the timeout
+            nReady = _SktReadyCollect(pSet, pResults, nResults);
+            break;
+        }
+    }
+
+    return nReady;
+}
+
+#endif  // defined(TCPIP_STACK_USE_SOCKET_READY)
+
@@ -392,6 +392,12 @@ static uint16_t         _UDPv4IsTxPutReady(UDP_SOCKET_DCPT* pSkt);
 static uint16_t         _UDPv4Flush(UDP_SOCKET_DCPT* pSkt);
 static void*            _TxSktGetLockedV4Pkt(UDP_SOCKET_DCPT* pSkt, bool clrSktPkt);
 static void             _UDPv4TxPktReset(UDP_SOCKET_DCPT* pSkt, IPV4_PACKET* pPkt);
+static bool             _UDPv4TxRoute(UDP_SOCKET_DCPT* pSkt);
+static void             _UDPv4PacketFormat(UDP_SOCKET_DCPT* pSkt, IPV4_PACKET* pv4Pkt, uint16_t udpLoadLen, TCPIP_MAC_DATA_SEGMENT* pZSeg);
+#if (_UDP_BATCH_SEND != 0)
+static IPV4_PACKET*     _UDPv4DatagramAlloc(UDP_SOCKET_DCPT* pSkt, uint16_t loadSize);
+static void             _UDPv4DatagramDiscard(UDP_SOCKET_DCPT* pSkt, IPV4_PACKET* pPkt);
+#endif  // (_UDP_BATCH_SEND != 0)
 static TCPIP_MAC_PKT_ACK_RES TCPIP_UDP_ProcessIPv4(TCPIP_MAC_PACKET* pRxPkt);
 #endif  // defined (TCPIP_STACK_USE_IPV4)
 
@@ -1622,20 +1628,13 @@ static TCPIP_MAC_PKT_ACK_RES TCPIP_UDP_ProcessIPv4(TCPIP_MAC_PACKET* pRxPkt)
 
 }
 
-static uint16_t _UDPv4Flush(UDP_SOCKET_DCPT* pSkt)
+// solves the socket route for an IPv4 transmission
+// returns false if there's no destination or no route to it
+static bool _UDPv4TxRoute(UDP_SOCKET_DCPT* pSkt)
 {
-    IPV4_PACKET*        pv4Pkt;
-    uint16_t            udpLoadLen, udpTotLen, rootLen;
-    UDP_HEADER*         pUDPHdr;
-    IPV4_PSEUDO_HEADER  pseudoHdr;
-    uint16_t            checksum;
-    TCPIP_MAC_DATA_SEGMENT* pZSeg;
-    TCPIP_IPV4_PACKET_PARAMS pktParams;
-    bool                isMcastDest;
-
     if(pSkt->destAddress.Val == 0)
     {   // don't even bother
-        return 0;
+        return false;
     }
 
     if(pSkt->flags.srcSolved == 0 || pSkt->pSktNet == 0)
@@ -1643,7 +1642,7 @@ static uint16_t _UDPv4Flush(UDP_SOCKET_DCPT* pSkt)
         pSkt->pSktNet = (TCPIP_NET_IF*)TCPIP_IPV4_SelectSourceInterface(pSkt->pSktNet, &pSkt->destAddress, &pSkt->srcAddress, pSkt->flags.srcValid != 0);
         if(pSkt->pSktNet == 0)
         {   // cannot find an route?
-            return 0;
+            return false;
         }
         pSkt->flags.srcSolved = 1;
         pSkt->flags.srcValid = 1;
@@ -1654,7 +1653,23 @@ static uint16_t _UDPv4Flush(UDP_SOCKET_DCPT* pSkt)
         pSkt->destAddress.Val = TCPIP_STACK_NetAddressBcast(pSkt->pSktNet);
     }
 
-    pv4Pkt = pSkt->pV4Pkt;
+    return true;
+}
+
+// builds the UDP and IPv4 headers in place for a socket packet
+// udpLoadLen is the UDP payload size
+// pZSeg != 0 for a split packet: the payload is in the external pZSeg
+// otherwise the payload follows the UDP header
+// the route should have been solved with _UDPv4TxRoute
+static void _UDPv4PacketFormat(UDP_SOCKET_DCPT* pSkt, IPV4_PACKET* pv4Pkt, uint16_t udpLoadLen, TCPIP_MAC_DATA_SEGMENT* pZSeg)
+{
+    uint16_t            udpTotLen, rootLen;
+    UDP_HEADER*         pUDPHdr;
+    IPV4_PSEUDO_HEADER  pseudoHdr;
+    uint16_t            checksum;
+    TCPIP_IPV4_PACKET_PARAMS pktParams;
+    bool                isMcastDest;
+
     pv4Pkt->srcAddress.Val = pSkt->srcAddress.Val;
     pv4Pkt->destAddress.Val = pSkt->destAddress.Val;
     pv4Pkt->netIfH = pSkt->pSktNet;
@@ -1663,18 +1678,13 @@ static uint16_t _UDPv4Flush(UDP_SOCKET_DCPT* pSkt)
     pUDPHdr = (UDP_HEADER*)pv4Pkt->macPkt.pTransportLayer;
 
     // update the current load length
-    if(pSkt->flags.txSplitAlloc != 0)
-    {
-        pZSeg = ((UDP_V4_PACKET*)pv4Pkt)->zcSeg;
-        udpLoadLen = pZSeg->segLen;
+    if(pZSeg != 0)
+    {   // size of the payload should already be set
         rootLen = sizeof(UDP_HEADER);
-        // size of the payload should already be set
     }
     else
     {
-        udpLoadLen = pSkt->txWrite - pSkt->txStart;
         rootLen = udpLoadLen + sizeof(UDP_HEADER); 
-        pZSeg = 0;
     }
     pv4Pkt->macPkt.pDSeg->segLen += rootLen;
     udpTotLen = udpLoadLen + sizeof(UDP_HEADER);
@@ -1694,7 +1704,7 @@ static uint16_t _UDPv4Flush(UDP_SOCKET_DCPT* pSkt)
 
         checksum = ~TCPIP_Helper_CalcIPChecksum((uint8_t*)&pseudoHdr, sizeof(pseudoHdr), 0);
 
-        if(pSkt->flags.txSplitAlloc != 0)
+        if(pZSeg != 0)
         {
             checksum = ~TCPIP_Helper_CalcIPChecksum((uint8_t*)pUDPHdr, sizeof(UDP_HEADER), checksum);
             checksum = ~TCPIP_Helper_CalcIPChecksum(pZSeg->segLoad, udpLoadLen, checksum);
@@ -1732,6 +1742,32 @@ static uint16_t _UDPv4Flush(UDP_SOCKET_DCPT* pSkt)
     {
         pv4Pkt->macPkt.modPktData = 0;
     }
+}
+
+static uint16_t _UDPv4Flush(UDP_SOCKET_DCPT* pSkt)
+{
+    IPV4_PACKET*        pv4Pkt;
+    uint16_t            udpLoadLen;
+    TCPIP_MAC_DATA_SEGMENT* pZSeg;
+
+    if(!_UDPv4TxRoute(pSkt))
+    {
+        return 0;
+    }
+
+    pv4Pkt = pSkt->pV4Pkt;
+    if(pSkt->flags.txSplitAlloc != 0)
+    {
+        pZSeg = ((UDP_V4_PACKET*)pv4Pkt)->zcSeg;
+        udpLoadLen = pZSeg->segLen;
+    }
+    else
+    {
+        udpLoadLen = pSkt->txWrite - pSkt->txStart;
+        pZSeg = 0;
+    }
+
+    _UDPv4PacketFormat(pSkt, pv4Pkt, udpLoadLen, pZSeg);
 
     TCPIP_PKT_FlightLogTxSkt(&pv4Pkt->macPkt, TCPIP_THIS_MODULE_ID,  ((uint32_t)pSkt->localPort << 16) | pSkt->remotePort, pSkt->sktIx);
     if(TCPIP_IPV4_PacketTransmit(pv4Pkt))
@@ -1746,6 +1782,63 @@ static uint16_t _UDPv4Flush(UDP_SOCKET_DCPT* pSkt)
     return 0;
 }
 
+#if (_UDP_BATCH_SEND != 0)
+// allocates a stand alone TX packet for a socket, with room for loadSize bytes of payload
+// the packet is not the socket current TX packet
+// and is released by _UDPv4TxAckFnc once transmitted
+static IPV4_PACKET* _UDPv4DatagramAlloc(UDP_SOCKET_DCPT* pSkt, uint16_t loadSize)
+{
+    TCPIP_MAC_PACKET_FLAGS allocFlags;
+    TCPIP_MAC_PACKET*   pPkt;
+    bool                allocOk;
+
+    // reserve the packet in the socket TX queue
+    OSAL_CRITSECT_DATA_TYPE status = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+    if((allocOk = pSkt->txAllocCnt < pSkt->txAllocLimit))
+    {
+        pSkt->txAllocCnt++;
+    }
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, status);
+
+    if(!allocOk)
+    {   // cannot try to allocate any more packets
+        return 0;
+    }
+
+    allocFlags = TCPIP_MAC_PKT_FLAG_IPV4;
+    if(pSkt->flags.stackConfig != 0)
+    {
+        allocFlags |= TCPIP_MAC_PKT_FLAG_CONFIG;
+    }
+
+    pPkt = _UDPAllocateTxPacket(sizeof(UDP_V4_PACKET), loadSize, allocFlags);
+    if(pPkt == 0)
+    {   // release the reservation
+        status = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+        pSkt->txAllocCnt--;
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, status);
+        return 0;
+    }
+
+    TCPIP_PKT_PacketAcknowledgeSet(pPkt, _UDPv4TxAckFnc, pSkt);
+    return (IPV4_PACKET*)pPkt;
+}
+
+// releases a packet obtained with _UDPv4DatagramAlloc
+// pSkt could be 0 if the socket is no longer valid
+static void _UDPv4DatagramDiscard(UDP_SOCKET_DCPT* pSkt, IPV4_PACKET* pPkt)
+{
+    OSAL_CRITSECT_DATA_TYPE status = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+    if(pSkt != 0 && pPkt->macPkt.ackParam == pSkt && pSkt->txAllocCnt != 0)
+    {
+        pSkt->txAllocCnt--;
+    }
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, status);
+
+    TCPIP_PKT_PacketFree(&pPkt->macPkt);
+}
+#endif  // (_UDP_BATCH_SEND != 0)
+
 #endif  // defined (TCPIP_STACK_USE_IPV4)
 
 #if defined (TCPIP_STACK_USE_IPV6)
@@ -2632,6 +2725,144 @@ uint16_t TCPIP_UDP_TxCountGet(UDP_SOCKET s)
     return 0;
 }
 
+#if defined (TCPIP_STACK_USE_IPV4) && (_UDP_BATCH_SEND != 0)
+TCPIP_MAC_PACKET* TCPIP_UDP_DatagramAlloc(UDP_SOCKET s, uint16_t loadSize, uint8_t** pLoad)
+{
+    IPV4_PACKET* pv4Pkt;
+    UDP_SOCKET_DCPT* pSkt = _UDPSocketDcpt(s);
+
+    if(pSkt == 0 || pSkt->addType != IP_ADDRESS_TYPE_IPV4 || pLoad == 0)
+    {
+        return 0;
+    }
+
+    if((pv4Pkt = _UDPv4DatagramAlloc(pSkt, loadSize)) == 0)
+    {
+        return 0;
+    }
+
+    *pLoad = pv4Pkt->macPkt.pTransportLayer + sizeof(UDP_HEADER);
+    return &pv4Pkt->macPkt;
+}
+
+void TCPIP_UDP_DatagramFree(UDP_SOCKET s, TCPIP_MAC_PACKET* pPkt)
+{
+    if(pPkt != 0)
+    {
+        _UDPv4DatagramDiscard(_UDPSocketDcpt(s), (IPV4_PACKET*)pPkt);
+    }
+}
+
+// builds all the datagrams packets and passes them to IPv4 as a single chain
+// so that the route, the destination MAC address and the MAC call are done once per batch
+uint16_t TCPIP_UDP_DatagramsSend(UDP_SOCKET s, TCPIP_UDP_DATAGRAM* dgArray, uint16_t nDgrams)
+{
+    TCPIP_UDP_DATAGRAM* pDg;
+    IPV4_PACKET     *pv4Pkt, *pHead, *pTail, *pNext;
+    TCPIP_MAC_DATA_SEGMENT* pSeg;
+    uint16_t        ix, nPkts, nSent;
+    bool            txFail;
+
+    UDP_SOCKET_DCPT* pSkt = _UDPSocketDcpt(s);
+
+    if(pSkt == 0 || pSkt->addType != IP_ADDRESS_TYPE_IPV4 || dgArray == 0 || nDgrams == 0)
+    {
+        return 0;
+    }
+
+    if(!_UDPv4TxRoute(pSkt))
+    {
+        return 0;
+    }
+
+    // build the chain; stop at the first datagram that cannot be built
+    pHead = pTail = 0;
+    for(ix = 0, pDg = dgArray; ix < nDgrams; ix++, pDg++)
+    {
+        if(pDg->pPkt != 0)
+        {   // zero copy: data already in place; check it belongs to this socket and fits
+            pv4Pkt = (IPV4_PACKET*)pDg->pPkt;
+            pSeg = pv4Pkt->macPkt.pDSeg;
+            if(pv4Pkt->macPkt.ackParam != pSkt || (pv4Pkt->macPkt.pktFlags & TCPIP_MAC_PKT_FLAG_QUEUED) != 0)
+            {
+                break;
+            }
+            if(pv4Pkt->macPkt.pTransportLayer + sizeof(UDP_HEADER) + pDg->dataLen > pSeg->segLoad + pSeg->segSize)
+            {
+                break;
+            }
+        }
+        else
+        {   // copy to a packet of the datagram size
+            if((pDg->pData == 0 && pDg->dataLen != 0) || (pv4Pkt = _UDPv4DatagramAlloc(pSkt, pDg->dataLen)) == 0)
+            {
+                break;
+            }
+            if(pDg->dataLen != 0)
+            {
+                TCPIP_Helper_Memcpy(pv4Pkt->macPkt.pTransportLayer + sizeof(UDP_HEADER), pDg->pData, pDg->dataLen);
+            }
+        }
+
+        _UDPv4PacketFormat(pSkt, pv4Pkt, pDg->dataLen, 0);
+        TCPIP_PKT_FlightLogTxSkt(&pv4Pkt->macPkt, TCPIP_THIS_MODULE_ID,  ((uint32_t)pSkt->localPort << 16) | pSkt->remotePort, pSkt->sktIx);
+
+        if(pTail == 0)
+        {
+            pHead = pv4Pkt;
+        }
+        else
+        {
+            pTail->macPkt.next = &pv4Pkt->macPkt;
+        }
+        pTail = pv4Pkt;
+    }
+
+    if((nPkts = ix) == 0)
+    {
+        return 0;
+    }
+
+    if(TCPIP_IPV4_PacketChainTransmit(pHead))
+    {
+        return nPkts;
+    }
+
+    // could not go as a chain: ARP not solved, internal destination, etc.
+    // transmit one by one and stop at the first failure
+    nSent = 0;
+    txFail = false;
+    for(pv4Pkt = pHead, pDg = dgArray; pv4Pkt != 0; pv4Pkt = pNext, pDg++)
+    {
+        pNext = (IPV4_PACKET*)pv4Pkt->macPkt.next;
+        pv4Pkt->macPkt.next = 0;
+
+        if(!txFail)
+        {
+            if(TCPIP_IPV4_PacketTransmit(pv4Pkt))
+            {
+                nSent++;
+                continue;
+            }
+            txFail = true;
+        }
+
+        TCPIP_PKT_FlightLogAcknowledge(&pv4Pkt->macPkt, TCPIP_THIS_MODULE_ID, TCPIP_MAC_PKT_ACK_IP_REJECT_ERR);
+        if(pDg->pPkt != 0)
+        {   // user packet: return it, ready to be sent again
+            pv4Pkt->macPkt.pDSeg->segLen = 0;
+            pv4Pkt->macPkt.pktFlags &= ~TCPIP_MAC_PKT_FLAG_QUEUED;
+        }
+        else
+        {
+            _UDPv4DatagramDiscard(pSkt, pv4Pkt);
+        }
+    }
+
+    return nSent;
+}
+#endif  // defined (TCPIP_STACK_USE_IPV4) && (_UDP_BATCH_SEND != 0)
+
 
 /****************************************************************************
   Section:
@@ -3615,7 +3846,7 @@ static UDP_PORT _UDPAllocateEphemeralPort(void)
 
     count = num_ephemeral = TCPIP_UDP_LOCAL_PORT_END_NUMBER - TCPIP_UDP_LOCAL_PORT_START_NUMBER + 1;
 
-    next_ephemeral = TCPIP_UDP_LOCAL_PORT_START_NUMBER + (SYS_RANDOM_PseudoGet() % num_ephemeral);
+    next_ephemeral = TCPIP_UDP_LOCAL_PORT_START_NUMBER + (SYS_RANDOM_PoolGet(SYS_RANDOM_POOL_NET_ID) % num_ephemeral);
 
     while(count--)
     {
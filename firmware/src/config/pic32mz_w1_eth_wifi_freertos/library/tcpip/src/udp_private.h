@@ -72,6 +72,12 @@ Microchip or any third party.
 #define _TCPIP_IPV4_FRAGMENTATION    0
 #endif
 
+#if defined(TCPIP_UDP_BATCH_SEND) && (TCPIP_UDP_BATCH_SEND != 0)
+#define _UDP_BATCH_SEND     1
+#else
+#define _UDP_BATCH_SEND     0
+#endif
+
 typedef struct
 {
     IPV4_PACKET             v4Pkt;     // safe cast to IPV4_PACKET
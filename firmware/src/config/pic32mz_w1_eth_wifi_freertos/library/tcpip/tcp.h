@@ -389,6 +389,10 @@ typedef enum
     TCPIP_TCP_SIGNAL_IF_CHANGE       = 0x4000,  // associated interface has changed address
                                                 // sockets connected on this interface will be disconnected, but still alive
 
+    // listening socket signals
+    TCPIP_TCP_SIGNAL_ACCEPT          = 0x8000,  // A new connection is waiting in the accept queue of a listening socket
+                                                // that has a backlog set; retrieve it with TCPIP_TCP_Accept
+
 }TCPIP_TCP_SIGNAL_TYPE;
 
 // *****************************************************************************
@@ -757,6 +761,12 @@ bool  TCPIP_TCP_RemoteBind(TCP_SOCKET hTCP, IP_ADDRESS_TYPE addType, TCP_PORT re
   Returns:
     - true  - Indicates success
     - false - Indicates failure
+
+  Remarks:
+    When TCPIP_TCP_AUTO_TUNE is enabled, the stack may grow the RX/TX buffers
+    of a busy socket; the sizes set with TCP_OPTION_RX_BUFF/TCP_OPTION_TX_BUFF
+    are the ones restored when the socket becomes idle.
+    TCPIP_TCP_OptionsGet returns the current sizes.
   */
 bool  TCPIP_TCP_OptionsSet(TCP_SOCKET hTCP, TCP_SOCKET_OPTION option, void* optParam);
 
@@ -1055,6 +1065,86 @@ bool  TCPIP_TCP_Connect(TCP_SOCKET hTCP);
   */
 bool  TCPIP_TCP_Close(TCP_SOCKET hTCP);
 
+//******************************************************************************
+/*
+  Function:
+    bool  TCPIP_TCP_ServerBacklogSet(TCP_SOCKET hTCP, uint8_t backlog)
+
+  Summary:
+    Sets the listen backlog of a server socket.
+
+  Description:
+    By default a listening server socket takes the incoming connection itself
+    and one server socket is needed for each simultaneous connection.
+    With a backlog set, the server socket keeps listening:
+    each incoming SYN is handled by a new socket allocated from the free TCP sockets,
+    with the options and buffer sizes of the listening socket.
+    Once the handshake completes, the new socket is placed in the socket accept queue
+    and it is retrieved with TCPIP_TCP_Accept().
+    SYNs received while the backlog is full are dropped and the remote host will retry.
+
+  Precondition:
+    TCP socket should have been opened with TCPIP_TCP_ServerOpen() and it is listening.
+    hTCP - valid socket
+
+  Parameters:
+    hTCP    - Handle to the listening server socket.
+    backlog - maximum number of connections that are being established
+              or waiting to be accepted.
+              0 restores the default behavior.
+
+  Returns:
+    - true  - If the call succeeded
+    - false - If the call failed: no such socket or not a listening server socket
+
+  Remarks:
+    Each connection in the backlog uses a TCP socket, so TCPIP_TCP_MAX_SOCKETS
+    bounds the connections of all the listening sockets.
+
+    The TCPIP_TCP_SIGNAL_ACCEPT signal is sent to the listening socket when
+    a new connection is placed in the accept queue.
+
+    Closing the listening socket aborts the connections not yet accepted.
+
+    Available only when TCPIP_TCP_LISTEN_BACKLOG is enabled.
+  */
+bool  TCPIP_TCP_ServerBacklogSet(TCP_SOCKET hTCP, uint8_t backlog);
+
+//******************************************************************************
+/*
+  Function:
+    TCP_SOCKET  TCPIP_TCP_Accept(TCP_SOCKET hTCP)
+
+  Summary:
+    Accepts a connection of a listening server socket.
+
+  Description:
+    This function returns the oldest connection from the accept queue
+    of a server socket that has a backlog set.
+
+  Precondition:
+    TCP socket should have been opened with TCPIP_TCP_ServerOpen()
+    and TCPIP_TCP_ServerBacklogSet() called.
+    hTCP - valid socket
+
+  Parameters:
+    hTCP - Handle to the listening server socket.
+
+  Returns:
+    - A TCP_SOCKET handle for the new connection
+    - INVALID_SOCKET - if there is no connection to be accepted
+
+  Remarks:
+    The returned socket belongs to the caller, which must close it with TCPIP_TCP_Close().
+    It's not a server socket: it won't return to listening when the connection ends.
+
+    The connection could have received data or could have been closed by the remote host
+    before being accepted.
+
+    Available only when TCPIP_TCP_LISTEN_BACKLOG is enabled.
+  */
+TCP_SOCKET  TCPIP_TCP_Accept(TCP_SOCKET hTCP);
+
 //*****************************************************************************
 /*
   Function:
@@ -1715,6 +1805,9 @@ uint16_t  TCPIP_TCP_ArrayFind(TCP_SOCKET hTCP, const uint8_t* cFindArray,
     Doing this may disrupt the communication, make the TCP algorithm fail or have an 
     unpredicted behavior!
 
+    When TCPIP_TCP_AUTO_TUNE is enabled, the sizes set by this function
+    become the sizes the automatic buffer tuning returns to when the socket is idle.
+
     This function is OBSOLETE and should NOT BE USED in new projects!
     It will be removed from the API in the future.
     The socket options TCP_OPTION_RX_BUFF and TCP_OPTION_TX_BUFF should be used to adjust the size of the socket buffers.
@@ -742,5 +742,6 @@ typedef struct TCPIP_STACK_INIT
 #include "tcpip/lldp.h"
 #include "tcpip/tcpip_commands.h"
 #include "tcpip/tcpip_mac_bridge.h"
+#include "tcpip/tcpip_socket_ready.h"
 #endif  // __TCPIP_H__
 
@@ -270,6 +270,8 @@ typedef enum
     // default is enabled
     // Note: the TCP/IP stack always uses non-cached buffers
     // for the network packets.
+    // With TCPIP_STACK_PACKET_CACHED_BUFFERS enabled, only the packet
+    // data buffers are accessed through the cached alias.
     // This flag will be set internally whenever needed. 
     TCPIP_STACK_HEAP_FLAG_ALLOC_UNCACHED    = 0x01,
     
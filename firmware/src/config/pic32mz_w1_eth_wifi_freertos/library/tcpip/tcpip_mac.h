@@ -279,6 +279,11 @@ typedef enum
     segment buffer:
         | Cache aligned buffer segBuffer (segSize bytes)                |
 
+    When TCPIP_STACK_PACKET_CACHED_BUFFERS is enabled, the gap and the segment buffer
+    are returned as cached (KSEG0) addresses and own all the cache lines they span.
+    A MAC driver that passes such a buffer to a DMA engine has to write back the cache
+    before a TX and invalidate it before and after a RX.
+
 
     The Harmony TCP/IP stack packet allocator properly sets the segmentPktPtr.
         
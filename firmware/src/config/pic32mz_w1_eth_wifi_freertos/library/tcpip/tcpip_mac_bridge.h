@@ -58,7 +58,8 @@ Microchip or any third party.
 /* The implementation of the bridge functionality is a subset of the IEEE 802.1D - 2004 standard.
  * Not implemented functionality and known limitations:
  *  - IEEE 802.3 and IEEE 802.11 support only
- *  - No STP/RSTP support
+ *  - RSTP (IEEE 802.1D-2004 clause 17) only when TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0.
+ *    There is no STP compatibility mode: legacy BPDUs are processed but never transmitted
  *  - no QoS support
  *  - no support for Extended Filtering Services
  *  - no GARP Multicast Registration Protocol (GMRP)
@@ -99,6 +100,10 @@ typedef enum
     TCPIP_MAC_BRIDGE_RES_INDEX_NO_ENTRY     = -15,      // FDB index exists but the entry is not used
     TCPIP_MAC_BRIDGE_RES_LOCK_ERROR         = -16,      // another FDB operation is in progress and the FDB is locked
                                                         // retry
+    TCPIP_MAC_BRIDGE_RES_VLAN_ERROR         = -17,      // VLAN configuration error: invalid VLAN ID, duplicate VLAN,
+                                                        // too many VLANs or more than one PVID for a port
+    TCPIP_MAC_BRIDGE_RES_ACL_ERROR          = -18,      // ACL configuration error: invalid rule, too many rules
+                                                        // or the compiled rule table could not be allocated
 
 }TCPIP_MAC_BRIDGE_RESULT;
 
@@ -135,6 +140,18 @@ typedef enum
     // maintenance events
     TCPIP_MAC_BRIDGE_EVENT_ENTRY_ADDED,     // dynamic MAC source address added to the FDB
     TCPIP_MAC_BRIDGE_EVENT_ENTRY_EXPIRED,   // FDB dynamic entry expired
+
+    // RSTP events
+    TCPIP_MAC_BRIDGE_EVENT_TOPOLOGY_CHANGE, // a topology change was detected or received; the FDB was flushed
+    TCPIP_MAC_BRIDGE_EVENT_PORT_STATE,      // a bridge port changed its forwarding state
+
+    // learning limits events
+    TCPIP_MAC_BRIDGE_EVENT_LEARN_DENIED,    // a new source address was not learnt: port limit or rate exceeded or learning disabled
+    TCPIP_MAC_BRIDGE_EVENT_ENTRY_EVICTED,   // a not yet expired dynamic entry was removed to make room in a full FDB
+
+    // MAC move dampening events
+    TCPIP_MAC_BRIDGE_EVENT_ENTRY_PINNED,    // a dynamic entry moved between ports more than TCPIP_MAC_BRIDGE_MOVE_THRESHOLD times
+                                            // within TCPIP_MAC_BRIDGE_MOVE_WINDOW and was pinned to its port
 }TCPIP_MAC_BRIDGE_EVENT;
 
 // *****************************************************************************
@@ -167,6 +184,18 @@ typedef enum
                                           pointer to a constant  MAC address that's been added
     TCPIP_MAC_BRIDGE_EVENT_ENTRY_EXPIRED- evInfo 
 
+    TCPIP_MAC_BRIDGE_EVENT_TOPOLOGY_CHANGE - evInfo == the port number the topology change was detected/received on 
+    TCPIP_MAC_BRIDGE_EVENT_PORT_STATE   - evInfo == (port number << 8) | new TCPIP_MAC_BRIDGE_PORT_STATE
+
+    TCPIP_MAC_BRIDGE_EVENT_LEARN_DENIED - evInfo == const TCPIP_MAC_ADD
+                                          pointer to a constant  MAC address that was not learnt
+                                          reported at most once per second for a port
+    TCPIP_MAC_BRIDGE_EVENT_ENTRY_EVICTED - evInfo == const TCPIP_MAC_ADD
+                                          pointer to a constant  MAC address that's been evicted
+
+    TCPIP_MAC_BRIDGE_EVENT_ENTRY_PINNED - evInfo == const TCPIP_MAC_ADD
+                                          pointer to a constant  MAC address that's been pinned
+
  */
 
 typedef void    (*TCPIP_MAC_BRIDGE_EVENT_HANDLER)(TCPIP_MAC_BRIDGE_EVENT evType, const void* evInfo);
@@ -364,6 +393,158 @@ typedef struct
     const TCPIP_MAC_BRIDGE_CONTROL_ENTRY*   pControlEntry;  // array of control entries, controlEntries entries
 }TCPIP_MAC_BRIDGE_PERMANENT_ENTRY;
 
+// *****************************************************************************
+/* MAC bridge VLAN member flags
+
+  Summary:
+    Flags describing how a bridge port is a member of a VLAN
+
+  Description:
+    IEEE 802.1Q port membership flags
+    used in the bridge VLAN configuration
+
+  Remarks:
+    8 bit values only supported
+ */
+typedef enum
+{
+    TCPIP_MAC_BRIDGE_VLAN_FLAG_NONE     = 0x00,     // tagged member: the VLAN frames are transmitted tagged on this port
+    TCPIP_MAC_BRIDGE_VLAN_FLAG_UNTAGGED = 0x01,     // untagged member: the VLAN frames are transmitted untagged on this port
+    TCPIP_MAC_BRIDGE_VLAN_FLAG_PVID     = 0x02,     // this VLAN is the port VLAN ID (PVID) of the port:
+                                                    // untagged and priority tagged frames received on the port belong to this VLAN
+                                                    // A port can have at most one PVID.
+                                                    // A port without a PVID discards the untagged frames.
+}TCPIP_MAC_BRIDGE_VLAN_FLAGS;
+
+// *****************************************************************************
+/* MAC bridge VLAN member
+
+  Summary:
+    Data structure for the bridge VLAN configuration
+
+  Description:
+    Describes one bridge port that is a member of a VLAN
+
+  Remarks:
+    None
+ */
+typedef struct
+{
+    uint8_t     ifIx;               // index of the member interface
+                                    // this interface should be part of the bridge
+    uint8_t     memberFlags;        // a TCPIP_MAC_BRIDGE_VLAN_FLAGS value
+}TCPIP_MAC_BRIDGE_VLAN_MEMBER;
+
+// *****************************************************************************
+/* MAC bridge VLAN entry
+
+  Summary:
+    Data structure for the bridge VLAN configuration
+
+  Description:
+    Describes an IEEE 802.1Q VLAN and its member ports
+
+  Remarks:
+    Frames are forwarded/flooded only to the member ports of their VLAN.
+    Frames received on a port that is not a member of their VLAN are discarded.
+
+    The host processes only the untagged/priority tagged frames 
+    that belong to the PVID of the port they were received on.
+ */
+typedef struct
+{
+    uint16_t                                vlanId;     // the VLAN ID, 1 - 4094
+    uint8_t                                 nMembers;   // entries in the pMembers
+    const TCPIP_MAC_BRIDGE_VLAN_MEMBER*     pMembers;   // array of member ports, nMembers entries
+}TCPIP_MAC_BRIDGE_VLAN_ENTRY;
+
+// *****************************************************************************
+/* MAC bridge ACL match flags
+
+  Summary:
+    Frame fields checked by an ACL rule
+
+  Description:
+    A rule matches a frame when all the fields selected by its flags match.
+    A rule with no flags set matches any frame.
+
+  Remarks:
+    Used only when TCPIP_MAC_BRIDGE_ACL != 0
+    16 bit values only supported
+ */
+typedef enum
+{
+    TCPIP_MAC_BRIDGE_ACL_MATCH_NONE         = 0x0000,   // any frame
+    TCPIP_MAC_BRIDGE_ACL_MATCH_IN_PORT      = 0x0001,   // the bridge port the frame is received on
+    TCPIP_MAC_BRIDGE_ACL_MATCH_SRC_MAC      = 0x0002,   // source MAC address
+    TCPIP_MAC_BRIDGE_ACL_MATCH_DEST_MAC     = 0x0004,   // destination MAC address
+    TCPIP_MAC_BRIDGE_ACL_MATCH_ETHER_TYPE   = 0x0008,   // EtherType; for a tagged frame the encapsulated type
+    TCPIP_MAC_BRIDGE_ACL_MATCH_VLAN         = 0x0010,   // VLAN ID
+    TCPIP_MAC_BRIDGE_ACL_MATCH_IP_PROTO     = 0x0020,   // IPv4 protocol or IPv6 next header
+                                                        // a non IP frame does not match
+    TCPIP_MAC_BRIDGE_ACL_MATCH_SRC_PORT     = 0x0040,   // TCP/UDP source port range
+                                                        // a frame without TCP/UDP ports (other protocol, IPv4 fragment) does not match
+    TCPIP_MAC_BRIDGE_ACL_MATCH_DEST_PORT    = 0x0080,   // TCP/UDP destination port range
+
+    TCPIP_MAC_BRIDGE_ACL_MATCH_ALL          = 0x00ff,   // all the supported flags
+}TCPIP_MAC_BRIDGE_ACL_MATCH;
+
+// *****************************************************************************
+/* MAC bridge ACL action
+
+  Summary:
+    Action of an ACL rule
+
+  Description:
+    The action of the first (highest priority) rule that matches
+    a frame is applied to that frame.
+
+  Remarks:
+    Used only when TCPIP_MAC_BRIDGE_ACL != 0
+    A frame that no rule matches is processed as usual.
+ */
+typedef enum
+{
+    TCPIP_MAC_BRIDGE_ACL_ACTION_PERMIT  = 0,    // the frame is processed as usual; the following rules are not checked
+    TCPIP_MAC_BRIDGE_ACL_ACTION_DROP,           // the frame is discarded: not learnt, not forwarded and not processed by the host
+}TCPIP_MAC_BRIDGE_ACL_ACTION;
+
+// *****************************************************************************
+/* MAC bridge ACL rule
+
+  Summary:
+    Data structure for a bridge ingress ACL rule
+
+  Description:
+    Describes a class of frames received on the bridge ports
+    and the action to be taken for them.
+
+  Remarks:
+    Used only when TCPIP_MAC_BRIDGE_ACL != 0
+
+    Only the fields selected by matchFlags are used.
+    The VLAN ID is the ID from the frame tag or the PVID of the input port if the bridge is VLAN aware.
+    An untagged frame in a bridge that is not VLAN aware has the VLAN ID 0.
+
+    The rules are compiled into a lookup table when they are set
+    so the cost of checking a frame does not grow with the number of rules.
+ */
+typedef struct
+{
+    uint16_t        matchFlags;     // TCPIP_MAC_BRIDGE_ACL_MATCH value: the fields checked by this rule
+    uint8_t         action;         // TCPIP_MAC_BRIDGE_ACL_ACTION value
+    uint8_t         inPort;         // input bridge port
+    TCPIP_MAC_ADDR  srcAdd;         // source MAC address
+    TCPIP_MAC_ADDR  destAdd;        // destination MAC address
+    uint16_t        etherType;      // EtherType, host order
+    uint16_t        vlanId;         // VLAN ID
+    uint16_t        srcPortLow;     // TCP/UDP source port range, inclusive
+    uint16_t        srcPortHigh;
+    uint16_t        destPortLow;    // TCP/UDP destination port range, inclusive
+    uint16_t        destPortHigh;
+    uint8_t         ipProto;        // IP protocol: IP_PROT_TCP, IP_PROT_UDP, etc.
+}TCPIP_MAC_BRIDGE_ACL_RULE;
+
 
 
 // *****************************************************************************
@@ -448,6 +629,25 @@ typedef struct
     /* Bridge permanent table. Not mandatory, could be NULL.
      * An array of TCPIP_MAC_BRIDGE_PERMANENT_ENTRY */
     const TCPIP_MAC_BRIDGE_PERMANENT_ENTRY* bridgePermTable;
+
+    /* The number of entries in the VLAN table.
+     * Not mandatory, could be 0. Should be <= TCPIP_MAC_BRIDGE_MAX_VLANS.
+     * If 0, the bridge is not VLAN aware and the frames are forwarded unchanged.
+     * Used only when TCPIP_MAC_BRIDGE_VLAN_SUPPORT != 0 */
+    size_t                                  vlanTableSize;
+
+    /* Bridge VLAN table. Not mandatory, could be NULL.
+     * An array of TCPIP_MAC_BRIDGE_VLAN_ENTRY */
+    const TCPIP_MAC_BRIDGE_VLAN_ENTRY*      vlanTable;
+
+    /* The number of rules in the ingress ACL.
+     * Not mandatory, could be 0. Should be <= TCPIP_MAC_BRIDGE_ACL_MAX_RULES.
+     * Used only when TCPIP_MAC_BRIDGE_ACL != 0 */
+    size_t                                  aclTableSize;
+
+    /* Bridge ingress ACL. Not mandatory, could be NULL.
+     * An array of TCPIP_MAC_BRIDGE_ACL_RULE, in priority order */
+    const TCPIP_MAC_BRIDGE_ACL_RULE*        aclTable;
                                                                                           
 
 }TCPIP_MAC_BRIDGE_CONFIG;
@@ -478,6 +678,16 @@ typedef struct
     uint32_t    fwdMcastPackets;    // total forwarded multicast packets
     uint32_t    fwdDirectPackets;   // total directly forwarded packets;
                                     // these are packets not processed by the host so a packet copy was not necessary
+    uint32_t    vlanDiscardPackets; // discarded packets with a VLAN the port is not a member of
+    uint32_t    rstpDiscardPackets; // packets not relayed because of the RSTP state of the port
+    uint32_t    learnDenied;        // new source addresses not learnt because of the port learning limits
+    uint32_t    learnDropPackets;   // packets dropped by the TCPIP_MAC_BRIDGE_LEARN_POLICY_DROP policy
+    uint32_t    macMoves;           // learnt addresses that moved to this port
+    uint32_t    moveDenied;         // address moves to this port ignored because the entry was pinned
+    uint32_t    backlogPackets;     // packets held in the port TX backlog because the MAC was busy
+    uint32_t    backlogDropPackets; // packets dropped because the port TX backlog was full
+    uint32_t    ackFiltered;        // queued pure TCP ACKs dropped because a newer ACK of the same connection superseded them
+    uint32_t    aclDropPackets;     // packets dropped by an ingress ACL rule
 }TCPIP_MAC_BRIDGE_PORT_STAT;
 
 // *****************************************************************************
@@ -502,6 +712,7 @@ typedef struct
     uint32_t    failSize;          // forwarding failures due to packet size
     uint32_t    failLocks;         // FDB was locked
     uint32_t    fdbFull;           // FDB was full
+    uint32_t    fdbEvictions;      // not expired dynamic entries removed from a full FDB
 
     uint32_t    allocPackets;      // number of run time allocated packets
     uint32_t    allocDcpts;        // number of run time allocated descriptors
@@ -517,6 +728,219 @@ typedef struct
     TCPIP_MAC_BRIDGE_PORT_STAT portStat[TCPIP_MAC_BRIDGE_MAX_PORTS_NO];
 }TCPIP_MAC_BRIDGE_STAT;
 
+// *****************************************************************************
+/* MAC bridge boot times
+
+  Summary:
+    Structure describing the time stamps of the bridge boot stages
+
+  Description:
+    Data structure recorded by the bridge while it comes up
+    when TCPIP_MAC_BRIDGE_BOOT_TIMESTAMPS != 0 
+    All values are in microseconds, counted from the start of the core timer.
+    A value of 0 means that stage has not been reached yet.
+
+  Remarks:
+    The bridge forwards frames as soon as its ports are up,
+    without waiting for the whole TCP/IP stack initialization to complete.
+    The port related stages are checked with the bridge task rate
+    until the bridge becomes ready.
+*/
+typedef struct
+{
+    uint32_t    bridgeInit;         // bridge module initialized
+    uint32_t    portUp[TCPIP_MAC_BRIDGE_MAX_PORTS_NO];  // port interface up and its host entry installed
+    uint32_t    portRx[TCPIP_MAC_BRIDGE_MAX_PORTS_NO];  // first frame received on the port
+    uint32_t    firstFwd;           // first frame forwarded by the bridge
+    uint32_t    bridgeReady;        // all ports up, the bridge status is SYS_STATUS_READY
+    uint32_t    stackReady;         // TCP/IP stack initialization completed
+}TCPIP_MAC_BRIDGE_BOOT_TIMES;
+
+// *****************************************************************************
+/* MAC bridge learning limit violation policy
+
+  Summary:
+    Action taken when a port exceeds its learning limits
+
+  Description:
+    A port violates its limits when a new source address would exceed
+    the maximum number of addresses learnt on the port
+    or the rate of new addresses learnt on the port.
+
+  Remarks:
+    Used only when TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0
+    In all cases the address is not learnt,
+    the learnDenied statistics counter is updated
+    and a TCPIP_MAC_BRIDGE_EVENT_LEARN_DENIED event is reported.
+ */
+typedef enum
+{
+    TCPIP_MAC_BRIDGE_LEARN_POLICY_NOTIFY    = 0,    // the frame is forwarded as usual, without learning its source
+    TCPIP_MAC_BRIDGE_LEARN_POLICY_DROP,             // the frame with an unknown source address is dropped
+    TCPIP_MAC_BRIDGE_LEARN_POLICY_DISABLE,          // learning is disabled on the port for TCPIP_MAC_BRIDGE_LEARN_HOLD_TIME seconds
+                                                    // the frames are forwarded as usual
+}TCPIP_MAC_BRIDGE_LEARN_POLICY;
+
+// *****************************************************************************
+/* MAC bridge port learning limits
+
+  Summary:
+    Learning limits of a bridge port
+
+  Description:
+    Data structure used to set the learning limits of a bridge port
+
+  Remarks:
+    Used only when TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0
+    The defaults are the TCPIP_MAC_BRIDGE_LEARN_MAX_ENTRIES, TCPIP_MAC_BRIDGE_LEARN_RATE
+    and TCPIP_MAC_BRIDGE_LEARN_VIOLATION build symbols.
+ */
+typedef struct
+{
+    uint16_t    maxEntries;         // max number of dynamic entries learnt on the port; 0 - no limit
+    uint16_t    maxRate;            // max number of new addresses learnt on the port per second; 0 - no limit
+    uint8_t     policy;             // TCPIP_MAC_BRIDGE_LEARN_POLICY value
+}TCPIP_MAC_BRIDGE_LEARN_LIMIT;
+
+
+// *****************************************************************************
+/* MAC bridge port role
+
+  Summary:
+    RSTP role of a bridge port
+
+  Description:
+    The IEEE 802.1D-2004 port roles assigned by the RSTP role selection
+
+  Remarks:
+    Used only when TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0
+ */
+typedef enum
+{
+    TCPIP_MAC_BRIDGE_PORT_ROLE_DISABLED     = 0,    // port is down or its link is down
+    TCPIP_MAC_BRIDGE_PORT_ROLE_ROOT,                // best path towards the root bridge
+    TCPIP_MAC_BRIDGE_PORT_ROLE_DESIGNATED,          // this bridge is the designated bridge for the port LAN
+    TCPIP_MAC_BRIDGE_PORT_ROLE_ALTERNATE,           // alternate path to the root, blocked
+    TCPIP_MAC_BRIDGE_PORT_ROLE_BACKUP,              // backup path to a LAN this bridge is already designated for, blocked
+}TCPIP_MAC_BRIDGE_PORT_ROLE;
+
+// *****************************************************************************
+/* MAC bridge port state
+
+  Summary:
+    RSTP state of a bridge port
+
+  Description:
+    The IEEE 802.1D-2004 port states.
+    They gate the learning and the forwarding of the frames received on the port.
+
+  Remarks:
+    Used only when TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0
+
+    The host still processes the frames addressed to it
+    that are received on a discarding port.
+ */
+typedef enum
+{
+    TCPIP_MAC_BRIDGE_PORT_STATE_DISCARDING  = 0,    // no learning, no forwarding
+    TCPIP_MAC_BRIDGE_PORT_STATE_LEARNING,           // learning, no forwarding
+    TCPIP_MAC_BRIDGE_PORT_STATE_FORWARDING,         // learning and forwarding
+}TCPIP_MAC_BRIDGE_PORT_STATE;
+
+// *****************************************************************************
+/* MAC bridge RSTP port flags
+
+  Summary:
+    Flags describing the RSTP operation of a bridge port
+
+  Description:
+    Run time RSTP port flags reported by TCPIP_MAC_Bridge_RstpInfoGet
+
+  Remarks:
+    8 bit values only supported
+ */
+typedef enum
+{
+    TCPIP_MAC_BRIDGE_RSTP_PORT_FLAG_NONE        = 0x00,     // no flag set
+    TCPIP_MAC_BRIDGE_RSTP_PORT_FLAG_ENABLED     = 0x01,     // port participates in RSTP: the port is up and linked
+    TCPIP_MAC_BRIDGE_RSTP_PORT_FLAG_ADMIN_EDGE  = 0x02,     // port configured as an edge port
+    TCPIP_MAC_BRIDGE_RSTP_PORT_FLAG_OPER_EDGE   = 0x04,     // port operates as an edge port: no bridge detected on its LAN
+    TCPIP_MAC_BRIDGE_RSTP_PORT_FLAG_PROPOSING   = 0x08,     // designated port proposing to go forwarding
+    TCPIP_MAC_BRIDGE_RSTP_PORT_FLAG_AGREED      = 0x10,     // the designated port proposal was agreed by the neighbor bridge
+}TCPIP_MAC_BRIDGE_RSTP_PORT_FLAGS;
+
+// *****************************************************************************
+/* MAC bridge RSTP port configuration
+
+  Summary:
+    Run time RSTP configuration of a bridge port
+
+  Description:
+    Data structure used to change the RSTP parameters of a bridge port
+
+  Remarks:
+    None
+ */
+typedef struct
+{
+    uint32_t    pathCost;           // port path cost, 1 - 200000000
+                                    // if 0, the default build time value TCPIP_MAC_BRIDGE_RSTP_PORT_PATH_COST will be used
+    uint8_t     portPriority;       // port priority, 0 - 240, in steps of 16. Default is 128
+    uint8_t     adminEdge;          // if !0, the port is connected to end stations only
+                                    // and goes forwarding without waiting for the RSTP handshake
+}TCPIP_MAC_BRIDGE_RSTP_PORT_CONFIG;
+
+// *****************************************************************************
+/* MAC bridge RSTP port info
+
+  Summary:
+    Structure describing the RSTP status of a bridge port
+
+  Description:
+    Data structure reported by TCPIP_MAC_Bridge_RstpInfoGet
+    for each bridge port
+
+  Remarks:
+    The bridge IDs are in network order: 2 bytes priority followed by the MAC address
+ */
+typedef struct
+{
+    uint8_t     designatedId[8];    // ID of the designated bridge of the port LAN
+    uint32_t    pathCost;           // port path cost
+    uint32_t    rxBpdus;            // BPDUs received on the port
+    uint32_t    txBpdus;            // BPDUs transmitted on the port
+    uint32_t    tcCount;            // topology changes detected or received on the port
+    uint16_t    designatedPort;     // port ID of the designated port of the port LAN
+    uint16_t    portId;             // port identifier: priority and port number
+    uint8_t     role;               // a TCPIP_MAC_BRIDGE_PORT_ROLE value
+    uint8_t     state;              // a TCPIP_MAC_BRIDGE_PORT_STATE value
+    uint8_t     portFlags;          // a TCPIP_MAC_BRIDGE_RSTP_PORT_FLAGS value
+}TCPIP_MAC_BRIDGE_RSTP_PORT_INFO;
+
+// *****************************************************************************
+/* MAC bridge RSTP info
+
+  Summary:
+    Structure describing the RSTP status of the bridge
+
+  Description:
+    Data structure reported by TCPIP_MAC_Bridge_RstpInfoGet
+
+  Remarks:
+    The bridge IDs are in network order: 2 bytes priority followed by the MAC address
+*/
+typedef struct
+{
+    uint8_t     bridgeId[8];        // ID of this bridge
+    uint8_t     rootId[8];          // ID of the current root bridge
+    uint32_t    rootPathCost;       // path cost from this bridge to the root bridge
+    uint32_t    tcCount;            // number of topology changes
+    uint32_t    tcAge;              // seconds since the last topology change
+    int8_t      rootPort;           // the root port, < 0 if this bridge is the root bridge
+    uint8_t     nPorts;             // number of valid entries in portInfo
+    TCPIP_MAC_BRIDGE_RSTP_PORT_INFO portInfo[TCPIP_MAC_BRIDGE_MAX_PORTS_NO];
+}TCPIP_MAC_BRIDGE_RSTP_INFO;
+
 
 // *****************************************************************************
 /* MAC FDB entry flags
@@ -538,6 +962,8 @@ typedef enum
                                                 // otherwise it's a dynamic entry
     TCPIP_MAC_FDB_FLAG_HOST         = 0x02,     // entry is for one of the interfaces belonging to this host
     TCPIP_MAC_FDB_FLAG_PORT_VALID   = 0x04,     // the learnPort value is valid 
+    TCPIP_MAC_FDB_FLAG_PINNED       = 0x08,     // dynamic entry pinned to its learnPort after moving
+                                                // more than TCPIP_MAC_BRIDGE_MOVE_THRESHOLD times within TCPIP_MAC_BRIDGE_MOVE_WINDOW
 
 }TCPIP_MAC_FDB_FLAGS;
 
@@ -562,8 +988,19 @@ typedef struct
     TCPIP_MAC_ADDR      destAdd;        // MAC address the entry refers to
     uint8_t             flags;          // a TCPIP_MAC_FDB_FLAGS value
     uint8_t             learnPort;      // port number this address has been learned on
+    uint16_t            vlanId;         // VLAN ID this entry was learnt on
+                                        // 0 for static entries, valid for all VLANs, or if the bridge is not VLAN aware
+    uint16_t            moveCount;      // dynamic entry: number of times the address moved to another port
+                                        // 0 if the move dampening is not enabled
     uint32_t            tExpire;        // dynamic entry expiration time translated in system ticks
     uint32_t            fwdPackets;     // number of packets forwarded for this destination address
+    uint32_t            txBytes;        // bytes forwarded for this destination address
+    uint32_t            rxPackets;      // number of packets received from this source address
+    uint32_t            rxBytes;        // bytes received from this source address
+                                        // the byte counters exclude the Ethernet header
+                                        // fwdPackets and txBytes count only the frames transmitted directly,
+                                        // not the ones retried from a port TX backlog
+                                        // rxPackets and the byte counters are 0 if TCPIP_MAC_BRIDGE_ENTRY_COUNTERS is not enabled
     uint8_t             outPortMap[TCPIP_MAC_BRIDGE_MAX_PORTS_NO][TCPIP_MAC_BRIDGE_MAX_PORTS_NO];
                                         // the TCPIP_MAC_BRIDGE_CONTROL_TYPE type for a static entry
                                         // the outPotMap[k][j] describes the behavior (forward/discard/default) 
@@ -573,6 +1010,27 @@ typedef struct
 
 }TCPIP_MAC_FDB_ENTRY;
 
+// *****************************************************************************
+/* MAC bridge FDB top talkers sort key
+
+  Summary:
+    Counter used to rank the FDB entries
+
+  Description:
+    Selects the TCPIP_MAC_FDB_ENTRY counter that TCPIP_MAC_Bridge_FDBTopGet() sorts on
+
+  Remarks:
+    Used only when TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0
+*/
+typedef enum
+{
+    TCPIP_MAC_BRIDGE_TOP_KEY_BYTES      = 0,    // rxBytes + txBytes
+    TCPIP_MAC_BRIDGE_TOP_KEY_RX_BYTES,          // rxBytes
+    TCPIP_MAC_BRIDGE_TOP_KEY_TX_BYTES,          // txBytes
+    TCPIP_MAC_BRIDGE_TOP_KEY_RX_PACKETS,        // rxPackets
+    TCPIP_MAC_BRIDGE_TOP_KEY_TX_PACKETS,        // fwdPackets
+}TCPIP_MAC_BRIDGE_TOP_KEY;
+
 // *****************************************************************************
 /* MAC bridge dynamic operation
 
@@ -662,6 +1120,297 @@ TCPIP_MAC_BRIDGE_HANDLE     TCPIP_MAC_Bridge_Open(const SYS_MODULE_INDEX bridgeI
 SYS_STATUS TCPIP_MAC_Bridge_Status(TCPIP_MAC_BRIDGE_HANDLE brHandle);
 
 
+// *****************************************************************************
+/*
+  Function:
+    bool TCPIP_MAC_Bridge_BootTimesGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_BRIDGE_BOOT_TIMES* pTimes);
+
+  Summary:
+    Helper to get the bridge boot stages times
+   
+  Description:
+    The function returns the time stamps recorded by the bridge
+    for each of its boot stages
+   
+  Precondition:
+    TCPIP_MAC_BRIDGE properly initialized
+        
+
+  Parameters:
+    brHandle    - bridge handle obtained with TCPIP_MAC_Bridge_Open()
+
+    pTimes      - pointer to a structure to store the boot times
+
+  Returns:
+    - true if success
+    - false if failed or the boot time stamps are not enabled
+      
+  Remarks:
+    The time stamps are recorded only if TCPIP_MAC_BRIDGE_BOOT_TIMESTAMPS != 0.
+    Otherwise the function always returns false.
+
+    With TCPIP_STACK_STAGED_INIT the stack ready time stamp
+    is usually recorded after the bridge ready one.
+
+ */
+bool TCPIP_MAC_Bridge_BootTimesGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_BRIDGE_BOOT_TIMES* pTimes);
+
+// *****************************************************************************
+/*
+  Function:
+    TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_WarmSnapshot(TCPIP_MAC_BRIDGE_HANDLE brHandle);
+
+  Summary:
+    Saves the learnt FDB entries for a warm start
+   
+  Description:
+    The function copies the dynamic FDB entries to a checksummed persistent RAM area.
+    After a soft reset, the bridge initialization restores these entries
+    if the snapshot is valid and the bridge configuration did not change.
+   
+  Precondition:
+    TCPIP_MAC_BRIDGE properly initialized
+    Bridge warm start enabled (TCPIP_MAC_BRIDGE_WARM_START != 0) 
+        
+
+  Parameters:
+    brHandle    - bridge handle obtained with TCPIP_MAC_Bridge_Open()
+
+  Returns:
+    - TCPIP_MAC_BRIDGE_RES_OK if the snapshot was taken
+    - TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR an invalid handle was supplied
+    - TCPIP_MAC_BRIDGE_RES_LOCK_ERROR if the FDB kept changing while being copied
+      or the bridge task was taking its own snapshot; a retry is needed 
+    - TCPIP_MAC_BRIDGE_RES_PARAM_ERROR if the warm start is not enabled
+      
+  Remarks:
+    The bridge task takes a snapshot every TCPIP_MAC_BRIDGE_WARM_SNAPSHOT_RATE seconds anyway.
+    Calling this function right before an orderly software reset saves the latest FDB contents.
+
+    A restored entry expires after at most TCPIP_MAC_BRIDGE_WARM_RESTORE_TMO seconds
+    unless it is refreshed by the learning process.
+
+ */
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_WarmSnapshot(TCPIP_MAC_BRIDGE_HANDLE brHandle);
+
+// *****************************************************************************
+/*
+  Function:
+    bool TCPIP_MAC_Bridge_RstpInfoGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_BRIDGE_RSTP_INFO* pInfo);
+
+  Summary:
+    Helper to get the bridge RSTP status
+   
+  Description:
+    The function returns the spanning tree status of the bridge:
+    bridge and root IDs, root port and the role and state of each port
+   
+  Precondition:
+    TCPIP_MAC_BRIDGE properly initialized
+    Bridge RSTP enabled (TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0) 
+        
+
+  Parameters:
+    brHandle    - bridge handle obtained with TCPIP_MAC_Bridge_Open()
+    pInfo       - address to store the RSTP status
+
+  Returns:
+    - true if the call succeeded
+    - false if the call failed, invalid handle or RSTP not enabled
+      
+  Remarks:
+    The bridge ID is 0 until the first bridge port is up.
+
+ */
+bool TCPIP_MAC_Bridge_RstpInfoGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_BRIDGE_RSTP_INFO* pInfo);
+
+// *****************************************************************************
+/*
+  Function:
+    TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_RstpPortSet(TCPIP_MAC_BRIDGE_HANDLE brHandle, int portIx, const TCPIP_MAC_BRIDGE_RSTP_PORT_CONFIG* pPortCfg);
+
+  Summary:
+    Changes the RSTP parameters of a bridge port
+   
+  Description:
+    The function sets the priority, path cost and the edge setting of a bridge port.
+    The new parameters are applied and the port roles recomputed by the next bridge task run.
+   
+  Precondition:
+    TCPIP_MAC_BRIDGE properly initialized
+    Bridge RSTP enabled (TCPIP_MAC_BRIDGE_RSTP_SUPPORT != 0) 
+        
+
+  Parameters:
+    brHandle    - bridge handle obtained with TCPIP_MAC_Bridge_Open()
+    portIx      - bridge port number
+    pPortCfg    - the new port parameters
+
+  Returns:
+    - TCPIP_MAC_BRIDGE_RES_OK if the parameters were accepted
+    - TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR an invalid handle was supplied
+    - TCPIP_MAC_BRIDGE_RES_PARAM_ERROR if a parameter is invalid or RSTP is not enabled
+      
+  Remarks:
+    A port configured as edge still becomes a non-edge port
+    as soon as a BPDU is received on it.
+
+ */
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_RstpPortSet(TCPIP_MAC_BRIDGE_HANDLE brHandle, int portIx, const TCPIP_MAC_BRIDGE_RSTP_PORT_CONFIG* pPortCfg);
+
+// *****************************************************************************
+/*
+  Function:
+    TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_LearnLimitSet(TCPIP_MAC_BRIDGE_HANDLE brHandle, int portIx, const TCPIP_MAC_BRIDGE_LEARN_LIMIT* pLimit);
+
+  Summary:
+    Sets the learning limits of a bridge port
+   
+  Description:
+    The function sets the maximum number of addresses learnt on a port,
+    the new address learning rate and the violation policy.
+   
+  Precondition:
+    TCPIP_MAC_BRIDGE properly initialized
+    Bridge learning limits enabled (TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0) 
+        
+
+  Parameters:
+    brHandle    - bridge handle obtained with TCPIP_MAC_Bridge_Open()
+    portIx      - bridge port number
+    pLimit      - the new port limits
+
+  Returns:
+    - TCPIP_MAC_BRIDGE_RES_OK if the limits were changed
+    - TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR an invalid handle was supplied
+    - TCPIP_MAC_BRIDGE_RES_PARAM_ERROR if a parameter is invalid or the learning limits are not enabled
+      
+  Remarks:
+    The addresses already learnt are not removed when the limit is lowered,
+    they age out normally.
+    Setting the limits re-enables the learning on a port disabled by the
+    TCPIP_MAC_BRIDGE_LEARN_POLICY_DISABLE policy.
+
+ */
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_LearnLimitSet(TCPIP_MAC_BRIDGE_HANDLE brHandle, int portIx, const TCPIP_MAC_BRIDGE_LEARN_LIMIT* pLimit);
+
+// *****************************************************************************
+/*
+  Function:
+    TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_LearnLimitGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, int portIx, TCPIP_MAC_BRIDGE_LEARN_LIMIT* pLimit, size_t* pnLearnt);
+
+  Summary:
+    Returns the learning limits of a bridge port
+   
+  Description:
+    The function returns the learning limits of a port
+    and the number of addresses currently learnt on it.
+   
+  Precondition:
+    TCPIP_MAC_BRIDGE properly initialized
+    Bridge learning limits enabled (TCPIP_MAC_BRIDGE_LEARN_LIMITS != 0) 
+        
+
+  Parameters:
+    brHandle    - bridge handle obtained with TCPIP_MAC_Bridge_Open()
+    portIx      - bridge port number
+    pLimit      - address to store the port limits
+    pnLearnt    - address to store the number of learnt addresses; could be NULL
+
+  Returns:
+    - TCPIP_MAC_BRIDGE_RES_OK if the call succeeded
+    - TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR an invalid handle was supplied
+    - TCPIP_MAC_BRIDGE_RES_PARAM_ERROR if a parameter is invalid or the learning limits are not enabled
+      
+  Remarks:
+    The number of learnt addresses is recounted by the bridge task
+    and could be slightly larger than the actual value in between. 
+
+ */
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_LearnLimitGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, int portIx, TCPIP_MAC_BRIDGE_LEARN_LIMIT* pLimit, size_t* pnLearnt);
+
+// *****************************************************************************
+/*
+  Function:
+    TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_AclSet(TCPIP_MAC_BRIDGE_HANDLE brHandle, const TCPIP_MAC_BRIDGE_ACL_RULE* pRules, size_t nRules);
+
+  Summary:
+    Sets the bridge ingress ACL
+   
+  Description:
+    The function validates the rules and compiles them into a decision table
+    that replaces the current ACL of the bridge.
+    Each received frame is checked against the ACL before learning and forwarding.
+   
+  Precondition:
+    TCPIP_MAC_BRIDGE properly initialized
+    Bridge ACL enabled (TCPIP_MAC_BRIDGE_ACL != 0) 
+        
+
+  Parameters:
+    brHandle    - bridge handle obtained with TCPIP_MAC_Bridge_Open()
+    pRules      - array of rules, in priority order: rule 0 is checked first
+    nRules      - number of rules in pRules, <= TCPIP_MAC_BRIDGE_ACL_MAX_RULES
+                  0 removes the ACL
+
+  Returns:
+    - TCPIP_MAC_BRIDGE_RES_OK if the new ACL is in place
+    - TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR an invalid handle was supplied
+    - TCPIP_MAC_BRIDGE_RES_PARAM_ERROR if the ACL is not enabled
+    - TCPIP_MAC_BRIDGE_RES_ACL_ERROR if a rule is invalid, there are too many rules
+      or there is not enough memory for the compiled table
+    - TCPIP_MAC_BRIDGE_RES_LOCK_ERROR if the previous ACL is not released yet; retry
+      
+  Remarks:
+    The compiled table is allocated from the stack heap.
+    Its size grows linearly with the number of rules.
+
+    The rule hit counters are cleared.
+
+    The function should not be called concurrently from multiple threads.
+
+ */
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_AclSet(TCPIP_MAC_BRIDGE_HANDLE brHandle, const TCPIP_MAC_BRIDGE_ACL_RULE* pRules, size_t nRules);
+
+// *****************************************************************************
+/*
+  Function:
+    TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_AclGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_BRIDGE_ACL_RULE* pRules, uint32_t* pHits, size_t nRules, size_t* pnRules, bool clearHits);
+
+  Summary:
+    Returns the bridge ingress ACL rules and their hit counters
+   
+  Description:
+    The function copies the current ACL rules and
+    the number of frames each rule matched.
+   
+  Precondition:
+    TCPIP_MAC_BRIDGE properly initialized
+    Bridge ACL enabled (TCPIP_MAC_BRIDGE_ACL != 0) 
+        
+
+  Parameters:
+    brHandle    - bridge handle obtained with TCPIP_MAC_Bridge_Open()
+    pRules      - array to store the rules; could be NULL
+    pHits       - array to store the hit counters; could be NULL
+    nRules      - number of entries in pRules and pHits
+    pnRules     - address to store the number of rules in the ACL; could be NULL
+    clearHits   - if true, the hit counters are cleared after being read
+
+  Returns:
+    - TCPIP_MAC_BRIDGE_RES_OK if the call succeeded
+    - TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR an invalid handle was supplied
+    - TCPIP_MAC_BRIDGE_RES_PARAM_ERROR if the ACL is not enabled
+      
+  Remarks:
+    At most nRules rules are copied.
+
+    The hit counters are updated by the bridge without protection;
+    a counter cleared while a frame is matched could lose that hit.
+
+ */
+TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_AclGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_BRIDGE_ACL_RULE* pRules, uint32_t* pHits, size_t nRules, size_t* pnRules, bool clearHits);
+
 // *****************************************************************************
 /*
   Function:
@@ -784,7 +1533,12 @@ bool    TCPIP_MAC_Bridge_EventHandlerDeregister(TCPIP_MAC_BRIDGE_HANDLE brHandle
 
 
   Remarks:
-    None
+    The returned value is the index range for TCPIP_MAC_Bridge_FDBIndexRead().
+    It is fdbEntries + 1: the FDB hash always keeps one slot empty.
+
+    With TCPIP_MAC_BRIDGE_FDB_MAX_ENTRIES the FDB is resized as stations
+    come and go and the range changes accordingly.
+    While a resize is in progress the range covers both the old and the new table.
  */
 
 size_t    TCPIP_MAC_Bridge_FDBEntries(TCPIP_MAC_BRIDGE_HANDLE brHandle);
@@ -815,14 +1569,134 @@ size_t    TCPIP_MAC_Bridge_FDBEntries(TCPIP_MAC_BRIDGE_HANDLE brHandle);
     - TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR an invalid handle was supplied
     - TCPIP_MAC_BRIDGE_RES_INDEX_ERROR if the index is invalid
     - TCPIP_MAC_BRIDGE_RES_INDEX_NO_ENTRY if the entry with this index is not currently in use
+    - TCPIP_MAC_BRIDGE_RES_LOCK_ERROR if the entry kept changing while being read and a retry is needed 
     
 
   Remarks:
-    None
+    The function does not lock the FDB, so it does not interfere with the packet forwarding.
  */
 
 TCPIP_MAC_BRIDGE_RESULT    TCPIP_MAC_Bridge_FDBIndexRead(TCPIP_MAC_BRIDGE_HANDLE brHandle, size_t ix, TCPIP_MAC_FDB_ENTRY* pEntry);
 
+// *****************************************************************************
+/* Function:
+    TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBExport(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_FDB_ENTRY* pEntries, size_t nEntries, size_t* pnExported)
+
+  Summary:
+    Copies all the FDB entries in one call
+    
+  Description:
+    This function copies the contents of all the FDB entries that are in use
+    to the supplied array.
+    The copy is a consistent snapshot of the FDB at a moment in time.
+
+  Precondition:
+    The bridge module must be initialized.
+
+  Parameters:
+    brHandle    - bridge hadle obtained with TCPIP_MAC_Bridge_Open()
+    pEntries    - array to store the FDB entries
+    nEntries    - number of entries in the pEntries array
+                  TCPIP_MAC_Bridge_FDBEntries() entries are enough to store the whole FDB
+    pnExported  - address to store the number of entries copied to pEntries
+                  Could be NULL
+
+
+  Returns:
+    - TCPIP_MAC_BRIDGE_RES_OK if the bridge handle is valid and the operation is successful
+    - TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR an invalid handle was supplied
+    - TCPIP_MAC_BRIDGE_RES_PARAM_ERROR if pEntries is NULL or nEntries is 0
+    - TCPIP_MAC_BRIDGE_RES_LOCK_ERROR if the FDB kept changing while being read and a retry is needed 
+    
+
+  Remarks:
+    The function does not lock the FDB, so it does not interfere with the packet forwarding.
+    If the FDB is updated while copying, the copy is retried a few times.
+
+    If the pEntries array is too small, only the first nEntries used entries are copied.
+ */
+
+TCPIP_MAC_BRIDGE_RESULT    TCPIP_MAC_Bridge_FDBExport(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_FDB_ENTRY* pEntries, size_t nEntries, size_t* pnExported);
+
+// *****************************************************************************
+/* Function:
+    TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBTopGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_BRIDGE_TOP_KEY key, TCPIP_MAC_FDB_ENTRY* pEntries, size_t nEntries, size_t* pnFound)
+
+  Summary:
+    Returns the FDB entries with the most traffic
+    
+  Description:
+    This function copies to the supplied array the nEntries FDB entries
+    with the highest value of the counter selected by key,
+    sorted in descending order.
+    Entries with a 0 counter are not reported.
+
+  Precondition:
+    The bridge module must be initialized.
+    TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0
+
+  Parameters:
+    brHandle    - bridge hadle obtained with TCPIP_MAC_Bridge_Open()
+    key         - counter to sort on
+    pEntries    - array to store the top entries
+    nEntries    - number of entries in the pEntries array
+    pnFound     - address to store the number of entries copied to pEntries
+                  Could be NULL
+
+
+  Returns:
+    - TCPIP_MAC_BRIDGE_RES_OK if the bridge handle is valid and the operation is successful
+    - TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR an invalid handle was supplied
+    - TCPIP_MAC_BRIDGE_RES_PARAM_ERROR if a parameter is invalid or the entry counters are not enabled
+    - TCPIP_MAC_BRIDGE_RES_LOCK_ERROR if the FDB kept changing while being read and a retry is needed 
+    
+
+  Remarks:
+    The pEntries array is used as the sort buffer, no memory is allocated.
+    The cost is proportional to TCPIP_MAC_Bridge_FDBEntries() * nEntries,
+    so nEntries should be kept small.
+
+    Like TCPIP_MAC_Bridge_FDBExport(), the FDB is not locked.
+ */
+
+TCPIP_MAC_BRIDGE_RESULT    TCPIP_MAC_Bridge_FDBTopGet(TCPIP_MAC_BRIDGE_HANDLE brHandle, TCPIP_MAC_BRIDGE_TOP_KEY key, TCPIP_MAC_FDB_ENTRY* pEntries, size_t nEntries, size_t* pnFound);
+
+// *****************************************************************************
+/* Function:
+    TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBCountersReset(TCPIP_MAC_BRIDGE_HANDLE brHandle)
+
+  Summary:
+    Clears the traffic counters of all the FDB entries
+    
+  Description:
+    This function clears the fwdPackets, txBytes, rxPackets and rxBytes
+    counters of all the FDB entries.
+
+  Precondition:
+    The bridge module must be initialized.
+    TCPIP_MAC_BRIDGE_ENTRY_COUNTERS != 0
+
+  Parameters:
+    brHandle    - bridge hadle obtained with TCPIP_MAC_Bridge_Open()
+
+
+  Returns:
+    - TCPIP_MAC_BRIDGE_RES_OK if the bridge handle is valid and the operation is successful
+    - TCPIP_MAC_BRIDGE_RES_HANDLE_ERROR an invalid handle was supplied
+    - TCPIP_MAC_BRIDGE_RES_PARAM_ERROR if the entry counters are not enabled
+    
+
+  Remarks:
+    The counters of an entry are kept when the entry is refreshed or moves to another port.
+    They start from 0 only when the entry is (re)created or by calling this function.
+
+    The counters are cleared by the bridge task at its next run,
+    not when this function returns.
+    A packet processed before that is still counted.
+ */
+
+TCPIP_MAC_BRIDGE_RESULT    TCPIP_MAC_Bridge_FDBCountersReset(TCPIP_MAC_BRIDGE_HANDLE brHandle);
+
 // *****************************************************************************
 /* Function:
     TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBReset(TCPIP_MAC_BRIDGE_HANDLE brHandle);
@@ -866,6 +1740,7 @@ TCPIP_MAC_BRIDGE_RESULT TCPIP_MAC_Bridge_FDBReset(TCPIP_MAC_BRIDGE_HANDLE brHand
     
   Description:
     This function will delete the entry corresponding to the destination address from the bridge FDB
+    For a VLAN aware bridge, the entries learnt for this address on all VLANs are deleted.
 
   Precondition:
     The bridge module must be initialized.
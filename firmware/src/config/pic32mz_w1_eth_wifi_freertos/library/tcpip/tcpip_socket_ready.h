@@ -0,0 +1,373 @@
+/*******************************************************************************
+  TCP/IP socket readiness file
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    tcpip_socket_ready.h
+
+  Summary:
+    TCP/IP socket readiness notification API
+
+  Description:
+    This header file contains the function prototypes and definitions of the
+    TCP/IP socket readiness service.
+    An application task adds a group of TCP and UDP sockets to a ready set
+    and then blocks on that set until one or more sockets have data to read,
+    TX space available or a connection state change.
+    This replaces the loops that poll TCPIP_TCP_GetIsReady/TCPIP_UDP_GetIsReady
+    with a delay between iterations.
+*******************************************************************************/
+// DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+// DOM-IGNORE-END
+
+#ifndef __TCPIP_SOCKET_READY_H_
+#define __TCPIP_SOCKET_READY_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "osal/osal.h"
+// DOM-IGNORE-BEGIN
+#ifdef __cplusplus  // Provide C++ Compatibility
+
+    extern "C" {
+
+#endif
+// DOM-IGNORE-END
+
+// *****************************************************************************
+/* Socket readiness events
+
+  Summary:
+    Events reported for a socket in a ready set
+
+  Description:
+    These are the socket events that can be waited for.
+    They are obtained from the TCP/UDP socket signals.
+
+  Remarks:
+    8 bit values only.
+ */
+typedef enum
+{
+    TCPIP_SOCKET_READY_EV_NONE      = 0x00,
+    TCPIP_SOCKET_READY_EV_RX        = 0x01,     // data is available for reading
+                                                // or, for a listening TCP socket, a connection can be accepted
+                                                // TCP: TCPIP_TCP_SIGNAL_RX_DATA, TCPIP_TCP_SIGNAL_ACCEPT
+                                                // UDP: TCPIP_UDP_SIGNAL_RX_DATA
+    TCPIP_SOCKET_READY_EV_TX        = 0x02,     // space is available for writing
+                                                // TCP: TCPIP_TCP_SIGNAL_TX_SPACE
+                                                // UDP: TCPIP_UDP_SIGNAL_TX_DONE
+    TCPIP_SOCKET_READY_EV_STATE     = 0x04,     // the socket changed its connection state
+                                                // TCP: TCPIP_TCP_SIGNAL_ESTABLISHED, RX_FIN, RX_RST, TX_RST, KEEP_ALIVE_TMO
+                                                // TCP, UDP: interface down or interface address change
+    TCPIP_SOCKET_READY_EV_ALL       = 0x07,
+}TCPIP_SOCKET_READY_EVENT;
+
+// *****************************************************************************
+/* Socket type
+
+  Summary:
+    Type of a socket in a ready set
+
+  Description:
+    A ready set can contain both TCP and UDP sockets.
+
+  Remarks:
+    None.
+ */
+typedef enum
+{
+    TCPIP_SOCKET_READY_TYPE_TCP     = 1,    // TCP_SOCKET
+    TCPIP_SOCKET_READY_TYPE_UDP,            // UDP_SOCKET
+}TCPIP_SOCKET_READY_TYPE;
+
+struct _tag_TCPIP_SOCKET_READY_SET;
+
+// *****************************************************************************
+/* Ready set entry
+
+  Summary:
+    Storage for one socket in a ready set
+
+  Description:
+    The application supplies an array of these entries when creating a ready set.
+    One entry is used for each socket added to the set.
+
+  Remarks:
+    The members are maintained by the service and should not be changed by the application.
+ */
+typedef struct
+{
+    struct _tag_TCPIP_SOCKET_READY_SET* pSet;   // owner set
+    const void*         hSig;       // socket signal handle
+    int16_t             socket;     // TCP_SOCKET/UDP_SOCKET; < 0 for a free entry
+    uint8_t             type;       // TCPIP_SOCKET_READY_TYPE
+    uint8_t             interest;   // TCPIP_SOCKET_READY_EVENT: events to report
+    volatile uint8_t    pending;    // TCPIP_SOCKET_READY_EVENT: events not reported yet
+    uint8_t             reserved[3];// not used
+}TCPIP_SOCKET_READY_ENTRY;
+
+// *****************************************************************************
+/* Ready set notification function
+
+  Summary:
+    Optional function called when a set gets a new pending event
+
+  Description:
+    This function is called, in addition to releasing a waiting task,
+    when a socket in the set gets a pending event and there was none before.
+    It allows the application to merge the socket readiness with other
+    events it is waiting for, for example by setting a bit in an RTOS event group.
+    The application then calls TCPIP_SOCKET_ReadyWait() with a 0 timeout.
+
+  Remarks:
+    The function is called from the TCP/IP stack context.
+    It has to be short and must not block.
+ */
+typedef void    (*TCPIP_SOCKET_READY_NOTIFY)(struct _tag_TCPIP_SOCKET_READY_SET* pSet, const void* param);
+
+// *****************************************************************************
+/* Ready set
+
+  Summary:
+    A group of sockets waited for by an application task
+
+  Description:
+    The application allocates this object and passes it to TCPIP_SOCKET_ReadySetCreate().
+
+  Remarks:
+    The members are maintained by the service and should not be changed by the application.
+ */
+typedef struct _tag_TCPIP_SOCKET_READY_SET
+{
+    TCPIP_SOCKET_READY_ENTRY*   pEntries;       // entries supplied at creation
+    uint16_t                    nEntries;       // number of entries
+    uint16_t                    scanIx;         // entry where the next scan starts
+    OSAL_SEM_HANDLE_TYPE        readySem;       // released when an event becomes pending
+    TCPIP_SOCKET_READY_NOTIFY   notifyF;        // optional notification function
+    const void*                 notifyParam;    // notification function parameter
+}TCPIP_SOCKET_READY_SET;
+
+// *****************************************************************************
+/* Ready socket result
+
+  Summary:
+    A ready socket reported by TCPIP_SOCKET_ReadyWait()
+
+  Description:
+    Describes a socket and the events that occurred since the previous report.
+
+  Remarks:
+    None.
+ */
+typedef struct
+{
+    int16_t     socket;     // TCP_SOCKET/UDP_SOCKET
+    uint8_t     type;       // TCPIP_SOCKET_READY_TYPE
+    uint8_t     events;     // TCPIP_SOCKET_READY_EVENT
+}TCPIP_SOCKET_READY_RESULT;
+
+
+// *****************************************************************************
+/*
+  Function:
+    bool TCPIP_SOCKET_ReadySetCreate(TCPIP_SOCKET_READY_SET* pSet, TCPIP_SOCKET_READY_ENTRY* pEntries, int nEntries,
+                                     TCPIP_SOCKET_READY_NOTIFY notifyF, const void* notifyParam);
+
+  Summary:
+    Creates a socket ready set.
+
+  Description:
+    This function initializes a ready set that can hold up to nEntries sockets.
+
+  Precondition:
+    None.
+
+  Parameters:
+    pSet        - set to initialize
+    pEntries    - storage for the set entries
+    nEntries    - number of entries in pEntries
+    notifyF     - optional notification function; could be 0
+    notifyParam - parameter passed to notifyF
+
+  Returns:
+    - true  - the set was created
+    - false - invalid parameters or the set semaphore could not be created
+
+  Remarks:
+    The set and entries storage has to remain valid until TCPIP_SOCKET_ReadySetDelete() is called.
+*/
+bool    TCPIP_SOCKET_ReadySetCreate(TCPIP_SOCKET_READY_SET* pSet, TCPIP_SOCKET_READY_ENTRY* pEntries, int nEntries,
+                                    TCPIP_SOCKET_READY_NOTIFY notifyF, const void* notifyParam);
+
+// *****************************************************************************
+/*
+  Function:
+    void TCPIP_SOCKET_ReadySetDelete(TCPIP_SOCKET_READY_SET* pSet);
+
+  Summary:
+    Deletes a socket ready set.
+
+  Description:
+    This function removes all the sockets from the set and releases the set resources.
+
+  Precondition:
+    The set should have been created with TCPIP_SOCKET_ReadySetCreate().
+
+  Parameters:
+    pSet    - set to delete
+
+  Returns:
+    None.
+
+  Remarks:
+    No task should be waiting on the set.
+*/
+void    TCPIP_SOCKET_ReadySetDelete(TCPIP_SOCKET_READY_SET* pSet);
+
+// *****************************************************************************
+/*
+  Function:
+    bool TCPIP_SOCKET_ReadyAdd(TCPIP_SOCKET_READY_SET* pSet, TCPIP_SOCKET_READY_TYPE type, int16_t socket, TCPIP_SOCKET_READY_EVENT events);
+
+  Summary:
+    Adds a socket to a ready set.
+
+  Description:
+    This function adds a TCP or UDP socket to the set.
+    The socket signal handler is used to report the socket events to the set.
+    Data already available for reading and TX space already available
+    are reported right away.
+
+  Precondition:
+    The set should have been created with TCPIP_SOCKET_ReadySetCreate().
+    Valid TCP or UDP socket.
+
+  Parameters:
+    pSet    - set to add to
+    type    - socket type
+    socket  - TCP_SOCKET or UDP_SOCKET
+    events  - events to report for this socket
+
+  Returns:
+    - true  - the socket was added
+    - false - invalid parameters, no free entry in the set,
+              or the socket already has a signal handler registered
+
+  Remarks:
+    A socket uses its only signal handler slot while it is part of a set.
+    It cannot be part of more than one set.
+
+    The events are edge triggered: an event is reported once,
+    when it occurs. The application should read all the available data
+    before waiting again.
+
+    A server socket should be added right after it is opened
+    so that the TCPIP_SOCKET_READY_EV_STATE event for the new connection is not missed.
+
+    The socket should be removed from the set before it is closed.
+*/
+bool    TCPIP_SOCKET_ReadyAdd(TCPIP_SOCKET_READY_SET* pSet, TCPIP_SOCKET_READY_TYPE type, int16_t socket, TCPIP_SOCKET_READY_EVENT events);
+
+// *****************************************************************************
+/*
+  Function:
+    bool TCPIP_SOCKET_ReadyRemove(TCPIP_SOCKET_READY_SET* pSet, TCPIP_SOCKET_READY_TYPE type, int16_t socket);
+
+  Summary:
+    Removes a socket from a ready set.
+
+  Description:
+    This function removes the socket from the set and deregisters its signal handler.
+    Pending events for the socket are discarded.
+
+  Precondition:
+    The set should have been created with TCPIP_SOCKET_ReadySetCreate().
+
+  Parameters:
+    pSet    - set to remove from
+    type    - socket type
+    socket  - TCP_SOCKET or UDP_SOCKET
+
+  Returns:
+    - true  - the socket was removed
+    - false - the socket is not part of the set
+
+  Remarks:
+    None.
+*/
+bool    TCPIP_SOCKET_ReadyRemove(TCPIP_SOCKET_READY_SET* pSet, TCPIP_SOCKET_READY_TYPE type, int16_t socket);
+
+// *****************************************************************************
+/*
+  Function:
+    int TCPIP_SOCKET_ReadyWait(TCPIP_SOCKET_READY_SET* pSet, TCPIP_SOCKET_READY_RESULT* pResults, int nResults, uint16_t waitMs);
+
+  Summary:
+    Waits for events on the sockets in a ready set.
+
+  Description:
+    This function blocks the calling task until at least one socket in the set
+    has pending events or the timeout expires.
+    It returns the ready sockets and clears their pending events.
+
+  Precondition:
+    The set should have been created with TCPIP_SOCKET_ReadySetCreate().
+
+  Parameters:
+    pSet        - set to wait on
+    pResults    - array to store the ready sockets
+    nResults    - size of the pResults array
+    waitMs      - maximum time to wait, ms
+                  0 - do not block, just report the pending events
+                  OSAL_WAIT_FOREVER - wait until an event occurs
+
+  Returns:
+    - > 0   - number of ready sockets stored in pResults
+    - 0     - timeout, no socket is ready
+    - < 0   - invalid parameters
+
+  Remarks:
+    Only one task should wait on a set at a time.
+
+    When more sockets are ready than fit in pResults, the remaining ones
+    stay pending and are reported by the next call.
+    The scan starts after the last reported socket, so all the sockets
+    get reported even when pResults is small.
+*/
+int     TCPIP_SOCKET_ReadyWait(TCPIP_SOCKET_READY_SET* pSet, TCPIP_SOCKET_READY_RESULT* pResults, int nResults, uint16_t waitMs);
+
+//DOM-IGNORE-BEGIN
+#ifdef __cplusplus
+}
+#endif
+//DOM-IGNORE-END
+
+#endif //  __TCPIP_SOCKET_READY_H_
@@ -554,6 +554,31 @@ typedef const void* TCPIP_UDP_PROCESS_HANDLE;
 typedef bool(*TCPIP_UDP_PACKET_HANDLER)(TCPIP_NET_HANDLE hNet, struct _tag_TCPIP_MAC_PACKET* rxPkt, const void* hParam);
 
 
+// *****************************************************************************
+/*
+  Structure:
+    TCPIP_UDP_DATAGRAM
+
+  Summary:
+    Describes a datagram to be sent with TCPIP_UDP_DatagramsSend.
+
+  Description:
+    A datagram is either a packet obtained with TCPIP_UDP_DatagramAlloc
+    and already filled in place by the caller (zero copy)
+    or a caller buffer that is copied into a newly allocated packet.
+
+  Remarks:
+    If pPkt != 0, the datagram data is already in the packet
+    and pData is not used.
+*/
+typedef struct
+{
+    struct _tag_TCPIP_MAC_PACKET*   pPkt;       // packet returned by TCPIP_UDP_DatagramAlloc or 0
+    const uint8_t*                  pData;      // datagram data to be copied if pPkt == 0
+    uint16_t                        dataLen;    // datagram payload size, bytes
+}TCPIP_UDP_DATAGRAM;
+
+
 // *****************************************************************************
 /*
   Structure:
@@ -1337,6 +1362,131 @@ uint16_t            TCPIP_UDP_Flush(UDP_SOCKET hUDP);
 
 // *****************************************************************************
 
+/*
+  Function:
+    struct _tag_TCPIP_MAC_PACKET* TCPIP_UDP_DatagramAlloc(UDP_SOCKET hUDP, uint16_t loadSize, uint8_t** pLoad)
+
+  Summary:
+    Allocates a packet to be filled in place and sent with TCPIP_UDP_DatagramsSend.
+    
+  Description:
+    This function allocates a TX packet for the socket,
+    with room for the network headers and for loadSize bytes of UDP payload.
+    The caller writes the datagram data directly in the packet
+    and then passes it to TCPIP_UDP_DatagramsSend.
+    The socket TX buffer is not used.
+
+  Precondition:
+    UDP socket should have been opened with TCPIP_UDP_ServerOpen/TCPIP_UDP_ClientOpen.
+    hUDP - valid IPv4 socket
+
+  Parameters:
+    hUDP     - UDP socket handle
+    loadSize - maximum size of the UDP payload
+    pLoad    - address to store a pointer to the UDP payload area of the packet
+    
+  Returns:
+    A valid packet pointer if the call succeeded.
+    0 if the socket is invalid, not IPv4, out of memory
+    or the socket TX queue limit (UDP_OPTION_TX_QUEUE_LIMIT) has been reached.
+
+  Remarks:
+    The packet counts against the socket TX queue limit
+    until it is transmitted or released with TCPIP_UDP_DatagramFree.
+
+    Available only when TCPIP_UDP_BATCH_SEND is enabled.
+
+  */
+struct _tag_TCPIP_MAC_PACKET* TCPIP_UDP_DatagramAlloc(UDP_SOCKET hUDP, uint16_t loadSize, uint8_t** pLoad);
+
+// *****************************************************************************
+
+/*
+  Function:
+    void TCPIP_UDP_DatagramFree(UDP_SOCKET hUDP, struct _tag_TCPIP_MAC_PACKET* pPkt)
+
+  Summary:
+    Releases a packet obtained with TCPIP_UDP_DatagramAlloc.
+    
+  Description:
+    This function releases a packet that was allocated
+    with TCPIP_UDP_DatagramAlloc but that was not transmitted.
+
+  Precondition:
+    pPkt - packet allocated with TCPIP_UDP_DatagramAlloc for this socket
+
+  Parameters:
+    hUDP   - UDP socket handle
+    pPkt   - packet to be released
+    
+  Returns:
+    None
+
+  Remarks:
+    Packets transmitted by TCPIP_UDP_DatagramsSend are released
+    by the stack and must not be freed by the caller.
+
+    Available only when TCPIP_UDP_BATCH_SEND is enabled.
+
+  */
+void            TCPIP_UDP_DatagramFree(UDP_SOCKET hUDP, struct _tag_TCPIP_MAC_PACKET* pPkt);
+
+// *****************************************************************************
+
+/*
+  Function:
+    uint16_t TCPIP_UDP_DatagramsSend(UDP_SOCKET hUDP, TCPIP_UDP_DATAGRAM* dgArray, uint16_t nDgrams)
+
+  Summary:
+    Transmits a batch of datagrams in one call.
+    
+  Description:
+    This function sends nDgrams datagrams to the socket remote destination.
+    The route and the destination MAC address are solved once for the whole batch,
+    the UDP/IPv4 headers are built in place in each packet
+    and the packets are passed to the MAC driver as a single chain.
+
+    Datagrams with dgArray[i].pPkt != 0 are sent without any copy.
+    Datagrams with dgArray[i].pPkt == 0 have their data copied
+    into a packet sized for that datagram.
+
+    If the batch cannot be sent as a chain (the destination address is not resolved yet,
+    the destination is local, etc.) the datagrams are sent one by one.
+
+  Precondition:
+    UDP socket should have been opened with TCPIP_UDP_ServerOpen/TCPIP_UDP_ClientOpen.
+    hUDP - valid IPv4 socket
+
+  Parameters:
+    hUDP    - UDP socket handle
+    dgArray - array of datagrams to send
+    nDgrams - number of datagrams in the array
+    
+  Returns:
+    The number of datagrams, from the start of dgArray, that have been transmitted.
+    0 if nothing could be sent:
+    - invalid or non IPv4 socket
+    - invalid remote address
+    - no route to the remote host could be found
+
+  Remarks:
+    The transmitted packets belong to the stack and are released once sent.
+    A packet that was not transmitted (index >= the returned value)
+    still belongs to the caller: it can be passed again to TCPIP_UDP_DatagramsSend
+    or released with TCPIP_UDP_DatagramFree.
+
+    Copied datagrams count against the socket TX queue limit (UDP_OPTION_TX_QUEUE_LIMIT)
+    while in flight; the limit should be set to accommodate the batch size.
+
+    The socket TX buffer and any data pending in it are not affected.
+
+    Available only when TCPIP_UDP_BATCH_SEND is enabled.
+
+  */
+uint16_t        TCPIP_UDP_DatagramsSend(UDP_SOCKET hUDP, TCPIP_UDP_DATAGRAM* dgArray, uint16_t nDgrams);
+
+// *****************************************************************************
+
 /*
   Function:
     uint16_t TCPIP_UDP_Put(UDP_SOCKET hUDP, uint8_t v)
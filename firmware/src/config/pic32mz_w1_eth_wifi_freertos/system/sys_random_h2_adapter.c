@@ -27,6 +27,33 @@ Microchip or any third party.
 #include "crypto/crypto.h"
 #include "osal/osal.h"
 
+#include <string.h>
+
+// buffered random pools
+#if defined(SYS_RANDOM_POOL_SIZE) && (SYS_RANDOM_POOL_SIZE != 0)
+#define _SYS_RANDOM_POOL    1
+#else
+#define _SYS_RANDOM_POOL    0
+#endif
+
+#if !defined(SYS_RANDOM_FAST_RESEED_COUNT) || (SYS_RANDOM_FAST_RESEED_COUNT == 0)
+#undef SYS_RANDOM_FAST_RESEED_COUNT
+#define SYS_RANDOM_FAST_RESEED_COUNT    65536
+#endif
+
+#if (_SYS_RANDOM_POOL != 0)
+typedef struct
+{
+    uint8_t     data[SYS_RANDOM_POOL_SIZE];
+    uint16_t    nBytes;         // available bytes, at the end of data
+}SYS_RANDOM_POOL_DCPT;
+
+static SYS_RANDOM_POOL_DCPT randPools[SYS_RANDOM_POOLS];
+static uint32_t randPoolFills;  // pool fills since the DRBG was seeded; protected by randSemaphore
+#endif  // (_SYS_RANDOM_POOL != 0)
+
+static uint32_t randFastState[4];   // xoshiro128** state
+static uint32_t randFastCount;      // values left until the next reseed; 0: needs seeding
 
 static CRYPT_RNG_CTX sysRandCtx;
 static CRYPT_RNG_CTX* pRandCtx = 0;
@@ -153,6 +180,12 @@ void SYS_RANDOM_CryptoDeinitialize( SYS_MODULE_OBJ object )
 
     if(doDeinit)
     {
+#if (_SYS_RANDOM_POOL != 0)
+        memset(randPools, 0, sizeof(randPools));
+        randPoolFills = 0;
+#endif  // (_SYS_RANDOM_POOL != 0)
+        memset(randFastState, 0, sizeof(randFastState));
+        randFastCount = 0;
         // CRYPT_RNG_Deinitialize(pRandCtx);
         OSAL_SEM_Delete(&randSemaphore);
         pRandCtx = 0;
@@ -234,4 +267,153 @@ uint8_t SYS_RANDOM_CryptoByteGet( void )
     return rNo;
 }
 
+#if (_SYS_RANDOM_POOL != 0)
+// refills a pool from the DRBG
+// the DRBG runs under the semaphore; only the pool update is in the critical section
+static bool _SYS_RANDOM_PoolFill(SYS_RANDOM_POOL_DCPT* pPool)
+{
+    uint8_t fillBuff[SYS_RANDOM_POOL_SIZE];
+    volatile uint8_t* pErase;
+    size_t ix;
+    bool fillRes = false;
+
+    CRYPT_RNG_CTX* pCtx = _SYS_RANDOM_CryptoLock();
+    if(pCtx)
+    {
+#if defined(SYS_RANDOM_POOL_RESEED_FILLS) && (SYS_RANDOM_POOL_RESEED_FILLS != 0)
+        if(randPoolFills >= SYS_RANDOM_POOL_RESEED_FILLS)
+        {   // reinstantiate the DRBG with a new seed from the entropy source
+            (void)CRYPT_RNG_Deinitialize(pCtx);
+            if(CRYPT_RNG_Initialize(pCtx) >= 0)
+            {
+                randPoolFills = 0;
+            }
+        }
+#endif  // defined(SYS_RANDOM_POOL_RESEED_FILLS) && (SYS_RANDOM_POOL_RESEED_FILLS != 0)
+
+        if(CRYPT_RNG_BlockGenerate(pCtx, fillBuff, sizeof(fillBuff)) >= 0)
+        {
+            randPoolFills++;
+            fillRes = true;
+        }
+        _SYS_RANDOM_CryptoUnlock();
+    }
+
+    if(fillRes)
+    {
+        OSAL_CRITSECT_DATA_TYPE status = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+        memcpy(pPool->data, fillBuff, sizeof(fillBuff));
+        pPool->nBytes = sizeof(fillBuff);
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, status);
+    }
+
+    // don't leave a copy on the stack
+    pErase = fillBuff;
+    for(ix = 0; ix < sizeof(fillBuff); ix++)
+    {
+        *pErase++ = 0;
+    }
+
+    return fillRes;
+}
+#endif  // (_SYS_RANDOM_POOL != 0)
+
+size_t SYS_RANDOM_PoolBlockGet( SYS_RANDOM_POOL pool, void *buffer, size_t size )
+{
+#if (_SYS_RANDOM_POOL != 0)
+    SYS_RANDOM_POOL_DCPT* pPool;
+    uint8_t* pSrc;
+
+    if(buffer == 0 || size == 0 || (unsigned int)pool >= (unsigned int)SYS_RANDOM_POOLS)
+    {
+        return 0;
+    }
+
+    if(size > SYS_RANDOM_POOL_SIZE / 2)
+    {   // large requests don't gain anything from the pool
+        return SYS_RANDOM_CryptoBlockGet(buffer, size);
+    }
+
+    pPool = randPools + pool;
+    while(true)
+    {
+        OSAL_CRITSECT_DATA_TYPE status = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+        if(pPool->nBytes >= size)
+        {
+            pSrc = pPool->data + SYS_RANDOM_POOL_SIZE - pPool->nBytes;
+            memcpy(buffer, pSrc, size);
+            memset(pSrc, 0, size);
+            pPool->nBytes -= size;
+            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, status);
+            return size;
+        }
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, status);
+
+        // the few bytes left, if any, are dropped
+        if(!_SYS_RANDOM_PoolFill(pPool))
+        {
+            return 0;
+        }
+    }
+#else
+    if((unsigned int)pool >= (unsigned int)SYS_RANDOM_POOLS)
+    {
+        return 0;
+    }
+    return SYS_RANDOM_CryptoBlockGet(buffer, size);
+#endif  // (_SYS_RANDOM_POOL != 0)
+}
+
+uint32_t SYS_RANDOM_PoolGet( SYS_RANDOM_POOL pool )
+{
+    uint32_t rNo = 0;
+
+    (void)SYS_RANDOM_PoolBlockGet(pool, &rNo, sizeof(rNo));
+
+    return rNo;
+}
+
+static __inline__ uint32_t __attribute__((always_inline)) _SYS_RANDOM_Rotl(uint32_t x, int k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+uint32_t SYS_RANDOM_FastGet( void )
+{
+    uint32_t seed[4];
+    uint32_t rNo, t;
+
+    if(randFastCount == 0)
+    {   // (re)seed from the DRBG
+        if(SYS_RANDOM_CryptoBlockGet(seed, sizeof(seed)) == sizeof(seed) && (seed[0] | seed[1] | seed[2] | seed[3]) != 0)
+        {
+            OSAL_CRITSECT_DATA_TYPE status = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+            memcpy(randFastState, seed, sizeof(randFastState));
+            randFastCount = SYS_RANDOM_FAST_RESEED_COUNT;
+            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, status);
+        }
+    }
+
+    OSAL_CRITSECT_DATA_TYPE status = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+    if((randFastState[0] | randFastState[1] | randFastState[2] | randFastState[3]) == 0)
+    {   // the DRBG failed; the all zero state is not valid
+        randFastState[0] = 1;
+    }
+
+    rNo = _SYS_RANDOM_Rotl(randFastState[1] * 5, 7) * 9;
+    t = randFastState[1] << 9;
+    randFastState[2] ^= randFastState[0];
+    randFastState[3] ^= randFastState[1];
+    randFastState[1] ^= randFastState[2];
+    randFastState[0] ^= randFastState[3];
+    randFastState[2] ^= t;
+    randFastState[3] = _SYS_RANDOM_Rotl(randFastState[3], 11);
+    if(randFastCount != 0)
+    {
+        randFastCount--;
+    }
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, status);
+
+    return rNo;
+}
 
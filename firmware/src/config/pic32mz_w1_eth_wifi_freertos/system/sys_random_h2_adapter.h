@@ -79,6 +79,30 @@ Microchip or any third party.
     interface and should be considered part it.
 */
 
+// *****************************************************************************
+/* Random Pool
+
+  Summary:
+    Class of the consumers served by a buffered random pool.
+
+  Description:
+    Each class has its own pool, filled in bulk from the cryptographic
+    Random Number Generator. The values handed to one class are never
+    handed to another.
+
+  Remarks:
+    Key material and nonces should use the SYS_RANDOM_Crypto functions.
+*/
+
+typedef enum
+{
+    SYS_RANDOM_POOL_NET_ID,         // values sent on the wire: ephemeral ports, DNS/DHCP transaction IDs
+    SYS_RANDOM_POOL_NET_SECRET,     // networking secrets that are never sent: TCP sequence number keys
+
+    /* number of pools; not a valid pool */
+    SYS_RANDOM_POOLS
+}SYS_RANDOM_POOL;
+
 static __inline__ void __attribute__((always_inline)) SYS_RANDOM_PseudoSeedSet( uint32_t seed )
 {
     srand(seed);
@@ -233,6 +257,102 @@ size_t SYS_RANDOM_CryptoBlockGet( void *buffer, size_t size );
 
 uint8_t SYS_RANDOM_CryptoByteGet( void );
 
+// *****************************************************************************
+/* Function:
+    size_t SYS_RANDOM_PoolBlockGet( SYS_RANDOM_POOL pool, void *buffer, size_t size );
+
+  Summary:
+    Gets a block of random bytes from a buffered random pool.
+
+  Description:
+    This function copies random bytes from the pool of the consumer class.
+    The pool is refilled with SYS_RANDOM_POOL_SIZE bytes from the
+    cryptographic Random Number Generator when it runs out.
+    The bytes are erased from the pool once handed out.
+
+  Precondition:
+    None
+
+  Parameters:
+    pool   - consumer class
+    buffer - Pointer to the memory location to fill with random data.
+    size   - The amount of random data, in bytes, to put in memory.
+
+  Returns:
+    size of the generated block.
+    0 if error.
+
+  Remarks:
+    Small requests are served within a short critical section.
+    Requests larger than SYS_RANDOM_POOL_SIZE / 2 go directly to the
+    cryptographic Random Number Generator.
+
+    The Random Number Generator is reinstantiated with a new seed from
+    its entropy source every SYS_RANDOM_POOL_RESEED_FILLS pool fills.
+
+    If SYS_RANDOM_POOL_SIZE == 0, all requests go directly to the
+    cryptographic Random Number Generator.
+*/
+
+size_t SYS_RANDOM_PoolBlockGet( SYS_RANDOM_POOL pool, void *buffer, size_t size );
+
+// *****************************************************************************
+/* Function:
+    uint32_t SYS_RANDOM_PoolGet( SYS_RANDOM_POOL pool );
+
+  Summary:
+    Returns a random 32 bit value from a buffered random pool.
+
+  Description:
+    This function returns a 32-bit random number from the pool
+    of the consumer class.
+
+  Precondition:
+    None
+
+  Parameters:
+    pool   - consumer class
+
+  Returns:
+    32-bit random number.
+    0 if error.
+
+  Remarks:
+    See SYS_RANDOM_PoolBlockGet.
+*/
+
+uint32_t SYS_RANDOM_PoolGet( SYS_RANDOM_POOL pool );
+
+// *****************************************************************************
+/* Function:
+    uint32_t SYS_RANDOM_FastGet( void );
+
+  Summary:
+    Returns a random 32 bit value from a fast pseudo-random generator.
+
+  Description:
+    This function returns a 32-bit number from a xoshiro128** generator
+    seeded from the cryptographic Random Number Generator.
+
+  Precondition:
+    None
+
+  Parameters:
+    None.
+
+  Returns:
+    32-bit pseudo-random number.
+
+  Remarks:
+    The generator is reseeded every SYS_RANDOM_FAST_RESEED_COUNT values.
+
+    The output is not cryptographically secure: the generator state can be
+    recovered from a few outputs. Use it for values that need to be well
+    distributed but not unpredictable: timer jitter, hash seeds, test data.
+*/
+
+uint32_t SYS_RANDOM_FastGet( void );
+
 
 
 
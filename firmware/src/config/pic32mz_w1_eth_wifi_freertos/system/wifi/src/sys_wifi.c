@@ -76,6 +76,13 @@ typedef struct
 
 /* Wi-Fi STA Mode, maximum auto connect retry */
 #define MAX_AUTO_CONNECT_RETRY                5
+
+/* Wi-Fi service task re-run period, in ms, for states waiting 
+   on a condition that does not generate an event */
+#define SYS_WIFI_TASK_POLL_PERIOD             10
+
+/* Wi-Fi AP Mode, connected STA DHCP lease check period, in ms */
+#define SYS_WIFI_STA_IP_CHECK_PERIOD          500
 typedef struct 
 {
     /* Assoc Handle associated with the station */
@@ -83,6 +90,9 @@ typedef struct
     
     /* STA connection info update to App */
     bool wifiSrvcSTAConnUpdate;
+
+    /* STA DHCP lease check is due */
+    bool wifiSrvcSTAIPCheck;
     
     /* Station Info shared with the App */
     SYS_WIFI_STA_APP_INFO wifiSrvcStaAppInfo;
@@ -135,6 +145,21 @@ bool      g_isRegDomainSetReq = false;
 
 /* Semaphore for Critical Section */
 static    OSAL_SEM_HANDLE_TYPE  g_wifiSrvcSemaphore;
+
+/* Semaphore signalling the Wi-Fi service task that an event occurred */
+static    OSAL_SEM_HANDLE_TYPE  g_wifiSrvcEventSemaphore;
+
+/* Event semaphore is created once and kept across de-initialization */
+static    bool                  g_wifiSrvcEventSemCreated = false;
+
+/* Wi-Fi service task wait time for the next event, in ms */
+static    uint16_t              g_wifiSrvcEventWait = 0;
+
+/* Wi-Fi STA Mode, connection request is directed to the last known BSS */
+static    bool                  g_wifiSrvcLastBssAttempt = false;
+
+/* Wi-Fi STA Mode, directed connection failed, next request does a full scan */
+static    bool                  g_wifiSrvcLastBssFailed = false;
 // *****************************************************************************
 
 // *****************************************************************************
@@ -162,6 +187,7 @@ static void SYS_WIFI_InitStaConnInfo(void)
     {
         g_wifiSrvcStaConnInfo[idx].wifiSrvcAssocHandle = WDRV_PIC32MZW_ASSOC_HANDLE_INVALID;
         g_wifiSrvcStaConnInfo[idx].wifiSrvcSTAConnUpdate = false;
+        g_wifiSrvcStaConnInfo[idx].wifiSrvcSTAIPCheck = false;
         memset(&g_wifiSrvcStaConnInfo[idx].wifiSrvcStaAppInfo,0,sizeof(SYS_WIFI_STA_APP_INFO));
     }
 }
@@ -386,12 +412,22 @@ static inline bool SYS_WIFI_GetAutoConnect(void)
 
 }
 
+static inline void SYS_WIFI_SignalTask(void)
+{
+    /* Wake up the Wi-Fi service task, a pending signal is not lost */
+    if (true == g_wifiSrvcEventSemCreated)
+    {
+        OSAL_SEM_Post(&g_wifiSrvcEventSemaphore);
+    }
+}
+
 static inline void SYS_WIFI_SetTaskstatus
 (
     SYS_WIFI_STATUS status
 )
 {
     g_wifiSrvcObj.wifiSrvcStatus = status;
+    SYS_WIFI_SignalTask();
 }
 
 static inline SYS_WIFI_STATUS SYS_WIFI_GetTaskstatus(void)
@@ -414,29 +450,110 @@ static inline void SYS_WIFI_PrintWifiConfig(void)
 
 }
 static void SYS_WIFI_WaitForConnSTAIP(uintptr_t context)
+{
+    /* SYS_TIME callback context: only flag the check, 
+       the DHCP lease lookup is done by the Wi-Fi service task */
+    SYS_WIFI_STA_CONNECTION_INFO *staConnInfo = (SYS_WIFI_STA_CONNECTION_INFO *)context;
+
+    staConnInfo->wifiSrvcSTAIPCheck = true;
+    if (true == g_wifiSrvcEventSemCreated)
+    {
+        OSAL_SEM_PostISR(&g_wifiSrvcEventSemaphore);
+    }
+}
+
+static void SYS_WIFI_CheckConnSTAIP(void)
 {
     TCPIP_NET_HANDLE netHdl = TCPIP_STACK_NetHandleGet("PIC32MZW1");
-    TCPIP_DHCPS_LEASE_HANDLE dhcpsLease = 0;
+    TCPIP_DHCPS_LEASE_HANDLE dhcpsLease;
     TCPIP_DHCPS_LEASE_ENTRY dhcpsLeaseEntry;
+    SYS_WIFI_STA_CONNECTION_INFO *staConnInfo;
+    uint8_t idx;
 
-    do
+    for(idx = 0; idx < SYS_WIFI_MAX_STA_SUPPORTED; idx++)
     {
-        dhcpsLease = TCPIP_DHCPS_LeaseEntryGet(netHdl, &dhcpsLeaseEntry, dhcpsLease);
-        if (0 != dhcpsLease)
+        staConnInfo = &g_wifiSrvcStaConnInfo[idx];
+        if (false == staConnInfo->wifiSrvcSTAIPCheck)
+        {
+            continue;
+        }
+        staConnInfo->wifiSrvcSTAIPCheck = false;
+
+        if (WDRV_PIC32MZW_ASSOC_HANDLE_INVALID == staConnInfo->wifiSrvcAssocHandle)
         {
-            SYS_WIFI_STA_CONNECTION_INFO *staConnInfo = (SYS_WIFI_STA_CONNECTION_INFO *)context;
-            if(0 == memcmp(&dhcpsLeaseEntry.hwAdd, staConnInfo->wifiSrvcStaAppInfo.macAddr, WDRV_PIC32MZW_MAC_ADDR_LEN))
-            {               
-                SYS_CONSOLE_PRINT("\r\nConnected STA IP:%d.%d.%d.%d \r\n", dhcpsLeaseEntry.ipAddress.v[0], dhcpsLeaseEntry.ipAddress.v[1], dhcpsLeaseEntry.ipAddress.v[2], dhcpsLeaseEntry.ipAddress.v[3]);
-                staConnInfo->wifiSrvcStaAppInfo.ipAddr.Val = dhcpsLeaseEntry.ipAddress.Val;
-                staConnInfo->wifiSrvcSTAConnUpdate = true; 
-                SYS_WIFI_SetTaskstatus(SYS_WIFI_STATUS_WAIT_FOR_STA_IP);
-                return;
+            /* STA disconnected before getting an address */
+            continue;
+        }
+
+        dhcpsLease = 0;
+        do
+        {
+            dhcpsLease = TCPIP_DHCPS_LeaseEntryGet(netHdl, &dhcpsLeaseEntry, dhcpsLease);
+            if (0 != dhcpsLease)
+            {
+                if(0 == memcmp(&dhcpsLeaseEntry.hwAdd, staConnInfo->wifiSrvcStaAppInfo.macAddr, WDRV_PIC32MZW_MAC_ADDR_LEN))
+                {               
+                    SYS_CONSOLE_PRINT("\r\nConnected STA IP:%d.%d.%d.%d \r\n", dhcpsLeaseEntry.ipAddress.v[0], dhcpsLeaseEntry.ipAddress.v[1], dhcpsLeaseEntry.ipAddress.v[2], dhcpsLeaseEntry.ipAddress.v[3]);
+                    staConnInfo->wifiSrvcStaAppInfo.ipAddr.Val = dhcpsLeaseEntry.ipAddress.Val;
+                    staConnInfo->wifiSrvcSTAConnUpdate = true; 
+                    SYS_WIFI_SetTaskstatus(SYS_WIFI_STATUS_WAIT_FOR_STA_IP);
+                    break;
+                }
             }
+        } while(0 != dhcpsLease);
+
+        if (false == staConnInfo->wifiSrvcSTAConnUpdate)
+        {
+            SYS_TIME_CallbackRegisterMS(SYS_WIFI_WaitForConnSTAIP, (uintptr_t)staConnInfo, SYS_WIFI_STA_IP_CHECK_PERIOD, SYS_TIME_SINGLE);
         }
-    } while(0 != dhcpsLease);
+    }
+}
+
+/* Time the Wi-Fi service task can block waiting for the next event */
+static uint16_t SYS_WIFI_EventWaitGet
+(
+    SYS_WIFI_STATUS prevStatus, 
+    uint8_t provStatus
+)
+{
+    SYS_WIFI_STATUS status = g_wifiSrvcObj.wifiSrvcStatus;
+
+    if (status != prevStatus)
+    {
+        /* Process the new state right away */
+        return 0;
+    }
+
+    if ((SYS_WIFIPROV_STATUS_WAITFORREQ != provStatus) && (SYS_WIFIPROV_STATUS_NONE != provStatus))
+    {
+        /* Provisioning NVM operation in progress */
+        return SYS_WIFI_TASK_POLL_PERIOD;
+    }
 
-    SYS_TIME_CallbackRegisterMS(SYS_WIFI_WaitForConnSTAIP, context, 500, SYS_TIME_SINGLE);
+    switch (status) 
+    {
+        case SYS_WIFI_STATUS_INIT:
+        case SYS_WIFI_STATUS_WDRV_OPEN_REQ:
+        case SYS_WIFI_STATUS_CONNECT_REQ:
+        case SYS_WIFI_STATUS_WAIT_FOR_AP_IP:
+        case SYS_WIFI_STATUS_TCPIP_ERROR:
+        {
+            /* Driver ready, stack status and interface address
+               changes are not signalled */
+            return SYS_WIFI_TASK_POLL_PERIOD;
+        }
+
+        case SYS_WIFI_STATUS_WAIT_FOR_STA_IP:
+        {
+            /* More connected STA updates may be pending */
+            return 0;
+        }
+
+        default:
+        {
+            return OSAL_WAIT_FOREVER;
+        }
+    }
 }
 static void SYS_WIFI_APConnCallBack
 (
@@ -465,7 +582,7 @@ static void SYS_WIFI_APConnCallBack
                     {
                         g_wifiSrvcStaConnInfo[idx].wifiSrvcAssocHandle = assocHandle;
                         memcpy(&g_wifiSrvcStaConnInfo[idx].wifiSrvcStaAppInfo.macAddr, wifiSrvcStaConnMac.addr, WDRV_PIC32MZW_MAC_ADDR_LEN);
-                        SYS_TIME_CallbackRegisterMS(SYS_WIFI_WaitForConnSTAIP, (uintptr_t)&g_wifiSrvcStaConnInfo[idx], 500, SYS_TIME_SINGLE);
+                        SYS_TIME_CallbackRegisterMS(SYS_WIFI_WaitForConnSTAIP, (uintptr_t)&g_wifiSrvcStaConnInfo[idx], SYS_WIFI_STA_IP_CHECK_PERIOD, SYS_TIME_SINGLE);
                         break;
                     }
                 }
@@ -519,6 +636,7 @@ static void SYS_WIFI_STAConnCallBack
                connection event */
             g_wifiSrvcDrvAssocHdl = assocHandle;
             g_wifiSrvcAutoConnectRetry = 0;
+            g_wifiSrvcLastBssFailed = false;
             break;
         }
 
@@ -527,6 +645,16 @@ static void SYS_WIFI_STAConnCallBack
             /* When user provided HOMEAP configuration is not matching with near 
                by available HOMEAPs,Wi-Fi driver updated event Fail. */
             SYS_CONSOLE_PRINT(" Trying to connect to SSID : %s \r\n STA Connection failed. \r\n \r\n", SYS_WIFI_GetSSID());
+
+            if (true == g_wifiSrvcLastBssAttempt)
+            {
+                /* The directed connection to the last known BSS failed,
+                   fall back to a full scan without using up a retry */
+                g_wifiSrvcLastBssFailed = true;
+                g_wifiSrvcDrvAssocHdl = WDRV_PIC32MZW_ASSOC_HANDLE_INVALID;
+                SYS_WIFI_SetTaskstatus(SYS_WIFI_STATUS_CONNECT_REQ);
+                break;
+            }
             
             /* check user has enable the Auto connect feature in the STA
                mode,Auto connect Retry count is less then user configured 
@@ -659,18 +787,93 @@ static void SYS_WIFI_TCPIP_DHCP_EventHandler
 
 
 
+/* Select the BSS for a STA mode connection request when the user has not
+   fixed the channel: fresh driver scan results first, then the last BSS
+   saved with the configuration. Returns false when a full scan is needed. */
+static bool SYS_WIFI_GetLastBss
+(
+    uint8_t *channel, 
+    uint8_t *bssid
+)
+{
+    WDRV_PIC32MZW_SSID ssid;
+    WDRV_PIC32MZW_BSS_INFO bssInfo;
+    SYS_WIFI_STA_LAST_BSS *lastBss = &g_wifiSrvcConfig.staLastBss;
+
+    if ((SYS_WIFI_STA != SYS_WIFI_GetMode()) || (WDRV_PIC32MZW_CID_ANY != SYS_WIFI_GetChannel()) || (true == g_wifiSrvcLastBssFailed))
+    {
+        return false;
+    }
+
+    ssid.length = SYS_WIFI_GetSSIDLen();
+    if (ssid.length > sizeof(ssid.name))
+    {
+        return false;
+    }
+    memcpy(ssid.name, SYS_WIFI_GetSSID(), ssid.length);
+
+    if (WDRV_PIC32MZW_STATUS_OK == WDRV_PIC32MZW_BSSFindCacheLookup(g_wifiSrvcObj.wifiSrvcDrvHdl, &ssid, &bssInfo))
+    {
+        *channel = bssInfo.ctx.channel;
+        memcpy(bssid, bssInfo.ctx.bssid.addr, sizeof(lastBss->bssid));
+        return true;
+    }
+
+    if ((lastBss->channel >= WDRV_PIC32MZW_CID_2_4G_CH1) && (lastBss->channel <= WDRV_PIC32MZW_CID_2_4G_CH13) && (lastBss->authType == SYS_WIFI_GetAuthType()))
+    {
+        *channel = lastBss->channel;
+        memcpy(bssid, lastBss->bssid, sizeof(lastBss->bssid));
+        return true;
+    }
+
+    return false;
+}
+
 static SYS_WIFI_RESULT SYS_WIFI_SetChannel(void)
 {
     uint8_t ret = SYS_WIFI_FAILURE;
     uint8_t channel = SYS_WIFI_GetChannel();
+    uint8_t bssid[6];
+
+    g_wifiSrvcLastBssAttempt = SYS_WIFI_GetLastBss(&channel, bssid);
+
+    /* A directed request targets a single BSSID on a single channel */
+    WDRV_PIC32MZW_BSSCtxSetBSSID(&g_wifiSrvcObj.wifiSrvcBssCtx, (true == g_wifiSrvcLastBssAttempt) ? bssid : NULL);
 
     if (WDRV_PIC32MZW_STATUS_OK == WDRV_PIC32MZW_BSSCtxSetChannel(&g_wifiSrvcObj.wifiSrvcBssCtx, channel)) 
     {
         ret = SYS_WIFI_SUCCESS;
     }
+    else if (true == g_wifiSrvcLastBssAttempt)
+    {
+        /* Hint channel not allowed by the current regulatory domain */
+        g_wifiSrvcLastBssAttempt = false;
+        WDRV_PIC32MZW_BSSCtxSetBSSID(&g_wifiSrvcObj.wifiSrvcBssCtx, NULL);
+        if (WDRV_PIC32MZW_STATUS_OK == WDRV_PIC32MZW_BSSCtxSetChannel(&g_wifiSrvcObj.wifiSrvcBssCtx, SYS_WIFI_GetChannel())) 
+        {
+            ret = SYS_WIFI_SUCCESS;
+        }
+    }
     return ret;
 }
 
+/* Copy a new configuration, the last BSS hint is kept only while 
+   the HOMEAP SSID is unchanged */
+static void SYS_WIFI_CopyConfig
+(
+    const SYS_WIFI_CONFIG *wifi_config
+)
+{
+    bool sameSsid = (0 == strncmp((const char *)g_wifiSrvcConfig.staConfig.ssid, (const char *)wifi_config->staConfig.ssid, sizeof(g_wifiSrvcConfig.staConfig.ssid)));
+
+    memcpy(&g_wifiSrvcConfig, wifi_config, sizeof(SYS_WIFI_CONFIG));
+    if (false == sameSsid)
+    {
+        memset(&g_wifiSrvcConfig.staLastBss, 0, sizeof(SYS_WIFI_STA_LAST_BSS));
+        g_wifiSrvcLastBssFailed = false;
+    }
+}
+
 static uint8_t SYS_WIFI_DisConnect(void)
 {
     uint8_t ret = SYS_WIFI_FAILURE;
@@ -840,7 +1043,7 @@ static SYS_WIFI_RESULT SYS_WIFI_SetConfig
         SYS_WIFI_RESULT ret = SYS_WIFI_SUCCESS;
 
         /* Copy the user Wi-Fi configuration and make connection request */
-        memcpy(&g_wifiSrvcConfig,wifi_config,sizeof(SYS_WIFI_CONFIG));
+        SYS_WIFI_CopyConfig(wifi_config);
         SYS_WIFI_SetTaskstatus(status);
         return ret;
     }
@@ -855,6 +1058,8 @@ static uint32_t SYS_WIFI_ExecuteBlock
     static TCPIP_NET_HANDLE      netHdl;
     SYS_WIFI_OBJ *               wifiSrvcObj = (SYS_WIFI_OBJ *) object;
     uint8_t                      ret =  SYS_WIFIPROV_OBJ_INVALID;
+    uint8_t                      provStatus;
+    SYS_WIFI_STATUS              prevStatus;
 	static bool provConnStatus = false;
 
     IPV4_ADDR                    apLastIp = {-1};
@@ -862,6 +1067,12 @@ static uint32_t SYS_WIFI_ExecuteBlock
  
     if (&g_wifiSrvcObj == (SYS_WIFI_OBJ*) wifiSrvcObj)
     {    
+        if (SYS_WIFI_AP == SYS_WIFI_GetMode())
+        {
+            SYS_WIFI_CheckConnSTAIP();
+        }
+
+        prevStatus = wifiSrvcObj->wifiSrvcStatus;
         switch (wifiSrvcObj->wifiSrvcStatus) 
         {
             case SYS_WIFI_STATUS_INIT:
@@ -996,6 +1207,7 @@ static uint32_t SYS_WIFI_ExecuteBlock
             case SYS_WIFI_STATUS_STA_IP_RECIEVED:
             {
                 WDRV_PIC32MZW_CHANNEL_ID channel = 0;
+                WDRV_PIC32MZW_MAC_ADDR peerAddr;
                  
                 /* Update the application(client) on receiving IP address */
                 SYS_WIFI_CallBackFun(SYS_WIFI_CONNECT, &g_wifiSrvcConfig.staConfig.ipAddr, g_wifiSrvcCookie);
@@ -1007,7 +1219,15 @@ static uint32_t SYS_WIFI_ExecuteBlock
                    if user has enable TCP Socket configuration from MHC */
                 SYS_WIFIPROV_CtrlMsg(g_wifiSrvcProvObj,SYS_WIFIPROV_CONNECT,&provConnStatus,sizeof(bool));                
                 WDRV_PIC32MZW_InfoOpChanGet(g_wifiSrvcObj.wifiSrvcDrvHdl,&channel);
-                g_wifiSrvcConfig.staConfig.channel = (uint8_t )channel;
+
+                /* Remember the BSS for a directed reconnect, the user
+                   channel setting is left untouched */
+                if (WDRV_PIC32MZW_STATUS_OK == WDRV_PIC32MZW_AssocPeerAddressGet(g_wifiSrvcDrvAssocHdl, &peerAddr))
+                {
+                    memcpy(g_wifiSrvcConfig.staLastBss.bssid, peerAddr.addr, sizeof(g_wifiSrvcConfig.staLastBss.bssid));
+                    g_wifiSrvcConfig.staLastBss.channel = (uint8_t)channel;
+                    g_wifiSrvcConfig.staLastBss.authType = SYS_WIFI_GetAuthType();
+                }
                 
                 if(g_wifiSrvcConfig.saveConfig == true)
                 {
@@ -1102,8 +1322,9 @@ static uint32_t SYS_WIFI_ExecuteBlock
                 break;
             }
         }
-        SYS_WIFIPROV_Tasks (g_wifiSrvcProvObj);
+        provStatus = SYS_WIFIPROV_Tasks (g_wifiSrvcProvObj);
         ret = wifiSrvcObj->wifiSrvcStatus;
+        g_wifiSrvcEventWait = SYS_WIFI_EventWaitGet(prevStatus, provStatus);
     }
     return ret;
 }
@@ -1144,7 +1365,7 @@ static void SYS_WIFI_WIFIPROVCallBack
                         {
 
                             /* Copy received configuration into Wi-Fi service structure */
-                            memcpy(&g_wifiSrvcConfig, wifiConfig, sizeof (SYS_WIFIPROV_CONFIG));
+                            SYS_WIFI_CopyConfig((SYS_WIFI_CONFIG *) wifiConfig);
 
                             /* In STA mode, check PIC32MZW1 connection status to HOMEAP */
                             if (g_wifiSrvcDrvAssocHdl == WDRV_PIC32MZW_ASSOC_HANDLE_INVALID) 
@@ -1209,6 +1430,14 @@ static void SYS_WIFI_WIFIPROVCallBack
                 break;
             }
 
+            case SYS_WIFIPROV_TASKREQ:
+            {
+                /* Wi-Fi Provisioning service has work pending, 
+                   it runs from the Wi-Fi service task */
+                SYS_WIFI_SignalTask();
+                break;
+            }
+
             default:
             {
                 break;
@@ -1237,6 +1466,17 @@ SYS_MODULE_OBJ SYS_WIFI_Initialize
             SYS_CONSOLE_MESSAGE("Failed to Initialize Wi-Fi Service as Semaphore NOT created\r\n");
             return SYS_MODULE_OBJ_INVALID;
         }
+        if (false == g_wifiSrvcEventSemCreated)
+        {
+            if (OSAL_SEM_Create(&g_wifiSrvcEventSemaphore, OSAL_SEM_TYPE_BINARY, 1, 0) != OSAL_RESULT_TRUE) 
+            {
+                SYS_CONSOLE_MESSAGE("Failed to Initialize Wi-Fi Service as Event Semaphore NOT created\r\n");
+                OSAL_SEM_Delete(&g_wifiSrvcSemaphore);
+                return SYS_MODULE_OBJ_INVALID;
+            }
+            g_wifiSrvcEventSemCreated = true;
+        }
+        g_wifiSrvcEventWait = 0;
         memset(g_wifiSrvcCallBack,0,sizeof(g_wifiSrvcCallBack));
         if (callback != NULL) 
         {
@@ -1345,6 +1585,25 @@ uint8_t SYS_WIFI_Tasks
     return ret;
 }
 
+// *****************************************************************************
+// *****************************************************************************
+// Section:  SYS WiFi Tasks Wait Interface
+// *****************************************************************************
+// *****************************************************************************
+void SYS_WIFI_TasksWait
+(
+    SYS_MODULE_OBJ object
+) 
+{
+    if ((&g_wifiSrvcObj == (SYS_WIFI_OBJ *) object) && (true == g_wifiSrvcEventSemCreated))
+    {
+        if (0 != g_wifiSrvcEventWait)
+        {
+            OSAL_SEM_Pend(&g_wifiSrvcEventSemaphore, g_wifiSrvcEventWait);
+        }
+    }
+}
+
 // *****************************************************************************
 // *****************************************************************************
 // Section:  SYS WiFi Control Message Interface
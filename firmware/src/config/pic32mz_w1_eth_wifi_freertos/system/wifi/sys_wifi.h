@@ -280,6 +280,35 @@ typedef struct
 
 } SYS_WIFI_AP_CONFIG;
 
+// *****************************************************************************
+/* System Wi-Fi service station mode last BSS structure.
+
+  Summary:
+    Last BSS the station mode was associated with.
+
+  Description:
+    Recorded by the Wi-Fi service when the station receives an IP address
+    and saved together with the rest of the configuration. On reconnect
+    the service first tries a directed connection on this BSSID/channel
+    and falls back to a full scan if that attempt fails.
+
+  Remarks:
+   Maintained by the Wi-Fi service, the application should not set it.
+   The entry is valid only if the channel is in range 1 to 13.
+*/
+typedef struct 
+{
+    /* BSSID of the last associated AP */
+    uint8_t bssid[6];
+
+    /* Operating channel of the last associated AP */
+    uint8_t channel;
+
+    /* Authentication type (SYS_WIFI_AUTH) used for the association */
+    uint8_t authType;
+
+} SYS_WIFI_STA_LAST_BSS;
+
 // *****************************************************************************
 /* System Wi-Fi service device configuration structure.
 
@@ -313,6 +342,11 @@ typedef struct
     /* Wi-Fi access point mode configuration structure */
     SYS_WIFI_AP_CONFIG apConfig;
 
+    /* Wi-Fi station mode reconnect hint.
+       Kept last so that a configuration saved by an older image
+       reads back as an invalid hint. */
+    SYS_WIFI_STA_LAST_BSS staLastBss;
+
 }SYS_WIFI_CONFIG;
 
 
@@ -710,6 +744,48 @@ uint8_t SYS_WIFI_GetStatus ( SYS_MODULE_OBJ object) ;
 
 uint8_t SYS_WIFI_Tasks (SYS_MODULE_OBJ object);
 
+// *****************************************************************************
+/* Function:
+   void SYS_WIFI_TasksWait ( SYS_MODULE_OBJ object)
+
+  Summary:
+    Blocks the Wi-Fi System task until there is work to do. 
+
+  Description:
+    This function blocks the calling RTOS task until a driver callback,
+    a DHCP/provisioning event, a timer or a client request signals the
+    Wi-Fi system service. States that wait on a condition which is not
+    signalled are re-run periodically. The function returns immediately
+    if the last SYS_WIFI_Tasks call changed the service state.
+
+  Precondition:
+       The SYS_WIFI_Initialize function should have been called before calling
+       this function.
+
+  Parameters:
+       object   - SYS WIFI object handle, returned from SYS_WIFI_Initialize
+
+  Returns:
+       None.
+
+  Example:
+        <code>
+
+        while (1)
+        {
+            SYS_WIFI_Tasks (sysObj.syswifi);
+            SYS_WIFI_TasksWait (sysObj.syswifi);
+        }
+
+        </code>
+
+  Remarks:
+    Only used in RTOS configurations. In a bare metal configuration
+    SYS_WIFI_Tasks is called from the super loop instead.
+*/
+
+void SYS_WIFI_TasksWait (SYS_MODULE_OBJ object);
+
 // *****************************************************************************
 /* Function:
    SYS_WIFI_RESULT SYS_WIFI_CtrlMsg 
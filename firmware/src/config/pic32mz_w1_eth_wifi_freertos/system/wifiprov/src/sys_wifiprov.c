@@ -121,19 +121,6 @@ static      void   SYS_WIFIPROV_PrintConfig(void);
 // Section: Local Functions
 // *****************************************************************************
 // *****************************************************************************
-static inline void SYS_WIFIPROV_SetTaskstatus
-(
-    SYS_WIFIPROV_STATUS val
-) 
-{
-    g_wifiProvSrvcObj.status = val;
-}
-
-static inline SYS_WIFIPROV_STATUS SYS_WIFIPROV_GetTaskstatus(void) 
-{
-    return g_wifiProvSrvcObj.status;
-}
-
 static inline void SYS_WIFIPROV_CallBackFun
 (
     uint32_t event, 
@@ -148,6 +135,25 @@ static inline void SYS_WIFIPROV_CallBackFun
     }
 }
 
+static inline void SYS_WIFIPROV_SetTaskstatus
+(
+    SYS_WIFIPROV_STATUS val
+) 
+{
+    g_wifiProvSrvcObj.status = val;
+    if ((SYS_WIFIPROV_STATUS_WAITFORREQ != val) && (SYS_WIFIPROV_STATUS_NONE != val))
+    {
+        /* Request the client to run SYS_WIFIPROV_Tasks, 
+           the service does not poll while idle */
+        SYS_WIFIPROV_CallBackFun(SYS_WIFIPROV_TASKREQ, NULL, g_wifiProvSrvcCookie);
+    }
+}
+
+static inline SYS_WIFIPROV_STATUS SYS_WIFIPROV_GetTaskstatus(void) 
+{
+    return g_wifiProvSrvcObj.status;
+}
+
 static void inline SYS_WIFIPROV_SetCookie(void *cookie) 
 {
     g_wifiProvSrvcCookie = cookie;
@@ -493,6 +499,8 @@ static int SYS_WIFIPROV_CMDProcess
                     g_wifiProvSrvcConfig.mode = wifiProvSrvcConfig.mode;
                     g_wifiProvSrvcConfig.saveConfig = wifiProvSrvcConfig.saveConfig;
                     memcpy(&g_wifiProvSrvcConfig.staConfig, &wifiProvSrvcConfig.staConfig, sizeof(SYS_WIFIPROV_STA_CONFIG));
+                    /* New HOMEAP details, the last BSS hint no longer applies */
+                    memset(&g_wifiProvSrvcConfig.staLastBss, 0, sizeof(SYS_WIFIPROV_STA_LAST_BSS));
                     SYS_WIFIPROV_WriteConfig();
                     //SYS_WIFIPROV_PrintConfig();
                 }
@@ -782,6 +790,7 @@ static void SYS_WIFIPROV_DataUpdate(uint8_t buffer[])
                 memcpy(g_wifiProvSrvcConfig.countryCode, wifiProvSrvcConfig.countryCode, sizeof (wifiProvSrvcConfig.countryCode));
                 memcpy(&g_wifiProvSrvcConfig.staConfig, &wifiProvSrvcConfig.staConfig, sizeof (SYS_WIFIPROV_STA_CONFIG));
                 memcpy(&g_wifiProvSrvcConfig.apConfig, &wifiProvSrvcConfig.apConfig, sizeof (SYS_WIFIPROV_AP_CONFIG));
+                memset(&g_wifiProvSrvcConfig.staLastBss, 0, sizeof (SYS_WIFIPROV_STA_LAST_BSS));
                 //SYS_WIFIPROV_PrintConfig();
                 /* Updating Configuration into Wi-Fi Provisioning structure */
                 SYS_WIFIPROV_WriteConfig();
@@ -831,6 +840,7 @@ static void SYS_WIFIPROV_DataUpdate(uint8_t buffer[])
                 g_wifiProvSrvcConfig.staConfig.authType = wifiProvSrvcConfig.staConfig.authType;
                 memcpy(g_wifiProvSrvcConfig.staConfig.ssid, wifiProvSrvcConfig.staConfig.ssid, sizeof (wifiProvSrvcConfig.staConfig.ssid));
                 memcpy(g_wifiProvSrvcConfig.staConfig.psk, wifiProvSrvcConfig.staConfig.psk, sizeof (wifiProvSrvcConfig.staConfig.psk));
+                memset(&g_wifiProvSrvcConfig.staLastBss, 0, sizeof (SYS_WIFIPROV_STA_LAST_BSS));
                 /* Updating Configuration into Wi-Fi Provisioning structure */
                 SYS_WIFIPROV_WriteConfig();
             }
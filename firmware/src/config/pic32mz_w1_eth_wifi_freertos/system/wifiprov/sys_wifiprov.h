@@ -131,6 +131,10 @@ typedef enum
     /* Updating Wi-Fi Connect status for enabling Wi-Fi Provisioning service */
     SYS_WIFIPROV_CONNECT,        
 
+    /* Client callback event: Wi-Fi Provisioning service has pending work,
+       client should run SYS_WIFIPROV_Tasks */
+    SYS_WIFIPROV_TASKREQ,
+
 } SYS_WIFIPROV_CTRLMSG ;
 
 // *****************************************************************************
@@ -233,6 +237,32 @@ typedef struct
 
 } SYS_WIFIPROV_AP_CONFIG;
 
+// *****************************************************************************
+/* System Wi-Fi Provisioning service station mode last BSS structure.
+
+  Summary:
+    Last BSS the station mode was associated with.
+
+  Description:
+    Stored by the Wi-Fi service and saved in NVM with the configuration,
+    used as a reconnect hint. Layout matches SYS_WIFI_STA_LAST_BSS.
+
+  Remarks:
+   None.
+*/
+typedef struct 
+{
+    /* BSSID of the last associated AP */
+    uint8_t bssid[6];
+
+    /* Operating channel of the last associated AP */
+    uint8_t channel;
+
+    /* Authentication type used for the association */
+    uint8_t authType;
+
+} SYS_WIFIPROV_STA_LAST_BSS;
+
 // *****************************************************************************
 /* System Wi-Fi Provisioning service device configuration structure.
 
@@ -264,6 +294,9 @@ typedef struct
 
     /* Wi-Fi access point mode configuration */
     SYS_WIFIPROV_AP_CONFIG apConfig;
+
+    /* Wi-Fi station mode reconnect hint */
+    SYS_WIFIPROV_STA_LAST_BSS staLastBss;
 }SYS_WIFIPROV_CONFIG;
 
 // *****************************************************************************
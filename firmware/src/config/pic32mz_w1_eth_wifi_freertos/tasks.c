@@ -161,7 +161,7 @@ void _SYS_WIFI_Task(  void *pvParameters  )
     while(1)
     {
         SYS_WIFI_Tasks(sysObj.syswifi);
-        vTaskDelay(1 / portTICK_PERIOD_MS);
+        SYS_WIFI_TasksWait(sysObj.syswifi);
     }
 }
 
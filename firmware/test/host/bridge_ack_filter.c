@@ -0,0 +1,621 @@
+/*******************************************************************************
+  MAC bridge TX backlog ACK filter test
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    bridge_ack_filter.c
+
+  Summary:
+    TCP ACK filtering on the port TX backlog
+
+  Description:
+    Station A on port 0 sends TCP frames to station B on port 1
+    while the port 1 MAC refuses to transmit: the frames are held in the TX backlog.
+    The MAC is then released and the frames that reach it are compared
+    with the ones the filter had to keep.
+
+    The frames are forwarded directly, without a bridge copy:
+    the test checks that every one of them is returned to its owner
+    as soon as it is backlogged and that only bridge packets are held.
+*******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+//DOM-IGNORE-END
+
+#include <stdlib.h>
+
+#include "host_test.h"
+
+// the module under test, for access to its internal state
+#include "tcpip/src/tcpip_mac_bridge.c"
+
+#if (_TCPIP_MAC_BRIDGE_ACK_FILTER == 0)
+#error "the test needs TCPIP_MAC_BRIDGE_TX_BACKLOG and TCPIP_MAC_BRIDGE_ACK_FILTER"
+#endif
+
+#define TEST_NETS               2
+#define TEST_TX_QUEUE           64
+#define TEST_MAX_FRAMES         2048
+#define TEST_RANDOM_RUNS        100
+#define TEST_RANDOM_FRAMES      1000
+#define TEST_RANDOM_HELD        (TCPIP_MAC_BRIDGE_TX_BACKLOG / 2)
+
+// frame options
+#define TEST_F_DATA             0x01
+#define TEST_F_SACK             0x02
+#define TEST_F_FIN              0x04
+#define TEST_F_CE               0x08
+#define TEST_F_FRAG             0x10
+#define TEST_F_PSH              0x20
+#define TEST_F_NO_TS            0x40
+
+static TCPIP_NET_IF testNetIf[TEST_NETS];
+static const TCPIP_MAC_ADDR testHostMac[TEST_NETS] =
+{
+    {{0x00, 0x04, 0xa3, 0x00, 0x00, 0x01}},
+    {{0x00, 0x04, 0xa3, 0x00, 0x00, 0x02}},
+};
+static const TCPIP_MAC_ADDR testStaMac[TEST_NETS] =
+{
+    {{0x02, 0x42, 0x00, 0x00, 0x00, 0x0a}},     // A, port 0
+    {{0x02, 0x42, 0x00, 0x00, 0x00, 0x0b}},     // B, port 1
+};
+
+static bool testMacBusy[TEST_NETS];
+static TCPIP_MAC_PACKET* testTxQueue[TEST_TX_QUEUE];
+static int testTxCount;
+static int testRxFrames;
+static int testRxAcks;
+
+// the frames sent by A, by frame id
+typedef struct
+{
+    uint32_t    seq;
+    uint32_t    ack;
+    uint16_t    window;
+    uint8_t     flow;
+    uint8_t     pure;       // pure ACK, no SACK: the filter may drop it
+    uint8_t     sent;       // reached the port 1 MAC
+}TEST_FRAME;
+
+static TEST_FRAME testFrames[TEST_MAX_FRAMES];
+static int testNFrames;
+static int testSentIds[TEST_MAX_FRAMES];
+static int testNSent;
+
+// stack services used by the bridge
+
+TCPIP_NET_HANDLE TCPIP_STACK_IndexToNet(int netIx)
+{
+    return netIx >= 0 && netIx < TEST_NETS ? testNetIf + netIx : 0;
+}
+
+int TCPIP_STACK_NetIxGet(const TCPIP_NET_IF* pNetIf)
+{
+    return pNetIf != 0 ? pNetIf - testNetIf : -1;
+}
+
+int TCPIP_STACK_NumberOfNetworksGet(void)
+{
+    return TEST_NETS;
+}
+
+TCPIP_NET_HANDLE TCPIP_STACK_NetHandleGet(const char* interface)
+{
+    return 0;
+}
+
+SYS_MODULE_OBJ TCPIP_STACK_Initialize(const SYS_MODULE_INDEX index, const SYS_MODULE_INIT * const init)
+{
+    return (SYS_MODULE_OBJ)testNetIf;
+}
+
+SYS_STATUS TCPIP_STACK_Status(SYS_MODULE_OBJ object)
+{
+    return SYS_STATUS_READY;
+}
+
+tcpipSignalHandle _TCPIPStackSignalHandlerRegister(TCPIP_STACK_MODULE modId, tcpipModuleSignalHandler signalHandler, int16_t asyncTmoMs)
+{
+    return (tcpipSignalHandle)testNetIf;
+}
+
+bool _TCPIPStackSignalHandlerSetParams(TCPIP_STACK_MODULE modId, tcpipSignalHandle handle, int16_t asyncTmoMs)
+{
+    return true;
+}
+
+void _TCPIPStackSignalHandlerDeregister(tcpipSignalHandle handle)
+{
+}
+
+// the MAC: a busy port refuses the frame, as the Wi-Fi MAC without TX memory
+// the frames taken by port 1 are recorded by the IP identification field
+TCPIP_MAC_RES _TCPIPStackPacketTx(TCPIP_NET_IF* pNetIf, TCPIP_MAC_PACKET * ptrPacket)
+{
+    int netIx = pNetIf - testNetIf;
+
+    if(testMacBusy[netIx] || testTxCount == TEST_TX_QUEUE)
+    {
+        return TCPIP_MAC_RES_QUEUE_TX_FULL;
+    }
+
+    if(netIx == 1)
+    {
+        const TCPIP_MAC_ETHERNET_HEADER* pMacHdr = (const TCPIP_MAC_ETHERNET_HEADER*)ptrPacket->pMacLayer;
+        const uint8_t* pIp = (const uint8_t*)(pMacHdr + 1);
+        if(pMacHdr->Type == TCPIP_Helper_htons(TCPIP_ETHER_TYPE_IPV4))
+        {
+            int frameId = ((int)pIp[4] << 8) | pIp[5];
+            testSentIds[testNSent++] = frameId;
+            testFrames[frameId].sent = 1;
+        }
+    }
+
+    testTxQueue[testTxCount++] = ptrPacket;
+    return TCPIP_MAC_RES_OK;
+}
+
+static void _TestTxDone(void)
+{
+    int ix;
+
+    for(ix = 0; ix < testTxCount; ix++)
+    {
+        TCPIP_MAC_PACKET* pPkt = testTxQueue[ix];
+        pPkt->ackRes = TCPIP_MAC_PKT_ACK_TX_OK;
+        (*pPkt->ackFunc)(pPkt, pPkt->ackParam);
+    }
+    testTxCount = 0;
+}
+
+// the received frames are allocated per frame: a directly forwarded one is in flight until acknowledged
+static void _TestRxAck(TCPIP_MAC_PACKET* pPkt, const void* param)
+{
+    testRxAcks++;
+    TCPIP_PKT_PacketFree(pPkt);
+}
+
+static TCPIP_MAC_PACKET* _TestRxPacket(int srcSta, int dstSta)
+{
+    TCPIP_MAC_PACKET* pRxPkt = TCPIP_PKT_PacketAlloc(sizeof(TCPIP_MAC_PACKET), 128, 0);
+    TCPIP_MAC_ETHERNET_HEADER* pMacHdr = (TCPIP_MAC_ETHERNET_HEADER*)pRxPkt->pMacLayer;
+
+    memset(pRxPkt->pMacLayer, 0, sizeof(*pMacHdr) + 128);
+    pMacHdr->SourceMACAddr = testStaMac[srcSta];
+    pMacHdr->DestMACAddr = testStaMac[dstSta];
+    pMacHdr->Type = TCPIP_Helper_htons(TCPIP_ETHER_TYPE_IPV4);
+
+    // as received from the MAC driver
+    pRxPkt->pktIf = testNetIf + srcSta;
+    pRxPkt->pNetLayer = pRxPkt->pMacLayer + sizeof(TCPIP_MAC_ETHERNET_HEADER);
+    pRxPkt->pDSeg->segLen = 46;
+    pRxPkt->ackFunc = _TestRxAck;
+    pRxPkt->ackParam = 0;
+
+    return pRxPkt;
+}
+
+static void _TestRxProcess(TCPIP_MAC_PACKET* pRxPkt)
+{
+    testRxFrames++;
+    if(TCPIP_MAC_Bridge_ProcessPacket(pRxPkt) == TCPIP_MAC_BRIDGE_PKT_RES_HOST_PROCESS)
+    {   // the host is done with it
+        pRxPkt->ackFunc(pRxPkt, pRxPkt->ackParam);
+    }
+}
+
+static void _TestPut32(uint8_t* pBuff, uint32_t val)
+{
+    pBuff[0] = (uint8_t)(val >> 24);
+    pBuff[1] = (uint8_t)(val >> 16);
+    pBuff[2] = (uint8_t)(val >> 8);
+    pBuff[3] = (uint8_t)val;
+}
+
+// builds an IPv4 TCP frame of a flow from A to B
+// the frame id goes into the IP identification field
+static TCPIP_MAC_PACKET* _TestTcpPacket(int flow, uint32_t seq, uint32_t ack, uint16_t window, uint32_t tsVal, int flags)
+{
+    TCPIP_MAC_PACKET* pPkt = _TestRxPacket(0, 1);
+    uint8_t* pIp = pPkt->pNetLayer;
+    uint8_t* pTcp = pIp + 20;
+    uint8_t* pOpt = pTcp + 20;
+    int optLen = ((flags & TEST_F_NO_TS) != 0 ? 0 : 12) + ((flags & TEST_F_SACK) != 0 ? 12 : 0);
+    int totLen = 20 + 20 + optLen + ((flags & TEST_F_DATA) != 0 ? 10 : 0);
+    int frameId = testNFrames++;
+
+    pIp[0] = 0x45;
+    pIp[1] = (flags & TEST_F_CE) != 0 ? 0x03 : 0;
+    pIp[2] = (uint8_t)(totLen >> 8);
+    pIp[3] = (uint8_t)totLen;
+    pIp[4] = (uint8_t)(frameId >> 8);
+    pIp[5] = (uint8_t)frameId;
+    pIp[6] = (flags & TEST_F_FRAG) != 0 ? 0x20 : 0x40;  // MF or DF
+    pIp[8] = 64;
+    pIp[9] = IP_PROT_TCP;
+    _TestPut32(pIp + 12, 0x0a000001 + flow);
+    _TestPut32(pIp + 16, 0xc0a80001);
+
+    _TestPut32(pTcp, ((40000u + flow) << 16) | 80);
+    _TestPut32(pTcp + 4, seq);
+    _TestPut32(pTcp + 8, ack);
+    pTcp[12] = (uint8_t)(((20 + optLen) / 4) << 4);
+    pTcp[13] = 0x10 | ((flags & TEST_F_FIN) != 0 ? 0x01 : 0) | ((flags & TEST_F_PSH) != 0 ? 0x08 : 0);
+    pTcp[14] = (uint8_t)(window >> 8);
+    pTcp[15] = (uint8_t)window;
+
+    if((flags & TEST_F_NO_TS) == 0)
+    {   // NOP, NOP, timestamps
+        pOpt[0] = 1;
+        pOpt[1] = 1;
+        pOpt[2] = 8;
+        pOpt[3] = 10;
+        _TestPut32(pOpt + 4, tsVal);
+        pOpt += 12;
+    }
+    if((flags & TEST_F_SACK) != 0)
+    {   // NOP, NOP, one SACK block
+        pOpt[0] = 1;
+        pOpt[1] = 1;
+        pOpt[2] = 5;
+        pOpt[3] = 10;
+        _TestPut32(pOpt + 4, ack + 1000);
+        _TestPut32(pOpt + 8, ack + 2000);
+    }
+
+    pPkt->pDSeg->segLen = totLen;
+
+    testFrames[frameId] = (TEST_FRAME)
+    {
+        .seq = seq, .ack = ack, .window = window, .flow = (uint8_t)flow,
+        .pure = (flags & (TEST_F_DATA | TEST_F_SACK | TEST_F_FIN | TEST_F_CE | TEST_F_FRAG | TEST_F_PSH)) == 0,
+    };
+
+    return pPkt;
+}
+
+// A sends a frame to B while the port 1 MAC is busy
+static void _TestSend(int flow, uint32_t seq, uint32_t ack, uint16_t window, uint32_t tsVal, int flags)
+{
+    SGL_LIST_NODE* pNode;
+    int nAcks = testRxAcks;
+
+    _TestRxProcess(_TestTcpPacket(flow, seq, ack, window, tsVal, flags));
+
+    // returned to its owner right away; the backlog holds bridge packets only
+    HOST_TEST_CHECK(testRxAcks == nAcks + 1);
+    for(pNode = bridgeDcpt.txBacklog[1].head; pNode != 0; pNode = pNode->next)
+    {
+        HOST_TEST_CHECK((_MAC_Bridge_GetPktFlags((TCPIP_MAC_PACKET*)pNode) & MAC_BRIDGE_ALLOC_FLAG_BRIDGE_OWN) != 0);
+    }
+}
+
+static void _TestReset(void)
+{
+    testNFrames = 0;
+    testNSent = 0;
+    testMacBusy[1] = true;
+}
+
+// releases the port 1 MAC and sends the backlog
+// returns the number of frames sent
+static int _TestFlush(void)
+{
+    testMacBusy[1] = false;
+    TCPIP_MAC_Bridge_Task();
+    _TestTxDone();
+    HOST_TEST_CHECK(TCPIP_Helper_SingleListIsEmpty(bridgeDcpt.txBacklog + 1));
+    return testNSent;
+}
+
+// the MAC takes the oldest held frame
+static void _TestTakeOne(void)
+{
+    int ix;
+    SGL_LIST_NODE* pHead = bridgeDcpt.txBacklog[1].head;
+
+    if(pHead != 0)
+    {   // let the head out, the next one is refused again
+        testMacBusy[1] = false;
+        ix = testTxCount;
+        _MAC_Bridge_ForwardPacket((TCPIP_MAC_PACKET*)TCPIP_Helper_SingleListHeadRemove(bridgeDcpt.txBacklog + 1), 0);
+        HOST_TEST_CHECK(testTxCount == ix + 1);
+        testMacBusy[1] = true;
+        _TestTxDone();
+    }
+}
+
+// the ACK information extracted from a frame
+static void _TestParse(void)
+{
+    MAC_BRIDGE_ACK_INFO ackInfo;
+    TCPIP_MAC_PACKET* pPkt;
+
+    testNFrames = 0;
+    pPkt = _TestTcpPacket(3, 0x01020304, 0xa0b0c0d0, 0x1234, 0x55667788, 0);
+    pPkt->pDSeg->segLen += sizeof(TCPIP_MAC_ETHERNET_HEADER);
+    HOST_TEST_CHECK(_MAC_Bridge_AckParse(pPkt, &ackInfo));
+    HOST_TEST_CHECK(ackInfo.srcAdd == 0x0a000004 && ackInfo.dstAdd == 0xc0a80001);
+    HOST_TEST_CHECK(ackInfo.ports == ((40003u << 16) | 80));
+    HOST_TEST_CHECK(ackInfo.seq == 0x01020304 && ackInfo.ack == 0xa0b0c0d0 && ackInfo.window == 0x1234);
+    HOST_TEST_CHECK(ackInfo.hasTs == 1 && ackInfo.tsVal == 0x55667788);
+
+    // the headers not in the segment
+    pPkt->pDSeg->segLen -= 1;
+    HOST_TEST_CHECK(!_MAC_Bridge_AckParse(pPkt, &ackInfo));
+    pPkt->pDSeg->segLen += 1;
+
+    // not IPv4
+    ((TCPIP_MAC_ETHERNET_HEADER*)pPkt->pMacLayer)->Type = TCPIP_Helper_htons(TCPIP_ETHER_TYPE_IPV6);
+    HOST_TEST_CHECK(!_MAC_Bridge_AckParse(pPkt, &ackInfo));
+    TCPIP_PKT_PacketFree(pPkt);
+
+    pPkt = _TestTcpPacket(0, 1, 1000, 500, 0, TEST_F_NO_TS);
+    pPkt->pDSeg->segLen += sizeof(TCPIP_MAC_ETHERNET_HEADER);
+    HOST_TEST_CHECK(_MAC_Bridge_AckParse(pPkt, &ackInfo) && ackInfo.hasTs == 0);
+    TCPIP_PKT_PacketFree(pPkt);
+
+    pPkt = _TestTcpPacket(0, 1, 1000, 500, 0, TEST_F_SACK);
+    pPkt->pDSeg->segLen += sizeof(TCPIP_MAC_ETHERNET_HEADER);
+    HOST_TEST_CHECK(!_MAC_Bridge_AckParse(pPkt, &ackInfo));
+    TCPIP_PKT_PacketFree(pPkt);
+}
+
+static void _TestCases(void)
+{
+    int ix;
+    static const int otherFlags[] = {TEST_F_DATA, TEST_F_FIN, TEST_F_PSH, TEST_F_CE, TEST_F_FRAG};
+
+    // cumulative ACKs: only the newest reaches the MAC
+    _TestReset();
+    for(ix = 0; ix < 5; ix++)
+    {
+        _TestSend(0, 1, 1000 * (ix + 1), 500, 100 + ix, 0);
+    }
+    HOST_TEST_CHECK(_TestFlush() == 1 && testSentIds[0] == 4);
+
+    // duplicate ACKs are kept for the fast retransmit
+    _TestReset();
+    for(ix = 0; ix < 4; ix++)
+    {
+        _TestSend(0, 1, 3000, 500, 100, 0);
+    }
+    HOST_TEST_CHECK(_TestFlush() == 4);
+
+    // a SACK is neither dropped nor dropping
+    _TestReset();
+    _TestSend(0, 1, 1000, 500, 1, TEST_F_SACK);
+    _TestSend(0, 1, 2000, 500, 2, 0);
+    _TestSend(0, 1, 3000, 500, 3, TEST_F_SACK);
+    HOST_TEST_CHECK(_TestFlush() == 3);
+
+    // data, FIN, PSH, CE and fragments are neither dropped nor dropping
+    _TestReset();
+    _TestSend(0, 1, 1000, 500, 1, 0);
+    for(ix = 0; ix < sizeof(otherFlags) / sizeof(*otherFlags); ix++)
+    {
+        _TestSend(0, 1, 2000 + ix, 500, 2, otherFlags[ix]);
+    }
+    HOST_TEST_CHECK(_TestFlush() == 1 + sizeof(otherFlags) / sizeof(*otherFlags));
+
+    // a smaller window is kept
+    _TestReset();
+    _TestSend(0, 1, 1000, 500, 1, 0);
+    _TestSend(0, 1, 2000, 400, 2, 0);
+    HOST_TEST_CHECK(_TestFlush() == 2);
+
+    // data sent in between: different sequence number
+    _TestReset();
+    _TestSend(0, 1, 1000, 500, 1, 0);
+    _TestSend(0, 11, 2000, 500, 2, 0);
+    HOST_TEST_CHECK(_TestFlush() == 2);
+
+    // other connections are untouched
+    _TestReset();
+    _TestSend(0, 1, 1000, 500, 1, 0);
+    _TestSend(1, 1, 2000, 500, 2, 0);
+    HOST_TEST_CHECK(_TestFlush() == 2);
+
+    // older timestamp and timestamp mismatch
+    _TestReset();
+    _TestSend(0, 1, 1000, 500, 10, 0);
+    _TestSend(0, 1, 2000, 500, 9, 0);
+    _TestSend(0, 1, 3000, 500, 0, TEST_F_NO_TS);
+    HOST_TEST_CHECK(_TestFlush() == 3);
+
+    // the ack number wraps around; an older one across the wrap is kept
+    _TestReset();
+    _TestSend(0, 1, 0xfffffc00u, 500, 1, 0);
+    _TestSend(0, 1, 0x200, 500, 2, 0);
+    _TestSend(0, 1, 0xfffffe00u, 500, 3, 0);
+    HOST_TEST_CHECK(_TestFlush() == 2 && testSentIds[0] == 1 && testSentIds[1] == 2);
+
+    // the frames are sent in order
+    for(ix = 1; ix < testNSent; ix++)
+    {
+        HOST_TEST_CHECK(testSentIds[ix] > testSentIds[ix - 1]);
+    }
+}
+
+// random flows, MAC taking frames at random
+// a frame that did not reach the MAC must be a pure ACK
+// superseded by a later pure ACK of the same flow
+static void _TestRandom(void)
+{
+    int run, ix, jx, flow, flags;
+    int nFiltered = 0;
+    uint32_t seq[4], ack[4], tsVal[4];
+    uint16_t window[4];
+
+    srand(12345);
+    for(run = 0; run < TEST_RANDOM_RUNS; run++)
+    {
+        _TestReset();
+        for(ix = 0; ix < 4; ix++)
+        {
+            seq[ix] = rand();
+            ack[ix] = rand();
+            tsVal[ix] = rand();
+            window[ix] = 1000;
+        }
+
+        for(ix = 0; ix < TEST_RANDOM_FRAMES; ix++)
+        {
+            int r = rand() % 100;
+            flow = rand() % 4;
+            flags = 0;
+            if(r < 50)
+            {   // new data acknowledged
+                ack[flow] += 1 + rand() % 3000;
+            }
+            else if(r < 60)
+            {   // duplicate
+            }
+            else if(r < 65)
+            {
+                flags = TEST_F_SACK;
+            }
+            else if(r < 70)
+            {
+                flags = TEST_F_DATA;
+            }
+            else if(r < 75)
+            {
+                window[flow] -= rand() % 100;
+            }
+            else if(r < 80)
+            {
+                window[flow] += rand() % 100;
+            }
+            else
+            {
+                ack[flow] += 1;
+            }
+            tsVal[flow] += rand() % 3;
+
+            _TestSend(flow, seq[flow], ack[flow], window[flow], tsVal[flow], flags);
+            if(flags == TEST_F_DATA)
+            {
+                seq[flow] += 10;
+            }
+
+            if(rand() % 4 == 0 || TCPIP_Helper_SingleListCount(bridgeDcpt.txBacklog + 1) >= TEST_RANDOM_HELD)
+            {
+                _TestTakeOne();
+            }
+        }
+        _TestFlush();
+
+        for(ix = 0; ix < testNFrames; ix++)
+        {
+            const TEST_FRAME* pDrop = testFrames + ix;
+            if(pDrop->sent)
+            {
+                continue;
+            }
+
+            nFiltered++;
+            HOST_TEST_CHECK(pDrop->pure);
+            for(jx = ix + 1; jx < testNFrames; jx++)
+            {
+                const TEST_FRAME* pNew = testFrames + jx;
+                if(pNew->flow == pDrop->flow && pNew->pure && pNew->seq == pDrop->seq &&
+                        (int32_t)(pNew->ack - pDrop->ack) > 0 && pNew->window >= pDrop->window)
+                {
+                    break;
+                }
+            }
+            HOST_TEST_CHECK(jx != testNFrames);
+        }
+    }
+    HOST_TEST_CHECK(nFiltered != 0);
+}
+
+int main(void)
+{
+    int ix;
+    TCPIP_STACK_HEAP_HANDLE heapH = HOST_TEST_HeapCreate();
+    HOST_TEST_CHECK(heapH != 0 && TCPIP_PKT_Initialize(heapH, 0, 0));
+
+    for(ix = 0; ix < TEST_NETS; ix++)
+    {
+        testNetIf[ix].netMACAddr = testHostMac[ix];
+        testNetIf[ix].linkMtu = TCPIP_MAC_LINK_MTU_DEFAULT;
+        testNetIf[ix].Flags.bInterfaceEnabled = 1;
+    }
+
+    // interface index table, as initialization.c builds it
+    const TCPIP_MAC_BRIDGE_ENTRY_BIN bridgeTable[TEST_NETS] =
+    {
+        {.ifIx = 0},
+        {.ifIx = 1},
+    };
+    const TCPIP_MAC_BRIDGE_CONFIG bridgeConfig =
+    {
+        .purgeTimeout = 60,
+        .transitDelay = 10,
+        .fdbEntries = 16,
+        .pktPoolSize = TCPIP_MAC_BRIDGE_TX_BACKLOG + 8,
+        .pktSize = 1536,
+        .dcptPoolSize = TCPIP_MAC_BRIDGE_TX_BACKLOG + 8,
+        .pktReplenish = 2,
+        .dcptReplenish = 4,
+        .bridgeFlags = TCPIP_MAC_BRIDGE_FLAG_IF_IX_TABLE,
+        .bridgeTableSize = TEST_NETS,
+        .bridgeTable = (const TCPIP_MAC_BRIDGE_ENTRY*)bridgeTable,
+    };
+    TCPIP_STACK_MODULE_CTRL stackCtrl =
+    {
+        .memH = heapH,
+        .stackAction = TCPIP_STACK_ACTION_INIT,
+    };
+
+    HOST_TEST_TimeAdvance(1000);
+    HOST_TEST_CHECK(TCPIP_MAC_Bridge_Initialize(&stackCtrl, &bridgeConfig));
+    TCPIP_MAC_Bridge_Task();
+    HOST_TEST_CHECK(TCPIP_MAC_Bridge_Status(TCPIP_MAC_Bridge_Open(0)) == SYS_STATUS_READY);
+
+    // learn A and B
+    for(ix = 0; ix < TEST_NETS; ix++)
+    {
+        _TestRxProcess(_TestRxPacket(ix, 1 - ix));
+        _TestTxDone();
+    }
+    testNSent = 0;
+
+    _TestParse();
+    _TestCases();
+    _TestRandom();
+
+    // all the received frames returned, the held copies back in the pool
+    HOST_TEST_CHECK(testRxAcks == testRxFrames);
+    HOST_TEST_CHECK(TCPIP_Helper_SingleListCount(&bridgeDcpt.pktPool) >= bridgeConfig.pktPoolSize);
+
+    return HOST_TEST_Result("bridge_ack_filter");
+}
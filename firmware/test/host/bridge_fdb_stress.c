@@ -0,0 +1,421 @@
+/*******************************************************************************
+  MAC bridge FDB lock free readers stress test
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    bridge_fdb_stress.c
+
+  Summary:
+    Concurrent FDB readers against the bridge forwarding path
+
+  Description:
+    A writer thread plays the stack task: it passes frames through
+    TCPIP_MAC_Bridge_ProcessPacket() and runs TCPIP_MAC_Bridge_Task().
+    The stations come and go in phases so that the FDB grows, ages and shrinks
+    while the entries are inserted, shifted by the Robin Hood removal and
+    migrated by the incremental resize.
+    Reader threads use the lock free FDB API at the same time:
+    TCPIP_MAC_Bridge_FDBIndexRead(), TCPIP_MAC_Bridge_FDBExport(),
+    TCPIP_MAC_Bridge_FDBTopGet() and TCPIP_MAC_Bridge_WarmSnapshot().
+
+    Every station MAC address carries a check pattern and the station
+    is always learnt on the port given by its address;
+    a torn copy or a read from a freed (poisoned) table breaks the pattern.
+*******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+//DOM-IGNORE-END
+
+#include <pthread.h>
+
+#include "host_test.h"
+
+// the module under test, for access to its internal state
+#include "tcpip/src/tcpip_mac_bridge.c"
+
+#if (_TCPIP_MAC_BRIDGE_FDB_RESIZE == 0) || (_TCPIP_MAC_BRIDGE_ENTRY_COUNTERS == 0) || (_TCPIP_MAC_BRIDGE_WARM_START == 0)
+#error "the test needs TCPIP_MAC_BRIDGE_FDB_MAX_ENTRIES, TCPIP_MAC_BRIDGE_ENTRY_COUNTERS and TCPIP_MAC_BRIDGE_WARM_START"
+#endif
+
+#define TEST_NETS               2
+#define TEST_STATIONS           48      // all active: the FDB grows to TCPIP_MAC_BRIDGE_FDB_MAX_ENTRIES
+#define TEST_FEW_STATIONS       4       // the others age out: the FDB shrinks back
+#define TEST_FDB_ENTRIES        16
+#define TEST_PURGE_TMO          3       // seconds
+#define TEST_FRAMES             400000
+#define TEST_PHASE_FRAMES       20000
+#define TEST_FRAME_MS           1       // virtual time per frame
+#define TEST_TASK_FRAMES        32      // bridge task run rate
+#define TEST_READERS            3
+#define TEST_TX_QUEUE           64
+
+static TCPIP_NET_IF testNetIf[TEST_NETS];
+static const TCPIP_MAC_ADDR testHostMac[TEST_NETS] =
+{
+    {{0x00, 0x04, 0xa3, 0x00, 0x00, 0x01}},
+    {{0x00, 0x04, 0xa3, 0x00, 0x00, 0x02}},
+};
+
+static TCPIP_MAC_PACKET* testTxQueue[TEST_TX_QUEUE];
+static int testTxCount;
+static int testRxAcks;
+
+static volatile int testWriterDone;
+static size_t testMinBuckets = ~0, testMaxBuckets;
+
+typedef struct
+{
+    int         readerIx;
+    unsigned    nReads;     // consistent reads
+    unsigned    nBusy;      // TCPIP_MAC_BRIDGE_RES_LOCK_ERROR: too much update activity
+}TEST_READER;
+
+// stack services used by the bridge
+
+TCPIP_NET_HANDLE TCPIP_STACK_IndexToNet(int netIx)
+{
+    return netIx >= 0 && netIx < TEST_NETS ? testNetIf + netIx : 0;
+}
+
+int TCPIP_STACK_NetIxGet(const TCPIP_NET_IF* pNetIf)
+{
+    return pNetIf != 0 ? pNetIf - testNetIf : -1;
+}
+
+int TCPIP_STACK_NumberOfNetworksGet(void)
+{
+    return TEST_NETS;
+}
+
+TCPIP_NET_HANDLE TCPIP_STACK_NetHandleGet(const char* interface)
+{
+    return 0;
+}
+
+SYS_MODULE_OBJ TCPIP_STACK_Initialize(const SYS_MODULE_INDEX index, const SYS_MODULE_INIT * const init)
+{
+    return (SYS_MODULE_OBJ)testNetIf;
+}
+
+SYS_STATUS TCPIP_STACK_Status(SYS_MODULE_OBJ object)
+{
+    return SYS_STATUS_READY;
+}
+
+tcpipSignalHandle _TCPIPStackSignalHandlerRegister(TCPIP_STACK_MODULE modId, tcpipModuleSignalHandler signalHandler, int16_t asyncTmoMs)
+{
+    return (tcpipSignalHandle)testNetIf;
+}
+
+bool _TCPIPStackSignalHandlerSetParams(TCPIP_STACK_MODULE modId, tcpipSignalHandle handle, int16_t asyncTmoMs)
+{
+    return true;
+}
+
+void _TCPIPStackSignalHandlerDeregister(tcpipSignalHandle handle)
+{
+}
+
+// the MAC: frames are acknowledged after the bridge returns, as the TX interrupt would
+TCPIP_MAC_RES _TCPIPStackPacketTx(TCPIP_NET_IF* pNetIf, TCPIP_MAC_PACKET * ptrPacket)
+{
+    if(testTxCount == TEST_TX_QUEUE)
+    {
+        return TCPIP_MAC_RES_QUEUE_TX_FULL;
+    }
+
+    testTxQueue[testTxCount++] = ptrPacket;
+    return TCPIP_MAC_RES_OK;
+}
+
+static void _TestTxDone(void)
+{
+    while(testTxCount != 0)
+    {
+        TCPIP_MAC_PACKET* pPkt = testTxQueue[--testTxCount];
+        pPkt->ackRes = TCPIP_MAC_PKT_ACK_TX_OK;
+        (*pPkt->ackFunc)(pPkt, pPkt->ackParam);
+    }
+}
+
+static void _TestRxAck(TCPIP_MAC_PACKET* pPkt, const void* param)
+{
+    testRxAcks++;
+}
+
+// station addresses: 02:42:hi:lo:hi^5a:lo^a5, learnt on port (lo & 1)
+static void _TestStationMac(int station, TCPIP_MAC_ADDR* pAdd)
+{
+    pAdd->v[0] = 0x02;
+    pAdd->v[1] = 0x42;
+    pAdd->v[2] = (uint8_t)(station >> 8);
+    pAdd->v[3] = (uint8_t)station;
+    pAdd->v[4] = pAdd->v[2] ^ 0x5a;
+    pAdd->v[5] = pAdd->v[3] ^ 0xa5;
+}
+
+static bool _TestEntryValid(const TCPIP_MAC_FDB_ENTRY* pEntry)
+{
+    const uint8_t* v = pEntry->destAdd.v;
+
+    if((pEntry->flags & TCPIP_MAC_FDB_FLAG_HOST) != 0)
+    {
+        return pEntry->flags == (TCPIP_MAC_FDB_FLAG_STATIC | TCPIP_MAC_FDB_FLAG_HOST) &&
+            (memcmp(v, testHostMac[0].v, sizeof(testHostMac[0])) == 0 || memcmp(v, testHostMac[1].v, sizeof(testHostMac[1])) == 0);
+    }
+
+    return pEntry->flags == TCPIP_MAC_FDB_FLAG_PORT_VALID && v[0] == 0x02 && v[1] == 0x42 && v[4] == (v[2] ^ 0x5a) && v[5] == (v[3] ^ 0xa5)
+        && ((v[2] << 8) | v[3]) < TEST_STATIONS && pEntry->learnPort == (v[3] & 1) && pEntry->vlanId == 0;
+}
+
+static void* _TestReader(void* param)
+{
+    TEST_READER* pReader = (TEST_READER*)param;
+    TCPIP_MAC_BRIDGE_HANDLE brH = TCPIP_MAC_Bridge_Open(0);
+    TCPIP_MAC_FDB_ENTRY entries[TCPIP_MAC_BRIDGE_FDB_MAX_ENTRIES + 1];
+    TCPIP_MAC_BRIDGE_RESULT res;
+    size_t ix, jx, nEntries;
+
+    while(!testWriterDone)
+    {
+        switch(pReader->readerIx)
+        {
+            case 0:
+                // walk the FDB by index
+                for(ix = 0; ix <= TCPIP_MAC_BRIDGE_FDB_MAX_ENTRIES; ix++)
+                {
+                    res = TCPIP_MAC_Bridge_FDBIndexRead(brH, ix, entries);
+                    if(res == TCPIP_MAC_BRIDGE_RES_INDEX_ERROR)
+                    {
+                        break;
+                    }
+                    if(res == TCPIP_MAC_BRIDGE_RES_LOCK_ERROR)
+                    {
+                        pReader->nBusy++;
+                        continue;
+                    }
+                    HOST_TEST_CHECK(res == TCPIP_MAC_BRIDGE_RES_OK || res == TCPIP_MAC_BRIDGE_RES_INDEX_NO_ENTRY);
+                    if(res == TCPIP_MAC_BRIDGE_RES_OK)
+                    {
+                        HOST_TEST_CHECK(_TestEntryValid(entries));
+                        pReader->nReads++;
+                    }
+                }
+                break;
+
+            case 1:
+                // the whole FDB: one snapshot, no station twice
+                res = TCPIP_MAC_Bridge_FDBExport(brH, entries, sizeof(entries) / sizeof(*entries), &nEntries);
+                if(res == TCPIP_MAC_BRIDGE_RES_LOCK_ERROR)
+                {
+                    pReader->nBusy++;
+                    break;
+                }
+                HOST_TEST_CHECK(res == TCPIP_MAC_BRIDGE_RES_OK);
+                HOST_TEST_CHECK(nEntries <= TEST_STATIONS + TEST_NETS);
+                for(ix = 0; ix < nEntries; ix++)
+                {
+                    HOST_TEST_CHECK(_TestEntryValid(entries + ix));
+                    for(jx = ix + 1; jx < nEntries; jx++)
+                    {
+                        HOST_TEST_CHECK(memcmp(entries[ix].destAdd.v, entries[jx].destAdd.v, sizeof(entries[ix].destAdd)) != 0);
+                    }
+                }
+                pReader->nReads++;
+                break;
+
+            default:
+                // top talkers, sorted
+                res = TCPIP_MAC_Bridge_FDBTopGet(brH, TCPIP_MAC_BRIDGE_TOP_KEY_RX_PACKETS, entries, 8, &nEntries);
+                if(res == TCPIP_MAC_BRIDGE_RES_LOCK_ERROR)
+                {
+                    pReader->nBusy++;
+                }
+                else
+                {
+                    HOST_TEST_CHECK(res == TCPIP_MAC_BRIDGE_RES_OK && nEntries <= 8);
+                    for(ix = 0; ix < nEntries; ix++)
+                    {
+                        HOST_TEST_CHECK(_TestEntryValid(entries + ix));
+                        HOST_TEST_CHECK(ix == 0 || entries[ix - 1].rxPackets >= entries[ix].rxPackets);
+                    }
+                    pReader->nReads++;
+                }
+
+                // warm start snapshot, checked while no one else writes it
+                res = TCPIP_MAC_Bridge_WarmSnapshot(brH);
+                HOST_TEST_CHECK(res == TCPIP_MAC_BRIDGE_RES_OK || res == TCPIP_MAC_BRIDGE_RES_LOCK_ERROR);
+                if(_MAC_Bridge_WarmClaim(&bridgeDcpt))
+                {
+                    const MAC_BRIDGE_WARM_SNAPSHOT* pSnap = &bridgeWarmSnap;
+                    if(pSnap->magic == MAC_BRIDGE_WARM_MAGIC)
+                    {
+                        HOST_TEST_CHECK(pSnap->checksum == _MAC_Bridge_WarmChecksum(pSnap));
+                        HOST_TEST_CHECK(pSnap->nEntries <= TEST_STATIONS);
+                        for(ix = 0; ix < pSnap->nEntries; ix++)
+                        {
+                            TCPIP_MAC_FDB_ENTRY warmEntry = {0};
+                            warmEntry.destAdd = pSnap->entries[ix].destAdd;
+                            warmEntry.flags = TCPIP_MAC_FDB_FLAG_PORT_VALID;
+                            warmEntry.learnPort = pSnap->entries[ix].learnPort;
+                            warmEntry.vlanId = pSnap->entries[ix].vlanId;
+                            HOST_TEST_CHECK(_TestEntryValid(&warmEntry));
+                        }
+                    }
+                    _MAC_Bridge_WarmRelease(&bridgeDcpt);
+                }
+                break;
+        }
+    }
+
+    return 0;
+}
+
+// plays the stack task: received frames and the bridge timeout
+static void* _TestWriter(void* param)
+{
+    int frame, station, nStations;
+    TCPIP_MAC_ADDR dstAdd;
+    TCPIP_MAC_PACKET* pRxPkt = TCPIP_PKT_PacketAlloc(sizeof(TCPIP_MAC_PACKET), 64, 0);
+    TCPIP_MAC_ETHERNET_HEADER* pMacHdr = (TCPIP_MAC_ETHERNET_HEADER*)pRxPkt->pMacLayer;
+
+    for(frame = 0; frame < TEST_FRAMES; frame++)
+    {
+        nStations = (frame / TEST_PHASE_FRAMES) % 2 == 0 ? TEST_STATIONS : TEST_FEW_STATIONS;
+        station = (frame * 7) % nStations;
+        _TestStationMac(station, &pMacHdr->SourceMACAddr);
+        _TestStationMac((station * 5 + 3) % TEST_STATIONS, &dstAdd);
+        pMacHdr->DestMACAddr = dstAdd;
+        pMacHdr->Type = TCPIP_Helper_htons(0x0800);
+
+        // as received from the MAC driver
+        pRxPkt->pktIf = testNetIf + (station & 1);
+        pRxPkt->pNetLayer = pRxPkt->pMacLayer + sizeof(TCPIP_MAC_ETHERNET_HEADER);
+        pRxPkt->pDSeg->segLen = 46;
+        pRxPkt->ackFunc = _TestRxAck;
+        pRxPkt->ackParam = 0;
+
+        int nAcks = testRxAcks;
+        TCPIP_MAC_BRIDGE_PKT_RES pktRes = TCPIP_MAC_Bridge_ProcessPacket(pRxPkt);
+        _TestTxDone();
+        if(pktRes == TCPIP_MAC_BRIDGE_PKT_RES_HOST_PROCESS)
+        {   // the host is done with it
+            pRxPkt->ackFunc(pRxPkt, pRxPkt->ackParam);
+        }
+        // the bridge returned the frame to its owner
+        HOST_TEST_CHECK(testRxAcks == nAcks + 1);
+
+        HOST_TEST_TimeAdvance(TEST_FRAME_MS);
+        if(frame % TEST_TASK_FRAMES == 0)
+        {
+            TCPIP_MAC_Bridge_Task();
+            size_t nBuckets = bridgeDcpt.hashDcpt->hEntries;
+            testMinBuckets = nBuckets < testMinBuckets ? nBuckets : testMinBuckets;
+            testMaxBuckets = nBuckets > testMaxBuckets ? nBuckets : testMaxBuckets;
+        }
+    }
+
+    TCPIP_PKT_PacketFree(pRxPkt);
+    testWriterDone = 1;
+    return 0;
+}
+
+int main(void)
+{
+    int ix;
+    pthread_t writer, readers[TEST_READERS];
+    TEST_READER readerDcpt[TEST_READERS];
+    TCPIP_STACK_HEAP_HANDLE heapH = HOST_TEST_HeapCreate();
+    HOST_TEST_CHECK(heapH != 0 && TCPIP_PKT_Initialize(heapH, 0, 0));
+
+    for(ix = 0; ix < TEST_NETS; ix++)
+    {
+        testNetIf[ix].netMACAddr = testHostMac[ix];
+        testNetIf[ix].linkMtu = TCPIP_MAC_LINK_MTU_DEFAULT;
+        testNetIf[ix].Flags.bInterfaceEnabled = 1;
+    }
+
+    // interface index table, as initialization.c builds it
+    const TCPIP_MAC_BRIDGE_ENTRY_BIN bridgeTable[TEST_NETS] =
+    {
+        {.ifIx = 0},
+        {.ifIx = 1},
+    };
+    const TCPIP_MAC_BRIDGE_CONFIG bridgeConfig =
+    {
+        .purgeTimeout = TEST_PURGE_TMO,
+        .transitDelay = 1,
+        .fdbEntries = TEST_FDB_ENTRIES,
+        .pktPoolSize = 8,
+        .pktSize = 1536,
+        .dcptPoolSize = 16,
+        .pktReplenish = 2,
+        .dcptReplenish = 4,
+        .bridgeFlags = TCPIP_MAC_BRIDGE_FLAG_IF_IX_TABLE,
+        .bridgeTableSize = TEST_NETS,
+        .bridgeTable = (const TCPIP_MAC_BRIDGE_ENTRY*)bridgeTable,
+    };
+    TCPIP_STACK_MODULE_CTRL stackCtrl =
+    {
+        .memH = heapH,
+        .stackAction = TCPIP_STACK_ACTION_INIT,
+    };
+
+    HOST_TEST_TimeAdvance(1000);
+    HOST_TEST_CHECK(TCPIP_MAC_Bridge_Initialize(&stackCtrl, &bridgeConfig));
+    TCPIP_MAC_Bridge_Task();
+    HOST_TEST_CHECK(TCPIP_MAC_Bridge_Status(TCPIP_MAC_Bridge_Open(0)) == SYS_STATUS_READY);
+
+    testWriterDone = 0;
+    for(ix = 0; ix < TEST_READERS; ix++)
+    {
+        readerDcpt[ix] = (TEST_READER){.readerIx = ix};
+        pthread_create(readers + ix, 0, _TestReader, readerDcpt + ix);
+    }
+    pthread_create(&writer, 0, _TestWriter, 0);
+
+    pthread_join(writer, 0);
+    for(ix = 0; ix < TEST_READERS; ix++)
+    {
+        pthread_join(readers[ix], 0);
+        printf("reader %d: %u consistent reads, %u busy\n", ix, readerDcpt[ix].nReads, readerDcpt[ix].nBusy);
+        HOST_TEST_CHECK(readerDcpt[ix].nReads != 0);
+    }
+    printf("FDB buckets: %zu - %zu\n", testMinBuckets, testMaxBuckets);
+
+    // the FDB has been resized both ways under the readers
+    HOST_TEST_CHECK(testMaxBuckets > TEST_FDB_ENTRIES + 1);
+    HOST_TEST_CHECK(testMinBuckets == TEST_FDB_ENTRIES + 1);
+
+    // no reader left counted, the retired table is released by the next task run
+    HOST_TEST_CHECK(bridgeDcpt.fdbReaders == 0);
+    TCPIP_MAC_Bridge_Task();
+    HOST_TEST_CHECK(bridgeDcpt.pFdbRetired == 0);
+
+    return HOST_TEST_Result("bridge_fdb_stress");
+}
@@ -0,0 +1,241 @@
+/*******************************************************************************
+  Host test heap implementation file
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    host_heap.c
+
+  Summary:
+    TCP/IP heap object for the host tests
+
+  Description:
+    The stack converts pointers to 32 bit values (cache alignment, KVA checks),
+    so the blocks are allocated from an arena mapped below 4 GB.
+    The freed blocks are poisoned: a module reading a block after freeing it
+    sees HOST_TEST_HEAP_POISON instead of plausible data.
+*******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+//DOM-IGNORE-END
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "host_test.h"
+#include "tcpip/src/tcpip_heap_alloc.h"
+
+#define HOST_HEAP_ARENA_SIZE    (64 * 1024 * 1024)
+#define HOST_HEAP_UNIT          16
+#define HOST_HEAP_CLASSES       4096    // exact size free lists, up to 64 KB blocks
+
+typedef struct _tag_HOST_HEAP_BLOCK
+{
+    struct _tag_HOST_HEAP_BLOCK* next;  // valid while free
+    size_t  size;                       // data size, multiple of HOST_HEAP_UNIT
+}HOST_HEAP_BLOCK;
+
+static uint8_t*         heapArena;
+static size_t           heapUsed;
+static HOST_HEAP_BLOCK* heapFree[HOST_HEAP_CLASSES];
+static int              heapBlocks;
+static size_t           heapBytes;          // allocated, in blocks
+static size_t           heapPeak;
+static size_t           heapLimit;          // 0 if none
+static pthread_mutex_t  heapMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void* _HostHeapMalloc(TCPIP_STACK_HEAP_HANDLE heapH, size_t nBytes)
+{
+    HOST_HEAP_BLOCK* pBlk = 0;
+    size_t size = ((nBytes + HOST_HEAP_UNIT - 1) / HOST_HEAP_UNIT) * HOST_HEAP_UNIT;
+    size_t sizeClass = size / HOST_HEAP_UNIT;
+
+    if(size == 0 || sizeClass >= HOST_HEAP_CLASSES)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&heapMutex);
+    if(heapLimit != 0 && heapBytes + size > heapLimit)
+    {
+        pBlk = 0;
+    }
+    else if(heapFree[sizeClass] != 0)
+    {
+        pBlk = heapFree[sizeClass];
+        heapFree[sizeClass] = pBlk->next;
+    }
+    else if(heapUsed + sizeof(HOST_HEAP_BLOCK) + size <= HOST_HEAP_ARENA_SIZE)
+    {
+        pBlk = (HOST_HEAP_BLOCK*)(heapArena + heapUsed);
+        pBlk->size = size;
+        heapUsed += sizeof(HOST_HEAP_BLOCK) + size;
+    }
+
+    if(pBlk != 0)
+    {
+        pBlk->next = 0;
+        heapBlocks++;
+        heapBytes += size;
+        if(heapBytes > heapPeak)
+        {
+            heapPeak = heapBytes;
+        }
+    }
+    pthread_mutex_unlock(&heapMutex);
+
+    return pBlk != 0 ? pBlk + 1 : 0;
+}
+
+static void* _HostHeapCalloc(TCPIP_STACK_HEAP_HANDLE heapH, size_t nElems, size_t elemSize)
+{
+    void* ptr = _HostHeapMalloc(heapH, nElems * elemSize);
+    if(ptr != 0)
+    {
+        memset(ptr, 0, nElems * elemSize);
+    }
+    return ptr;
+}
+
+static size_t _HostHeapFree(TCPIP_STACK_HEAP_HANDLE heapH, const void* pBuff)
+{
+    if(pBuff == 0)
+    {
+        return 0;
+    }
+
+    HOST_HEAP_BLOCK* pBlk = (HOST_HEAP_BLOCK*)pBuff - 1;
+    size_t size = pBlk->size;
+    memset(pBlk + 1, HOST_TEST_HEAP_POISON, size);
+
+    pthread_mutex_lock(&heapMutex);
+    pBlk->next = heapFree[size / HOST_HEAP_UNIT];
+    heapFree[size / HOST_HEAP_UNIT] = pBlk;
+    heapBlocks--;
+    heapBytes -= size;
+    pthread_mutex_unlock(&heapMutex);
+
+    return size;
+}
+
+static size_t _HostHeapSize(TCPIP_STACK_HEAP_HANDLE heapH)
+{
+    return HOST_HEAP_ARENA_SIZE;
+}
+
+static size_t _HostHeapFreeSize(TCPIP_STACK_HEAP_HANDLE heapH)
+{
+    return heapLimit != 0 ? heapLimit - heapBytes : HOST_HEAP_ARENA_SIZE - heapUsed;
+}
+
+static TCPIP_STACK_HEAP_RES _HostHeapLastError(TCPIP_STACK_HEAP_HANDLE heapH)
+{
+    return TCPIP_STACK_HEAP_RES_OK;
+}
+
+static const TCPIP_HEAP_OBJECT hostHeapObject =
+{
+    .TCPIP_HEAP_Malloc = _HostHeapMalloc,
+    .TCPIP_HEAP_Calloc = _HostHeapCalloc,
+    .TCPIP_HEAP_Free = _HostHeapFree,
+    .TCPIP_HEAP_Size = _HostHeapSize,
+    .TCPIP_HEAP_MaxSize = _HostHeapFreeSize,
+    .TCPIP_HEAP_FreeSize = _HostHeapFreeSize,
+    .TCPIP_HEAP_HighWatermark = _HostHeapSize,
+    .TCPIP_HEAP_LastError = _HostHeapLastError,
+};
+
+TCPIP_STACK_HEAP_HANDLE HOST_TEST_HeapCreate(void)
+{
+    if(heapArena == 0)
+    {
+        void* pArena = mmap(0, HOST_HEAP_ARENA_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+        if(pArena == MAP_FAILED)
+        {
+            return 0;
+        }
+        heapArena = (uint8_t*)pArena;
+    }
+
+    return &hostHeapObject;
+}
+
+int HOST_TEST_HeapBlocks(void)
+{
+    pthread_mutex_lock(&heapMutex);
+    int nBlocks = heapBlocks;
+    pthread_mutex_unlock(&heapMutex);
+
+    return nBlocks;
+}
+
+size_t HOST_TEST_HeapBytes(void)
+{
+    pthread_mutex_lock(&heapMutex);
+    size_t nBytes = heapBytes;
+    pthread_mutex_unlock(&heapMutex);
+
+    return nBytes;
+}
+
+size_t HOST_TEST_HeapPeak(bool reset)
+{
+    pthread_mutex_lock(&heapMutex);
+    size_t nBytes = heapPeak;
+    if(reset)
+    {
+        heapPeak = heapBytes;
+    }
+    pthread_mutex_unlock(&heapMutex);
+
+    return nBytes;
+}
+
+void HOST_TEST_HeapLimitSet(size_t nBytes)
+{
+    pthread_mutex_lock(&heapMutex);
+    heapLimit = nBytes;
+    pthread_mutex_unlock(&heapMutex);
+}
+
+// out of line versions, for the modules that call them directly
+void* TCPIP_HEAP_MallocOutline(TCPIP_STACK_HEAP_HANDLE heapH, size_t nBytes)
+{
+    return _HostHeapMalloc(heapH, nBytes);
+}
+
+void* TCPIP_HEAP_CallocOutline(TCPIP_STACK_HEAP_HANDLE heapH, size_t nElems, size_t elemSize)
+{
+    return _HostHeapCalloc(heapH, nElems, elemSize);
+}
+
+size_t TCPIP_HEAP_FreeOutline(TCPIP_STACK_HEAP_HANDLE heapH, const void* ptr)
+{
+    return _HostHeapFree(heapH, ptr);
+}
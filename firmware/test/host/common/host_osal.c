@@ -0,0 +1,240 @@
+/*******************************************************************************
+  Host test OSAL implementation file
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    host_osal.c
+
+  Summary:
+    OSAL on top of pthreads
+
+  Description:
+    Implements the FreeRTOS OSAL API for the host tests.
+    The critical sections are a single recursive mutex:
+    on the target they exclude the other tasks, so does the mutex for the test threads.
+*******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+//DOM-IGNORE-END
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+
+#include "osal/osal.h"
+
+typedef struct
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond;
+    int             count;
+    int             maxCount;
+}HOST_OSAL_SEM;
+
+static pthread_mutex_t critMutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+
+OSAL_CRITSECT_DATA_TYPE OSAL_CRIT_Enter(OSAL_CRIT_TYPE severity)
+{
+    pthread_mutex_lock(&critMutex);
+    return 0;
+}
+
+void OSAL_CRIT_Leave(OSAL_CRIT_TYPE severity, OSAL_CRITSECT_DATA_TYPE status)
+{
+    pthread_mutex_unlock(&critMutex);
+}
+
+OSAL_RESULT OSAL_SEM_Create(OSAL_SEM_HANDLE_TYPE* semID, OSAL_SEM_TYPE type, uint8_t maxCount, uint8_t initialCount)
+{
+    HOST_OSAL_SEM* pSem = (HOST_OSAL_SEM*)calloc(1, sizeof(*pSem));
+    if(pSem == 0)
+    {
+        return OSAL_RESULT_FALSE;
+    }
+
+    pthread_mutex_init(&pSem->mutex, 0);
+    pthread_cond_init(&pSem->cond, 0);
+    pSem->maxCount = type == OSAL_SEM_TYPE_BINARY ? 1 : maxCount;
+    pSem->count = initialCount;
+    *semID = (OSAL_SEM_HANDLE_TYPE)pSem;
+    return OSAL_RESULT_TRUE;
+}
+
+OSAL_RESULT OSAL_SEM_Delete(OSAL_SEM_HANDLE_TYPE* semID)
+{
+    HOST_OSAL_SEM* pSem = (HOST_OSAL_SEM*)*semID;
+    if(pSem != 0)
+    {
+        pthread_cond_destroy(&pSem->cond);
+        pthread_mutex_destroy(&pSem->mutex);
+        free(pSem);
+        *semID = 0;
+    }
+    return OSAL_RESULT_TRUE;
+}
+
+OSAL_RESULT OSAL_SEM_Pend(OSAL_SEM_HANDLE_TYPE* semID, uint16_t waitMS)
+{
+    HOST_OSAL_SEM* pSem = (HOST_OSAL_SEM*)*semID;
+    OSAL_RESULT res = OSAL_RESULT_TRUE;
+    struct timespec tEnd;
+
+    if(waitMS != OSAL_WAIT_FOREVER)
+    {
+        clock_gettime(CLOCK_REALTIME, &tEnd);
+        tEnd.tv_sec += waitMS / 1000;
+        tEnd.tv_nsec += (long)(waitMS % 1000) * 1000000;
+        if(tEnd.tv_nsec >= 1000000000)
+        {
+            tEnd.tv_sec++;
+            tEnd.tv_nsec -= 1000000000;
+        }
+    }
+
+    pthread_mutex_lock(&pSem->mutex);
+    while(pSem->count == 0)
+    {
+        if(waitMS == OSAL_WAIT_FOREVER)
+        {
+            pthread_cond_wait(&pSem->cond, &pSem->mutex);
+        }
+        else if(waitMS == 0 || pthread_cond_timedwait(&pSem->cond, &pSem->mutex, &tEnd) == ETIMEDOUT)
+        {
+            res = OSAL_RESULT_FALSE;
+            break;
+        }
+    }
+
+    if(res == OSAL_RESULT_TRUE)
+    {
+        pSem->count--;
+    }
+    pthread_mutex_unlock(&pSem->mutex);
+
+    return res;
+}
+
+OSAL_RESULT OSAL_SEM_Post(OSAL_SEM_HANDLE_TYPE* semID)
+{
+    HOST_OSAL_SEM* pSem = (HOST_OSAL_SEM*)*semID;
+
+    pthread_mutex_lock(&pSem->mutex);
+    if(pSem->count < pSem->maxCount)
+    {
+        pSem->count++;
+    }
+    pthread_cond_signal(&pSem->cond);
+    pthread_mutex_unlock(&pSem->mutex);
+
+    return OSAL_RESULT_TRUE;
+}
+
+OSAL_RESULT OSAL_SEM_PostISR(OSAL_SEM_HANDLE_TYPE* semID)
+{
+    return OSAL_SEM_Post(semID);
+}
+
+uint8_t OSAL_SEM_GetCount(OSAL_SEM_HANDLE_TYPE* semID)
+{
+    HOST_OSAL_SEM* pSem = (HOST_OSAL_SEM*)*semID;
+
+    pthread_mutex_lock(&pSem->mutex);
+    int count = pSem->count;
+    pthread_mutex_unlock(&pSem->mutex);
+
+    return (uint8_t)count;
+}
+
+OSAL_RESULT OSAL_MUTEX_Create(OSAL_MUTEX_HANDLE_TYPE* mutexID)
+{
+    pthread_mutex_t* pMutex = (pthread_mutex_t*)malloc(sizeof(*pMutex));
+    if(pMutex == 0)
+    {
+        return OSAL_RESULT_FALSE;
+    }
+
+    pthread_mutex_init(pMutex, 0);
+    *mutexID = (OSAL_MUTEX_HANDLE_TYPE)pMutex;
+    return OSAL_RESULT_TRUE;
+}
+
+OSAL_RESULT OSAL_MUTEX_Delete(OSAL_MUTEX_HANDLE_TYPE* mutexID)
+{
+    pthread_mutex_t* pMutex = (pthread_mutex_t*)*mutexID;
+    if(pMutex != 0)
+    {
+        pthread_mutex_destroy(pMutex);
+        free(pMutex);
+        *mutexID = 0;
+    }
+    return OSAL_RESULT_TRUE;
+}
+
+OSAL_RESULT OSAL_MUTEX_Lock(OSAL_MUTEX_HANDLE_TYPE* mutexID, uint16_t waitMS)
+{
+    pthread_mutex_t* pMutex = (pthread_mutex_t*)*mutexID;
+
+    if(waitMS == OSAL_WAIT_FOREVER)
+    {
+        return pthread_mutex_lock(pMutex) == 0 ? OSAL_RESULT_TRUE : OSAL_RESULT_FALSE;
+    }
+
+    struct timespec tEnd;
+    clock_gettime(CLOCK_REALTIME, &tEnd);
+    tEnd.tv_sec += waitMS / 1000;
+    tEnd.tv_nsec += (long)(waitMS % 1000) * 1000000;
+    if(tEnd.tv_nsec >= 1000000000)
+    {
+        tEnd.tv_sec++;
+        tEnd.tv_nsec -= 1000000000;
+    }
+    return pthread_mutex_timedlock(pMutex, &tEnd) == 0 ? OSAL_RESULT_TRUE : OSAL_RESULT_FALSE;
+}
+
+OSAL_RESULT OSAL_MUTEX_Unlock(OSAL_MUTEX_HANDLE_TYPE* mutexID)
+{
+    pthread_mutex_unlock((pthread_mutex_t*)*mutexID);
+    return OSAL_RESULT_TRUE;
+}
+
+void* OSAL_Malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void OSAL_Free(void* pData)
+{
+    free(pData);
+}
+
+OSAL_RESULT OSAL_Initialize(void)
+{
+    return OSAL_RESULT_TRUE;
+}
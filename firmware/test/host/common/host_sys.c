@@ -0,0 +1,130 @@
+/*******************************************************************************
+  Host test system services implementation file
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    host_sys.c
+
+  Summary:
+    Console, debug and time services for the host tests
+
+  Description:
+    SYS_TIME is a virtual clock moved by the test with HOST_TEST_TimeAdvance(),
+    so that the timeouts of the stack modules are reproducible.
+*******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+//DOM-IGNORE-END
+
+#include <stdarg.h>
+
+#include "host_test.h"
+#include "system/console/sys_console.h"
+#include "system/debug/sys_debug.h"
+#include "system/time/sys_time.h"
+
+static volatile uint64_t hostTimeCount;
+static volatile int hostTestFailures;
+static bool hostConsoleOn;
+
+void HOST_TEST_Fail(const char* file, int line, const char* expr)
+{
+    __sync_fetch_and_add(&hostTestFailures, 1);
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+}
+
+int HOST_TEST_Failures(void)
+{
+    return __sync_fetch_and_add(&hostTestFailures, 0);
+}
+
+int HOST_TEST_Result(const char* testName)
+{
+    int nFails = HOST_TEST_Failures();
+    printf("%s: %s (%d failed checks)\n", testName, nFails == 0 ? "PASS" : "FAIL", nFails);
+    return nFails == 0 ? 0 : 1;
+}
+
+void HOST_TEST_TimeAdvance(uint32_t ms)
+{
+    __sync_fetch_and_add(&hostTimeCount, (uint64_t)ms * (HOST_TEST_TIME_FREQ / 1000));
+}
+
+uint32_t HOST_TEST_TimeMs(void)
+{
+    return (uint32_t)(__sync_fetch_and_add(&hostTimeCount, 0) / (HOST_TEST_TIME_FREQ / 1000));
+}
+
+void HOST_TEST_ConsoleEnable(bool enable)
+{
+    hostConsoleOn = enable;
+}
+
+uint32_t SYS_TIME_FrequencyGet(void)
+{
+    return HOST_TEST_TIME_FREQ;
+}
+
+uint32_t SYS_TIME_CounterGet(void)
+{
+    return (uint32_t)__sync_fetch_and_add(&hostTimeCount, 0);
+}
+
+uint64_t SYS_TIME_Counter64Get(void)
+{
+    return __sync_fetch_and_add(&hostTimeCount, 0);
+}
+
+void SYS_CONSOLE_Print(const SYS_CONSOLE_HANDLE handle, const char* format, ...)
+{
+    if(hostConsoleOn)
+    {
+        va_list args;
+        va_start(args, format);
+        vprintf(format, args);
+        va_end(args);
+    }
+}
+
+void SYS_CONSOLE_Message(const SYS_CONSOLE_HANDLE handle, const char* message)
+{
+    if(hostConsoleOn)
+    {
+        fputs(message, stdout);
+    }
+}
+
+SYS_ERROR_LEVEL SYS_DEBUG_ErrorLevelGet(void)
+{
+    return SYS_ERROR_FATAL;
+}
+
+SYS_MODULE_INDEX SYS_DEBUG_ConsoleInstanceGet(void)
+{
+    return 0;
+}
@@ -0,0 +1,453 @@
+/*******************************************************************************
+  Host test TCP link implementation file
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    host_tcp.c
+
+  Summary:
+    Emulated IPv4 link between the TCP module and remote hosts
+
+  Description:
+    The IPv4 layer formats nothing: the TCP header the stack built is read
+    when the packet is transmitted and the packet is completed by the MAC
+    at the end of the step.
+    The received segments are built in packets allocated from the stack heap,
+    with the checksum marked as verified by the MAC.
+*******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+//DOM-IGNORE-END
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_tcp.h"
+
+#define TCPIP_THIS_MODULE_ID    TCPIP_MODULE_TCP
+#include "tcpip/src/tcpip_private.h"
+#include "tcpip/src/tcp_private.h"
+#include "crypto/crypto.h"
+#include "wolfssl/wolfcrypt/md5.h"
+
+#define HOST_TCP_LINK_SEGS      65536       // segments on the link, each direction
+#define HOST_TCP_TX_PKTS        4096        // packets transmitted in a step
+#define HOST_TCP_RX_PKTS        8192        // packets waiting for the TCP task
+#define HOST_TCP_FRAME_OVERHEAD 54          // Ethernet + IPv4 + TCP headers
+
+// a direction of the link
+typedef struct
+{
+    HOST_TCP_SEG    segs[HOST_TCP_LINK_SEGS];
+    int             head;
+    int             tail;
+    uint64_t        freeUs;         // the previous segment is out
+}HOST_TCP_DIR;
+
+static HOST_TCP_LINK        tcpLink;
+static HOST_TCP_DIR         tcpToRemote;
+static HOST_TCP_DIR         tcpToLocal;
+
+static TCPIP_MAC_PACKET*    tcpTxPkts[HOST_TCP_TX_PKTS];
+static int                  tcpNTxPkts;
+static TCPIP_MAC_PACKET*    tcpRxPkts[HOST_TCP_RX_PKTS];
+static int                  tcpRxHead, tcpRxTail;
+
+static TCPIP_NET_IF         tcpNetIf;
+static TCPIP_MODULE_SIGNAL  tcpSignal;
+static int16_t              tcpTimerMs;
+static HOST_TCP_STATS       tcpStats;
+
+// system and stack services used by the TCP module
+
+uint32_t SYS_TMR_TickCountGet(void)
+{
+    return SYS_TIME_CounterGet();
+}
+
+uint32_t SYS_TMR_TickCounterFrequencyGet(void)
+{
+    return HOST_TEST_TIME_FREQ;
+}
+
+uint32_t SYS_RANDOM_PoolGet(SYS_RANDOM_POOL pool)
+{
+    return (uint32_t)rand();
+}
+
+size_t SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL pool, void* buffer, size_t size)
+{
+    size_t ix;
+
+    for(ix = 0; ix < size; ix++)
+    {
+        ((uint8_t*)buffer)[ix] = (uint8_t)rand();
+    }
+    return size;
+}
+
+size_t SYS_RANDOM_CryptoBlockGet(void* buffer, size_t size)
+{
+    return SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_SECRET, buffer, size);
+}
+
+// MD5 on top of the wolfCrypt one, as crypto.c does
+int CRYPT_MD5_Initialize(CRYPT_MD5_CTX* md5)
+{
+    return wc_InitMd5((wc_Md5*)md5);
+}
+
+int CRYPT_MD5_DataAdd(CRYPT_MD5_CTX* md5, const unsigned char* input, unsigned int sz)
+{
+    return wc_Md5Update((wc_Md5*)md5, input, sz);
+}
+
+int CRYPT_MD5_Finalize(CRYPT_MD5_CTX* md5, unsigned char* digest)
+{
+    return wc_Md5Final((wc_Md5*)md5, digest);
+}
+
+TCPIP_NET_HANDLE TCPIP_STACK_NetDefaultGet(void)
+{
+    return &tcpNetIf;
+}
+
+int TCPIP_STACK_NetIxGet(const TCPIP_NET_IF* pNetIf)
+{
+    return 0;
+}
+
+TCPIP_NET_IF* TCPIP_STACK_IPAddToNet(IPV4_ADDR* pIpAddress, bool useDefault)
+{
+    return &tcpNetIf;
+}
+
+tcpipSignalHandle _TCPIPStackSignalHandlerRegister(TCPIP_STACK_MODULE modId, tcpipModuleSignalHandler signalHandler, int16_t asyncTmoMs)
+{
+    tcpTimerMs = asyncTmoMs;
+    return (tcpipSignalHandle)&tcpSignal;
+}
+
+bool _TCPIPStackSignalHandlerSetParams(TCPIP_STACK_MODULE modId, tcpipSignalHandle handle, int16_t asyncTmoMs)
+{
+    tcpTimerMs = asyncTmoMs;
+    return true;
+}
+
+void _TCPIPStackSignalHandlerDeregister(tcpipSignalHandle handle)
+{
+}
+
+TCPIP_MODULE_SIGNAL _TCPIPStackModuleSignalGet(TCPIP_STACK_MODULE modId, TCPIP_MODULE_SIGNAL clrMask)
+{
+    TCPIP_MODULE_SIGNAL sigPend = tcpSignal;
+    tcpSignal &= ~clrMask;
+    return sigPend;
+}
+
+TCPIP_MODULE_SIGNAL _TCPIPStackModuleSignalParamGet(TCPIP_STACK_MODULE modId, TCPIP_MODULE_SIGNAL clrMask, uint32_t* signalParam)
+{
+    *signalParam = 0;
+    return _TCPIPStackModuleSignalGet(modId, clrMask);
+}
+
+TCPIP_MAC_PACKET* _TCPIPStackModuleRxExtract(TCPIP_STACK_MODULE modId)
+{
+    TCPIP_MAC_PACKET* pRxPkt = 0;
+
+    if(tcpRxTail != tcpRxHead)
+    {
+        pRxPkt = tcpRxPkts[tcpRxTail];
+        tcpRxTail = (tcpRxTail + 1) % HOST_TCP_RX_PKTS;
+    }
+    return pRxPkt;
+}
+
+// the IPv4 layer
+
+TCPIP_NET_HANDLE TCPIP_IPV4_SelectSourceInterface(TCPIP_NET_HANDLE netH, const IPV4_ADDR* pDestAddress, IPV4_ADDR* pSrcAddress, bool srcSet)
+{
+    if(!srcSet)
+    {
+        pSrcAddress->Val = tcpNetIf.netIPAddr.Val;
+    }
+    return &tcpNetIf;
+}
+
+int TCPIP_IPV4_MaxDatagramDataSizeGet(TCPIP_NET_HANDLE netH)
+{
+    return TCPIP_MAC_LINK_MTU_DEFAULT - sizeof(IPV4_HEADER);
+}
+
+bool TCPIP_IPV4_IsFragmentationEnabled(void)
+{
+    return false;
+}
+
+void TCPIP_IPV4_PacketFormatTx(IPV4_PACKET* pPkt, uint8_t protocol, uint16_t ipLoadLen, TCPIP_IPV4_PACKET_PARAMS* pParams)
+{
+}
+
+// a segment starts on the link when the previous one is out
+static void _HostTcpLinkPush(HOST_TCP_DIR* pDir, const HOST_TCP_SEG* pSeg)
+{
+    uint64_t nowUs = SYS_TIME_Counter64Get();
+    uint64_t startUs = pDir->freeUs > nowUs ? pDir->freeUs : nowUs;
+    HOST_TCP_SEG* pLinkSeg = pDir->segs + pDir->head;
+
+    if(tcpLink.rateKbps != 0)
+    {
+        startUs += (uint64_t)(pSeg->len + HOST_TCP_FRAME_OVERHEAD) * 8000 / tcpLink.rateKbps;
+    }
+    pDir->freeUs = startUs;
+
+    *pLinkSeg = *pSeg;
+    pLinkSeg->deliverUs = startUs + tcpLink.delayUs;
+    pDir->head = (pDir->head + 1) % HOST_TCP_LINK_SEGS;
+    HOST_TEST_CHECK(pDir->head != pDir->tail);
+}
+
+bool TCPIP_IPV4_PacketTransmit(IPV4_PACKET* pPkt)
+{
+    TCPIP_MAC_PACKET* pMacPkt = &pPkt->macPkt;
+    const TCP_HEADER* pHdr = (const TCP_HEADER*)pMacPkt->pTransportLayer;
+    const TCPIP_MAC_DATA_SEGMENT* pDSeg;
+    HOST_TCP_SEG seg;
+
+    // the header is in the first segment, the data in the next ones
+    seg.len = 0;
+    for(pDSeg = pMacPkt->pDSeg->next; pDSeg != 0; pDSeg = pDSeg->next)
+    {
+        seg.len += pDSeg->segLen;
+    }
+    seg.remoteAdd = TCPIP_Helper_ntohl(pPkt->destAddress.Val);
+    seg.remotePort = TCPIP_Helper_ntohs(pHdr->DestPort);
+    seg.localPort = TCPIP_Helper_ntohs(pHdr->SourcePort);
+    seg.seq = TCPIP_Helper_ntohl(pHdr->SeqNumber);
+    seg.ack = TCPIP_Helper_ntohl(pHdr->AckNumber);
+    seg.win = TCPIP_Helper_ntohs(pHdr->Window);
+    seg.flags = pHdr->Flags.byte;
+    _HostTcpLinkPush(&tcpToRemote, &seg);
+
+    tcpStats.txSegs++;
+    if(seg.len == 0 && seg.flags == HOST_TCP_ACK)
+    {
+        tcpStats.txPureAcks++;
+    }
+    if((seg.flags & HOST_TCP_RST) != 0)
+    {
+        tcpStats.txResets++;
+    }
+
+    HOST_TEST_CHECK(tcpNTxPkts < HOST_TCP_TX_PKTS);
+    pMacPkt->pktFlags |= TCPIP_MAC_PKT_FLAG_QUEUED;
+    tcpTxPkts[tcpNTxPkts++] = pMacPkt;
+    return true;
+}
+
+// the MAC is done with the transmitted packets
+static void _HostTcpTxDone(void)
+{
+    int ix;
+
+    for(ix = 0; ix < tcpNTxPkts; ix++)
+    {
+        TCPIP_MAC_PACKET* pPkt = tcpTxPkts[ix];
+        pPkt->pktFlags &= ~TCPIP_MAC_PKT_FLAG_QUEUED;
+        pPkt->ackRes = TCPIP_MAC_PKT_ACK_TX_OK;
+        (*pPkt->ackFunc)(pPkt, pPkt->ackParam);
+    }
+    tcpNTxPkts = 0;
+}
+
+static void _HostTcpRxAck(TCPIP_MAC_PACKET* pPkt, const void* param)
+{
+    TCPIP_PKT_PacketFree(pPkt);
+}
+
+// a segment from a remote host reached the interface
+static void _HostTcpRx(const HOST_TCP_SEG* pSeg)
+{
+    int optLen = (pSeg->flags & HOST_TCP_SYN) != 0 ? 4 : 0;
+    uint16_t ipLen = sizeof(IPV4_HEADER) + sizeof(TCP_HEADER) + optLen + pSeg->len;
+    TCPIP_MAC_PACKET* pRxPkt = TCPIP_PKT_PacketAlloc(sizeof(TCPIP_MAC_PACKET), sizeof(TCPIP_MAC_ETHERNET_HEADER) + ipLen, 0);
+    IPV4_HEADER* pIpHdr;
+    TCP_HEADER* pHdr;
+    uint8_t* pOpt;
+
+    if(pRxPkt == 0 || (tcpRxHead + 1) % HOST_TCP_RX_PKTS == tcpRxTail)
+    {
+        TCPIP_PKT_PacketFree(pRxPkt);
+        tcpStats.rxDrops++;
+        return;
+    }
+
+    pRxPkt->pNetLayer = pRxPkt->pMacLayer + sizeof(TCPIP_MAC_ETHERNET_HEADER);
+    pRxPkt->pTransportLayer = pRxPkt->pNetLayer + sizeof(IPV4_HEADER);
+    pIpHdr = (IPV4_HEADER*)pRxPkt->pNetLayer;
+    pHdr = (TCP_HEADER*)pRxPkt->pTransportLayer;
+    pOpt = (uint8_t*)(pHdr + 1);
+    memset(pIpHdr, 0, sizeof(*pIpHdr) + sizeof(*pHdr));
+
+    pIpHdr->SourceAddress.Val = TCPIP_Helper_htonl(pSeg->remoteAdd);
+    pIpHdr->DestAddress.Val = tcpNetIf.netIPAddr.Val;
+    pHdr->SourcePort = TCPIP_Helper_htons(pSeg->remotePort);
+    pHdr->DestPort = TCPIP_Helper_htons(pSeg->localPort);
+    pHdr->SeqNumber = TCPIP_Helper_htonl(pSeg->seq);
+    pHdr->AckNumber = TCPIP_Helper_htonl(pSeg->ack);
+    pHdr->DataOffset.Val = (sizeof(TCP_HEADER) + optLen) / 4;
+    pHdr->Flags.byte = pSeg->flags;
+    pHdr->Window = TCPIP_Helper_htons(pSeg->win);
+    if(optLen != 0)
+    {
+        pOpt[0] = 2;    // MSS option
+        pOpt[1] = 4;
+        pOpt[2] = HOST_TCP_REMOTE_MSS >> 8;
+        pOpt[3] = HOST_TCP_REMOTE_MSS & 0xff;
+    }
+    memset(pOpt + optLen, 'r', pSeg->len);
+
+    // as the IPv4 layer hands it over
+    pRxPkt->pDSeg->segLen = sizeof(TCPIP_MAC_ETHERNET_HEADER) + ipLen;
+    pRxPkt->totTransportLen = ipLen - sizeof(IPV4_HEADER);
+    pRxPkt->pktIf = &tcpNetIf;
+    pRxPkt->pktFlags |= TCPIP_MAC_PKT_FLAG_IPV4 | TCPIP_MAC_PKT_FLAG_RX_CHKSUM_TCP;
+    pRxPkt->ackFunc = _HostTcpRxAck;
+    pRxPkt->ackParam = 0;
+
+    tcpRxPkts[tcpRxHead] = pRxPkt;
+    tcpRxHead = (tcpRxHead + 1) % HOST_TCP_RX_PKTS;
+    tcpSignal |= TCPIP_MODULE_SIGNAL_RX_PENDING;
+    tcpStats.rxSegs++;
+}
+
+// delivers the segments of a direction that are due
+static void _HostTcpLinkDeliver(HOST_TCP_DIR* pDir, void (*deliverF)(const HOST_TCP_SEG* pSeg))
+{
+    uint64_t nowUs = SYS_TIME_Counter64Get();
+
+    while(pDir->tail != pDir->head && pDir->segs[pDir->tail].deliverUs <= nowUs)
+    {
+        const HOST_TCP_SEG* pSeg = pDir->segs + pDir->tail;
+        pDir->tail = (pDir->tail + 1) % HOST_TCP_LINK_SEGS;
+        (*deliverF)(pSeg);
+    }
+}
+
+bool HOST_TCP_Initialize(const HOST_TCP_LINK* pLink)
+{
+    TCPIP_STACK_HEAP_HANDLE heapH = HOST_TEST_HeapCreate();
+    TCPIP_TCP_MODULE_CONFIG tcpConfig =
+    {
+        .nSockets = TCPIP_TCP_MAX_SOCKETS,
+        .sktTxBuffSize = TCPIP_TCP_SOCKET_DEFAULT_TX_SIZE,
+        .sktRxBuffSize = TCPIP_TCP_SOCKET_DEFAULT_RX_SIZE,
+    };
+    TCPIP_STACK_MODULE_CTRL stackCtrl =
+    {
+        .memH = heapH,
+        .stackAction = TCPIP_STACK_ACTION_INIT,
+    };
+
+    if(heapH == 0 || !TCPIP_PKT_Initialize(heapH, 0, 0))
+    {
+        return false;
+    }
+
+    tcpNetIf.netIPAddr.Val = TCPIP_Helper_htonl(HOST_TCP_LOCAL_ADD);
+    tcpNetIf.linkMtu = TCPIP_MAC_LINK_MTU_DEFAULT;
+    tcpNetIf.txOffload = TCPIP_MAC_CHECKSUM_TCP;
+    tcpNetIf.Flags.bInterfaceEnabled = 1;
+    HOST_TCP_LinkSet(pLink);
+
+    // the TCP timeouts count from a non-zero time
+    HOST_TEST_TimeAdvance(1);
+    return TCPIP_TCP_Initialize(&stackCtrl, &tcpConfig);
+}
+
+void HOST_TCP_LinkSet(const HOST_TCP_LINK* pLink)
+{
+    tcpLink = *pLink;
+}
+
+void HOST_TCP_RemoteSend(const HOST_TCP_SEG* pSeg)
+{
+    _HostTcpLinkPush(&tcpToLocal, pSeg);
+}
+
+void HOST_TCP_Step(HOST_TCP_APP appF)
+{
+    struct timespec tStart, tEnd;
+
+    _HostTcpLinkDeliver(&tcpToRemote, tcpLink.remoteRx);
+    _HostTcpLinkDeliver(&tcpToLocal, _HostTcpRx);
+    if(tcpTimerMs != 0 && HOST_TEST_TimeMs() % tcpTimerMs == 0)
+    {
+        tcpSignal |= TCPIP_MODULE_SIGNAL_TMO;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &tStart);
+    TCPIP_TCP_Task();
+    clock_gettime(CLOCK_MONOTONIC, &tEnd);
+    tcpStats.taskNs += (uint64_t)(tEnd.tv_sec - tStart.tv_sec) * 1000000000 + tEnd.tv_nsec - tStart.tv_nsec;
+    _HostTcpTxDone();
+
+    if(appF != 0)
+    {
+        (*appF)();
+        _HostTcpTxDone();
+    }
+
+    HOST_TEST_TimeAdvance(1);
+}
+
+const HOST_TCP_STATS* HOST_TCP_Stats(void)
+{
+    return &tcpStats;
+}
+
+void HOST_TCP_StatsReset(void)
+{
+    memset(&tcpStats, 0, sizeof(tcpStats));
+}
+
+int HOST_TCP_Sockets(void)
+{
+    int ix, nSkts = 0;
+    TCP_SOCKET_INFO sktInfo;
+
+    for(ix = 0; ix < TCPIP_TCP_MAX_SOCKETS; ix++)
+    {
+        if(TCPIP_TCP_SocketInfoGet(ix, &sktInfo))
+        {
+            nSkts++;
+        }
+    }
+    return nSkts;
+}
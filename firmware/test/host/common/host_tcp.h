@@ -0,0 +1,122 @@
+/*******************************************************************************
+  Host test TCP link header file
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    host_tcp.h
+
+  Summary:
+    Emulated IPv4 link between the TCP module and remote hosts
+
+  Description:
+    The TCP tests include tcp.c and link host_tcp.c: it replaces the IPv4 layer,
+    the MAC and the stack manager signals of the TCP module.
+    The segments the stack sends travel over a link with a delay and a rate
+    to the remote hosts the test emulates; the remote hosts send their segments the other way.
+    The segments carry no data on the link: a received payload is a fill pattern.
+    The time is the virtual SYS_TIME of host_sys.c and moves 1 ms per HOST_TCP_Step().
+*******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+//DOM-IGNORE-END
+
+#ifndef _HOST_TCP_H_
+#define _HOST_TCP_H_
+
+#include "host_test.h"
+
+#define HOST_TCP_LOCAL_ADD      0x0a00000a      // address of the stack interface, host order
+#define HOST_TCP_REMOTE_MSS     1460            // MSS option of the remote SYNs
+
+// TCP header flags
+#define HOST_TCP_FIN            0x01
+#define HOST_TCP_SYN            0x02
+#define HOST_TCP_RST            0x04
+#define HOST_TCP_PSH            0x08
+#define HOST_TCP_ACK            0x10
+
+// a segment on the link; host order
+typedef struct
+{
+    uint64_t    deliverUs;      // time it reaches the other end; set by the link
+    uint32_t    remoteAdd;      // address of the remote host
+    uint16_t    remotePort;
+    uint16_t    localPort;
+    uint32_t    seq;
+    uint32_t    ack;
+    uint16_t    len;            // payload bytes
+    uint16_t    win;
+    uint8_t     flags;
+}HOST_TCP_SEG;
+
+// a segment sent by the stack reached a remote host
+typedef void (*HOST_TCP_REMOTE_RX)(const HOST_TCP_SEG* pSeg);
+
+// the application: runs once per step, after the TCP task
+typedef void (*HOST_TCP_APP)(void);
+
+typedef struct
+{
+    uint32_t            delayUs;        // one way delay
+    uint32_t            rateKbps;       // rate of each direction; 0: no serialization time
+    HOST_TCP_REMOTE_RX  remoteRx;       // the remote hosts
+}HOST_TCP_LINK;
+
+typedef struct
+{
+    uint32_t    txSegs;         // segments sent by the stack
+    uint32_t    txPureAcks;     // of them, no data and only the ACK flag
+    uint32_t    txResets;
+    uint32_t    rxSegs;         // segments delivered to the stack
+    uint32_t    rxDrops;        // segments the stack couldn't get: no packet memory
+    uint64_t    taskNs;         // CPU time spent in TCPIP_TCP_Task()
+}HOST_TCP_STATS;
+
+// initializes the heap, the packet and the TCP modules and the link
+// the TCP module uses its configuration.h sizes
+bool HOST_TCP_Initialize(const HOST_TCP_LINK* pLink);
+
+// changes the link; the segments already on it keep their delivery time
+void HOST_TCP_LinkSet(const HOST_TCP_LINK* pLink);
+
+// a remote host sends a segment to the stack
+void HOST_TCP_RemoteSend(const HOST_TCP_SEG* pSeg);
+
+// 1 ms of the test: the segments due are delivered, the TCP task and the application run
+// and the MAC completes the transmitted packets
+void HOST_TCP_Step(HOST_TCP_APP appF);
+
+// counters since the initialization or the last reset
+const HOST_TCP_STATS* HOST_TCP_Stats(void);
+
+void HOST_TCP_StatsReset(void);
+
+// number of the TCP sockets in use
+int HOST_TCP_Sockets(void);
+
+#endif  // _HOST_TCP_H_
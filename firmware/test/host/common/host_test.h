@@ -0,0 +1,97 @@
+/*******************************************************************************
+  Host test support header file
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    host_test.h
+
+  Summary:
+    Support for running the TCP/IP stack modules on a host PC
+
+  Description:
+    The host tests build the stack modules with the native gcc.
+    The RTOS, the heap and the system services are replaced by
+    pthread based implementations in the common directory.
+    A test exits with a non-zero code if any of its checks failed.
+*******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+//DOM-IGNORE-END
+
+#ifndef _HOST_TEST_H_
+#define _HOST_TEST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "tcpip/tcpip.h"
+
+// records a failed check, the test goes on
+#define HOST_TEST_CHECK(cond)   do { if(!(cond)) { HOST_TEST_Fail(__FILE__, __LINE__, #cond); } } while(0)
+
+void HOST_TEST_Fail(const char* file, int line, const char* expr);
+
+// number of the failed checks so far; thread safe
+int HOST_TEST_Failures(void);
+
+// prints the test result; returns the process exit code
+int HOST_TEST_Result(const char* testName);
+
+// heap for the stack modules
+// allocates from a region below 4 GB: the stack truncates pointers to 32 bits
+// the freed blocks are filled with HOST_TEST_HEAP_POISON before reuse
+#define HOST_TEST_HEAP_POISON   0xa5
+
+TCPIP_STACK_HEAP_HANDLE HOST_TEST_HeapCreate(void);
+
+// number of the allocated blocks
+int HOST_TEST_HeapBlocks(void);
+
+// bytes in the allocated blocks
+size_t HOST_TEST_HeapBytes(void);
+
+// highest HOST_TEST_HeapBytes() so far; reset: start over from the current value
+size_t HOST_TEST_HeapPeak(bool reset);
+
+// the allocations fail above nBytes and the heap free size is what is left up to nBytes
+// 0: no limit
+void HOST_TEST_HeapLimitSet(size_t nBytes);
+
+// virtual time
+// SYS_TIME runs at HOST_TEST_TIME_FREQ and advances only when the test moves it
+#define HOST_TEST_TIME_FREQ     1000000
+
+void HOST_TEST_TimeAdvance(uint32_t ms);
+
+uint32_t HOST_TEST_TimeMs(void);
+
+// console output of the stack modules is discarded unless enabled
+void HOST_TEST_ConsoleEnable(bool enable);
+
+#endif  // _HOST_TEST_H_
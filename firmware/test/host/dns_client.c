@@ -0,0 +1,560 @@
+/*******************************************************************************
+  DNS client test
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    dns_client.c
+
+  Summary:
+    DNS client against a stub resolver
+
+  Description:
+    The DNS client runs over a stub UDP socket: the queries it sends are decoded
+    and the test answers them, as any of the 2 configured servers, in any order.
+    Covers:
+        - the queries sent to all servers in parallel, the first valid answer taken
+        - the refresh-ahead of the entries in use, before their TTL ends
+        - the RFC 2308 negative caching of NXDOMAIN, with the SOA TTL
+        - the hit/miss/prefetch statistics of TCPIP_DNS_ClientInfoGet()
+*******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+//DOM-IGNORE-END
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+
+// the module under test, for access to its internal state
+#include "tcpip/src/dns.c"
+
+#if (TCPIP_DNS_CLIENT_PARALLEL_QUERY == 0) || (TCPIP_DNS_CLIENT_PREFETCH_PERCENT != 10)
+#error "the test needs TCPIP_DNS_CLIENT_PARALLEL_QUERY and a 10% TCPIP_DNS_CLIENT_PREFETCH_PERCENT"
+#endif
+
+#define TEST_SERVER_1           0x08080808
+#define TEST_SERVER_2           0x01010101
+#define TEST_ADDRESS_1          0x0a000001
+#define TEST_ADDRESS_2          0x0a000002
+
+#define TEST_MAX_QUERIES        64
+#define TEST_RX_QUEUE           16
+#define TEST_RX_SIZE            512
+
+#define TEST_RCODE_SERVFAIL     2
+#define TEST_RCODE_NXDOMAIN     3
+
+// a query sent by the client
+typedef struct
+{
+    uint32_t    dstAdd;
+    uint16_t    transId;
+    uint16_t    type;
+    char        name[TCPIP_DNS_CLIENT_MAX_HOSTNAME_LEN + 1];
+}TEST_QUERY;
+
+static TCPIP_NET_IF testNetIf;
+
+static TEST_QUERY testQueries[TEST_MAX_QUERIES];
+static int testNQueries;
+static uint8_t testTxBuff[TEST_RX_SIZE];
+static uint32_t testTxDst;
+
+// answers not read yet
+static uint8_t testRxQueue[TEST_RX_QUEUE][TEST_RX_SIZE];
+static uint16_t testRxLen[TEST_RX_QUEUE];
+static int testRxHead, testRxTail;
+
+static TCPIP_MODULE_SIGNAL testSignal;
+
+// system and stack services used by the DNS client
+
+uint64_t SYS_TMR_TickCountGetLong(void)
+{
+    return SYS_TIME_Counter64Get();
+}
+
+uint32_t SYS_TMR_TickCounterFrequencyGet(void)
+{
+    return HOST_TEST_TIME_FREQ;
+}
+
+uint32_t SYS_RANDOM_PoolGet(SYS_RANDOM_POOL pool)
+{
+    return (uint32_t)rand();
+}
+
+TCPIP_ARP_RESULT TCPIP_ARP_EntryRemove(TCPIP_NET_HANDLE hNet,  const IPV4_ADDR* ipAdd)
+{
+    return ARP_RES_OK;
+}
+
+bool TCPIP_STACK_DNSServiceCanStart(TCPIP_NET_IF* pNetIf, TCPIP_STACK_DNS_SERVICE_TYPE servType)
+{
+    return true;
+}
+
+TCPIP_NET_HANDLE TCPIP_STACK_IndexToNet(int netIx)
+{
+    return netIx == 0 ? &testNetIf : 0;
+}
+
+TCPIP_NET_HANDLE TCPIP_STACK_NetDefaultGet(void)
+{
+    return &testNetIf;
+}
+
+bool TCPIP_STACK_NetIsReady(TCPIP_NET_HANDLE hNet)
+{
+    return true;
+}
+
+int TCPIP_STACK_NumberOfNetworksGet(void)
+{
+    return 1;
+}
+
+TCPIP_MODULE_SIGNAL _TCPIPStackModuleSignalGet(TCPIP_STACK_MODULE modId, TCPIP_MODULE_SIGNAL clrMask)
+{
+    TCPIP_MODULE_SIGNAL sigPend = testSignal;
+    testSignal = TCPIP_MODULE_SIGNAL_NONE;
+    return sigPend;
+}
+
+bool _TCPIPStackModuleSignalRequest(TCPIP_STACK_MODULE modId, TCPIP_MODULE_SIGNAL signal, bool noOverride)
+{
+    return true;
+}
+
+tcpipSignalHandle _TCPIPStackSignalHandlerRegister(TCPIP_STACK_MODULE modId, tcpipModuleSignalHandler signalHandler, int16_t asyncTmoMs)
+{
+    return (tcpipSignalHandle)&testSignal;
+}
+
+void _TCPIPStackSignalHandlerDeregister(tcpipSignalHandle handle)
+{
+}
+
+// the UDP socket of the client
+
+UDP_SOCKET TCPIP_UDP_ClientOpen(IP_ADDRESS_TYPE addType, UDP_PORT remotePort, IP_MULTI_ADDRESS* remoteAddress)
+{
+    return 1;
+}
+
+bool TCPIP_UDP_Close(UDP_SOCKET hUDP)
+{
+    return true;
+}
+
+bool TCPIP_UDP_Disconnect(UDP_SOCKET hUDP, bool flushRxQueue)
+{
+    return true;
+}
+
+bool TCPIP_UDP_SocketInfoGet(UDP_SOCKET hUDP, UDP_SOCKET_INFO* pInfo)
+{
+    return false;
+}
+
+bool TCPIP_UDP_OptionsSet(UDP_SOCKET hUDP, UDP_SOCKET_OPTION option, void* optParam)
+{
+    return true;
+}
+
+TCPIP_UDP_SIGNAL_HANDLE TCPIP_UDP_SignalHandlerRegister(UDP_SOCKET s, TCPIP_UDP_SIGNAL_TYPE sigMask, TCPIP_UDP_SIGNAL_FUNCTION handler, const void* hParam)
+{
+    return (TCPIP_UDP_SIGNAL_HANDLE)&testSignal;
+}
+
+uint16_t TCPIP_UDP_TxPutIsReady(UDP_SOCKET hUDP, unsigned short count)
+{
+    return sizeof(testTxBuff);
+}
+
+uint16_t TCPIP_UDP_PutIsReady(UDP_SOCKET hUDP)
+{
+    return sizeof(testTxBuff);
+}
+
+bool TCPIP_UDP_Bind(UDP_SOCKET hUDP, IP_ADDRESS_TYPE addType, UDP_PORT localPort, IP_MULTI_ADDRESS* localAddress)
+{
+    return true;
+}
+
+bool TCPIP_UDP_DestinationIPAddressSet(UDP_SOCKET hUDP, IP_ADDRESS_TYPE addType, IP_MULTI_ADDRESS* remoteAddress)
+{
+    testTxDst = remoteAddress->v4Add.Val;
+    return true;
+}
+
+bool TCPIP_UDP_DestinationPortSet(UDP_SOCKET hUDP, UDP_PORT remotePort)
+{
+    return true;
+}
+
+bool TCPIP_UDP_TxOffsetSet(UDP_SOCKET hUDP, uint16_t wrOffset, bool relative)
+{
+    return true;
+}
+
+uint8_t* TCPIP_UDP_TxPointerGet(UDP_SOCKET hUDP)
+{
+    return testTxBuff;
+}
+
+// decodes the query the client sent
+uint16_t TCPIP_UDP_Flush(UDP_SOCKET hUDP)
+{
+    TEST_QUERY* pQuery = testQueries + testNQueries++;
+    uint8_t* pSrc = testTxBuff + sizeof(TCPIP_DNS_HEADER);
+    char* pName = pQuery->name;
+    int labelLen;
+
+    HOST_TEST_CHECK(testNQueries < TEST_MAX_QUERIES);
+    pQuery->dstAdd = testTxDst;
+    pQuery->transId = (testTxBuff[0] << 8) | testTxBuff[1];
+    while((labelLen = *pSrc++) != 0)
+    {
+        if(pName != pQuery->name)
+        {
+            *pName++ = '.';
+        }
+        memcpy(pName, pSrc, labelLen);
+        pName += labelLen;
+        pSrc += labelLen;
+    }
+    *pName = 0;
+    pQuery->type = (pSrc[0] << 8) | pSrc[1];
+
+    return (uint16_t)(pSrc + 4 - testTxBuff);
+}
+
+uint16_t TCPIP_UDP_GetIsReady(UDP_SOCKET hUDP)
+{
+    return testRxHead != testRxTail ? testRxLen[testRxHead] : 0;
+}
+
+uint16_t TCPIP_UDP_ArrayGet(UDP_SOCKET hUDP, uint8_t* cData, uint16_t wDataLen)
+{
+    uint16_t len = testRxLen[testRxHead] < wDataLen ? testRxLen[testRxHead] : wDataLen;
+    memcpy(cData, testRxQueue[testRxHead], len);
+    return len;
+}
+
+uint16_t TCPIP_UDP_Discard(UDP_SOCKET hUDP)
+{
+    if(testRxHead != testRxTail)
+    {
+        testRxHead = (testRxHead + 1) % TEST_RX_QUEUE;
+    }
+    return 0;
+}
+
+// the stub resolver
+
+static uint8_t* _TestPutName(uint8_t* pDst, const char* name)
+{
+    while(*name != 0)
+    {
+        const char* pDot = strchr(name, '.');
+        int labelLen = pDot != 0 ? pDot - name : strlen(name);
+        *pDst++ = labelLen;
+        memcpy(pDst, name, labelLen);
+        pDst += labelLen;
+        name += pDot != 0 ? labelLen + 1 : labelLen;
+    }
+    *pDst++ = 0;
+    return pDst;
+}
+
+static uint8_t* _TestPut16(uint8_t* pDst, uint16_t val)
+{
+    *pDst++ = val >> 8;
+    *pDst++ = val;
+    return pDst;
+}
+
+static uint8_t* _TestPut32(uint8_t* pDst, uint32_t val)
+{
+    return _TestPut16(_TestPut16(pDst, val >> 16), val);
+}
+
+// answers a query with the A addresses (host order) and their TTL
+// soaTtl != 0 adds a SOA record in the authority section
+static void _TestReply(const TEST_QUERY* pQuery, int rCode, const uint32_t* pAdd, int nAdd, uint32_t ttl, uint32_t soaTtl, uint32_t soaMinimum)
+{
+    uint8_t* pStart = testRxQueue[testRxTail];
+    uint8_t *pDst, *pRdLen;
+    int ix;
+
+    pDst = _TestPut16(pStart, pQuery->transId);
+    pDst = _TestPut16(pDst, 0x8180 | rCode);
+    pDst = _TestPut16(pDst, 1);
+    pDst = _TestPut16(pDst, nAdd);
+    pDst = _TestPut16(pDst, soaTtl != 0 ? 1 : 0);
+    pDst = _TestPut16(pDst, 0);
+    pDst = _TestPutName(pDst, pQuery->name);
+    pDst = _TestPut16(pDst, pQuery->type);
+    pDst = _TestPut16(pDst, 1);
+
+    for(ix = 0; ix < nAdd; ix++)
+    {   // name pointer to the question
+        pDst = _TestPut16(pDst, 0xc00c);
+        pDst = _TestPut16(pDst, TCPIP_DNS_TYPE_A);
+        pDst = _TestPut16(pDst, 1);
+        pDst = _TestPut32(pDst, ttl);
+        pDst = _TestPut16(pDst, sizeof(uint32_t));
+        pDst = _TestPut32(pDst, pAdd[ix]);
+    }
+
+    if(soaTtl != 0)
+    {
+        pDst = _TestPutName(pDst, "example");
+        pDst = _TestPut16(pDst, 6);     // SOA
+        pDst = _TestPut16(pDst, 1);
+        pDst = _TestPut32(pDst, soaTtl);
+        pRdLen = pDst;
+        pDst = _TestPutName(pDst + 2, "ns.example");
+        pDst = _TestPutName(pDst, "admin.example");
+        pDst = _TestPut32(pDst, 1);     // serial
+        pDst = _TestPut32(pDst, 2);     // refresh
+        pDst = _TestPut32(pDst, 3);     // retry
+        pDst = _TestPut32(pDst, 4);     // expire
+        pDst = _TestPut32(pDst, soaMinimum);
+        _TestPut16(pRdLen, pDst - pRdLen - 2);
+    }
+
+    testRxLen[testRxTail] = pDst - pStart;
+    testRxTail = (testRxTail + 1) % TEST_RX_QUEUE;
+}
+
+static void _TestTask(TCPIP_MODULE_SIGNAL signal)
+{
+    testSignal = signal;
+    TCPIP_DNS_ClientTask();
+}
+
+// the client runs once a second
+static void _TestAdvance(int nSecs)
+{
+    while(nSecs-- > 0)
+    {
+        HOST_TEST_TimeAdvance(1000);
+        _TestTask(TCPIP_MODULE_SIGNAL_TMO);
+    }
+}
+
+static bool _TestResolved(const char* name, uint32_t addHost)
+{
+    IPV4_ADDR ipAdd;
+
+    return TCPIP_DNS_IsNameResolved(name, &ipAdd, 0) == TCPIP_DNS_RES_OK && ipAdd.Val == TCPIP_Helper_htonl(addHost);
+}
+
+static void _TestInitialize(void)
+{
+    TCPIP_STACK_MODULE_CTRL stackCtrl;
+    TCPIP_DNS_CLIENT_MODULE_CONFIG dnsConfig;
+
+    memset(&stackCtrl, 0, sizeof(stackCtrl));
+    stackCtrl.memH = HOST_TEST_HeapCreate();
+    stackCtrl.pNetIf = &testNetIf;
+    stackCtrl.stackAction = TCPIP_STACK_ACTION_INIT;
+
+    testNetIf.netIPAddr.Val = 0x0100a8c0;
+    testNetIf.dnsServer[0].Val = TEST_SERVER_1;
+    testNetIf.dnsServer[1].Val = TEST_SERVER_2;
+    testNetIf.Flags.bInterfaceEnabled = 1;
+    testNetIf.Flags.bIsDnsClientEnabled = 1;
+
+    memset(&dnsConfig, 0, sizeof(dnsConfig));
+    dnsConfig.deleteOldLease = TCPIP_DNS_CLIENT_DELETE_OLD_ENTRIES;
+    dnsConfig.cacheEntries = TCPIP_DNS_CLIENT_CACHE_ENTRIES;
+    dnsConfig.entrySolvedTmo = 0;
+    dnsConfig.nIPv4Entries = TCPIP_DNS_CLIENT_CACHE_PER_IPV4_ADDRESS;
+    dnsConfig.nIPv6Entries = TCPIP_DNS_CLIENT_CACHE_PER_IPV6_ADDRESS;
+    dnsConfig.ipAddressType = IP_ADDRESS_TYPE_IPV4;
+
+    HOST_TEST_TimeAdvance(1000000);
+    HOST_TEST_CHECK(TCPIP_DNS_ClientInitialize(&stackCtrl, &dnsConfig));
+    _TestTask(TCPIP_MODULE_SIGNAL_TMO);
+}
+
+// both servers queried with the same transaction ID, the first valid answer wins
+static void _TestParallel(void)
+{
+    uint32_t add1 = TEST_ADDRESS_1, add2 = TEST_ADDRESS_2;
+    IPV4_ADDR ipAdd;
+    TCPIP_DNS_CLIENT_INFO clientInfo;
+
+    HOST_TEST_CHECK(TCPIP_DNS_Resolve("host.example", TCPIP_DNS_TYPE_A) == TCPIP_DNS_RES_PENDING);
+    HOST_TEST_CHECK(testNQueries == 2);
+    HOST_TEST_CHECK(testQueries[0].dstAdd != testQueries[1].dstAdd && testQueries[0].transId == testQueries[1].transId);
+    HOST_TEST_CHECK(strcmp(testQueries[0].name, "host.example") == 0 && testQueries[0].type == TCPIP_DNS_TYPE_A);
+
+    // server 1 fails, server 2 answers, then server 1 answers late
+    _TestReply(testQueries + 0, TEST_RCODE_SERVFAIL, 0, 0, 0, 0, 0);
+    _TestTask(TCPIP_MODULE_SIGNAL_RX_PENDING);
+    HOST_TEST_CHECK(TCPIP_DNS_IsNameResolved("host.example", &ipAdd, 0) == TCPIP_DNS_RES_PENDING);
+    _TestReply(testQueries + 1, 0, &add1, 1, 100, 0, 0);
+    _TestReply(testQueries + 0, 0, &add2, 1, 100, 0, 0);
+    _TestTask(TCPIP_MODULE_SIGNAL_RX_PENDING);
+    HOST_TEST_CHECK(_TestResolved("host.example", TEST_ADDRESS_1));
+    HOST_TEST_CHECK(TCPIP_DNS_GetIPAddressesNumber("host.example", IP_ADDRESS_TYPE_IPV4) == 1);
+
+    // now from the cache
+    HOST_TEST_CHECK(TCPIP_DNS_Resolve("host.example", TCPIP_DNS_TYPE_A) == TCPIP_DNS_RES_OK);
+    TCPIP_DNS_ClientInfoGet(&clientInfo);
+    HOST_TEST_CHECK(clientInfo.cacheHits == 1 && clientInfo.cacheMisses == 1 && clientInfo.pendingEntries == 0);
+}
+
+// an entry in use is refreshed when 10% of its TTL is left
+static void _TestPrefetch(void)
+{
+    int nQueries;
+    uint32_t add1 = TEST_ADDRESS_1, add2 = TEST_ADDRESS_2;
+    TCPIP_DNS_CLIENT_INFO clientInfo;
+
+    _TestAdvance(89);
+    HOST_TEST_CHECK(testNQueries == 2);
+    _TestAdvance(1);
+    HOST_TEST_CHECK(testNQueries == 4);
+    HOST_TEST_CHECK(testQueries[2].transId == testQueries[3].transId && strcmp(testQueries[2].name, "host.example") == 0);
+    TCPIP_DNS_ClientInfoGet(&clientInfo);
+    HOST_TEST_CHECK(clientInfo.prefetchQueries == 1 && clientInfo.pendingEntries == 1);
+
+    // the old answer is used while refreshing
+    HOST_TEST_CHECK(_TestResolved("host.example", TEST_ADDRESS_1));
+    _TestAdvance(1);
+    _TestReply(testQueries + 2, 0, &add2, 1, 100, 0, 0);
+    _TestTask(TCPIP_MODULE_SIGNAL_RX_PENDING);
+    HOST_TEST_CHECK(_TestResolved("host.example", TEST_ADDRESS_2));
+    TCPIP_DNS_ClientInfoGet(&clientInfo);
+    HOST_TEST_CHECK(clientInfo.pendingEntries == 0);
+
+    // the late answer of the other server is ignored
+    _TestReply(testQueries + 3, 0, &add1, 1, 100, 0, 0);
+    _TestTask(TCPIP_MODULE_SIGNAL_RX_PENDING);
+    HOST_TEST_CHECK(_TestResolved("host.example", TEST_ADDRESS_2));
+
+    // used again above: refreshed 90 s later
+    nQueries = testNQueries;
+    _TestAdvance(90);
+    HOST_TEST_CHECK(testNQueries == nQueries + 2);
+
+    // no answer to the refresh: the old answer is used until it expires
+    _TestAdvance(9);
+    HOST_TEST_CHECK(_TestResolved("host.example", TEST_ADDRESS_2));
+    _TestAdvance(1);
+    HOST_TEST_CHECK(TCPIP_DNS_IsNameResolved("host.example", 0, 0) == TCPIP_DNS_RES_NO_NAME_ENTRY);
+    TCPIP_DNS_ClientInfoGet(&clientInfo);
+    HOST_TEST_CHECK(clientInfo.pendingEntries == 0);
+}
+
+// NXDOMAIN is cached for min(SOA TTL, SOA minimum)
+static void _TestNegative(void)
+{
+    int nQueries = testNQueries;
+    uint32_t add1 = TEST_ADDRESS_1;
+    TCPIP_DNS_CLIENT_INFO clientInfo;
+
+    HOST_TEST_CHECK(TCPIP_DNS_Resolve("nx.example", TCPIP_DNS_TYPE_A) == TCPIP_DNS_RES_PENDING);
+    _TestReply(testQueries + nQueries, TEST_RCODE_NXDOMAIN, 0, 0, 0, 600, 60);
+    _TestTask(TCPIP_MODULE_SIGNAL_RX_PENDING);
+    HOST_TEST_CHECK(TCPIP_DNS_IsNameResolved("nx.example", 0, 0) == TCPIP_DNS_RES_NAME_ERROR);
+
+    // the name error is for any type, no new query
+    HOST_TEST_CHECK(TCPIP_DNS_Resolve("nx.example", TCPIP_DNS_TYPE_A) == TCPIP_DNS_RES_NAME_ERROR);
+    HOST_TEST_CHECK(TCPIP_DNS_Resolve("nx.example", TCPIP_DNS_TYPE_AAAA) == TCPIP_DNS_RES_NAME_ERROR);
+    HOST_TEST_CHECK(testNQueries == nQueries + 2);
+    TCPIP_DNS_ClientInfoGet(&clientInfo);
+    HOST_TEST_CHECK(clientInfo.negativeHits == 2 && clientInfo.pendingEntries == 0);
+
+    // a name error is not refreshed ahead
+    _TestAdvance(59);
+    HOST_TEST_CHECK(testNQueries == nQueries + 2);
+    HOST_TEST_CHECK(TCPIP_DNS_Resolve("nx.example", TCPIP_DNS_TYPE_A) == TCPIP_DNS_RES_NAME_ERROR);
+    _TestAdvance(1);
+    HOST_TEST_CHECK(TCPIP_DNS_IsNameResolved("nx.example", 0, 0) == TCPIP_DNS_RES_NO_NAME_ENTRY);
+    HOST_TEST_CHECK(TCPIP_DNS_Resolve("nx.example", TCPIP_DNS_TYPE_A) == TCPIP_DNS_RES_PENDING);
+    HOST_TEST_CHECK(testNQueries == nQueries + 4);
+
+    // NXDOMAIN without a SOA is not cached
+    _TestReply(testQueries + nQueries + 2, TEST_RCODE_NXDOMAIN, 0, 0, 0, 0, 0);
+    _TestTask(TCPIP_MODULE_SIGNAL_RX_PENDING);
+    HOST_TEST_CHECK(TCPIP_DNS_IsNameResolved("nx.example", 0, 0) == TCPIP_DNS_RES_NO_NAME_ENTRY);
+
+    // a SOA TTL lower than the SOA minimum is used
+    nQueries = testNQueries;
+    HOST_TEST_CHECK(TCPIP_DNS_Resolve("nx2.example", TCPIP_DNS_TYPE_A) == TCPIP_DNS_RES_PENDING);
+    _TestReply(testQueries + nQueries, TEST_RCODE_NXDOMAIN, 0, 0, 0, 5, 3600);
+    _TestTask(TCPIP_MODULE_SIGNAL_RX_PENDING);
+    _TestAdvance(4);
+    HOST_TEST_CHECK(TCPIP_DNS_IsNameResolved("nx2.example", 0, 0) == TCPIP_DNS_RES_NAME_ERROR);
+    _TestAdvance(1);
+    HOST_TEST_CHECK(TCPIP_DNS_IsNameResolved("nx2.example", 0, 0) == TCPIP_DNS_RES_NO_NAME_ENTRY);
+
+    // a forced query overrides a cached name error
+    nQueries = testNQueries;
+    TCPIP_DNS_Resolve("nx3.example", TCPIP_DNS_TYPE_A);
+    _TestReply(testQueries + nQueries, TEST_RCODE_NXDOMAIN, 0, 0, 0, 600, 600);
+    _TestTask(TCPIP_MODULE_SIGNAL_RX_PENDING);
+    HOST_TEST_CHECK(TCPIP_DNS_Send_Query("nx3.example", TCPIP_DNS_TYPE_A) == TCPIP_DNS_RES_PENDING);
+    _TestReply(testQueries + nQueries + 2, 0, &add1, 1, 50, 0, 0);
+    _TestTask(TCPIP_MODULE_SIGNAL_RX_PENDING);
+    HOST_TEST_CHECK(TCPIP_DNS_GetIPAddressesNumber("nx3.example", IP_ADDRESS_TYPE_IPV4) == 1);
+}
+
+// an entry not used since it was solved is left to expire
+static void _TestUnused(void)
+{
+    int nQueries = testNQueries;
+    TCPIP_DNS_CLIENT_INFO clientInfo;
+
+    _TestAdvance(49);
+    HOST_TEST_CHECK(testNQueries == nQueries);
+    _TestAdvance(1);
+    HOST_TEST_CHECK(TCPIP_DNS_IsNameResolved("nx3.example", 0, 0) == TCPIP_DNS_RES_NO_NAME_ENTRY);
+
+    TCPIP_DNS_ClientInfoGet(&clientInfo);
+    HOST_TEST_CHECK(clientInfo.pendingEntries == 0);
+    HOST_TEST_CHECK(clientInfo.prefetchQueries == 2);
+}
+
+int main(void)
+{
+    _TestInitialize();
+    _TestParallel();
+    _TestPrefetch();
+    _TestNegative();
+    _TestUnused();
+
+    return HOST_TEST_Result("dns_client");
+}
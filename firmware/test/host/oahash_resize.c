@@ -0,0 +1,302 @@
+/*******************************************************************************
+  OA hash incremental resize test
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    oahash_resize.c
+
+  Summary:
+    Robin Hood hash with incremental resize
+
+  Description:
+    Random inserts and removals with the resize steps interleaved,
+    checked against a reference set after every operation.
+
+    A full current bucket array while entries are still to be migrated:
+    the delete function has to be offered entries of the current array only,
+    removing an entry not migrated yet makes no room for the new key.
+*******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+//DOM-IGNORE-END
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+
+// the module under test, for access to its internal state
+#include "tcpip/src/oahash.c"
+
+#define TEST_MIN_ENTRIES        8
+#define TEST_MAX_ENTRIES        256
+#define TEST_GROW_LOAD          75
+#define TEST_SHRINK_LOAD        25
+#define TEST_KEYS               1024    // key space of the random test
+#define TEST_OPERATIONS         200000
+
+typedef struct
+{
+    OA_HASH_ENTRY   hEntry;
+    uint32_t        key;
+    uint32_t        stamp;      // insertion order
+}TEST_ENTRY;
+
+static uint32_t testStamp;
+static int testNAllocs;
+static bool testReference[TEST_KEYS];
+
+static size_t _TestHash(OA_HASH_DCPT* pOH, const void* key)
+{
+    uint32_t x = *(const uint32_t*)key;
+
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x % pOH->hEntries;
+}
+
+// evicts the oldest entry it's offered
+static OA_HASH_ENTRY* _TestDelete(OA_HASH_DCPT* pOH)
+{
+    size_t ix, nEntries = TCPIP_OAHASH_EntryRange(pOH);
+    TEST_ENTRY *pE, *pOldest = 0;
+
+    for(ix = 0; ix < nEntries; ix++)
+    {
+        pE = (TEST_ENTRY*)TCPIP_OAHASH_EntryGet(pOH, ix);
+        if(pE->hEntry.flags.busy != 0 && (pOldest == 0 || pE->stamp < pOldest->stamp))
+        {
+            pOldest = pE;
+        }
+    }
+
+    return pOldest != 0 ? &pOldest->hEntry : 0;
+}
+
+static int _TestKeyCompare(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* hEntry, const void* key)
+{
+    return ((TEST_ENTRY*)hEntry)->key != *(const uint32_t*)key;
+}
+
+static void _TestKeyCopy(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* dstEntry, const void* key)
+{
+    ((TEST_ENTRY*)dstEntry)->key = *(const uint32_t*)key;
+    ((TEST_ENTRY*)dstEntry)->stamp = testStamp++;
+}
+
+static const void* _TestEntryKey(OA_HASH_DCPT* pOH, OA_HASH_ENTRY* hEntry)
+{
+    return &((TEST_ENTRY*)hEntry)->key;
+}
+
+static void* _TestAlloc(OA_HASH_DCPT* pOH, size_t nBytes)
+{
+    void* memBlk = malloc(nBytes);
+
+    // garbage in the new buckets
+    memset(memBlk, HOST_TEST_HEAP_POISON, nBytes);
+    testNAllocs++;
+    return memBlk;
+}
+
+static void _TestFree(OA_HASH_DCPT* pOH, void* memBlk)
+{
+    free(memBlk);
+    testNAllocs--;
+}
+
+static void _TestCreate(OA_HASH_DCPT* pOH, size_t hEntries, OA_HASH_DEL_ENTRY_F delF)
+{
+    memset(pOH, 0, sizeof(*pOH));
+    pOH->hEntrySize = sizeof(TEST_ENTRY);
+    pOH->hEntries = hEntries;
+    pOH->probeStep = 1;
+    pOH->hashF = _TestHash;
+    pOH->delF = delF;
+    pOH->cmpF = _TestKeyCompare;
+    pOH->cpyF = _TestKeyCopy;
+    pOH->keyF = _TestEntryKey;
+    pOH->hFlags = OA_HASH_FLAG_ROBIN_HOOD | OA_HASH_FLAG_RESIZE;
+    pOH->allocF = _TestAlloc;
+    pOH->freeF = _TestFree;
+    pOH->minEntries = TEST_MIN_ENTRIES;
+    pOH->maxEntries = TEST_MAX_ENTRIES;
+    pOH->growLoad = TEST_GROW_LOAD;
+    pOH->shrinkLoad = TEST_SHRINK_LOAD;
+    pOH->memBlk = _TestAlloc(pOH, hEntries * sizeof(TEST_ENTRY));
+    TCPIP_OAHASH_Initialize(pOH);
+}
+
+// the hash holds exactly the reference keys
+static void _TestVerify(OA_HASH_DCPT* pOH)
+{
+    uint32_t key;
+    size_t nKeys = 0, nIter = 0;
+    OA_HASH_ITERATOR hIter;
+    TEST_ENTRY* pE;
+
+    for(key = 0; key < TEST_KEYS; key++)
+    {
+        pE = (TEST_ENTRY*)TCPIP_OAHASH_EntryLookup(pOH, &key);
+        HOST_TEST_CHECK((pE != 0) == testReference[key]);
+        HOST_TEST_CHECK(pE == 0 || pE->key == key);
+        nKeys += testReference[key] ? 1 : 0;
+    }
+
+    TCPIP_OAHASH_IteratorInit(pOH, &hIter);
+    while((pE = (TEST_ENTRY*)TCPIP_OAHASH_IteratorNext(pOH, &hIter)) != 0)
+    {
+        HOST_TEST_CHECK(pE->key < TEST_KEYS && testReference[pE->key]);
+        nIter++;
+    }
+
+    HOST_TEST_CHECK(nIter == nKeys && pOH->fullSlots == nKeys);
+}
+
+static void _TestRandom(void)
+{
+    int op;
+    uint32_t key;
+    size_t minEntries = ~0, maxEntries = 0;
+    OA_HASH_DCPT hashDcpt;
+    OA_HASH_ENTRY* pE;
+
+    _TestCreate(&hashDcpt, TEST_MIN_ENTRIES, 0);
+    memset(testReference, 0, sizeof(testReference));
+
+    srand(2024);
+    for(op = 0; op < TEST_OPERATIONS; op++)
+    {
+        // phases of growth and shrinking
+        int insertPercent = (op / 20000) % 2 == 0 ? 70 : 30;
+        key = rand() % TEST_KEYS;
+        if(rand() % 100 < insertPercent)
+        {
+            pE = TCPIP_OAHASH_EntryLookupOrInsert(&hashDcpt, &key);
+            if(pE != 0)
+            {
+                HOST_TEST_CHECK(pE->flags.newEntry == !testReference[key]);
+                testReference[key] = true;
+            }
+            else
+            {   // only when full, no delete function
+                HOST_TEST_CHECK(hashDcpt.fullSlots - hashDcpt.oldFullSlots >= hashDcpt.hEntries - 1);
+            }
+        }
+        else if((pE = TCPIP_OAHASH_EntryLookup(&hashDcpt, &key)) != 0)
+        {
+            TCPIP_OAHASH_EntryRemove(&hashDcpt, pE);
+            testReference[key] = false;
+        }
+
+        if(rand() % 4 == 0)
+        {
+            TCPIP_OAHASH_ResizeStep(&hashDcpt, 1 + rand() % 16);
+        }
+
+        minEntries = hashDcpt.hEntries < minEntries ? hashDcpt.hEntries : minEntries;
+        maxEntries = hashDcpt.hEntries > maxEntries ? hashDcpt.hEntries : maxEntries;
+        if(op % 97 == 0)
+        {
+            _TestVerify(&hashDcpt);
+        }
+    }
+    _TestVerify(&hashDcpt);
+
+    // resized both ways
+    HOST_TEST_CHECK(minEntries == TEST_MIN_ENTRIES && maxEntries == TEST_MAX_ENTRIES);
+
+    TCPIP_OAHASH_Deinitialize(&hashDcpt);
+    HOST_TEST_CHECK(testNAllocs == 0);
+}
+
+// full current array, the oldest entries not migrated yet
+static void _TestFullWhileMigrating(void)
+{
+    uint32_t key;
+    OA_HASH_DCPT hashDcpt;
+    OA_HASH_ENTRY *pE, *pBkt;
+    size_t nOld;
+
+    // a few old entries: the 64 buckets shrink to 32
+    _TestCreate(&hashDcpt, 64, _TestDelete);
+    memset(testReference, 0, sizeof(testReference));
+    for(key = 0; key < 8; key++)
+    {
+        HOST_TEST_CHECK(TCPIP_OAHASH_EntryLookupOrInsert(&hashDcpt, &key) != 0);
+        testReference[key] = true;
+    }
+    HOST_TEST_CHECK(TCPIP_OAHASH_ResizeStep(&hashDcpt, 0));
+    HOST_TEST_CHECK(hashDcpt.hEntries == 32 && hashDcpt.oldFullSlots == 8);
+
+    // new keys fill the current array, no migration in between
+    for(key = 100; hashDcpt.fullSlots - hashDcpt.oldFullSlots < hashDcpt.hEntries - 1; key++)
+    {
+        pBkt = _OAHashRobinHoodFindBkt(&hashDcpt, &key);
+        HOST_TEST_CHECK(pBkt != 0 && pBkt->flags.busy == 0);
+        pBkt->flags.busy = 1;
+        testReference[key] = true;
+    }
+    nOld = hashDcpt.oldFullSlots;
+    HOST_TEST_CHECK(nOld == 8);
+
+    // the oldest entries are the old ones; the new key needs a current bucket
+    key = 99;
+    pE = TCPIP_OAHASH_EntryLookupOrInsert(&hashDcpt, &key);
+    HOST_TEST_CHECK(pE != 0 && pE->flags.newEntry != 0 && ((TEST_ENTRY*)pE)->key == key);
+    testReference[key] = true;
+
+    // the entries not migrated are all there, the oldest current one went
+    HOST_TEST_CHECK(hashDcpt.oldFullSlots == nOld);
+    testReference[100] = false;
+    _TestVerify(&hashDcpt);
+
+    // once there's room, the migration completes
+    for(key = 101; key < 101 + nOld; key++)
+    {
+        TCPIP_OAHASH_EntryRemove(&hashDcpt, TCPIP_OAHASH_EntryLookup(&hashDcpt, &key));
+        testReference[key] = false;
+    }
+    while(TCPIP_OAHASH_ResizeStep(&hashDcpt, 4));
+    HOST_TEST_CHECK(hashDcpt.oldMemBlk == 0);
+    _TestVerify(&hashDcpt);
+
+    TCPIP_OAHASH_Deinitialize(&hashDcpt);
+    HOST_TEST_CHECK(testNAllocs == 0);
+}
+
+int main(void)
+{
+    _TestRandom();
+    _TestFullWhileMigrating();
+
+    return HOST_TEST_Result("oahash_resize");
+}
@@ -0,0 +1,415 @@
+/*******************************************************************************
+  Socket ready set test
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    socket_ready.c
+
+  Summary:
+    Socket ready set with many TCP and UDP sockets
+
+  Description:
+    The test stands for the stack: it calls the socket signal handlers
+    the ready set registers, while an application thread waits on the set.
+    Covers the report of the data already there when a socket is added,
+    the full set, the round robin collection, remove and re-add,
+    the deregistration on delete and the signal to wake-up latency.
+*******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+//DOM-IGNORE-END
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host_test.h"
+
+// the module under test, for access to its internal state
+#include "tcpip/src/tcpip_socket_ready.c"
+
+#if !defined(TCPIP_STACK_USE_SOCKET_READY)
+#error "the test needs TCPIP_STACK_USE_SOCKET_READY"
+#endif
+
+#define TEST_TCP_SOCKETS        32
+#define TEST_UDP_SOCKETS        32
+#define TEST_SOCKETS            (TEST_TCP_SOCKETS + TEST_UDP_SOCKETS)
+#define TEST_EVENTS             2000    // RX signals of the latency run
+#define TEST_MAX_LATENCY_US     500000  // a wake-up that never happened, not a slow one
+
+// socket state, as seen by the ready set
+typedef struct
+{
+    const void*     handler;    // registered signal handler, 0 if none
+    const void*     hParam;
+    int             sigMask;
+    uint16_t        rxBytes;
+    uint16_t        txSpace;
+}TEST_SOCKET;
+
+static TEST_SOCKET testTcp[TEST_TCP_SOCKETS];
+static TEST_SOCKET testUdp[TEST_UDP_SOCKETS];
+
+static TCPIP_SOCKET_READY_SET testSet;
+static TCPIP_SOCKET_READY_ENTRY testEntries[TEST_SOCKETS];
+static int testNotifies;
+
+// latency run
+static uint64_t testSignalTime[TEST_SOCKETS];   // us, last RX signal
+static volatile int testSignalSeq[TEST_SOCKETS];
+static volatile int testSeenSeq[TEST_SOCKETS];
+static uint64_t testLatencySum, testLatencyMax;
+static int testNLatency, testNWakeups;
+static volatile bool testDone;
+
+// socket services used by the ready set
+
+TCPIP_TCP_SIGNAL_HANDLE TCPIP_TCP_SignalHandlerRegister(TCP_SOCKET s, TCPIP_TCP_SIGNAL_TYPE sigMask, TCPIP_TCP_SIGNAL_FUNCTION handler, const void* hParam)
+{
+    if(s < 0 || s >= TEST_TCP_SOCKETS || testTcp[s].handler != 0)
+    {   // one handler per socket
+        return 0;
+    }
+    testTcp[s].handler = handler;
+    testTcp[s].hParam = hParam;
+    testTcp[s].sigMask = sigMask;
+    return (TCPIP_TCP_SIGNAL_HANDLE)(testTcp + s);
+}
+
+bool TCPIP_TCP_SignalHandlerDeregister(TCP_SOCKET s, TCPIP_TCP_SIGNAL_HANDLE hSig)
+{
+    HOST_TEST_CHECK(hSig == (TCPIP_TCP_SIGNAL_HANDLE)(testTcp + s) && testTcp[s].handler != 0);
+    testTcp[s].handler = 0;
+    return true;
+}
+
+uint16_t TCPIP_TCP_GetIsReady(TCP_SOCKET s)
+{
+    return testTcp[s].rxBytes;
+}
+
+uint16_t TCPIP_TCP_PutIsReady(TCP_SOCKET s)
+{
+    return testTcp[s].txSpace;
+}
+
+bool TCPIP_TCP_IsConnected(TCP_SOCKET s)
+{
+    return true;
+}
+
+TCPIP_UDP_SIGNAL_HANDLE TCPIP_UDP_SignalHandlerRegister(UDP_SOCKET s, TCPIP_UDP_SIGNAL_TYPE sigMask, TCPIP_UDP_SIGNAL_FUNCTION handler, const void* hParam)
+{
+    if(s < 0 || s >= TEST_UDP_SOCKETS || testUdp[s].handler != 0)
+    {
+        return 0;
+    }
+    testUdp[s].handler = handler;
+    testUdp[s].hParam = hParam;
+    testUdp[s].sigMask = sigMask;
+    return (TCPIP_UDP_SIGNAL_HANDLE)(testUdp + s);
+}
+
+bool TCPIP_UDP_SignalHandlerDeregister(UDP_SOCKET s, TCPIP_UDP_SIGNAL_HANDLE hSig)
+{
+    HOST_TEST_CHECK(hSig == (TCPIP_UDP_SIGNAL_HANDLE)(testUdp + s) && testUdp[s].handler != 0);
+    testUdp[s].handler = 0;
+    return true;
+}
+
+uint16_t TCPIP_UDP_GetIsReady(UDP_SOCKET s)
+{
+    return testUdp[s].rxBytes;
+}
+
+uint16_t TCPIP_UDP_PutIsReady(UDP_SOCKET s)
+{
+    return testUdp[s].txSpace;
+}
+
+// the stack side: signals a socket, as the TCP/UDP modules do
+// sockets 0 - TEST_TCP_SOCKETS - 1 are TCP, the following ones UDP
+static void _TestSignal(int sockIx, int sigType)
+{
+    if(sockIx < TEST_TCP_SOCKETS)
+    {
+        TEST_SOCKET* pSkt = testTcp + sockIx;
+        if(pSkt->handler != 0 && (pSkt->sigMask & sigType) != 0)
+        {
+            (*(TCPIP_TCP_SIGNAL_FUNCTION)pSkt->handler)(sockIx, 0, sigType, pSkt->hParam);
+        }
+    }
+    else
+    {
+        TEST_SOCKET* pSkt = testUdp + sockIx - TEST_TCP_SOCKETS;
+        if(pSkt->handler != 0 && (pSkt->sigMask & sigType) != 0)
+        {
+            (*(TCPIP_UDP_SIGNAL_FUNCTION)pSkt->handler)(sockIx - TEST_TCP_SOCKETS, 0, sigType, pSkt->hParam);
+        }
+    }
+}
+
+static int _TestResultIx(const TCPIP_SOCKET_READY_RESULT* pRes)
+{
+    return pRes->type == TCPIP_SOCKET_READY_TYPE_TCP ? pRes->socket : pRes->socket + TEST_TCP_SOCKETS;
+}
+
+static int _TestHandlers(void)
+{
+    int ix, nHandlers = 0;
+
+    for(ix = 0; ix < TEST_TCP_SOCKETS; ix++)
+    {
+        nHandlers += testTcp[ix].handler != 0 ? 1 : 0;
+    }
+    for(ix = 0; ix < TEST_UDP_SOCKETS; ix++)
+    {
+        nHandlers += testUdp[ix].handler != 0 ? 1 : 0;
+    }
+    return nHandlers;
+}
+
+static uint64_t _TestTimeUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void _TestNotify(TCPIP_SOCKET_READY_SET* pSet, const void* param)
+{
+    HOST_TEST_CHECK(pSet == &testSet && param == &testNotifies);
+    testNotifies++;
+}
+
+// adds all the sockets: TCP for all the events, UDP for RX only
+static void _TestAddAll(void)
+{
+    int ix;
+
+    for(ix = 0; ix < TEST_TCP_SOCKETS; ix++)
+    {
+        HOST_TEST_CHECK(TCPIP_SOCKET_ReadyAdd(&testSet, TCPIP_SOCKET_READY_TYPE_TCP, ix, TCPIP_SOCKET_READY_EV_ALL));
+    }
+    for(ix = 0; ix < TEST_UDP_SOCKETS; ix++)
+    {
+        HOST_TEST_CHECK(TCPIP_SOCKET_ReadyAdd(&testSet, TCPIP_SOCKET_READY_TYPE_UDP, ix, TCPIP_SOCKET_READY_EV_RX));
+    }
+}
+
+// data and TX space there before the add are reported right away
+static void _TestPreReady(void)
+{
+    TCPIP_SOCKET_READY_RESULT results[4];
+
+    HOST_TEST_CHECK(TCPIP_SOCKET_ReadySetCreate(&testSet, testEntries, TEST_SOCKETS, _TestNotify, &testNotifies));
+
+    testTcp[3].rxBytes = 100;
+    testUdp[7].txSpace = 512;
+    HOST_TEST_CHECK(TCPIP_SOCKET_ReadyAdd(&testSet, TCPIP_SOCKET_READY_TYPE_TCP, 3, TCPIP_SOCKET_READY_EV_ALL));
+    HOST_TEST_CHECK(TCPIP_SOCKET_ReadyAdd(&testSet, TCPIP_SOCKET_READY_TYPE_UDP, 7, TCPIP_SOCKET_READY_EV_TX));
+    HOST_TEST_CHECK(TCPIP_SOCKET_ReadyWait(&testSet, results, 4, 0) == 2);
+    HOST_TEST_CHECK(results[0].type == TCPIP_SOCKET_READY_TYPE_TCP && results[0].socket == 3 && results[0].events == TCPIP_SOCKET_READY_EV_RX);
+    HOST_TEST_CHECK(results[1].type == TCPIP_SOCKET_READY_TYPE_UDP && results[1].socket == 7 && results[1].events == TCPIP_SOCKET_READY_EV_TX);
+    HOST_TEST_CHECK(TCPIP_SOCKET_ReadyWait(&testSet, results, 4, 0) == 0);
+
+    // not interested in the UDP RX
+    testUdp[7].rxBytes = 10;
+    _TestSignal(TEST_TCP_SOCKETS + 7, TCPIP_UDP_SIGNAL_RX_DATA);
+    HOST_TEST_CHECK(TCPIP_SOCKET_ReadyWait(&testSet, results, 4, 0) == 0);
+
+    testTcp[3].rxBytes = 0;
+    testUdp[7].rxBytes = testUdp[7].txSpace = 0;
+    HOST_TEST_CHECK(TCPIP_SOCKET_ReadyRemove(&testSet, TCPIP_SOCKET_READY_TYPE_TCP, 3));
+    HOST_TEST_CHECK(TCPIP_SOCKET_ReadyRemove(&testSet, TCPIP_SOCKET_READY_TYPE_UDP, 7));
+    HOST_TEST_CHECK(_TestHandlers() == 0);
+}
+
+// duplicate and full set adds fail; the wait times out when nothing is ready
+static void _TestFullSet(void)
+{
+    TCPIP_SOCKET_READY_RESULT results[4];
+    TCPIP_SOCKET_READY_SET otherSet;
+    TCPIP_SOCKET_READY_ENTRY otherEntries[2];
+    uint64_t tStart;
+
+    _TestAddAll();
+    HOST_TEST_CHECK(_TestHandlers() == TEST_SOCKETS);
+    HOST_TEST_CHECK(!TCPIP_SOCKET_ReadyAdd(&testSet, TCPIP_SOCKET_READY_TYPE_UDP, 1, TCPIP_SOCKET_READY_EV_RX));
+
+    // the set is full; the socket handler slot of a set member is taken
+    HOST_TEST_CHECK(TCPIP_SOCKET_ReadyRemove(&testSet, TCPIP_SOCKET_READY_TYPE_UDP, 1));
+    testUdp[1].handler = (const void*)_TestNotify;
+    HOST_TEST_CHECK(!TCPIP_SOCKET_ReadyAdd(&testSet, TCPIP_SOCKET_READY_TYPE_UDP, 1, TCPIP_SOCKET_READY_EV_RX));
+    testUdp[1].handler = 0;
+    HOST_TEST_CHECK(TCPIP_SOCKET_ReadyAdd(&testSet, TCPIP_SOCKET_READY_TYPE_UDP, 1, TCPIP_SOCKET_READY_EV_RX));
+    HOST_TEST_CHECK(TCPIP_SOCKET_ReadySetCreate(&otherSet, otherEntries, 2, 0, 0));
+    HOST_TEST_CHECK(!TCPIP_SOCKET_ReadyAdd(&otherSet, TCPIP_SOCKET_READY_TYPE_TCP, 0, TCPIP_SOCKET_READY_EV_RX));
+    TCPIP_SOCKET_ReadySetDelete(&otherSet);
+    HOST_TEST_CHECK(_TestHandlers() == TEST_SOCKETS);
+
+    tStart = _TestTimeUs();
+    HOST_TEST_CHECK(TCPIP_SOCKET_ReadyWait(&testSet, results, 4, 20) == 0);
+    HOST_TEST_CHECK(_TestTimeUs() - tStart >= 19000);
+}
+
+// a busy socket does not hide the others; events are edge triggered
+static void _TestRoundRobin(void)
+{
+    TCPIP_SOCKET_READY_RESULT results[4];
+    int reports[TEST_SOCKETS] = {0};
+    int ix, jx, nRes, nNotifies;
+
+    nNotifies = testNotifies;
+    for(ix = 0; ix < 16; ix++)
+    {
+        _TestSignal(ix * 4, ix * 4 < TEST_TCP_SOCKETS ? TCPIP_TCP_SIGNAL_RX_DATA : TCPIP_UDP_SIGNAL_RX_DATA);
+    }
+    // pending already: no new notification
+    _TestSignal(0, TCPIP_TCP_SIGNAL_RX_DATA);
+    HOST_TEST_CHECK(testNotifies == nNotifies + 16);
+
+    for(ix = 0; ix < 4; ix++)
+    {
+        nRes = TCPIP_SOCKET_ReadyWait(&testSet, results, 4, 0);
+        HOST_TEST_CHECK(nRes == 4);
+        for(jx = 0; jx < nRes; jx++)
+        {
+            reports[_TestResultIx(results + jx)]++;
+            HOST_TEST_CHECK(results[jx].events == TCPIP_SOCKET_READY_EV_RX);
+        }
+        // socket 0 keeps receiving
+        _TestSignal(0, TCPIP_TCP_SIGNAL_RX_DATA);
+    }
+
+    for(ix = 0; ix < 16; ix++)
+    {
+        HOST_TEST_CHECK(reports[ix * 4] == 1 || (ix == 0 && reports[0] >= 1));
+    }
+    while(TCPIP_SOCKET_ReadyWait(&testSet, results, 4, 0) != 0);
+
+    // TX space and state changes of a TCP socket
+    _TestSignal(5, TCPIP_TCP_SIGNAL_TX_SPACE);
+    _TestSignal(5, TCPIP_TCP_SIGNAL_RX_FIN);
+    HOST_TEST_CHECK(TCPIP_SOCKET_ReadyWait(&testSet, results, 4, 0) == 1);
+    HOST_TEST_CHECK(results[0].socket == 5 && results[0].events == (TCPIP_SOCKET_READY_EV_TX | TCPIP_SOCKET_READY_EV_STATE));
+}
+
+static void* _TestWaiter(void* param)
+{
+    TCPIP_SOCKET_READY_RESULT results[8];
+    int ix, nRes, sockIx;
+    uint64_t tNow, latency;
+
+    while(!testDone)
+    {
+        nRes = TCPIP_SOCKET_ReadyWait(&testSet, results, sizeof(results) / sizeof(*results), 100);
+        tNow = _TestTimeUs();
+        testNWakeups++;
+        for(ix = 0; ix < nRes; ix++)
+        {
+            sockIx = _TestResultIx(results + ix);
+            latency = tNow - __atomic_load_n(testSignalTime + sockIx, __ATOMIC_ACQUIRE);
+            testLatencySum += latency;
+            testLatencyMax = latency > testLatencyMax ? latency : testLatencyMax;
+            testNLatency++;
+            testSeenSeq[sockIx] = testSignalSeq[sockIx];
+        }
+    }
+
+    return 0;
+}
+
+// random RX signals 1-3 ms apart, the application thread blocked on the set
+static void _TestLatency(void)
+{
+    pthread_t waitThread;
+    int ev, sockIx;
+
+    srand(1);
+    testDone = false;
+    HOST_TEST_CHECK(pthread_create(&waitThread, 0, _TestWaiter, 0) == 0);
+    for(ev = 0; ev < TEST_EVENTS; ev++)
+    {
+        usleep(1000 + rand() % 2000);
+        sockIx = rand() % TEST_SOCKETS;
+        testSignalSeq[sockIx]++;
+        __atomic_store_n(testSignalTime + sockIx, _TestTimeUs(), __ATOMIC_RELEASE);
+        _TestSignal(sockIx, sockIx < TEST_TCP_SOCKETS ? TCPIP_TCP_SIGNAL_RX_DATA : TCPIP_UDP_SIGNAL_RX_DATA);
+    }
+    usleep(50000);
+    testDone = true;
+    pthread_join(waitThread, 0);
+
+    // every signal reported, at most once
+    for(sockIx = 0; sockIx < TEST_SOCKETS; sockIx++)
+    {
+        HOST_TEST_CHECK(testSeenSeq[sockIx] == testSignalSeq[sockIx]);
+    }
+    HOST_TEST_CHECK(testNLatency > 0 && testNLatency <= TEST_EVENTS);
+    HOST_TEST_CHECK(testLatencyMax < TEST_MAX_LATENCY_US);
+
+    printf("socket_ready: %d sockets, %d events, %d reports, %d wake-ups, latency avg %llu us, max %llu us\n",
+            TEST_SOCKETS, TEST_EVENTS, testNLatency, testNWakeups,
+            (unsigned long long)(testNLatency != 0 ? testLatencySum / testNLatency : 0), (unsigned long long)testLatencyMax);
+}
+
+// a removed socket is not reported and can be added again; delete deregisters all
+static void _TestRemoveDelete(void)
+{
+    TCPIP_SOCKET_READY_RESULT results[4];
+
+    _TestSignal(5, TCPIP_TCP_SIGNAL_RX_DATA);
+    HOST_TEST_CHECK(TCPIP_SOCKET_ReadyRemove(&testSet, TCPIP_SOCKET_READY_TYPE_TCP, 5));
+    HOST_TEST_CHECK(!TCPIP_SOCKET_ReadyRemove(&testSet, TCPIP_SOCKET_READY_TYPE_TCP, 5));
+    HOST_TEST_CHECK(testTcp[5].handler == 0);
+    HOST_TEST_CHECK(TCPIP_SOCKET_ReadyWait(&testSet, results, 4, 0) == 0);
+
+    HOST_TEST_CHECK(TCPIP_SOCKET_ReadyAdd(&testSet, TCPIP_SOCKET_READY_TYPE_TCP, 5, TCPIP_SOCKET_READY_EV_RX));
+    _TestSignal(5, TCPIP_TCP_SIGNAL_RX_DATA);
+    HOST_TEST_CHECK(TCPIP_SOCKET_ReadyWait(&testSet, results, 4, 0) == 1 && results[0].socket == 5);
+
+    TCPIP_SOCKET_ReadySetDelete(&testSet);
+    HOST_TEST_CHECK(_TestHandlers() == 0);
+}
+
+int main(void)
+{
+    _TestPreReady();
+    _TestFullSet();
+    _TestRoundRobin();
+    _TestLatency();
+    _TestRemoveDelete();
+
+    return HOST_TEST_Result("socket_ready");
+}
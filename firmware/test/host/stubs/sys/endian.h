@@ -0,0 +1,4 @@
+#ifndef _STUB_ENDIAN_H
+#define _STUB_ENDIAN_H
+#include <endian.h>
+#endif
@@ -0,0 +1,12 @@
+#ifndef _STUB_KMEM_H
+#define _STUB_KMEM_H
+#include <stdint.h>
+#define KVA_TO_PA(v)    ((uint32_t)(v) & 0x1fffffff)
+#define PA_TO_KVA0(pa)  ((void *)((pa) | 0x80000000))
+#define PA_TO_KVA1(pa)  ((void *)((pa) | 0xa0000000))
+#define KVA0_TO_KVA1(v) ((void *)((uint32_t)(v) | 0x20000000))
+#define KVA1_TO_KVA0(v) ((void *)((uint32_t)(v) & ~0x20000000))
+#define IS_KVA(v)  ((int)(v) < 0)
+#define IS_KVA0(v) (((uint32_t)(v) >> 29) == 0x4)
+#define IS_KVA1(v) (((uint32_t)(v) >> 29) == 0x5)
+#endif
@@ -0,0 +1,788 @@
+/*******************************************************************************
+  SYS_RANDOM pools and fast PRNG test
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    sys_random.c
+
+  Summary:
+    Known answers and NIST SP 800-22 statistics of the SYS_RANDOM adapter
+
+  Description:
+    The SYS_RANDOM adapter runs over the CRYPT_RNG calls of the test:
+    - known answers, over a DRBG replaced by a byte counter:
+        - a pool hands out the bytes of each fill in order and erases them,
+          the few bytes left are dropped and the pools are independent
+        - the large requests go to the DRBG, not to a pool
+        - the DRBG is reinstantiated every SYS_RANDOM_POOL_RESEED_FILLS fills
+        - SYS_RANDOM_FastGet() gives the xoshiro128** reference sequence,
+          is reseeded every SYS_RANDOM_FAST_RESEED_COUNT values
+          and never keeps the all zero state
+    - statistics, over the wolfCrypt Hash-DRBG:
+      a NIST SP 800-22 subset on sequences built from small requests,
+      for both pools and SYS_RANDOM_FastGet(), with a 32 bit LCG as control.
+      The host DRBG is seeded from the virtual SYS_TIME: the runs are repeatable.
+    - the request rate of the SYS_RANDOM calls.
+*******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+//DOM-IGNORE-END
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "host_test.h"
+
+// the module under test, for access to its internal state
+#include "system/sys_random_h2_adapter.c"
+
+#include "wolfssl/wolfcrypt/random.h"
+
+#if (_SYS_RANDOM_POOL == 0) || (SYS_RANDOM_POOL_SIZE != 64)
+#error "the test needs 64 byte SYS_RANDOM pools"
+#endif
+
+#define TEST_SEQUENCES          100         // NIST SP 800-22: at least 55 for the p-value uniformity
+#define TEST_BITS               1000000     // bits of a sequence
+#define TEST_ALPHA              0.01
+#define TEST_UNIFORMITY_MIN     0.0001      // smallest p-value of the p-values uniformity
+#define TEST_RATE_REQUESTS      2000000
+
+// what the DRBG of the test gives
+typedef enum
+{
+    TEST_RNG_DRBG,          // the wolfCrypt Hash-DRBG
+    TEST_RNG_COUNTER,       // bytes 0, 1, 2, ...
+    TEST_RNG_ZERO,          // zeros
+}TEST_RNG_MODE;
+
+// the sources of the statistical tests
+typedef enum
+{
+    TEST_SOURCE_POOL_ID,        // SYS_RANDOM_PoolGet(SYS_RANDOM_POOL_NET_ID)
+    TEST_SOURCE_POOL_SECRET,    // 2 byte SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_SECRET)
+    TEST_SOURCE_FAST,           // SYS_RANDOM_FastGet()
+    TEST_SOURCE_LCG,            // control: the raw 32 bit LCG of the C library examples
+
+    TEST_SOURCES
+}TEST_SOURCE;
+
+static const char* testSourceNames[TEST_SOURCES] =
+{
+    "pool NET_ID, 4 B requests",
+    "pool NET_SECRET, 2 B requests",
+    "SYS_RANDOM_FastGet",
+    "control: 32 bit LCG",
+};
+
+typedef double (*TEST_STAT_FNC)(void);
+
+typedef struct
+{
+    const char*     name;
+    TEST_STAT_FNC   statF;      // returns the p-value of the test sequence
+}TEST_STAT;
+
+static TEST_RNG_MODE testRngMode;
+static uint8_t testRngCounter;
+static int testRngInits;
+static int testRngDeinits;
+static int testRngGenerates;
+static unsigned int testRngLastSize;
+
+static uint8_t testBits[TEST_BITS];
+static uint32_t testCounts[1 << 17];
+
+static volatile uint32_t testSink;
+
+// the CRYPT_RNG calls, as crypto.c does them, or the known answer generators
+
+// the host seed comes from SYS_TIME: a new instantiation needs a new time
+// to get a new seed, as the TRNG would give
+int CRYPT_RNG_Initialize(CRYPT_RNG_CTX* rng)
+{
+    testRngInits++;
+    HOST_TEST_TimeAdvance(1);
+    return testRngMode == TEST_RNG_DRBG ? wc_InitRng((WC_RNG*)rng) : 0;
+}
+
+int CRYPT_RNG_Deinitialize(CRYPT_RNG_CTX* rng)
+{
+    testRngDeinits++;
+    if(testRngMode == TEST_RNG_DRBG)
+    {
+        (void)wc_FreeRng((WC_RNG*)rng);
+    }
+    return 0;
+}
+
+int CRYPT_RNG_BlockGenerate(CRYPT_RNG_CTX* rng, unsigned char* b, unsigned int sz)
+{
+    unsigned int ix;
+
+    testRngGenerates++;
+    testRngLastSize = sz;
+    switch(testRngMode)
+    {
+        case TEST_RNG_COUNTER:
+            for(ix = 0; ix < sz; ix++)
+            {
+                b[ix] = testRngCounter++;
+            }
+            return 0;
+
+        case TEST_RNG_ZERO:
+            memset(b, 0, sz);
+            return 0;
+
+        default:
+            return wc_RNG_GenerateBlock((WC_RNG*)rng, b, sz);
+    }
+}
+
+int CRYPT_RNG_Get(CRYPT_RNG_CTX* rng, unsigned char* b)
+{
+    return CRYPT_RNG_BlockGenerate(rng, b, 1);
+}
+
+// the DRBG is instantiated again by the next SYS_RANDOM call
+static void _TestRngModeSet(TEST_RNG_MODE mode)
+{
+    SYS_RANDOM_CryptoDeinitialize((SYS_MODULE_OBJ)pRandCtx);
+    testRngMode = mode;
+    testRngCounter = 0;
+    testRngInits = testRngDeinits = testRngGenerates = 0;
+}
+
+static bool _TestIsCounter(const uint8_t* pBuff, size_t size, uint8_t first)
+{
+    size_t ix;
+
+    for(ix = 0; ix < size; ix++)
+    {
+        if(pBuff[ix] != (uint8_t)(first + ix))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void _TestPoolKnown(void)
+{
+    uint8_t buff[SYS_RANDOM_POOL_SIZE];
+    uint8_t zeros[SYS_RANDOM_POOL_SIZE] = {0};
+    SYS_RANDOM_POOL_DCPT* pPool = randPools + SYS_RANDOM_POOL_NET_ID;
+    int ix;
+
+    _TestRngModeSet(TEST_RNG_COUNTER);
+
+    // a fill is handed out in order, one DRBG call
+    for(ix = 0; ix < SYS_RANDOM_POOL_SIZE / 4; ix++)
+    {
+        HOST_TEST_CHECK(SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_ID, buff, 4) == 4);
+        HOST_TEST_CHECK(_TestIsCounter(buff, 4, ix * 4));
+    }
+    HOST_TEST_CHECK(testRngInits == 1 && testRngGenerates == 1 && testRngLastSize == SYS_RANDOM_POOL_SIZE);
+    // nothing left behind
+    HOST_TEST_CHECK(pPool->nBytes == 0 && memcmp(pPool->data, zeros, sizeof(zeros)) == 0);
+
+    // the next request refills
+    HOST_TEST_CHECK(SYS_RANDOM_PoolGet(SYS_RANDOM_POOL_NET_ID) == 0x43424140);
+    HOST_TEST_CHECK(testRngGenerates == 2 && pPool->nBytes == SYS_RANDOM_POOL_SIZE - 4);
+
+    // the other pool has its own fill
+    HOST_TEST_CHECK(SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_SECRET, buff, 2) == 2);
+    HOST_TEST_CHECK(_TestIsCounter(buff, 2, 0x80) && testRngGenerates == 3);
+    HOST_TEST_CHECK(pPool->nBytes == SYS_RANDOM_POOL_SIZE - 4);
+
+    // the bytes too few for a request are dropped
+    for(ix = 0; ix < (SYS_RANDOM_POOL_SIZE - 4) / 3; ix++)
+    {
+        HOST_TEST_CHECK(SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_ID, buff, 3) == 3);
+        HOST_TEST_CHECK(_TestIsCounter(buff, 3, 0x44 + ix * 3));
+    }
+    HOST_TEST_CHECK(pPool->nBytes == 0 && testRngGenerates == 3);
+    HOST_TEST_CHECK(SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_ID, buff, 1) == 1);
+    HOST_TEST_CHECK(buff[0] == 0xc0 && testRngGenerates == 4);
+
+    // a large request goes to the DRBG
+    HOST_TEST_CHECK(SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_ID, buff, SYS_RANDOM_POOL_SIZE / 2 + 1) == SYS_RANDOM_POOL_SIZE / 2 + 1);
+    HOST_TEST_CHECK(testRngGenerates == 5 && testRngLastSize == SYS_RANDOM_POOL_SIZE / 2 + 1);
+    HOST_TEST_CHECK(pPool->nBytes == SYS_RANDOM_POOL_SIZE - 1);
+
+    // bad requests
+    HOST_TEST_CHECK(SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOLS, buff, 4) == 0);
+    HOST_TEST_CHECK(SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_ID, 0, 4) == 0);
+    HOST_TEST_CHECK(SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_ID, buff, 0) == 0);
+    HOST_TEST_CHECK(testRngGenerates == 5);
+
+    // the DRBG is instantiated again after SYS_RANDOM_POOL_RESEED_FILLS fills
+    randPoolFills = SYS_RANDOM_POOL_RESEED_FILLS - 1;
+    HOST_TEST_CHECK(SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_ID, buff, SYS_RANDOM_POOL_SIZE) == SYS_RANDOM_POOL_SIZE);
+    HOST_TEST_CHECK(SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_SECRET, buff, SYS_RANDOM_POOL_SIZE / 2) == SYS_RANDOM_POOL_SIZE / 2);
+    HOST_TEST_CHECK(testRngDeinits == 0 && randPoolFills == SYS_RANDOM_POOL_RESEED_FILLS - 1);
+    pPool->nBytes = 0;
+    HOST_TEST_CHECK(SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_ID, buff, 4) == 4);
+    HOST_TEST_CHECK(testRngDeinits == 0 && randPoolFills == SYS_RANDOM_POOL_RESEED_FILLS);
+    pPool->nBytes = 0;
+    HOST_TEST_CHECK(SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_ID, buff, 4) == 4);
+    HOST_TEST_CHECK(testRngDeinits == 1 && testRngInits == 2 && randPoolFills == 1);
+}
+
+static void _TestFastKnown(void)
+{
+    // xoshiro128** from the state {1, 2, 3, 4}
+    static const uint32_t knownFast[] =
+    {
+        11520, 0, 5927040, 70819200, 2031721883, 1637235492, 1287239034, 3734860849, 3729100597, 4258142804,
+    };
+    static const uint32_t knownState[4] = {1, 2, 3, 4};
+    uint32_t seed[4];
+    int ix;
+
+    _TestRngModeSet(TEST_RNG_COUNTER);
+    HOST_TEST_CHECK(SYS_RANDOM_CryptoInitialize() != 0);
+
+    memcpy(randFastState, knownState, sizeof(randFastState));
+    randFastCount = sizeof(knownFast) / sizeof(*knownFast);
+    for(ix = 0; ix < sizeof(knownFast) / sizeof(*knownFast); ix++)
+    {
+        HOST_TEST_CHECK(SYS_RANDOM_FastGet() == knownFast[ix]);
+    }
+    HOST_TEST_CHECK(randFastCount == 0 && testRngGenerates == 0);
+
+    // reseeded from the DRBG
+    testRngCounter = 0;
+    (void)SYS_RANDOM_FastGet();
+    HOST_TEST_CHECK(testRngGenerates == 1 && testRngLastSize == sizeof(randFastState));
+    HOST_TEST_CHECK(randFastCount == SYS_RANDOM_FAST_RESEED_COUNT - 1);
+    for(ix = 0; ix < SYS_RANDOM_FAST_RESEED_COUNT - 1; ix++)
+    {
+        (void)SYS_RANDOM_FastGet();
+    }
+    HOST_TEST_CHECK(randFastCount == 0 && testRngGenerates == 1);
+
+    // an all zero seed is not taken; neither the all zero state
+    memset(randFastState, 0, sizeof(randFastState));
+    _TestRngModeSet(TEST_RNG_ZERO);
+    (void)SYS_RANDOM_FastGet();
+    HOST_TEST_CHECK(testRngGenerates == 1 && randFastCount == 0);
+    memset(seed, 0, sizeof(seed));
+    HOST_TEST_CHECK(memcmp(randFastState, seed, sizeof(seed)) != 0);
+}
+
+// the incomplete gamma functions of the NIST SP 800-22 tests
+static double _TestIgamc(double a, double x);
+
+static double _TestIgam(double a, double x)
+{
+    double ax, r, c, sum;
+
+    if(x <= 0 || a <= 0)
+    {
+        return 0;
+    }
+    if(x > 1 && x > a)
+    {
+        return 1 - _TestIgamc(a, x);
+    }
+
+    ax = a * log(x) - x - lgamma(a);
+    r = a;
+    c = 1;
+    sum = 1;
+    do
+    {
+        r += 1;
+        c *= x / r;
+        sum += c;
+    }while(c / sum > 1e-15);
+
+    return exp(ax) * sum / a;
+}
+
+static double _TestIgamc(double a, double x)
+{
+    double ax, y, z, c, pkm2, qkm2, pkm1, qkm1, sum, pk, qk, yc, r, t;
+
+    if(x <= 0 || a <= 0)
+    {
+        return 1;
+    }
+    if(x < 1 || x < a)
+    {
+        return 1 - _TestIgam(a, x);
+    }
+
+    // continued fraction
+    ax = a * log(x) - x - lgamma(a);
+    y = 1 - a;
+    z = x + y + 1;
+    c = 0;
+    pkm2 = 1;
+    qkm2 = x;
+    pkm1 = x + 1;
+    qkm1 = z * x;
+    sum = pkm1 / qkm1;
+    do
+    {
+        c += 1;
+        y += 1;
+        z += 2;
+        yc = y * c;
+        pk = pkm1 * z - pkm2 * yc;
+        qk = qkm1 * z - qkm2 * yc;
+        if(qk != 0)
+        {
+            r = pk / qk;
+            t = fabs((sum - r) / r);
+            sum = r;
+        }
+        else
+        {
+            t = 1;
+        }
+        pkm2 = pkm1;
+        pkm1 = pk;
+        qkm2 = qkm1;
+        qkm1 = qk;
+        if(fabs(pk) > 1e32)
+        {
+            pkm2 *= 1e-32;
+            pkm1 *= 1e-32;
+            qkm2 *= 1e-32;
+            qkm1 *= 1e-32;
+        }
+    }while(t > 1e-15);
+
+    return sum * exp(ax);
+}
+
+static double _TestNormal(double x)
+{
+    return 0.5 * erfc(-x / sqrt(2));
+}
+
+// counts the overlapping m bit patterns of the sequence, wrapped around
+static void _TestPatternCount(int m)
+{
+    uint32_t mask = (1 << m) - 1;
+    uint32_t pattern = 0;
+    int ix;
+
+    memset(testCounts, 0, (mask + 1) * sizeof(*testCounts));
+    for(ix = 0; ix < m - 1; ix++)
+    {
+        pattern = (pattern << 1) | testBits[ix];
+    }
+    for(ix = 0; ix < TEST_BITS; ix++)
+    {
+        pattern = ((pattern << 1) | testBits[(ix + m - 1) % TEST_BITS]) & mask;
+        testCounts[pattern]++;
+    }
+}
+
+static double _TestStatFrequency(void)
+{
+    long sum = 0;
+    int ix;
+
+    for(ix = 0; ix < TEST_BITS; ix++)
+    {
+        sum += testBits[ix] ? 1 : -1;
+    }
+    return erfc(labs(sum) / sqrt(TEST_BITS) / sqrt(2));
+}
+
+static double _TestStatBlockFrequency(void)
+{
+    const int blockLen = 128;
+    const int nBlocks = TEST_BITS / blockLen;
+    double chi = 0, pi;
+    int bx, ix, ones;
+
+    for(bx = 0; bx < nBlocks; bx++)
+    {
+        ones = 0;
+        for(ix = 0; ix < blockLen; ix++)
+        {
+            ones += testBits[bx * blockLen + ix];
+        }
+        pi = (double)ones / blockLen - 0.5;
+        chi += pi * pi;
+    }
+    return _TestIgamc(nBlocks / 2.0, chi * 4 * blockLen / 2);
+}
+
+static double _TestStatRuns(void)
+{
+    long ones = 0, runs = 1;
+    double pi;
+    int ix;
+
+    for(ix = 0; ix < TEST_BITS; ix++)
+    {
+        ones += testBits[ix];
+    }
+    pi = (double)ones / TEST_BITS;
+    if(fabs(pi - 0.5) >= 2 / sqrt(TEST_BITS))
+    {   // the frequency test fails: not run
+        return 0;
+    }
+
+    for(ix = 1; ix < TEST_BITS; ix++)
+    {
+        runs += testBits[ix] != testBits[ix - 1];
+    }
+    return erfc(fabs(runs - 2.0 * TEST_BITS * pi * (1 - pi)) / (2 * sqrt(2.0 * TEST_BITS) * pi * (1 - pi)));
+}
+
+static double _TestStatLongestRun(void)
+{   // M = 10000, K = 6, N = 75
+    static const double classProb[7] = {0.0882, 0.2092, 0.2483, 0.1933, 0.1208, 0.0675, 0.0727};
+    const int blockLen = 10000;
+    const int nBlocks = 75;
+    int classCount[7] = {0};
+    int bx, ix, run, longest, cx;
+    double chi = 0;
+
+    for(bx = 0; bx < nBlocks; bx++)
+    {
+        run = longest = 0;
+        for(ix = 0; ix < blockLen; ix++)
+        {
+            run = testBits[bx * blockLen + ix] ? run + 1 : 0;
+            longest = run > longest ? run : longest;
+        }
+        cx = longest <= 10 ? 0 : longest >= 16 ? 6 : longest - 10;
+        classCount[cx]++;
+    }
+
+    for(cx = 0; cx < 7; cx++)
+    {
+        chi += (classCount[cx] - nBlocks * classProb[cx]) * (classCount[cx] - nBlocks * classProb[cx]) / (nBlocks * classProb[cx]);
+    }
+    return _TestIgamc(3, chi / 2);
+}
+
+// psi square of the serial test
+static double _TestPsi2(int m)
+{
+    double sum = 0;
+    int ix;
+
+    _TestPatternCount(m);
+    for(ix = 0; ix < (1 << m); ix++)
+    {
+        sum += (double)testCounts[ix] * testCounts[ix];
+    }
+    return sum * (1 << m) / TEST_BITS - TEST_BITS;
+}
+
+static double _TestStatSerial(void)
+{
+    const int m = 16;
+
+    return _TestIgamc(1 << (m - 2), (_TestPsi2(m) - _TestPsi2(m - 1)) / 2);
+}
+
+// phi of the approximate entropy test
+static double _TestPhi(int m)
+{
+    double sum = 0, freq;
+    int ix;
+
+    _TestPatternCount(m);
+    for(ix = 0; ix < (1 << m); ix++)
+    {
+        if(testCounts[ix] != 0)
+        {
+            freq = (double)testCounts[ix] / TEST_BITS;
+            sum += freq * log(freq);
+        }
+    }
+    return sum;
+}
+
+static double _TestStatApproxEntropy(void)
+{
+    const int m = 10;
+    double apEn = _TestPhi(m) - _TestPhi(m + 1);
+
+    return _TestIgamc(1 << (m - 1), TEST_BITS * (log(2) - apEn));
+}
+
+static double _TestStatCusum(void)
+{   // forward mode
+    long sum = 0, zMax = 0, kx;
+    double n = TEST_BITS, z, sum1 = 0, sum2 = 0;
+    int ix;
+
+    for(ix = 0; ix < TEST_BITS; ix++)
+    {
+        sum += testBits[ix] ? 1 : -1;
+        zMax = labs(sum) > zMax ? labs(sum) : zMax;
+    }
+    z = zMax;
+
+    for(kx = (long)((-n / z + 1) / 4); kx <= (long)((n / z - 1) / 4); kx++)
+    {
+        sum1 += _TestNormal((4 * kx + 1) * z / sqrt(n)) - _TestNormal((4 * kx - 1) * z / sqrt(n));
+    }
+    for(kx = (long)((-n / z - 3) / 4); kx <= (long)((n / z - 1) / 4); kx++)
+    {
+        sum2 += _TestNormal((4 * kx + 3) * z / sqrt(n)) - _TestNormal((4 * kx + 1) * z / sqrt(n));
+    }
+    return 1 - sum1 + sum2;
+}
+
+// not in SP 800-22: the bytes distribution
+static double _TestStatByteChi(void)
+{
+    const int nBytes = TEST_BITS / 8;
+    double expected = nBytes / 256.0, chi = 0;
+    int ix, jx, val;
+
+    memset(testCounts, 0, 256 * sizeof(*testCounts));
+    for(ix = 0; ix < nBytes; ix++)
+    {
+        for(jx = 0, val = 0; jx < 8; jx++)
+        {
+            val = (val << 1) | testBits[ix * 8 + jx];
+        }
+        testCounts[val]++;
+    }
+
+    for(ix = 0; ix < 256; ix++)
+    {
+        chi += (testCounts[ix] - expected) * (testCounts[ix] - expected) / expected;
+    }
+    return _TestIgamc(255 / 2.0, chi / 2);
+}
+
+static const TEST_STAT testStats[] =
+{
+    {"frequency",                   _TestStatFrequency},
+    {"block frequency",             _TestStatBlockFrequency},
+    {"runs",                        _TestStatRuns},
+    {"longest run",                 _TestStatLongestRun},
+    {"serial m=16",                 _TestStatSerial},
+    {"approximate entropy m=10",    _TestStatApproxEntropy},
+    {"cumulative sums",             _TestStatCusum},
+    {"byte chi-square",             _TestStatByteChi},
+};
+
+#define TEST_STATS      (sizeof(testStats) / sizeof(*testStats))
+
+// a test sequence from small requests, as the stack makes them
+static void _TestSequence(TEST_SOURCE source)
+{
+    static uint32_t lcgState = 1;
+    uint16_t half[2];
+    uint32_t val;
+    int ix, jx;
+
+    for(ix = 0; ix < TEST_BITS; ix += 32)
+    {
+        switch(source)
+        {
+            case TEST_SOURCE_POOL_ID:
+                val = SYS_RANDOM_PoolGet(SYS_RANDOM_POOL_NET_ID);
+                break;
+
+            case TEST_SOURCE_POOL_SECRET:
+                SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_SECRET, half, sizeof(half[0]));
+                SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_SECRET, half + 1, sizeof(half[1]));
+                val = half[0] | (uint32_t)half[1] << 16;
+                break;
+
+            case TEST_SOURCE_FAST:
+                val = SYS_RANDOM_FastGet();
+                break;
+
+            default:
+                lcgState = lcgState * 1103515245 + 12345;
+                val = lcgState;
+                break;
+        }
+
+        for(jx = 0; jx < 32 && ix + jx < TEST_BITS; jx++)
+        {
+            testBits[ix + jx] = (val >> jx) & 1;
+        }
+    }
+}
+
+// runs the statistical tests over TEST_SEQUENCES sequences of a source
+// returns the number of the tests failed: proportion of the passing sequences or p-values uniformity
+static int _TestSource(TEST_SOURCE source)
+{
+    int passCount[TEST_STATS] = {0};
+    int bins[TEST_STATS][10];
+    int sx, tx, bx, nFails;
+    double pValue, expected, chi, uniformity, minPass;
+
+    memset(bins, 0, sizeof(bins));
+    for(sx = 0; sx < TEST_SEQUENCES; sx++)
+    {
+        _TestSequence(source);
+        for(tx = 0; tx < TEST_STATS; tx++)
+        {
+            pValue = (*testStats[tx].statF)();
+            passCount[tx] += pValue >= TEST_ALPHA;
+            bx = (int)(pValue * 10);
+            bins[tx][bx < 0 ? 0 : bx > 9 ? 9 : bx]++;
+        }
+    }
+
+    // SP 800-22 4.2.1: the proportion interval is p +- 3 sqrt(p (1 - p) / n)
+    minPass = TEST_SEQUENCES * ((1 - TEST_ALPHA) - 3 * sqrt(TEST_ALPHA * (1 - TEST_ALPHA) / TEST_SEQUENCES));
+
+    printf("%s: %d sequences x %d bits\n", testSourceNames[source], TEST_SEQUENCES, TEST_BITS);
+    nFails = 0;
+    for(tx = 0; tx < TEST_STATS; tx++)
+    {
+        // SP 800-22 4.2.2: chi-square of the p-values over 10 bins
+        expected = TEST_SEQUENCES / 10.0;
+        chi = 0;
+        for(bx = 0; bx < 10; bx++)
+        {
+            chi += (bins[tx][bx] - expected) * (bins[tx][bx] - expected) / expected;
+        }
+        uniformity = _TestIgamc(9 / 2.0, chi / 2);
+        printf("    %-26s pass %3d/%d, p-values uniformity %.4f\n", testStats[tx].name, passCount[tx], TEST_SEQUENCES, uniformity);
+        nFails += passCount[tx] < minPass || uniformity < TEST_UNIFORMITY_MIN;
+    }
+
+    return nFails;
+}
+
+static void _TestRate(const char* name, long nReqs, double elapsedNs)
+{
+    printf("    %-34s %6.1f M requests/s %7.1f ns/request\n", name, nReqs / elapsedNs * 1e3, elapsedNs / nReqs);
+}
+
+static double _TestNs(const struct timespec* pStart)
+{
+    struct timespec tEnd;
+
+    clock_gettime(CLOCK_MONOTONIC, &tEnd);
+    return (double)(tEnd.tv_sec - pStart->tv_sec) * 1e9 + tEnd.tv_nsec - pStart->tv_nsec;
+}
+
+static void _TestRates(void)
+{
+    struct timespec tStart;
+    uint8_t buff[16];
+    long ix;
+
+    printf("request rate, %d requests each:\n", TEST_RATE_REQUESTS);
+
+    clock_gettime(CLOCK_MONOTONIC, &tStart);
+    for(ix = 0; ix < TEST_RATE_REQUESTS; ix++)
+    {
+        testSink = SYS_RANDOM_CryptoGet();
+    }
+    _TestRate("SYS_RANDOM_CryptoGet (4 B)", TEST_RATE_REQUESTS, _TestNs(&tStart));
+
+    clock_gettime(CLOCK_MONOTONIC, &tStart);
+    for(ix = 0; ix < TEST_RATE_REQUESTS; ix++)
+    {
+        testSink = SYS_RANDOM_PoolGet(SYS_RANDOM_POOL_NET_ID);
+    }
+    _TestRate("SYS_RANDOM_PoolGet (4 B)", TEST_RATE_REQUESTS, _TestNs(&tStart));
+
+    clock_gettime(CLOCK_MONOTONIC, &tStart);
+    for(ix = 0; ix < TEST_RATE_REQUESTS; ix++)
+    {
+        SYS_RANDOM_CryptoBlockGet(buff, 16);
+        testSink = buff[3];
+    }
+    _TestRate("SYS_RANDOM_CryptoBlockGet (16 B)", TEST_RATE_REQUESTS, _TestNs(&tStart));
+
+    clock_gettime(CLOCK_MONOTONIC, &tStart);
+    for(ix = 0; ix < TEST_RATE_REQUESTS; ix++)
+    {
+        SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_SECRET, buff, 16);
+        testSink = buff[3];
+    }
+    _TestRate("SYS_RANDOM_PoolBlockGet (16 B)", TEST_RATE_REQUESTS, _TestNs(&tStart));
+
+    clock_gettime(CLOCK_MONOTONIC, &tStart);
+    for(ix = 0; ix < TEST_RATE_REQUESTS; ix++)
+    {
+        SYS_RANDOM_CryptoBlockGet(buff, 2);
+        testSink = buff[1];
+    }
+    _TestRate("SYS_RANDOM_CryptoBlockGet (2 B)", TEST_RATE_REQUESTS, _TestNs(&tStart));
+
+    clock_gettime(CLOCK_MONOTONIC, &tStart);
+    for(ix = 0; ix < TEST_RATE_REQUESTS; ix++)
+    {
+        SYS_RANDOM_PoolBlockGet(SYS_RANDOM_POOL_NET_ID, buff, 2);
+        testSink = buff[1];
+    }
+    _TestRate("SYS_RANDOM_PoolBlockGet (2 B)", TEST_RATE_REQUESTS, _TestNs(&tStart));
+
+    clock_gettime(CLOCK_MONOTONIC, &tStart);
+    for(ix = 0; ix < TEST_RATE_REQUESTS * 10; ix++)
+    {
+        testSink = SYS_RANDOM_FastGet();
+    }
+    _TestRate("SYS_RANDOM_FastGet", TEST_RATE_REQUESTS * 10, _TestNs(&tStart));
+}
+
+int main(void)
+{
+    TEST_SOURCE source;
+    int nFails;
+
+    _TestPoolKnown();
+    _TestFastKnown();
+
+    _TestRngModeSet(TEST_RNG_DRBG);
+    for(source = 0; source < TEST_SOURCES; source++)
+    {
+        nFails = _TestSource(source);
+        if(source == TEST_SOURCE_LCG)
+        {   // the control has to be caught
+            HOST_TEST_CHECK(nFails != 0);
+        }
+        else
+        {
+            HOST_TEST_CHECK(nFails == 0);
+        }
+    }
+
+    _TestRates();
+
+    return HOST_TEST_Result("sys_random");
+}
@@ -0,0 +1,532 @@
+/*******************************************************************************
+  TCP buffer auto tuning test
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    tcp_auto_tune.c
+
+  Summary:
+    Throughput and heap use of the TCP buffer auto tuning
+
+  Description:
+    Transfers over a 20 Mb/s link, sockets opened with the default 512 B buffers:
+    - a single download or upload at 2, 10 and 40 ms round trip time,
+      with the buffers kept at their base size by a low heap,
+      with the auto tuning and with static 8 KB buffers.
+      The tuned transfer has to get close to the 8 KB one.
+    - a download, an upload and 8 request/response sockets together at 10 ms:
+      the growth stays within TCPIP_TCP_AUTO_TUNE_MAX_SIZE per buffer and
+      TCPIP_TCP_AUTO_TUNE_TOTAL_SIZE overall and the buffers return
+      to their base size once idle.
+    All the sockets are aborted after each run: the heap is back to its initial use.
+*******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+//DOM-IGNORE-END
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_tcp.h"
+
+// the module under test, for access to its internal state
+#include "tcpip/src/tcp.c"
+
+#if (_TCP_AUTO_TUNE == 0)
+#error "the test needs TCPIP_TCP_AUTO_TUNE"
+#endif
+
+#define TEST_RATE_KBPS          20000
+#define TEST_REMOTE_ADD         0x0a000101
+#define TEST_REMOTE_WIN         65535
+#define TEST_MSS                1460
+#define TEST_BULK_BYTES         (256 * 1024)
+#define TEST_STATIC_SIZE        8192    // buffers of the static runs
+#define TEST_LOW_HEAP           4096    // heap left to the low heap runs: below TCPIP_TCP_AUTO_TUNE_HEAP_RESERVE
+#define TEST_CHATS              8       // request/response sockets of the mixed run
+#define TEST_REQUEST_LEN        100
+#define TEST_RESPONSE_LEN       300
+#define TEST_REQUEST_MS         1000    // a request each second
+#define TEST_RTO_MS             300     // remote go back when no progress
+#define TEST_PROBE_MS           200     // remote zero window probe
+#define TEST_MAX_MS             120000
+#define TEST_IDLE_MS            (TCPIP_TCP_AUTO_TUNE_IDLE_TIMEOUT + 3000)
+#define TEST_FLOWS              (2 + TEST_CHATS)
+
+typedef enum
+{
+    TEST_FLOW_DOWNLOAD,     // the stack sends
+    TEST_FLOW_UPLOAD,       // the remote sends
+    TEST_FLOW_CHAT,         // requests from the remote, answered by the stack
+}TEST_FLOW_TYPE;
+
+typedef enum
+{
+    TEST_BUFF_LOW_HEAP,     // base size: no growth under heap pressure
+    TEST_BUFF_AUTO,
+    TEST_BUFF_STATIC,
+}TEST_BUFF_MODE;
+
+typedef struct
+{
+    TEST_FLOW_TYPE  type;
+    TCP_SOCKET      hTCP;           // the stack socket
+    bool            established;    // remote side
+    uint16_t        remotePort;
+    uint16_t        localPort;
+    uint32_t        iss;
+    uint32_t        sndUna;
+    uint32_t        sndNxt;
+    uint32_t        rcvNxt;
+    uint32_t        sndWin;         // window advertised by the stack
+    uint32_t        total;          // bulk bytes
+    uint32_t        rxBytes;
+    uint32_t        startMs;
+    uint32_t        doneMs;
+    uint32_t        progressMs;
+    uint32_t        requestMs;
+    uint32_t        appTxBytes;     // the stack application
+}TEST_FLOW;
+
+typedef struct
+{
+    uint32_t    kBps[2];        // download, upload
+    size_t      fifoPeak;       // all the socket buffers
+    size_t      heapPeak;
+}TEST_RESULT;
+
+static TEST_FLOW testFlows[TEST_FLOWS];
+static int testNFlows;
+static uint16_t testPort = 40000;
+
+static void _TestRemoteSend(TEST_FLOW* pFlow, uint32_t seq, uint8_t flags, uint16_t len)
+{
+    HOST_TCP_SEG seg =
+    {
+        .remoteAdd = TEST_REMOTE_ADD,
+        .remotePort = pFlow->remotePort,
+        .localPort = pFlow->localPort,
+        .seq = seq,
+        .ack = pFlow->rcvNxt,
+        .len = len,
+        .win = TEST_REMOTE_WIN,
+        .flags = flags,
+    };
+
+    HOST_TCP_RemoteSend(&seg);
+}
+
+// the remote side: connects, acknowledges every data segment
+static void _TestRemoteRx(const HOST_TCP_SEG* pSeg)
+{
+    int ix;
+    TEST_FLOW* pFlow = 0;
+
+    for(ix = 0; ix < testNFlows; ix++)
+    {
+        if(testFlows[ix].remotePort == pSeg->remotePort)
+        {
+            pFlow = testFlows + ix;
+            break;
+        }
+    }
+
+    if(pFlow == 0 || (pSeg->flags & HOST_TCP_RST) != 0)
+    {
+        return;
+    }
+
+    if(!pFlow->established)
+    {
+        if((pSeg->flags & (HOST_TCP_SYN | HOST_TCP_ACK)) == (HOST_TCP_SYN | HOST_TCP_ACK))
+        {
+            pFlow->established = true;
+            pFlow->rcvNxt = pSeg->seq + 1;
+            pFlow->sndUna = pFlow->sndNxt = pFlow->iss + 1;
+            pFlow->sndWin = pSeg->win;
+            pFlow->startMs = pFlow->progressMs = HOST_TEST_TimeMs();
+            _TestRemoteSend(pFlow, pFlow->sndNxt, HOST_TCP_ACK, 0);
+        }
+        return;
+    }
+
+    if((pSeg->flags & HOST_TCP_ACK) != 0)
+    {
+        if((int32_t)(pSeg->ack - pFlow->sndUna) > 0)
+        {
+            pFlow->sndUna = pSeg->ack;
+            pFlow->progressMs = HOST_TEST_TimeMs();
+        }
+        pFlow->sndWin = pSeg->win;
+    }
+
+    if(pSeg->len != 0)
+    {
+        if(pSeg->seq == pFlow->rcvNxt)
+        {
+            pFlow->rcvNxt += pSeg->len;
+            pFlow->rxBytes += pSeg->len;
+            if(pFlow->type == TEST_FLOW_DOWNLOAD && pFlow->rxBytes >= pFlow->total && pFlow->doneMs == 0)
+            {
+                pFlow->doneMs = HOST_TEST_TimeMs();
+            }
+        }
+        _TestRemoteSend(pFlow, pFlow->sndNxt, HOST_TCP_ACK, 0);
+    }
+}
+
+// the remote sends what the stack window allows
+static void _TestRemoteRun(TEST_FLOW* pFlow)
+{
+    uint32_t nowMs = HOST_TEST_TimeMs();
+    uint32_t endSeq = pFlow->iss + 1 + pFlow->total;
+    uint32_t inFlight, left, len;
+
+    if(!pFlow->established)
+    {
+        return;
+    }
+
+    if(pFlow->type == TEST_FLOW_CHAT)
+    {
+        if(nowMs >= pFlow->requestMs && pFlow->sndNxt == pFlow->sndUna)
+        {
+            pFlow->requestMs = nowMs + TEST_REQUEST_MS;
+            _TestRemoteSend(pFlow, pFlow->sndNxt, HOST_TCP_ACK | HOST_TCP_PSH, TEST_REQUEST_LEN);
+            pFlow->sndNxt += TEST_REQUEST_LEN;
+        }
+        return;
+    }
+
+    if(pFlow->type != TEST_FLOW_UPLOAD)
+    {
+        return;
+    }
+
+    if(pFlow->sndUna == endSeq)
+    {
+        if(pFlow->doneMs == 0)
+        {
+            pFlow->doneMs = nowMs;
+        }
+        return;
+    }
+
+    if(pFlow->sndNxt != pFlow->sndUna && nowMs - pFlow->progressMs > TEST_RTO_MS)
+    {   // go back
+        pFlow->sndNxt = pFlow->sndUna;
+        pFlow->progressMs = nowMs;
+    }
+
+    while((left = endSeq - pFlow->sndNxt) != 0)
+    {
+        inFlight = pFlow->sndNxt - pFlow->sndUna;
+        len = TEST_MSS;
+        if(inFlight >= pFlow->sndWin)
+        {
+            if(inFlight != 0 || nowMs - pFlow->progressMs <= TEST_PROBE_MS)
+            {
+                break;
+            }
+            // zero window probe
+            len = 1;
+            pFlow->progressMs = nowMs;
+        }
+        else if(len > pFlow->sndWin - inFlight)
+        {
+            len = pFlow->sndWin - inFlight;
+        }
+        len = len > left ? left : len;
+
+        _TestRemoteSend(pFlow, pFlow->sndNxt, HOST_TCP_ACK, len);
+        pFlow->sndNxt += len;
+        if(len == 1)
+        {
+            break;
+        }
+    }
+}
+
+// the stack application
+static void _TestApp(void)
+{
+    int ix;
+    uint16_t n;
+    static uint8_t buff[TEST_STATIC_SIZE];
+
+    for(ix = 0; ix < testNFlows; ix++)
+    {
+        TEST_FLOW* pFlow = testFlows + ix;
+        if(!TCPIP_TCP_IsConnected(pFlow->hTCP))
+        {
+            continue;
+        }
+
+        switch(pFlow->type)
+        {
+            case TEST_FLOW_DOWNLOAD:
+                while(pFlow->appTxBytes < pFlow->total && (n = TCPIP_TCP_PutIsReady(pFlow->hTCP)) != 0)
+                {
+                    n = n > pFlow->total - pFlow->appTxBytes ? pFlow->total - pFlow->appTxBytes : n;
+                    n = n > sizeof(buff) ? sizeof(buff) : n;
+                    pFlow->appTxBytes += TCPIP_TCP_ArrayPut(pFlow->hTCP, buff, n);
+                }
+                break;
+
+            case TEST_FLOW_UPLOAD:
+                while((n = TCPIP_TCP_GetIsReady(pFlow->hTCP)) != 0)
+                {
+                    TCPIP_TCP_ArrayGet(pFlow->hTCP, buff, n > sizeof(buff) ? sizeof(buff) : n);
+                }
+                break;
+
+            default:
+                while(TCPIP_TCP_GetIsReady(pFlow->hTCP) >= TEST_REQUEST_LEN)
+                {
+                    TCPIP_TCP_ArrayGet(pFlow->hTCP, buff, TEST_REQUEST_LEN);
+                    HOST_TEST_CHECK(TCPIP_TCP_ArrayPut(pFlow->hTCP, buff, TEST_RESPONSE_LEN) == TEST_RESPONSE_LEN);
+                    TCPIP_TCP_Flush(pFlow->hTCP);
+                }
+                break;
+        }
+    }
+}
+
+// TX + RX buffer sizes of a socket
+static size_t _TestFifoSize(TCP_SOCKET hTCP)
+{
+    TCB_STUB* pSkt = TCBStubs[hTCP];
+
+    return (pSkt->txEnd - pSkt->txStart - 1) + (pSkt->rxEnd - pSkt->rxStart);
+}
+
+static size_t _TestFifoBytes(void)
+{
+    int ix;
+    size_t nBytes = 0;
+
+    for(ix = 0; ix < testNFlows; ix++)
+    {
+        nBytes += _TestFifoSize(testFlows[ix].hTCP);
+    }
+    return nBytes;
+}
+
+static void _TestStep(void)
+{
+    int ix;
+
+    HOST_TCP_Step(_TestApp);
+    for(ix = 0; ix < testNFlows; ix++)
+    {
+        _TestRemoteRun(testFlows + ix);
+    }
+}
+
+static void _TestFlowAdd(TEST_FLOW_TYPE type, uint32_t total, TEST_BUFF_MODE buffMode)
+{
+    TEST_FLOW* pFlow = testFlows + testNFlows;
+
+    memset(pFlow, 0, sizeof(*pFlow));
+    pFlow->type = type;
+    pFlow->total = total;
+    pFlow->remotePort = testPort++;
+    pFlow->localPort = 80 + testNFlows;
+    pFlow->iss = (uint32_t)rand();
+    pFlow->requestMs = HOST_TEST_TimeMs() + 100 + testNFlows * 97;
+    pFlow->hTCP = TCPIP_TCP_ServerOpen(IP_ADDRESS_TYPE_IPV4, pFlow->localPort, 0);
+    HOST_TEST_CHECK(pFlow->hTCP != INVALID_SOCKET);
+    if(buffMode == TEST_BUFF_STATIC)
+    {
+        HOST_TEST_CHECK(TCPIP_TCP_OptionsSet(pFlow->hTCP, TCP_OPTION_TX_BUFF, (void*)TEST_STATIC_SIZE));
+        HOST_TEST_CHECK(TCPIP_TCP_OptionsSet(pFlow->hTCP, TCP_OPTION_RX_BUFF, (void*)TEST_STATIC_SIZE));
+    }
+    testNFlows++;
+
+    _TestRemoteSend(pFlow, pFlow->iss, HOST_TCP_SYN, 0);
+}
+
+// runs the flows until the bulk ones are done
+static void _TestRun(int rttMs, TEST_BUFF_MODE buffMode, TEST_RESULT* pRes)
+{
+    int ix;
+    bool bulkDone;
+    size_t fifoBytes;
+    uint32_t endMs = HOST_TEST_TimeMs() + TEST_MAX_MS;
+    const HOST_TCP_LINK link =
+    {
+        .delayUs = rttMs * 500,
+        .rateKbps = TEST_RATE_KBPS,
+        .remoteRx = _TestRemoteRx,
+    };
+
+    HOST_TCP_LinkSet(&link);
+    memset(pRes, 0, sizeof(*pRes));
+    HOST_TEST_HeapLimitSet(buffMode == TEST_BUFF_LOW_HEAP ? HOST_TEST_HeapBytes() + TEST_LOW_HEAP : 0);
+    HOST_TEST_HeapPeak(true);
+
+    do
+    {
+        _TestStep();
+        fifoBytes = _TestFifoBytes();
+        pRes->fifoPeak = fifoBytes > pRes->fifoPeak ? fifoBytes : pRes->fifoPeak;
+        for(ix = 0; ix < testNFlows && buffMode != TEST_BUFF_STATIC; ix++)
+        {
+            TCB_STUB* pSkt = TCBStubs[testFlows[ix].hTCP];
+            HOST_TEST_CHECK(pSkt->txEnd - pSkt->txStart - 1 <= TCPIP_TCP_AUTO_TUNE_MAX_SIZE && pSkt->rxEnd - pSkt->rxStart <= TCPIP_TCP_AUTO_TUNE_MAX_SIZE);
+        }
+        HOST_TEST_CHECK(tcpTuneBytes <= TCPIP_TCP_AUTO_TUNE_TOTAL_SIZE);
+
+        bulkDone = true;
+        for(ix = 0; ix < testNFlows; ix++)
+        {
+            if(testFlows[ix].type != TEST_FLOW_CHAT && testFlows[ix].doneMs == 0)
+            {
+                bulkDone = false;
+            }
+        }
+    }while(!bulkDone && HOST_TEST_TimeMs() < endMs);
+
+    pRes->heapPeak = HOST_TEST_HeapPeak(false);
+    for(ix = 0; ix < testNFlows; ix++)
+    {
+        TEST_FLOW* pFlow = testFlows + ix;
+        if(pFlow->type != TEST_FLOW_CHAT && pFlow->doneMs != 0)
+        {
+            pRes->kBps[pFlow->type] = (uint32_t)((uint64_t)pFlow->total * 1000 / (pFlow->doneMs - pFlow->startMs) / 1024);
+        }
+    }
+}
+
+// aborts all the sockets of a run
+static void _TestFlowsClose(void)
+{
+    int ix;
+
+    for(ix = 0; ix < testNFlows; ix++)
+    {
+        TCPIP_TCP_Abort(testFlows[ix].hTCP, true);
+    }
+    testNFlows = 0;
+    for(ix = 0; ix < 100; ix++)
+    {
+        _TestStep();
+    }
+    HOST_TEST_HeapLimitSet(0);
+}
+
+// a single download or upload, each buffer mode
+static void _TestSingle(TEST_FLOW_TYPE type, int rttMs, size_t idleBytes)
+{
+    TEST_BUFF_MODE buffMode;
+    TEST_RESULT res[TEST_BUFF_STATIC + 1];
+
+    for(buffMode = TEST_BUFF_LOW_HEAP; buffMode <= TEST_BUFF_STATIC; buffMode++)
+    {
+        _TestFlowAdd(type, TEST_BULK_BYTES, buffMode);
+        _TestRun(rttMs, buffMode, res + buffMode);
+        if(buffMode == TEST_BUFF_LOW_HEAP)
+        {   // never grown
+            HOST_TEST_CHECK(res[buffMode].fifoPeak == TCPIP_TCP_SOCKET_DEFAULT_TX_SIZE + TCPIP_TCP_SOCKET_DEFAULT_RX_SIZE);
+        }
+        _TestFlowsClose();
+        HOST_TEST_CHECK(HOST_TCP_Sockets() == 0 && HOST_TEST_HeapBytes() == idleBytes);
+    }
+
+    printf("%-8s rtt %2d ms: low heap %5u KB/s, auto %5u KB/s (buffers peak %5zu B), static %5u KB/s (buffers %5zu B)\n",
+            type == TEST_FLOW_DOWNLOAD ? "download" : "upload", rttMs,
+            res[TEST_BUFF_LOW_HEAP].kBps[type], res[TEST_BUFF_AUTO].kBps[type], res[TEST_BUFF_AUTO].fifoPeak,
+            res[TEST_BUFF_STATIC].kBps[type], res[TEST_BUFF_STATIC].fifoPeak);
+
+    HOST_TEST_CHECK(res[TEST_BUFF_AUTO].kBps[type] >= 4 * res[TEST_BUFF_LOW_HEAP].kBps[type]);
+    HOST_TEST_CHECK(res[TEST_BUFF_AUTO].kBps[type] * 10 >= res[TEST_BUFF_STATIC].kBps[type] * 8);
+}
+
+// bulk and request/response sockets together
+static void _TestMixed(size_t idleBytes)
+{
+    int ix;
+    size_t baseBytes;
+    TEST_RESULT res;
+
+    _TestFlowAdd(TEST_FLOW_DOWNLOAD, TEST_BULK_BYTES, TEST_BUFF_AUTO);
+    _TestFlowAdd(TEST_FLOW_UPLOAD, TEST_BULK_BYTES, TEST_BUFF_AUTO);
+    for(ix = 0; ix < TEST_CHATS; ix++)
+    {
+        _TestFlowAdd(TEST_FLOW_CHAT, 0, TEST_BUFF_AUTO);
+    }
+    baseBytes = _TestFifoBytes();
+
+    _TestRun(10, TEST_BUFF_AUTO, &res);
+    HOST_TEST_CHECK(res.fifoPeak <= baseBytes + TCPIP_TCP_AUTO_TUNE_TOTAL_SIZE);
+
+    // the request/response sockets keep working
+    for(ix = 0; ix < TEST_IDLE_MS; ix++)
+    {
+        _TestStep();
+    }
+
+    printf("mixed    rtt 10 ms: download %u KB/s, upload %u KB/s, buffers peak %zu B (base %zu B), heap peak %zu B; after %u ms idle: buffers %zu B, heap %zu B\n",
+            res.kBps[TEST_FLOW_DOWNLOAD], res.kBps[TEST_FLOW_UPLOAD], res.fifoPeak, baseBytes, res.heapPeak,
+            TEST_IDLE_MS, _TestFifoBytes(), HOST_TEST_HeapBytes());
+    HOST_TEST_CHECK(_TestFifoBytes() == baseBytes && tcpTuneBytes == 0);
+    for(ix = 0; ix < TEST_CHATS; ix++)
+    {
+        HOST_TEST_CHECK(testFlows[2 + ix].rxBytes >= TEST_RESPONSE_LEN);
+    }
+
+    _TestFlowsClose();
+    HOST_TEST_CHECK(HOST_TCP_Sockets() == 0 && HOST_TEST_HeapBytes() == idleBytes);
+}
+
+int main(void)
+{
+    int ix;
+    size_t idleBytes;
+    const int rttMs[] = {2, 10, 40};
+    const HOST_TCP_LINK link =
+    {
+        .delayUs = 0,
+        .rateKbps = TEST_RATE_KBPS,
+        .remoteRx = _TestRemoteRx,
+    };
+
+    srand(3);
+    HOST_TEST_CHECK(HOST_TCP_Initialize(&link));
+    idleBytes = HOST_TEST_HeapBytes();
+
+    for(ix = 0; ix < sizeof(rttMs) / sizeof(*rttMs); ix++)
+    {
+        _TestSingle(TEST_FLOW_DOWNLOAD, rttMs[ix], idleBytes);
+        _TestSingle(TEST_FLOW_UPLOAD, rttMs[ix], idleBytes);
+    }
+
+    _TestMixed(idleBytes);
+
+    return HOST_TEST_Result("tcp_auto_tune");
+}
@@ -0,0 +1,453 @@
+/*******************************************************************************
+  TCP listen backlog test
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    tcp_backlog.c
+
+  Summary:
+    Connection rate of the TCP server sockets with and without a backlog
+
+  Description:
+    Bursts of short connections: the client sends a request, the server
+    answers and closes. The same bursts are served by pre-opened server
+    sockets, one per connection, and by a listening socket with a backlog,
+    the children taken with TCPIP_TCP_Accept().
+    Prints the connection rate and latency of both.
+
+    Closing the listening socket with children still in the accept queue
+    and in the handshake releases all of them.
+*******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+//DOM-IGNORE-END
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_tcp.h"
+
+// the module under test, for access to its internal state
+#include "tcpip/src/tcp.c"
+
+#if (_TCP_LISTEN_BACKLOG == 0)
+#error "the test needs TCPIP_TCP_LISTEN_BACKLOG"
+#endif
+
+#define TEST_PORT               80
+#define TEST_REQUEST_LEN        100
+#define TEST_RESPONSE_LEN       300
+#define TEST_SYN_RTO_MS         1000    // client SYN retransmission, doubles each time
+#define TEST_BURST              8       // connections started together
+#define TEST_BURSTS             8
+#define TEST_BURST_GAP_MS       500
+#define TEST_CLIENTS            (TEST_BURST * TEST_BURSTS)
+#define TEST_START_MS           100
+#define TEST_APP_PERIOD_MS      10      // the server application runs every 10 ms
+#define TEST_SERVER_SOCKETS     4       // pre-opened server sockets
+#define TEST_BACKLOG            8
+#define TEST_PENDING            5       // children when the listener is closed
+#define TEST_QUEUED             2       // of them, established
+
+typedef enum
+{
+    TEST_CLIENT_IDLE,
+    TEST_CLIENT_SYN_SENT,
+    TEST_CLIENT_ESTABLISHED,
+    TEST_CLIENT_DONE,
+}TEST_CLIENT_STATE;
+
+typedef struct
+{
+    TEST_CLIENT_STATE   state;
+    uint32_t            remoteAdd;
+    uint16_t            remotePort;
+    uint32_t            iss;
+    uint32_t            sndNxt;
+    uint32_t            rcvNxt;
+    uint32_t            rxBytes;
+    uint32_t            startMs;
+    uint32_t            synMs;      // last SYN
+    uint32_t            rtoMs;
+    uint32_t            doneMs;
+    int                 nSyns;
+}TEST_CLIENT;
+
+typedef struct
+{
+    int         nDone;
+    int         nRetried;       // needed more than one SYN
+    uint32_t    avgMs;
+    uint32_t    maxMs;
+    uint32_t    connPerSec;
+}TEST_RESULT;
+
+static TEST_CLIENT testClients[TEST_CLIENTS + TEST_PENDING];
+static int testNClients;
+
+static bool testBacklog;
+static TCP_SOCKET testServers[TEST_SERVER_SOCKETS];
+static int testNServers;
+static TCP_SOCKET testChildren[TCPIP_TCP_MAX_SOCKETS];
+static int testNChildren;
+
+static void _TestClientSend(TEST_CLIENT* pClient, uint32_t seq, uint8_t flags, uint16_t len)
+{
+    HOST_TCP_SEG seg =
+    {
+        .remoteAdd = pClient->remoteAdd,
+        .remotePort = pClient->remotePort,
+        .localPort = TEST_PORT,
+        .seq = seq,
+        .ack = pClient->rcvNxt,
+        .len = len,
+        .win = 8192,
+        .flags = flags,
+    };
+
+    HOST_TCP_RemoteSend(&seg);
+}
+
+static void _TestClientStart(TEST_CLIENT* pClient, uint32_t remoteAdd, uint16_t remotePort)
+{
+    memset(pClient, 0, sizeof(*pClient));
+    pClient->remoteAdd = remoteAdd;
+    pClient->remotePort = remotePort;
+    pClient->state = TEST_CLIENT_SYN_SENT;
+    pClient->iss = (uint32_t)rand();
+    pClient->sndNxt = pClient->iss + 1;
+    pClient->startMs = pClient->synMs = HOST_TEST_TimeMs();
+    pClient->rtoMs = TEST_SYN_RTO_MS;
+    pClient->nSyns = 1;
+    _TestClientSend(pClient, pClient->iss, HOST_TCP_SYN, 0);
+}
+
+// the client side: SYN, ACK + request, FIN after the whole response
+static void _TestRemoteRx(const HOST_TCP_SEG* pSeg)
+{
+    int ix;
+    TEST_CLIENT* pClient = 0;
+
+    for(ix = 0; ix < testNClients; ix++)
+    {
+        if(testClients[ix].remotePort == pSeg->remotePort && testClients[ix].remoteAdd == pSeg->remoteAdd)
+        {
+            pClient = testClients + ix;
+            break;
+        }
+    }
+
+    if(pClient == 0 || pClient->state == TEST_CLIENT_IDLE || pClient->state == TEST_CLIENT_DONE)
+    {
+        return;
+    }
+
+    if((pSeg->flags & HOST_TCP_RST) != 0)
+    {   // refused: the next SYN when the timer expires
+        pClient->state = TEST_CLIENT_SYN_SENT;
+        pClient->sndNxt = pClient->iss + 1;
+        return;
+    }
+
+    if(pClient->state == TEST_CLIENT_SYN_SENT)
+    {
+        if((pSeg->flags & (HOST_TCP_SYN | HOST_TCP_ACK)) == (HOST_TCP_SYN | HOST_TCP_ACK) && pSeg->ack == pClient->sndNxt)
+        {
+            pClient->rcvNxt = pSeg->seq + 1;
+            pClient->state = TEST_CLIENT_ESTABLISHED;
+            _TestClientSend(pClient, pClient->sndNxt, HOST_TCP_ACK | HOST_TCP_PSH, TEST_REQUEST_LEN);
+            pClient->sndNxt += TEST_REQUEST_LEN;
+        }
+        return;
+    }
+
+    if(pSeg->len != 0 && pSeg->seq == pClient->rcvNxt)
+    {
+        pClient->rcvNxt += pSeg->len;
+        pClient->rxBytes += pSeg->len;
+    }
+
+    if((pSeg->flags & HOST_TCP_FIN) != 0 && pSeg->seq + pSeg->len == pClient->rcvNxt)
+    {
+        pClient->rcvNxt++;
+        _TestClientSend(pClient, pClient->sndNxt, HOST_TCP_FIN | HOST_TCP_ACK, 0);
+        pClient->sndNxt++;
+        pClient->state = TEST_CLIENT_DONE;
+        pClient->doneMs = HOST_TEST_TimeMs();
+    }
+    else if(pSeg->len != 0)
+    {
+        _TestClientSend(pClient, pClient->sndNxt, HOST_TCP_ACK, 0);
+    }
+}
+
+static void _TestClientTimers(void)
+{
+    int ix;
+    uint32_t nowMs = HOST_TEST_TimeMs();
+
+    for(ix = 0; ix < testNClients; ix++)
+    {
+        TEST_CLIENT* pClient = testClients + ix;
+        if(pClient->state == TEST_CLIENT_SYN_SENT && nowMs - pClient->synMs >= pClient->rtoMs)
+        {
+            pClient->synMs = nowMs;
+            pClient->rtoMs *= 2;
+            pClient->nSyns++;
+            _TestClientSend(pClient, pClient->iss, HOST_TCP_SYN, 0);
+        }
+    }
+}
+
+// answers a whole request; true if done with the socket
+static bool _TestServe(TCP_SOCKET hTCP)
+{
+    uint8_t buff[TEST_RESPONSE_LEN];
+
+    if(TCPIP_TCP_GetIsReady(hTCP) < TEST_REQUEST_LEN)
+    {
+        return false;
+    }
+
+    TCPIP_TCP_ArrayGet(hTCP, buff, TEST_REQUEST_LEN);
+    memset(buff, 's', sizeof(buff));
+    HOST_TEST_CHECK(TCPIP_TCP_ArrayPut(hTCP, buff, sizeof(buff)) == sizeof(buff));
+    return true;
+}
+
+// the server application
+static void _TestApp(void)
+{
+    int ix;
+    TCP_SOCKET hChild;
+
+    if(HOST_TEST_TimeMs() % TEST_APP_PERIOD_MS != 0)
+    {
+        return;
+    }
+
+    if(!testBacklog)
+    {   // the server socket listens again after the disconnect
+        for(ix = 0; ix < testNServers; ix++)
+        {
+            if(_TestServe(testServers[ix]))
+            {
+                TCPIP_TCP_Disconnect(testServers[ix]);
+            }
+        }
+        return;
+    }
+
+    while((hChild = TCPIP_TCP_Accept(testServers[0])) != INVALID_SOCKET)
+    {
+        HOST_TEST_CHECK(testNChildren < sizeof(testChildren) / sizeof(*testChildren));
+        testChildren[testNChildren++] = hChild;
+    }
+
+    for(ix = 0; ix < testNChildren; ix++)
+    {
+        if(_TestServe(testChildren[ix]))
+        {
+            TCPIP_TCP_Close(testChildren[ix]);
+            testChildren[ix--] = testChildren[--testNChildren];
+        }
+    }
+}
+
+static void _TestStep(HOST_TCP_APP appF)
+{
+    HOST_TCP_Step(appF);
+    _TestClientTimers();
+}
+
+static bool _TestClientsDone(void)
+{
+    int ix;
+
+    for(ix = 0; ix < testNClients; ix++)
+    {
+        if(testClients[ix].state != TEST_CLIENT_DONE)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// the bursts of connections, served by the sockets in testServers
+static void _TestBursts(TEST_RESULT* pRes)
+{
+    int ix, nStarted = 0;
+    uint32_t sumMs = 0, lastMs = 0;
+    uint32_t startMs = HOST_TEST_TimeMs() + TEST_START_MS;
+    uint32_t endMs = startMs + TEST_BURSTS * TEST_BURST_GAP_MS + 60000;
+
+    testNClients = 0;
+    while(HOST_TEST_TimeMs() < endMs)
+    {
+        if(nStarted < TEST_CLIENTS && HOST_TEST_TimeMs() >= startMs + (nStarted / TEST_BURST) * TEST_BURST_GAP_MS)
+        {
+            for(ix = 0; ix < TEST_BURST; ix++, nStarted++)
+            {
+                _TestClientStart(testClients + testNClients++, 0x0a000100 + nStarted, 40000 + nStarted);
+            }
+        }
+
+        _TestStep(_TestApp);
+        if(nStarted == TEST_CLIENTS && _TestClientsDone())
+        {
+            break;
+        }
+    }
+
+    // the server sockets close
+    for(ix = 0; ix < 1000; ix++)
+    {
+        _TestStep(_TestApp);
+    }
+
+    memset(pRes, 0, sizeof(*pRes));
+    for(ix = 0; ix < testNClients; ix++)
+    {
+        TEST_CLIENT* pClient = testClients + ix;
+        if(pClient->state == TEST_CLIENT_DONE && pClient->rxBytes == TEST_RESPONSE_LEN)
+        {
+            uint32_t connMs = pClient->doneMs - pClient->startMs;
+            pRes->nDone++;
+            pRes->nRetried += pClient->nSyns > 1 ? 1 : 0;
+            sumMs += connMs;
+            pRes->maxMs = connMs > pRes->maxMs ? connMs : pRes->maxMs;
+            lastMs = pClient->doneMs > lastMs ? pClient->doneMs : lastMs;
+        }
+    }
+
+    if(pRes->nDone != 0)
+    {
+        pRes->avgMs = sumMs / pRes->nDone;
+        pRes->connPerSec = pRes->nDone * 1000 / (lastMs - startMs);
+    }
+}
+
+static void _TestPrint(const char* name, int nSockets, const TEST_RESULT* pRes)
+{
+    const HOST_TCP_STATS* pStats = HOST_TCP_Stats();
+
+    printf("%-8s %d socket(s): %d/%d done, %d needed a SYN retry, connect avg %u ms max %u ms, %u conn/s, %u RST, peak heap %zu B, TCP task %u us\n",
+            name, nSockets, pRes->nDone, TEST_CLIENTS, pRes->nRetried, pRes->avgMs, pRes->maxMs, pRes->connPerSec,
+            pStats->txResets, HOST_TEST_HeapPeak(false), (unsigned)(pStats->taskNs / 1000));
+}
+
+static void _TestServerSockets(TEST_RESULT* pRes)
+{
+    int ix;
+    size_t idleBytes = HOST_TEST_HeapBytes();
+
+    testBacklog = false;
+    for(testNServers = 0; testNServers < TEST_SERVER_SOCKETS; testNServers++)
+    {
+        testServers[testNServers] = TCPIP_TCP_ServerOpen(IP_ADDRESS_TYPE_IPV4, TEST_PORT, 0);
+        HOST_TEST_CHECK(testServers[testNServers] != INVALID_SOCKET);
+    }
+
+    HOST_TEST_HeapPeak(true);
+    HOST_TCP_StatsReset();
+    _TestBursts(pRes);
+    _TestPrint("servers", TEST_SERVER_SOCKETS, pRes);
+
+    for(ix = 0; ix < testNServers; ix++)
+    {
+        TCPIP_TCP_Close(testServers[ix]);
+    }
+    HOST_TEST_CHECK(HOST_TCP_Sockets() == 0 && HOST_TEST_HeapBytes() == idleBytes);
+}
+
+static void _TestListener(TEST_RESULT* pRes)
+{
+    int ix;
+    size_t idleBytes = HOST_TEST_HeapBytes();
+    int idleBlocks = HOST_TEST_HeapBlocks();
+
+    testBacklog = true;
+    testNServers = 1;
+    testNChildren = 0;
+    testServers[0] = TCPIP_TCP_ServerOpen(IP_ADDRESS_TYPE_IPV4, TEST_PORT, 0);
+    HOST_TEST_CHECK(testServers[0] != INVALID_SOCKET && TCPIP_TCP_ServerBacklogSet(testServers[0], TEST_BACKLOG));
+
+    HOST_TEST_HeapPeak(true);
+    HOST_TCP_StatsReset();
+    _TestBursts(pRes);
+    _TestPrint("backlog", 1, pRes);
+    HOST_TEST_CHECK(testNChildren == 0 && HOST_TCP_Sockets() == 1);
+
+    // children the application didn't accept: established in the queue and still in the handshake
+    for(ix = 0; ix < TEST_PENDING; ix++)
+    {
+        _TestClientStart(testClients + testNClients++, 0x0b000000 + ix, 50000 + ix);
+        if(ix == TEST_QUEUED - 1)
+        {   // SYN, SYN-ACK, ACK
+            _TestStep(0);
+            _TestStep(0);
+            _TestStep(0);
+        }
+    }
+    _TestStep(0);
+    HOST_TEST_CHECK(testClients[testNClients - TEST_PENDING].state == TEST_CLIENT_ESTABLISHED);
+    HOST_TEST_CHECK(HOST_TCP_Sockets() == 1 + TEST_PENDING);
+
+    TCPIP_TCP_Close(testServers[0]);
+    for(ix = 0; ix < 100; ix++)
+    {
+        _TestStep(0);
+    }
+    printf("listener close: %d children pending, %d sockets left, heap %zu B (idle %zu B)\n", TEST_PENDING, HOST_TCP_Sockets(), HOST_TEST_HeapBytes(), idleBytes);
+    HOST_TEST_CHECK(HOST_TCP_Sockets() == 0);
+    HOST_TEST_CHECK(HOST_TEST_HeapBytes() == idleBytes && HOST_TEST_HeapBlocks() == idleBlocks);
+}
+
+int main(void)
+{
+    TEST_RESULT serverRes, backlogRes;
+    const HOST_TCP_LINK link =
+    {
+        .delayUs = 0,
+        .rateKbps = 0,
+        .remoteRx = _TestRemoteRx,
+    };
+
+    srand(7);
+    HOST_TEST_CHECK(HOST_TCP_Initialize(&link));
+
+    _TestServerSockets(&serverRes);
+    _TestListener(&backlogRes);
+
+    // the backlog completes every connection, sooner than the pre-opened sockets
+    HOST_TEST_CHECK(backlogRes.nDone == TEST_CLIENTS && backlogRes.nRetried == 0);
+    HOST_TEST_CHECK(backlogRes.avgMs < serverRes.avgMs && backlogRes.connPerSec > serverRes.connPerSec);
+
+    return HOST_TEST_Result("tcp_backlog");
+}
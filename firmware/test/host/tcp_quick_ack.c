@@ -0,0 +1,441 @@
+/*******************************************************************************
+  TCP quick acknowledgment test
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    tcp_quick_ack.c
+
+  Summary:
+    Request/response latency and bulk upload with the adaptive delayed ACK
+
+  Description:
+    Runs over a 10 Mb/s link, against a remote that sends each request
+    as a 100 B header and a 200 B body with Nagle on: the body waits
+    for the header acknowledgment. The stack answers with 400 B.
+    - request/response at 2 and 20 ms round trip time, 0, 50 and 500 ms between requests:
+      with TCPIP_TCP_QUICK_ACK the header is acknowledged before
+      TCPIP_TCP_DELAYED_ACK_TIMEOUT; without it the request waits for the timer.
+    - a 1 MB upload to an 8 KB RX buffer at 2 and 20 ms, and at 20 ms with a data segment lost:
+      with TCPIP_TCP_QUICK_ACK the out of order segments are acknowledged at once:
+      the remote retransmits sooner and the loss costs less than TCPIP_TCP_DELAYED_ACK_TIMEOUT.
+    The test is built as tcp_quick_ack, with TCPIP_TCP_QUICK_ACK,
+    and as tcp_delayed_ack, without it, for the comparison.
+*******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+//DOM-IGNORE-END
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_tcp.h"
+
+// the module under test, for access to its internal state
+#include "tcpip/src/tcp.c"
+
+#if (_TCP_QUICK_ACK != 0)
+#define TEST_NAME               "tcp_quick_ack"
+#else
+#define TEST_NAME               "tcp_delayed_ack"
+#endif
+
+#define TEST_RATE_KBPS          10000
+#define TEST_REMOTE_ADD         0x0a000101
+#define TEST_REMOTE_WIN         65535
+#define TEST_MSS                1460
+#define TEST_REQUESTS           200
+#define TEST_HEADER_LEN         100
+#define TEST_BODY_LEN           200
+#define TEST_RESPONSE_LEN       400
+#define TEST_UPLOAD_BYTES       (1024 * 1024)
+#define TEST_UPLOAD_RX_SIZE     8192    // RX buffer of the upload socket
+#define TEST_LOST_SEGMENT       40      // data segment of the upload lost on the link
+#define TEST_RTO_MS             300     // remote go back when no progress
+#define TEST_PROBE_MS           200     // remote zero window probe
+#define TEST_MAX_MS             600000
+
+typedef enum
+{
+    TEST_FLOW_REQUEST,      // requests from the remote, answered by the stack
+    TEST_FLOW_UPLOAD,       // the remote sends
+}TEST_FLOW_TYPE;
+
+typedef struct
+{
+    TEST_FLOW_TYPE  type;
+    TCP_SOCKET      hTCP;           // the stack socket
+    bool            established;    // remote side
+    uint16_t        remotePort;
+    uint16_t        localPort;
+    uint32_t        iss;
+    uint32_t        sndUna;
+    uint32_t        sndNxt;
+    uint32_t        rcvNxt;
+    uint32_t        sndWin;         // window advertised by the stack
+    uint32_t        dupAcks;
+    uint32_t        fastRetx;       // fast retransmits done
+    uint32_t        lostSegment;    // countdown to the lost data segment; 0: no loss
+    uint32_t        total;          // upload bytes
+    uint32_t        startMs;
+    uint32_t        doneMs;
+    uint32_t        progressMs;
+    // request/response
+    uint32_t        thinkMs;
+    uint32_t        requestMs;      // start of the next request
+    uint32_t        requestStartMs; // start of the current request; 0 if none
+    uint16_t        bodyLeft;       // body bytes waiting for the header acknowledgment
+    uint16_t        responseBytes;
+    uint32_t        nRequests;      // requests answered
+    uint32_t        latencySum;
+    uint32_t        latencyMax;
+}TEST_FLOW;
+
+static TEST_FLOW testFlow;
+static uint16_t testPort = 40000;
+
+static void _TestRemoteSend(TEST_FLOW* pFlow, uint32_t seq, uint8_t flags, uint16_t len)
+{
+    HOST_TCP_SEG seg =
+    {
+        .remoteAdd = TEST_REMOTE_ADD,
+        .remotePort = pFlow->remotePort,
+        .localPort = pFlow->localPort,
+        .seq = seq,
+        .ack = pFlow->rcvNxt,
+        .len = len,
+        .win = TEST_REMOTE_WIN,
+        .flags = flags,
+    };
+
+    if(len != 0 && pFlow->lostSegment != 0 && --pFlow->lostSegment == 0)
+    {   // lost on the link
+        return;
+    }
+    HOST_TCP_RemoteSend(&seg);
+}
+
+// the remote side: connects, acknowledges every data segment
+// and retransmits on the third duplicate acknowledgment
+static void _TestRemoteRx(const HOST_TCP_SEG* pSeg)
+{
+    TEST_FLOW* pFlow = &testFlow;
+    uint32_t nowMs = HOST_TEST_TimeMs();
+    uint32_t latency, len;
+
+    if(pFlow->remotePort != pSeg->remotePort || (pSeg->flags & HOST_TCP_RST) != 0)
+    {
+        return;
+    }
+
+    if(!pFlow->established)
+    {
+        if((pSeg->flags & (HOST_TCP_SYN | HOST_TCP_ACK)) == (HOST_TCP_SYN | HOST_TCP_ACK))
+        {
+            pFlow->established = true;
+            pFlow->rcvNxt = pSeg->seq + 1;
+            pFlow->sndUna = pFlow->sndNxt = pFlow->iss + 1;
+            pFlow->sndWin = pSeg->win;
+            pFlow->startMs = pFlow->progressMs = nowMs;
+            pFlow->requestMs = nowMs + 1;
+            _TestRemoteSend(pFlow, pFlow->sndNxt, HOST_TCP_ACK, 0);
+        }
+        return;
+    }
+
+    if((pSeg->flags & HOST_TCP_ACK) != 0)
+    {
+        if((int32_t)(pSeg->ack - pFlow->sndUna) > 0)
+        {
+            pFlow->sndUna = pSeg->ack;
+            pFlow->progressMs = nowMs;
+            pFlow->dupAcks = 0;
+        }
+        else if(pSeg->ack == pFlow->sndUna && pSeg->len == 0 && pFlow->sndNxt != pFlow->sndUna && ++pFlow->dupAcks == 3)
+        {   // fast retransmit
+            len = pFlow->sndNxt - pFlow->sndUna;
+            _TestRemoteSend(pFlow, pFlow->sndUna, HOST_TCP_ACK, len > TEST_MSS ? TEST_MSS : len);
+            pFlow->progressMs = nowMs;
+            pFlow->fastRetx++;
+        }
+        pFlow->sndWin = pSeg->win;
+    }
+
+    if(pSeg->len != 0)
+    {
+        if(pSeg->seq == pFlow->rcvNxt)
+        {
+            pFlow->rcvNxt += pSeg->len;
+            if(pFlow->type == TEST_FLOW_REQUEST && (pFlow->responseBytes += pSeg->len) >= TEST_RESPONSE_LEN)
+            {
+                latency = nowMs - pFlow->requestStartMs;
+                pFlow->latencySum += latency;
+                pFlow->latencyMax = latency > pFlow->latencyMax ? latency : pFlow->latencyMax;
+                pFlow->nRequests++;
+                pFlow->responseBytes -= TEST_RESPONSE_LEN;
+                pFlow->requestStartMs = 0;
+                pFlow->requestMs = nowMs + pFlow->thinkMs;
+            }
+        }
+        _TestRemoteSend(pFlow, pFlow->sndNxt, HOST_TCP_ACK, 0);
+    }
+}
+
+// a request: write(header), write(body), with Nagle on
+static void _TestRemoteRequest(TEST_FLOW* pFlow, uint32_t nowMs)
+{
+    if(pFlow->requestStartMs == 0)
+    {
+        if(pFlow->nRequests == TEST_REQUESTS)
+        {
+            pFlow->doneMs = pFlow->doneMs == 0 ? nowMs : pFlow->doneMs;
+        }
+        else if(nowMs >= pFlow->requestMs)
+        {
+            pFlow->requestStartMs = nowMs;
+            _TestRemoteSend(pFlow, pFlow->sndNxt, HOST_TCP_ACK | HOST_TCP_PSH, TEST_HEADER_LEN);
+            pFlow->sndNxt += TEST_HEADER_LEN;
+            pFlow->bodyLeft = TEST_BODY_LEN;
+        }
+    }
+    else if(pFlow->bodyLeft != 0 && pFlow->sndNxt == pFlow->sndUna)
+    {   // Nagle: the small body goes once all the sent data is acknowledged
+        _TestRemoteSend(pFlow, pFlow->sndNxt, HOST_TCP_ACK | HOST_TCP_PSH, pFlow->bodyLeft);
+        pFlow->sndNxt += pFlow->bodyLeft;
+        pFlow->bodyLeft = 0;
+    }
+}
+
+// the remote sends what the stack window allows
+static void _TestRemoteRun(TEST_FLOW* pFlow)
+{
+    uint32_t nowMs = HOST_TEST_TimeMs();
+    uint32_t endSeq = pFlow->iss + 1 + pFlow->total;
+    uint32_t inFlight, left, len;
+
+    if(!pFlow->established)
+    {
+        return;
+    }
+
+    if(pFlow->type == TEST_FLOW_REQUEST)
+    {
+        _TestRemoteRequest(pFlow, nowMs);
+        return;
+    }
+
+    if(pFlow->sndUna == endSeq)
+    {
+        pFlow->doneMs = pFlow->doneMs == 0 ? nowMs : pFlow->doneMs;
+        return;
+    }
+
+    if(pFlow->sndNxt != pFlow->sndUna && nowMs - pFlow->progressMs > TEST_RTO_MS)
+    {   // go back
+        pFlow->sndNxt = pFlow->sndUna;
+        pFlow->progressMs = nowMs;
+    }
+
+    while((left = endSeq - pFlow->sndNxt) != 0)
+    {
+        inFlight = pFlow->sndNxt - pFlow->sndUna;
+        len = TEST_MSS;
+        if(inFlight >= pFlow->sndWin)
+        {
+            if(inFlight != 0 || nowMs - pFlow->progressMs <= TEST_PROBE_MS)
+            {
+                break;
+            }
+            // zero window probe
+            len = 1;
+            pFlow->progressMs = nowMs;
+        }
+        else if(len > pFlow->sndWin - inFlight)
+        {
+            len = pFlow->sndWin - inFlight;
+        }
+        len = len > left ? left : len;
+
+        _TestRemoteSend(pFlow, pFlow->sndNxt, HOST_TCP_ACK, len);
+        pFlow->sndNxt += len;
+        if(len == 1)
+        {
+            break;
+        }
+    }
+}
+
+// the stack application
+static void _TestApp(void)
+{
+    TEST_FLOW* pFlow = &testFlow;
+    uint16_t n;
+    static uint8_t buff[TEST_MSS];
+
+    if(!TCPIP_TCP_IsConnected(pFlow->hTCP))
+    {
+        return;
+    }
+
+    if(pFlow->type == TEST_FLOW_UPLOAD)
+    {
+        while((n = TCPIP_TCP_GetIsReady(pFlow->hTCP)) != 0)
+        {
+            TCPIP_TCP_ArrayGet(pFlow->hTCP, buff, n > sizeof(buff) ? sizeof(buff) : n);
+        }
+        return;
+    }
+
+    while(TCPIP_TCP_GetIsReady(pFlow->hTCP) >= TEST_HEADER_LEN + TEST_BODY_LEN)
+    {
+        TCPIP_TCP_ArrayGet(pFlow->hTCP, buff, TEST_HEADER_LEN + TEST_BODY_LEN);
+        HOST_TEST_CHECK(TCPIP_TCP_ArrayPut(pFlow->hTCP, buff, TEST_RESPONSE_LEN) == TEST_RESPONSE_LEN);
+        TCPIP_TCP_Flush(pFlow->hTCP);
+    }
+}
+
+// runs a flow until it is done; the socket is aborted after
+static void _TestRun(TEST_FLOW_TYPE type, int rttMs, uint32_t thinkMs, bool loss, size_t idleBytes)
+{
+    TEST_FLOW* pFlow = &testFlow;
+    uint32_t endMs = HOST_TEST_TimeMs() + TEST_MAX_MS;
+    int ix;
+    const HOST_TCP_LINK link =
+    {
+        .delayUs = rttMs * 500,
+        .rateKbps = TEST_RATE_KBPS,
+        .remoteRx = _TestRemoteRx,
+    };
+
+    HOST_TCP_LinkSet(&link);
+    memset(pFlow, 0, sizeof(*pFlow));
+    pFlow->type = type;
+    pFlow->total = type == TEST_FLOW_UPLOAD ? TEST_UPLOAD_BYTES : 0;
+    pFlow->thinkMs = thinkMs;
+    pFlow->lostSegment = loss ? TEST_LOST_SEGMENT : 0;
+    pFlow->remotePort = testPort++;
+    pFlow->localPort = 80;
+    pFlow->iss = (uint32_t)rand();
+    pFlow->hTCP = TCPIP_TCP_ServerOpen(IP_ADDRESS_TYPE_IPV4, pFlow->localPort, 0);
+    HOST_TEST_CHECK(pFlow->hTCP != INVALID_SOCKET);
+    if(type == TEST_FLOW_UPLOAD)
+    {
+        HOST_TEST_CHECK(TCPIP_TCP_OptionsSet(pFlow->hTCP, TCP_OPTION_RX_BUFF, (void*)TEST_UPLOAD_RX_SIZE));
+    }
+
+    _TestRemoteSend(pFlow, pFlow->iss, HOST_TCP_SYN, 0);
+    HOST_TCP_StatsReset();
+    do
+    {
+        HOST_TCP_Step(_TestApp);
+        _TestRemoteRun(pFlow);
+    }while(pFlow->doneMs == 0 && HOST_TEST_TimeMs() < endMs);
+
+    HOST_TEST_CHECK(pFlow->doneMs != 0 && HOST_TCP_Stats()->txResets == 0);
+
+    TCPIP_TCP_Abort(pFlow->hTCP, true);
+    for(ix = 0; ix < 100; ix++)
+    {
+        HOST_TCP_Step(0);
+    }
+    HOST_TEST_CHECK(HOST_TCP_Sockets() == 0 && HOST_TEST_HeapBytes() == idleBytes);
+}
+
+static void _TestRequests(int rttMs, uint32_t thinkMs, size_t idleBytes)
+{
+    TEST_FLOW* pFlow = &testFlow;
+    uint32_t latencyAvg;
+
+    _TestRun(TEST_FLOW_REQUEST, rttMs, thinkMs, false, idleBytes);
+
+    latencyAvg = pFlow->nRequests != 0 ? pFlow->latencySum / pFlow->nRequests : 0;
+    printf("request rtt %2d ms think %3u ms: %u requests, latency avg %3u ms max %3u ms, stack segments %u (pure ACKs %u)\n",
+            rttMs, thinkMs, pFlow->nRequests, latencyAvg, pFlow->latencyMax, HOST_TCP_Stats()->txSegs, HOST_TCP_Stats()->txPureAcks);
+
+    HOST_TEST_CHECK(pFlow->nRequests == TEST_REQUESTS);
+#if (_TCP_QUICK_ACK != 0)
+    // the header acknowledgment does not wait for the timer
+    HOST_TEST_CHECK(pFlow->latencyMax < rttMs * 3 + TCPIP_TCP_DELAYED_ACK_TIMEOUT / 2);
+#else
+    // the header acknowledgment waits for the timer
+    HOST_TEST_CHECK(latencyAvg >= TCPIP_TCP_DELAYED_ACK_TIMEOUT);
+#endif  // (_TCP_QUICK_ACK != 0)
+}
+
+// returns the upload time, ms
+static uint32_t _TestUpload(int rttMs, bool loss, size_t idleBytes)
+{
+    TEST_FLOW* pFlow = &testFlow;
+    uint32_t elapsedMs;
+
+    _TestRun(TEST_FLOW_UPLOAD, rttMs, 0, loss, idleBytes);
+
+    elapsedMs = pFlow->doneMs - pFlow->startMs;
+    printf("upload%-5s rtt %2d ms: %u B in %u ms = %u KB/s, fast retransmits %u, stack segments %u (pure ACKs %u)\n",
+            loss ? "+loss" : "", rttMs, pFlow->total, elapsedMs, (uint32_t)((uint64_t)pFlow->total * 1000 / elapsedMs / 1024),
+            pFlow->fastRetx, HOST_TCP_Stats()->txSegs, HOST_TCP_Stats()->txPureAcks);
+
+    HOST_TEST_CHECK(!loss || pFlow->fastRetx != 0);
+    return elapsedMs;
+}
+
+int main(void)
+{
+    int ix, jx;
+    size_t idleBytes;
+    uint32_t uploadMs, lossUploadMs;
+    const int rttMs[] = {2, 20};
+    const uint32_t thinkMs[] = {0, 50, 500};
+    const HOST_TCP_LINK link =
+    {
+        .delayUs = 0,
+        .rateKbps = TEST_RATE_KBPS,
+        .remoteRx = _TestRemoteRx,
+    };
+
+    srand(3);
+    HOST_TEST_CHECK(HOST_TCP_Initialize(&link));
+    idleBytes = HOST_TEST_HeapBytes();
+
+    for(ix = 0; ix < sizeof(thinkMs) / sizeof(*thinkMs); ix++)
+    {
+        for(jx = 0; jx < sizeof(rttMs) / sizeof(*rttMs); jx++)
+        {
+            _TestRequests(rttMs[jx], thinkMs[ix], idleBytes);
+        }
+    }
+
+    _TestUpload(2, false, idleBytes);
+    uploadMs = _TestUpload(20, false, idleBytes);
+    lossUploadMs = _TestUpload(20, true, idleBytes);
+#if (_TCP_QUICK_ACK != 0)
+    // the duplicate acknowledgments are not delayed
+    HOST_TEST_CHECK(lossUploadMs - uploadMs < TCPIP_TCP_DELAYED_ACK_TIMEOUT);
+#endif  // (_TCP_QUICK_ACK != 0)
+
+    return HOST_TEST_Result(TEST_NAME);
+}
@@ -0,0 +1,453 @@
+/*******************************************************************************
+  TCP SYN flood test
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    tcp_syn_flood.c
+
+  Summary:
+    Listening socket under a SYN flood, with SYN cookies and the SYN rate limit
+
+  Description:
+    Bursts of clients connect to a listener with a backlog,
+    once on a quiet link and once with a flood of SYNs from spoofed sources:
+    the embryonic limit is reached, the listener answers with SYN cookies
+    and every client has to complete its request without a SYN retry.
+    The TCP task CPU time is reported per received SYN.
+
+    A single source scanning the ports gets no more than
+    TCPIP_TCP_SYN_RATE_LIMIT answers per second.
+
+    The SYN sources are told apart by a keyed hash:
+    IPv6 addresses that fold to the same 32 bit value hash differently
+    and the hash changes with the key.
+*******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+//DOM-IGNORE-END
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_tcp.h"
+
+// the module under test, for access to its internal state
+#include "tcpip/src/tcp.c"
+
+#if (_TCP_LISTEN_BACKLOG == 0) || (_TCP_SYN_COOKIES == 0) || (_TCP_SYN_RATE_LIMIT == 0)
+#error "the test needs TCPIP_TCP_LISTEN_BACKLOG, TCPIP_TCP_SYN_COOKIES and TCPIP_TCP_SYN_RATE_LIMIT"
+#endif
+
+#define TEST_PORT               80
+#define TEST_REQUEST_LEN        100
+#define TEST_RESPONSE_LEN       300
+#define TEST_SYN_RTO_MS         1000    // client SYN retransmission, doubles each time
+#define TEST_BURST              4       // connections started together
+#define TEST_BURSTS             8
+#define TEST_BURST_GAP_MS       250
+#define TEST_CLIENTS            (TEST_BURST * TEST_BURSTS)
+#define TEST_START_MS           100
+#define TEST_APP_PERIOD_MS      10      // the server application runs every 10 ms
+#define TEST_BACKLOG            8
+#define TEST_FLOOD_RATE         10000   // spoofed SYNs per second
+#define TEST_SCAN_RATE          500     // SYNs per second from the scanning source
+#define TEST_SCAN_MS            3000
+#define TEST_SCAN_ADD           0x0d000001
+
+typedef enum
+{
+    TEST_CLIENT_IDLE,
+    TEST_CLIENT_SYN_SENT,
+    TEST_CLIENT_ESTABLISHED,
+    TEST_CLIENT_DONE,
+}TEST_CLIENT_STATE;
+
+typedef struct
+{
+    TEST_CLIENT_STATE   state;
+    uint32_t            remoteAdd;
+    uint16_t            remotePort;
+    uint32_t            iss;
+    uint32_t            sndNxt;
+    uint32_t            rcvNxt;
+    uint32_t            rxBytes;
+    uint32_t            startMs;
+    uint32_t            synMs;      // last SYN
+    uint32_t            rtoMs;
+    uint32_t            doneMs;
+    int                 nSyns;
+}TEST_CLIENT;
+
+typedef struct
+{
+    int         nDone;
+    int         nRetried;       // needed more than one SYN
+    uint32_t    avgMs;
+    uint32_t    maxMs;
+    uint32_t    nSyns;          // SYNs sent to the listener: clients and flood
+    uint32_t    synNs;          // TCP task time per SYN
+}TEST_RESULT;
+
+static TEST_CLIENT testClients[TEST_CLIENTS];
+static int testNClients;
+
+static TCP_SOCKET testListener;
+static TCP_SOCKET testChildren[TCPIP_TCP_MAX_SOCKETS];
+static int testNChildren;
+
+static uint32_t testScanSynAcks;    // SYN + ACKs the scanning source got
+
+static void _TestClientSend(TEST_CLIENT* pClient, uint32_t seq, uint8_t flags, uint16_t len)
+{
+    HOST_TCP_SEG seg =
+    {
+        .remoteAdd = pClient->remoteAdd,
+        .remotePort = pClient->remotePort,
+        .localPort = TEST_PORT,
+        .seq = seq,
+        .ack = pClient->rcvNxt,
+        .len = len,
+        .win = 8192,
+        .flags = flags,
+    };
+
+    HOST_TCP_RemoteSend(&seg);
+}
+
+// a SYN that nobody will follow up
+static void _TestSynSend(uint32_t remoteAdd, uint16_t remotePort)
+{
+    HOST_TCP_SEG seg =
+    {
+        .remoteAdd = remoteAdd,
+        .remotePort = remotePort,
+        .localPort = TEST_PORT,
+        .seq = (uint32_t)rand(),
+        .win = 8192,
+        .flags = HOST_TCP_SYN,
+    };
+
+    HOST_TCP_RemoteSend(&seg);
+}
+
+static void _TestClientStart(TEST_CLIENT* pClient, uint32_t remoteAdd, uint16_t remotePort)
+{
+    memset(pClient, 0, sizeof(*pClient));
+    pClient->remoteAdd = remoteAdd;
+    pClient->remotePort = remotePort;
+    pClient->state = TEST_CLIENT_SYN_SENT;
+    pClient->iss = (uint32_t)rand();
+    pClient->sndNxt = pClient->iss + 1;
+    pClient->startMs = pClient->synMs = HOST_TEST_TimeMs();
+    pClient->rtoMs = TEST_SYN_RTO_MS;
+    pClient->nSyns = 1;
+    _TestClientSend(pClient, pClient->iss, HOST_TCP_SYN, 0);
+}
+
+// the client side: SYN, ACK + request, FIN after the whole response
+// the spoofed sources never answer
+static void _TestRemoteRx(const HOST_TCP_SEG* pSeg)
+{
+    int ix;
+    TEST_CLIENT* pClient = 0;
+
+    if(pSeg->remoteAdd == TEST_SCAN_ADD)
+    {
+        if((pSeg->flags & (HOST_TCP_SYN | HOST_TCP_ACK)) == (HOST_TCP_SYN | HOST_TCP_ACK))
+        {
+            testScanSynAcks++;
+        }
+        return;
+    }
+
+    for(ix = 0; ix < testNClients; ix++)
+    {
+        if(testClients[ix].remotePort == pSeg->remotePort && testClients[ix].remoteAdd == pSeg->remoteAdd)
+        {
+            pClient = testClients + ix;
+            break;
+        }
+    }
+
+    if(pClient == 0 || pClient->state == TEST_CLIENT_IDLE || pClient->state == TEST_CLIENT_DONE)
+    {
+        return;
+    }
+
+    if((pSeg->flags & HOST_TCP_RST) != 0)
+    {   // refused: the next SYN when the timer expires
+        pClient->state = TEST_CLIENT_SYN_SENT;
+        pClient->sndNxt = pClient->iss + 1;
+        return;
+    }
+
+    if(pClient->state == TEST_CLIENT_SYN_SENT)
+    {
+        if((pSeg->flags & (HOST_TCP_SYN | HOST_TCP_ACK)) == (HOST_TCP_SYN | HOST_TCP_ACK) && pSeg->ack == pClient->sndNxt)
+        {
+            pClient->rcvNxt = pSeg->seq + 1;
+            pClient->state = TEST_CLIENT_ESTABLISHED;
+            _TestClientSend(pClient, pClient->sndNxt, HOST_TCP_ACK | HOST_TCP_PSH, TEST_REQUEST_LEN);
+            pClient->sndNxt += TEST_REQUEST_LEN;
+        }
+        return;
+    }
+
+    if(pSeg->len != 0 && pSeg->seq == pClient->rcvNxt)
+    {
+        pClient->rcvNxt += pSeg->len;
+        pClient->rxBytes += pSeg->len;
+    }
+
+    if((pSeg->flags & HOST_TCP_FIN) != 0 && pSeg->seq + pSeg->len == pClient->rcvNxt)
+    {
+        pClient->rcvNxt++;
+        _TestClientSend(pClient, pClient->sndNxt, HOST_TCP_FIN | HOST_TCP_ACK, 0);
+        pClient->sndNxt++;
+        pClient->state = TEST_CLIENT_DONE;
+        pClient->doneMs = HOST_TEST_TimeMs();
+    }
+    else if(pSeg->len != 0)
+    {
+        _TestClientSend(pClient, pClient->sndNxt, HOST_TCP_ACK, 0);
+    }
+}
+
+static void _TestClientTimers(void)
+{
+    int ix;
+    uint32_t nowMs = HOST_TEST_TimeMs();
+
+    for(ix = 0; ix < testNClients; ix++)
+    {
+        TEST_CLIENT* pClient = testClients + ix;
+        if(pClient->state == TEST_CLIENT_SYN_SENT && nowMs - pClient->synMs >= pClient->rtoMs)
+        {
+            pClient->synMs = nowMs;
+            pClient->rtoMs *= 2;
+            pClient->nSyns++;
+            _TestClientSend(pClient, pClient->iss, HOST_TCP_SYN, 0);
+        }
+    }
+}
+
+// the server application: accepts the children, answers a whole request and closes
+static void _TestApp(void)
+{
+    int ix;
+    TCP_SOCKET hChild;
+    uint8_t buff[TEST_RESPONSE_LEN];
+
+    if(HOST_TEST_TimeMs() % TEST_APP_PERIOD_MS != 0)
+    {
+        return;
+    }
+
+    while((hChild = TCPIP_TCP_Accept(testListener)) != INVALID_SOCKET)
+    {
+        HOST_TEST_CHECK(testNChildren < sizeof(testChildren) / sizeof(*testChildren));
+        testChildren[testNChildren++] = hChild;
+    }
+
+    for(ix = 0; ix < testNChildren; ix++)
+    {
+        if(TCPIP_TCP_GetIsReady(testChildren[ix]) >= TEST_REQUEST_LEN)
+        {
+            TCPIP_TCP_ArrayGet(testChildren[ix], buff, TEST_REQUEST_LEN);
+            memset(buff, 's', sizeof(buff));
+            HOST_TEST_CHECK(TCPIP_TCP_ArrayPut(testChildren[ix], buff, sizeof(buff)) == sizeof(buff));
+            TCPIP_TCP_Close(testChildren[ix]);
+            testChildren[ix--] = testChildren[--testNChildren];
+        }
+    }
+}
+
+static void _TestStep(void)
+{
+    HOST_TCP_Step(_TestApp);
+    _TestClientTimers();
+}
+
+static bool _TestClientsDone(void)
+{
+    int ix;
+
+    for(ix = 0; ix < testNClients; ix++)
+    {
+        if(testClients[ix].state != TEST_CLIENT_DONE)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// the bursts of clients, while the spoofed sources send floodRate SYNs per second
+static void _TestBursts(uint32_t floodRate, TEST_RESULT* pRes)
+{
+    int ix, nStarted = 0;
+    uint32_t floodAcc = 0, nFlood = 0, sumMs = 0;
+    uint32_t startMs = HOST_TEST_TimeMs() + TEST_START_MS;
+    uint32_t floodEndMs = startMs + TEST_BURSTS * TEST_BURST_GAP_MS;
+    uint32_t endMs = floodEndMs + 60000;
+
+    testNClients = 0;
+    HOST_TCP_StatsReset();
+    while(HOST_TEST_TimeMs() < endMs)
+    {
+        if(nStarted < TEST_CLIENTS && HOST_TEST_TimeMs() >= startMs + (nStarted / TEST_BURST) * TEST_BURST_GAP_MS)
+        {
+            for(ix = 0; ix < TEST_BURST; ix++, nStarted++)
+            {
+                _TestClientStart(testClients + testNClients++, 0x0a000100 + nStarted, 40000 + nStarted);
+            }
+        }
+
+        if(HOST_TEST_TimeMs() < floodEndMs)
+        {
+            for(floodAcc += floodRate; floodAcc >= 1000; floodAcc -= 1000, nFlood++)
+            {
+                _TestSynSend(0x0c000000 | (rand() & 0xffffff), 1024 + rand() % 30000);
+            }
+        }
+
+        _TestStep();
+        if(nStarted == TEST_CLIENTS && _TestClientsDone())
+        {
+            break;
+        }
+    }
+
+    memset(pRes, 0, sizeof(*pRes));
+    for(ix = 0; ix < testNClients; ix++)
+    {
+        TEST_CLIENT* pClient = testClients + ix;
+        pRes->nSyns += pClient->nSyns;
+        if(pClient->state == TEST_CLIENT_DONE && pClient->rxBytes == TEST_RESPONSE_LEN)
+        {
+            uint32_t connMs = pClient->doneMs - pClient->startMs;
+            pRes->nDone++;
+            pRes->nRetried += pClient->nSyns > 1 ? 1 : 0;
+            sumMs += connMs;
+            pRes->maxMs = connMs > pRes->maxMs ? connMs : pRes->maxMs;
+        }
+    }
+
+    pRes->nSyns += nFlood;
+    pRes->synNs = HOST_TCP_Stats()->taskNs / pRes->nSyns;
+    if(pRes->nDone != 0)
+    {
+        pRes->avgMs = sumMs / pRes->nDone;
+    }
+
+    printf("flood %5u SYN/s: %d/%d done, %d needed a SYN retry, connect avg %u ms max %u ms, %u SYNs, %u ns per SYN, %u RST\n",
+            floodRate, pRes->nDone, TEST_CLIENTS, pRes->nRetried, pRes->avgMs, pRes->maxMs, pRes->nSyns, pRes->synNs, HOST_TCP_Stats()->txResets);
+
+    // the embryonic children of the flood time out
+    for(ix = 0; ix < 120000 && HOST_TCP_Sockets() > 1; ix++)
+    {
+        _TestStep();
+    }
+    HOST_TEST_CHECK(testNChildren == 0 && HOST_TCP_Sockets() == 1);
+}
+
+// a single source sends SYNs to all the ports
+static void _TestScan(void)
+{
+    int ix;
+    uint32_t scanAcc = 0, nScan = 0;
+    uint32_t maxSynAcks = (TEST_SCAN_MS / 1000 + 1) * TCPIP_TCP_SYN_RATE_LIMIT;
+
+    testScanSynAcks = 0;
+    for(ix = 0; ix < TEST_SCAN_MS; ix++)
+    {
+        for(scanAcc += TEST_SCAN_RATE; scanAcc >= 1000; scanAcc -= 1000, nScan++)
+        {
+            _TestSynSend(TEST_SCAN_ADD, 1024 + nScan);
+        }
+        _TestStep();
+    }
+
+    printf("scan %u SYN/s for %u ms: %u SYNs, %u answered (max %u)\n", TEST_SCAN_RATE, TEST_SCAN_MS, nScan, testScanSynAcks, maxSynAcks);
+    HOST_TEST_CHECK(testScanSynAcks >= TCPIP_TCP_SYN_RATE_LIMIT && testScanSynAcks <= maxSynAcks);
+}
+
+// the source hash of addresses that fold to the same XOR value
+static void _TestSourceHash(void)
+{
+    uint32_t hash1, hash2;
+    uint32_t savedKey[sizeof(tcpSynSourceKey) / sizeof(*tcpSynSourceKey)];
+    const uint32_t add1[4] = {0x20010db8, 0x00000001, 0x00000000, 0x00000002};
+    const uint32_t add2[4] = {0x20010db8, 0x00000002, 0x00000000, 0x00000001};
+
+    HOST_TEST_CHECK((add1[0] ^ add1[1] ^ add1[2] ^ add1[3]) == (add2[0] ^ add2[1] ^ add2[2] ^ add2[3]));
+
+    hash1 = _TcpSynSourceHash(add1, sizeof(add1));
+    hash2 = _TcpSynSourceHash(add2, sizeof(add2));
+    HOST_TEST_CHECK(hash1 != hash2);
+    HOST_TEST_CHECK(hash1 == _TcpSynSourceHash(add1, sizeof(add1)));
+
+    memcpy(savedKey, tcpSynSourceKey, sizeof(savedKey));
+    tcpSynSourceKey[0] ^= 1;
+    HOST_TEST_CHECK(_TcpSynSourceHash(add1, sizeof(add1)) != hash1);
+    memcpy(tcpSynSourceKey, savedKey, sizeof(savedKey));
+}
+
+int main(void)
+{
+    TEST_RESULT quietRes, floodRes;
+    size_t idleBytes;
+    const HOST_TCP_LINK link =
+    {
+        .delayUs = 0,
+        .rateKbps = 0,
+        .remoteRx = _TestRemoteRx,
+    };
+
+    srand(11);
+    HOST_TEST_CHECK(HOST_TCP_Initialize(&link));
+    _TestSourceHash();
+
+    idleBytes = HOST_TEST_HeapBytes();
+    testListener = TCPIP_TCP_ServerOpen(IP_ADDRESS_TYPE_IPV4, TEST_PORT, 0);
+    HOST_TEST_CHECK(testListener != INVALID_SOCKET && TCPIP_TCP_ServerBacklogSet(testListener, TEST_BACKLOG));
+
+    _TestBursts(0, &quietRes);
+    _TestBursts(TEST_FLOOD_RATE, &floodRes);
+    _TestScan();
+
+    // every client connects at the first SYN, flood or not
+    HOST_TEST_CHECK(quietRes.nDone == TEST_CLIENTS && quietRes.nRetried == 0);
+    HOST_TEST_CHECK(floodRes.nDone == TEST_CLIENTS && floodRes.nRetried == 0);
+
+    TCPIP_TCP_Close(testListener);
+    _TestStep();
+    HOST_TEST_CHECK(HOST_TCP_Sockets() == 0 && HOST_TEST_HeapBytes() == idleBytes);
+
+    return HOST_TEST_Result("tcp_syn_flood");
+}
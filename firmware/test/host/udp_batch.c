@@ -0,0 +1,565 @@
+/*******************************************************************************
+  UDP batch send test
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    udp_batch.c
+
+  Summary:
+    TCPIP_UDP_DatagramsSend() over the IPv4 module and a model of the MAC
+
+  Description:
+    The UDP and the IPv4 modules run over a stub ARP cache and a MAC that
+    copies every frame of the packets it gets, as the PIC32MZW1 Wi-Fi driver does.
+    Covers:
+        - the unresolved ARP and the internal destination fallback, one packet at a time
+        - the user packets returned by a failed send and sent again
+        - the rejected datagrams: too big for their packet, packet of another socket
+        - the socket TX queue limit of TCPIP_UDP_DatagramAlloc()
+    and measures the datagrams per second of TCPIP_UDP_ArrayPut() + TCPIP_UDP_Flush()
+    against TCPIP_UDP_DatagramsSend(), with copy and zero copy,
+    with the MAC acknowledging at once (Wi-Fi) or after the batch (DMA).
+    The MAC model runs on the host: the WDRV_PIC32MZW_MACPacketTx() handling
+    of a packet chain is not exercised.
+*******************************************************************************/
+
+//DOM-IGNORE-BEGIN
+/*
+Copyright (C) 2012-2023, Microchip Technology Inc., and its subsidiaries. All rights reserved.
+
+The software and documentation is provided by microchip and its contributors
+"as is" and any express, implied or statutory warranties, including, but not
+limited to, the implied warranties of merchantability, fitness for a particular
+purpose and non-infringement of third party intellectual property rights are
+disclaimed to the fullest extent permitted by law. In no event shall microchip
+or its contributors be liable for any direct, indirect, incidental, special,
+exemplary, or consequential damages (including, but not limited to, procurement
+of substitute goods or services; loss of use, data, or profits; or business
+interruption) however caused and on any theory of liability, whether in contract,
+strict liability, or tort (including negligence or otherwise) arising in any way
+out of the use of the software and documentation, even if advised of the
+possibility of such damage.
+
+Except as expressly permitted hereunder and subject to the applicable license terms
+for any third-party software incorporated in the software and any applicable open
+source software license terms, no license or other rights, whether express or
+implied, are granted under any patent or other intellectual property rights of
+Microchip or any third party.
+*/
+
+//DOM-IGNORE-END
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_test.h"
+
+// the module under test, for access to its internal state
+#include "tcpip/src/udp.c"
+
+#if (_UDP_BATCH_SEND == 0)
+#error "the test needs TCPIP_UDP_BATCH_SEND"
+#endif
+
+// addresses, network order
+#define TEST_LOCAL_ADD          0x0a00000a      // 10.0.0.10
+#define TEST_NET_MASK           0x00ffffff
+#define TEST_SOLVED_ADD         0x2700000a      // 10.0.0.39, in the ARP cache
+#define TEST_UNSOLVED_ADD       0x6000000a      // 10.0.0.96, not in the ARP cache
+#define TEST_ARP_ENTRIES        8               // 10.0.0.32 - 10.0.0.39
+
+#define TEST_REMOTE_PORT        514
+#define TEST_BATCH              32
+#define TEST_TX_QUEUE_LIMIT     (TEST_BATCH + 2)
+#define TEST_ROUNDS             20000
+
+#define TEST_MAX_FRAME          1600
+
+// the ways the application sends a batch
+typedef enum
+{
+    TEST_SEND_PUT_FLUSH,        // TCPIP_UDP_ArrayPut() + TCPIP_UDP_Flush() per datagram
+    TEST_SEND_BATCH_COPY,       // TCPIP_UDP_DatagramsSend() of the application data
+    TEST_SEND_BATCH_ZERO_COPY,  // TCPIP_UDP_DatagramsSend() of the TCPIP_UDP_DatagramAlloc() packets
+
+    TEST_SEND_MODES
+}TEST_SEND_MODE;
+
+static const char* testModeNames[TEST_SEND_MODES] =
+{
+    "ArrayPut+Flush",
+    "DatagramsSend copy",
+    "DatagramsSend zero-copy",
+};
+
+static TCPIP_NET_IF testNetIf;
+
+static struct
+{
+    uint32_t        ipAdd;
+    TCPIP_MAC_ADDR  macAdd;
+}testArpCache[TEST_ARP_ENTRIES];
+
+// MAC model
+static uint8_t testFrame[TEST_MAX_FRAME];
+static volatile uint32_t testFrameSink;
+static uint32_t testFrames;
+static uint32_t testMacCalls;
+static bool testMacDeferAck;
+static TCPIP_MAC_PACKET* testMacPending[TEST_TX_QUEUE_LIMIT * 2];
+static int testMacNPending;
+
+static uint8_t testAppData[2][TCPIP_MAC_LINK_MTU_DEFAULT];
+
+// TX packets the socket holds between the tests: its own TX packet
+static uint16_t testAllocBase;
+
+// system and stack services used by the UDP and IPv4 modules
+
+uint32_t SYS_RANDOM_PoolGet(SYS_RANDOM_POOL pool)
+{
+    return (uint32_t)rand();
+}
+
+tcpipSignalHandle _TCPIPStackSignalHandlerRegister(TCPIP_STACK_MODULE modId, tcpipModuleSignalHandler signalHandler, int16_t asyncTmoMs)
+{
+    return (tcpipSignalHandle)&testNetIf;
+}
+
+void _TCPIPStackSignalHandlerDeregister(tcpipSignalHandle handle)
+{
+}
+
+TCPIP_MODULE_SIGNAL _TCPIPStackModuleSignalGet(TCPIP_STACK_MODULE modId, TCPIP_MODULE_SIGNAL clrMask)
+{
+    return TCPIP_MODULE_SIGNAL_NONE;
+}
+
+TCPIP_MAC_PACKET* _TCPIPStackModuleRxExtract(TCPIP_STACK_MODULE modId)
+{
+    return 0;
+}
+
+void _TCPIPStackInsertRxPacket(TCPIP_NET_IF* pNetIf, TCPIP_MAC_PACKET* pRxPkt, bool signal)
+{   // an internal destination: the packet is done with
+    TCPIP_PKT_PacketAcknowledge(pRxPkt, TCPIP_MAC_PKT_ACK_RX_OK);
+}
+
+int TCPIP_STACK_NetIxGet(const TCPIP_NET_IF* pNetIf)
+{
+    return 0;
+}
+
+int TCPIP_STACK_NumberOfNetworksGet(void)
+{
+    return 1;
+}
+
+TCPIP_NET_HANDLE TCPIP_STACK_IndexToNet(int netIx)
+{
+    return netIx == 0 ? &testNetIf : 0;
+}
+
+TCPIP_NET_IF* TCPIP_STACK_IPAddToNet(IPV4_ADDR* pIpAddress, bool useDefault)
+{
+    return pIpAddress->Val == testNetIf.netIPAddr.Val ? &testNetIf : 0;
+}
+
+TCPIP_NET_IF* _TCPIPStackHandleToNetLinked(TCPIP_NET_HANDLE hNet)
+{
+    return (TCPIP_NET_IF*)hNet;
+}
+
+TCPIP_NET_IF* _TCPIPStackAnyNetLinked(bool useDefault)
+{
+    return &testNetIf;
+}
+
+TCPIP_NET_IF* TCPIP_STACK_MatchNetAddress(TCPIP_NET_IF* pNetIf, const IPV4_ADDR* pIpAdd)
+{
+    return pIpAdd->Val == testNetIf.netIPAddr.Val ? &testNetIf : 0;
+}
+
+uint32_t TCPIP_STACK_NetAddressBcast(TCPIP_NET_HANDLE hNet)
+{
+    return testNetIf.netIPAddr.Val | ~testNetIf.netMask.Val;
+}
+
+bool TCPIP_STACK_IsBcastAddress(TCPIP_NET_IF* pNetIf, const IPV4_ADDR* pIpAdd)
+{
+    return pIpAdd->Val == 0xffffffff;
+}
+
+uint32_t TCPIP_STACK_NetAddressGet(TCPIP_NET_IF* pNetIf)
+{
+    return pNetIf->netIPAddr.Val;
+}
+
+TCPIP_NET_IF* TCPIP_STACK_NetByAddress(const IPV4_ADDR* pIpAddress)
+{
+    return pIpAddress->Val == testNetIf.netIPAddr.Val ? &testNetIf : 0;
+}
+
+TCPIP_NET_IF* _TCPIPStackIpAddFromAnyNet(TCPIP_NET_IF* pNetIf, IPV4_ADDR* pIpAddress)
+{
+    return TCPIP_STACK_NetByAddress(pIpAddress);
+}
+
+bool _TCPIPStackModuleRxInsert(TCPIP_STACK_MODULE modId, TCPIP_MAC_PACKET* pRxPkt, bool signal)
+{
+    return false;
+}
+
+TCPIP_ARP_HANDLE TCPIP_ARP_HandlerRegister(TCPIP_NET_HANDLE hNet, TCPIP_ARP_EVENT_HANDLER handler, const void* hParam)
+{
+    return (TCPIP_ARP_HANDLE)&testArpCache;
+}
+
+bool TCPIP_ARP_HandlerDeRegister(TCPIP_ARP_HANDLE hArp)
+{
+    return true;
+}
+
+TCPIP_ARP_RESULT TCPIP_ARP_EntryGet(TCPIP_NET_HANDLE hNet, const IPV4_ADDR* pIPAddr, TCPIP_MAC_ADDR* pHwAdd, bool probe)
+{
+    int ix;
+
+    for(ix = 0; ix < TEST_ARP_ENTRIES; ix++)
+    {
+        if(testArpCache[ix].ipAdd == pIPAddr->Val)
+        {
+            *pHwAdd = testArpCache[ix].macAdd;
+            return ARP_RES_ENTRY_SOLVED;
+        }
+    }
+
+    return ARP_RES_ENTRY_NEW;
+}
+
+// the MAC: copies each frame of the chain to its buffer and
+// acknowledges it at once, or once the batch is done
+TCPIP_MAC_RES _TCPIPStackPacketTx(TCPIP_NET_IF* pNetIf, TCPIP_MAC_PACKET* pPkt)
+{
+    TCPIP_MAC_PACKET* pNext;
+    TCPIP_MAC_DATA_SEGMENT* pSeg;
+    uint8_t* pFrame;
+
+    testMacCalls++;
+    for(; pPkt != 0; pPkt = pNext)
+    {
+        pNext = pPkt->next;
+        pFrame = testFrame;
+        for(pSeg = pPkt->pDSeg; pSeg != 0; pSeg = pSeg->next)
+        {
+            memcpy(pFrame, pSeg->segLoad, pSeg->segLen);
+            pFrame += pSeg->segLen;
+        }
+        testFrameSink += pFrame[-1];
+        testFrames++;
+
+        pPkt->pktFlags |= TCPIP_MAC_PKT_FLAG_QUEUED;
+        if(testMacDeferAck)
+        {
+            testMacPending[testMacNPending++] = pPkt;
+        }
+        else
+        {
+            pPkt->pktFlags &= ~TCPIP_MAC_PKT_FLAG_QUEUED;
+            TCPIP_PKT_PacketAcknowledge(pPkt, TCPIP_MAC_PKT_ACK_TX_OK);
+        }
+    }
+
+    return TCPIP_MAC_RES_OK;
+}
+
+static void _TestMacAckPending(void)
+{
+    int ix;
+
+    for(ix = 0; ix < testMacNPending; ix++)
+    {
+        testMacPending[ix]->pktFlags &= ~TCPIP_MAC_PKT_FLAG_QUEUED;
+        TCPIP_PKT_PacketAcknowledge(testMacPending[ix], TCPIP_MAC_PKT_ACK_TX_OK);
+    }
+    testMacNPending = 0;
+}
+
+static void _TestDestinationSet(UDP_SOCKET skt, uint32_t ipAdd)
+{
+    IP_MULTI_ADDRESS dstAdd;
+
+    dstAdd.v4Add.Val = ipAdd;
+    HOST_TEST_CHECK(TCPIP_UDP_DestinationIPAddressSet(skt, IP_ADDRESS_TYPE_IPV4, &dstAdd));
+}
+
+static void _TestFallback(UDP_SOCKET skt)
+{
+    TCPIP_UDP_DATAGRAM dgArray[4], resend[2];
+    uint8_t* pLoad;
+    uint32_t frames, macCalls;
+    int ix;
+
+    // odd entries are user packets, even entries are copied
+    for(ix = 0; ix < 4; ix++)
+    {
+        dgArray[ix].pPkt = (ix & 1) != 0 ? TCPIP_UDP_DatagramAlloc(skt, 100, &pLoad) : 0;
+        dgArray[ix].pData = testAppData[0];
+        dgArray[ix].dataLen = 100;
+    }
+
+    // own address: not a chain; one packet at a time through the internal path
+    _TestDestinationSet(skt, TEST_LOCAL_ADD);
+    frames = testFrames;
+    macCalls = testMacCalls;
+    HOST_TEST_CHECK(TCPIP_UDP_DatagramsSend(skt, dgArray, 4) == 4);
+    HOST_TEST_CHECK(testFrames == frames && testMacCalls == macCalls);
+    HOST_TEST_CHECK(_UDPSocketDcpt(skt)->txAllocCnt == testAllocBase);
+
+    // unresolved ARP: nothing goes out, the user packets are returned
+    for(ix = 1; ix < 4; ix += 2)
+    {
+        dgArray[ix].pPkt = TCPIP_UDP_DatagramAlloc(skt, 100, &pLoad);
+        HOST_TEST_CHECK(dgArray[ix].pPkt != 0);
+    }
+    _TestDestinationSet(skt, TEST_UNSOLVED_ADD);
+    HOST_TEST_CHECK(TCPIP_UDP_DatagramsSend(skt, dgArray, 4) == 0);
+    HOST_TEST_CHECK(testFrames == frames && testMacCalls == macCalls);
+    for(ix = 1; ix < 4; ix += 2)
+    {
+        HOST_TEST_CHECK(dgArray[ix].pPkt->pDSeg->segLen == 0);
+        HOST_TEST_CHECK((dgArray[ix].pPkt->pktFlags & TCPIP_MAC_PKT_FLAG_QUEUED) == 0);
+    }
+    // only the returned packets are held
+    HOST_TEST_CHECK(_UDPSocketDcpt(skt)->txAllocCnt == testAllocBase + 2);
+
+    // the returned packets go out as a chain to a solved destination
+    _TestDestinationSet(skt, TEST_SOLVED_ADD);
+    resend[0] = dgArray[1];
+    resend[1] = dgArray[3];
+    HOST_TEST_CHECK(TCPIP_UDP_DatagramsSend(skt, resend, 2) == 2);
+    HOST_TEST_CHECK(testFrames == frames + 2 && testMacCalls == macCalls + 1);
+    HOST_TEST_CHECK(_UDPSocketDcpt(skt)->txAllocCnt == testAllocBase);
+}
+
+static void _TestReject(UDP_SOCKET skt, UDP_SOCKET otherSkt)
+{
+    TCPIP_UDP_DATAGRAM dg;
+    uint8_t* pLoad;
+    uint32_t frames;
+
+    frames = testFrames;
+
+    // payload larger than the packet
+    dg.pPkt = TCPIP_UDP_DatagramAlloc(skt, 64, &pLoad);
+    dg.pData = 0;
+    dg.dataLen = 1400;
+    HOST_TEST_CHECK(dg.pPkt != 0);
+    HOST_TEST_CHECK(TCPIP_UDP_DatagramsSend(skt, &dg, 1) == 0);
+    dg.dataLen = 64;
+    HOST_TEST_CHECK(TCPIP_UDP_DatagramsSend(skt, &dg, 1) == 1);
+
+    // packet of another socket
+    dg.pPkt = TCPIP_UDP_DatagramAlloc(otherSkt, 64, &pLoad);
+    HOST_TEST_CHECK(dg.pPkt != 0);
+    HOST_TEST_CHECK(TCPIP_UDP_DatagramsSend(skt, &dg, 1) == 0);
+    TCPIP_UDP_DatagramFree(otherSkt, dg.pPkt);
+
+    HOST_TEST_CHECK(testFrames == frames + 1);
+    HOST_TEST_CHECK(_UDPSocketDcpt(skt)->txAllocCnt == testAllocBase && _UDPSocketDcpt(otherSkt)->txAllocCnt == 0);
+}
+
+static void _TestQueueLimit(UDP_SOCKET skt)
+{
+    TCPIP_MAC_PACKET* pktArray[TEST_TX_QUEUE_LIMIT + 1];
+    uint8_t* pLoad;
+    int ix, nPkts, nRound;
+
+    for(nRound = 0; nRound < 2; nRound++)
+    {
+        for(nPkts = 0; nPkts < TEST_TX_QUEUE_LIMIT + 1; nPkts++)
+        {
+            if((pktArray[nPkts] = TCPIP_UDP_DatagramAlloc(skt, 10, &pLoad)) == 0)
+            {
+                break;
+            }
+        }
+        HOST_TEST_CHECK(nPkts == TEST_TX_QUEUE_LIMIT - testAllocBase);
+
+        for(ix = 0; ix < nPkts; ix++)
+        {
+            TCPIP_UDP_DatagramFree(skt, pktArray[ix]);
+        }
+        HOST_TEST_CHECK(_UDPSocketDcpt(skt)->txAllocCnt == testAllocBase);
+    }
+}
+
+// the application formats each datagram, e.g. a telemetry record
+static void _TestProduce(uint8_t* pData, uint16_t len, int seq)
+{
+    memset(pData, 'a' + (seq & 0xf), len);
+}
+
+static uint32_t _TestSendRound(UDP_SOCKET skt, TEST_SEND_MODE mode, uint16_t len)
+{
+    TCPIP_UDP_DATAGRAM dgArray[TEST_BATCH];
+    TCPIP_MAC_PACKET* pPkt;
+    uint8_t* pLoad;
+    uint8_t* pData;
+    int ix, nDgrams, nSent;
+
+    nSent = 0;
+    switch(mode)
+    {
+        case TEST_SEND_PUT_FLUSH:
+            for(ix = 0; ix < TEST_BATCH; ix++)
+            {
+                _TestProduce(testAppData[0], len, ix);
+                if(TCPIP_UDP_PutIsReady(skt) < len)
+                {
+                    break;
+                }
+                TCPIP_UDP_ArrayPut(skt, testAppData[0], len);
+                if(TCPIP_UDP_Flush(skt) != 0)
+                {
+                    nSent++;
+                }
+            }
+            break;
+
+        case TEST_SEND_BATCH_COPY:
+            for(ix = 0; ix < TEST_BATCH; ix++)
+            {
+                pData = testAppData[ix & 1];
+                _TestProduce(pData, len, ix);
+                dgArray[ix].pPkt = 0;
+                dgArray[ix].pData = pData;
+                dgArray[ix].dataLen = len;
+            }
+            nSent = TCPIP_UDP_DatagramsSend(skt, dgArray, TEST_BATCH);
+            break;
+
+        default:
+            for(nDgrams = 0; nDgrams < TEST_BATCH; nDgrams++)
+            {
+                if((pPkt = TCPIP_UDP_DatagramAlloc(skt, len, &pLoad)) == 0)
+                {
+                    break;
+                }
+                _TestProduce(pLoad, len, nDgrams);
+                dgArray[nDgrams].pPkt = pPkt;
+                dgArray[nDgrams].pData = 0;
+                dgArray[nDgrams].dataLen = len;
+            }
+            nSent = TCPIP_UDP_DatagramsSend(skt, dgArray, nDgrams);
+            for(ix = nSent; ix < nDgrams; ix++)
+            {
+                TCPIP_UDP_DatagramFree(skt, dgArray[ix].pPkt);
+            }
+            break;
+    }
+
+    _TestMacAckPending();
+    return nSent;
+}
+
+static void _TestThroughput(UDP_SOCKET skt, bool deferAck, uint16_t len)
+{
+    struct timespec tStart, tEnd;
+    uint64_t elapsedNs, nSent;
+    TEST_SEND_MODE mode;
+    int round;
+
+    testMacDeferAck = deferAck;
+    printf("%s, %u byte payload, batch %d\n", deferAck ? "deferred ack (DMA)" : "immediate ack (Wi-Fi)", len, TEST_BATCH);
+    for(mode = 0; mode < TEST_SEND_MODES; mode++)
+    {
+        nSent = 0;
+        testFrames = testMacCalls = 0;
+        clock_gettime(CLOCK_MONOTONIC, &tStart);
+        for(round = 0; round < TEST_ROUNDS; round++)
+        {
+            nSent += _TestSendRound(skt, mode, len);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &tEnd);
+        elapsedNs = (uint64_t)(tEnd.tv_sec - tStart.tv_sec) * 1000000000 + tEnd.tv_nsec - tStart.tv_nsec;
+
+        printf("    %-24s %9.0f dgrams/s %5.0f ns/dgram, frames %u, MAC calls %u\n", testModeNames[mode],
+                nSent * 1e9 / elapsedNs, (double)elapsedNs / nSent, testFrames, testMacCalls);
+
+        // every datagram goes out; a batch is a single MAC call
+        HOST_TEST_CHECK(nSent == TEST_ROUNDS * TEST_BATCH && testFrames == nSent);
+        HOST_TEST_CHECK(testMacCalls == (mode == TEST_SEND_PUT_FLUSH ? nSent : TEST_ROUNDS));
+        HOST_TEST_CHECK(_UDPSocketDcpt(skt)->txAllocCnt == testAllocBase);
+    }
+}
+
+int main(void)
+{
+    TCPIP_STACK_HEAP_HANDLE heapH = HOST_TEST_HeapCreate();
+    TCPIP_UDP_MODULE_CONFIG udpConfig =
+    {
+        .nSockets = 4,
+        .sktTxBuffSize = TCPIP_MAC_LINK_MTU_DEFAULT - sizeof(IPV4_HEADER) - sizeof(UDP_HEADER),
+    };
+    TCPIP_STACK_MODULE_CTRL stackCtrl =
+    {
+        .memH = heapH,
+        .stackAction = TCPIP_STACK_ACTION_INIT,
+        .nIfs = 1,
+    };
+    IP_MULTI_ADDRESS dstAdd;
+    UDP_SOCKET skt, otherSkt;
+    int ix, nBlocks;
+
+    HOST_TEST_CHECK(heapH != 0 && TCPIP_PKT_Initialize(heapH, 0, 0));
+
+    testNetIf.netIPAddr.Val = TEST_LOCAL_ADD;
+    testNetIf.netMask.Val = TEST_NET_MASK;
+    testNetIf.linkMtu = TCPIP_MAC_LINK_MTU_DEFAULT;
+    testNetIf.macType = TCPIP_MAC_TYPE_ETH;
+    testNetIf.Flags.bInterfaceEnabled = 1;
+    for(ix = 0; ix < sizeof(testNetIf.netMACAddr.v); ix++)
+    {
+        testNetIf.netMACAddr.v[ix] = ix + 1;
+    }
+    for(ix = 0; ix < TEST_ARP_ENTRIES; ix++)
+    {
+        testArpCache[ix].ipAdd = 0x0000000a | (0x20 + ix) << 24;
+        memset(testArpCache[ix].macAdd.v, 0x10 + ix, sizeof(testArpCache[ix].macAdd.v));
+    }
+
+    HOST_TEST_CHECK(TCPIP_UDP_Initialize(&stackCtrl, &udpConfig));
+
+    dstAdd.v4Add.Val = TEST_SOLVED_ADD;
+    skt = TCPIP_UDP_ClientOpen(IP_ADDRESS_TYPE_IPV4, TEST_REMOTE_PORT, &dstAdd);
+    otherSkt = TCPIP_UDP_ClientOpen(IP_ADDRESS_TYPE_IPV4, TEST_REMOTE_PORT, &dstAdd);
+    HOST_TEST_CHECK(skt != INVALID_UDP_SOCKET && otherSkt != INVALID_UDP_SOCKET);
+    HOST_TEST_CHECK(TCPIP_UDP_OptionsSet(skt, UDP_OPTION_TX_QUEUE_LIMIT, (void*)TEST_TX_QUEUE_LIMIT));
+    HOST_TEST_CHECK(TCPIP_UDP_OptionsSet(otherSkt, UDP_OPTION_TX_QUEUE_LIMIT, (void*)TEST_TX_QUEUE_LIMIT));
+
+    // the socket TX packet is allocated by the first TCPIP_UDP_PutIsReady()
+    HOST_TEST_CHECK(TCPIP_UDP_PutIsReady(skt) != 0);
+    HOST_TEST_CHECK(TCPIP_UDP_ArrayPut(skt, testAppData[0], 10) == 10 && TCPIP_UDP_Flush(skt) == 10);
+    HOST_TEST_CHECK(TCPIP_UDP_PutIsReady(skt) != 0);
+    testAllocBase = _UDPSocketDcpt(skt)->txAllocCnt;
+    nBlocks = HOST_TEST_HeapBlocks();
+
+    _TestFallback(skt);
+    _TestReject(skt, otherSkt);
+    _TestQueueLimit(skt);
+    HOST_TEST_CHECK(HOST_TEST_HeapBlocks() == nBlocks);
+
+    _TestThroughput(skt, false, 64);
+    _TestThroughput(skt, false, 512);
+    _TestThroughput(skt, true, 64);
+    _TestThroughput(skt, true, 512);
+    HOST_TEST_CHECK(HOST_TEST_HeapBlocks() == nBlocks);
+
+    TCPIP_UDP_Close(skt);
+    TCPIP_UDP_Close(otherSkt);
+
+    return HOST_TEST_Result("udp_batch");
+}